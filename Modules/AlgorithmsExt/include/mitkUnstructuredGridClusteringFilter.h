@@ -57,6 +57,15 @@ namespace mitk
   *             N = N joined with N'
   *         if P' is not yet member of any cluster
   *           add P' to cluster C
+  *
+  * The implementation finds the same clusters without expanding them point by
+  * point: the neighbours are searched in a uniform grid with cells of size eps,
+  * the kernel points are found in parallel and kernel points in range of each
+  * other are merged with a concurrent union-find, whose root label is the
+  * smallest kernel point id of a cluster. A density reachable point belongs to
+  * the cluster with the smallest root label among its kernel neighbours, which
+  * is the one the serial expansion reaches first. Clusters are ordered by their
+  * root label, the points of a cluster by their id.
   */
 
   class MITKALGORITHMSEXT_EXPORT UnstructuredGridClusteringFilter : public UnstructuredGridToUnstructuredGridFilter
@@ -77,6 +86,10 @@ namespace mitk
       /** If activated the clusteres UnstructuredGrid is meshed */
       itkSetMacro(Meshing, bool);
 
+      /** Sets the number of threads used for clustering (0: number of hardware threads) */
+      itkSetMacro(NumberOfThreads, unsigned int);
+      itkGetMacro(NumberOfThreads, unsigned int);
+
       /** Returns all clusters as UnstructuredGrids which were found */
       virtual std::vector<mitk::UnstructuredGrid::Pointer> GetAllClusters();
 
@@ -97,9 +110,6 @@ namespace mitk
     void GenerateData() override;
 
   private:
-    /** Used for the DBSCAN algorithm to expand a cluster and add more points to it */
-    void ExpandCluster(int id, vtkIdList *pointIDs, vtkPoints *cluster, vtkPoints *inpPoints);
-
     /** The result main Cluster */
     mitk::UnstructuredGrid::Pointer m_UnstructGrid;
 
@@ -121,6 +131,8 @@ namespace mitk
     /** If its activated the distance of the clusters is used instead of the
     * size */
     bool m_DistCalc;
+
+    unsigned int m_NumberOfThreads;
   };
 
 } // namespace mitk
@@ -12,21 +12,241 @@ found in the LICENSE file.
 
 #include <mitkUnstructuredGridClusteringFilter.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
 #include <vtkDataArray.h>
 #include <vtkDelaunay3D.h>
 #include <vtkDoubleArray.h>
 #include <vtkPointData.h>
-#include <vtkPointLocator.h>
 #include <vtkPoints.h>
 #include <vtkPolyVertex.h>
 #include <vtkSmartPointer.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkVariant.h>
 
+namespace
+{
+  /** Runs function(begin, end) on chunks of [0, n) in parallel, the calling thread takes part. */
+  template <typename Function>
+  void ParallelFor(vtkIdType n, unsigned int numberOfThreads, const Function &function)
+  {
+    const vtkIdType chunkSize = 1024;
+    std::atomic<vtkIdType> next(0);
+    auto worker = [&]() {
+      for (vtkIdType begin = next.fetch_add(chunkSize); begin < n; begin = next.fetch_add(chunkSize))
+      {
+        function(begin, std::min(begin + chunkSize, n));
+      }
+    };
+
+    const unsigned int numberOfWorkers =
+      static_cast<unsigned int>(std::min<vtkIdType>(numberOfThreads, (n + chunkSize - 1) / chunkSize));
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfWorkers; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  /** Points sorted into the cells of a uniform grid, whose cells are not smaller than the search radius. */
+  class PointGrid
+  {
+  public:
+    PointGrid(const std::vector<double> &points, double radius) : m_Points(points), m_SquaredRadius(radius * radius)
+    {
+      const vtkIdType numberOfPoints = static_cast<vtkIdType>(points.size() / 3);
+
+      double bounds[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+      bool first = true;
+      for (vtkIdType id = 0; id < numberOfPoints; ++id)
+      {
+        if (!this->IsFinite(id))
+          continue;
+
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+          const double coordinate = points[3 * id + axis];
+          bounds[2 * axis] = first ? coordinate : std::min(bounds[2 * axis], coordinate);
+          bounds[2 * axis + 1] = first ? coordinate : std::max(bounds[2 * axis + 1], coordinate);
+        }
+        first = false;
+      }
+
+      // the number of cells per axis is limited, so that the cell keys fit into 64 bit
+      const double extent = std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+      m_CellSize = std::max(radius, extent / (1 << 20));
+      if (!(m_CellSize > 0.0))
+      {
+        m_CellSize = 1.0;
+      }
+
+      for (unsigned int axis = 0; axis < 3; ++axis)
+      {
+        m_Origin[axis] = bounds[2 * axis];
+        m_Dimensions[axis] = static_cast<std::int64_t>((bounds[2 * axis + 1] - bounds[2 * axis]) / m_CellSize) + 1;
+      }
+
+      std::vector<std::pair<std::uint64_t, vtkIdType>> keys;
+      keys.reserve(numberOfPoints);
+      for (vtkIdType id = 0; id < numberOfPoints; ++id)
+      {
+        if (this->IsFinite(id))
+        {
+          std::int64_t cell[3];
+          this->GetCell(id, cell);
+          keys.emplace_back(this->GetKey(cell[0], cell[1], cell[2]), id);
+        }
+      }
+      std::sort(keys.begin(), keys.end());
+
+      m_SortedIds.reserve(keys.size());
+      for (const auto &key : keys)
+      {
+        if (m_Keys.empty() || m_Keys.back() != key.first)
+        {
+          m_Keys.push_back(key.first);
+          m_CellStarts.push_back(static_cast<vtkIdType>(m_SortedIds.size()));
+        }
+        m_SortedIds.push_back(key.second);
+      }
+      m_CellStarts.push_back(static_cast<vtkIdType>(m_SortedIds.size()));
+    }
+
+    bool IsFinite(vtkIdType id) const
+    {
+      return std::isfinite(m_Points[3 * id]) && std::isfinite(m_Points[3 * id + 1]) &&
+             std::isfinite(m_Points[3 * id + 2]);
+    }
+
+    /** Calls visitor(neighbourId) for all points within the radius of a point, including the point itself,
+     * until the visitor returns false. */
+    template <typename Visitor>
+    void ForEachNeighbour(vtkIdType id, const Visitor &visitor) const
+    {
+      if (!this->IsFinite(id))
+        return;
+
+      const double *point = &m_Points[3 * id];
+      std::int64_t cell[3];
+      this->GetCell(id, cell);
+
+      const std::int64_t lastZ = std::min(cell[2] + 1, m_Dimensions[2] - 1);
+      const std::int64_t lastY = std::min(cell[1] + 1, m_Dimensions[1] - 1);
+      for (std::int64_t z = std::max<std::int64_t>(cell[2] - 1, 0); z <= lastZ; ++z)
+      {
+        for (std::int64_t y = std::max<std::int64_t>(cell[1] - 1, 0); y <= lastY; ++y)
+        {
+          // the cells along x are consecutive keys
+          const std::uint64_t firstKey = this->GetKey(std::max<std::int64_t>(cell[0] - 1, 0), y, z);
+          const std::uint64_t lastKey = this->GetKey(std::min(cell[0] + 1, m_Dimensions[0] - 1), y, z);
+
+          for (auto key = std::lower_bound(m_Keys.begin(), m_Keys.end(), firstKey);
+               key != m_Keys.end() && *key <= lastKey;
+               ++key)
+          {
+            const std::size_t cellIndex = key - m_Keys.begin();
+            for (vtkIdType i = m_CellStarts[cellIndex]; i < m_CellStarts[cellIndex + 1]; ++i)
+            {
+              const vtkIdType neighbour = m_SortedIds[i];
+              const double *neighbourPoint = &m_Points[3 * neighbour];
+              const double dx = neighbourPoint[0] - point[0];
+              const double dy = neighbourPoint[1] - point[1];
+              const double dz = neighbourPoint[2] - point[2];
+              if (dx * dx + dy * dy + dz * dz <= m_SquaredRadius && !visitor(neighbour))
+                return;
+            }
+          }
+        }
+      }
+    }
+
+  private:
+    void GetCell(vtkIdType id, std::int64_t cell[3]) const
+    {
+      for (unsigned int axis = 0; axis < 3; ++axis)
+      {
+        const std::int64_t index =
+          static_cast<std::int64_t>((m_Points[3 * id + axis] - m_Origin[axis]) / m_CellSize);
+        cell[axis] = std::min(std::max<std::int64_t>(index, 0), m_Dimensions[axis] - 1);
+      }
+    }
+
+    std::uint64_t GetKey(std::int64_t x, std::int64_t y, std::int64_t z) const
+    {
+      return (static_cast<std::uint64_t>(z) * m_Dimensions[1] + y) * m_Dimensions[0] + x;
+    }
+
+    const std::vector<double> &m_Points;
+    double m_SquaredRadius;
+    double m_CellSize;
+    double m_Origin[3];
+    std::int64_t m_Dimensions[3];
+
+    std::vector<std::uint64_t> m_Keys;
+    std::vector<vtkIdType> m_CellStarts;
+    std::vector<vtkIdType> m_SortedIds;
+  };
+
+  /** Union-find which can be used concurrently. The root of a set is its smallest element. */
+  class ConcurrentUnionFind
+  {
+  public:
+    explicit ConcurrentUnionFind(vtkIdType size) : m_Parents(size)
+    {
+      for (vtkIdType i = 0; i < size; ++i)
+        m_Parents[i].store(i, std::memory_order_relaxed);
+    }
+
+    vtkIdType Find(vtkIdType element)
+    {
+      while (true)
+      {
+        vtkIdType parent = m_Parents[element].load();
+        if (parent == element)
+          return element;
+
+        // path halving
+        const vtkIdType grandParent = m_Parents[parent].load();
+        m_Parents[element].compare_exchange_weak(parent, grandParent);
+        element = grandParent;
+      }
+    }
+
+    void Union(vtkIdType first, vtkIdType second)
+    {
+      while (true)
+      {
+        first = this->Find(first);
+        second = this->Find(second);
+        if (first == second)
+          return;
+
+        // the larger root is linked below the smaller one, it fails if the larger root got a parent meanwhile
+        if (first < second)
+          std::swap(first, second);
+        vtkIdType expected = first;
+        if (m_Parents[first].compare_exchange_strong(expected, second))
+          return;
+      }
+    }
+
+  private:
+    std::vector<std::atomic<vtkIdType>> m_Parents;
+  };
+}
+
 mitk::UnstructuredGridClusteringFilter::UnstructuredGridClusteringFilter()
-  : m_eps(5.0), m_MinPts(4), m_Meshing(false), m_DistCalc(false)
+  : m_eps(5.0), m_MinPts(4), m_Meshing(false), m_DistCalc(false), m_NumberOfThreads(0)
 {
   this->m_UnstructGrid = mitk::UnstructuredGrid::New();
 }
@@ -35,14 +255,6 @@ mitk::UnstructuredGridClusteringFilter::~UnstructuredGridClusteringFilter()
 {
 }
 
-std::map<int, bool> visited;
-std::map<int, bool> isNoise;
-std::map<int, bool> clusterMember;
-vtkSmartPointer<vtkPointLocator> pLocator;
-std::vector<vtkSmartPointer<vtkPoints>> clusterVector;
-
-std::vector<std::vector<int>> clustersPointsIDs;
-
 void mitk::UnstructuredGridClusteringFilter::GenerateOutputInformation()
 {
   m_UnstructGrid = this->GetOutput();
@@ -56,79 +268,121 @@ void mitk::UnstructuredGridClusteringFilter::GenerateData()
 
   vtkSmartPointer<vtkUnstructuredGrid> vtkInpGrid = inputGrid->GetVtkUnstructuredGrid();
   vtkSmartPointer<vtkPoints> inpPoints = vtkInpGrid->GetPoints();
-  pLocator = vtkSmartPointer<vtkPointLocator>::New();
+  const vtkIdType numberOfPoints = inpPoints != nullptr ? inpPoints->GetNumberOfPoints() : 0;
 
-  vtkSmartPointer<vtkDoubleArray> distances = vtkSmartPointer<vtkDoubleArray>::New();
-  if (inputGrid->GetVtkUnstructuredGrid()->GetPointData()->GetNumberOfArrays() > 0)
+  vtkDataArray *distances = nullptr;
+  m_DistCalc = vtkInpGrid->GetPointData()->GetNumberOfArrays() > 0;
+  if (m_DistCalc)
   {
-    m_DistCalc = true;
-    distances = dynamic_cast<vtkDoubleArray *>(vtkInpGrid->GetPointData()->GetArray(0));
+    distances = vtkInpGrid->GetPointData()->GetArray(0);
+    m_DistCalc = distances != nullptr;
   }
 
-  pLocator->SetDataSet(vtkInpGrid);
-  pLocator->AutomaticOn();
-  pLocator->SetNumberOfPointsPerBucket(2);
-  pLocator->BuildLocator();
+  const unsigned int numberOfThreads =
+    m_NumberOfThreads > 0 ? m_NumberOfThreads : std::max(1u, std::thread::hardware_concurrency());
 
-  // fill the visited map with false for checking
-  for (int i = 0; i < inpPoints->GetNumberOfPoints(); i++)
+  std::vector<double> coordinates(3 * numberOfPoints);
+  for (vtkIdType id = 0; id < numberOfPoints; ++id)
   {
-    visited[i] = false;
-    isNoise[i] = false;
-    clusterMember[i] = false;
+    inpPoints->GetPoint(id, &coordinates[3 * id]);
   }
 
-  for (int i = 0; i < inpPoints->GetNumberOfPoints(); i++)
-  {
-    if (!visited[i])
+  const PointGrid grid(coordinates, m_eps);
+
+  // kernel points have at least MinPts neighbours, the point itself included
+  std::vector<char> isKernel(numberOfPoints, 0);
+  ParallelFor(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType id = begin; id < end; ++id)
     {
-      visited[i] = true;                                                       // mark P as visited
-      vtkSmartPointer<vtkIdList> idList = vtkSmartPointer<vtkIdList>::New();   // represent N
-      pLocator->FindPointsWithinRadius(m_eps, inpPoints->GetPoint(i), idList); // N = D.regionQuery(P, eps)
-      if (idList->GetNumberOfIds() < m_MinPts)                                 // if sizeof(N) < MinPts
-      {
-        isNoise[i] = true; // mark P as NOISE
-      }
-      else
+      int numberOfNeighbours = 0;
+      grid.ForEachNeighbour(id, [&](vtkIdType) { return ++numberOfNeighbours < m_MinPts; });
+      isKernel[id] = numberOfNeighbours >= m_MinPts;
+    }
+  });
+
+  // kernel points in range of each other belong to the same cluster
+  ConcurrentUnionFind clusters(numberOfPoints);
+  ParallelFor(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      if (!isKernel[id])
+        continue;
+
+      grid.ForEachNeighbour(id, [&](vtkIdType neighbour) {
+        if (neighbour > id && isKernel[neighbour])
+          clusters.Union(id, neighbour);
+        return true;
+      });
+    }
+  });
+
+  // Each point is labelled with the root of its cluster, i.e. its smallest kernel point id. As the
+  // serial algorithm expands the clusters in the order of these ids, a density reachable point
+  // belongs to the cluster with the smallest root label among its kernel neighbours.
+  std::vector<vtkIdType> labels(numberOfPoints, -1);
+  ParallelFor(numberOfPoints, numberOfThreads, [&](vtkIdType begin, vtkIdType end) {
+    for (vtkIdType id = begin; id < end; ++id)
+    {
+      if (isKernel[id])
       {
-        vtkSmartPointer<vtkPoints> cluster = vtkSmartPointer<vtkPoints>::New(); // represent a cluster
-        clusterVector.push_back(cluster);                                       // C = next cluster
-        this->ExpandCluster(
-          i, idList, cluster, inpPoints); // expandCluster(P, N, C, eps, MinPts) mod. the parameter list
+        labels[id] = clusters.Find(id);
+        continue;
       }
+
+      grid.ForEachNeighbour(id, [&](vtkIdType neighbour) {
+        if (isKernel[neighbour])
+        {
+          const vtkIdType label = clusters.Find(neighbour);
+          if (labels[id] < 0 || label < labels[id])
+            labels[id] = label;
+        }
+        return true;
+      });
     }
+  });
+
+  std::vector<int> clusterOfLabel(numberOfPoints, -1);
+  int numberOfClusters = 0;
+  for (vtkIdType id = 0; id < numberOfPoints; ++id)
+  {
+    if (labels[id] == id)
+      clusterOfLabel[id] = numberOfClusters++;
+  }
+
+  std::vector<std::vector<vtkIdType>> clustersPointsIDs(numberOfClusters);
+  for (vtkIdType id = 0; id < numberOfPoints; ++id)
+  {
+    if (labels[id] >= 0)
+      clustersPointsIDs[clusterOfLabel[labels[id]]].push_back(id);
   }
 
   // OUTPUT LOGIC
-  m_Clusters = clusterVector;
+  m_Clusters.clear();
+  m_DistanceArrays.clear();
   int numberOfClusterPoints = 0;
   int IdOfBiggestCluster = 0;
 
-  for (unsigned int i = 0; i < m_Clusters.size(); i++)
+  for (unsigned int i = 0; i < clustersPointsIDs.size(); i++)
   {
-    vtkSmartPointer<vtkDoubleArray> array = vtkSmartPointer<vtkDoubleArray>::New();
-    vtkSmartPointer<vtkPoints> points = m_Clusters.at(i);
+    const std::vector<vtkIdType> &pointIDs = clustersPointsIDs[i];
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetNumberOfPoints(pointIDs.size());
+    for (std::size_t j = 0; j < pointIDs.size(); j++)
+    {
+      points->SetPoint(j, &coordinates[3 * pointIDs[j]]);
+    }
+    m_Clusters.push_back(points);
+
     if (m_DistCalc)
     {
+      vtkSmartPointer<vtkDoubleArray> array = vtkSmartPointer<vtkDoubleArray>::New();
       array->SetNumberOfComponents(1);
       array->SetNumberOfTuples(points->GetNumberOfPoints());
-      for (int j = 0; j < points->GetNumberOfPoints(); j++)
+      for (std::size_t j = 0; j < pointIDs.size(); j++)
       {
-        double point[3];
-        points->GetPoint(j, point);
-        if (clustersPointsIDs.at(i).at(j) < inpPoints->GetNumberOfPoints())
-        {
-          if (distances->GetValue(clustersPointsIDs.at(i).at(j)) > 0.001)
-          {
-            double dist[1] = {distances->GetValue(clustersPointsIDs.at(i).at(j))};
-            array->SetTuple(j, dist);
-          }
-          else
-          {
-            double dist[1] = {0.0};
-            array->SetTuple(j, dist);
-          }
-        }
+        const double distance = distances->GetTuple1(pointIDs[j]);
+        array->SetValue(j, distance > 0.001 ? distance : 0.0);
       }
       m_DistanceArrays.push_back(array);
     }
@@ -140,9 +394,11 @@ void mitk::UnstructuredGridClusteringFilter::GenerateData()
   }
 
   vtkSmartPointer<vtkUnstructuredGrid> biggestCluster = vtkSmartPointer<vtkUnstructuredGrid>::New();
-
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  points = m_Clusters.at(IdOfBiggestCluster);
+  if (m_Clusters.empty())
+  {
+    m_UnstructGrid->SetVtkUnstructuredGrid(biggestCluster);
+    return;
+  }
 
   vtkSmartPointer<vtkPolyVertex> verts = vtkSmartPointer<vtkPolyVertex>::New();
   verts->GetPointIds()->SetNumberOfIds(m_Clusters.at(IdOfBiggestCluster)->GetNumberOfPoints());
@@ -169,56 +425,6 @@ void mitk::UnstructuredGridClusteringFilter::GenerateData()
   {
     m_UnstructGrid->SetVtkUnstructuredGrid(biggestCluster);
   }
-
-  clusterVector.clear();
-  clustersPointsIDs.clear();
-}
-
-void mitk::UnstructuredGridClusteringFilter::ExpandCluster(int id,
-                                                           vtkIdList *pointIDs,
-                                                           vtkPoints *cluster,
-                                                           vtkPoints *inpPoints)
-{
-  std::vector<int> x;
-  x.push_back(id);
-  cluster->InsertNextPoint(inpPoints->GetPoint(id)); // add P to cluster C
-  clusterMember[id] = true;
-
-  vtkSmartPointer<vtkPoints> neighbours = vtkSmartPointer<vtkPoints>::New(); // same N as in other function
-  inpPoints->GetPoints(pointIDs, neighbours);
-
-  for (int i = 0; i < pointIDs->GetNumberOfIds(); i++) // for each point P' in N
-  {
-    if (!visited[pointIDs->GetId(i)]) // if P' is not visited
-    {
-      visited[pointIDs->GetId(i)] = true;                                    // mark P' as visited
-      vtkSmartPointer<vtkIdList> idList = vtkSmartPointer<vtkIdList>::New(); // represent N'
-      pLocator->FindPointsWithinRadius(
-        m_eps, inpPoints->GetPoint(pointIDs->GetId(i)), idList); // N' = D.regionQuery(P', eps)
-
-      if (idList->GetNumberOfIds() >= m_MinPts) // if sizeof(N') >= MinPts
-      {
-        for (int j = 0; j < idList->GetNumberOfIds(); j++) // N = N joined with N'
-        {
-          if (idList->GetId(j) < inpPoints->GetNumberOfPoints()) // a litte bit hacked ?!
-          {
-            pointIDs->InsertNextId(idList->GetId(j));
-          }
-        }
-      }
-    }
-    if (!clusterMember[pointIDs->GetId(i)]) // if P' is not yet member of any cluster
-    {
-      if (pointIDs->GetId(i) < inpPoints->GetNumberOfPoints())
-      {
-        clusterMember[pointIDs->GetId(i)] = true;
-        x.push_back(pointIDs->GetId(i));
-        cluster->InsertNextPoint(inpPoints->GetPoint(pointIDs->GetId(i))); // add P' to cluster C
-      }
-    }
-  }
-
-  clustersPointsIDs.push_back(x);
 }
 
 std::vector<mitk::UnstructuredGrid::Pointer> mitk::UnstructuredGridClusteringFilter::GetAllClusters()
@@ -18,10 +18,17 @@ found in the LICENSE file.
 
 #include <mitkIOUtil.h>
 
+#include <vtkMath.h>
 #include <vtkPoints.h>
 #include <vtkSmartPointer.h>
 #include <vtkUnstructuredGrid.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+
 class mitkUnstructuredGridClusteringFilterTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkUnstructuredGridClusteringFilterTestSuite);
@@ -32,11 +39,135 @@ class mitkUnstructuredGridClusteringFilterTestSuite : public mitk::TestFixture
   MITK_TEST(testReturnedCluster);
   MITK_TEST(testClusterVector);
   MITK_TEST(testGetNumberOfFoundClusters);
+  MITK_TEST(testClustersMatchSerialDBSCAN);
+  MITK_TEST(testClustersAreIndependentOfThreads);
+  MITK_TEST(testNoClusterFound);
+  MITK_TEST(testLargePointCloud);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   mitk::UnstructuredGrid::Pointer m_UnstructuredGrid;
 
+  /** Gaussian blobs in uniformly distributed noise */
+  static mitk::UnstructuredGrid::Pointer CreatePointCloud(unsigned int numberOfBlobs,
+                                                          unsigned int pointsPerBlob,
+                                                          unsigned int numberOfNoisePoints,
+                                                          double extent)
+  {
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> uniform(-extent, extent);
+    std::normal_distribution<double> normal(0.0, 2.0);
+
+    std::vector<std::array<double, 3>> coordinates;
+    for (unsigned int blob = 0; blob < numberOfBlobs; ++blob)
+    {
+      const std::array<double, 3> center = {{uniform(generator), uniform(generator), uniform(generator)}};
+      for (unsigned int i = 0; i < pointsPerBlob; ++i)
+      {
+        coordinates.push_back(
+          {{center[0] + normal(generator), center[1] + normal(generator), center[2] + normal(generator)}});
+      }
+    }
+    for (unsigned int i = 0; i < numberOfNoisePoints; ++i)
+      coordinates.push_back({{uniform(generator), uniform(generator), uniform(generator)}});
+    std::shuffle(coordinates.begin(), coordinates.end(), generator);
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    for (const auto &coordinate : coordinates)
+      points->InsertNextPoint(coordinate.data());
+
+    vtkSmartPointer<vtkUnstructuredGrid> vtkGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    vtkGrid->SetPoints(points);
+    mitk::UnstructuredGrid::Pointer grid = mitk::UnstructuredGrid::New();
+    grid->SetVtkUnstructuredGrid(vtkGrid);
+    return grid;
+  }
+
+  /** Straightforward DBSCAN testing all pairs of points, the points of a cluster are sorted by their id */
+  static std::vector<std::vector<vtkIdType>> ClusterSerially(vtkPoints *points, double eps, int minPts)
+  {
+    const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+    auto findNeighbours = [&](vtkIdType id) {
+      double point[3];
+      points->GetPoint(id, point);
+      std::vector<vtkIdType> neighbours;
+      for (vtkIdType other = 0; other < numberOfPoints; ++other)
+      {
+        double otherPoint[3];
+        points->GetPoint(other, otherPoint);
+        if (vtkMath::Distance2BetweenPoints(point, otherPoint) <= eps * eps)
+          neighbours.push_back(other);
+      }
+      return neighbours;
+    };
+
+    std::vector<bool> visited(numberOfPoints, false);
+    std::vector<bool> clusterMember(numberOfPoints, false);
+    std::vector<std::vector<vtkIdType>> clusters;
+    for (vtkIdType id = 0; id < numberOfPoints; ++id)
+    {
+      if (visited[id])
+        continue;
+      visited[id] = true;
+
+      std::vector<vtkIdType> neighbours = findNeighbours(id);
+      if (static_cast<int>(neighbours.size()) < minPts)
+        continue;
+
+      std::vector<vtkIdType> cluster(1, id);
+      clusterMember[id] = true;
+      for (std::size_t i = 0; i < neighbours.size(); ++i)
+      {
+        const vtkIdType neighbour = neighbours[i];
+        if (!visited[neighbour])
+        {
+          visited[neighbour] = true;
+          const std::vector<vtkIdType> neighbourNeighbours = findNeighbours(neighbour);
+          if (static_cast<int>(neighbourNeighbours.size()) >= minPts)
+            neighbours.insert(neighbours.end(), neighbourNeighbours.begin(), neighbourNeighbours.end());
+        }
+        if (!clusterMember[neighbour])
+        {
+          clusterMember[neighbour] = true;
+          cluster.push_back(neighbour);
+        }
+      }
+      std::sort(cluster.begin(), cluster.end());
+      clusters.push_back(cluster);
+    }
+    return clusters;
+  }
+
+  /** Maps the points of the found clusters back to the ids of the input points */
+  static std::vector<std::vector<vtkIdType>> GetClusterIds(mitk::UnstructuredGridClusteringFilter *filter,
+                                                            vtkPoints *inputPoints)
+  {
+    std::vector<std::vector<vtkIdType>> clusters;
+    for (const auto &grid : filter->GetAllClusters())
+    {
+      vtkPoints *points = grid->GetVtkUnstructuredGrid()->GetPoints();
+      std::vector<vtkIdType> cluster;
+
+      // the points of a cluster are in the order of the input points
+      vtkIdType id = 0;
+      for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i, ++id)
+      {
+        double point[3];
+        double inputPoint[3];
+        points->GetPoint(i, point);
+        for (; id < inputPoints->GetNumberOfPoints(); ++id)
+        {
+          inputPoints->GetPoint(id, inputPoint);
+          if (vtkMath::Distance2BetweenPoints(point, inputPoint) == 0.0)
+            break;
+        }
+        cluster.push_back(id);
+      }
+      clusters.push_back(cluster);
+    }
+    return clusters;
+  }
+
 public:
   void setUp() override
   {
@@ -116,6 +247,91 @@ public:
     clusterFilter->Update();
     CPPUNIT_ASSERT_MESSAGE("Testing number of found clusters!", clusterFilter->GetNumberOfFoundClusters() == 17);
   }
+
+  void testClustersMatchSerialDBSCAN()
+  {
+    mitk::UnstructuredGrid::Pointer grid = CreatePointCloud(12, 250, 1500, 50.0);
+    vtkPoints *points = grid->GetVtkUnstructuredGrid()->GetPoints();
+
+    mitk::UnstructuredGridClusteringFilter::Pointer clusterFilter = mitk::UnstructuredGridClusteringFilter::New();
+    clusterFilter->SetInput(grid);
+    clusterFilter->SetMinPts(4);
+    clusterFilter->Seteps(1.5);
+    clusterFilter->Update();
+
+    const std::vector<std::vector<vtkIdType>> expected = ClusterSerially(points, 1.5, 4);
+    CPPUNIT_ASSERT_MESSAGE("Testing that clusters were found!", expected.size() > 1);
+    CPPUNIT_ASSERT_MESSAGE("Testing that the same clusters are found as by the serial algorithm!",
+                           GetClusterIds(clusterFilter, points) == expected);
+
+    std::size_t biggestCluster = 0;
+    for (const auto &cluster : expected)
+      biggestCluster = std::max(biggestCluster, cluster.size());
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(biggestCluster),
+                         clusterFilter->GetOutput()->GetVtkUnstructuredGrid()->GetNumberOfPoints());
+  }
+
+  void testClustersAreIndependentOfThreads()
+  {
+    mitk::UnstructuredGridClusteringFilter::Pointer singleThreaded = mitk::UnstructuredGridClusteringFilter::New();
+    singleThreaded->SetInput(m_UnstructuredGrid);
+    singleThreaded->SetMinPts(4);
+    singleThreaded->Seteps(1.2);
+    singleThreaded->SetNumberOfThreads(1);
+    singleThreaded->Update();
+
+    mitk::UnstructuredGridClusteringFilter::Pointer multiThreaded = mitk::UnstructuredGridClusteringFilter::New();
+    multiThreaded->SetInput(m_UnstructuredGrid);
+    multiThreaded->SetMinPts(4);
+    multiThreaded->Seteps(1.2);
+    multiThreaded->SetNumberOfThreads(8);
+    multiThreaded->Update();
+
+    vtkPoints *points = m_UnstructuredGrid->GetVtkUnstructuredGrid()->GetPoints();
+    CPPUNIT_ASSERT(GetClusterIds(singleThreaded, points) == GetClusterIds(multiThreaded, points));
+  }
+
+  void testNoClusterFound()
+  {
+    mitk::UnstructuredGridClusteringFilter::Pointer clusterFilter = mitk::UnstructuredGridClusteringFilter::New();
+    clusterFilter->SetInput(CreatePointCloud(0, 0, 100, 50.0));
+    clusterFilter->SetMinPts(4);
+    clusterFilter->Seteps(0.1);
+    clusterFilter->Update();
+
+    CPPUNIT_ASSERT_EQUAL(0, clusterFilter->GetNumberOfFoundClusters());
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(0),
+                         clusterFilter->GetOutput()->GetVtkUnstructuredGrid()->GetNumberOfPoints());
+  }
+
+  void testLargePointCloud()
+  {
+    mitk::UnstructuredGrid::Pointer grid = CreatePointCloud(40, 2500, 100000, 200.0);
+
+    std::vector<vtkIdType> clusterSizes[2];
+    const unsigned int numberOfThreads[2] = {1, 0};
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      mitk::UnstructuredGridClusteringFilter::Pointer clusterFilter = mitk::UnstructuredGridClusteringFilter::New();
+      clusterFilter->SetInput(grid);
+      clusterFilter->SetMinPts(4);
+      clusterFilter->Seteps(1.0);
+      clusterFilter->SetNumberOfThreads(numberOfThreads[i]);
+
+      const auto start = std::chrono::steady_clock::now();
+      clusterFilter->Update();
+      const std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+      MITK_INFO << "Clustering " << grid->GetVtkUnstructuredGrid()->GetNumberOfPoints() << " points with "
+                << (numberOfThreads[i] > 0 ? std::to_string(numberOfThreads[i]) : std::string("all"))
+                << " threads took " << duration.count() << " ms, found " << clusterFilter->GetNumberOfFoundClusters() << " clusters";
+
+      for (const auto &cluster : clusterFilter->GetAllClusters())
+        clusterSizes[i].push_back(cluster->GetVtkUnstructuredGrid()->GetNumberOfPoints());
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Testing that the blobs were found!", clusterSizes[0].size() >= 40);
+    CPPUNIT_ASSERT(clusterSizes[0] == clusterSizes[1]);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkUnstructuredGridClusteringFilter)
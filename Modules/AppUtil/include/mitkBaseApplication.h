@@ -94,6 +94,7 @@ namespace mitk
     static const QString ARG_REGISTRY_MULTI_LANGUAGE;
     static const QString ARG_SPLASH_IMAGE;
     static const QString ARG_STORAGE_DIR;
+    static const QString ARG_TRACE;
     static const QString ARG_XARGS;
 
     // BlueBerry specific plugin framework properties
@@ -15,6 +15,7 @@ found in the LICENSE file.
 #include <mitkExceptionMacro.h>
 #include <mitkLogMacros.h>
 #include <mitkProvisioningInfo.h>
+#include <mitkTrace.h>
 
 #include <QmitkSafeApplication.h>
 #include <QmitkSingleApplication.h>
@@ -92,6 +93,7 @@ namespace mitk
   const QString BaseApplication::ARG_REGISTRY_MULTI_LANGUAGE = "BlueBerry.registryMultiLanguage";
   const QString BaseApplication::ARG_SPLASH_IMAGE = "BlueBerry.splashscreen";
   const QString BaseApplication::ARG_STORAGE_DIR = "BlueBerry.storageDir";
+  const QString BaseApplication::ARG_TRACE = "trace";
   const QString BaseApplication::ARG_XARGS = "xargs";
 
   const QString BaseApplication::PROP_APPLICATION = "blueberry.application";
@@ -532,6 +534,10 @@ namespace mitk
     //    framework properties.
     d->initializeCTKPluginFrameworkProperties(this->config());
 
+    // 5.1 Start recording trace spans if a trace file is given on the command line
+    if (!d->getProperty(ARG_TRACE).isNull())
+      mitk::Trace::Start();
+
     // 6. Initialize splash screen if an image path is provided
     //    in the .ini file
     this->initializeSplashScreen(qApp);
@@ -575,6 +581,23 @@ namespace mitk
       pfw->waitForStop(10000);
     }
 
+    auto traceFileName = d->getProperty(ARG_TRACE);
+
+    if (!traceFileName.isNull())
+    {
+      mitk::Trace::Stop();
+
+      try
+      {
+        mitk::Trace::WriteChromeTrace(traceFileName.toString().toStdString());
+        MITK_INFO << "Trace written to " << traceFileName.toString().toStdString();
+      }
+      catch (const mitk::Exception &e)
+      {
+        MITK_ERROR << e.GetDescription();
+      }
+    }
+
     Poco::Util::Application::uninitialize();
   }
 
@@ -763,6 +786,10 @@ namespace mitk
   splashScreenOption.argument("<filename>").binding(ARG_SPLASH_IMAGE.toStdString());
   options.addOption(splashScreenOption);
 
+    Poco::Util::Option traceOption(ARG_TRACE.toStdString(), "", "record trace spans and write them as Chrome trace JSON on exit");
+    traceOption.argument("<filename>").binding(ARG_TRACE.toStdString());
+    options.addOption(traceOption);
+
     Poco::Util::Option xargsOption(ARG_XARGS.toStdString(), "", "Extended argument list");
     xargsOption.argument("<args>").binding(ARG_XARGS.toStdString());
     options.addOption(xargsOption);
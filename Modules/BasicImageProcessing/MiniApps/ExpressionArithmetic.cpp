@@ -0,0 +1,151 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkProperties.h"
+
+#include "mitkCommandLineParser.h"
+#include "mitkIOUtil.h"
+
+#include <mitkArithmeticExpression.h>
+
+#include <locale>
+#include <sstream>
+
+static bool ConvertToBool(std::map<std::string, us::Any> &data, std::string name)
+{
+  if (!data.count(name))
+  {
+    return false;
+  }
+  try {
+    return us::any_cast<bool>(data[name]);
+  }
+  catch ( const us::BadAnyCastException & )
+  {
+    return false;
+  }
+}
+
+/** Splits arguments of the form name=content */
+static bool SplitAssignment(const std::string &argument, std::string &name, std::string &content)
+{
+  const std::size_t position = argument.find('=');
+  if (position == std::string::npos || position == 0)
+  {
+    MITK_ERROR << "Expected name=content, got \"" << argument << "\"";
+    return false;
+  }
+  name = argument.substr(0, position);
+  content = argument.substr(position + 1);
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  mitkCommandLineParser parser;
+
+  parser.setTitle("Expression Arithmetic");
+  parser.setCategory("Basic Image Processing");
+  parser.setDescription("Evaluates an arithmetic expression for each voxel of one or more images in a single pass, "
+                        "for example --expression \"(a - b) / s * exp(-c)\" --images a=first.nrrd b=second.nrrd c=third.nrrd --values s=2.5");
+  parser.setContributor("German Cancer Research Center (DKFZ)");
+
+  parser.setArgumentPrefix("--","-");
+  // Add command line argument names
+  parser.addArgument("help", "h",mitkCommandLineParser::Bool, "Help:", "Show this help text");
+  parser.addArgument("expression", "e", mitkCommandLineParser::String, "Expression:", "Expression over the image and value variables, supports + - * / ^ ( ) and the functions abs, sqrt, square, exp, expneg, log, log10, sin, cos, tan, asin, acos, atan, pow, min, max", us::Any(), false);
+  parser.addArgument("images", "i", mitkCommandLineParser::StringList, "Input images:", "Images as name=file, for example a=image.nrrd", us::Any(), false);
+  parser.addArgument("values", "v", mitkCommandLineParser::StringList, "Input values:", "Values as name=value, for example s=2.5", us::Any(), true);
+  parser.addArgument("output", "o", mitkCommandLineParser::File, "Output file:", "Output file", us::Any(), false, false, false, mitkCommandLineParser::Output);
+
+  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type, otherwise the type of the first image in the expression", false, true);
+  parser.addArgument("threads", "t", mitkCommandLineParser::Int, "Threads", "Number of threads, 0 uses all hardware threads", 0, true);
+
+  std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+  if (parsedArgs.size()==0)
+      return EXIT_FAILURE;
+
+  // Show a help message
+  if ( parsedArgs.count("help") || parsedArgs.count("h"))
+  {
+    std::cout << parser.helpText();
+    return EXIT_SUCCESS;
+  }
+
+  std::string expressionString = us::any_cast<std::string>(parsedArgs["expression"]);
+  std::string outputFilename = us::any_cast<std::string>(parsedArgs["output"]);
+
+  std::map<std::string, mitk::Image::Pointer> images;
+  for (const auto &argument : us::any_cast<mitkCommandLineParser::StringContainerType>(parsedArgs["images"]))
+  {
+    std::string name;
+    std::string filename;
+    if (!SplitAssignment(argument, name, filename))
+      return EXIT_FAILURE;
+
+    auto nodes = mitk::IOUtil::Load(filename);
+    mitk::Image::Pointer image = nodes.empty() ? nullptr : dynamic_cast<mitk::Image*>(nodes[0].GetPointer());
+    if (image.IsNull())
+    {
+      MITK_ERROR << "No image loaded from " << filename;
+      return EXIT_FAILURE;
+    }
+    images[name] = image;
+  }
+
+  std::map<std::string, double> values;
+  if (parsedArgs.count("values"))
+  {
+    for (const auto &argument : us::any_cast<mitkCommandLineParser::StringContainerType>(parsedArgs["values"]))
+    {
+      std::string name;
+      std::string content;
+      if (!SplitAssignment(argument, name, content))
+        return EXIT_FAILURE;
+
+      std::istringstream stream(content);
+      stream.imbue(std::locale::classic());
+      double value = 0.0;
+      if (!(stream >> value))
+      {
+        MITK_ERROR << "Invalid value for " << name << ": " << content;
+        return EXIT_FAILURE;
+      }
+      values[name] = value;
+    }
+  }
+
+  bool resultAsDouble = ConvertToBool(parsedArgs, "as-double");
+  int numberOfThreads = parsedArgs.count("threads") ? us::any_cast<int>(parsedArgs["threads"]) : 0;
+  if (numberOfThreads < 0)
+  {
+    MITK_ERROR << "Invalid number of threads: " << numberOfThreads;
+    return EXIT_FAILURE;
+  }
+  MITK_INFO << "Output image as double: " << resultAsDouble;
+
+  try
+  {
+    mitk::ArithmeticExpression expression(expressionString);
+    MITK_INFO << " Start Doing Operation: " << expression.GetExpression();
+    mitk::Image::Pointer result = expression.Evaluate(images, values, resultAsDouble, static_cast<unsigned int>(numberOfThreads));
+    mitk::IOUtil::Save(result, outputFilename);
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_ERROR << e.GetDescription();
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkArithmeticExpression_h
+#define mitkArithmeticExpression_h
+
+#include <mitkImage.h>
+#include <MitkBasicImageProcessingExports.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /** \brief Evaluates an element-wise arithmetic expression over several images and values in one pass
+  *
+  * Instead of chaining the operations of ArithmeticOperation, which allocate and traverse a full
+  * image for every step, a formula like "(a - mean) / std * exp(-b / 2)" is parsed once and
+  * evaluated for blocks of voxels at a time. Only the output image is allocated.
+  *
+  * The expression supports numbers, variables, the operators + - * / ^ (power), parentheses and the
+  * functions abs, sqrt, square, exp, expneg, log, log10, sin, cos, tan, asin, acos, atan, pow, min and max.
+  * Variables are bound to images or values when the expression is evaluated. All images must have the
+  * same dimensions, they are read as scalars and the computation is done in double precision.
+  *
+  * Syntax errors are reported by an mitk::Exception on construction, unbound variables or
+  * incompatible images by an mitk::Exception on evaluation.
+  */
+  class MITKBASICIMAGEPROCESSING_EXPORT ArithmeticExpression
+  {
+  public:
+    explicit ArithmeticExpression(const std::string &expression);
+    ~ArithmeticExpression();
+
+    const std::string &GetExpression() const;
+
+    /** Names of the variables in the order of their first occurrence */
+    std::vector<std::string> GetVariableNames() const;
+
+    /** \brief Computes the expression for every voxel
+    *
+    * The output has the geometry of the first image variable of the expression. It is a double image
+    * if outputAsDouble is set, otherwise it has the pixel type of that image. numberOfThreads 0 uses
+    * all hardware threads.
+    */
+    Image::Pointer Evaluate(const std::map<std::string, Image::Pointer> &images,
+                            const std::map<std::string, double> &values = std::map<std::string, double>(),
+                            bool outputAsDouble = true,
+                            unsigned int numberOfThreads = 0) const;
+
+  private:
+    /** The parsed expression */
+    struct SyntaxTree;
+
+    std::string m_Expression;
+    std::unique_ptr<SyntaxTree> m_SyntaxTree;
+  };
+}
+#endif // mitkArithmeticExpression_h
@@ -0,0 +1,772 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkArithmeticExpression.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkImageIOBase.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <locale>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+  enum class Operation
+  {
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Power,
+    Minimum,
+    Maximum,
+    Negate,
+    Abs,
+    Sqrt,
+    Square,
+    Exp,
+    ExpNeg,
+    Log,
+    Log10,
+    Sin,
+    Cos,
+    Tan,
+    Asin,
+    Acos,
+    Atan
+  };
+
+  struct Function
+  {
+    const char *name;
+    Operation operation;
+    unsigned int numberOfArguments;
+  };
+
+  const Function Functions[] = {{"abs", Operation::Abs, 1},
+                                {"sqrt", Operation::Sqrt, 1},
+                                {"square", Operation::Square, 1},
+                                {"exp", Operation::Exp, 1},
+                                {"expneg", Operation::ExpNeg, 1},
+                                {"log", Operation::Log, 1},
+                                {"log10", Operation::Log10, 1},
+                                {"sin", Operation::Sin, 1},
+                                {"cos", Operation::Cos, 1},
+                                {"tan", Operation::Tan, 1},
+                                {"asin", Operation::Asin, 1},
+                                {"acos", Operation::Acos, 1},
+                                {"atan", Operation::Atan, 1},
+                                {"pow", Operation::Power, 2},
+                                {"min", Operation::Minimum, 2},
+                                {"max", Operation::Maximum, 2}};
+
+  double Apply(Operation operation, double a, double b)
+  {
+    switch (operation)
+    {
+      case Operation::Add:
+        return a + b;
+      case Operation::Subtract:
+        return a - b;
+      case Operation::Multiply:
+        return a * b;
+      case Operation::Divide:
+        return a / b;
+      case Operation::Power:
+        return std::pow(a, b);
+      case Operation::Minimum:
+        return std::min(a, b);
+      case Operation::Maximum:
+        return std::max(a, b);
+      case Operation::Negate:
+        return -a;
+      case Operation::Abs:
+        return std::abs(a);
+      case Operation::Sqrt:
+        return std::sqrt(a);
+      case Operation::Square:
+        return a * a;
+      case Operation::Exp:
+        return std::exp(a);
+      case Operation::ExpNeg:
+        return std::exp(-a);
+      case Operation::Log:
+        return std::log(a);
+      case Operation::Log10:
+        return std::log10(a);
+      case Operation::Sin:
+        return std::sin(a);
+      case Operation::Cos:
+        return std::cos(a);
+      case Operation::Tan:
+        return std::tan(a);
+      case Operation::Asin:
+        return std::asin(a);
+      case Operation::Acos:
+        return std::acos(a);
+      case Operation::Atan:
+        return std::atan(a);
+    }
+    return 0.0;
+  }
+
+  struct ExpressionNode
+  {
+    enum class Type
+    {
+      Number,
+      Variable,
+      Operation
+    };
+
+    Type type = Type::Number;
+    double value = 0.0;
+    std::string name;
+    Operation operation = Operation::Add;
+    std::vector<std::unique_ptr<ExpressionNode>> arguments;
+  };
+
+  typedef std::unique_ptr<ExpressionNode> NodePointer;
+
+  NodePointer MakeOperation(Operation operation, NodePointer first, NodePointer second = nullptr)
+  {
+    NodePointer node(new ExpressionNode);
+    node->type = ExpressionNode::Type::Operation;
+    node->operation = operation;
+    node->arguments.push_back(std::move(first));
+    if (second)
+      node->arguments.push_back(std::move(second));
+    return node;
+  }
+
+  /** Recursive descent parser, ^ binds stronger than an unary minus and is right associative */
+  class Parser
+  {
+  public:
+    explicit Parser(const std::string &expression) : m_Expression(expression), m_Position(0) {}
+
+    NodePointer Parse()
+    {
+      NodePointer root = this->ParseSum();
+      this->SkipWhitespace();
+      if (m_Position < m_Expression.size())
+        this->Fail("Unexpected character");
+      return root;
+    }
+
+  private:
+    void Fail(const std::string &message) const
+    {
+      mitkThrow() << message << " at position " << m_Position << " of expression \"" << m_Expression << "\"";
+    }
+
+    void SkipWhitespace()
+    {
+      while (m_Position < m_Expression.size() && std::isspace(static_cast<unsigned char>(m_Expression[m_Position])))
+        ++m_Position;
+    }
+
+    bool Accept(char character)
+    {
+      this->SkipWhitespace();
+      if (m_Position < m_Expression.size() && m_Expression[m_Position] == character)
+      {
+        ++m_Position;
+        return true;
+      }
+      return false;
+    }
+
+    void Expect(char character)
+    {
+      if (!this->Accept(character))
+        this->Fail(std::string("Expected '") + character + "'");
+    }
+
+    NodePointer ParseSum()
+    {
+      NodePointer node = this->ParseProduct();
+      while (true)
+      {
+        if (this->Accept('+'))
+          node = MakeOperation(Operation::Add, std::move(node), this->ParseProduct());
+        else if (this->Accept('-'))
+          node = MakeOperation(Operation::Subtract, std::move(node), this->ParseProduct());
+        else
+          return node;
+      }
+    }
+
+    NodePointer ParseProduct()
+    {
+      NodePointer node = this->ParseUnary();
+      while (true)
+      {
+        if (this->Accept('*'))
+          node = MakeOperation(Operation::Multiply, std::move(node), this->ParseUnary());
+        else if (this->Accept('/'))
+          node = MakeOperation(Operation::Divide, std::move(node), this->ParseUnary());
+        else
+          return node;
+      }
+    }
+
+    NodePointer ParseUnary()
+    {
+      if (this->Accept('-'))
+        return MakeOperation(Operation::Negate, this->ParseUnary());
+      if (this->Accept('+'))
+        return this->ParseUnary();
+      return this->ParsePower();
+    }
+
+    NodePointer ParsePower()
+    {
+      NodePointer node = this->ParsePrimary();
+      if (this->Accept('^'))
+        node = MakeOperation(Operation::Power, std::move(node), this->ParseUnary());
+      return node;
+    }
+
+    NodePointer ParsePrimary()
+    {
+      this->SkipWhitespace();
+      if (m_Position >= m_Expression.size())
+        this->Fail("Unexpected end");
+
+      if (this->Accept('('))
+      {
+        NodePointer node = this->ParseSum();
+        this->Expect(')');
+        return node;
+      }
+
+      const char character = m_Expression[m_Position];
+      if (std::isdigit(static_cast<unsigned char>(character)) || character == '.')
+        return this->ParseNumber();
+
+      if (std::isalpha(static_cast<unsigned char>(character)) || character == '_')
+      {
+        const std::size_t begin = m_Position;
+        while (m_Position < m_Expression.size() &&
+               (std::isalnum(static_cast<unsigned char>(m_Expression[m_Position])) || m_Expression[m_Position] == '_'))
+          ++m_Position;
+        const std::string name = m_Expression.substr(begin, m_Position - begin);
+
+        if (!this->Accept('('))
+        {
+          NodePointer node(new ExpressionNode);
+          node->type = ExpressionNode::Type::Variable;
+          node->name = name;
+          return node;
+        }
+
+        auto function = std::find_if(
+          std::begin(Functions), std::end(Functions), [&](const Function &f) { return name == f.name; });
+        if (function == std::end(Functions))
+          this->Fail("Unknown function \"" + name + "\"");
+
+        NodePointer node(new ExpressionNode);
+        node->type = ExpressionNode::Type::Operation;
+        node->operation = function->operation;
+        for (unsigned int i = 0; i < function->numberOfArguments; ++i)
+        {
+          if (i > 0)
+            this->Expect(',');
+          node->arguments.push_back(this->ParseSum());
+        }
+        this->Expect(')');
+        return node;
+      }
+
+      this->Fail("Unexpected character");
+      return nullptr;
+    }
+
+    NodePointer ParseNumber()
+    {
+      const std::size_t begin = m_Position;
+      while (m_Position < m_Expression.size() &&
+             (std::isdigit(static_cast<unsigned char>(m_Expression[m_Position])) || m_Expression[m_Position] == '.'))
+        ++m_Position;
+
+      if (m_Position < m_Expression.size() && (m_Expression[m_Position] == 'e' || m_Expression[m_Position] == 'E'))
+      {
+        std::size_t exponent = m_Position + 1;
+        if (exponent < m_Expression.size() && (m_Expression[exponent] == '+' || m_Expression[exponent] == '-'))
+          ++exponent;
+        if (exponent < m_Expression.size() && std::isdigit(static_cast<unsigned char>(m_Expression[exponent])))
+        {
+          m_Position = exponent;
+          while (m_Position < m_Expression.size() && std::isdigit(static_cast<unsigned char>(m_Expression[m_Position])))
+            ++m_Position;
+        }
+      }
+
+      // numbers are independent of the locale
+      std::istringstream stream(m_Expression.substr(begin, m_Position - begin));
+      stream.imbue(std::locale::classic());
+      NodePointer node(new ExpressionNode);
+      stream >> node->value;
+      if (stream.fail() || !stream.eof())
+      {
+        m_Position = begin;
+        this->Fail("Invalid number");
+      }
+      return node;
+    }
+
+    const std::string &m_Expression;
+    std::size_t m_Position;
+  };
+
+  void CollectVariables(const ExpressionNode &node, std::vector<std::string> &names)
+  {
+    if (node.type == ExpressionNode::Type::Variable && std::find(names.begin(), names.end(), node.name) == names.end())
+      names.push_back(node.name);
+    for (const auto &argument : node.arguments)
+      CollectVariables(*argument, names);
+  }
+
+  /** Number of voxels that are computed at once, the temporary values of a block stay in the cache */
+  const std::size_t BlockSize = 512;
+
+  /** Operand of an instruction, either a register holding a block of values or a constant */
+  struct Operand
+  {
+    int reg;
+    double value;
+  };
+
+  /** Computes target = operation(first, second), or loads an image into target if image is not negative */
+  struct Instruction
+  {
+    Operation operation;
+    int target;
+    Operand first;
+    Operand second;
+    int image;
+  };
+
+  typedef void (*LoadFunction)(const void *data, std::size_t begin, std::size_t count, double *values);
+  typedef void (*StoreFunction)(const double *values, std::size_t begin, std::size_t count, void *data);
+
+  template <typename TPixel>
+  void Load(const void *data, std::size_t begin, std::size_t count, double *values)
+  {
+    const TPixel *pixels = static_cast<const TPixel *>(data) + begin;
+    for (std::size_t i = 0; i < count; ++i)
+      values[i] = static_cast<double>(pixels[i]);
+  }
+
+  template <typename TPixel>
+  void Store(const double *values, std::size_t begin, std::size_t count, void *data)
+  {
+    TPixel *pixels = static_cast<TPixel *>(data) + begin;
+    for (std::size_t i = 0; i < count; ++i)
+      pixels[i] = static_cast<TPixel>(values[i]);
+  }
+
+  /** The expression translated to a sequence of operations on blocks of values
+  *
+  * Registers are assigned by the depth of a node in the tree, so that the number of blocks
+  * is small. Subexpressions without variables bound to images are folded into constants.
+  */
+  class Program
+  {
+  public:
+    Program(const ExpressionNode &root,
+            const std::map<std::string, std::size_t> &imageIndices,
+            const std::map<std::string, double> &values)
+      : m_ImageIndices(imageIndices), m_Values(values), m_NumberOfRegisters(0)
+    {
+      m_Result = this->Compile(root, 0);
+    }
+
+    bool IsConstant() const { return m_Result.reg < 0; }
+    double GetConstant() const { return m_Result.value; }
+
+    /** Computes count <= BlockSize values, registers must hold GetNumberOfRegisters() * BlockSize values */
+    void Execute(const std::vector<const void *> &images,
+                 const std::vector<LoadFunction> &loadFunctions,
+                 std::size_t begin,
+                 std::size_t count,
+                 double *registers) const
+    {
+      for (const auto &instruction : m_Instructions)
+      {
+        double *target = registers + instruction.target * BlockSize;
+        if (instruction.image >= 0)
+        {
+          loadFunctions[instruction.image](images[instruction.image], begin, count, target);
+        }
+        else
+        {
+          this->Apply(instruction, registers, count, target);
+        }
+      }
+    }
+
+    const double *GetResult(const double *registers) const { return registers + m_Result.reg * BlockSize; }
+
+    std::size_t GetNumberOfRegisters() const { return m_NumberOfRegisters; }
+
+  private:
+    Operand Compile(const ExpressionNode &node, int depth)
+    {
+      if (node.type == ExpressionNode::Type::Number)
+        return {-1, node.value};
+
+      if (node.type == ExpressionNode::Type::Variable)
+      {
+        auto value = m_Values.find(node.name);
+        if (value != m_Values.end())
+          return {-1, value->second};
+
+        auto image = m_ImageIndices.find(node.name);
+        if (image == m_ImageIndices.end())
+          mitkThrow() << "No image or value is given for the variable \"" << node.name << "\"";
+
+        this->UseRegister(depth);
+        m_Instructions.push_back({Operation::Add, depth, {-1, 0.0}, {-1, 0.0}, static_cast<int>(image->second)});
+        return {depth, 0.0};
+      }
+
+      Operand first = this->Compile(*node.arguments[0], depth);
+      Operand second = {-1, 0.0};
+      if (node.arguments.size() > 1)
+        second = this->Compile(*node.arguments[1], first.reg < 0 ? depth : depth + 1);
+
+      if (first.reg < 0 && second.reg < 0)
+        return {-1, ::Apply(node.operation, first.value, second.value)};
+
+      this->UseRegister(depth);
+      m_Instructions.push_back({node.operation, depth, first, second, -1});
+      return {depth, 0.0};
+    }
+
+    void UseRegister(int reg)
+    {
+      m_NumberOfRegisters = std::max(m_NumberOfRegisters, static_cast<std::size_t>(reg) + 1);
+    }
+
+    template <typename TOperation>
+    static void ApplyBinary(
+      const Instruction &instruction, const double *registers, std::size_t count, double *target, TOperation operation)
+    {
+      if (instruction.first.reg >= 0 && instruction.second.reg >= 0)
+      {
+        const double *first = registers + instruction.first.reg * BlockSize;
+        const double *second = registers + instruction.second.reg * BlockSize;
+        for (std::size_t i = 0; i < count; ++i)
+          target[i] = operation(first[i], second[i]);
+      }
+      else if (instruction.first.reg >= 0)
+      {
+        const double *first = registers + instruction.first.reg * BlockSize;
+        const double second = instruction.second.value;
+        for (std::size_t i = 0; i < count; ++i)
+          target[i] = operation(first[i], second);
+      }
+      else
+      {
+        const double first = instruction.first.value;
+        const double *second = registers + instruction.second.reg * BlockSize;
+        for (std::size_t i = 0; i < count; ++i)
+          target[i] = operation(first, second[i]);
+      }
+    }
+
+    template <typename TOperation>
+    static void ApplyUnary(const Instruction &instruction,
+                           const double *registers,
+                           std::size_t count,
+                           double *target,
+                           TOperation operation)
+    {
+      const double *first = registers + instruction.first.reg * BlockSize;
+      for (std::size_t i = 0; i < count; ++i)
+        target[i] = operation(first[i]);
+    }
+
+    void Apply(const Instruction &instruction, const double *registers, std::size_t count, double *target) const
+    {
+      // each operation is a simple loop over the block, which the compiler can vectorize
+      switch (instruction.operation)
+      {
+        case Operation::Add:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return a + b; });
+          break;
+        case Operation::Subtract:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return a - b; });
+          break;
+        case Operation::Multiply:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return a * b; });
+          break;
+        case Operation::Divide:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return a / b; });
+          break;
+        case Operation::Minimum:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return b < a ? b : a; });
+          break;
+        case Operation::Maximum:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return a < b ? b : a; });
+          break;
+        case Operation::Power:
+          ApplyBinary(instruction, registers, count, target, [](double a, double b) { return std::pow(a, b); });
+          break;
+        case Operation::Negate:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return -a; });
+          break;
+        case Operation::Square:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return a * a; });
+          break;
+        case Operation::Abs:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::abs(a); });
+          break;
+        case Operation::Sqrt:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::sqrt(a); });
+          break;
+        case Operation::Exp:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::exp(a); });
+          break;
+        case Operation::ExpNeg:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::exp(-a); });
+          break;
+        case Operation::Log:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::log(a); });
+          break;
+        case Operation::Log10:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::log10(a); });
+          break;
+        case Operation::Sin:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::sin(a); });
+          break;
+        case Operation::Cos:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::cos(a); });
+          break;
+        case Operation::Tan:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::tan(a); });
+          break;
+        case Operation::Asin:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::asin(a); });
+          break;
+        case Operation::Acos:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::acos(a); });
+          break;
+        case Operation::Atan:
+          ApplyUnary(instruction, registers, count, target, [](double a) { return std::atan(a); });
+          break;
+      }
+    }
+
+    const std::map<std::string, std::size_t> &m_ImageIndices;
+    const std::map<std::string, double> &m_Values;
+    std::vector<Instruction> m_Instructions;
+    std::size_t m_NumberOfRegisters;
+    Operand m_Result;
+  };
+
+  template <typename TPixel>
+  void GetAccessFunctions(LoadFunction &load, StoreFunction &store)
+  {
+    load = &Load<TPixel>;
+    store = &Store<TPixel>;
+  }
+
+  void GetAccessFunctions(const mitk::PixelType &pixelType, LoadFunction &load, StoreFunction &store)
+  {
+    if (pixelType.GetNumberOfComponents() != 1)
+      mitkThrow() << "Only scalar images are supported by mitk::ArithmeticExpression";
+
+    switch (pixelType.GetComponentType())
+    {
+      case itk::ImageIOBase::CHAR:
+        GetAccessFunctions<char>(load, store);
+        break;
+      case itk::ImageIOBase::UCHAR:
+        GetAccessFunctions<unsigned char>(load, store);
+        break;
+      case itk::ImageIOBase::SHORT:
+        GetAccessFunctions<short>(load, store);
+        break;
+      case itk::ImageIOBase::USHORT:
+        GetAccessFunctions<unsigned short>(load, store);
+        break;
+      case itk::ImageIOBase::INT:
+        GetAccessFunctions<int>(load, store);
+        break;
+      case itk::ImageIOBase::UINT:
+        GetAccessFunctions<unsigned int>(load, store);
+        break;
+      case itk::ImageIOBase::LONG:
+        GetAccessFunctions<long>(load, store);
+        break;
+      case itk::ImageIOBase::ULONG:
+        GetAccessFunctions<unsigned long>(load, store);
+        break;
+      case itk::ImageIOBase::LONGLONG:
+        GetAccessFunctions<long long>(load, store);
+        break;
+      case itk::ImageIOBase::ULONGLONG:
+        GetAccessFunctions<unsigned long long>(load, store);
+        break;
+      case itk::ImageIOBase::FLOAT:
+        GetAccessFunctions<float>(load, store);
+        break;
+      case itk::ImageIOBase::DOUBLE:
+        GetAccessFunctions<double>(load, store);
+        break;
+      default:
+        mitkThrow() << "Pixel type " << pixelType.GetComponentTypeAsString()
+                    << " is not supported by mitk::ArithmeticExpression";
+    }
+  }
+}
+
+struct mitk::ArithmeticExpression::SyntaxTree
+{
+  NodePointer root;
+};
+
+mitk::ArithmeticExpression::ArithmeticExpression(const std::string &expression)
+  : m_Expression(expression), m_SyntaxTree(new SyntaxTree)
+{
+  m_SyntaxTree->root = Parser(m_Expression).Parse();
+}
+
+mitk::ArithmeticExpression::~ArithmeticExpression()
+{
+}
+
+const std::string &mitk::ArithmeticExpression::GetExpression() const
+{
+  return m_Expression;
+}
+
+std::vector<std::string> mitk::ArithmeticExpression::GetVariableNames() const
+{
+  std::vector<std::string> names;
+  CollectVariables(*m_SyntaxTree->root, names);
+  return names;
+}
+
+mitk::Image::Pointer mitk::ArithmeticExpression::Evaluate(const std::map<std::string, Image::Pointer> &images,
+                                                          const std::map<std::string, double> &values,
+                                                          bool outputAsDouble,
+                                                          unsigned int numberOfThreads) const
+{
+  // the images of the expression in the order of their first occurrence, values take precedence over images
+  std::vector<Image::Pointer> inputs;
+  std::map<std::string, std::size_t> imageIndices;
+  for (const auto &name : this->GetVariableNames())
+  {
+    auto image = images.find(name);
+    if (values.count(name) == 0 && image != images.end())
+    {
+      if (image->second.IsNull())
+        mitkThrow() << "The image of variable \"" << name << "\" is null";
+      imageIndices[name] = inputs.size();
+      inputs.push_back(image->second);
+    }
+  }
+
+  const Program program(*m_SyntaxTree->root, imageIndices, values);
+  if (inputs.empty())
+    mitkThrow() << "The expression \"" << m_Expression << "\" does not contain an image";
+
+  const Image::Pointer reference = inputs.front();
+  for (const auto &input : inputs)
+  {
+    bool sameSize = input->GetDimension() == reference->GetDimension();
+    for (unsigned int i = 0; sameSize && i < reference->GetDimension(); ++i)
+      sameSize = input->GetDimension(i) == reference->GetDimension(i);
+    if (!sameSize)
+      mitkThrow() << "Images have different sizes. This is not supported by mitk::ArithmeticExpression";
+  }
+
+  std::vector<LoadFunction> loadFunctions(inputs.size());
+  std::vector<std::unique_ptr<ImageReadAccessor>> accessors;
+  std::vector<const void *> data;
+  for (std::size_t i = 0; i < inputs.size(); ++i)
+  {
+    StoreFunction store;
+    GetAccessFunctions(inputs[i]->GetPixelType(), loadFunctions[i], store);
+    accessors.emplace_back(new ImageReadAccessor(inputs[i]));
+    data.push_back(accessors.back()->GetData());
+  }
+
+  const PixelType outputPixelType = outputAsDouble ? MakeScalarPixelType<double>() : reference->GetPixelType();
+  LoadFunction load;
+  StoreFunction store;
+  GetAccessFunctions(outputPixelType, load, store);
+
+  Image::Pointer output = Image::New();
+  output->Initialize(outputPixelType, reference->GetDimension(), reference->GetDimensions());
+  output->SetTimeGeometry(reference->GetTimeGeometry()->Clone());
+
+  std::size_t numberOfPixels = 1;
+  for (unsigned int i = 0; i < reference->GetDimension(); ++i)
+    numberOfPixels *= reference->GetDimension(i);
+
+  ImageWriteAccessor outputAccessor(output);
+  void *outputData = outputAccessor.GetData();
+
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+  const std::size_t numberOfBlocks = (numberOfPixels + BlockSize - 1) / BlockSize;
+  numberOfThreads = static_cast<unsigned int>(std::min<std::size_t>(numberOfThreads, numberOfBlocks));
+
+  // the blocks are distributed in chunks to keep the synchronization cheap
+  const std::size_t blocksPerChunk = 16;
+  std::atomic<std::size_t> nextBlock(0);
+  auto worker = [&]() {
+    std::vector<double> registers(std::max<std::size_t>(program.GetNumberOfRegisters(), 1) * BlockSize);
+    for (std::size_t block = nextBlock.fetch_add(blocksPerChunk); block < numberOfBlocks;
+         block = nextBlock.fetch_add(blocksPerChunk))
+    {
+      const std::size_t endBlock = std::min(block + blocksPerChunk, numberOfBlocks);
+      for (; block < endBlock; ++block)
+      {
+        const std::size_t begin = block * BlockSize;
+        const std::size_t count = std::min(BlockSize, numberOfPixels - begin);
+        if (program.IsConstant())
+        {
+          std::fill(registers.begin(), registers.begin() + count, program.GetConstant());
+          store(registers.data(), begin, count, outputData);
+        }
+        else
+        {
+          program.Execute(data, loadFunctions, begin, count, registers.data());
+          store(program.GetResult(registers.data()), begin, count, outputData);
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &thread : threads)
+    thread.join();
+
+  return output;
+}
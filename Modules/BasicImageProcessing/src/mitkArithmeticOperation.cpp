@@ -11,6 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkArithmeticOperation.h"
+#include "mitkArithmeticExpression.h"
 
 #include <mitkImage.h>
 #include <mitkImageAccessByItk.h>
@@ -466,6 +467,11 @@ mitk::Image::Pointer mitk::ArithmeticOperation::Log10(Image::Pointer & imageA, b
   return resultImage;
 }
 
+mitk::Image::Pointer mitk::ArithmeticOperation::Evaluate(const std::string & expression, const std::map<std::string, Image::Pointer> & images, bool outputAsDouble)
+{
+  return ArithmeticExpression(expression).Evaluate(images, std::map<std::string, double>(), outputAsDouble);
+}
+
 
 void mitk::NonStaticArithmeticOperation::CallExecuteTwoImageFilter(mitk::Image::Pointer imageA, mitk::Image::Pointer imageB)
 {
@@ -512,19 +518,19 @@ void mitk::NonStaticArithmeticOperation::ExecuteTwoImageFilter(itk::Image<TPixel
 
   case OperationsEnum::Sub2:
     ExecuteTwoImageFilterWithFunctor<itk::Functor::Sub2<TPixel1, TPixel2, TPixel1>,
-      itk::Functor::Add2<TPixel1, TPixel2, double>,
+      itk::Functor::Sub2<TPixel1, TPixel2, double>,
       Image1Type, Image2Type, DoubleOutputType>(imageA, imageB);
     break;
 
   case OperationsEnum::Mult:
     ExecuteTwoImageFilterWithFunctor<itk::Functor::Mult<TPixel1, TPixel2, TPixel1>,
-      itk::Functor::Add2<TPixel1, TPixel2, double>,
+      itk::Functor::Mult<TPixel1, TPixel2, double>,
       Image1Type, Image2Type, DoubleOutputType>(imageA, imageB);
     break;
 
   case OperationsEnum::Div:
     ExecuteTwoImageFilterWithFunctor<itk::Functor::Div<TPixel1, TPixel2, TPixel1>,
-      itk::Functor::Add2<TPixel1, TPixel2, double>,
+      itk::Functor::Div<TPixel1, TPixel2, double>,
       Image1Type, Image2Type, DoubleOutputType>(imageA, imageB);
     break;
   default:
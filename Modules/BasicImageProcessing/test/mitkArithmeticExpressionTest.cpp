@@ -0,0 +1,234 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkArithmeticExpression.h>
+#include <mitkArithmeticOperation.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+
+#include <cmath>
+
+class mitkArithmeticExpressionTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkArithmeticExpressionTestSuite);
+
+  MITK_TEST(PrecedenceAndAssociativity);
+  MITK_TEST(MalformedExpressionsAreRejected);
+  MITK_TEST(UnboundVariablesAndIncompatibleImagesAreRejected);
+  MITK_TEST(ConstantSubexpressionsAreFolded);
+  MITK_TEST(MixedPixelTypes);
+  MITK_TEST(MatchesChainOfArithmeticOperations);
+  MITK_TEST(NumberOfThreadsDoesNotChangeResult);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  // 990 voxels, so that the last of the blocks of 512 voxels is incomplete
+  mitk::Image::Pointer m_Gradient;
+  mitk::Image::Pointer m_UCharImage;
+  mitk::Image::Pointer m_UShortImage;
+  mitk::Image::Pointer m_FloatImage;
+
+  template <typename TPixel>
+  static std::vector<double> GetValues(const mitk::Image::Pointer &image)
+  {
+    CPPUNIT_ASSERT(image->GetPixelType() == mitk::MakeScalarPixelType<TPixel>());
+    mitk::ImageReadAccessor accessor(image);
+    const auto *pixels = static_cast<const TPixel *>(accessor.GetData());
+    std::size_t numberOfPixels = 1;
+    for (unsigned int i = 0; i < image->GetDimension(); ++i)
+      numberOfPixels *= image->GetDimension(i);
+    return std::vector<double>(pixels, pixels + numberOfPixels);
+  }
+
+  static void AssertEqualValues(const std::vector<double> &expected, const std::vector<double> &actual)
+  {
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[i], actual[i], 1e-12 * (1.0 + std::abs(expected[i])));
+  }
+
+  static void AssertSyntaxError(const std::string &expression)
+  {
+    CPPUNIT_ASSERT_THROW_MESSAGE("Expression \"" + expression + "\" must be rejected",
+                                 mitk::ArithmeticExpression{expression},
+                                 mitk::Exception);
+  }
+
+  /** Checks that "a + (expression)" adds the given constant to every voxel of the gradient image */
+  void AssertConstant(const std::string &expression, double expected)
+  {
+    const mitk::ArithmeticExpression arithmeticExpression("a + (" + expression + ")");
+    const auto result = GetValues<double>(arithmeticExpression.Evaluate({{"a", m_Gradient}}));
+    const auto gradient = GetValues<float>(m_Gradient);
+    for (std::size_t i = 0; i < gradient.size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(expression, gradient[i] + expected, result[i], 1e-9);
+  }
+
+public:
+  void setUp() override
+  {
+    m_Gradient = mitk::ImageGenerator::GenerateGradientImage<float>(11, 10, 9);
+    m_UCharImage = mitk::ImageGenerator::GenerateRandomImage<unsigned char>(11, 10, 9, 1, 1, 1, 1, 100);
+    m_UShortImage = mitk::ImageGenerator::GenerateRandomImage<unsigned short>(11, 10, 9, 1, 1, 1, 1, 1000);
+    m_FloatImage = mitk::ImageGenerator::GenerateRandomImage<float>(11, 10, 9, 1, 1, 1, 1, 1.0, -1.0);
+  }
+
+  void tearDown() override
+  {
+    m_Gradient = nullptr;
+    m_UCharImage = nullptr;
+    m_UShortImage = nullptr;
+    m_FloatImage = nullptr;
+  }
+
+  void PrecedenceAndAssociativity()
+  {
+    // ^ binds stronger than the unary minus and is right associative
+    AssertConstant("-2^2", -4.0);
+    AssertConstant("2^3^2", 512.0);
+    AssertConstant("2^-1", 0.5);
+    AssertConstant("(-2)^2", 4.0);
+    AssertConstant("2*3^2", 18.0);
+    AssertConstant("2+3*4", 14.0);
+    AssertConstant("8-4-2", 2.0);
+    AssertConstant("8/4/2", 1.0);
+    AssertConstant("--3", 3.0);
+    AssertConstant("1.5e1 - 1E-1", 14.9);
+    AssertConstant("max(2, min(3, 1)) + pow(2, 3)", 10.0);
+
+    const auto gradient = GetValues<float>(m_Gradient);
+    const auto result = GetValues<double>(mitk::ArithmeticExpression("-a^2").Evaluate({{"a", m_Gradient}}));
+    for (std::size_t i = 0; i < gradient.size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(-double(gradient[i]) * gradient[i], result[i], 1e-9);
+  }
+
+  void MalformedExpressionsAreRejected()
+  {
+    AssertSyntaxError("");
+    AssertSyntaxError("(a + b");
+    AssertSyntaxError("((a + b) * c");
+    AssertSyntaxError("a + b)");
+    AssertSyntaxError("a +");
+    AssertSyntaxError("a * ");
+    AssertSyntaxError("a ^");
+    AssertSyntaxError("a b");
+    AssertSyntaxError("a $ b");
+    AssertSyntaxError("2..3");
+    AssertSyntaxError("unknown(a)");
+    AssertSyntaxError("min(a)");
+    AssertSyntaxError("sqrt(a, b)");
+  }
+
+  void UnboundVariablesAndIncompatibleImagesAreRejected()
+  {
+    const mitk::ArithmeticExpression expression("a + unknown");
+    CPPUNIT_ASSERT_THROW(expression.Evaluate({{"a", m_Gradient}}), mitk::Exception);
+
+    // an expression without any image has no geometry for the result
+    CPPUNIT_ASSERT_THROW(expression.Evaluate({}, {{"a", 1.0}, {"unknown", 2.0}}), mitk::Exception);
+
+    auto smallerImage = mitk::ImageGenerator::GenerateGradientImage<float>(11, 10, 8);
+    CPPUNIT_ASSERT_THROW(expression.Evaluate({{"a", m_Gradient}, {"unknown", smallerImage}}), mitk::Exception);
+
+    CPPUNIT_ASSERT_THROW(expression.Evaluate({{"a", m_Gradient}, {"unknown", nullptr}}), mitk::Exception);
+  }
+
+  void ConstantSubexpressionsAreFolded()
+  {
+    const mitk::ArithmeticExpression expression("(2 + 3) * a - sqrt(16) * s + s");
+    const std::vector<std::string> expectedNames = {"a", "s"};
+    CPPUNIT_ASSERT(expectedNames == expression.GetVariableNames());
+
+    const auto gradient = GetValues<float>(m_Gradient);
+    auto result = GetValues<double>(expression.Evaluate({{"a", m_Gradient}}, {{"s", 0.5}}));
+    for (std::size_t i = 0; i < gradient.size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0 * gradient[i] - 1.5, result[i], 1e-9);
+
+    // values take precedence over images of the same name
+    result = GetValues<double>(expression.Evaluate({{"a", m_Gradient}, {"s", m_FloatImage}}, {{"s", 0.5}}));
+    for (std::size_t i = 0; i < gradient.size(); ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(5.0 * gradient[i] - 1.5, result[i], 1e-9);
+  }
+
+  void MixedPixelTypes()
+  {
+    const auto a = GetValues<unsigned char>(m_UCharImage);
+    const auto b = GetValues<unsigned short>(m_UShortImage);
+    const auto c = GetValues<float>(m_FloatImage);
+
+    const mitk::ArithmeticExpression expression("a + b * c - b / (a + 1)");
+    std::vector<double> expected(a.size());
+    for (std::size_t i = 0; i < a.size(); ++i)
+      expected[i] = a[i] + b[i] * c[i] - b[i] / (a[i] + 1.0);
+
+    const std::map<std::string, mitk::Image::Pointer> images = {
+      {"a", m_UCharImage}, {"b", m_UShortImage}, {"c", m_FloatImage}};
+    AssertEqualValues(expected, GetValues<double>(expression.Evaluate(images)));
+
+    // without double output the result has the pixel type of the first image of the expression
+    const auto result = GetValues<unsigned char>(mitk::ArithmeticExpression("a / 2 + 1").Evaluate(images, {}, false));
+    for (std::size_t i = 0; i < a.size(); ++i)
+      CPPUNIT_ASSERT_EQUAL(static_cast<double>(static_cast<unsigned char>(a[i] / 2 + 1)), result[i]);
+
+    const auto shortResult =
+      GetValues<unsigned short>(mitk::ArithmeticExpression("b + a").Evaluate(images, {}, false));
+    for (std::size_t i = 0; i < a.size(); ++i)
+      CPPUNIT_ASSERT_EQUAL(a[i] + b[i], shortResult[i]);
+  }
+
+  void MatchesChainOfArithmeticOperations()
+  {
+    // the two image operations of ArithmeticOperation compute in the input pixel type, integral values keep them exact
+    mitk::Image::Pointer u = m_UShortImage;
+    mitk::Image::Pointer b = m_Gradient;
+    mitk::Image::Pointer c = m_FloatImage;
+    mitk::Image::Pointer a = mitk::ImageGenerator::GenerateRandomImage<float>(11, 10, 9, 1, 1, 1, 1, 100.0, 1.0);
+
+    // (u - b) / 2 * exp(c) + sqrt(a) * 3 - log10(a)
+    auto difference = mitk::ArithmeticOperation::Subtract(u, b);
+    auto halfDifference = mitk::ArithmeticOperation::Divide(difference, 2.0);
+    auto exponential = mitk::ArithmeticOperation::Exp(c);
+    auto product = mitk::ArithmeticOperation::Multiply(halfDifference, exponential);
+    auto root = mitk::ArithmeticOperation::Sqrt(a);
+    auto scaledRoot = mitk::ArithmeticOperation::Multiply(root, 3.0);
+    auto sum = mitk::ArithmeticOperation::Add(product, scaledRoot);
+    auto logarithm = mitk::ArithmeticOperation::Log10(a);
+    auto chain = mitk::ArithmeticOperation::Subtract(sum, logarithm);
+
+    const std::string expression = "(u - b) / 2 * exp(c) + sqrt(a) * 3 - log10(a)";
+    const std::map<std::string, mitk::Image::Pointer> images = {{"u", u}, {"b", b}, {"c", c}, {"a", a}};
+    const auto expected = GetValues<double>(chain);
+    AssertEqualValues(expected, GetValues<double>(mitk::ArithmeticExpression(expression).Evaluate(images)));
+    AssertEqualValues(expected, GetValues<double>(mitk::ArithmeticOperation::Evaluate(expression, images)));
+
+    // the result has the geometry of the first image of the expression
+    auto result = mitk::ArithmeticOperation::Evaluate(expression, images);
+    CPPUNIT_ASSERT(mitk::Equal(*u->GetGeometry(), *result->GetGeometry(), mitk::eps, mitk::eps, true));
+  }
+
+  void NumberOfThreadsDoesNotChangeResult()
+  {
+    const mitk::ArithmeticExpression expression("abs(c) * a + b ^ 0.5");
+    const std::map<std::string, mitk::Image::Pointer> images = {
+      {"a", m_UCharImage}, {"b", m_UShortImage}, {"c", m_FloatImage}};
+
+    const auto sequential = GetValues<double>(expression.Evaluate(images, {}, true, 1));
+    for (unsigned int numberOfThreads : {0u, 2u, 3u, 64u})
+      CPPUNIT_ASSERT(sequential == GetValues<double>(expression.Evaluate(images, {}, true, numberOfThreads)));
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkArithmeticExpression)
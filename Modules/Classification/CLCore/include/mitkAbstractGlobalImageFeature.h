@@ -219,6 +219,10 @@ public:
   itkSetMacro(EncodeParameters, bool);
   itkGetConstMacro(EncodeParameters, bool);
 
+  /** \brief Upper limit for the threads a feature class uses internally, 0 uses one thread per hardware core (default). */
+  itkSetMacro(NumberOfThreads, unsigned int);
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
   std::string GetOptionPrefix() const
   {
     if (m_Prefix.length() > 0)
@@ -282,6 +286,8 @@ private:
   bool m_IgnoreMask = false;
   bool m_CalculateWithParameter = false;
 
+  unsigned int m_NumberOfThreads = 0;
+
   mitk::Image::Pointer m_MorphMask = nullptr;
 //#endif // Skip Doxygen
 
@@ -0,0 +1,195 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkCommandLineParser.h"
+#include "mitkIOUtil.h"
+#include <mitkFeatureStore.h>
+#include <mitkVigraRandomForestClassifier.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <chrono>
+#include <fstream>
+#include <random>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+/// Peak resident memory of the process in MB
+static double GetPeakMemory()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+  return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+/// Two classes of normal distributed samples, which differ in the mean of every second feature
+static void GenerateChunk(std::mt19937 & generator, Eigen::MatrixXd & X, Eigen::MatrixXi & Y)
+{
+  std::normal_distribution<double> distribution;
+  for (Eigen::Index row = 0; row < X.rows(); ++row)
+  {
+    Y(row, 0) = 1 + row % 2;
+    for (Eigen::Index col = 0; col < X.cols(); ++col)
+      X(row, col) = distribution(generator) + ((row % 2 == 1 && col % 2 == 0) ? 1.0 : 0.0);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  mitkCommandLineParser parser;
+
+  parser.setTitle("Feature Store Benchmark");
+  parser.setCategory("Classification Command Tools");
+  parser.setDescription("Trains and applies a random forest on a synthetic cohort, either from an in-memory sample matrix or from a feature store, and reports run time and peak memory.");
+  parser.setContributor("German Cancer Research Center (DKFZ)");
+
+  parser.setArgumentPrefix("--", "-");
+  parser.addArgument("help", "h", mitkCommandLineParser::Bool, "Help:", "Show this help text");
+  parser.addArgument("samples", "n", mitkCommandLineParser::Int, "Samples:", "Number of samples of the cohort", us::Any(), false);
+  parser.addArgument("features", "f", mitkCommandLineParser::Int, "Features:", "Number of features per sample (default: 50)", us::Any(), true);
+  parser.addArgument("trees", "t", mitkCommandLineParser::Int, "Trees:", "Number of trees (default: 10)", us::Any(), true);
+  parser.addArgument("samples-per-tree", "spt", mitkCommandLineParser::Float, "Samples per tree:", "Fraction of samples drawn for each tree (default: 1.0)", us::Any(), true);
+  parser.addArgument("mode", "m", mitkCommandLineParser::String, "Mode:", "dense (sample matrix in memory) or store (default: store)", us::Any(), true);
+  parser.addArgument("memory-budget", "b", mitkCommandLineParser::Float, "Memory budget:", "Memory in MB for trees learned at the same time from the store (default: 0, one tree at a time)", us::Any(), true);
+  parser.addArgument("store", "s", mitkCommandLineParser::File, "Store:", "File of the feature store, a temporary file by default", us::Any(), true, false, false, mitkCommandLineParser::Output);
+  parser.addArgument("output", "o", mitkCommandLineParser::File, "Output file:", "CSV file the results are appended to", us::Any(), true, false, false, mitkCommandLineParser::Output);
+
+  std::map<std::string, us::Any> parsedArgs = parser.parseArguments(argc, argv);
+
+  if (parsedArgs.size() == 0)
+    return EXIT_FAILURE;
+
+  if (parsedArgs.count("help") || parsedArgs.count("h"))
+  {
+    std::cout << parser.helpText();
+    return EXIT_SUCCESS;
+  }
+
+  const int numberOfSamples = us::any_cast<int>(parsedArgs["samples"]);
+  const int numberOfFeatures = parsedArgs.count("features") ? us::any_cast<int>(parsedArgs["features"]) : 50;
+  const int numberOfTrees = parsedArgs.count("trees") ? us::any_cast<int>(parsedArgs["trees"]) : 10;
+  const float samplesPerTree = parsedArgs.count("samples-per-tree") ? us::any_cast<float>(parsedArgs["samples-per-tree"]) : 1.0f;
+  const std::string mode = parsedArgs.count("mode") ? us::any_cast<std::string>(parsedArgs["mode"]) : "store";
+  const float memoryBudget = parsedArgs.count("memory-budget") ? us::any_cast<float>(parsedArgs["memory-budget"]) : 0.0f;
+
+  if (mode != "dense" && mode != "store")
+  {
+    std::cout << "Unknown mode " << mode << std::endl << std::endl;
+    std::cout << parser.helpText();
+    return EXIT_FAILURE;
+  }
+
+  // small chunks, so writing the store does not dominate its peak memory
+  const int samplesPerChunk = 10000;
+  std::mt19937 generator(42);
+
+  auto classifier = mitk::VigraRandomForestClassifier::New();
+  classifier->SetTreeCount(numberOfTrees);
+  classifier->SetSamplesPerTree(samplesPerTree);
+  classifier->UseSampleWithReplacement(true);
+  classifier->SetStoreTrainingMemoryBudget(memoryBudget);
+
+  auto start = std::chrono::steady_clock::now();
+  double trainingTime = 0;
+  double predictionTime = 0;
+  Eigen::MatrixXi labels;
+
+  if (mode == "dense")
+  {
+    Eigen::MatrixXd X(numberOfSamples, numberOfFeatures);
+    Eigen::MatrixXi Y(numberOfSamples, 1);
+    GenerateChunk(generator, X, Y);
+
+    start = std::chrono::steady_clock::now();
+    classifier->Train(X, Y);
+    trainingTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    labels = classifier->Predict(X);
+    predictionTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  else
+  {
+    const bool isTemporary = parsedArgs.count("store") == 0;
+    const std::string fileName = isTemporary ? mitk::IOUtil::CreateTemporaryFile("FeatureStoreBenchmark_XXXXXX.fst") : us::any_cast<std::string>(parsedArgs["store"]);
+
+    // the cohort is written chunk by chunk, like one patient after the other
+    auto store = mitk::FeatureStore::New();
+    store->Create(fileName, numberOfFeatures);
+    for (int first = 0; first < numberOfSamples; first += samplesPerChunk)
+    {
+      const int count = std::min(samplesPerChunk, numberOfSamples - first);
+      Eigen::MatrixXd X(count, numberOfFeatures);
+      Eigen::MatrixXi Y(count, 1);
+      GenerateChunk(generator, X, Y);
+      store->Append(X, Y);
+    }
+    store->Close();
+
+    start = std::chrono::steady_clock::now();
+    classifier->Train(store);
+    trainingTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    labels = classifier->Predict(store);
+    predictionTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    store = nullptr;
+    if (isTemporary)
+      itksys::SystemTools::RemoveFile(fileName);
+  }
+
+  // the labels of the generated samples alternate, starting with 1
+  Eigen::Index correct = 0;
+  for (Eigen::Index row = 0; row < labels.rows(); ++row)
+    correct += labels(row, 0) == 1 + row % 2 ? 1 : 0;
+  const double accuracy = labels.rows() > 0 ? correct / static_cast<double>(labels.rows()) : 0.0;
+  const double peakMemory = GetPeakMemory();
+
+  std::cout << "Mode: " << mode << std::endl;
+  std::cout << "Samples: " << numberOfSamples << " x " << numberOfFeatures << " features" << std::endl;
+  std::cout << "Training time [s]: " << trainingTime << std::endl;
+  std::cout << "Prediction time [s]: " << predictionTime << std::endl;
+  std::cout << "Accuracy: " << accuracy << std::endl;
+  std::cout << "Peak memory [MB]: " << peakMemory << std::endl;
+
+  if (parsedArgs.count("output"))
+  {
+    const std::string outputFile = us::any_cast<std::string>(parsedArgs["output"]);
+    const bool writeHeader = !itksys::SystemTools::FileExists(outputFile);
+    std::ofstream output(outputFile, std::ios::app);
+    if (writeHeader)
+      output << "Mode;Samples;Features;Trees;SamplesPerTree;TrainingTime;PredictionTime;Accuracy;PeakMemoryMB" << std::endl;
+    output << mode << ";" << numberOfSamples << ";" << numberOfFeatures << ";" << numberOfTrees << ";" << samplesPerTree << ";"
+           << trainingTime << ";" << predictionTime << ";" << accuracy << ";" << peakMemory << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
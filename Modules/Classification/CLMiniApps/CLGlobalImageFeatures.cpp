@@ -38,6 +38,7 @@ found in the LICENSE file.
 #include <mitkGIFIntensityVolumeHistogramFeatures.h>
 #include <mitkGIFNeighbourhoodGreyToneDifferenceFeatures.h>
 #include <mitkGIFNeighbouringGreyLevelDependenceFeatures.h>
+#include <mitkGlobalImageFeatureEngine.h>
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 #include <mitkITKImageImport.h>
@@ -49,10 +50,6 @@ found in the LICENSE file.
 #include <iostream>
 #include <locale>
 
-#include <itkImageDuplicator.h>
-#include <itkImageRegionIterator.h>
-
-
 #include "itkNearestNeighborInterpolateImageFunction.h"
 #include "itkResampleImageFilter.h"
 
@@ -111,46 +108,6 @@ ResampleImage(itk::Image<TPixel, VImageDimension>* itkImage, float resolution, m
 }
 
 
-template<typename TPixel, unsigned int VImageDimension>
-static void
-CreateNoNaNMask(itk::Image<TPixel, VImageDimension>* itkValue, mitk::Image::Pointer mask, mitk::Image::Pointer& newMask)
-{
-  typedef itk::Image< TPixel, VImageDimension>                 LFloatImageType;
-  typedef itk::Image< unsigned short, VImageDimension>          LMaskImageType;
-  typename LMaskImageType::Pointer itkMask = LMaskImageType::New();
-
-  mitk::CastToItkImage(mask, itkMask);
-
-  typedef itk::ImageDuplicator< LMaskImageType > DuplicatorType;
-  typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage(itkMask);
-  duplicator->Update();
-
-  auto tmpMask = duplicator->GetOutput();
-
-  itk::ImageRegionIterator<LMaskImageType> mask1Iter(itkMask, itkMask->GetLargestPossibleRegion());
-  itk::ImageRegionIterator<LMaskImageType> mask2Iter(tmpMask, tmpMask->GetLargestPossibleRegion());
-  itk::ImageRegionIterator<LFloatImageType> imageIter(itkValue, itkValue->GetLargestPossibleRegion());
-  while (!mask1Iter.IsAtEnd())
-  {
-    mask2Iter.Set(0);
-    if (mask1Iter.Value() > 0)
-    {
-      // Is not NaN
-      if (imageIter.Value() == imageIter.Value())
-      {
-        mask2Iter.Set(1);
-      }
-    }
-    ++mask1Iter;
-    ++mask2Iter;
-    ++imageIter;
-  }
-
-  newMask->InitializeByItk(tmpMask);
-  mitk::GrabItkImageMemory(tmpMask, newMask);
-}
-
 template<typename TPixel, unsigned int VImageDimension>
 static void
 ResampleMask(itk::Image<TPixel, VImageDimension>* itkMoving, mitk::Image::Pointer ref, mitk::Image::Pointer& newMask)
@@ -177,11 +134,10 @@ ResampleMask(itk::Image<TPixel, VImageDimension>* itkMoving, mitk::Image::Pointe
 
 static void
 ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
-                        mitk::Image::Pointer maskNoNaN, mitk::Image::Pointer morphMask,
+                        mitk::Image::Pointer morphMask,
                         int direction,
                         std::vector<mitk::Image::Pointer> &imageVector,
                         std::vector<mitk::Image::Pointer> &maskVector,
-                        std::vector<mitk::Image::Pointer> &maskNoNaNVector,
                         std::vector<mitk::Image::Pointer> &morphMaskVector)
 {
   typedef itk::Image< double, 2 >                 FloatImage2DType;
@@ -189,10 +145,8 @@ ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
 
   FloatImageType::Pointer itkFloat = FloatImageType::New();
   MaskImageType::Pointer itkMask = MaskImageType::New();
-  MaskImageType::Pointer itkMaskNoNaN = MaskImageType::New();
   MaskImageType::Pointer itkMorphMask = MaskImageType::New();
   mitk::CastToItkImage(mask, itkMask);
-  mitk::CastToItkImage(maskNoNaN, itkMaskNoNaN);
   mitk::CastToItkImage(image, itkFloat);
   mitk::CastToItkImage(morphMask, itkMorphMask);
 
@@ -239,10 +193,6 @@ ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
     mask2D->SetRegions(region);
     mask2D->Allocate();
 
-    MaskImage2DType::Pointer masnNoNaN2D = MaskImage2DType::New();
-    masnNoNaN2D->SetRegions(region);
-    masnNoNaN2D->Allocate();
-
     MaskImage2DType::Pointer morph2D = MaskImage2DType::New();
     morph2D->SetRegions(region);
     morph2D->Allocate();
@@ -261,7 +211,6 @@ ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
         index2D[1] = b;
         image2D->SetPixel(index2D, itkFloat->GetPixel(index3D));
         mask2D->SetPixel(index2D, itkMask->GetPixel(index3D));
-        masnNoNaN2D->SetPixel(index2D, itkMaskNoNaN->GetPixel(index3D));
         morph2D->SetPixel(index2D, itkMorphMask->GetPixel(index3D));
         voxelsInMask += (itkMask->GetPixel(index3D) > 0) ? 1 : 0;
 
@@ -270,7 +219,6 @@ ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
 
     image2D->SetSpacing(spacing2D);
     mask2D->SetSpacing(spacing2D);
-    masnNoNaN2D->SetSpacing(spacing2D);
     morph2D->SetSpacing(spacing2D);
 
     mitk::Image::Pointer tmpFloatImage = mitk::Image::New();
@@ -281,10 +229,6 @@ ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
     tmpMaskImage->InitializeByItk(mask2D.GetPointer());
     mitk::GrabItkImageMemory(mask2D, tmpMaskImage);
 
-    mitk::Image::Pointer tmpMaskNoNaNImage = mitk::Image::New();
-    tmpMaskNoNaNImage->InitializeByItk(masnNoNaN2D.GetPointer());
-    mitk::GrabItkImageMemory(masnNoNaN2D, tmpMaskNoNaNImage);
-
     mitk::Image::Pointer tmpMorphMaskImage = mitk::Image::New();
     tmpMorphMaskImage->InitializeByItk(morph2D.GetPointer());
     mitk::GrabItkImageMemory(morph2D, tmpMorphMaskImage);
@@ -293,7 +237,6 @@ ExtractSlicesFromImages(mitk::Image::Pointer image, mitk::Image::Pointer mask,
     {
       imageVector.push_back(tmpFloatImage);
       maskVector.push_back(tmpMaskImage);
-      maskNoNaNVector.push_back(tmpMaskNoNaNImage);
       morphMaskVector.push_back(tmpMorphMaskImage);
     }
   }
@@ -358,7 +301,8 @@ void SaveSliceOrImageAsPNG(mitk::Image::Pointer image, mitk::Image::Pointer mask
   }
 }
 
-int main(int argc, char* argv[])
+static std::vector<mitk::AbstractGlobalImageFeature::Pointer>
+CreateFeatureCalculators()
 {
   // Commented : Updated to a common interface, include, if possible, mask is type unsigned short, uses Quantification, Comments
   //                                 Name follows standard scheme with Class Name::Feature Name
@@ -398,6 +342,41 @@ int main(int argc, char* argv[])
   features.push_back(ipCalculator.GetPointer());
   features.push_back(ngtdCalculator.GetPointer());
 
+  return features;
+}
+
+static void
+ConfigureFeatureCalculators(std::vector<mitk::AbstractGlobalImageFeature::Pointer> &features,
+                            const mitk::cl::GlobalImageFeaturesParameter &param,
+                            const std::map<std::string, us::Any> &parsedArgs,
+                            int direction)
+{
+  for (auto cFeature : features)
+  {
+    if (param.defineGlobalMinimumIntensity)
+    {
+      cFeature->SetMinimumIntensity(param.globalMinimumIntensity);
+      cFeature->SetUseMinimumIntensity(true);
+    }
+    if (param.defineGlobalMaximumIntensity)
+    {
+      cFeature->SetMaximumIntensity(param.globalMaximumIntensity);
+      cFeature->SetUseMaximumIntensity(true);
+    }
+    if (param.defineGlobalNumberOfBins)
+    {
+      cFeature->SetBins(param.globalNumberOfBins);
+    }
+    cFeature->SetParameter(parsedArgs);
+    cFeature->SetDirection(direction);
+    cFeature->SetEncodeParameters(param.encodeParameter);
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::vector<mitk::AbstractGlobalImageFeature::Pointer> features = CreateFeatureCalculators();
+
   mitkCommandLineParser parser;
   parser.setArgumentPrefix("--", "-");
   mitk::cl::GlobalImageFeaturesParameter param;
@@ -414,6 +393,7 @@ int main(int argc, char* argv[])
   parser.addArgument("direction", "dir", mitkCommandLineParser::String, "Int", "Allows to specify the direction for Cooc and RL. 0: All directions, 1: Only single direction (Test purpose), 2,3,4... Without dimension 0,1,2... ", us::Any());
   parser.addArgument("slice-wise", "slice", mitkCommandLineParser::String, "Int", "Allows to specify if the image is processed slice-wise (number giving direction) ", us::Any());
   parser.addArgument("output-mode", "omode", mitkCommandLineParser::Int, "Int", "Defines if the results of an image / slice are written in a single row (0 , default) or column (1).");
+  parser.addArgument("threads", "threads", mitkCommandLineParser::Int, "Int", "Number of threads used to calculate the features of the image / slices (1, default). 0 uses all cores.");
 
   // Miniapp Infos
   parser.setCategory("Classification Tools");
@@ -550,11 +530,11 @@ int main(int argc, char* argv[])
     direction = mitk::cl::splitDouble(parsedArgs["direction"].ToString(), ';')[0];
   }
 
-  MITK_INFO << "Start creating Mask without NaN";
-
-  mitk::Image::Pointer maskNoNaN = mitk::Image::New();
-  AccessByItk_2(image, CreateNoNaNMask,  mask, maskNoNaN);
-  //CreateNoNaNMask(mask, image, maskNoNaN);
+  unsigned int numberOfThreads = 1;
+  if (parsedArgs.count("threads"))
+  {
+    numberOfThreads = us::any_cast<int>(parsedArgs["threads"]);
+  }
 
 
   bool sliceWise = false;
@@ -564,7 +544,6 @@ int main(int argc, char* argv[])
 
   std::vector<mitk::Image::Pointer> floatVector;
   std::vector<mitk::Image::Pointer> maskVector;
-  std::vector<mitk::Image::Pointer> maskNoNaNVector;
   std::vector<mitk::Image::Pointer> morphMaskVector;
 
   if ((parsedArgs.count("slice-wise")) && image->GetDimension() > 2)
@@ -573,32 +552,18 @@ int main(int argc, char* argv[])
     sliceWise = true;
     sliceDirection = mitk::cl::splitDouble(parsedArgs["slice-wise"].ToString(), ';')[0];
     MITK_INFO << sliceDirection;
-    ExtractSlicesFromImages(image, mask, maskNoNaN, morphMask, sliceDirection, floatVector, maskVector, maskNoNaNVector, morphMaskVector);
+    ExtractSlicesFromImages(image, mask, morphMask, sliceDirection, floatVector, maskVector, morphMaskVector);
     MITK_INFO << "Slice";
   }
 
   log << " Configure features -";
-  for (auto cFeature : features)
+  // Every worker thread of the engine uses its own, identically configured calculators
+  auto createConfiguredFeatureCalculators = [&]()
   {
-    if (param.defineGlobalMinimumIntensity)
-    {
-      cFeature->SetMinimumIntensity(param.globalMinimumIntensity);
-      cFeature->SetUseMinimumIntensity(true);
-    }
-    if (param.defineGlobalMaximumIntensity)
-    {
-      cFeature->SetMaximumIntensity(param.globalMaximumIntensity);
-      cFeature->SetUseMaximumIntensity(true);
-    }
-    if (param.defineGlobalNumberOfBins)
-    {
-      cFeature->SetBins(param.globalNumberOfBins);
-      MITK_INFO << param.globalNumberOfBins;
-    }
-    cFeature->SetParameter(parsedArgs);
-    cFeature->SetDirection(direction);
-    cFeature->SetEncodeParameters(param.encodeParameter);
-  }
+    auto calculators = CreateFeatureCalculators();
+    ConfigureFeatureCalculators(calculators, param, parsedArgs, direction);
+    return calculators;
+  };
 
   bool addDescription = parsedArgs.count("description");
   mitk::cl::FeatureResultWritter writer(param.outputPath, writeDirection);
@@ -616,8 +581,6 @@ int main(int argc, char* argv[])
 
   mitk::Image::Pointer cImage = image;
   mitk::Image::Pointer cMask = mask;
-  mitk::Image::Pointer cMaskNoNaN = maskNoNaN;
-  mitk::Image::Pointer cMorphMask = morphMask;
 
   if (param.useHeader)
   {
@@ -636,14 +599,32 @@ int main(int argc, char* argv[])
   std::vector<mitk::AbstractGlobalImageFeature::FeatureListType> allStats;
 
   log << " Begin Processing -";
+  std::vector<mitk::GlobalImageFeatureEngine::Case> cases;
+  if (sliceWise)
+  {
+    for (std::size_t i = 0; i < floatVector.size(); ++i)
+    {
+      cases.push_back({ floatVector[i], maskVector[i], morphMaskVector[i] });
+    }
+  }
+  else
+  {
+    cases.push_back({ image, mask, morphMask });
+  }
+
+  mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+  engine->SetFeatureSetFactory(createConfiguredFeatureCalculators);
+  engine->SetNumberOfThreads(numberOfThreads);
+
+  log << " Calculating features -";
+  std::vector<mitk::AbstractGlobalImageFeature::FeatureListType> caseStats = engine->CalculateFeatures(cases);
+
   while (imageToProcess)
   {
     if (sliceWise)
     {
       cImage = floatVector[currentSlice];
       cMask = maskVector[currentSlice];
-      cMaskNoNaN = maskNoNaNVector[currentSlice];
-      cMorphMask = morphMaskVector[currentSlice];
       imageToProcess = (floatVector.size()-1 > (currentSlice)) ? true : false ;
     }
     else
@@ -664,14 +645,7 @@ int main(int argc, char* argv[])
       mitk::IOUtil::Save(cMask, param.analysisMaskPath);
     }
 
-    mitk::AbstractGlobalImageFeature::FeatureListType stats;
-
-    for (auto cFeature : features)
-    {
-      log << " Calculating " << cFeature->GetFeatureClassName() << " -";
-      cFeature->SetMorphMask(cMorphMask);
-      cFeature->CalculateFeaturesUsingParameters(cImage, cMask, cMaskNoNaN, stats);
-    }
+    const mitk::AbstractGlobalImageFeature::FeatureListType &stats = caseStats[currentSlice];
 
     for (std::size_t i = 0; i < stats.size(); ++i)
     {
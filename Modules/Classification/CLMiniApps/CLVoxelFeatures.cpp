@@ -29,6 +29,7 @@ found in the LICENSE file.
 #include <itkMultiHistogramFilter.h>
 #include <itkSubtractImageFilter.h>
 #include <itkLocalStatisticFilter.h>
+#include <mitkLocalFeatureMapEngine.h>
 
 static std::vector<double> splitDouble(std::string str, char delimiter) {
   std::vector<double> internal;
@@ -243,6 +244,8 @@ int main(int argc, char* argv[])
   parser.addArgument("local-histogram", "lh", mitkCommandLineParser::String, "Local Histograms", "Calculate the local histogram based feature. Specify Offset and Delta, for exampel -3;0.6 ", us::Any());
   parser.addArgument("local-histogram2", "lh2", mitkCommandLineParser::String, "Local Histograms", "Calculate the local histogram based feature. Specify Minimum;Maximum;Bins, for exampel -3;3;6 ", us::Any());
   parser.addArgument("local-statistic", "ls", mitkCommandLineParser::String, "Local Histograms", "Calculate the local histogram based feature. Specify Offset and Delta, for exampel -3;0.6 ", us::Any());
+  parser.addArgument("local-texture", "lt", mitkCommandLineParser::String, "Local Texture Features", "Calculate local first order and co-occurrence features. Specify Radius;Bins, for example 2;32 ", us::Any());
+  parser.addArgument("threads", "t", mitkCommandLineParser::Int, "Threads", "Number of threads used for the local texture features, 0 uses all cores (default)", us::Any());
   // Miniapp Infos
   parser.setCategory("Classification Tools");
   parser.setTitle("Global Image Feature calculator");
@@ -343,6 +346,35 @@ int main(int argc, char* argv[])
   }
 
 
+  ////////////////////////////////////////////////////////////////
+  // CAlculate Local Texture Features
+  ////////////////////////////////////////////////////////////////
+  MITK_INFO << "Check for Local Texture Features...";
+  if (parsedArgs.count("local-texture"))
+  {
+    auto ranges = splitDouble(parsedArgs["local-texture"].ToString(), ';');
+    if (ranges.size() < 2)
+    {
+      MITK_INFO << "Missing Radius and Bins for Local Texture Features";
+    }
+    else
+    {
+      auto engine = mitk::LocalFeatureMapEngine::New();
+      engine->SetRadius(ranges[0]);
+      engine->SetBins(ranges[1]);
+      if (parsedArgs.count("threads"))
+        engine->SetNumberOfThreads(us::any_cast<int>(parsedArgs["threads"]));
+
+      auto outs = mitk::LocalFeatureMapEngine::SplitFeatureMap(engine->CalculateFeatureMap(image));
+      for (std::size_t i = 0; i < outs.size(); ++i)
+      {
+        std::string name = filename + "-ltex" + us::any_value_to_string<int>(ranges[0]) + "_" + us::any_value_to_string<int>(i) + extension;
+        mitk::IOUtil::Save(outs[i], name);
+      }
+    }
+  }
+
+
   ////////////////////////////////////////////////////////////////
   // CAlculate Gaussian Features
   ////////////////////////////////////////////////////////////////
@@ -9,6 +9,7 @@ set(CPP_FILES
 
   Features/itkNeighborhoodFunctorImageFilter.cpp
   Features/itkLineHistogramBasedMassImageFilter.cpp
+  Features/mitkLocalFeatureMapEngine.cpp
 
   GlobalImageFeatures/mitkGIFCooccurenceMatrix.cpp
   GlobalImageFeatures/mitkGIFCooccurenceMatrix2.cpp
@@ -27,11 +28,13 @@ set(CPP_FILES
   GlobalImageFeatures/mitkGIFIntensityVolumeHistogramFeatures.cpp
   GlobalImageFeatures/mitkGIFNeighbourhoodGreyToneDifferenceFeatures.cpp
   GlobalImageFeatures/mitkGIFCurvatureStatistic.cpp
+  GlobalImageFeatures/mitkGlobalImageFeatureEngine.cpp
 
   MiniAppUtils/mitkGlobalImageFeaturesParameter.cpp
   MiniAppUtils/mitkSplitParameterToVector.cpp
 
   mitkCLUtil.cpp
+  mitkFeatureStore.cpp
 
 )
 
@@ -32,11 +32,12 @@ found in the LICENSE file.
 
 #include "itkEnhancedScalarImageToRunLengthMatrixFilter.h"
 
-#include "itkConstNeighborhoodIterator.h"
-#include "itkNeighborhood.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "vnl/vnl_math.h"
 #include "itkMacro.h"
 
+#include <algorithm>
+
 namespace itk
 {
   namespace Statistics
@@ -168,11 +169,42 @@ namespace itk
       // Iterate over all of those pixels and offsets, adding each
       // distance/intensity pair to the histogram
 
-      typedef ConstNeighborhoodIterator<ImageType> NeighborhoodIteratorType;
-      typename NeighborhoodIteratorType::RadiusType radius;
-      radius.Fill( 1 );
-      NeighborhoodIteratorType neighborIt( radius,
-        inputImage, inputImage->GetRequestedRegion() );
+      // Run centers and all pixels of a run have to be inside of the mask,
+      // so only the bounding box of the mask has to be visited. The pixels
+      // are still visited in the same order, which keeps the runs identical.
+      RegionType region = inputImage->GetRequestedRegion();
+      if ( this->GetMaskImage() )
+      {
+        IndexType lower = region.GetUpperIndex();
+        IndexType upper = region.GetIndex();
+        bool maskIsEmpty = true;
+        typedef ImageRegionConstIteratorWithIndex<ImageType> MaskIteratorType;
+        for ( MaskIteratorType maskIt( this->GetMaskImage(), region ); !maskIt.IsAtEnd(); ++maskIt )
+        {
+          if ( maskIt.Get() == this->m_InsidePixelValue )
+          {
+            const IndexType maskIndex = maskIt.GetIndex();
+            for ( unsigned int i = 0; i < ImageDimension; ++i )
+            {
+              lower[i] = std::min( lower[i], maskIndex[i] );
+              upper[i] = std::max( upper[i], maskIndex[i] );
+            }
+            maskIsEmpty = false;
+          }
+        }
+        if ( maskIsEmpty )
+        {
+          return;
+        }
+        region.SetIndex( lower );
+        for ( unsigned int i = 0; i < ImageDimension; ++i )
+        {
+          region.SetSize( i, upper[i] - lower[i] + 1 );
+        }
+      }
+
+      typedef ImageRegionConstIteratorWithIndex<ImageType> IteratorType;
+      IteratorType neighborIt( inputImage, region );
 
       // this temp image has the same dimension for each offset
       // moving the allocation out of loop of offsets
@@ -180,7 +212,7 @@ namespace itk
       typedef Image<bool, ImageDimension> BoolImageType;
       typename BoolImageType::Pointer alreadyVisitedImage = BoolImageType::New();
       alreadyVisitedImage->CopyInformation( inputImage );
-      alreadyVisitedImage->SetRegions( inputImage->GetRequestedRegion() );
+      alreadyVisitedImage->SetRegions( region );
       alreadyVisitedImage->Allocate();
 
       typename OffsetVector::ConstIterator offsets;
@@ -196,7 +228,7 @@ namespace itk
 
         for( neighborIt.GoToBegin(); !neighborIt.IsAtEnd(); ++neighborIt )
         {
-          const PixelType centerPixelIntensity = neighborIt.GetCenterPixel();
+          const PixelType centerPixelIntensity = neighborIt.Get();
           if (centerPixelIntensity != centerPixelIntensity) // Check for invalid values
           {
             continue;
@@ -234,7 +266,7 @@ namespace itk
           // length of continuous pixels whose pixel values are
           // in the same bin.
 
-          while ( inputImage->GetRequestedRegion().IsInside(index) )
+          while ( region.IsInside(index) )
           {
             pixelIntensity = inputImage->GetPixel(index);
             // For the same offset, each run length segment can
@@ -281,7 +313,7 @@ namespace itk
           IndexType lastGoodIndex2 = lastGoodIndex;
           index = centerIndex - offset;
           lastGoodIndex = centerIndex;
-          while ( inputImage->GetRequestedRegion().IsInside(index) )
+          while ( region.IsInside(index) )
           {
             pixelIntensity = inputImage->GetPixel(index);
             if (pixelIntensity != pixelIntensity)
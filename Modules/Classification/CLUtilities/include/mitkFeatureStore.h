@@ -0,0 +1,114 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkFeatureStore_h
+#define mitkFeatureStore_h
+
+#include <MitkCLUtilitiesExports.h>
+#include <mitkImage.h>
+
+#include <Eigen/Dense>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief File based sample matrix for training and applying classifiers chunk by chunk.
+  *
+  * The samples are stored as float32 rows together with an integer label. A store is written
+  * chunk by chunk (e.g. one patient at a time) with Create(), Append() / AppendImages() and Close().
+  * An existing store is opened with Open().
+  *
+  * Samples are read through memory mapped windows of the file, which are unmapped again after
+  * each call. Reading from several threads at the same time is safe. Requests for many scattered samples (e.g. the bootstrap
+  * sample of a tree) are served in file order, one window after the other.
+  *
+  * \note The file is written in the byte order of the machine.
+  */
+  class MITKCLUTILITIES_EXPORT FeatureStore : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(FeatureStore, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    /**
+    * \brief Creates a new, empty store. An existing file is overwritten.
+    * \throw mitk::Exception if the file cannot be created
+    */
+    void Create(const std::string& fileName, unsigned int numberOfFeatures);
+
+    /**
+    * \brief Appends the samples of X (one row per sample) with the labels of Y (first column).
+    * \throw mitk::Exception if the store is not being written or the sizes do not match
+    */
+    void Append(const Eigen::MatrixXd& X, const Eigen::MatrixXi& Y);
+
+    /**
+    * \brief Appends one sample for every voxel of the label image with a value other than 0.
+    *
+    * The samples are ordered like the rows of mitk::CLUtil::Transform().
+    * \param features one image per feature, of the size of the label image
+    * \param labels label of each voxel, 0 for voxels which are not used
+    */
+    void AppendImages(const std::vector<mitk::Image::Pointer>& features, const mitk::Image* labels);
+
+    /** \brief Finishes writing and opens the store for reading. */
+    void Close();
+
+    /**
+    * \brief Opens an existing store for reading.
+    * \throw mitk::Exception if the file does not exist, is not a feature store, contains no samples or is
+    * incomplete (e.g. truncated or not closed after writing)
+    */
+    void Open(const std::string& fileName);
+
+    bool IsOpen() const;
+    std::string GetFileName() const;
+    std::uint64_t GetNumberOfSamples() const;
+    unsigned int GetNumberOfFeatures() const;
+
+    /** \brief Index of the first sample of each label, available after Close() or Open(). */
+    const std::map<int, std::uint64_t>& GetFirstSampleOfLabels() const;
+
+    /**
+    * \brief Copies consecutive samples.
+    * \param features count * GetNumberOfFeatures() values, row major
+    * \param labels count values, may be nullptr
+    */
+    void GetSamples(std::uint64_t first, std::size_t count, float* features, int* labels) const;
+
+    /**
+    * \brief Copies the given samples, which may be unordered and contain duplicates, into a matrix.
+    *
+    * Row i of X and Y is the sample rows[i].
+    */
+    void GetSamples(const std::vector<std::uint64_t>& rows, Eigen::MatrixXd& X, Eigen::MatrixXi& Y) const;
+
+    /** \brief Same as above, but keeps the float values of the store, which needs half the memory. */
+    void GetSamples(const std::vector<std::uint64_t>& rows, Eigen::MatrixXf& X, Eigen::MatrixXi& Y) const;
+
+  protected:
+    FeatureStore();
+    ~FeatureStore() override;
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> m_Impl;
+  };
+}
+
+#endif //mitkFeatureStore_h
@@ -164,6 +164,7 @@ namespace mitk
       double MaximumIntensity;
       int Bins;
       std::string prefix;
+      unsigned int NumberOfThreads;
     };
 
     private:
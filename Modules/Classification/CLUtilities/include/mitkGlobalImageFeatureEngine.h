@@ -0,0 +1,115 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkGlobalImageFeatureEngine_h
+#define mitkGlobalImageFeatureEngine_h
+
+#include <MitkCLUtilitiesExports.h>
+#include <mitkAbstractGlobalImageFeature.h>
+#include <mitkImage.h>
+
+#include <functional>
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Calculates a set of global image features for many image / mask pairs in parallel.
+  *
+  * Every case is prepared exactly once and the prepared images are shared by all
+  * feature classes: integer masks are converted to unsigned short (the type the feature
+  * classes work on) and the mask that excludes NaN voxels is created. Optionally, all
+  * images are cropped to the bounding box of the masks (plus a margin), so that the
+  * feature classes do not have to walk the background of large images over and over again.
+  *
+  * The work is split into one task per case and feature class. The tasks are processed
+  * by a pool of worker threads in case order, so only about as many prepared cases as
+  * there are threads are kept in memory at any time. As the feature classes are stateful
+  * (quantifier, morphological mask, ...), every worker uses its own set of feature
+  * classes created by the given factory. The workers pass private image objects to the feature
+  * classes which share the pixel buffers of the prepared case, so the feature classes,
+  * which lock their inputs for writing, do not block each other. The features of a case
+  * are returned in the order of the feature classes of the factory, independent of the
+  * number of threads, so the results are identical to a sequential calculation.
+  * Feature classes that run in parallel internally get an equal share of the hardware
+  * cores (see AbstractGlobalImageFeature::SetNumberOfThreads()), so the inner threads
+  * do not oversubscribe the machine.
+  *
+  * \note Cropping is disabled by default because it changes the results of the feature
+  * classes that also evaluate voxels outside of the mask, e.g. the image description
+  * features or intensity histograms which ignore the mask.
+  */
+  class MITKCLUTILITIES_EXPORT GlobalImageFeatureEngine : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(GlobalImageFeatureEngine, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    typedef AbstractGlobalImageFeature::FeatureListType FeatureListType;
+    typedef std::vector<AbstractGlobalImageFeature::Pointer> FeatureSetType;
+
+    /** \brief Creates a fully configured set of feature classes. Called once per worker thread. */
+    typedef std::function<FeatureSetType()> FeatureSetFactoryType;
+
+    struct Case
+    {
+      mitk::Image::Pointer Image;
+      mitk::Image::Pointer Mask;
+      mitk::Image::Pointer MorphMask; ///< optional, the mask is used if not set
+    };
+
+    struct PreparedCase
+    {
+      mitk::Image::Pointer Image;
+      mitk::Image::Pointer Mask;
+      mitk::Image::Pointer MaskNoNaN;
+      mitk::Image::Pointer MorphMask;
+    };
+
+    void SetFeatureSetFactory(const FeatureSetFactoryType& factory) { m_FeatureSetFactory = factory; }
+
+    /** \brief Number of worker threads, 0 uses one thread per hardware core (default). */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /** \brief Number of voxels kept around the bounding box of the mask, a negative value disables cropping (default). */
+    itkSetMacro(CropMargin, int);
+    itkGetConstMacro(CropMargin, int);
+
+    /**
+    * \brief Calculates the features of all cases.
+    * \return one feature list per case, in the order of the cases
+    * \throw mitk::Exception if no factory is set or a case is incomplete. Exceptions of the
+    * feature classes are passed on after all workers have stopped.
+    */
+    std::vector<FeatureListType> CalculateFeatures(const std::vector<Case>& cases);
+
+    FeatureListType CalculateFeatures(const Case& singleCase);
+
+    /**
+    * \brief Performs the preprocessing which is shared by all feature classes.
+    * \param cropMargin see SetCropMargin()
+    */
+    static PreparedCase PrepareCase(const Case& singleCase, int cropMargin = -1);
+
+  protected:
+    GlobalImageFeatureEngine();
+    ~GlobalImageFeatureEngine() override;
+
+  private:
+    FeatureSetFactoryType m_FeatureSetFactory;
+    unsigned int m_NumberOfThreads;
+    int m_CropMargin;
+  };
+}
+
+#endif //mitkGlobalImageFeatureEngine_h
@@ -0,0 +1,110 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkLocalFeatureMapEngine_h
+#define mitkLocalFeatureMapEngine_h
+
+#include <MitkCLUtilitiesExports.h>
+#include <mitkImage.h>
+
+#include <Eigen/Dense>
+
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Calculates dense maps of local first order and co-occurrence features.
+  *
+  * For every voxel, the features are calculated from a cubic window with the given radius
+  * around the voxel (clipped at the image border). The intensities are quantized to a fixed
+  * number of bins within the intensity range of the image or the given range. The co-occurrence
+  * matrix is symmetric and pools all 13 directions of the 26-neighbourhood.
+  *
+  * The window is moved along the lines of the image. Each step only removes the slab of voxels
+  * leaving the window and adds the slab entering it, so the histogram, the co-occurrence counts
+  * and all sums derived from them are updated instead of being recomputed. The lines are
+  * processed in blocks by a pool of worker threads.
+  *
+  * The result is a float image with one component per feature (see GetFeatureNames()).
+  * CreateSampleMatrix() turns it into the sample matrix expected by the classifiers,
+  * e.g. mitk::VigraRandomForestClassifier, and SplitFeatureMap() into one image per feature.
+  * NaN voxels are ignored. Voxels outside of the mask are not calculated and set to 0.
+  */
+  class MITKCLUTILITIES_EXPORT LocalFeatureMapEngine : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(LocalFeatureMapEngine, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Radius of the window in voxels, the window covers 2 * radius + 1 voxels per dimension (default 2). */
+    itkSetMacro(Radius, unsigned int);
+    itkGetConstMacro(Radius, unsigned int);
+
+    /** \brief Number of bins used to quantize the intensities (default 32). */
+    itkSetMacro(Bins, unsigned int);
+    itkGetConstMacro(Bins, unsigned int);
+
+    /** \brief Lower bound of the quantization range, the minimum of the image is used if not set. */
+    itkSetMacro(MinimumIntensity, double);
+    itkGetConstMacro(MinimumIntensity, double);
+    itkSetMacro(UseMinimumIntensity, bool);
+    itkGetConstMacro(UseMinimumIntensity, bool);
+
+    /** \brief Upper bound of the quantization range, the maximum of the image is used if not set. */
+    itkSetMacro(MaximumIntensity, double);
+    itkGetConstMacro(MaximumIntensity, double);
+    itkSetMacro(UseMaximumIntensity, bool);
+    itkGetConstMacro(UseMaximumIntensity, bool);
+
+    /** \brief Number of worker threads, 0 uses one thread per hardware core (default). */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /** \brief Names of the features in the order of the components of the feature map. */
+    static std::vector<std::string> GetFeatureNames();
+
+    /**
+    * \brief Calculates the feature map of a 3D image.
+    * \param mask optional, restricts the calculation to the voxels with a value other than 0
+    * \throw mitk::Exception if the image is not 3D or the mask does not match the image
+    */
+    mitk::Image::Pointer CalculateFeatureMap(const mitk::Image* image, const mitk::Image* mask = nullptr) const;
+
+    /** \brief Copies each component of the feature map into a scalar image. */
+    static std::vector<mitk::Image::Pointer> SplitFeatureMap(const mitk::Image* featureMap);
+
+    /**
+    * \brief Creates a matrix with one row per voxel of the mask and one column per feature.
+    *
+    * The rows are ordered like the ones of mitk::CLUtil::Transform(), so the predictions
+    * of a classifier can be mapped back into an image with it.
+    */
+    static Eigen::MatrixXd CreateSampleMatrix(const mitk::Image* featureMap, const mitk::Image* mask);
+
+  protected:
+    LocalFeatureMapEngine();
+    ~LocalFeatureMapEngine() override;
+
+  private:
+    unsigned int m_Radius;
+    unsigned int m_Bins;
+    double m_MinimumIntensity;
+    bool m_UseMinimumIntensity;
+    double m_MaximumIntensity;
+    bool m_UseMaximumIntensity;
+    unsigned int m_NumberOfThreads;
+  };
+}
+
+#endif //mitkLocalFeatureMapEngine_h
@@ -0,0 +1,581 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkLocalFeatureMapEngine.h>
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkImageRegionConstIterator.h>
+#include <itkVectorImage.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  enum LocalFeature
+  {
+    Mean = 0,
+    StandardDeviation,
+    Entropy,
+    Uniformity,
+    Contrast,
+    Dissimilarity,
+    Homogeneity,
+    Energy,
+    JointEntropy,
+    Correlation,
+    NumberOfLocalFeatures
+  };
+
+  const unsigned int LinesPerBlock = 16;
+
+  struct Volume
+  {
+    int Size[3];
+    double Shift;
+    std::vector<int> Bins; ///< -1 for NaN voxels
+    std::vector<double> Values; ///< shifted by Shift to keep the sums small
+    std::vector<char> Mask; ///< empty if all voxels are calculated
+  };
+
+  struct Offset
+  {
+    int Step[3];
+    std::ptrdiff_t Delta;
+  };
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void ReadValues(const itk::Image<TPixel, VImageDimension>* itkImage, std::vector<double>& values)
+  {
+    values.clear();
+    values.reserve(itkImage->GetLargestPossibleRegion().GetNumberOfPixels());
+
+    itk::ImageRegionConstIterator<itk::Image<TPixel, VImageDimension>> it(itkImage, itkImage->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+      values.push_back(static_cast<double>(it.Get()));
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void ReadMask(const itk::Image<TPixel, VImageDimension>* itkMask, std::vector<char>& mask)
+  {
+    mask.clear();
+    mask.reserve(itkMask->GetLargestPossibleRegion().GetNumberOfPixels());
+
+    itk::ImageRegionConstIterator<itk::Image<TPixel, VImageDimension>> it(itkMask, itkMask->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+      mask.push_back(it.Get() != 0 ? 1 : 0);
+  }
+
+  void CheckGeometry(const mitk::Image* image, const mitk::Image* mask)
+  {
+    if (image == nullptr || !image->IsInitialized())
+      mitkThrow() << "No image given.";
+
+    if (image->GetDimension() != 3)
+      mitkThrow() << "Local feature maps can only be calculated for 3D images.";
+
+    if (mask == nullptr)
+      return;
+
+    if (mask->GetDimension() != 3 || mask->GetDimension(0) != image->GetDimension(0) ||
+        mask->GetDimension(1) != image->GetDimension(1) || mask->GetDimension(2) != image->GetDimension(2))
+      mitkThrow() << "Mask does not match the size of the image.";
+  }
+
+  void ReadMask(const mitk::Image* mask, std::vector<char>& maskValues)
+  {
+    AccessFixedDimensionByItk_1(mask, ReadMask, 3, maskValues);
+  }
+
+  /** \brief Offsets of the 13 directions of the 26-neighbourhood, each direction is contained once. */
+  std::vector<Offset> CreateOffsets(const int size[3])
+  {
+    std::vector<Offset> offsets;
+    for (int z = -1; z <= 1; ++z)
+    {
+      for (int y = -1; y <= 1; ++y)
+      {
+        for (int x = -1; x <= 1; ++x)
+        {
+          if (z > 0 || (z == 0 && y > 0) || (z == 0 && y == 0 && x > 0))
+          {
+            Offset offset;
+            offset.Step[0] = x;
+            offset.Step[1] = y;
+            offset.Step[2] = z;
+            offset.Delta = x + static_cast<std::ptrdiff_t>(size[0]) * (y + static_cast<std::ptrdiff_t>(size[1]) * z);
+            offsets.push_back(offset);
+          }
+        }
+      }
+    }
+    return offsets;
+  }
+
+  /**
+  * \brief Histogram, co-occurrence counts and all sums the features are derived from.
+  *
+  * Every update changes a single count by one, the squared sums and the entropy sums
+  * (sum of c * log2(c) over all counts c) are corrected by the difference of the old and
+  * the new term. The entropy terms are looked up in a shared table.
+  */
+  class Window
+  {
+  public:
+    Window(unsigned int bins, const std::vector<double>& entropyTerms)
+      : m_Bins(bins),
+        m_EntropyTerms(entropyTerms),
+        m_Histogram(bins),
+        m_Matrix(bins * bins),
+        m_Differences(bins)
+    {
+      this->Clear();
+    }
+
+    void Clear()
+    {
+      std::fill(m_Histogram.begin(), m_Histogram.end(), 0);
+      std::fill(m_Matrix.begin(), m_Matrix.end(), 0);
+      std::fill(m_Differences.begin(), m_Differences.end(), 0);
+
+      m_NumberOfVoxels = 0;
+      m_Sum = 0;
+      m_SquaredSum = 0;
+      m_HistogramSquaredSum = 0;
+      m_HistogramEntropySum = 0;
+
+      m_NumberOfPairs = 0;
+      m_IndexSum = 0;
+      m_IndexSquaredSum = 0;
+      m_IndexProductSum = 0;
+      m_MatrixSquaredSum = 0;
+      m_MatrixEntropySum = 0;
+    }
+
+    void UpdateVoxel(int bin, double value, int sign)
+    {
+      m_NumberOfVoxels += sign;
+      m_Sum += sign * value;
+      m_SquaredSum += sign * value * value;
+      this->UpdateCount(m_Histogram[bin], sign, m_HistogramSquaredSum, m_HistogramEntropySum);
+    }
+
+    /** \brief Updates the symmetric co-occurrence matrix with the pair (i, j) and (j, i). */
+    void UpdatePair(int i, int j, int sign)
+    {
+      this->UpdateCount(m_Matrix[i * m_Bins + j], sign, m_MatrixSquaredSum, m_MatrixEntropySum);
+      this->UpdateCount(m_Matrix[j * m_Bins + i], sign, m_MatrixSquaredSum, m_MatrixEntropySum);
+
+      m_NumberOfPairs += sign;
+      m_Differences[std::abs(i - j)] += sign;
+      m_IndexSum += sign * (i + j);
+      m_IndexSquaredSum += sign * (i * i + j * j);
+      m_IndexProductSum += sign * 2 * i * j;
+    }
+
+    void GetFeatures(double shift, float* features) const
+    {
+      std::fill(features, features + NumberOfLocalFeatures, 0.0f);
+
+      if (m_NumberOfVoxels > 0)
+      {
+        const double n = static_cast<double>(m_NumberOfVoxels);
+        const double mean = m_Sum / n;
+        features[Mean] = static_cast<float>(mean + shift);
+        features[StandardDeviation] = static_cast<float>(std::sqrt(std::max(0.0, m_SquaredSum / n - mean * mean)));
+        features[Entropy] = static_cast<float>(std::log2(n) - m_HistogramEntropySum / n);
+        features[Uniformity] = static_cast<float>(m_HistogramSquaredSum / (n * n));
+      }
+
+      if (m_NumberOfPairs > 0)
+      {
+        // every pair is contained twice in the symmetric matrix
+        const double pairs = static_cast<double>(m_NumberOfPairs);
+        const double n = 2.0 * pairs;
+
+        double contrast = 0;
+        double dissimilarity = 0;
+        double homogeneity = 0;
+        for (unsigned int d = 0; d < m_Bins; ++d)
+        {
+          const double count = static_cast<double>(m_Differences[d]);
+          contrast += count * d * d;
+          dissimilarity += count * d;
+          homogeneity += count / (1.0 + d);
+        }
+        features[Contrast] = static_cast<float>(contrast / pairs);
+        features[Dissimilarity] = static_cast<float>(dissimilarity / pairs);
+        features[Homogeneity] = static_cast<float>(homogeneity / pairs);
+        features[Energy] = static_cast<float>(m_MatrixSquaredSum / (n * n));
+        features[JointEntropy] = static_cast<float>(std::log2(n) - m_MatrixEntropySum / n);
+
+        // (co)variances scaled by n^2, calculated with integers so that constant windows are detected exactly
+        const long long total = 2 * m_NumberOfPairs;
+        const long long variance = m_IndexSquaredSum * total - m_IndexSum * m_IndexSum;
+        const long long covariance = m_IndexProductSum * total - m_IndexSum * m_IndexSum;
+        features[Correlation] = variance > 0 ? static_cast<float>(static_cast<double>(covariance) / variance) : 1.0f;
+      }
+    }
+
+  private:
+    void UpdateCount(long long& count, int sign, long long& squaredSum, double& entropySum)
+    {
+      const long long old = count;
+      count += sign;
+      squaredSum += count * count - old * old;
+      entropySum += m_EntropyTerms[count] - m_EntropyTerms[old];
+    }
+
+    unsigned int m_Bins;
+    const std::vector<double>& m_EntropyTerms;
+
+    std::vector<long long> m_Histogram;
+    std::vector<long long> m_Matrix;
+    std::vector<long long> m_Differences;
+
+    long long m_NumberOfVoxels;
+    double m_Sum;
+    double m_SquaredSum;
+    long long m_HistogramSquaredSum;
+    double m_HistogramEntropySum;
+
+    long long m_NumberOfPairs;
+    long long m_IndexSum;
+    long long m_IndexSquaredSum;
+    long long m_IndexProductSum;
+    long long m_MatrixSquaredSum;
+    double m_MatrixEntropySum;
+  };
+
+  struct Bounds
+  {
+    int Lower[3];
+    int Upper[3];
+  };
+
+  /**
+  * \brief Adds (sign = 1) or removes (sign = -1) the voxels of the column x of the window
+  * and all pairs between them and the other voxels of the window.
+  *
+  * The column has to be part of the bounds. Pairs within the column are counted in the
+  * direction of the offset only, pairs with a neighbouring column in both directions.
+  */
+  void UpdateColumn(const Volume& volume, const std::vector<Offset>& offsets, const Bounds& bounds, int x, int sign, Window& window)
+  {
+    for (int z = bounds.Lower[2]; z <= bounds.Upper[2]; ++z)
+    {
+      for (int y = bounds.Lower[1]; y <= bounds.Upper[1]; ++y)
+      {
+        const std::ptrdiff_t index = x + static_cast<std::ptrdiff_t>(volume.Size[0]) * (y + static_cast<std::ptrdiff_t>(volume.Size[1]) * z);
+        const int bin = volume.Bins[index];
+        if (bin < 0)
+          continue;
+
+        window.UpdateVoxel(bin, volume.Values[index], sign);
+
+        for (const auto& offset : offsets)
+        {
+          for (int direction = 1; direction >= -1; direction -= 2)
+          {
+            if (direction < 0 && offset.Step[0] == 0)
+              break;
+
+            const int nx = x + direction * offset.Step[0];
+            const int ny = y + direction * offset.Step[1];
+            const int nz = z + direction * offset.Step[2];
+            if (nx < bounds.Lower[0] || nx > bounds.Upper[0] || ny < bounds.Lower[1] || ny > bounds.Upper[1] ||
+                nz < bounds.Lower[2] || nz > bounds.Upper[2])
+              continue;
+
+            const int neighbourBin = volume.Bins[index + direction * offset.Delta];
+            if (neighbourBin >= 0)
+              window.UpdatePair(bin, neighbourBin, sign);
+          }
+        }
+      }
+    }
+  }
+
+  /** \brief Slides the window along the line (y, z) and writes the features of all calculated voxels. */
+  void ProcessLine(const Volume& volume, const std::vector<Offset>& offsets, int radius, int y, int z, Window& window, float* output)
+  {
+    const std::ptrdiff_t lineStart = static_cast<std::ptrdiff_t>(volume.Size[0]) * (y + static_cast<std::ptrdiff_t>(volume.Size[1]) * z);
+
+    Bounds bounds;
+    bounds.Lower[1] = std::max(0, y - radius);
+    bounds.Upper[1] = std::min(volume.Size[1] - 1, y + radius);
+    bounds.Lower[2] = std::max(0, z - radius);
+    bounds.Upper[2] = std::min(volume.Size[2] - 1, z + radius);
+    bounds.Lower[0] = 0;
+    bounds.Upper[0] = -1;
+
+    for (int x = 0; x < volume.Size[0]; ++x)
+    {
+      if (!volume.Mask.empty() && volume.Mask[lineStart + x] == 0)
+        continue;
+
+      const int lower = std::max(0, x - radius);
+      const int upper = std::min(volume.Size[0] - 1, x + radius);
+
+      // start from scratch if the new window does not overlap the current one
+      if (lower > bounds.Upper[0])
+      {
+        window.Clear();
+        bounds.Lower[0] = lower;
+        bounds.Upper[0] = lower - 1;
+      }
+
+      while (bounds.Upper[0] < upper)
+      {
+        ++bounds.Upper[0];
+        UpdateColumn(volume, offsets, bounds, bounds.Upper[0], 1, window);
+      }
+      while (bounds.Lower[0] < lower)
+      {
+        UpdateColumn(volume, offsets, bounds, bounds.Lower[0], -1, window);
+        ++bounds.Lower[0];
+      }
+
+      window.GetFeatures(volume.Shift, output + (lineStart + x) * NumberOfLocalFeatures);
+    }
+  }
+
+  unsigned int GetNumberOfWorkers(unsigned int numberOfThreads, std::size_t numberOfBlocks)
+  {
+    if (numberOfThreads == 0)
+      numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    return static_cast<unsigned int>(std::min<std::size_t>(numberOfThreads, numberOfBlocks));
+  }
+}
+
+mitk::LocalFeatureMapEngine::LocalFeatureMapEngine()
+  : m_Radius(2),
+    m_Bins(32),
+    m_MinimumIntensity(0),
+    m_UseMinimumIntensity(false),
+    m_MaximumIntensity(0),
+    m_UseMaximumIntensity(false),
+    m_NumberOfThreads(0)
+{
+}
+
+mitk::LocalFeatureMapEngine::~LocalFeatureMapEngine()
+{
+}
+
+std::vector<std::string> mitk::LocalFeatureMapEngine::GetFeatureNames()
+{
+  std::vector<std::string> names(NumberOfLocalFeatures);
+  names[Mean] = "Local::Mean";
+  names[StandardDeviation] = "Local::Standard Deviation";
+  names[Entropy] = "Local::Entropy";
+  names[Uniformity] = "Local::Uniformity";
+  names[Contrast] = "Local Co-occurrence::Contrast";
+  names[Dissimilarity] = "Local Co-occurrence::Dissimilarity";
+  names[Homogeneity] = "Local Co-occurrence::Homogeneity";
+  names[Energy] = "Local Co-occurrence::Joint Energy";
+  names[JointEntropy] = "Local Co-occurrence::Joint Entropy";
+  names[Correlation] = "Local Co-occurrence::Correlation";
+  return names;
+}
+
+mitk::Image::Pointer mitk::LocalFeatureMapEngine::CalculateFeatureMap(const mitk::Image* image, const mitk::Image* mask) const
+{
+  CheckGeometry(image, mask);
+
+  if (m_Bins == 0)
+    mitkThrow() << "At least one bin is required.";
+
+  Volume volume;
+  for (unsigned int i = 0; i < 3; ++i)
+    volume.Size[i] = static_cast<int>(image->GetDimension(i));
+
+  AccessFixedDimensionByItk_1(image, ReadValues, 3, volume.Values);
+  if (mask != nullptr)
+    ReadMask(mask, volume.Mask);
+
+  // quantization
+  double minimum = std::numeric_limits<double>::max();
+  double maximum = std::numeric_limits<double>::lowest();
+  for (auto value : volume.Values)
+  {
+    if (value == value)
+    {
+      minimum = std::min(minimum, value);
+      maximum = std::max(maximum, value);
+    }
+  }
+  if (m_UseMinimumIntensity)
+    minimum = m_MinimumIntensity;
+  if (m_UseMaximumIntensity)
+    maximum = m_MaximumIntensity;
+
+  const int bins = static_cast<int>(m_Bins);
+  const double binWidth = maximum > minimum ? (maximum - minimum) / bins : 0.0;
+
+  volume.Shift = minimum == std::numeric_limits<double>::max() ? 0.0 : minimum;
+  volume.Bins.resize(volume.Values.size());
+  for (std::size_t i = 0; i < volume.Values.size(); ++i)
+  {
+    const double value = volume.Values[i] - volume.Shift;
+    if (value != value)
+    {
+      volume.Bins[i] = -1;
+      continue;
+    }
+
+    int bin = binWidth > 0 ? static_cast<int>(std::floor(value / binWidth)) : 0;
+    volume.Bins[i] = std::min(std::max(bin, 0), bins - 1);
+    volume.Values[i] = value;
+  }
+
+  // c * log2(c) for every count that can occur in a window
+  const int radius = static_cast<int>(m_Radius);
+  const std::size_t windowSize = static_cast<std::size_t>(2 * radius + 1) * (2 * radius + 1) * (2 * radius + 1);
+  std::vector<double> entropyTerms(2 * 13 * windowSize + 1, 0.0);
+  for (std::size_t c = 2; c < entropyTerms.size(); ++c)
+    entropyTerms[c] = c * std::log2(static_cast<double>(c));
+
+  const auto offsets = CreateOffsets(volume.Size);
+
+  auto output = mitk::Image::New();
+  unsigned int dimensions[3] = {image->GetDimension(0), image->GetDimension(1), image->GetDimension(2)};
+  output->Initialize(mitk::MakePixelType<itk::VectorImage<float, 3>>(NumberOfLocalFeatures), 3, dimensions);
+  output->SetClonedTimeGeometry(image->GetTimeGeometry());
+
+  mitk::ImageWriteAccessor outputAccessor(output);
+  float* outputData = static_cast<float*>(outputAccessor.GetData());
+  std::fill(outputData, outputData + volume.Values.size() * NumberOfLocalFeatures, 0.0f);
+
+  const std::size_t numberOfLines = static_cast<std::size_t>(volume.Size[1]) * volume.Size[2];
+  const std::size_t numberOfBlocks = (numberOfLines + LinesPerBlock - 1) / LinesPerBlock;
+
+  std::atomic<std::size_t> nextBlock(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto work = [&]() {
+    try
+    {
+      Window window(m_Bins, entropyTerms);
+      for (std::size_t block = nextBlock++; block < numberOfBlocks; block = nextBlock++)
+      {
+        const std::size_t lastLine = std::min(numberOfLines, (block + 1) * LinesPerBlock);
+        for (std::size_t line = block * LinesPerBlock; line < lastLine; ++line)
+        {
+          const int y = static_cast<int>(line % volume.Size[1]);
+          const int z = static_cast<int>(line / volume.Size[1]);
+          ProcessLine(volume, offsets, radius, y, z, window, outputData);
+        }
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error)
+        error = std::current_exception();
+      nextBlock = numberOfBlocks;
+    }
+  };
+
+  const unsigned int numberOfWorkers = GetNumberOfWorkers(m_NumberOfThreads, numberOfBlocks);
+  std::vector<std::thread> workers;
+  for (unsigned int i = 1; i < numberOfWorkers; ++i)
+    workers.emplace_back(work);
+  work();
+  for (auto& worker : workers)
+    worker.join();
+
+  if (error)
+    std::rethrow_exception(error);
+
+  return output;
+}
+
+std::vector<mitk::Image::Pointer> mitk::LocalFeatureMapEngine::SplitFeatureMap(const mitk::Image* featureMap)
+{
+  CheckGeometry(featureMap, nullptr);
+
+  const unsigned int numberOfComponents = featureMap->GetPixelType().GetNumberOfComponents();
+  if (featureMap->GetPixelType().GetComponentType() != itk::ImageIOBase::FLOAT)
+    mitkThrow() << "Feature map has to be a float image.";
+
+  std::size_t numberOfVoxels = 1;
+  unsigned int dimensions[3];
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    dimensions[i] = featureMap->GetDimension(i);
+    numberOfVoxels *= dimensions[i];
+  }
+
+  mitk::ImageReadAccessor accessor(featureMap);
+  const float* data = static_cast<const float*>(accessor.GetData());
+
+  std::vector<mitk::Image::Pointer> images;
+  for (unsigned int component = 0; component < numberOfComponents; ++component)
+  {
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    image->SetClonedTimeGeometry(featureMap->GetTimeGeometry());
+
+    mitk::ImageWriteAccessor imageAccessor(image);
+    float* imageData = static_cast<float*>(imageAccessor.GetData());
+    for (std::size_t i = 0; i < numberOfVoxels; ++i)
+      imageData[i] = data[i * numberOfComponents + component];
+
+    images.push_back(image);
+  }
+  return images;
+}
+
+Eigen::MatrixXd mitk::LocalFeatureMapEngine::CreateSampleMatrix(const mitk::Image* featureMap, const mitk::Image* mask)
+{
+  if (mask == nullptr)
+    mitkThrow() << "No mask given.";
+  CheckGeometry(featureMap, mask);
+
+  if (featureMap->GetPixelType().GetComponentType() != itk::ImageIOBase::FLOAT)
+    mitkThrow() << "Feature map has to be a float image.";
+
+  std::vector<char> maskValues;
+  ReadMask(mask, maskValues);
+
+  const unsigned int numberOfComponents = featureMap->GetPixelType().GetNumberOfComponents();
+  const auto numberOfSamples = std::count(maskValues.begin(), maskValues.end(), 1);
+
+  mitk::ImageReadAccessor accessor(featureMap);
+  const float* data = static_cast<const float*>(accessor.GetData());
+
+  Eigen::MatrixXd samples(numberOfSamples, numberOfComponents);
+  Eigen::Index row = 0;
+  for (std::size_t i = 0; i < maskValues.size(); ++i)
+  {
+    if (maskValues[i] == 0)
+      continue;
+
+    for (unsigned int component = 0; component < numberOfComponents; ++component)
+      samples(row, component) = data[i * numberOfComponents + component];
+    ++row;
+  }
+  return samples;
+}
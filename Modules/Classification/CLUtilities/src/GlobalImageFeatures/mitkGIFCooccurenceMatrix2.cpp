@@ -19,12 +19,15 @@ found in the LICENSE file.
 
 // ITK
 #include <itkEnhancedScalarImageToTextureFeaturesFilter.h>
-#include <itkShapedNeighborhoodIterator.h>
 #include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
 
 // STL
+#include <algorithm>
 #include <sstream>
 #include <cmath>
+#include <thread>
+#include <vector>
 
 namespace mitk
 {
@@ -165,52 +168,151 @@ double mitk::CoocurenceMatrixHolder::IndexToMaxIntensity(int index)
 
 template<typename TPixel, unsigned int VImageDimension>
 void
-CalculateCoOcMatrix(itk::Image<TPixel, VImageDimension>* itkImage,
-                    itk::Image<unsigned short, VImageDimension>* mask,
-                    itk::Offset<VImageDimension> offset,
-                    int range,
-                    mitk::CoocurenceMatrixHolder &holder)
+CalculateCoOcMatrices(itk::Image<TPixel, VImageDimension>* itkImage,
+                      itk::Image<unsigned short, VImageDimension>* mask,
+                      const std::vector<itk::Offset<VImageDimension> > &offsets,
+                      std::vector<mitk::CoocurenceMatrixHolder> &holders,
+                      unsigned int maximumNumberOfThreads)
 {
   typedef itk::Image<TPixel, VImageDimension> ImageType;
   typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
-  typedef itk::ShapedNeighborhoodIterator<ImageType> ShapeIterType;
-  typedef itk::ShapedNeighborhoodIterator<MaskImageType> ShapeMaskIterType;
   typedef itk::ImageRegionConstIterator<ImageType> ConstIterType;
-  typedef itk::ImageRegionConstIterator<MaskImageType> ConstMaskIterType;
+  typedef itk::ImageRegionConstIteratorWithIndex<MaskImageType> ConstMaskIterType;
+  typedef itk::ImageRegion<VImageDimension> RegionType;
+
+  if (offsets.empty())
+    return;
+
+  // Pairs are only counted if both voxels are inside of the mask, so the bounding box
+  // of the mask contains all pairs.
+  typename MaskImageType::IndexType lower = mask->GetLargestPossibleRegion().GetUpperIndex();
+  typename MaskImageType::IndexType upper = mask->GetLargestPossibleRegion().GetIndex();
+  bool maskIsEmpty = true;
+  for (ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion()); !maskIter.IsAtEnd(); ++maskIter)
+  {
+    if (maskIter.Value() > 0)
+    {
+      auto index = maskIter.GetIndex();
+      for (unsigned int d = 0; d < VImageDimension; ++d)
+      {
+        lower[d] = std::min(lower[d], index[d]);
+        upper[d] = std::max(upper[d], index[d]);
+      }
+      maskIsEmpty = false;
+    }
+  }
+  if (maskIsEmpty)
+    return;
+
+  RegionType boundingBox;
+  boundingBox.SetIndex(lower);
+  for (unsigned int d = 0; d < VImageDimension; ++d)
+    boundingBox.SetSize(d, upper[d] - lower[d] + 1);
+
+  // Contiguous buffer of the quantized voxels within the bounding box. Voxels outside
+  // of the mask and NaN voxels are marked with -1.
+  const std::size_t numberOfVoxels = boundingBox.GetNumberOfPixels();
+  std::vector<int> bins(numberOfVoxels);
+  ConstIterType imageIter(itkImage, boundingBox);
+  itk::ImageRegionConstIterator<MaskImageType> maskIter(mask, boundingBox);
+  for (std::size_t i = 0; i < numberOfVoxels; ++i, ++imageIter, ++maskIter)
+  {
+    const TPixel value = imageIter.Get();
+    bins[i] = (maskIter.Get() > 0 && value == value) ? holders.front().IntensityToIndex(value) : -1;
+  }
 
+  long size[VImageDimension];
+  long stride[VImageDimension];
+  for (unsigned int d = 0; d < VImageDimension; ++d)
+  {
+    size[d] = static_cast<long>(boundingBox.GetSize(d));
+    stride[d] = (d == 0) ? 1 : stride[d - 1] * size[d - 1];
+  }
 
-  itk::Size<VImageDimension> radius;
-  radius.Fill(range+1);
-  ShapeIterType imageOffsetIter(radius, itkImage, itkImage->GetLargestPossibleRegion());
-  ShapeMaskIterType maskOffsetIter(radius, mask, mask->GetLargestPossibleRegion());
-  imageOffsetIter.ActivateOffset(offset);
-  maskOffsetIter.ActivateOffset(offset);
-  ConstIterType imageIter(itkImage, itkImage->GetLargestPossibleRegion());
-  ConstMaskIterType maskIter(mask, mask->GetLargestPossibleRegion());
-  //  iterator.GetIndex() + ci.GetNeighborhoodOffset()
-  auto region = mask->GetLargestPossibleRegion();
+  const std::size_t numberOfOffsets = offsets.size();
+  std::vector<long> delta(numberOfOffsets, 0);
+  for (std::size_t o = 0; o < numberOfOffsets; ++o)
+    for (unsigned int d = 0; d < VImageDimension; ++d)
+      delta[o] += offsets[o][d] * stride[d];
 
+  const int numberOfBins = holders.front().m_NumberOfBins;
+  const std::size_t matrixSize = static_cast<std::size_t>(numberOfBins) * numberOfBins;
+  const long numberOfLines = static_cast<long>(numberOfVoxels) / size[0];
 
-  while (!maskIter.IsAtEnd())
+  // Every line of the bounding box (along the first dimension) is visited once and
+  // all offsets are counted while it is in the cache. Counting integers keeps the
+  // matrices exact, independent of the order in which the threads are merged.
+  auto countLines = [&](long firstLine, long lastLine, std::vector<unsigned long long> &counts)
   {
-    auto ciMask = maskOffsetIter.Begin();
-    auto ciValue = imageOffsetIter.Begin();
-    if (maskIter.Value() > 0 &&
-      ciMask.Get() > 0 &&
-      imageIter.Get() == imageIter.Get() &&
-      ciValue.Get() == ciValue.Get() &&
-      region.IsInside(maskOffsetIter.GetIndex() + ciMask.GetNeighborhoodOffset()))
+    long position[VImageDimension];
+    for (long line = firstLine; line < lastLine; ++line)
     {
-      int i = holder.IntensityToIndex(imageIter.Get());
-      int j = holder.IntensityToIndex(ciValue.Get());
-      holder.m_Matrix(i, j) += 1;
-      holder.m_Matrix(j, i) += 1;
+      long remainder = line;
+      for (unsigned int d = 1; d < VImageDimension; ++d)
+      {
+        position[d] = remainder % size[d];
+        remainder /= size[d];
+      }
+      const int *lineBins = bins.data() + line * size[0];
+
+      for (std::size_t o = 0; o < numberOfOffsets; ++o)
+      {
+        bool lineIsInside = true;
+        for (unsigned int d = 1; d < VImageDimension; ++d)
+        {
+          const long neighbour = position[d] + offsets[o][d];
+          lineIsInside = lineIsInside && neighbour >= 0 && neighbour < size[d];
+        }
+        if (!lineIsInside)
+          continue;
+
+        const long begin = std::max<long>(0, -offsets[o][0]);
+        const long end = std::min<long>(size[0], size[0] - offsets[o][0]);
+        const int *centerBins = lineBins + begin;
+        const int *neighbourBins = bins.data() + (line * size[0] + begin + delta[o]);
+        unsigned long long *matrix = counts.data() + o * matrixSize;
+        for (long x = 0; x < end - begin; ++x)
+        {
+          const int i = centerBins[x];
+          const int j = neighbourBins[x];
+          if (i >= 0 && j >= 0)
+          {
+            ++matrix[i * numberOfBins + j];
+            ++matrix[j * numberOfBins + i];
+          }
+        }
+      }
     }
-    ++imageOffsetIter;
-    ++maskOffsetIter;
-    ++imageIter;
-    ++maskIter;
+  };
+
+  const long minimumNumberOfVoxelsPerThread = 1 << 16;
+  // the thread budget is limited if the feature class itself runs in parallel to others (see GlobalImageFeatureEngine)
+  if (maximumNumberOfThreads == 0)
+    maximumNumberOfThreads = std::thread::hardware_concurrency();
+  long numberOfThreads = std::min<long>(std::max(1u, maximumNumberOfThreads),
+    std::max<long>(1, static_cast<long>(numberOfVoxels) / minimumNumberOfVoxelsPerThread));
+  numberOfThreads = std::min(numberOfThreads, numberOfLines);
+
+  std::vector<std::vector<unsigned long long> > counts(numberOfThreads,
+    std::vector<unsigned long long>(numberOfOffsets * matrixSize, 0));
+  std::vector<std::thread> threads;
+  for (long t = 1; t < numberOfThreads; ++t)
+  {
+    threads.emplace_back(countLines, t * numberOfLines / numberOfThreads, (t + 1) * numberOfLines / numberOfThreads,
+      std::ref(counts[t]));
   }
+  countLines(0, numberOfLines / numberOfThreads, counts[0]);
+  for (auto &thread : threads)
+    thread.join();
+
+  for (long t = 1; t < numberOfThreads; ++t)
+    for (std::size_t k = 0; k < counts[0].size(); ++k)
+      counts[0][k] += counts[t][k];
+
+  for (std::size_t o = 0; o < numberOfOffsets; ++o)
+    for (int i = 0; i < numberOfBins; ++i)
+      for (int j = 0; j < numberOfBins; ++j)
+        holders[o].m_Matrix(i, j) = static_cast<double>(counts[0][o * matrixSize + i * numberOfBins + j]);
 }
 
 void CalculateFeatures(
@@ -420,9 +522,7 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
     offset[2] = 1;
   }
 
-  std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
-  mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
-  mitk::CoocurenceMatrixFeatures overallFeature;
+  std::vector<itk::Offset<VImageDimension> > usedOffsets;
   for (std::size_t i = 0; i < offsetVector.size(); ++i)
   {
     if (config.direction > 1)
@@ -432,12 +532,18 @@ CalculateCoocurenceFeatures(itk::Image<TPixel, VImageDimension>* itkImage, mitk:
         continue;
       }
     }
+    usedOffsets.push_back(offsetVector[i]);
+  }
 
+  std::vector<mitk::CoocurenceMatrixHolder> holders(usedOffsets.size(), mitk::CoocurenceMatrixHolder(rangeMin, rangeMax, numberOfBins));
+  CalculateCoOcMatrices<TPixel, VImageDimension>(itkImage, maskImage, usedOffsets, holders, config.NumberOfThreads);
 
-    offset = offsetVector[i];
-    mitk::CoocurenceMatrixHolder holder(rangeMin, rangeMax, numberOfBins);
+  std::vector<mitk::CoocurenceMatrixFeatures> resultVector;
+  mitk::CoocurenceMatrixHolder holderOverall(rangeMin, rangeMax, numberOfBins);
+  mitk::CoocurenceMatrixFeatures overallFeature;
+  for (auto &holder : holders)
+  {
     mitk::CoocurenceMatrixFeatures coocResults;
-    CalculateCoOcMatrix<TPixel, VImageDimension>(itkImage, maskImage, offset, config.range, holder);
     holderOverall.m_Matrix += holder.m_Matrix;
     CalculateFeatures(holder, coocResults);
     resultVector.push_back(coocResults);
@@ -640,6 +746,7 @@ mitk::GIFCooccurenceMatrix2::FeatureListType mitk::GIFCooccurenceMatrix2::Calcul
   config.MaximumIntensity = GetQuantifier()->GetMaximum();
   config.Bins = GetQuantifier()->GetBins();
   config.prefix = FeatureDescriptionPrefix();
+  config.NumberOfThreads = GetNumberOfThreads();
 
   AccessByItk_3(image, CalculateCoocurenceFeatures, mask, featureList,config);
 
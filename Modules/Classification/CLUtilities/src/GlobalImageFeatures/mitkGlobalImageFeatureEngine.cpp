@@ -0,0 +1,387 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkGlobalImageFeatureEngine.h>
+
+// MITK
+#include <mitkExceptionMacro.h>
+#include <mitkITKImageImport.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageCast.h>
+#include <mitkImageReadAccessor.h>
+
+// ITK
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkRegionOfInterestImageFilter.h>
+
+// STL
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  template <unsigned int VDimension>
+  mitk::Image::Pointer CastMaskToUnsignedShort(const mitk::Image* mask)
+  {
+    typedef itk::Image<unsigned short, VDimension> MaskImageType;
+    typename MaskImageType::Pointer itkMask = MaskImageType::New();
+    mitk::CastToItkImage(mask, itkMask);
+    return mitk::GrabItkImageMemory(itkMask.GetPointer());
+  }
+
+  mitk::Image::Pointer ConvertMask(const mitk::Image::Pointer& mask)
+  {
+    const auto componentType = mask->GetPixelType().GetComponentType();
+    if (componentType == itk::ImageIOBase::USHORT || componentType == itk::ImageIOBase::FLOAT
+      || componentType == itk::ImageIOBase::DOUBLE)
+    {
+      // nothing to gain, or casting would change which voxels belong to the mask
+      return mask;
+    }
+
+    switch (mask->GetDimension())
+    {
+    case 2: return CastMaskToUnsignedShort<2>(mask);
+    case 3: return CastMaskToUnsignedShort<3>(mask);
+    default: return mask;
+    }
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void CreateNoNaNMask(const itk::Image<TPixel, VImageDimension>* itkValue, mitk::Image::Pointer mask, mitk::Image::Pointer& newMask)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<unsigned short, VImageDimension> MaskImageType;
+
+    typename MaskImageType::Pointer itkMask = MaskImageType::New();
+    mitk::CastToItkImage(mask, itkMask);
+
+    typename MaskImageType::Pointer noNaNMask = MaskImageType::New();
+    noNaNMask->CopyInformation(itkMask);
+    noNaNMask->SetRegions(itkMask->GetLargestPossibleRegion());
+    noNaNMask->Allocate();
+
+    itk::ImageRegionConstIterator<MaskImageType> maskIter(itkMask, itkMask->GetLargestPossibleRegion());
+    itk::ImageRegionIterator<MaskImageType> noNaNIter(noNaNMask, noNaNMask->GetLargestPossibleRegion());
+    itk::ImageRegionConstIterator<ImageType> imageIter(itkValue, itkValue->GetLargestPossibleRegion());
+    while (!maskIter.IsAtEnd())
+    {
+      // NaN is the only value which is not equal to itself
+      noNaNIter.Set((maskIter.Value() > 0 && imageIter.Value() == imageIter.Value()) ? 1 : 0);
+      ++maskIter;
+      ++noNaNIter;
+      ++imageIter;
+    }
+
+    newMask = mitk::GrabItkImageMemory(noNaNMask.GetPointer());
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void ExpandBoundingBox(const itk::Image<TPixel, VImageDimension>* itkMask, itk::Index<VImageDimension>& lower,
+    itk::Index<VImageDimension>& upper, bool& found)
+  {
+    typedef itk::Image<TPixel, VImageDimension> MaskImageType;
+
+    itk::ImageRegionConstIteratorWithIndex<MaskImageType> iter(itkMask, itkMask->GetLargestPossibleRegion());
+    for (; !iter.IsAtEnd(); ++iter)
+    {
+      if (!(iter.Get() > 0))
+        continue;
+
+      const auto index = iter.GetIndex();
+      for (unsigned int i = 0; i < VImageDimension; ++i)
+      {
+        lower[i] = found ? std::min(lower[i], index[i]) : index[i];
+        upper[i] = found ? std::max(upper[i], index[i]) : index[i];
+      }
+      found = true;
+    }
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void CropImage(const itk::Image<TPixel, VImageDimension>* itkImage, const itk::ImageRegion<VImageDimension>& region,
+    mitk::Image::Pointer& cropped)
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::RegionOfInterestImageFilter<ImageType, ImageType> FilterType;
+
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(itkImage);
+    filter->SetRegionOfInterest(region);
+    filter->Update();
+
+    cropped = mitk::GrabItkImageMemory(filter->GetOutput());
+  }
+
+  template <unsigned int VDimension>
+  void CropToMasks(mitk::GlobalImageFeatureEngine::PreparedCase& prepared, int margin)
+  {
+    const mitk::Image* image = prepared.Image;
+    const mitk::Image* mask = prepared.Mask;
+    const mitk::Image* maskNoNaN = prepared.MaskNoNaN;
+    const mitk::Image* morphMask = prepared.MorphMask;
+
+    typedef itk::Index<VDimension> IndexType;
+    typedef itk::ImageRegion<VDimension> RegionType;
+
+    IndexType lower;
+    IndexType upper;
+    lower.Fill(0);
+    upper.Fill(0);
+    bool found = false;
+    AccessFixedDimensionByItk_3(mask, ExpandBoundingBox, VDimension, lower, upper, found);
+    if (morphMask != mask)
+      AccessFixedDimensionByItk_3(morphMask, ExpandBoundingBox, VDimension, lower, upper, found);
+
+    if (!found)
+      return; // empty mask, nothing to crop to
+
+    RegionType region;
+    for (unsigned int i = 0; i < VDimension; ++i)
+    {
+      const auto extent = static_cast<itk::IndexValueType>(image->GetDimension(i));
+      const auto start = std::max<itk::IndexValueType>(0, lower[i] - margin);
+      const auto end = std::min<itk::IndexValueType>(extent - 1, upper[i] + margin);
+      region.SetIndex(i, start);
+      region.SetSize(i, static_cast<itk::SizeValueType>(end - start + 1));
+    }
+
+    mitk::GlobalImageFeatureEngine::PreparedCase cropped;
+    AccessFixedDimensionByItk_2(image, CropImage, VDimension, region, cropped.Image);
+    AccessFixedDimensionByItk_2(mask, CropImage, VDimension, region, cropped.Mask);
+    AccessFixedDimensionByItk_2(maskNoNaN, CropImage, VDimension, region, cropped.MaskNoNaN);
+    if (morphMask != mask)
+    {
+      AccessFixedDimensionByItk_2(morphMask, CropImage, VDimension, region, cropped.MorphMask);
+    }
+    else
+    {
+      cropped.MorphMask = cropped.Mask;
+    }
+
+    prepared = cropped;
+  }
+
+  /** Image which shares the pixels of the given image, but has its own access locks. */
+  mitk::Image::Pointer CreateView(const mitk::Image::Pointer& image)
+  {
+    mitk::Image::Pointer view = mitk::Image::New();
+    view->Initialize(image->GetPixelType(), image->GetDimension(), image->GetDimensions());
+    view->SetClonedTimeGeometry(image->GetTimeGeometry());
+
+    // the accessor only guards the acquisition of the pointer, the prepared case outlives the view
+    mitk::ImageReadAccessor accessor(image, image->GetVolumeData(0));
+    view->SetImportVolume(const_cast<void*>(accessor.GetData()), 0, 0, mitk::Image::ReferenceMemory);
+
+    return view;
+  }
+
+  mitk::GlobalImageFeatureEngine::PreparedCase CreateViews(const mitk::GlobalImageFeatureEngine::PreparedCase& prepared)
+  {
+    mitk::GlobalImageFeatureEngine::PreparedCase views;
+    views.Image = CreateView(prepared.Image);
+    views.Mask = CreateView(prepared.Mask);
+    views.MaskNoNaN = CreateView(prepared.MaskNoNaN);
+    views.MorphMask = prepared.MorphMask == prepared.Mask ? views.Mask : CreateView(prepared.MorphMask);
+    return views;
+  }
+
+  bool HaveSameSize(const mitk::Image* a, const mitk::Image* b)
+  {
+    if (a->GetDimension() != b->GetDimension())
+      return false;
+
+    for (unsigned int i = 0; i < a->GetDimension(); ++i)
+    {
+      if (a->GetDimension(i) != b->GetDimension(i))
+        return false;
+    }
+    return true;
+  }
+}
+
+mitk::GlobalImageFeatureEngine::GlobalImageFeatureEngine()
+  : m_NumberOfThreads(0),
+    m_CropMargin(-1)
+{
+}
+
+mitk::GlobalImageFeatureEngine::~GlobalImageFeatureEngine()
+{
+}
+
+mitk::GlobalImageFeatureEngine::PreparedCase mitk::GlobalImageFeatureEngine::PrepareCase(const Case& singleCase, int cropMargin)
+{
+  if (singleCase.Image.IsNull() || singleCase.Mask.IsNull())
+    mitkThrow() << "Cannot calculate features without image and mask.";
+
+  PreparedCase prepared;
+  prepared.Image = singleCase.Image;
+  prepared.Mask = ConvertMask(singleCase.Mask);
+  prepared.MorphMask = singleCase.MorphMask.IsNull() || singleCase.MorphMask == singleCase.Mask
+    ? prepared.Mask
+    : ConvertMask(singleCase.MorphMask);
+
+  // read-only access, the same image may be shared by several cases which are prepared concurrently
+  const mitk::Image* image = prepared.Image;
+  prepared.MaskNoNaN = mitk::Image::New();
+  AccessByItk_2(image, CreateNoNaNMask, prepared.Mask, prepared.MaskNoNaN);
+
+  if (cropMargin < 0)
+    return prepared;
+
+  if (!HaveSameSize(prepared.Image, prepared.Mask) || !HaveSameSize(prepared.Image, prepared.MorphMask))
+  {
+    MITK_WARN << "Image and masks differ in size, the case is not cropped.";
+    return prepared;
+  }
+
+  switch (prepared.Image->GetDimension())
+  {
+  case 2: CropToMasks<2>(prepared, cropMargin); break;
+  case 3: CropToMasks<3>(prepared, cropMargin); break;
+  default: MITK_WARN << "Only 2D and 3D cases can be cropped."; break;
+  }
+
+  return prepared;
+}
+
+mitk::GlobalImageFeatureEngine::FeatureListType mitk::GlobalImageFeatureEngine::CalculateFeatures(const Case& singleCase)
+{
+  return this->CalculateFeatures(std::vector<Case>(1, singleCase)).front();
+}
+
+std::vector<mitk::GlobalImageFeatureEngine::FeatureListType> mitk::GlobalImageFeatureEngine::CalculateFeatures(const std::vector<Case>& cases)
+{
+  if (!m_FeatureSetFactory)
+    mitkThrow() << "No factory for the feature classes is set.";
+
+  for (std::size_t i = 0; i < cases.size(); ++i)
+  {
+    if (cases[i].Image.IsNull() || cases[i].Mask.IsNull())
+      mitkThrow() << "Case " << i << " has no image or no mask.";
+  }
+
+  std::vector<FeatureSetType> featureSets;
+  featureSets.push_back(m_FeatureSetFactory());
+
+  const std::size_t numberOfFeatureClasses = featureSets.front().size();
+  const std::size_t numberOfTasks = cases.size() * numberOfFeatureClasses;
+
+  unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
+  numberOfThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, numberOfTasks)));
+
+  // the factory is called here, so it does not have to be thread-safe
+  while (featureSets.size() < numberOfThreads)
+  {
+    featureSets.push_back(m_FeatureSetFactory());
+    if (featureSets.back().size() != numberOfFeatureClasses)
+      mitkThrow() << "The feature set factory has to return the same feature classes on every call.";
+  }
+
+  // The cores are shared by the workers, so a feature class that runs in parallel itself
+  // only gets its part of them. Otherwise every worker would start one thread per core.
+  const unsigned int numberOfCores = std::max(1u, std::thread::hardware_concurrency());
+  const unsigned int innerNumberOfThreads = std::max(1u, numberOfCores / numberOfThreads);
+  for (auto &featureSet : featureSets)
+  {
+    for (auto &feature : featureSet)
+      feature->SetNumberOfThreads(innerNumberOfThreads);
+  }
+
+  struct CaseState
+  {
+    std::once_flag Prepared;
+    PreparedCase Data;
+    std::atomic<std::size_t> RemainingTasks;
+    std::vector<FeatureListType> Results;
+  };
+
+  std::vector<CaseState> states(cases.size());
+  for (auto& state : states)
+  {
+    state.RemainingTasks = numberOfFeatureClasses;
+    state.Results.resize(numberOfFeatureClasses);
+  }
+
+  std::atomic<std::size_t> nextTask(0);
+  std::atomic<bool> failed(false);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  const int cropMargin = m_CropMargin;
+
+  auto worker = [&](FeatureSetType& features)
+  {
+    try
+    {
+      while (!failed)
+      {
+        // tasks are handed out case by case, so cases are finished (and released) in order
+        const std::size_t task = nextTask++;
+        if (task >= numberOfTasks)
+          break;
+
+        const std::size_t caseIndex = task / numberOfFeatureClasses;
+        const std::size_t featureIndex = task % numberOfFeatureClasses;
+        CaseState& state = states[caseIndex];
+
+        std::call_once(state.Prepared, [&]() { state.Data = PrepareCase(cases[caseIndex], cropMargin); });
+
+        {
+          // the feature classes access their inputs with write locks, private views keep them from blocking each other
+          const PreparedCase views = CreateViews(state.Data);
+
+          auto& feature = features[featureIndex];
+          feature->SetMorphMask(views.MorphMask);
+          feature->CalculateFeaturesUsingParameters(views.Image, views.Mask, views.MaskNoNaN, state.Results[featureIndex]);
+          feature->SetMorphMask(nullptr);
+        }
+
+        if (--state.RemainingTasks == 0)
+          state.Data = PreparedCase();
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error)
+        error = std::current_exception();
+      failed = true;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+    threads.emplace_back(worker, std::ref(featureSets[i]));
+
+  worker(featureSets.front());
+
+  for (auto& thread : threads)
+    thread.join();
+
+  if (error)
+    std::rethrow_exception(error);
+
+  std::vector<FeatureListType> results(cases.size());
+  for (std::size_t i = 0; i < cases.size(); ++i)
+  {
+    for (const auto& featureClassResult : states[i].Results)
+      results[i].insert(results[i].end(), featureClassResult.begin(), featureClassResult.end());
+  }
+
+  return results;
+}
@@ -0,0 +1,478 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkFeatureStore.h>
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageCast.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const char Magic[8] = {'M', 'I', 'T', 'K', 'F', 'S', 'T', '1'};
+
+  /// Maximum number of bytes which are mapped at the same time by a single read
+  const std::size_t WindowSize = 64 * 1024 * 1024;
+
+  struct FileHeader
+  {
+    char Magic[8];
+    std::uint64_t NumberOfSamples;
+    std::uint32_t NumberOfFeatures;
+    std::uint32_t NumberOfLabels;
+    std::uint64_t Reserved[5];
+  };
+
+  struct LabelEntry
+  {
+    std::int32_t Label;
+    std::uint32_t Reserved;
+    std::uint64_t FirstSample;
+  };
+
+#ifdef _WIN32
+  typedef HANDLE MappingHandleType;
+  const MappingHandleType InvalidMappingHandle = nullptr;
+#else
+  typedef int MappingHandleType;
+  const MappingHandleType InvalidMappingHandle = -1;
+#endif
+
+  std::uint64_t GetMappingGranularity()
+  {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    return static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+#endif
+  }
+
+  /** \brief Read-only mapping of a byte range of a file, unmapped on destruction. */
+  class MappedWindow
+  {
+  public:
+    MappedWindow(MappingHandleType handle, std::uint64_t offset, std::size_t length)
+      : m_Base(nullptr), m_Length(0), m_Delta(0)
+    {
+      const std::uint64_t alignedOffset = offset - offset % GetMappingGranularity();
+      m_Delta = static_cast<std::size_t>(offset - alignedOffset);
+      m_Length = length + m_Delta;
+
+#ifdef _WIN32
+      m_Base = MapViewOfFile(handle, FILE_MAP_READ, static_cast<DWORD>(alignedOffset >> 32),
+        static_cast<DWORD>(alignedOffset & 0xFFFFFFFF), m_Length);
+      if (m_Base == nullptr)
+        mitkThrow() << "Feature store could not be mapped into memory.";
+#else
+      m_Base = mmap(nullptr, m_Length, PROT_READ, MAP_SHARED, handle, static_cast<off_t>(alignedOffset));
+      if (m_Base == MAP_FAILED)
+        mitkThrow() << "Feature store could not be mapped into memory.";
+      madvise(m_Base, m_Length, MADV_SEQUENTIAL);
+#endif
+    }
+
+    ~MappedWindow()
+    {
+#ifdef _WIN32
+      UnmapViewOfFile(m_Base);
+#else
+      munmap(m_Base, m_Length);
+#endif
+    }
+
+    MappedWindow(const MappedWindow&) = delete;
+    MappedWindow& operator=(const MappedWindow&) = delete;
+
+    const char* GetData() const { return static_cast<const char*>(m_Base) + m_Delta; }
+
+  private:
+    void* m_Base;
+    std::size_t m_Length;
+    std::size_t m_Delta;
+  };
+
+  void ReadRecord(const char* record, unsigned int numberOfFeatures, float* features, int* label)
+  {
+    if (label != nullptr)
+    {
+      std::int32_t value;
+      std::memcpy(&value, record, sizeof(value));
+      *label = value;
+    }
+    std::memcpy(features, record + sizeof(std::int32_t), numberOfFeatures * sizeof(float));
+  }
+}
+
+struct mitk::FeatureStore::Impl
+{
+  std::string FileName;
+  unsigned int NumberOfFeatures = 0;
+  std::uint64_t NumberOfSamples = 0;
+  std::map<int, std::uint64_t> FirstSampleOfLabels;
+
+  std::ofstream Writer;
+  std::vector<char> Buffer;
+
+#ifdef _WIN32
+  HANDLE File = INVALID_HANDLE_VALUE;
+#endif
+  MappingHandleType Mapping = InvalidMappingHandle;
+
+  std::size_t GetRecordSize() const { return sizeof(std::int32_t) + NumberOfFeatures * sizeof(float); }
+
+  std::uint64_t GetOffset(std::uint64_t sample) const { return sizeof(FileHeader) + sample * GetRecordSize(); }
+
+  std::uint64_t GetSamplesPerWindow() const { return std::max<std::uint64_t>(1, WindowSize / GetRecordSize()); }
+
+  void WriteRecord(int label, const float* features)
+  {
+    FirstSampleOfLabels.emplace(label, NumberOfSamples);
+    ++NumberOfSamples;
+
+    const std::int32_t value = label;
+    const std::size_t position = Buffer.size();
+    Buffer.resize(position + GetRecordSize());
+    std::memcpy(Buffer.data() + position, &value, sizeof(value));
+    std::memcpy(Buffer.data() + position + sizeof(value), features, NumberOfFeatures * sizeof(float));
+  }
+
+  void FlushBuffer()
+  {
+    Writer.write(Buffer.data(), Buffer.size());
+    Buffer.clear();
+    if (!Writer)
+      mitkThrow() << "Samples could not be written to the feature store " << FileName << ".";
+  }
+
+  void CloseMapping()
+  {
+#ifdef _WIN32
+    if (Mapping != InvalidMappingHandle)
+      CloseHandle(Mapping);
+    if (File != INVALID_HANDLE_VALUE)
+      CloseHandle(File);
+    File = INVALID_HANDLE_VALUE;
+#else
+    if (Mapping != InvalidMappingHandle)
+      close(Mapping);
+#endif
+    Mapping = InvalidMappingHandle;
+  }
+
+  void CheckOpen() const
+  {
+    if (Mapping == InvalidMappingHandle)
+      mitkThrow() << "Feature store is not open for reading.";
+  }
+
+  /** \brief Copies the given samples, which may be unordered and contain duplicates, into X and Y */
+  template <typename TMatrix>
+  void GatherSamples(const std::vector<std::uint64_t>& rows, TMatrix& X, Eigen::MatrixXi& Y) const
+  {
+    CheckOpen();
+
+    const std::size_t recordSize = GetRecordSize();
+    const unsigned int numberOfFeatures = NumberOfFeatures;
+
+    X.resize(rows.size(), numberOfFeatures);
+    Y.resize(rows.size(), 1);
+
+    // serve the requests in file order
+    std::vector<std::size_t> order(rows.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&rows](std::size_t a, std::size_t b) { return rows[a] < rows[b]; });
+
+    if (!rows.empty() && rows[order.back()] >= NumberOfSamples)
+      mitkThrow() << "Sample " << rows[order.back()] << " is out of range.";
+
+    std::vector<float> features(numberOfFeatures);
+    for (std::size_t i = 0; i < order.size();)
+    {
+      const std::uint64_t first = rows[order[i]];
+      const std::uint64_t last = std::min(first + GetSamplesPerWindow(), NumberOfSamples);
+
+      // map only up to the last requested sample of this window
+      std::size_t end = i;
+      while (end < order.size() && rows[order[end]] < last)
+        ++end;
+
+      const std::uint64_t windowCount = rows[order[end - 1]] - first + 1;
+      MappedWindow window(Mapping, GetOffset(first), static_cast<std::size_t>(windowCount * recordSize));
+
+      for (; i < end; ++i)
+      {
+        int label;
+        ReadRecord(window.GetData() + (rows[order[i]] - first) * recordSize, numberOfFeatures, features.data(), &label);
+
+        Y(order[i], 0) = label;
+        for (unsigned int col = 0; col < numberOfFeatures; ++col)
+          X(order[i], col) = static_cast<typename TMatrix::Scalar>(features[col]);
+      }
+    }
+  }
+};
+
+mitk::FeatureStore::FeatureStore()
+  : m_Impl(new Impl)
+{
+}
+
+mitk::FeatureStore::~FeatureStore()
+{
+  m_Impl->CloseMapping();
+}
+
+void mitk::FeatureStore::Create(const std::string& fileName, unsigned int numberOfFeatures)
+{
+  m_Impl->CloseMapping();
+  if (m_Impl->Writer.is_open())
+    m_Impl->Writer.close();
+
+  m_Impl->FileName = fileName;
+  m_Impl->NumberOfFeatures = numberOfFeatures;
+  m_Impl->NumberOfSamples = 0;
+  m_Impl->FirstSampleOfLabels.clear();
+  m_Impl->Buffer.clear();
+
+  m_Impl->Writer.open(fileName, std::ios::binary | std::ios::trunc);
+  if (!m_Impl->Writer)
+    mitkThrow() << "Feature store " << fileName << " could not be created.";
+
+  // the number of samples stays 0 until the store is closed, which marks incomplete files
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, Magic, sizeof(Magic));
+  header.NumberOfFeatures = numberOfFeatures;
+  m_Impl->Writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void mitk::FeatureStore::Append(const Eigen::MatrixXd& X, const Eigen::MatrixXi& Y)
+{
+  if (!m_Impl->Writer.is_open())
+    mitkThrow() << "Feature store is not open for writing.";
+
+  if (X.cols() != static_cast<Eigen::Index>(m_Impl->NumberOfFeatures) || X.rows() != Y.rows() || Y.cols() < 1)
+    mitkThrow() << "Samples do not match the feature store: " << X.rows() << "x" << X.cols() << " samples and "
+                << Y.rows() << " labels for " << m_Impl->NumberOfFeatures << " features.";
+
+  std::vector<float> features(m_Impl->NumberOfFeatures);
+  for (Eigen::Index row = 0; row < X.rows(); ++row)
+  {
+    for (Eigen::Index col = 0; col < X.cols(); ++col)
+      features[col] = static_cast<float>(X(row, col));
+    m_Impl->WriteRecord(Y(row, 0), features.data());
+  }
+  m_Impl->FlushBuffer();
+}
+
+void mitk::FeatureStore::AppendImages(const std::vector<mitk::Image::Pointer>& features, const mitk::Image* labels)
+{
+  if (!m_Impl->Writer.is_open())
+    mitkThrow() << "Feature store is not open for writing.";
+
+  if (features.size() != m_Impl->NumberOfFeatures || labels == nullptr)
+    mitkThrow() << "Expected " << m_Impl->NumberOfFeatures << " feature images and a label image.";
+
+  typedef itk::Image<float, 3> FeatureImageType;
+  typedef itk::Image<int, 3> LabelImageType;
+
+  LabelImageType::Pointer itkLabels;
+  mitk::CastToItkImage(labels, itkLabels);
+  const auto size = itkLabels->GetLargestPossibleRegion().GetSize();
+
+  std::vector<FeatureImageType::Pointer> itkFeatures(features.size());
+  for (std::size_t i = 0; i < features.size(); ++i)
+  {
+    mitk::CastToItkImage(features[i], itkFeatures[i]);
+    if (itkFeatures[i]->GetLargestPossibleRegion().GetSize() != size)
+      mitkThrow() << "Feature image " << i << " does not match the size of the label image.";
+  }
+
+  const std::size_t numberOfVoxels = itkLabels->GetLargestPossibleRegion().GetNumberOfPixels();
+  const int* labelData = itkLabels->GetBufferPointer();
+
+  std::vector<float> sample(features.size());
+  for (std::size_t voxel = 0; voxel < numberOfVoxels; ++voxel)
+  {
+    if (labelData[voxel] == 0)
+      continue;
+
+    for (std::size_t i = 0; i < itkFeatures.size(); ++i)
+      sample[i] = itkFeatures[i]->GetBufferPointer()[voxel];
+    m_Impl->WriteRecord(labelData[voxel], sample.data());
+
+    if (m_Impl->Buffer.size() >= WindowSize)
+      m_Impl->FlushBuffer();
+  }
+  m_Impl->FlushBuffer();
+}
+
+void mitk::FeatureStore::Close()
+{
+  if (!m_Impl->Writer.is_open())
+    mitkThrow() << "Feature store is not open for writing.";
+
+  for (const auto& entry : m_Impl->FirstSampleOfLabels)
+  {
+    LabelEntry labelEntry;
+    labelEntry.Label = entry.first;
+    labelEntry.Reserved = 0;
+    labelEntry.FirstSample = entry.second;
+    m_Impl->Writer.write(reinterpret_cast<const char*>(&labelEntry), sizeof(labelEntry));
+  }
+
+  FileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.Magic, Magic, sizeof(Magic));
+  header.NumberOfSamples = m_Impl->NumberOfSamples;
+  header.NumberOfFeatures = m_Impl->NumberOfFeatures;
+  header.NumberOfLabels = static_cast<std::uint32_t>(m_Impl->FirstSampleOfLabels.size());
+  m_Impl->Writer.seekp(0);
+  m_Impl->Writer.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_Impl->Writer.close();
+
+  if (!m_Impl->Writer)
+    mitkThrow() << "Feature store " << m_Impl->FileName << " could not be written.";
+
+  this->Open(m_Impl->FileName);
+}
+
+void mitk::FeatureStore::Open(const std::string& fileName)
+{
+  m_Impl->CloseMapping();
+  if (m_Impl->Writer.is_open())
+    m_Impl->Writer.close();
+
+  std::ifstream reader(fileName, std::ios::binary);
+  FileHeader header;
+  if (!reader.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.Magic, Magic, sizeof(Magic)) != 0)
+    mitkThrow() << fileName << " is not a feature store.";
+
+  // the header of a store that was not closed after writing still says 0 samples
+  reader.seekg(0, std::ios::end);
+  const std::uint64_t fileSize = static_cast<std::uint64_t>(reader.tellg());
+  const std::uint64_t recordSize = sizeof(std::int32_t) + static_cast<std::uint64_t>(header.NumberOfFeatures) * sizeof(float);
+  const std::uint64_t expectedSize = sizeof(FileHeader) + header.NumberOfSamples * recordSize + header.NumberOfLabels * sizeof(LabelEntry);
+  if (header.NumberOfSamples == 0)
+    mitkThrow() << "Feature store " << fileName << " contains no samples or was not closed after writing.";
+  if (fileSize != expectedSize)
+    mitkThrow() << "Feature store " << fileName << " is incomplete: " << fileSize << " bytes instead of " << expectedSize << ".";
+
+  m_Impl->FileName = fileName;
+  m_Impl->NumberOfFeatures = header.NumberOfFeatures;
+  m_Impl->NumberOfSamples = header.NumberOfSamples;
+  m_Impl->FirstSampleOfLabels.clear();
+
+  reader.seekg(m_Impl->GetOffset(header.NumberOfSamples));
+  for (std::uint32_t i = 0; i < header.NumberOfLabels; ++i)
+  {
+    LabelEntry labelEntry;
+    if (!reader.read(reinterpret_cast<char*>(&labelEntry), sizeof(labelEntry)))
+      mitkThrow() << "Feature store " << fileName << " is incomplete.";
+    m_Impl->FirstSampleOfLabels[labelEntry.Label] = labelEntry.FirstSample;
+  }
+
+#ifdef _WIN32
+  m_Impl->File = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_Impl->File != INVALID_HANDLE_VALUE)
+    m_Impl->Mapping = CreateFileMappingA(m_Impl->File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+#else
+  m_Impl->Mapping = open(fileName.c_str(), O_RDONLY);
+#endif
+
+  if (m_Impl->Mapping == InvalidMappingHandle)
+  {
+    m_Impl->CloseMapping();
+    mitkThrow() << "Feature store " << fileName << " could not be opened.";
+  }
+}
+
+bool mitk::FeatureStore::IsOpen() const
+{
+  return m_Impl->Mapping != InvalidMappingHandle;
+}
+
+std::string mitk::FeatureStore::GetFileName() const
+{
+  return m_Impl->FileName;
+}
+
+std::uint64_t mitk::FeatureStore::GetNumberOfSamples() const
+{
+  return m_Impl->NumberOfSamples;
+}
+
+unsigned int mitk::FeatureStore::GetNumberOfFeatures() const
+{
+  return m_Impl->NumberOfFeatures;
+}
+
+const std::map<int, std::uint64_t>& mitk::FeatureStore::GetFirstSampleOfLabels() const
+{
+  return m_Impl->FirstSampleOfLabels;
+}
+
+void mitk::FeatureStore::GetSamples(std::uint64_t first, std::size_t count, float* features, int* labels) const
+{
+  m_Impl->CheckOpen();
+
+  if (first + count > m_Impl->NumberOfSamples)
+    mitkThrow() << "Samples " << first << " to " << first + count << " are out of range.";
+
+  const std::size_t recordSize = m_Impl->GetRecordSize();
+  const unsigned int numberOfFeatures = m_Impl->NumberOfFeatures;
+
+  while (count > 0)
+  {
+    const std::size_t windowCount = static_cast<std::size_t>(std::min<std::uint64_t>(count, m_Impl->GetSamplesPerWindow()));
+    MappedWindow window(m_Impl->Mapping, m_Impl->GetOffset(first), windowCount * recordSize);
+
+    for (std::size_t i = 0; i < windowCount; ++i)
+    {
+      ReadRecord(window.GetData() + i * recordSize, numberOfFeatures, features + i * numberOfFeatures,
+        labels != nullptr ? labels + i : nullptr);
+    }
+
+    first += windowCount;
+    count -= windowCount;
+    features += windowCount * numberOfFeatures;
+    if (labels != nullptr)
+      labels += windowCount;
+  }
+}
+
+void mitk::FeatureStore::GetSamples(const std::vector<std::uint64_t>& rows, Eigen::MatrixXd& X, Eigen::MatrixXi& Y) const
+{
+  m_Impl->GatherSamples(rows, X, Y);
+}
+
+void mitk::FeatureStore::GetSamples(const std::vector<std::uint64_t>& rows, Eigen::MatrixXf& X, Eigen::MatrixXi& Y) const
+{
+  m_Impl->GatherSamples(rows, X, Y);
+}
@@ -1,4 +1,5 @@
 set(MODULE_TESTS
+  mitkFeatureStoreTest
   mitkGIFCooc2Test
   mitkGIFCurvatureStatisticTest
   mitkGIFFirstOrderHistogramStatisticsTest
@@ -13,6 +14,8 @@ set(MODULE_TESTS
   mitkGIFNeighbouringGreyLevelDependenceFeatureTest
   mitkGIFVolumetricDensityStatisticsTest
   mitkGIFVolumetricStatisticsTest
+  mitkGlobalImageFeatureEngineTest
+  mitkLocalFeatureMapEngineTest
   #mitkSmoothedClassProbabilitesTest.cpp
   #mitkGlobalFeaturesTest.cpp
 )
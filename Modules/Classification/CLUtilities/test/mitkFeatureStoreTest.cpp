@@ -0,0 +1,217 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkCLUtil.h>
+#include <mitkFeatureStore.h>
+#include <mitkIOUtil.h>
+#include <mitkITKImageImport.h>
+
+#include <itkImage.h>
+#include <itkImageRegionIterator.h>
+#include <itksys/SystemTools.hxx>
+
+#include <fstream>
+#include <iterator>
+#include <random>
+
+class mitkFeatureStoreTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkFeatureStoreTestSuite);
+
+  MITK_TEST(ConsecutiveSamplesMatchAppendedSamples);
+  MITK_TEST(ScatteredSamplesMatchAppendedSamples);
+  MITK_TEST(OpenedStoreMatchesWrittenStore);
+  MITK_TEST(IncompleteStoresAreRejected);
+  MITK_TEST(ImageSamplesAreOrderedLikeTransform);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  std::string m_FileName;
+  mitk::FeatureStore::Pointer m_Store;
+  Eigen::MatrixXd m_X;
+  Eigen::MatrixXi m_Y;
+
+public:
+
+  void setUp() override
+  {
+    std::mt19937 generator(42);
+    std::normal_distribution<double> distribution;
+
+    m_X.resize(1000, 5);
+    m_Y.resize(1000, 1);
+    for (int row = 0; row < m_X.rows(); ++row)
+    {
+      // label 3 is rare and appears first in the second chunk
+      m_Y(row, 0) = row == 600 ? 3 : 1 + row % 2;
+      for (int col = 0; col < m_X.cols(); ++col)
+        m_X(row, col) = static_cast<float>(distribution(generator));
+    }
+
+    m_FileName = mitk::IOUtil::CreateTemporaryFile("FeatureStoreTest_XXXXXX.fst");
+    m_Store = mitk::FeatureStore::New();
+    m_Store->Create(m_FileName, m_X.cols());
+    m_Store->Append(m_X.topRows(500), m_Y.topRows(500));
+    m_Store->Append(m_X.bottomRows(500), m_Y.bottomRows(500));
+    m_Store->Close();
+  }
+
+  void tearDown() override
+  {
+    m_Store = nullptr;
+    itksys::SystemTools::RemoveFile(m_FileName);
+  }
+
+  void ConsecutiveSamplesMatchAppendedSamples()
+  {
+    CPPUNIT_ASSERT(m_Store->IsOpen());
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(1000), m_Store->GetNumberOfSamples());
+    CPPUNIT_ASSERT_EQUAL(5u, m_Store->GetNumberOfFeatures());
+
+    std::vector<float> features(300 * 5);
+    std::vector<int> labels(300);
+    m_Store->GetSamples(450, 300, features.data(), labels.data());
+
+    for (int i = 0; i < 300; ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(m_Y(450 + i, 0), labels[i]);
+      for (int col = 0; col < 5; ++col)
+        CPPUNIT_ASSERT_EQUAL(static_cast<float>(m_X(450 + i, col)), features[i * 5 + col]);
+    }
+
+    CPPUNIT_ASSERT_THROW(m_Store->GetSamples(900, 101, features.data(), nullptr), mitk::Exception);
+  }
+
+  void ScatteredSamplesMatchAppendedSamples()
+  {
+    std::vector<std::uint64_t> rows = {999, 3, 600, 3, 0, 512};
+    Eigen::MatrixXd X;
+    Eigen::MatrixXi Y;
+    m_Store->GetSamples(rows, X, Y);
+
+    CPPUNIT_ASSERT_EQUAL(Eigen::Index(rows.size()), X.rows());
+    for (std::size_t i = 0; i < rows.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(m_Y(rows[i], 0), Y(i, 0));
+      for (int col = 0; col < 5; ++col)
+        CPPUNIT_ASSERT_EQUAL(m_X(rows[i], col), X(i, col));
+    }
+
+    Eigen::MatrixXf floatX;
+    m_Store->GetSamples(rows, floatX, Y);
+    CPPUNIT_ASSERT(floatX == X.cast<float>());
+  }
+
+  void OpenedStoreMatchesWrittenStore()
+  {
+    auto store = mitk::FeatureStore::New();
+    store->Open(m_FileName);
+
+    CPPUNIT_ASSERT_EQUAL(m_Store->GetNumberOfSamples(), store->GetNumberOfSamples());
+    CPPUNIT_ASSERT_EQUAL(m_Store->GetNumberOfFeatures(), store->GetNumberOfFeatures());
+
+    const auto & firstSamples = store->GetFirstSampleOfLabels();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), firstSamples.size());
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(0), firstSamples.at(1));
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(1), firstSamples.at(2));
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(600), firstSamples.at(3));
+
+    auto invalid = mitk::FeatureStore::New();
+    CPPUNIT_ASSERT_THROW(invalid->Open(GetTestDataFilePath("Pic3D.nrrd")), mitk::Exception);
+  }
+
+  void IncompleteStoresAreRejected()
+  {
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("FeatureStoreIncompleteTest_XXXXXX.fst");
+
+    // written, but not closed
+    {
+      auto unclosed = mitk::FeatureStore::New();
+      unclosed->Create(fileName, m_X.cols());
+      unclosed->Append(m_X, m_Y);
+    }
+    auto store = mitk::FeatureStore::New();
+    CPPUNIT_ASSERT_THROW(store->Open(fileName), mitk::Exception);
+    CPPUNIT_ASSERT(!store->IsOpen());
+
+    // truncated copy of a complete store
+    {
+      std::ifstream input(m_FileName, std::ios::binary);
+      std::vector<char> content((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+      std::ofstream output(fileName, std::ios::binary | std::ios::trunc);
+      output.write(content.data(), content.size() - 100);
+    }
+    CPPUNIT_ASSERT_THROW(store->Open(fileName), mitk::Exception);
+    CPPUNIT_ASSERT(!store->IsOpen());
+
+    store = nullptr;
+    itksys::SystemTools::RemoveFile(fileName);
+  }
+
+  void ImageSamplesAreOrderedLikeTransform()
+  {
+    typedef itk::Image<double, 3> ImageType;
+    typedef itk::Image<int, 3> LabelImageType;
+
+    ImageType::RegionType region;
+    region.SetSize(0, 7);
+    region.SetSize(1, 5);
+    region.SetSize(2, 3);
+
+    auto itkFeature = ImageType::New();
+    itkFeature->SetRegions(region);
+    itkFeature->Allocate();
+    auto itkLabels = LabelImageType::New();
+    itkLabels->SetRegions(region);
+    itkLabels->Allocate();
+
+    itk::ImageRegionIterator<ImageType> it(itkFeature, region);
+    itk::ImageRegionIterator<LabelImageType> labelIt(itkLabels, region);
+    for (int i = 0; !it.IsAtEnd(); ++it, ++labelIt, ++i)
+    {
+      it.Set(0.5 * i);
+      labelIt.Set(i % 4 == 0 ? 0 : i % 3 + 1);
+    }
+
+    mitk::Image::Pointer feature = mitk::GrabItkImageMemory(itkFeature.GetPointer());
+    mitk::Image::Pointer labels = mitk::GrabItkImageMemory(itkLabels.GetPointer());
+
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("FeatureStoreImageTest_XXXXXX.fst");
+    auto store = mitk::FeatureStore::New();
+    store->Create(fileName, 2);
+    store->AppendImages({feature, feature}, labels);
+    store->Close();
+
+    Eigen::MatrixXd expected = mitk::CLUtil::Transform<double>(feature, labels);
+    CPPUNIT_ASSERT_EQUAL(std::uint64_t(expected.rows()), store->GetNumberOfSamples());
+
+    std::vector<float> features(expected.rows() * 2);
+    std::vector<int> sampleLabels(expected.rows());
+    store->GetSamples(0, expected.rows(), features.data(), sampleLabels.data());
+
+    for (int row = 0; row < expected.rows(); ++row)
+    {
+      CPPUNIT_ASSERT(sampleLabels[row] != 0);
+      CPPUNIT_ASSERT_EQUAL(static_cast<float>(expected(row, 0)), features[row * 2]);
+      CPPUNIT_ASSERT_EQUAL(static_cast<float>(expected(row, 0)), features[row * 2 + 1]);
+    }
+
+    store = nullptr;
+    itksys::SystemTools::RemoveFile(fileName);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkFeatureStore)
@@ -16,6 +16,10 @@ found in the LICENSE file.
 #include <cmath>
 
 #include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkImageCast.h>
+#include <mitkITKImageImport.h>
+
+#include <itkConstantPadImageFilter.h>
 
 class mitkGIFCooc2TestSuite : public mitk::TestFixture
 {
@@ -23,6 +27,7 @@ class mitkGIFCooc2TestSuite : public mitk::TestFixture
 
   MITK_TEST(ImageDescription_PhantomTest_3D);
   MITK_TEST(ImageDescription_PhantomTest_2D);
+  MITK_TEST(PaddedImage_SameFeaturesTest);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -32,6 +37,29 @@ private:
   mitk::Image::Pointer m_IBSI_Phantom_Mask_Small;
   mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
 
+  template <typename TPixel>
+  static mitk::Image::Pointer Pad(const mitk::Image* image, TPixel value, unsigned long lowerPadding, unsigned long upperPadding)
+  {
+    typedef itk::Image<TPixel, 3> ImageType;
+    typename ImageType::Pointer itkImage = ImageType::New();
+    mitk::CastToItkImage(image, itkImage);
+
+    typename ImageType::SizeType lowerBound;
+    typename ImageType::SizeType upperBound;
+    lowerBound.Fill(lowerPadding);
+    upperBound.Fill(upperPadding);
+
+    typedef itk::ConstantPadImageFilter<ImageType, ImageType> PadFilterType;
+    typename PadFilterType::Pointer padFilter = PadFilterType::New();
+    padFilter->SetInput(itkImage);
+    padFilter->SetPadLowerBound(lowerBound);
+    padFilter->SetPadUpperBound(upperBound);
+    padFilter->SetConstant(value);
+    padFilter->Update();
+
+    return mitk::GrabItkImageMemory(padFilter->GetOutput());
+  }
+
 public:
 
   void setUp(void) override
@@ -242,6 +270,35 @@ public:
     CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("SliceWise Mean Co-occurenced Based Features::Mean Second Row-Column Entropy with Large IBSI Phantom Image", 2.24761, results["SliceWise Mean Co-occurenced Based Features::Mean Second Row-Column Entropy"], 0.001);
   }
 
+  void PaddedImage_SameFeaturesTest()
+  {
+    // The matrices are only accumulated within the bounding box of the mask, voxels
+    // outside of the mask must not change any feature.
+    mitk::Image::Pointer image = Pad<double>(m_IBSI_Phantom_Image_Large, 0.0, 0, 0);
+    mitk::Image::Pointer mask = Pad<unsigned short>(m_IBSI_Phantom_Mask_Large, 0, 0, 0);
+    mitk::Image::Pointer paddedImage = Pad<double>(m_IBSI_Phantom_Image_Large, 3.0, 3, 2);
+    mitk::Image::Pointer paddedMask = Pad<unsigned short>(m_IBSI_Phantom_Mask_Large, 0, 3, 2);
+
+    mitk::GIFCooccurenceMatrix2::Pointer featureCalculator = mitk::GIFCooccurenceMatrix2::New();
+    featureCalculator->SetUseBinsize(true);
+    featureCalculator->SetBinsize(1.0);
+    featureCalculator->SetUseMinimumIntensity(true);
+    featureCalculator->SetUseMaximumIntensity(true);
+    featureCalculator->SetMinimumIntensity(0.5);
+    featureCalculator->SetMaximumIntensity(6.5);
+
+    auto featureList = featureCalculator->CalculateFeatures(image, mask);
+    auto paddedFeatureList = featureCalculator->CalculateFeatures(paddedImage, paddedMask);
+
+    CPPUNIT_ASSERT_EQUAL(featureList.size(), paddedFeatureList.size());
+    for (std::size_t i = 0; i < featureList.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(featureList[i].first, paddedFeatureList[i].first);
+      CPPUNIT_ASSERT_MESSAGE(featureList[i].first, featureList[i].second == paddedFeatureList[i].second
+        || (std::isnan(featureList[i].second) && std::isnan(paddedFeatureList[i].second)));
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkGIFCooc2 )
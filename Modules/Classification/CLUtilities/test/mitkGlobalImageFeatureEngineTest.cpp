@@ -0,0 +1,229 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include "mitkIOUtil.h"
+
+#include <mitkGlobalImageFeatureEngine.h>
+#include <mitkGIFCooccurenceMatrix2.h>
+#include <mitkGIFFirstOrderStatistics.h>
+#include <mitkGIFGreyLevelSizeZone.h>
+
+#include <algorithm>
+#include <thread>
+
+class mitkGlobalImageFeatureEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkGlobalImageFeatureEngineTestSuite);
+
+  MITK_TEST(ResultsMatchSequentialCalculation);
+  MITK_TEST(ResultsAreIndependentOfNumberOfThreads);
+  MITK_TEST(ConcurrentCasesShareTheCores);
+  MITK_TEST(CroppingKeepsMaskedFeatures);
+  MITK_TEST(MissingFactoryThrows);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Small;
+  mitk::Image::Pointer m_IBSI_Phantom_Image_Large;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Small;
+  mitk::Image::Pointer m_IBSI_Phantom_Mask_Large;
+
+  static mitk::GlobalImageFeatureEngine::FeatureSetType CreateFeatureSet()
+  {
+    mitk::GlobalImageFeatureEngine::FeatureSetType features;
+    features.push_back(mitk::GIFFirstOrderStatistics::New().GetPointer());
+    features.push_back(mitk::GIFCooccurenceMatrix2::New().GetPointer());
+    features.push_back(mitk::GIFGreyLevelSizeZone::New().GetPointer());
+
+    for (auto feature : features)
+    {
+      feature->SetUseBinsize(true);
+      feature->SetBinsize(1);
+      feature->SetUseMinimumIntensity(true);
+      feature->SetUseMaximumIntensity(true);
+      feature->SetMinimumIntensity(0.5);
+      feature->SetMaximumIntensity(6.5);
+    }
+    return features;
+  }
+
+  std::vector<mitk::GlobalImageFeatureEngine::Case> CreateCases()
+  {
+    std::vector<mitk::GlobalImageFeatureEngine::Case> cases(3);
+    cases[0].Image = m_IBSI_Phantom_Image_Large;
+    cases[0].Mask = m_IBSI_Phantom_Mask_Large;
+    cases[1].Image = m_IBSI_Phantom_Image_Small;
+    cases[1].Mask = m_IBSI_Phantom_Mask_Small;
+    cases[2].Image = m_IBSI_Phantom_Image_Large;
+    cases[2].Mask = m_IBSI_Phantom_Mask_Large;
+    return cases;
+  }
+
+  static void AssertEqual(const mitk::GlobalImageFeatureEngine::FeatureListType& expected,
+    const mitk::GlobalImageFeatureEngine::FeatureListType& actual)
+  {
+    CPPUNIT_ASSERT_EQUAL(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(expected[i].first, actual[i].first);
+      // NaN is a valid feature value and has to match as well
+      CPPUNIT_ASSERT_MESSAGE(expected[i].first, expected[i].second == actual[i].second
+        || (expected[i].second != expected[i].second && actual[i].second != actual[i].second));
+    }
+  }
+
+public:
+
+  void setUp(void) override
+  {
+    m_IBSI_Phantom_Image_Small = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Small.nrrd"));
+    m_IBSI_Phantom_Image_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Image_Large.nrrd"));
+    m_IBSI_Phantom_Mask_Small = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Small.nrrd"));
+    m_IBSI_Phantom_Mask_Large = mitk::IOUtil::Load<mitk::Image>(GetTestDataFilePath("Radiomics/IBSI_Phantom_Mask_Large.nrrd"));
+  }
+
+  void ResultsMatchSequentialCalculation()
+  {
+    auto cases = CreateCases();
+
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->SetFeatureSetFactory(&CreateFeatureSet);
+    engine->SetNumberOfThreads(4);
+    auto results = engine->CalculateFeatures(cases);
+
+    CPPUNIT_ASSERT_EQUAL(cases.size(), results.size());
+    for (std::size_t i = 0; i < cases.size(); ++i)
+    {
+      auto prepared = mitk::GlobalImageFeatureEngine::PrepareCase(cases[i]);
+
+      mitk::GlobalImageFeatureEngine::FeatureListType expected;
+      for (auto feature : CreateFeatureSet())
+      {
+        feature->SetMorphMask(prepared.MorphMask);
+        feature->CalculateFeaturesUsingParameters(prepared.Image, prepared.Mask, prepared.MaskNoNaN, expected);
+      }
+
+      CPPUNIT_ASSERT(!expected.empty());
+      AssertEqual(expected, results[i]);
+    }
+  }
+
+  void ResultsAreIndependentOfNumberOfThreads()
+  {
+    auto cases = CreateCases();
+
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->SetFeatureSetFactory(&CreateFeatureSet);
+
+    engine->SetNumberOfThreads(1);
+    auto sequential = engine->CalculateFeatures(cases);
+    engine->SetNumberOfThreads(3);
+    auto parallel = engine->CalculateFeatures(cases);
+
+    CPPUNIT_ASSERT_EQUAL(sequential.size(), parallel.size());
+    for (std::size_t i = 0; i < sequential.size(); ++i)
+      AssertEqual(sequential[i], parallel[i]);
+
+    // identical cases give identical results
+    AssertEqual(parallel[0], parallel[2]);
+  }
+
+  void ConcurrentCasesShareTheCores()
+  {
+    std::vector<mitk::GlobalImageFeatureEngine::Case> cases;
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+      auto moreCases = CreateCases();
+      cases.insert(cases.end(), moreCases.begin(), moreCases.end());
+    }
+
+    // the factory is only called by the calling thread
+    std::vector<mitk::AbstractGlobalImageFeature::Pointer> createdFeatures;
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->SetFeatureSetFactory([&createdFeatures]() {
+      auto features = CreateFeatureSet();
+      createdFeatures.insert(createdFeatures.end(), features.begin(), features.end());
+      return features;
+    });
+
+    engine->SetNumberOfThreads(1);
+    auto sequential = engine->CalculateFeatures(cases);
+
+    const unsigned int numberOfCores = std::max(1u, std::thread::hardware_concurrency());
+    CPPUNIT_ASSERT_EQUAL(numberOfCores, createdFeatures.front()->GetNumberOfThreads());
+
+    // several cases at once, the feature classes of every worker only get their share of the cores
+    createdFeatures.clear();
+    engine->SetNumberOfThreads(4);
+    auto parallel = engine->CalculateFeatures(cases);
+
+    const std::size_t numberOfWorkers = createdFeatures.size() / CreateFeatureSet().size();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), numberOfWorkers);
+    for (auto feature : createdFeatures)
+    {
+      CPPUNIT_ASSERT(feature->GetNumberOfThreads() >= 1);
+      CPPUNIT_ASSERT(numberOfWorkers * feature->GetNumberOfThreads() <= std::max<std::size_t>(numberOfCores, numberOfWorkers));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(sequential.size(), parallel.size());
+    for (std::size_t i = 0; i < sequential.size(); ++i)
+      AssertEqual(sequential[i], parallel[i]);
+  }
+
+  void CroppingKeepsMaskedFeatures()
+  {
+    mitk::GlobalImageFeatureEngine::Case singleCase;
+    singleCase.Image = m_IBSI_Phantom_Image_Large;
+    singleCase.Mask = m_IBSI_Phantom_Mask_Large;
+
+    auto prepared = mitk::GlobalImageFeatureEngine::PrepareCase(singleCase, 1);
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      CPPUNIT_ASSERT(prepared.Image->GetDimension(i) <= m_IBSI_Phantom_Image_Large->GetDimension(i));
+      CPPUNIT_ASSERT_EQUAL(prepared.Image->GetDimension(i), prepared.Mask->GetDimension(i));
+      CPPUNIT_ASSERT_EQUAL(prepared.Image->GetDimension(i), prepared.MaskNoNaN->GetDimension(i));
+    }
+
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    engine->SetFeatureSetFactory([]() {
+      mitk::GlobalImageFeatureEngine::FeatureSetType features;
+      features.push_back(CreateFeatureSet().front());
+      return features;
+    });
+
+    auto uncropped = engine->CalculateFeatures(singleCase);
+    engine->SetCropMargin(1);
+    auto cropped = engine->CalculateFeatures(singleCase);
+
+    std::map<std::string, double> uncroppedResults(uncropped.begin(), uncropped.end());
+    std::map<std::string, double> croppedResults(cropped.begin(), cropped.end());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(uncroppedResults["First Order::Mean"], croppedResults["First Order::Mean"], 1e-10);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(uncroppedResults["First Order::Maximum"], croppedResults["First Order::Maximum"], 1e-10);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(uncroppedResults["First Order::Number Of Voxels"], croppedResults["First Order::Number Of Voxels"], 1e-10);
+  }
+
+  void MissingFactoryThrows()
+  {
+    mitk::GlobalImageFeatureEngine::Pointer engine = mitk::GlobalImageFeatureEngine::New();
+    CPPUNIT_ASSERT_THROW(engine->CalculateFeatures(CreateCases()), mitk::Exception);
+
+    engine->SetFeatureSetFactory(&CreateFeatureSet);
+    std::vector<mitk::GlobalImageFeatureEngine::Case> cases(1);
+    cases[0].Image = m_IBSI_Phantom_Image_Large;
+    CPPUNIT_ASSERT_THROW(engine->CalculateFeatures(cases), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkGlobalImageFeatureEngine)
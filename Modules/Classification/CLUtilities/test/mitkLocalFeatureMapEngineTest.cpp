@@ -0,0 +1,278 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkITKImageImport.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkLocalFeatureMapEngine.h>
+
+#include <itkImage.h>
+#include <itkImageRegionIterator.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+class mitkLocalFeatureMapEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLocalFeatureMapEngineTestSuite);
+
+  MITK_TEST(FeatureMapMatchesWindowCalculation);
+  MITK_TEST(ResultsAreIndependentOfNumberOfThreads);
+  MITK_TEST(MaskRestrictsCalculation);
+  MITK_TEST(SampleMatrixMatchesFeatureMap);
+
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<double, 3> ImageType;
+  typedef itk::Image<unsigned char, 3> MaskType;
+
+  static const int SizeX = 11;
+  static const int SizeY = 9;
+  static const int SizeZ = 7;
+
+  ImageType::Pointer m_ItkImage;
+  mitk::Image::Pointer m_Image;
+  mitk::Image::Pointer m_Mask;
+
+  mitk::LocalFeatureMapEngine::Pointer CreateEngine(unsigned int radius)
+  {
+    auto engine = mitk::LocalFeatureMapEngine::New();
+    engine->SetRadius(radius);
+    engine->SetBins(8);
+    engine->SetMinimumIntensity(0);
+    engine->SetUseMinimumIntensity(true);
+    engine->SetMaximumIntensity(8);
+    engine->SetUseMaximumIntensity(true);
+    return engine;
+  }
+
+  int GetBin(int x, int y, int z) const
+  {
+    ImageType::IndexType index = {{x, y, z}};
+    const double value = m_ItkImage->GetPixel(index);
+    if (value != value)
+      return -1;
+    return std::min(7, static_cast<int>(std::floor(value)));
+  }
+
+  /** \brief Calculates the features of a single window without any incremental update. */
+  std::vector<double> CalculateWindow(int x, int y, int z, int radius) const
+  {
+    auto inside = [&](int i, int j, int k) {
+      return i >= 0 && j >= 0 && k >= 0 && i < SizeX && j < SizeY && k < SizeZ &&
+             std::abs(i - x) <= radius && std::abs(j - y) <= radius && std::abs(k - z) <= radius;
+    };
+
+    std::vector<double> histogram(8, 0.0);
+    std::vector<double> matrix(64, 0.0);
+    double sum = 0, squaredSum = 0, n = 0, pairs = 0;
+
+    for (int k = z - radius; k <= z + radius; ++k)
+    {
+      for (int j = y - radius; j <= y + radius; ++j)
+      {
+        for (int i = x - radius; i <= x + radius; ++i)
+        {
+          if (!inside(i, j, k) || GetBin(i, j, k) < 0)
+            continue;
+
+          ImageType::IndexType index = {{i, j, k}};
+          const double value = m_ItkImage->GetPixel(index);
+          sum += value;
+          squaredSum += value * value;
+          n += 1;
+          histogram[GetBin(i, j, k)] += 1;
+
+          for (int dz = -1; dz <= 1; ++dz)
+            for (int dy = -1; dy <= 1; ++dy)
+              for (int dx = -1; dx <= 1; ++dx)
+              {
+                if ((dx == 0 && dy == 0 && dz == 0) || !inside(i + dx, j + dy, k + dz) || GetBin(i + dx, j + dy, k + dz) < 0)
+                  continue;
+                // every pair is found from both sides, which gives the symmetric matrix
+                matrix[GetBin(i, j, k) * 8 + GetBin(i + dx, j + dy, k + dz)] += 1;
+                pairs += 0.5;
+              }
+        }
+      }
+    }
+
+    std::vector<double> features(10, 0.0);
+    const double mean = sum / n;
+    features[0] = mean;
+    features[1] = std::sqrt(squaredSum / n - mean * mean);
+    for (auto count : histogram)
+    {
+      if (count > 0)
+        features[2] -= count / n * std::log2(count / n);
+      features[3] += (count / n) * (count / n);
+    }
+
+    double mu = 0;
+    for (int i = 0; i < 8; ++i)
+      for (int j = 0; j < 8; ++j)
+        mu += i * matrix[i * 8 + j] / (2 * pairs);
+
+    double variance = 0, covariance = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+      for (int j = 0; j < 8; ++j)
+      {
+        const double p = matrix[i * 8 + j] / (2 * pairs);
+        features[4] += p * (i - j) * (i - j);
+        features[5] += p * std::abs(i - j);
+        features[6] += p / (1.0 + std::abs(i - j));
+        features[7] += p * p;
+        if (p > 0)
+          features[8] -= p * std::log2(p);
+        variance += p * (i - mu) * (i - mu);
+        covariance += p * (i - mu) * (j - mu);
+      }
+    }
+    features[9] = variance > 1e-12 ? covariance / variance : 1.0;
+    return features;
+  }
+
+  static std::vector<float> GetData(const mitk::Image::Pointer& image)
+  {
+    mitk::ImageReadAccessor accessor(image);
+    const float* data = static_cast<const float*>(accessor.GetData());
+    const std::size_t size = SizeX * SizeY * SizeZ * image->GetPixelType().GetNumberOfComponents();
+    return std::vector<float>(data, data + size);
+  }
+
+public:
+
+  void setUp() override
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(0.0, 8.0);
+
+    m_ItkImage = ImageType::New();
+    ImageType::RegionType region;
+    region.SetSize(0, SizeX);
+    region.SetSize(1, SizeY);
+    region.SetSize(2, SizeZ);
+    m_ItkImage->SetRegions(region);
+    m_ItkImage->Allocate();
+
+    auto itkMask = MaskType::New();
+    itkMask->SetRegions(region);
+    itkMask->Allocate();
+
+    itk::ImageRegionIterator<ImageType> it(m_ItkImage, region);
+    itk::ImageRegionIterator<MaskType> maskIt(itkMask, region);
+    for (unsigned int i = 0; !it.IsAtEnd(); ++it, ++maskIt, ++i)
+    {
+      it.Set(i % 37 == 5 ? std::numeric_limits<double>::quiet_NaN() : distribution(generator));
+      maskIt.Set(i % 3 == 0 ? 1 : 0);
+    }
+
+    m_Image = mitk::GrabItkImageMemory(m_ItkImage.GetPointer());
+    m_Mask = mitk::GrabItkImageMemory(itkMask.GetPointer());
+  }
+
+  void tearDown() override
+  {
+    m_ItkImage = nullptr;
+    m_Image = nullptr;
+    m_Mask = nullptr;
+  }
+
+  void FeatureMapMatchesWindowCalculation()
+  {
+    const auto names = mitk::LocalFeatureMapEngine::GetFeatureNames();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(10), names.size());
+
+    for (int radius = 1; radius <= 2; ++radius)
+    {
+      auto featureMap = CreateEngine(radius)->CalculateFeatureMap(m_Image);
+      CPPUNIT_ASSERT_EQUAL(10u, featureMap->GetPixelType().GetNumberOfComponents());
+
+      const auto data = GetData(featureMap);
+      for (int z = 0; z < SizeZ; ++z)
+      {
+        for (int y = 0; y < SizeY; ++y)
+        {
+          for (int x = 0; x < SizeX; ++x)
+          {
+            const auto expected = CalculateWindow(x, y, z, radius);
+            const std::size_t index = x + SizeX * (y + SizeY * z);
+            for (std::size_t f = 0; f < expected.size(); ++f)
+              CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(names[f], expected[f], data[index * 10 + f], 1e-4 * (1 + std::abs(expected[f])));
+          }
+        }
+      }
+    }
+  }
+
+  void ResultsAreIndependentOfNumberOfThreads()
+  {
+    auto engine = CreateEngine(2);
+    engine->SetNumberOfThreads(1);
+    const auto sequential = GetData(engine->CalculateFeatureMap(m_Image));
+    engine->SetNumberOfThreads(4);
+    const auto parallel = GetData(engine->CalculateFeatureMap(m_Image));
+
+    CPPUNIT_ASSERT(sequential == parallel);
+  }
+
+  void MaskRestrictsCalculation()
+  {
+    auto engine = CreateEngine(1);
+    const auto full = GetData(engine->CalculateFeatureMap(m_Image));
+    const auto masked = GetData(engine->CalculateFeatureMap(m_Image, m_Mask));
+
+    for (std::size_t i = 0; i < full.size(); ++i)
+    {
+      // the window is restarted at gaps of the mask, so the sums can differ by rounding
+      const bool inside = (i / 10) % 3 == 0;
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(inside ? full[i] : 0.0, masked[i], 1e-5 * (1 + std::abs(full[i])));
+    }
+
+    auto wrongMask = mitk::Image::New();
+    unsigned int dimensions[3] = {SizeX, SizeY, 1};
+    wrongMask->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+    CPPUNIT_ASSERT_THROW(engine->CalculateFeatureMap(m_Image, wrongMask), mitk::Exception);
+  }
+
+  void SampleMatrixMatchesFeatureMap()
+  {
+    auto featureMap = CreateEngine(1)->CalculateFeatureMap(m_Image, m_Mask);
+    const auto data = GetData(featureMap);
+
+    auto samples = mitk::LocalFeatureMapEngine::CreateSampleMatrix(featureMap, m_Mask);
+    auto images = mitk::LocalFeatureMapEngine::SplitFeatureMap(featureMap);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(10), images.size());
+    CPPUNIT_ASSERT_EQUAL(Eigen::Index(10), samples.cols());
+    CPPUNIT_ASSERT_EQUAL(Eigen::Index((SizeX * SizeY * SizeZ + 2) / 3), samples.rows());
+
+    for (std::size_t f = 0; f < images.size(); ++f)
+    {
+      const auto component = GetData(images[f]);
+      Eigen::Index row = 0;
+      for (std::size_t i = 0; i < component.size(); ++i)
+      {
+        CPPUNIT_ASSERT_EQUAL(data[i * 10 + f], component[i]);
+        if (i % 3 == 0)
+          CPPUNIT_ASSERT_EQUAL(static_cast<double>(component[i]), samples(row++, f));
+      }
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLocalFeatureMapEngine)
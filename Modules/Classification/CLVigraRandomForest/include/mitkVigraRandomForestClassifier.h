@@ -20,6 +20,10 @@ found in the LICENSE file.
 #include <vigra/random_forest.hxx>
 
 #include <mitkBaseData.h>
+#include <mitkFeatureStore.h>
+#include <mitkImage.h>
+
+#include <memory>
 
 namespace mitk
 {
@@ -42,6 +46,46 @@ namespace mitk
     Eigen::MatrixXi Predict(const Eigen::MatrixXd &X) override;
     Eigen::MatrixXi PredictWeighted(const Eigen::MatrixXd &X);
 
+    ///
+    /// @brief Trains the forest with the samples of a feature store.
+    ///
+    /// Every tree draws its own sample of SamplesPerTree * N rows (with or without replacement)
+    /// from the store and keeps their float values. By default the trees are learned one after
+    /// the other, see SetStoreTrainingMemoryBudget() to learn several trees at the same time.
+    /// Stratification and point wise weights are not supported and ignored.
+    ///
+    void Train(const mitk::FeatureStore * store);
+
+    ///
+    /// @brief Predicts the labels of all samples of a feature store, reading one chunk at a time.
+    ///
+    /// Only the labels are kept, GetPointWiseProbabilities() is empty afterwards.
+    ///
+    Eigen::MatrixXi Predict(const mitk::FeatureStore * store);
+
+    ///
+    /// @brief Predicts the class of every voxel of the mask and writes it directly into an image.
+    ///
+    /// The samples are read block-wise from the feature map, so no sample or probability matrix
+    /// of the whole image is created. The results are identical to Predict() with the features
+    /// of the masked voxels (see mitk::LocalFeatureMapEngine::CreateSampleMatrix()).
+    /// @param featureMap float image with one component per feature, e.g. created by mitk::LocalFeatureMapEngine
+    /// @param mask voxels with a value other than 0 are classified, all other voxels are 0 in the label image
+    /// @param probabilities optional, set to a float image with one component per class
+    /// @return int image with the predicted labels
+    ///
+    mitk::Image::Pointer PredictImage(const mitk::Image* featureMap, const mitk::Image* mask, mitk::Image::Pointer* probabilities = nullptr);
+
+    ///
+    /// @brief Use the compiled forest for predictions (default).
+    ///
+    /// The trained forest is converted once into a single contiguous array of nodes (threshold,
+    /// feature and the index of the children) and the samples are classified in blocks tree by
+    /// tree, so the nodes of a tree stay in cache for the whole block. If disabled or if the
+    /// forest contains nodes other than threshold splits and probability leaves, vigra is used.
+    ///
+    void UseCompiledForest(bool);
+    bool IsUsingCompiledForest() const;
 
     bool SupportsPointWiseWeight() override;
     bool SupportsPointWiseProbability() override;
@@ -59,6 +103,15 @@ namespace mitk
     void SetTreeCount(int);
     void SetWeightLambda(double);
 
+    ///
+    /// @brief Memory in MB the samples of trees learned at the same time by Train(const FeatureStore*) may use.
+    ///
+    /// The samples of a tree are estimated to take SamplesPerTree * N * ((number of features) * 4 + 32) bytes.
+    /// As many trees as fit into the budget by this estimate are learned in parallel, at least one.
+    /// Default: 0, i.e. one tree at a time.
+    ///
+    void SetStoreTrainingMemoryBudget(double megabytes);
+
     void SetTreeWeights(Eigen::MatrixXd weights);
     void SetTreeWeight(int treeId, double weight);
     Eigen::MatrixXd GetTreeWeights() const;
@@ -75,6 +128,10 @@ namespace mitk
     struct PredictionData;
     struct EigenToVigraTransform;
     struct Parameter;
+    struct CompiledForest;
+
+    const CompiledForest * GetCompiledForest();
+    void PredictCompiled(const CompiledForest & forest, const Eigen::MatrixXd & X, const double * treeWeights);
 
     vigra::MultiArrayView<2, double> m_Probabilities;
     Eigen::MatrixXd m_TreeWeights;
@@ -82,6 +139,9 @@ namespace mitk
     Parameter * m_Parameter;
     vigra::RandomForest<int> m_RandomForest;
 
+    bool m_UseCompiledForest;
+    std::shared_ptr<const CompiledForest> m_CompiledForest; ///< created on demand, shared by clones
+
     static ITK_THREAD_RETURN_TYPE TrainTreesCallback(void *);
     static ITK_THREAD_RETURN_TYPE PredictCallback(void *);
     static ITK_THREAD_RETURN_TYPE PredictWeightedCallback(void *);
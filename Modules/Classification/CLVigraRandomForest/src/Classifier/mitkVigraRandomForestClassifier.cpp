@@ -16,6 +16,11 @@ found in the LICENSE file.
 #include <mitkImpurityLoss.h>
 #include <mitkLinearSplitting.h>
 #include <mitkProperties.h>
+#include <mitkExceptionMacro.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkLogMacros.h>
 
 // Vigra includes
 #include <vigra/random_forest.hxx>
@@ -25,6 +30,18 @@ found in the LICENSE file.
 #include <itkFastMutexLock.h>
 #include <itkMultiThreader.h>
 #include <itkCommand.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkVectorImage.h>
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <queue>
+#include <random>
+#include <set>
 
 typedef mitk::ThresholdSplit<mitk::LinearSplitting< mitk::ImpurityLoss<> >,int,vigra::ClassificationTag> DefaultSplitType;
 
@@ -40,6 +57,7 @@ struct mitk::VigraRandomForestClassifier::Parameter
   double Precision;
   double WeightLambda;
   double SamplesPerTree;
+  double StoreTrainingMemoryBudget;
 };
 
 struct mitk::VigraRandomForestClassifier::TrainingData
@@ -93,8 +111,227 @@ struct mitk::VigraRandomForestClassifier::PredictionData
   vigra::MultiArrayView<2, double> m_TreeWeights;
 };
 
+struct mitk::VigraRandomForestClassifier::CompiledForest
+{
+  /// Inner nodes send a sample to Next if its feature is smaller than the threshold and to Next + 1
+  /// otherwise. Leaves have no feature, Next is the offset of their data in LeafData.
+  struct Node
+  {
+    double Threshold;
+    int Feature;
+    int Next;
+  };
+
+  std::vector<Node> Nodes;
+  std::vector<int> Roots;
+  std::vector<double> LeafData; ///< number of samples in the leaf followed by the class probabilities
+  std::vector<int> ClassLabels;
+  int NumberOfClasses;
+  int NumberOfFeatures;
+  bool IsSupported;
+
+  explicit CompiledForest(const vigra::RandomForest<int> & rf)
+    : NumberOfClasses(rf.class_count()),
+      NumberOfFeatures(rf.feature_count()),
+      IsSupported(rf.class_count() > 0)
+  {
+    for (int i = 0; i < NumberOfClasses; ++i)
+    {
+      int label;
+      rf.ext_param_.to_classlabel(i, label);
+      ClassLabels.push_back(label);
+    }
+
+    for (int k = 0; k < rf.options_.tree_count_ && IsSupported; ++k)
+    {
+      const auto & tree = rf.trees_[k];
+
+      // breadth first, so both children of a node are neighbours
+      std::queue<std::pair<int, int>> nodes;
+      Roots.push_back(static_cast<int>(Nodes.size()));
+      Nodes.emplace_back();
+      nodes.push(std::make_pair(2, Roots.back())); // the root of a vigra tree is at index 2
+
+      while (!nodes.empty())
+      {
+        const int vigraIndex = nodes.front().first;
+        const int index = nodes.front().second;
+        nodes.pop();
+
+        if (tree.topology_[vigraIndex] == vigra::i_ThresholdNode)
+        {
+          vigra::Node<vigra::i_ThresholdNode> node(tree.topology_, tree.parameters_, vigraIndex);
+          const int children = static_cast<int>(Nodes.size());
+          Nodes.resize(Nodes.size() + 2);
+          Nodes[index].Threshold = node.threshold();
+          Nodes[index].Feature = node.column();
+          Nodes[index].Next = children;
+          nodes.push(std::make_pair(static_cast<int>(node.child(0)), children));
+          nodes.push(std::make_pair(static_cast<int>(node.child(1)), children + 1));
+        }
+        else if (tree.topology_[vigraIndex] == vigra::e_ConstProbNode)
+        {
+          vigra::Node<vigra::e_ConstProbNode> leaf(tree.topology_, tree.parameters_, vigraIndex);
+          Nodes[index].Threshold = 0;
+          Nodes[index].Feature = -1;
+          Nodes[index].Next = static_cast<int>(LeafData.size());
+          LeafData.push_back(leaf.weights());
+          LeafData.insert(LeafData.end(), leaf.prob_begin(), leaf.prob_begin() + NumberOfClasses);
+        }
+        else
+        {
+          IsSupported = false;
+          break;
+        }
+      }
+    }
+  }
+
+  ///
+  /// @brief Classifies a block of samples (row major, numberOfColumns values each).
+  ///
+  /// Without tree weights, the votes are combined like vigra::RandomForest::predictProbabilities()
+  /// and samples containing NaN get zero probabilities. With tree weights, the votes are combined
+  /// like VigraPredictWeighted(). The order of all summations is kept, so the results are identical.
+  ///
+  void Predict(const double * samples, std::size_t numberOfSamples, std::size_t numberOfColumns,
+    bool isSampleWeighted, const double * treeWeights, double * probabilities, double * totalWeights, int * labels) const
+  {
+    std::fill(probabilities, probabilities + numberOfSamples * NumberOfClasses, 0.0);
+    std::fill(totalWeights, totalWeights + numberOfSamples, 0.0);
+
+    std::vector<char> skip(numberOfSamples, 0);
+    if (treeWeights == nullptr)
+    {
+      for (std::size_t s = 0; s < numberOfSamples; ++s)
+      {
+        const double * sample = samples + s * numberOfColumns;
+        skip[s] = std::any_of(sample, sample + numberOfColumns, [](double value) { return value != value; });
+      }
+    }
+
+    for (std::size_t k = 0; k < Roots.size(); ++k)
+    {
+      const Node * nodes = Nodes.data();
+      for (std::size_t s = 0; s < numberOfSamples; ++s)
+      {
+        if (skip[s])
+          continue;
+
+        const double * sample = samples + s * numberOfColumns;
+        const Node * node = nodes + Roots[k];
+        while (node->Feature >= 0)
+          node = nodes + node->Next + (sample[node->Feature] < node->Threshold ? 0 : 1);
+
+        const double * leaf = LeafData.data() + node->Next;
+        const double factor = isSampleWeighted ? leaf[0] : 1.0;
+        double * probability = probabilities + s * NumberOfClasses;
+        for (int l = 0; l < NumberOfClasses; ++l)
+        {
+          double weight = leaf[1 + l] * factor;
+          if (treeWeights != nullptr)
+          {
+            weight *= treeWeights[k];
+            probability[l] += static_cast<int>(weight);
+          }
+          else
+          {
+            probability[l] += weight;
+          }
+          totalWeights[s] += weight;
+        }
+      }
+    }
+
+    for (std::size_t s = 0; s < numberOfSamples; ++s)
+    {
+      double * probability = probabilities + s * NumberOfClasses;
+      if (!skip[s])
+      {
+        for (int l = 0; l < NumberOfClasses; ++l)
+          probability[l] /= totalWeights[s];
+      }
+
+      int maxCol = 0;
+      for (int l = 1; l < NumberOfClasses; ++l)
+      {
+        if (probability[l] > probability[maxCol])
+          maxCol = l;
+      }
+      labels[s] = ClassLabels[maxCol];
+    }
+  }
+};
+
+namespace
+{
+  /// Number of samples which are passed through all trees together
+  const std::size_t SamplesPerBlock = 256;
+
+  /// Number of samples which are read from a feature store at once for prediction
+  const std::uint64_t SamplesPerChunk = 16384;
+
+  /// Draws the rows of a bootstrap sample in ascending order
+  std::vector<std::uint64_t> DrawBootstrapSample(std::uint64_t numberOfSamples, std::uint64_t sampleSize, bool withReplacement, std::mt19937_64 & generator)
+  {
+    std::vector<std::uint64_t> rows;
+    rows.reserve(sampleSize);
+
+    if (withReplacement)
+    {
+      std::uniform_int_distribution<std::uint64_t> distribution(0, numberOfSamples - 1);
+      for (std::uint64_t i = 0; i < sampleSize; ++i)
+        rows.push_back(distribution(generator));
+      std::sort(rows.begin(), rows.end());
+    }
+    else
+    {
+      // selection sampling, every row is selected with probability (still needed) / (still available)
+      std::uniform_real_distribution<double> distribution(0.0, 1.0);
+      for (std::uint64_t row = 0; row < numberOfSamples && rows.size() < sampleSize; ++row)
+      {
+        if ((numberOfSamples - row) * distribution(generator) < sampleSize - rows.size())
+          rows.push_back(row);
+      }
+    }
+    return rows;
+  }
+
+  typedef std::function<void(unsigned int, unsigned int)> ThreadedMethodType;
+
+  ITK_THREAD_RETURN_TYPE ThreadedMethodCallback(void * arg)
+  {
+    typedef itk::MultiThreader::ThreadInfoStruct  ThreadInfoType;
+    ThreadInfoType * infoStruct = static_cast< ThreadInfoType * >( arg );
+    (*static_cast<ThreadedMethodType *>(infoStruct->UserData))(infoStruct->ThreadID, infoStruct->NumberOfThreads);
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /// Runs method(threadId, numberOfThreads) in all threads of an itk::MultiThreader, or in at most maximumNumberOfThreads
+  void ExecuteThreaded(ThreadedMethodType method, unsigned int maximumNumberOfThreads = 0)
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    if (maximumNumberOfThreads > 0)
+      threader->SetNumberOfThreads(std::min<itk::ThreadIdType>(threader->GetNumberOfThreads(), maximumNumberOfThreads));
+    threader->SetSingleMethod(ThreadedMethodCallback, &method);
+    threader->SingleMethodExecute();
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void ReadMask(const itk::Image<TPixel, VImageDimension> * itkMask, std::vector<char> & mask)
+  {
+    mask.clear();
+    mask.reserve(itkMask->GetLargestPossibleRegion().GetNumberOfPixels());
+
+    itk::ImageRegionConstIterator<itk::Image<TPixel, VImageDimension>> it(itkMask, itkMask->GetLargestPossibleRegion());
+    for (; !it.IsAtEnd(); ++it)
+      mask.push_back(it.Get() != 0 ? 1 : 0);
+  }
+}
+
 mitk::VigraRandomForestClassifier::VigraRandomForestClassifier()
-  :m_Parameter(nullptr)
+  :m_Parameter(nullptr),
+  m_UseCompiledForest(true)
 {
   itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::Pointer command = itk::SimpleMemberCommand<mitk::VigraRandomForestClassifier>::New();
   command->SetCallbackFunction(this, &mitk::VigraRandomForestClassifier::ConvertParameter);
@@ -120,6 +357,7 @@ void mitk::VigraRandomForestClassifier::OnlineTrain(const Eigen::MatrixXd & X_in
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(Y_in.rows(),Y_in.cols()),Y_in.data());
   m_RandomForest.onlineLearn(X,Y,0,true);
+  m_CompiledForest.reset();
 }
 
 void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, const Eigen::MatrixXi &Y_in)
@@ -164,12 +402,156 @@ void mitk::VigraRandomForestClassifier::Train(const Eigen::MatrixXd & X_in, cons
   m_RandomForest.set_options().tree_count(m_Parameter->TreeCount);
   m_RandomForest.ext_param_.class_count_ = data->m_ClassCount;
   m_RandomForest.trees_ = data->trees_;
+  m_CompiledForest.reset();
 
   // Set Tree Weights to default
   m_TreeWeights = Eigen::MatrixXd(m_Parameter->TreeCount,1);
   m_TreeWeights.fill(1.0);
 }
 
+void mitk::VigraRandomForestClassifier::Train(const mitk::FeatureStore * store)
+{
+  if (store == nullptr || !store->IsOpen() || store->GetNumberOfSamples() == 0)
+    mitkThrow() << "Feature store is not open or contains no samples.";
+
+  this->ConvertParameter();
+  const Parameter parameter = *m_Parameter;
+
+  if (parameter.UsePointBasedWeights)
+    MITK_WARN << "Point wise weights are not supported for training from a feature store and are ignored.";
+
+  const std::uint64_t numberOfSamples = store->GetNumberOfSamples();
+  std::uint64_t sampleSize = std::max<std::uint64_t>(1, std::llround(parameter.SamplesPerTree * numberOfSamples));
+  if (!parameter.SampleWithReplacement)
+    sampleSize = std::min(sampleSize, numberOfSamples);
+
+  const int numberOfTrees = std::max(1, parameter.TreeCount);
+
+  // Every tree in training holds its sample as float values plus labels, the row indices and vigra's index
+  // arrays. Only as many trees are trained at the same time as fit into the memory budget.
+  const double bytesPerTree = static_cast<double>(sampleSize) * (store->GetNumberOfFeatures() * sizeof(float) + 32);
+  const double budget = parameter.StoreTrainingMemoryBudget * 1024.0 * 1024.0;
+  const unsigned int concurrentTrees = static_cast<unsigned int>(
+    std::max(1.0, std::min<double>(numberOfTrees, std::floor(budget / bytesPerTree))));
+
+  std::random_device device;
+  std::vector<std::uint64_t> seeds(numberOfTrees);
+  for (auto & seed : seeds)
+    seed = (static_cast<std::uint64_t>(device()) << 32) | device();
+
+  // The bootstrap sample is drawn here, so vigra learns each tree on exactly the samples it gets.
+  auto learnTree = [&](std::uint64_t seed, vigra::RandomForest<int> & rf) {
+    std::mt19937_64 generator(seed);
+    const auto rows = DrawBootstrapSample(numberOfSamples, sampleSize, parameter.SampleWithReplacement, generator);
+
+    Eigen::MatrixXf X_in;
+    Eigen::MatrixXi Y_in;
+    store->GetSamples(rows, X_in, Y_in);
+
+    // all trees have to know all classes, so rare classes missing in the sample are added
+    std::set<int> labels(Y_in.data(), Y_in.data() + Y_in.rows());
+    std::vector<std::uint64_t> missingRows;
+    for (const auto & firstSample : store->GetFirstSampleOfLabels())
+    {
+      if (labels.count(firstSample.first) == 0)
+        missingRows.push_back(firstSample.second);
+    }
+    if (!missingRows.empty())
+    {
+      Eigen::MatrixXf missingX;
+      Eigen::MatrixXi missingY;
+      store->GetSamples(missingRows, missingX, missingY);
+      X_in.conservativeResize(X_in.rows() + missingX.rows(), Eigen::NoChange);
+      Y_in.conservativeResize(Y_in.rows() + missingY.rows(), Eigen::NoChange);
+      X_in.bottomRows(missingX.rows()) = missingX;
+      Y_in.bottomRows(missingY.rows()) = missingY;
+    }
+
+    DefaultSplitType splitter;
+    splitter.UseRandomSplit(parameter.UseRandomSplit);
+    splitter.SetPrecision(parameter.Precision);
+    splitter.SetMaximumTreeDepth(parameter.TreeDepth);
+
+    // the splits are computed in double precision, so the trees equal those learned from the converted samples
+    vigra::MultiArrayView<2, float> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
+    vigra::MultiArrayView<2, int> Y(vigra::Shape2(Y_in.rows(),Y_in.cols()),Y_in.data());
+
+    rf.set_options().tree_count(1);
+    rf.set_options().use_stratification(vigra::RF_NONE);
+    rf.set_options().sample_with_replacement(false);
+    rf.set_options().samples_per_tree(1.0);
+    rf.set_options().min_split_node_size(parameter.MinimumSplitNodeSize);
+    rf.learn(X, Y, vigra::rf::visitors::VisitorBase(), splitter);
+  };
+
+  // the first tree initializes the forest, the others are learned in parallel on copies of it
+  learnTree(seeds[0], m_RandomForest);
+
+  vigra::ArrayVector<vigra::RandomForest<int>::DecisionTree_t> trees(numberOfTrees, m_RandomForest.trees_[0]);
+  std::atomic<int> nextTree(1);
+  std::exception_ptr exception;
+  itk::FastMutexLock::Pointer mutex = itk::FastMutexLock::New();
+
+  ExecuteThreaded([&](unsigned int, unsigned int) {
+    vigra::RandomForest<int> rf = m_RandomForest;
+    try
+    {
+      for (int k = nextTree++; k < numberOfTrees; k = nextTree++)
+      {
+        learnTree(seeds[k], rf);
+        trees[k] = rf.trees_[0];
+      }
+    }
+    catch (...)
+    {
+      mutex->Lock();
+      exception = std::current_exception();
+      nextTree = numberOfTrees;
+      mutex->Unlock();
+    }
+  }, concurrentTrees);
+
+  if (exception)
+    std::rethrow_exception(exception);
+
+  m_RandomForest.set_options().tree_count(numberOfTrees);
+  m_RandomForest.trees_ = trees;
+  m_CompiledForest.reset();
+
+  // Set Tree Weights to default
+  m_TreeWeights = Eigen::MatrixXd(numberOfTrees,1);
+  m_TreeWeights.fill(1.0);
+}
+
+Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const mitk::FeatureStore * store)
+{
+  if (store == nullptr || !store->IsOpen())
+    mitkThrow() << "Feature store is not open.";
+
+  const std::uint64_t numberOfSamples = store->GetNumberOfSamples();
+  const std::size_t numberOfFeatures = store->GetNumberOfFeatures();
+
+  typedef Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> ChunkType;
+
+  Eigen::MatrixXi labels(numberOfSamples, 1);
+  std::vector<float> chunk(SamplesPerChunk * numberOfFeatures);
+  Eigen::MatrixXd X;
+
+  for (std::uint64_t first = 0; first < numberOfSamples; first += SamplesPerChunk)
+  {
+    const std::size_t count = static_cast<std::size_t>(std::min(SamplesPerChunk, numberOfSamples - first));
+    store->GetSamples(first, count, chunk.data(), nullptr);
+
+    X = Eigen::Map<const ChunkType>(chunk.data(), count, numberOfFeatures).cast<double>();
+    labels.middleRows(first, count) = this->Predict(X);
+  }
+
+  m_OutLabel = labels;
+  m_OutProbability.resize(0, m_RandomForest.class_count());
+  m_Probabilities = vigra::MultiArrayView<2, double>();
+  return m_OutLabel;
+}
+
 Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const Eigen::MatrixXd &X_in)
 {
   // Initialize output Eigen matrices
@@ -187,6 +569,15 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::Predict(const Eigen::MatrixXd
 
 
   vigra::MultiArrayView<2, double> P(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
+
+  const CompiledForest * forest = m_UseCompiledForest ? this->GetCompiledForest() : nullptr;
+  if (forest != nullptr)
+  {
+    this->PredictCompiled(*forest, X_in, nullptr);
+    m_Probabilities = P;
+    return m_OutLabel;
+  }
+
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(m_OutLabel.rows(),m_OutLabel.cols()),m_OutLabel.data());
   vigra::MultiArrayView<2, double> X(vigra::Shape2(X_in.rows(),X_in.cols()),X_in.data());
   vigra::MultiArrayView<2, double> TW(vigra::Shape2(m_RandomForest.tree_count(),1),m_TreeWeights.data());
@@ -217,6 +608,12 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::
     m_TreeWeights.fill(1);
   }
 
+  const CompiledForest * forest = m_UseCompiledForest ? this->GetCompiledForest() : nullptr;
+  if (forest != nullptr)
+  {
+    this->PredictCompiled(*forest, X_in, m_TreeWeights.data());
+    return m_OutLabel;
+  }
 
   vigra::MultiArrayView<2, double> P(vigra::Shape2(m_OutProbability.rows(),m_OutProbability.cols()),m_OutProbability.data());
   vigra::MultiArrayView<2, int> Y(vigra::Shape2(m_OutLabel.rows(),m_OutLabel.cols()),m_OutLabel.data());
@@ -234,6 +631,171 @@ Eigen::MatrixXi mitk::VigraRandomForestClassifier::PredictWeighted(const Eigen::
 }
 
 
+mitk::Image::Pointer mitk::VigraRandomForestClassifier::PredictImage(const mitk::Image * featureMap, const mitk::Image * mask, mitk::Image::Pointer * probabilities)
+{
+  if (featureMap == nullptr || mask == nullptr)
+    mitkThrow() << "Feature map and mask are required.";
+
+  if (featureMap->GetDimension() != 3 || mask->GetDimension() != 3)
+    mitkThrow() << "Feature map and mask have to be 3D images.";
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (featureMap->GetDimension(i) != mask->GetDimension(i))
+      mitkThrow() << "Mask does not match the size of the feature map.";
+  }
+
+  if (featureMap->GetPixelType().GetComponentType() != itk::ImageIOBase::FLOAT)
+    mitkThrow() << "Feature map has to be a float image.";
+
+  const CompiledForest * forest = this->GetCompiledForest();
+  if (forest == nullptr)
+    mitkThrow() << "The random forest is not trained or contains nodes which are not supported by the image prediction.";
+
+  const std::size_t numberOfColumns = featureMap->GetPixelType().GetNumberOfComponents();
+  if (numberOfColumns < static_cast<std::size_t>(forest->NumberOfFeatures))
+    mitkThrow() << "Feature map has " << numberOfColumns << " components, but the random forest uses " << forest->NumberOfFeatures << " features.";
+
+  std::vector<char> maskValues;
+  AccessFixedDimensionByItk_1(mask, ReadMask, 3, maskValues);
+
+  unsigned int dimensions[3] = { featureMap->GetDimension(0), featureMap->GetDimension(1), featureMap->GetDimension(2) };
+  const std::size_t numberOfClasses = forest->NumberOfClasses;
+
+  auto labelImage = mitk::Image::New();
+  labelImage->Initialize(mitk::MakeScalarPixelType<int>(), 3, dimensions);
+  labelImage->SetClonedTimeGeometry(featureMap->GetTimeGeometry());
+
+  mitk::Image::Pointer probabilityImage;
+  if (probabilities != nullptr)
+  {
+    probabilityImage = mitk::Image::New();
+    probabilityImage->Initialize(mitk::MakePixelType<itk::VectorImage<float, 3>>(numberOfClasses), 3, dimensions);
+    probabilityImage->SetClonedTimeGeometry(featureMap->GetTimeGeometry());
+  }
+
+  {
+    mitk::ImageReadAccessor featureAccessor(featureMap);
+    mitk::ImageWriteAccessor labelAccessor(labelImage);
+    std::unique_ptr<mitk::ImageWriteAccessor> probabilityAccessor;
+    if (probabilityImage.IsNotNull())
+      probabilityAccessor.reset(new mitk::ImageWriteAccessor(probabilityImage));
+
+    const float * features = static_cast<const float *>(featureAccessor.GetData());
+    int * labels = static_cast<int *>(labelAccessor.GetData());
+    float * probabilityData = probabilityAccessor != nullptr ? static_cast<float *>(probabilityAccessor->GetData()) : nullptr;
+
+    const std::size_t numberOfVoxels = maskValues.size();
+    std::fill(labels, labels + numberOfVoxels, 0);
+    if (probabilityData != nullptr)
+      std::fill(probabilityData, probabilityData + numberOfVoxels * numberOfClasses, 0.0f);
+
+    const bool isSampleWeighted = m_RandomForest.options_.predict_weighted_ != 0;
+
+    ExecuteThreaded([&](unsigned int threadId, unsigned int numberOfThreads) {
+      const std::size_t begin = numberOfVoxels * threadId / numberOfThreads;
+      const std::size_t end = numberOfVoxels * (threadId + 1) / numberOfThreads;
+
+      std::vector<std::size_t> voxels;
+      std::vector<double> samples(SamplesPerBlock * numberOfColumns);
+      std::vector<double> blockProbabilities(SamplesPerBlock * numberOfClasses);
+      std::vector<double> totalWeights(SamplesPerBlock);
+      std::vector<int> blockLabels(SamplesPerBlock);
+
+      for (std::size_t voxel = begin; voxel < end;)
+      {
+        voxels.clear();
+        for (; voxel < end && voxels.size() < SamplesPerBlock; ++voxel)
+        {
+          if (maskValues[voxel] == 0)
+            continue;
+
+          std::copy(features + voxel * numberOfColumns, features + (voxel + 1) * numberOfColumns, samples.begin() + voxels.size() * numberOfColumns);
+          voxels.push_back(voxel);
+        }
+
+        forest->Predict(samples.data(), voxels.size(), numberOfColumns, isSampleWeighted, nullptr,
+          blockProbabilities.data(), totalWeights.data(), blockLabels.data());
+
+        for (std::size_t s = 0; s < voxels.size(); ++s)
+        {
+          labels[voxels[s]] = blockLabels[s];
+          if (probabilityData != nullptr)
+          {
+            for (std::size_t l = 0; l < numberOfClasses; ++l)
+              probabilityData[voxels[s] * numberOfClasses + l] = static_cast<float>(blockProbabilities[s * numberOfClasses + l]);
+          }
+        }
+      }
+    });
+  }
+
+  if (probabilities != nullptr)
+    *probabilities = probabilityImage;
+
+  return labelImage;
+}
+
+void mitk::VigraRandomForestClassifier::PredictCompiled(const CompiledForest & forest, const Eigen::MatrixXd & X, const double * treeWeights)
+{
+  const std::size_t numberOfSamples = X.rows();
+  const std::size_t numberOfColumns = X.cols();
+  const std::size_t numberOfClasses = forest.NumberOfClasses;
+
+  if (numberOfColumns < static_cast<std::size_t>(forest.NumberOfFeatures))
+    mitkThrow() << "Sample matrix has " << numberOfColumns << " columns, but the random forest uses " << forest.NumberOfFeatures << " features.";
+
+  const bool isSampleWeighted = m_RandomForest.options_.predict_weighted_ != 0;
+
+  ExecuteThreaded([&](unsigned int threadId, unsigned int numberOfThreads) {
+    const std::size_t begin = numberOfSamples * threadId / numberOfThreads;
+    const std::size_t end = numberOfSamples * (threadId + 1) / numberOfThreads;
+
+    std::vector<double> samples(SamplesPerBlock * numberOfColumns);
+    std::vector<double> probabilities(SamplesPerBlock * numberOfClasses);
+    std::vector<double> totalWeights(SamplesPerBlock);
+    std::vector<int> labels(SamplesPerBlock);
+
+    for (std::size_t first = begin; first < end; first += SamplesPerBlock)
+    {
+      const std::size_t count = std::min(SamplesPerBlock, end - first);
+      for (std::size_t s = 0; s < count; ++s)
+      {
+        for (std::size_t c = 0; c < numberOfColumns; ++c)
+          samples[s * numberOfColumns + c] = X(first + s, c);
+      }
+
+      forest.Predict(samples.data(), count, numberOfColumns, isSampleWeighted, treeWeights,
+        probabilities.data(), totalWeights.data(), labels.data());
+
+      for (std::size_t s = 0; s < count; ++s)
+      {
+        m_OutLabel(first + s, 0) = labels[s];
+        for (std::size_t l = 0; l < numberOfClasses; ++l)
+          m_OutProbability(first + s, l) = probabilities[s * numberOfClasses + l];
+      }
+    }
+  });
+}
+
+const mitk::VigraRandomForestClassifier::CompiledForest * mitk::VigraRandomForestClassifier::GetCompiledForest()
+{
+  if (m_CompiledForest == nullptr)
+    m_CompiledForest = std::make_shared<const CompiledForest>(m_RandomForest);
+
+  return m_CompiledForest->IsSupported ? m_CompiledForest.get() : nullptr;
+}
+
+void mitk::VigraRandomForestClassifier::UseCompiledForest(bool val)
+{
+  m_UseCompiledForest = val;
+}
+
+bool mitk::VigraRandomForestClassifier::IsUsingCompiledForest() const
+{
+  return m_UseCompiledForest;
+}
+
 
 void mitk::VigraRandomForestClassifier::SetTreeWeights(Eigen::MatrixXd weights)
 {
@@ -463,6 +1025,7 @@ void  mitk::VigraRandomForestClassifier::ConvertParameter()
   if(!this->GetPropertyList()->Get("samplespertree",this->m_Parameter->SamplesPerTree))                 this->m_Parameter->SamplesPerTree = 0.6;
   if(!this->GetPropertyList()->Get("samplewithreplacement",this->m_Parameter->SampleWithReplacement))   this->m_Parameter->SampleWithReplacement = true;
   if(!this->GetPropertyList()->Get("lambda",this->m_Parameter->WeightLambda))                           this->m_Parameter->WeightLambda = 1.0; // Not used yet
+  if(!this->GetPropertyList()->Get("storetrainingmemorybudget",this->m_Parameter->StoreTrainingMemoryBudget)) this->m_Parameter->StoreTrainingMemoryBudget = 0;
   //  if(!this->GetPropertyList()->Get("samplewithreplacement",this->m_Parameter->Stratification))
   this->m_Parameter->Stratification = vigra::RF_NONE; // no Property given
 }
@@ -523,6 +1086,11 @@ void mitk::VigraRandomForestClassifier::PrintParameter(std::ostream & str)
   else
     str << "lambda\t\t" << this->m_Parameter->WeightLambda << "\n";
 
+  if(!this->GetPropertyList()->Get("storetrainingmemorybudget",this->m_Parameter->StoreTrainingMemoryBudget))
+    str << "storetrainingmemorybudget\tNOT SET (default " << this->m_Parameter->StoreTrainingMemoryBudget << ")" << "\n";
+  else
+    str << "storetrainingmemorybudget\t" << this->m_Parameter->StoreTrainingMemoryBudget << "\n";
+
   //  if(!this->GetPropertyList()->Get("samplewithreplacement",this->m_Parameter->Stratification))
   //  this->m_Parameter->Stratification = vigra:RF_NONE; // no Property given
 }
@@ -568,6 +1136,11 @@ void mitk::VigraRandomForestClassifier::SetWeightLambda(double val)
   this->GetPropertyList()->SetDoubleProperty("lambda",val);
 }
 
+void mitk::VigraRandomForestClassifier::SetStoreTrainingMemoryBudget(double megabytes)
+{
+  this->GetPropertyList()->SetDoubleProperty("storetrainingmemorybudget",megabytes);
+}
+
 void mitk::VigraRandomForestClassifier::SetTreeWeight(int treeId, double weight)
 {
   m_TreeWeights(treeId,0) = weight;
@@ -581,6 +1154,7 @@ void mitk::VigraRandomForestClassifier::SetRandomForest(const vigra::RandomFores
   this->SetSamplesPerTree(rf.options().training_set_proportion_);
   this->UseSampleWithReplacement(rf.options().sample_with_replacement_);
   this->m_RandomForest = rf;
+  this->m_CompiledForest.reset();
 }
 
 const vigra::RandomForest<int> & mitk::VigraRandomForestClassifier::GetRandomForest() const
@@ -22,6 +22,10 @@ found in the LICENSE file.
 #include <itkAddImageFilter.h>
 #include <mitkImageCast.h>
 #include <mitkStandaloneDataStorage.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <itkVectorImage.h>
+#include <itksys/SystemTools.hxx>
 
 class mitkVigraRandomForestTestSuite : public mitk::TestFixture
 {
@@ -35,6 +39,9 @@ class mitkVigraRandomForestTestSuite : public mitk::TestFixture
   MITK_TEST(TrainThreadedDecisionForest_MatlabDataSet_shouldReturnTrue);
   MITK_TEST(PredictWeightedDecisionForest_SetWeightsToZero_shouldReturnTrue);
   MITK_TEST(TrainThreadedDecisionForest_BreastCancerDataSet_shouldReturnTrue);
+  MITK_TEST(PredictCompiledForest_BreastCancerDataSet_shouldMatchVigra);
+  MITK_TEST(PredictImage_BreastCancerDataSet_shouldMatchPredict);
+  MITK_TEST(TrainFeatureStore_BreastCancerDataSet_shouldReturnTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -172,6 +179,133 @@ public:
   }
 
 
+  // ------------------------------------------------------------------------------------------------------
+  // ------------------------------------------------------------------------------------------------------
+
+  void PredictCompiledForest_BreastCancerDataSet_shouldMatchVigra()
+  {
+    auto & Features_Training = FeatureData_Cancer.first;
+    auto & Features_Testing = FeatureData_Cancer.second;
+    auto & Labels_Training = LabelData_Cancer.first;
+
+    classifier->Train(Features_Training,Labels_Training);
+
+    classifier->UseCompiledForest(false);
+    Eigen::MatrixXi vigraClasses = classifier->Predict(Features_Testing);
+    Eigen::MatrixXd vigraProbabilities = classifier->GetPointWiseProbabilities();
+
+    classifier->UseCompiledForest(true);
+    Eigen::MatrixXi compiledClasses = classifier->Predict(Features_Testing);
+    Eigen::MatrixXd compiledProbabilities = classifier->GetPointWiseProbabilities();
+
+    CPPUNIT_ASSERT_MESSAGE("Compiled forest predicts the same labels", vigraClasses == compiledClasses);
+    CPPUNIT_ASSERT_MESSAGE("Compiled forest predicts the same probabilities", vigraProbabilities == compiledProbabilities);
+
+    // weighted prediction with some trees switched off
+    Eigen::MatrixXd weights(classifier->GetRandomForest().tree_count(), 1);
+    for (int i = 0; i < weights.rows(); ++i)
+      weights(i, 0) = (i % 3 == 0) ? 0.0 : 2.0;
+    classifier->SetTreeWeights(weights);
+
+    classifier->UseCompiledForest(false);
+    vigraClasses = classifier->PredictWeighted(Features_Testing);
+    vigraProbabilities = classifier->GetPointWiseProbabilities();
+
+    classifier->UseCompiledForest(true);
+    compiledClasses = classifier->PredictWeighted(Features_Testing);
+    compiledProbabilities = classifier->GetPointWiseProbabilities();
+
+    CPPUNIT_ASSERT_MESSAGE("Compiled forest predicts the same weighted probabilities", vigraProbabilities == compiledProbabilities);
+  }
+
+  void PredictImage_BreastCancerDataSet_shouldMatchPredict()
+  {
+    auto & Features_Training = FeatureData_Cancer.first;
+    auto & Labels_Training = LabelData_Cancer.first;
+    MatrixDoubleType Features_Testing = FeatureData_Cancer.second;
+
+    classifier->Train(Features_Training,Labels_Training);
+
+    // one voxel per sample, every second voxel is masked
+    unsigned int dimensions[3] = {static_cast<unsigned int>(Features_Testing.rows()), 1, 1};
+    auto featureMap = mitk::Image::New();
+    featureMap->Initialize(mitk::MakePixelType<itk::VectorImage<float, 3>>(Features_Testing.cols()), 3, dimensions);
+    auto mask = mitk::Image::New();
+    mask->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor featureAccessor(featureMap);
+      mitk::ImageWriteAccessor maskAccessor(mask);
+      float * features = static_cast<float *>(featureAccessor.GetData());
+      unsigned char * maskValues = static_cast<unsigned char *>(maskAccessor.GetData());
+      for (int row = 0; row < Features_Testing.rows(); ++row)
+      {
+        maskValues[row] = row % 2;
+        for (int col = 0; col < Features_Testing.cols(); ++col)
+        {
+          features[row * Features_Testing.cols() + col] = static_cast<float>(Features_Testing(row, col));
+          Features_Testing(row, col) = static_cast<float>(Features_Testing(row, col));
+        }
+      }
+    }
+
+    Eigen::MatrixXi classes = classifier->Predict(Features_Testing);
+    Eigen::MatrixXd probabilities = classifier->GetPointWiseProbabilities();
+
+    mitk::Image::Pointer probabilityImage;
+    mitk::Image::Pointer labelImage = classifier->PredictImage(featureMap, mask, &probabilityImage);
+    CPPUNIT_ASSERT(probabilityImage.IsNotNull());
+
+    mitk::ImageReadAccessor labelAccessor(labelImage);
+    mitk::ImageReadAccessor probabilityAccessor(probabilityImage);
+    const int * labels = static_cast<const int *>(labelAccessor.GetData());
+    const float * probabilityValues = static_cast<const float *>(probabilityAccessor.GetData());
+
+    for (int row = 0; row < Features_Testing.rows(); ++row)
+    {
+      CPPUNIT_ASSERT_EQUAL(row % 2 ? classes(row, 0) : 0, labels[row]);
+      for (int l = 0; l < probabilities.cols(); ++l)
+        CPPUNIT_ASSERT_EQUAL(row % 2 ? static_cast<float>(probabilities(row, l)) : 0.0f, probabilityValues[row * probabilities.cols() + l]);
+    }
+  }
+
+  void TrainFeatureStore_BreastCancerDataSet_shouldReturnTrue()
+  {
+    auto & Labels_Training = LabelData_Cancer.first;
+    auto & Labels_Testing = LabelData_Cancer.second;
+
+    // the store keeps float values
+    MatrixDoubleType Features_Training = FeatureData_Cancer.first.cast<float>().cast<double>();
+    MatrixDoubleType Features_Testing = FeatureData_Cancer.second.cast<float>().cast<double>();
+
+    auto trainingStore = mitk::FeatureStore::New();
+    const std::string trainingFile = mitk::IOUtil::CreateTemporaryFile("RandomForestTraining_XXXXXX.fst");
+    trainingStore->Create(trainingFile, Features_Training.cols());
+    trainingStore->Append(Features_Training.topRows(100), Labels_Training.topRows(100));
+    trainingStore->Append(Features_Training.bottomRows(Features_Training.rows() - 100), Labels_Training.bottomRows(Labels_Training.rows() - 100));
+    trainingStore->Close();
+
+    auto testingStore = mitk::FeatureStore::New();
+    const std::string testingFile = mitk::IOUtil::CreateTemporaryFile("RandomForestTesting_XXXXXX.fst");
+    testingStore->Create(testingFile, Features_Testing.cols());
+    testingStore->Append(Features_Testing, Labels_Testing);
+    testingStore->Close();
+
+    classifier->SetTreeCount(20);
+    classifier->Train(trainingStore);
+    CPPUNIT_ASSERT_EQUAL(20, classifier->GetRandomForest().tree_count());
+
+    Eigen::MatrixXi classes = classifier->Predict(Features_Testing);
+    Eigen::MatrixXi storeClasses = classifier->Predict(testingStore);
+
+    CPPUNIT_ASSERT_MESSAGE("Prediction from the store matches the prediction of the matrix", classes == storeClasses);
+    CPPUNIT_ASSERT_MESSAGE("Testvalue of cancer data set is in range.", isIntervall<int>(Labels_Testing, storeClasses, 95, 100));
+
+    trainingStore = nullptr;
+    testingStore = nullptr;
+    itksys::SystemTools::RemoveFile(trainingFile);
+    itksys::SystemTools::RemoveFile(testingFile);
+  }
+
   // ------------------------------------------------------------------------------------------------------
   // ------------------------------------------------------------------------------------------------------
   /*Reading an file, which includes the trainingdataset and the testdataset, and convert the
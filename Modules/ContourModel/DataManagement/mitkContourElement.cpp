@@ -10,18 +10,156 @@ found in the LICENSE file.
 
 ============================================================================*/
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <mitkContourElement.h>
+#include <unordered_map>
 #include <vtkMath.h>
 
+namespace
+{
+  // contours with fewer vertices are searched without a spatial hash
+  const std::size_t MinimumNumberOfVerticesForSpatialHash = 64;
+
+  // segments covering more cells are tested for every query
+  const long long MaximumNumberOfCellsPerEntry = 64;
+
+  const long long MaximumNumberOfQueryCells = 4096;
+
+  const long long CellCoordinateLimit = 1 << 20;
+
+  // vertices are allocated in blocks growing from the minimum to the maximum size
+  const std::size_t MinimumVertexBlockSize = 16;
+  const std::size_t MaximumVertexBlockSize = 4096;
+
+  long long GetCellCoordinate(double coordinate, double cellSize)
+  {
+    const double cell = std::floor(coordinate / cellSize);
+    return static_cast<long long>(
+      std::min<double>(std::max<double>(cell, -CellCoordinateLimit), CellCoordinateLimit - 1));
+  }
+
+  std::uint64_t GetCellKey(long long x, long long y, long long z)
+  {
+    return (static_cast<std::uint64_t>(x + CellCoordinateLimit) << 42) |
+           (static_cast<std::uint64_t>(y + CellCoordinateLimit) << 21) |
+           static_cast<std::uint64_t>(z + CellCoordinateLimit);
+  }
+
+  bool IsFinite(const mitk::Point3D &point)
+  {
+    return std::isfinite(point[0]) && std::isfinite(point[1]) && std::isfinite(point[2]);
+  }
+
+  bool IsNearSegment(const mitk::Point3D &point, const mitk::Point3D &v1, const mitk::Point3D &v2, float eps)
+  {
+    const float l2 = v1.SquaredEuclideanDistanceTo(v2);
+
+    mitk::Vector3D p_v1 = point - v1;
+    mitk::Vector3D v2_v1 = v2 - v1;
+
+    double tc = (p_v1 * v2_v1) / l2;
+
+    // take into account we have line segments and not (infinite) lines
+    if (tc < 0.0)
+      tc = 0.0;
+    if (tc > 1.0)
+      tc = 1.0;
+
+    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
+
+    double distance = point.SquaredEuclideanDistanceTo(crossPoint);
+
+    return distance < eps;
+  }
+}
+
+/** Vertices are allocated in blocks whose capacity is never exceeded, so their addresses are stable. */
+struct mitk::ContourElement::VertexStorage
+{
+  VertexType *Create(const mitk::Point3D &point, bool isControlPoint)
+  {
+    if (Blocks.empty() || Blocks.back().size() == Blocks.back().capacity())
+    {
+      const std::size_t blockSize =
+        Blocks.empty() ? MinimumVertexBlockSize : std::min(2 * Blocks.back().capacity(), MaximumVertexBlockSize);
+      Blocks.emplace_back();
+      Blocks.back().reserve(blockSize);
+    }
+    Blocks.back().emplace_back(point, isControlPoint);
+    return &Blocks.back().back();
+  }
+
+  std::vector<std::vector<VertexType>> Blocks;
+};
+
+/** Uniform hash grid, entry i covers the bounding box of vertex i and the segment to vertex i + 1. */
+struct mitk::ContourElement::SpatialHash
+{
+  void Clear()
+  {
+    Cells.clear();
+    LargeEntries.clear();
+    NumberOfEntries = 0;
+    Valid = false;
+  }
+
+  void Insert(int index, const mitk::Point3D &first, const mitk::Point3D &second)
+  {
+    if (!IsFinite(first) || !IsFinite(second))
+    {
+      LargeEntries.push_back(index);
+      return;
+    }
+
+    long long begin[3];
+    long long end[3];
+    long long numberOfCells = 1;
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+      begin[axis] = GetCellCoordinate(std::min(first[axis], second[axis]), CellSize);
+      end[axis] = GetCellCoordinate(std::max(first[axis], second[axis]), CellSize);
+      numberOfCells *= end[axis] - begin[axis] + 1;
+    }
+
+    if (numberOfCells > MaximumNumberOfCellsPerEntry)
+    {
+      LargeEntries.push_back(index);
+      return;
+    }
+
+    for (long long z = begin[2]; z <= end[2]; ++z)
+      for (long long y = begin[1]; y <= end[1]; ++y)
+        for (long long x = begin[0]; x <= end[0]; ++x)
+          Cells[GetCellKey(x, y, z)].push_back(index);
+  }
+
+  std::unordered_map<std::uint64_t, std::vector<int>> Cells;
+  std::vector<int> LargeEntries;
+  double CellSize = 1.0;
+  std::size_t NumberOfEntries = 0;
+  std::size_t BuildSize = 0;
+  bool Valid = false;
+};
+
 mitk::ContourElement::ContourElement()
+  : m_VertexStorage(std::make_shared<VertexStorage>()), m_SpatialHash(new SpatialHash)
 {
   this->m_Vertices = new VertexListType();
   this->m_IsClosed = false;
 }
 
 mitk::ContourElement::ContourElement(const mitk::ContourElement &other)
-  : itk::LightObject(), m_Vertices(other.m_Vertices), m_IsClosed(other.m_IsClosed)
+  : itk::LightObject(),
+    m_Vertices(new VertexListType()),
+    m_IsClosed(other.m_IsClosed),
+    m_VertexStorage(std::make_shared<VertexStorage>()),
+    m_SpatialHash(new SpatialHash)
 {
+  for (const VertexType *vertex : *other.m_Vertices)
+  {
+    this->m_Vertices->push_back(this->CreateVertex(vertex->Coordinates, vertex->IsControlPoint));
+  }
 }
 
 mitk::ContourElement::~ContourElement()
@@ -29,24 +167,33 @@ mitk::ContourElement::~ContourElement()
   delete this->m_Vertices;
 }
 
+mitk::ContourElement::VertexType *mitk::ContourElement::CreateVertex(const mitk::Point3D &point, bool isControlPoint)
+{
+  return this->m_VertexStorage->Create(point, isControlPoint);
+}
+
 void mitk::ContourElement::AddVertex(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_back(new VertexType(vertex, isControlPoint));
+  this->m_Vertices->push_back(this->CreateVertex(vertex, isControlPoint));
+  this->AppendToSpatialHash();
 }
 
 void mitk::ContourElement::AddVertex(VertexType &vertex)
 {
-  this->m_Vertices->push_back(&vertex);
+  this->m_Vertices->push_back(this->CreateVertex(vertex.Coordinates, vertex.IsControlPoint));
+  this->AppendToSpatialHash();
 }
 
 void mitk::ContourElement::AddVertexAtFront(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_front(new VertexType(vertex, isControlPoint));
+  this->m_Vertices->push_front(this->CreateVertex(vertex, isControlPoint));
+  this->m_SpatialHash->Valid = false;
 }
 
 void mitk::ContourElement::AddVertexAtFront(VertexType &vertex)
 {
-  this->m_Vertices->push_front(&vertex);
+  this->m_Vertices->push_front(this->CreateVertex(vertex.Coordinates, vertex.IsControlPoint));
+  this->m_SpatialHash->Valid = false;
 }
 
 void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isControlPoint, int index)
@@ -55,7 +202,8 @@ void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isCon
   {
     auto _where = this->m_Vertices->begin();
     _where += index;
-    this->m_Vertices->insert(_where, new VertexType(vertex, isControlPoint));
+    this->m_Vertices->insert(_where, this->CreateVertex(vertex, isControlPoint));
+    this->m_SpatialHash->Valid = false;
   }
 }
 
@@ -64,6 +212,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const Point3D &point)
   if (pointId >= 0 && this->GetSize() > pointId)
   {
     this->m_Vertices->at(pointId)->Coordinates = point;
+    this->m_SpatialHash->Valid = false;
   }
 }
 
@@ -73,9 +222,146 @@ void mitk::ContourElement::SetVertexAt(int pointId, const VertexType *vertex)
   {
     this->m_Vertices->at(pointId)->Coordinates = vertex->Coordinates;
     this->m_Vertices->at(pointId)->IsControlPoint = vertex->IsControlPoint;
+    this->m_SpatialHash->Valid = false;
   }
 }
 
+void mitk::ContourElement::VertexCoordinatesModified()
+{
+  this->m_SpatialHash->Valid = false;
+}
+
+bool mitk::ContourElement::UpdateSpatialHash()
+{
+  const std::size_t numberOfVertices = this->m_Vertices->size();
+  if (numberOfVertices < MinimumNumberOfVerticesForSpatialHash)
+  {
+    return false;
+  }
+
+  // the vertex list may have been modified from outside, or grew a lot since the cell size was chosen
+  SpatialHash &hash = *this->m_SpatialHash;
+  if (hash.Valid && hash.NumberOfEntries == numberOfVertices && numberOfVertices <= 2 * hash.BuildSize)
+  {
+    return true;
+  }
+
+  hash.Clear();
+
+  // cells of about twice the average segment length, bounded by the extent of the contour
+  double bounds[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  double length = 0.0;
+  bool first = true;
+  for (std::size_t i = 0; i < numberOfVertices; ++i)
+  {
+    const mitk::Point3D &point = (*this->m_Vertices)[i]->Coordinates;
+    if (!IsFinite(point))
+      continue;
+
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+      bounds[2 * axis] = first ? point[axis] : std::min(bounds[2 * axis], point[axis]);
+      bounds[2 * axis + 1] = first ? point[axis] : std::max(bounds[2 * axis + 1], point[axis]);
+    }
+    first = false;
+
+    if (i + 1 < numberOfVertices && IsFinite((*this->m_Vertices)[i + 1]->Coordinates))
+    {
+      length += point.EuclideanDistanceTo((*this->m_Vertices)[i + 1]->Coordinates);
+    }
+  }
+
+  const double extent =
+    std::max(bounds[1] - bounds[0], std::max(bounds[3] - bounds[2], bounds[5] - bounds[4]));
+  hash.CellSize = std::max(2.0 * length / numberOfVertices, extent / 1024.0);
+  if (!(hash.CellSize > 0.0) || !std::isfinite(hash.CellSize))
+  {
+    hash.CellSize = 1.0;
+  }
+
+  for (std::size_t i = 0; i < numberOfVertices; ++i)
+  {
+    const mitk::Point3D &point = (*this->m_Vertices)[i]->Coordinates;
+    hash.Insert(static_cast<int>(i), point, i + 1 < numberOfVertices ? (*this->m_Vertices)[i + 1]->Coordinates : point);
+  }
+
+  hash.NumberOfEntries = numberOfVertices;
+  hash.BuildSize = numberOfVertices;
+  hash.Valid = true;
+  return true;
+}
+
+void mitk::ContourElement::AppendToSpatialHash()
+{
+  SpatialHash &hash = *this->m_SpatialHash;
+  const std::size_t numberOfVertices = this->m_Vertices->size();
+  if (!hash.Valid || hash.NumberOfEntries + 1 != numberOfVertices)
+  {
+    hash.Valid = false;
+    return;
+  }
+
+  // the former last vertex gets a segment to the new one
+  const mitk::Point3D &point = this->m_Vertices->back()->Coordinates;
+  if (numberOfVertices > 1)
+  {
+    hash.Insert(static_cast<int>(numberOfVertices - 2), (*this->m_Vertices)[numberOfVertices - 2]->Coordinates, point);
+  }
+  hash.Insert(static_cast<int>(numberOfVertices - 1), point, point);
+  hash.NumberOfEntries = numberOfVertices;
+}
+
+bool mitk::ContourElement::GetSpatialHashCandidates(const mitk::Point3D &point,
+                                                     double radius,
+                                                     std::vector<int> &candidates)
+{
+  candidates.clear();
+  const SpatialHash &hash = *this->m_SpatialHash;
+
+  if (!IsFinite(point) || !std::isfinite(radius))
+  {
+    return false;
+  }
+
+  // a small margin, so that rounding does not drop vertices at the border of the query
+  radius = radius * (1.0 + 1e-9) + 1e-12;
+
+  long long begin[3];
+  long long end[3];
+  long long numberOfCells = 1;
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    begin[axis] = GetCellCoordinate(point[axis] - radius, hash.CellSize);
+    end[axis] = GetCellCoordinate(point[axis] + radius, hash.CellSize);
+    numberOfCells *= end[axis] - begin[axis] + 1;
+    if (numberOfCells > MaximumNumberOfQueryCells ||
+        numberOfCells > static_cast<long long>(hash.NumberOfEntries))
+    {
+      return false;
+    }
+  }
+
+  for (long long z = begin[2]; z <= end[2]; ++z)
+  {
+    for (long long y = begin[1]; y <= end[1]; ++y)
+    {
+      for (long long x = begin[0]; x <= end[0]; ++x)
+      {
+        auto cell = hash.Cells.find(GetCellKey(x, y, z));
+        if (cell != hash.Cells.end())
+        {
+          candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
+        }
+      }
+    }
+  }
+  candidates.insert(candidates.end(), hash.LargeEntries.begin(), hash.LargeEntries.end());
+
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+  return true;
+}
+
 mitk::ContourElement::VertexType *mitk::ContourElement::GetVertexAt(int index)
 {
   return this->m_Vertices->at(index);
@@ -88,12 +374,9 @@ bool mitk::ContourElement::IsEmpty()
 
 mitk::ContourElement::VertexType *mitk::ContourElement::GetVertexAt(const mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should some kind of an octree with spatial query*/
-
   if (eps > 0)
   {
-    // currently no method with better performance is available
-    return BruteForceGetVertexAt(point, eps);
+    return OptimizedGetVertexAt(point, eps);
   } // if eps < 0
   return nullptr;
 }
@@ -152,70 +435,43 @@ mitk::ContourElement::VertexType *mitk::ContourElement::BruteForceGetVertexAt(co
   return nullptr;
 }
 
-/*mitk::ContourElement::VertexType* mitk::ContourElement::OptimizedGetVertexAt(const mitk::Point3D &point, float eps)
+mitk::ContourElement::VertexType *mitk::ContourElement::OptimizedGetVertexAt(const mitk::Point3D &point, float eps)
 {
-  if( (eps > 0) && (this->m_Vertices->size()>0) )
+  std::vector<int> candidates;
+  if (!(eps > 0) || !this->UpdateSpatialHash() || !this->GetSpatialHashCandidates(point, eps, candidates))
   {
-      int k = 1;
-      int dim = 3;
-      int nPoints = this->m_Vertices->size();
-      ANNpointArray pointsArray;
-      ANNpoint queryPoint;
-      ANNidxArray indexArray;
-      ANNdistArray distanceArray;
-      ANNkd_tree* kdTree;
-
-      queryPoint = annAllocPt(dim);
-      pointsArray = annAllocPts(nPoints, dim);
-      indexArray = new ANNidx[k];
-      distanceArray = new ANNdist[k];
-
-
-       int i = 0;
-
-      //fill points array with our control points
-      for(VertexIterator it = this->m_Vertices->begin(); it != this->m_Vertices->end(); it++, i++)
-      {
-        mitk::Point3D cur = (*it)->Coordinates;
-        pointsArray[i][0]= cur[0];
-        pointsArray[i][1]= cur[1];
-        pointsArray[i][2]= cur[2];
-      }
-
-      //create the kd tree
-      kdTree = new ANNkd_tree(pointsArray,nPoints, dim);
-
-      //fill mitk::Point3D into ANN query point
-      queryPoint[0] = point[0];
-      queryPoint[1] = point[1];
-      queryPoint[2] = point[2];
-
-      //k nearest neighbour search
-      kdTree->annkSearch(queryPoint, k, indexArray, distanceArray, eps);
-
-      VertexType* ret = nullptr;
+    return BruteForceGetVertexAt(point, eps);
+  }
 
-      try
-      {
-        ret = this->m_Vertices->at(indexArray[0]);
-      }
-      catch(std::out_of_range ex)
-      {
-        //ret stays nullptr
-        return ret;
-      }
+  // same selection as in BruteForceGetVertexAt(): the candidates are visited in the order of the contour
+  // and each vertex closer than all before is remembered, the last remembered control point wins
+  std::vector<VertexType *> nearestlist;
+  double nearestDistance = 0.0;
+  for (const int index : candidates)
+  {
+    VertexType *vertex = (*this->m_Vertices)[index];
+    const double distance = vertex->Coordinates.EuclideanDistanceTo(point);
+    if (distance < eps && (nearestlist.empty() || distance < nearestDistance))
+    {
+      nearestlist.push_back(vertex);
+      nearestDistance = distance;
+    }
+  }
 
-      //clean up ANN
-      delete [] indexArray;
-      delete [] distanceArray;
-      delete kdTree;
-      annClose();
+  if (nearestlist.empty())
+  {
+    return nullptr;
+  }
 
-      return ret;
+  for (auto it = nearestlist.rbegin(); it != nearestlist.rend(); ++it)
+  {
+    if ((*it)->IsControlPoint)
+    {
+      return *it;
+    }
   }
-  return nullptr;
+  return nearestlist.back();
 }
-*/
 
 mitk::ContourElement::VertexListType *mitk::ContourElement::GetVertexList()
 {
@@ -229,6 +485,34 @@ bool mitk::ContourElement::IsClosed()
 
 bool mitk::ContourElement::IsNearContour(const mitk::Point3D &point, float eps)
 {
+  std::vector<int> candidates;
+  if (!this->UpdateSpatialHash() || !(eps > 0) || !this->GetSpatialHashCandidates(point, std::sqrt(eps), candidates))
+  {
+    return this->BruteForceIsNearContour(point, eps);
+  }
+
+  // entry i of the hash covers the segment from vertex i to vertex i + 1,
+  // the segment from the last to the first vertex is not hashed
+  const int numberOfVertices = this->GetSize();
+  for (const int index : candidates)
+  {
+    if (index + 1 < numberOfVertices &&
+        IsNearSegment(point, (*this->m_Vertices)[index]->Coordinates, (*this->m_Vertices)[index + 1]->Coordinates, eps))
+    {
+      return true;
+    }
+  }
+
+  return IsNearSegment(point, this->m_Vertices->back()->Coordinates, this->m_Vertices->front()->Coordinates, eps);
+}
+
+bool mitk::ContourElement::BruteForceIsNearContour(const mitk::Point3D &point, float eps)
+{
+  if (this->m_Vertices->empty())
+  {
+    return false;
+  }
+
   ConstVertexIterator it1 = this->m_Vertices->begin();
   ConstVertexIterator it2 = this->m_Vertices->begin();
   it2++; // it2 runs one position ahead
@@ -242,27 +526,7 @@ bool mitk::ContourElement::IsNearContour(const mitk::Point3D &point, float eps)
     if (it2 == end)
       it2 = this->m_Vertices->begin();
 
-    mitk::Point3D v1 = (*it1)->Coordinates;
-    mitk::Point3D v2 = (*it2)->Coordinates;
-
-    const float l2 = v1.SquaredEuclideanDistanceTo(v2);
-
-    mitk::Vector3D p_v1 = point - v1;
-    mitk::Vector3D v2_v1 = v2 - v1;
-
-    double tc = (p_v1 * v2_v1) / l2;
-
-    // take into account we have line segments and not (infinite) lines
-    if (tc < 0.0)
-      tc = 0.0;
-    if (tc > 1.0)
-      tc = 1.0;
-
-    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
-
-    double distance = point.SquaredEuclideanDistanceTo(crossPoint);
-
-    if (distance < eps)
+    if (IsNearSegment(point, (*it1)->Coordinates, (*it2)->Coordinates, eps))
     {
       return true;
     }
@@ -309,6 +573,21 @@ void mitk::ContourElement::Concatenate(mitk::ContourElement *other, bool check)
 {
   if (other->GetSize() > 0)
   {
+    // the vertices are shared, so their storage has to live as long as this element refers to them
+    if (other != this)
+    {
+      for (const auto &storage : other->m_SharedVertexStorages)
+      {
+        if (storage != this->m_VertexStorage &&
+            std::find(m_SharedVertexStorages.begin(), m_SharedVertexStorages.end(), storage) ==
+              m_SharedVertexStorages.end())
+          m_SharedVertexStorages.push_back(storage);
+      }
+      if (std::find(m_SharedVertexStorages.begin(), m_SharedVertexStorages.end(), other->m_VertexStorage) ==
+          m_SharedVertexStorages.end())
+        m_SharedVertexStorages.push_back(other->m_VertexStorage);
+    }
+
     ConstVertexIterator otherIt = other->m_Vertices->begin();
     ConstVertexIterator otherEnd = other->m_Vertices->end();
     while (otherIt != otherEnd)
@@ -330,11 +609,15 @@ void mitk::ContourElement::Concatenate(mitk::ContourElement *other, bool check)
           thisIt++;
         }
         if (!found)
+        {
           this->m_Vertices->push_back(*otherIt);
+          this->AppendToSpatialHash();
+        }
       }
       else
       {
         this->m_Vertices->push_back(*otherIt);
+        this->AppendToSpatialHash();
       }
       otherIt++;
     }
@@ -353,6 +636,7 @@ bool mitk::ContourElement::RemoveVertex(const VertexType *vertex)
     if ((*it) == vertex)
     {
       this->m_Vertices->erase(it);
+      this->m_SpatialHash->Valid = false;
       return true;
     }
 
@@ -390,6 +674,7 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
   if (index >= 0 && static_cast<VertexListType::size_type>(index) < this->m_Vertices->size())
   {
     this->m_Vertices->erase(this->m_Vertices->begin() + index);
+    this->m_SpatialHash->Valid = false;
     return true;
   }
   else
@@ -417,6 +702,7 @@ bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
         // approximate point found
         // now erase it
         this->m_Vertices->erase(it);
+        this->m_SpatialHash->Valid = false;
         return true;
       }
 
@@ -429,6 +715,11 @@ bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
 void mitk::ContourElement::Clear()
 {
   this->m_Vertices->clear();
+  this->m_SpatialHash->Clear();
+
+  // vertices shared with concatenated contours stay alive in their storage
+  this->m_VertexStorage = std::make_shared<VertexStorage>();
+  this->m_SharedVertexStorages.clear();
 }
 //----------------------------------------------------------------------
 void mitk::ContourElement::RedistributeControlVertices(const VertexType *selected, int period)
@@ -16,9 +16,9 @@ found in the LICENSE file.
 #include <MitkContourModelExports.h>
 #include <mitkNumericTypes.h>
 
-//#include <ANN/ANN.h>
-
 #include <deque>
+#include <memory>
+#include <vector>
 
 namespace mitk
 {
@@ -28,6 +28,15 @@ namespace mitk
   end of the contour and to iterate in both directions.
   To mark a vertex as a special one it can be set as a control point.
 
+  The vertices are owned by the contour element and allocated in contiguous blocks, the
+  pointers in the vertex list stay valid until the vertex is removed or the element is cleared.
+  Concatenated contours share their vertices with the contour they were taken from.
+
+  Long contours keep a spatial hash of their vertices and line segments, which is used by
+  GetVertexAt() and IsNearContour(). It is updated when vertices are added at the end and
+  rebuilt lazily after other modifications. Call VertexCoordinatesModified() after
+  changing the coordinates of vertices through the pointers returned by this class.
+
   \Note It is highly not recommend to use this class directly as no secure mechanism is used here.
   Use mitk::ContourModel instead providing some additional features.
   */
@@ -46,7 +55,9 @@ namespace mitk
       */
       struct ContourModelVertex
     {
-      ContourModelVertex(mitk::Point3D &point, bool active = false) : IsControlPoint(active), Coordinates(point) {}
+      ContourModelVertex(const mitk::Point3D &point, bool active = false) : IsControlPoint(active), Coordinates(point)
+      {
+      }
       ContourModelVertex(const ContourModelVertex &other)
         : IsControlPoint(other.IsControlPoint), Coordinates(other.Coordinates)
       {
@@ -90,7 +101,7 @@ namespace mitk
     */
     virtual void AddVertex(mitk::Point3D &point, bool isControlPoint);
 
-    /** \brief Add a vertex at the end of the contour
+    /** \brief Add a copy of a vertex at the end of the contour
     \param vertex - a contour element vertex.
     */
     virtual void AddVertex(VertexType &vertex);
@@ -101,7 +112,7 @@ namespace mitk
     */
     virtual void AddVertexAtFront(mitk::Point3D &point, bool isControlPoint);
 
-    /** \brief Add a vertex at the front of the contour
+    /** \brief Add a copy of a vertex at the front of the contour
     \param vertex - a contour element vertex.
     */
     virtual void AddVertexAtFront(VertexType &vertex);
@@ -209,10 +220,17 @@ namespace mitk
     VertexType *BruteForceGetVertexAt(const mitk::Point3D &point, float eps);
 
     /** \brief Returns the approximate nearest vertex a given posoition in 3D space
+    Same result as BruteForceGetVertexAt(), but only the vertices in the cells of the spatial hash
+    around the position are tested.
     \param point - query position in 3D space.
     \param eps - the error bound for search algorithm.
     */
-    // VertexType* OptimizedGetVertexAt(const mitk::Point3D &point, float eps);
+    VertexType *OptimizedGetVertexAt(const mitk::Point3D &point, float eps);
+
+    /** \brief Marks the spatial hash as outdated.
+    Has to be called if the coordinates of vertices were modified directly.
+    */
+    void VertexCoordinatesModified();
 
     VertexListType *GetControlVertices();
 
@@ -229,8 +247,33 @@ namespace mitk
     ContourElement(const mitk::ContourElement &other);
     ~ContourElement() override;
 
+    /** \brief Creates a vertex in the storage of this element. */
+    VertexType *CreateVertex(const mitk::Point3D &point, bool isControlPoint);
+
+    bool BruteForceIsNearContour(const mitk::Point3D &point, float eps);
+
+    /** \brief Builds or updates the spatial hash, returns false if the contour is too short to use one. */
+    bool UpdateSpatialHash();
+
+    /** \brief Adds the last vertex to a valid spatial hash, invalidates it otherwise. */
+    void AppendToSpatialHash();
+
+    /** \brief Collects the sorted indices of all vertices and segments that may be within radius of point.
+    \return false if the query covers too many cells, the caller has to test all vertices then.
+    */
+    bool GetSpatialHashCandidates(const mitk::Point3D &point, double radius, std::vector<int> &candidates);
+
+    struct VertexStorage;
+    struct SpatialHash;
+
     VertexListType *m_Vertices; // double ended queue with vertices
     bool m_IsClosed;
+
+    std::shared_ptr<VertexStorage> m_VertexStorage;
+    // storages of concatenated contours, whose vertices are shared with this one
+    std::vector<std::shared_ptr<VertexStorage>> m_SharedVertexStorages;
+
+    std::unique_ptr<SpatialHash> m_SpatialHash;
   };
 } // namespace mitk
 
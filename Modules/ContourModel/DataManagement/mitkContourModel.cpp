@@ -390,6 +390,10 @@ void mitk::ContourModel::ShiftSelectedVertex(mitk::Vector3D &translate)
   if (this->m_SelectedVertex)
   {
     this->ShiftVertex(this->m_SelectedVertex, translate);
+    for (auto &contour : this->m_ContourSeries)
+    {
+      contour->VertexCoordinatesModified();
+    }
     this->Modified();
     this->m_UpdateBoundingBox = true;
   }
@@ -409,6 +413,7 @@ void mitk::ContourModel::ShiftContour(mitk::Vector3D &translate, int timestep)
       this->ShiftVertex((*it), translate);
       it++;
     }
+    this->m_ContourSeries[timestep]->VertexCoordinatesModified();
 
     this->Modified();
     this->m_UpdateBoundingBox = true;
@@ -12,6 +12,8 @@ found in the LICENSE file.
 #include <mitkContourModel.h>
 #include <mitkTestingMacros.h>
 
+#include <cmath>
+
 // Add a vertex to the contour and see if size changed
 static void TestAddVertex()
 {
@@ -396,6 +398,69 @@ static void TestContourModelAPI()
   MITK_TEST_CONDITION(contour2->GetNumberOfVertices() == 1, "Add call with another contour");
 }
 
+// Search vertices and segments of a contour long enough to be searched with a spatial hash
+static void TestLongContourLookup()
+{
+  mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+
+  // spiral with a vertex every 0.5 mm
+  mitk::Point3D p;
+  for (int i = 0; i < 5000; ++i)
+  {
+    const double angle = i * 0.01;
+    p[0] = (10.0 + angle) * std::cos(angle);
+    p[1] = (10.0 + angle) * std::sin(angle);
+    p[2] = 0;
+    contour->AddVertex(p, i % 100 == 0);
+  }
+
+  mitk::Point3D query = contour->GetVertexAt(1234)->Coordinates;
+  query[2] = 0.1;
+  MITK_TEST_CONDITION(contour->SelectVertexAt(query, 0.3), "select vertex of long contour");
+  MITK_TEST_CONDITION(contour->GetIndex(contour->GetSelectedVertex()) == 1234, "closest vertex selected");
+
+  // vertex 1203 is closest, but the control point 1200 is near enough as well
+  query = contour->GetVertexAt(1203)->Coordinates;
+  query[2] = 0.1;
+  MITK_TEST_CONDITION(contour->SelectVertexAt(query, 5.0) &&
+                        contour->GetIndex(contour->GetSelectedVertex()) == 1200,
+                      "control point preferred");
+
+  mitk::Point3D between;
+  between[0] = (contour->GetVertexAt(2000)->Coordinates[0] + contour->GetVertexAt(2001)->Coordinates[0]) / 2;
+  between[1] = (contour->GetVertexAt(2000)->Coordinates[1] + contour->GetVertexAt(2001)->Coordinates[1]) / 2;
+  between[2] = 0.05;
+  MITK_TEST_CONDITION(contour->IsNearContour(between, 0.01, 0), "point between two vertices is near contour");
+
+  mitk::Point3D center;
+  center[0] = center[1] = center[2] = 0;
+  MITK_TEST_CONDITION(!contour->IsNearContour(center, 1.0, 0), "center of spiral is not near contour");
+  MITK_TEST_CONDITION(!contour->SelectVertexAt(center, 1.0), "no vertex at center of spiral");
+
+  // the lookup follows shifted vertices
+  mitk::Vector3D translate;
+  translate[0] = 100;
+  translate[1] = translate[2] = 0;
+  contour->ShiftContour(translate);
+  center[0] = 100;
+  MITK_TEST_CONDITION(!contour->IsNearContour(center, 1.0, 0), "center of shifted spiral is not near contour");
+  between[0] += 100;
+  MITK_TEST_CONDITION(contour->IsNearContour(between, 0.01, 0), "shifted contour is found");
+  between[0] -= 100;
+  MITK_TEST_CONDITION(!contour->IsNearContour(between, 0.01, 0), "shifted contour is not at the old position");
+
+  // concatenated vertices stay valid after the source contour is gone
+  mitk::ContourModel::Pointer concatenated = mitk::ContourModel::New();
+  concatenated->Concatenate(contour);
+  const mitk::ContourModel::VertexType *vertex = concatenated->GetVertexAt(4999);
+  mitk::Point3D lastPoint = vertex->Coordinates;
+  contour = nullptr;
+  MITK_TEST_CONDITION(mitk::Equal(vertex->Coordinates, lastPoint), "concatenated vertices are kept alive");
+  MITK_TEST_CONDITION(concatenated->SelectVertexAt(lastPoint, 0.1) &&
+                        concatenated->GetSelectedVertex() == vertex,
+                      "select concatenated vertex");
+}
+
 int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
 {
   MITK_TEST_BEGIN("mitkContourModelTest")
@@ -414,6 +479,7 @@ int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
   TestSetVertices();
   TestSelectVertexAtWrongPosition();
   TestContourModelAPI();
+  TestLongContourLookup();
 
   MITK_TEST_END()
 }
@@ -108,6 +108,25 @@ namespace mitk
       this->m_ZMax = zMax;
     }
 
+    /** \brief Set the slab mode of the reslicer (VTK_IMAGE_SLAB_MIN, VTK_IMAGE_SLAB_MAX, VTK_IMAGE_SLAB_MEAN
+    * or VTK_IMAGE_SLAB_SUM, see vtkImageReslice).
+    * Only used if the number of slab slices is larger than 1.
+    */
+    void SetSlabMode(int slabMode) { this->m_SlabMode = slabMode; }
+    int GetSlabMode() const { return this->m_SlabMode; }
+    /** \brief Set the number of slices that are combined into the 2D output (default 1: no slab).
+    * The slices are sampled along the normal of the world geometry, centered on it, with the
+    * spacing set by SetOutputSpacingZDirection(). They are combined while reslicing, i.e. no
+    * intermediate 3D stack is created. Requires an output dimension of 2.
+    */
+    void SetSlabNumberOfSlices(int numberOfSlices) { this->m_SlabNumberOfSlices = numberOfSlices < 1 ? 1 : numberOfSlices; }
+    int GetSlabNumberOfSlices() const { return this->m_SlabNumberOfSlices; }
+    /** \brief Set a factor that is applied to the resliced values before they are converted to the
+    * output type (default 1), e.g. to normalize a VTK_IMAGE_SLAB_SUM slab.
+    */
+    void SetScalarScale(double scalarScale) { this->m_ScalarScale = scalarScale; }
+    double GetScalarScale() const { return this->m_ScalarScale; }
+
     /** \brief Get the bounding box of the slice [xMin, xMax, yMin, yMax, zMin, zMax]
     * The method uses the input of the filter to calculate the bounds.
     * It is recommended to use
@@ -159,6 +178,8 @@ namespace mitk
       this->m_InterpolationMode = interpolation;
     }
 
+    ExtractSliceFilter::ResliceInterpolation GetInterpolationMode() const { return this->m_InterpolationMode; }
+
   protected:
     ExtractSliceFilter(vtkImageReslice *reslicer = nullptr);
     ~ExtractSliceFilter() override;
@@ -180,6 +201,12 @@ namespace mitk
 
     int m_ZMax;
 
+    int m_SlabMode;
+
+    int m_SlabNumberOfSlices;
+
+    double m_ScalarScale;
+
     ResliceInterpolation m_InterpolationMode;
 
     bool m_InPlaneResampleExtentByGeometry; // Resampling grid corresponds to:  false->image    true->worldgeometry
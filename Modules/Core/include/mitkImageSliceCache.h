@@ -0,0 +1,124 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKIMAGESLICECACHE_H_HEADER_INCLUDED
+#define MITKIMAGESLICECACHE_H_HEADER_INCLUDED
+
+#include <MitkCoreExports.h>
+#include <mitkTimeGeometry.h>
+
+#include <vtkSmartPointer.h>
+
+#include <array>
+#include <list>
+
+class vtkImageData;
+class vtkMatrix4x4;
+
+namespace mitk
+{
+  class PlaneGeometry;
+
+  /** \brief Small least-recently-used cache for resliced 2D images.
+   *
+   * The cache is owned by a mapper's LocalStorage, i.e. there is one cache per
+   * render window. A slice is identified by everything that influences the
+   * reslicing step: the plane geometry, the time step, the modification time
+   * of the data and the reslice parameters (interpolation, thick slices). Properties
+   * that only influence the appearance of the slice (level window, lookup table,
+   * color, opacity) are deliberately not part of the key, so changing them reuses
+   * the cached slice and only reruns the level window filter.
+   *
+   * \sa ImageVtkMapper2D
+   */
+  class MITKCORE_EXPORT ImageSliceCache
+  {
+  public:
+    struct MITKCORE_EXPORT Key
+    {
+      Key();
+
+      /** \brief Fills the geometry part of the key (index-to-world matrix, offset, bounds) from a plane. */
+      void SetPlaneGeometry(const PlaneGeometry *planeGeometry);
+
+      bool operator==(const Key &other) const;
+      bool operator!=(const Key &other) const { return !(*this == other); }
+
+      std::array<double, 18> PlaneValues;
+      TimeStepType TimeStep;
+      unsigned long DataMTime;
+      unsigned long DataGeometryMTime;
+      int InterpolationMode;
+      int ThickSlicesMode;
+      int ThickSlicesNum;
+      bool ResampleExtentByGeometry;
+    };
+
+    struct MITKCORE_EXPORT Entry
+    {
+      Entry();
+
+      vtkSmartPointer<vtkImageData> Slice;
+      vtkSmartPointer<vtkMatrix4x4> ResliceAxes;
+      double ClippedPlaneBounds[6];
+      ScalarType Spacing[2];
+    };
+
+    /** \brief Number of slices kept by a cache that has not been enlarged (e.g. for prefetching). */
+    static const unsigned int DefaultCapacity = 8;
+
+    explicit ImageSliceCache(unsigned int capacity = DefaultCapacity);
+
+    /** \brief Returns the entry for the given key or nullptr. A hit marks the entry as most recently used.
+     *
+     * The returned pointer stays valid until the next call of Insert(), Clear() or SetCapacity().
+     */
+    const Entry *Find(const Key &key);
+
+    /** \brief Checks for an entry without changing the order of the entries. */
+    bool Contains(const Key &key) const;
+
+    /** \brief Inserts (or replaces) an entry and evicts the least recently used ones if the capacity is exceeded. */
+    void Insert(const Key &key, const Entry &entry);
+
+    void Clear();
+
+    void SetCapacity(unsigned int capacity);
+    unsigned int GetCapacity() const { return m_Capacity; }
+
+    /** \brief Upper limit for the memory occupied by all cached slices in bytes (0: no limit).
+     *
+     * The most recently used entry is never evicted because of the memory budget.
+     */
+    void SetMemoryBudget(std::size_t bytes);
+    std::size_t GetMemoryBudget() const { return m_MemoryBudget; }
+
+    unsigned int GetSize() const { return static_cast<unsigned int>(m_Entries.size()); }
+
+    /** \brief Memory occupied by all cached slices in bytes. */
+    std::size_t GetMemorySize() const;
+
+    /** \brief Memory occupied by the slice of an entry in bytes. */
+    static std::size_t GetMemorySize(const Entry &entry);
+
+  private:
+    void Shrink();
+
+    typedef std::list<std::pair<Key, Entry>> EntryListType;
+
+    EntryListType m_Entries;
+    unsigned int m_Capacity;
+    std::size_t m_MemoryBudget;
+  };
+}
+
+#endif
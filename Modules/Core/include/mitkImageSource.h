@@ -129,6 +129,9 @@ namespace mitk
     virtual vtkImageData *GetVtkImageData();
     virtual const vtkImageData *GetVtkImageData() const;
 
+    /** @brief Traces the data generation of all image sources and filters as span named after the class (see mitk::Trace). */
+    void UpdateOutputData(itk::DataObject *output) override;
+
   protected:
     ImageSource();
     ~ImageSource() override {}
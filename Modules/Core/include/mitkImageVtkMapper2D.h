@@ -19,6 +19,8 @@ found in the LICENSE file.
 // MITK Rendering
 #include "mitkBaseRenderer.h"
 #include "mitkExtractSliceFilter.h"
+#include "mitkImageSliceCache.h"
+#include "mitkSlicePrefetcher.h"
 #include "mitkVtkMapper.h"
 
 // VTK
@@ -38,6 +40,7 @@ class vtkMitkThickSlicesFilter;
 class vtkPolyData;
 class vtkMitkApplyLevelWindowToRGBFilter;
 class vtkMitkLevelWindowFilter;
+class vtkMatrix4x4;
 
 namespace mitk
 {
@@ -88,6 +91,15 @@ namespace mitk
    *   - \b "texture interpolation": (BoolProperty) texture interpolation of the image
    *   - \b "reslice interpolation": (VtkResliceInterpolationProperty) reslice interpolation of the image
    *   - \b "in plane resample extent by geometry": (BoolProperty) Do it or not
+   *   - \b "Image Rendering.Slice Cache": (BoolProperty) Keep the most recently resliced slices of each render
+   *          window and reuse them if plane geometry, time step, data and reslice parameters did not change.
+   *          Level window, lookup table and color changes then only rerun the level window filter.
+   *   - \b "Image Rendering.Slice Prefetch": (BoolProperty) Requires the slice cache. Predicts the next slices
+   *          (or time steps) from the navigation direction and reslices them on background threads.
+   *   - \b "Image Rendering.Slice Prefetch.Depth": (IntProperty) Maximum number of slices prefetched in
+   *          navigation direction. The actual number grows with the number of consecutive steps in one direction.
+   *   - \b "Image Rendering.Slice Cache.Memory Budget": (IntProperty) Memory in MB the cached and prefetched
+   *          slices of one render window may occupy.
    *   - \b "bounding box": (BoolProperty) Is the Bounding Box of the image shown or not
    *   - \b "layer": (IntProperty) Layer of the image
    *   - \b "volume annotation color": (ColorProperty) color of the volume annotation, TODO has to be reimplemented
@@ -103,6 +115,10 @@ namespace mitk
    *   - \b "texture interpolation", mitk::BoolProperty::New( false ) )
    *   - \b "reslice interpolation", mitk::VtkResliceInterpolationProperty::New() )
    *   - \b "in plane resample extent by geometry", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.Slice Cache", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.Slice Prefetch", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.Slice Prefetch.Depth", mitk::IntProperty::New( 4 ) )
+   *   - \b "Image Rendering.Slice Cache.Memory Budget", mitk::IntProperty::New( 256 ) )
    *   - \b "bounding box", mitk::BoolProperty::New( false ) )
    *   - \b "layer", mitk::IntProperty::New(10), renderer, overwrite)
    *   - \b "Image Rendering.Transfer Function":  Default color transfer function for CTs
@@ -183,6 +199,23 @@ namespace mitk
 
       /** \brief mmPerPixel relation between pixel and mm. (World spacing).*/
       mitk::ScalarType *m_mmPerPixel;
+      /** \brief Storage for the in-plane spacing of the current slice, m_mmPerPixel points to it. */
+      mitk::ScalarType m_SliceSpacing[2];
+      /** \brief Reslice axes of the current slice (copied from the reslicer or the slice cache). */
+      vtkSmartPointer<vtkMatrix4x4> m_ResliceAxes;
+      /** \brief Recently resliced slices of this render window (see property "Image Rendering.Slice Cache"). */
+      mitk::ImageSliceCache m_SliceCache;
+      /** \brief Reslices predicted slices of this render window in the background. */
+      mitk::SlicePrefetcher m_Prefetcher;
+      /** \brief Slice index, time step and number of consecutive steps in the same direction
+            of the last update; used to predict the next slices. */
+      int m_LastSlice;
+      int m_LastTimeStep;
+      int m_SliceStep;
+      int m_TimeStepStep;
+      int m_PrefetchStreak;
+      /** \brief True if the current slice was resliced with reduced quality on request of the RenderingManager. */
+      bool m_RenderingDegraded;
 
       /** \brief This filter is used to apply the level window to Grayvalue and RBG(A) images. */
       vtkSmartPointer<vtkMitkLevelWindowFilter> m_LevelWindowFilter;
@@ -191,6 +224,10 @@ namespace mitk
       LocalStorage();
       /** \brief Default deconstructor of the local storage. */
       ~LocalStorage() override;
+
+      /** \brief Drops all pending prefetch jobs, shrinks the slice cache back to its default
+            capacity and forgets the navigation history. */
+      void StopPrefetching();
     };
 
     /** \brief The LocalStorageHandler holds all (three) LocalStorages for the three 2D render windows. */
@@ -300,6 +337,18 @@ namespace mitk
       * If the distances have different sign, there is an intersection.
       **/
     bool RenderingGeometryIntersectsImage(const PlaneGeometry *renderingGeometry, SlicedGeometry3D *imageGeometry);
+
+    /** \brief Predicts the next slices and time steps from the navigation history of the renderer
+      * and requests them from the prefetcher of the local storage.
+      *
+      * Only single (not thick) slices of plane geometries are prefetched. The predicted slices are
+      * resliced on a shallow copy of the respective image volume, so the worker threads never
+      * touch the pipeline of the input image.
+      */
+    void PrefetchSlices(mitk::BaseRenderer *renderer, const ImageSliceCache::Key &currentKey);
+
+    /** \brief Stops prefetching for the renderer while the image is hidden or has no valid time step. */
+    void ResetMapper(BaseRenderer *renderer) override;
   };
 
 } // namespace mitk
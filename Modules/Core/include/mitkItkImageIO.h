@@ -45,6 +45,15 @@ namespace mitk
     void Write() override;
     ConfidenceLevel GetWriterConfidenceLevel() const override;
 
+    /**
+     * \brief Whether images are compressed if the ITK ImageIO supports it (default: true)
+     *
+     * This is not a writer option, so interactive saving does not ask for it. It is meant for
+     * callers that use the writer directly, e.g. to store large images uncompressed in a scene.
+     */
+    void SetUseCompression(bool useCompression);
+    bool GetUseCompression() const;
+
   protected:
     virtual std::vector<std::string> FixUpImageIOExtensions(const std::string &imageIOName);
     virtual void FixUpCustomMimeTypeName(const std::string &imageIOName, CustomMimeType &customMimeType);
@@ -58,6 +67,7 @@ namespace mitk
     ItkImageIO *IOClone() const override;
 
     itk::ImageIOBase::Pointer m_ImageIO;
+    bool m_UseCompression;
 
     std::vector<std::string> m_DefaultMetaDataKeys;
   };
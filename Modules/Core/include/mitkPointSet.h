@@ -14,12 +14,15 @@ found in the LICENSE file.
 #define MITKPointSet_H_HEADER_INCLUDED
 
 #include "mitkBaseData.h"
+#include "mitkPointSetSpatialIndex.h"
 
 #include <itkDefaultDynamicMeshTraits.h>
 #include <itkMesh.h>
 
 namespace mitk
 {
+  class PlaneGeometry;
+
   /**
    * \brief Data structure which stores a set of points. Superclass of
    * mitk::Mesh.
@@ -253,6 +256,27 @@ namespace mitk
      */
     int SearchPoint(Point3D point, ScalarType distance, int t = 0) const;
 
+    /**
+     * \brief searches all points closer to a plane than distance
+     *
+     * \param distance is in mm.
+     * The identifiers of the points are returned in ascending order.
+     */
+    void SearchPointsNearPlane(const PlaneGeometry *plane,
+                               ScalarType distance,
+                               std::vector<PointIdentifier> &ids,
+                               int t = 0) const;
+
+    /**
+     * \brief returns the spatial index of the points of time step t (in index coordinates)
+     *
+     * The index is built with the first request and afterwards kept up to date by the methods
+     * of PointSet that change points. If the points were changed directly in the itk::Mesh, it
+     * is rebuilt with the next request. Returns nullptr for an invalid time step. The pointer
+     * may become invalid when the number of time steps changes.
+     */
+    const PointSetSpatialIndex *GetSpatialIndex(int t = 0) const;
+
     bool IsEmptyTimeStep(unsigned int t) const override;
 
     // virtual methods, that need to be implemented
@@ -281,12 +305,33 @@ namespace mitk
     /** \brief swaps point coordinates and point data of the points with identifiers id1 and id2 */
     bool SwapPointContents(PointIdentifier id1, PointIdentifier id2, int t = 0);
 
+    /** \brief returns true if the spatial index of time step t exists and matches the points */
+    bool IsSpatialIndexUpToDate(int t) const;
+
+    /**
+     * \brief updates the spatial index of time step t after the point id was set to indexPoint
+     * or removed (indexPoint == nullptr), if the index was up to date before the change
+     */
+    void UpdateSpatialIndex(int t, bool wasUpToDate, PointIdentifier id, const PointType *indexPoint);
+
     typedef std::vector<DataType::Pointer> PointSetSeries;
 
     PointSetSeries m_PointSetSeries;
 
     DataType::PointsContainer::Pointer m_EmptyPointsContainer;
 
+    struct SpatialIndexType
+    {
+      PointSetSpatialIndex Index;
+      const PointsContainer *Points = nullptr;
+      unsigned long PointsTime = 0;
+    };
+
+    /**
+    * @brief spatial index for each time step, see GetSpatialIndex()
+    **/
+    mutable std::vector<SpatialIndexType> m_SpatialIndices;
+
     /**
     * @brief flag to indicate the right time to call SetBounds
     **/
@@ -0,0 +1,93 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKPOINTSETSPATIALINDEX_H_HEADER_INCLUDED
+#define MITKPOINTSETSPATIALINDEX_H_HEADER_INCLUDED
+
+#include <MitkCoreExports.h>
+#include <mitkNumericTypes.h>
+
+#include <itkIntTypes.h>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /** \brief Uniform grid over the points of one time step of a PointSet.
+   *
+   * The grid allows to find the points close to a position or to a plane without visiting
+   * all points. It is updated incrementally by SetPoint() and RemovePoint(). The grid is
+   * rebuilt when a point is set outside of its extent or when the number of points grew
+   * a lot since the last build, the extent is enlarged by a margin then to keep rebuilds rare.
+   *
+   * The index does not know about geometries, all positions are in the coordinate system
+   * in which the points were given.
+   *
+   * \sa PointSet::GetSpatialIndex()
+   */
+  class MITKCORE_EXPORT PointSetSpatialIndex
+  {
+  public:
+    typedef itk::IdentifierType IdentifierType;
+
+    PointSetSpatialIndex();
+
+    /** \brief Replaces all points of the index and builds the grid for them. */
+    void Build(const std::vector<std::pair<IdentifierType, Point3D>> &points);
+
+    void Clear();
+
+    /** \brief Inserts a point or moves it if the identifier exists. */
+    void SetPoint(IdentifierType id, const Point3D &point);
+
+    void RemovePoint(IdentifierType id);
+
+    std::size_t GetNumberOfPoints() const { return m_Points.size(); }
+
+    /** \brief Finds the point closest to point with a squared distance smaller than squaredDistance.
+     *
+     * Of several points with the same distance the one with the smallest identifier is returned.
+     * \return false if there is no point within the distance
+     */
+    bool FindClosestPoint(const Point3D &point, ScalarType squaredDistance, IdentifierType &id) const;
+
+    /** \brief Finds all points p with |normal * (p - origin)| <= distance, in ascending order of their identifiers.
+     *
+     * The normal does not have to be of unit length, distance is measured in multiples of its length.
+     */
+    void FindPointsNearPlane(const Point3D &origin,
+                             const Vector3D &normal,
+                             ScalarType distance,
+                             std::vector<IdentifierType> &ids) const;
+
+  private:
+    void Rebuild();
+    bool IsInsideGrid(const Point3D &point) const;
+    std::size_t GetCellIndex(const Point3D &point) const;
+    void RemoveFromCell(IdentifierType id, const Point3D &point);
+    int GetCellCoordinate(ScalarType coordinate, unsigned int axis) const;
+
+    std::unordered_map<IdentifierType, Point3D> m_Points;
+    std::vector<std::vector<IdentifierType>> m_Cells;
+
+    Point3D m_Origin;
+    Vector3D m_CellSize;
+    int m_Dimensions[3];
+
+    /// number of points at the last build of the grid
+    std::size_t m_BuildSize;
+  };
+}
+
+#endif
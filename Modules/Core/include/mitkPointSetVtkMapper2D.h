@@ -22,6 +22,8 @@ found in the LICENSE file.
 // VTK
 #include <vtkSmartPointer.h>
 class vtkActor;
+class vtkActor2D;
+class vtkLabeledDataMapper;
 class vtkPropAssembly;
 class vtkPolyData;
 class vtkPolyDataMapper;
@@ -29,6 +31,7 @@ class vtkGlyphSource2D;
 class vtkGlyph3D;
 class vtkFloatArray;
 class vtkCellArray;
+class vtkStringArray;
 
 namespace mitk
 {
@@ -64,6 +67,12 @@ namespace mitk
   * object is returned in GetProp() and so hooked up into the rendering
   * pipeline.
   *
+  * Only the points near the current plane are visited, they are found with the
+  * spatial index of the PointSet (see PointSet::SearchPointsNearPlane()). If a
+  * contour is shown all points are visited, since the contour connects consecutive
+  * points. The labels, distances and angles are rendered by one vtkLabeledDataMapper
+  * per kind of text instead of one text actor per point.
+  *
   * @section mitkPointSetVtkMapper2D_propertires Applicable Properties
   *
   * Properties that can be set for point sets and influence the PointSetVTKMapper2D are:
@@ -173,11 +182,32 @@ namespace mitk
       vtkSmartPointer<vtkActor> m_UnselectedActor;
       vtkSmartPointer<vtkActor> m_SelectedActor;
       vtkSmartPointer<vtkActor> m_ContourActor;
-      vtkSmartPointer<vtkTextActor> m_VtkTextActor;
 
-      std::vector<vtkSmartPointer<vtkTextActor>> m_VtkTextLabelActors;
-      std::vector<vtkSmartPointer<vtkTextActor>> m_VtkTextDistanceActors;
-      std::vector<vtkSmartPointer<vtkTextActor>> m_VtkTextAngleActors;
+      /** \brief Texts rendered at display positions by a single vtkLabeledDataMapper. */
+      struct TextLabels
+      {
+        TextLabels();
+
+        /** \brief Removes all texts. */
+        void Reset();
+
+        void Add(double x, double y, const std::string &text);
+
+        /** \brief Passes the texts to the mapper and sets their color. */
+        void Update(double red, double green, double blue);
+
+        bool IsEmpty() const;
+
+        vtkSmartPointer<vtkPoints> Positions;
+        vtkSmartPointer<vtkStringArray> Texts;
+        vtkSmartPointer<vtkPolyData> PolyData;
+        vtkSmartPointer<vtkLabeledDataMapper> Mapper;
+        vtkSmartPointer<vtkActor2D> Actor;
+      };
+
+      TextLabels m_PointLabels;
+      TextLabels m_DistanceLabels;
+      TextLabels m_AngleLabels;
 
       // mappers
       vtkSmartPointer<vtkPolyDataMapper> m_VtkUnselectedPolyDataMapper;
@@ -0,0 +1,111 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKPOLYDATACUTINDEX_H_HEADER_INCLUDED
+#define MITKPOLYDATACUTINDEX_H_HEADER_INCLUDED
+
+#include <MitkCoreExports.h>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkPolyData;
+
+namespace mitk
+{
+  /** \brief Bounding volume hierarchy over the cells of a vtkPolyData for cutting it with planes.
+   *
+   * A plane usually cuts only a small part of the cells of a large surface. The index finds
+   * these cells without visiting the others: the hierarchy is traversed down to the leaves
+   * whose bounding boxes are cut by the plane and only the cells of these leaves are tested,
+   * in parallel for large meshes. A cell is cut if it has points on both sides of the plane
+   * (or on the plane), which is exactly the set of cells vtkCutter produces output for.
+   *
+   * The index is built lazily by the first query after SetInput() and rebuilt when the
+   * modification time of the poly data changes. It copies the points and the connectivity of
+   * the poly data, so queries are safe to run concurrently with reading the poly data.
+   *
+   * \sa SurfaceVtkMapper2D
+   */
+  class MITKCORE_EXPORT PolyDataCutIndex
+  {
+  public:
+    PolyDataCutIndex();
+    ~PolyDataCutIndex();
+
+    void SetInput(vtkPolyData *polyData);
+    vtkPolyData *GetInput() const;
+
+    /** \brief Number of threads used to test the cells (0: number of hardware threads). */
+    void SetNumberOfThreads(unsigned int numberOfThreads);
+    unsigned int GetNumberOfThreads() const { return m_NumberOfThreads; }
+
+    /** \brief Number of candidate cells per thread below which fewer threads are used (default: 16384).
+     *
+     * Small cuts are tested by the calling thread alone, since starting threads costs more than testing the cells.
+     */
+    void SetMinimumCellsPerThread(vtkIdType minimumCellsPerThread);
+    vtkIdType GetMinimumCellsPerThread() const { return m_MinimumCellsPerThread; }
+
+    /** \brief Builds the index if the input changed since the last build. */
+    void Update();
+
+    /** \brief Collects the ids of all cells cut by a plane in ascending order.
+     *
+     * Origin and normal of the plane are given in the coordinate system of the points of the input.
+     */
+    void FindCutCells(const double origin[3], const double normal[3], std::vector<vtkIdType> &cellIds);
+
+    /** \brief Copies the cells cut by a plane with their points, point data and cell data into output.
+     *
+     * The cells keep their order and their type (vertices, lines, polygons, triangle strips).
+     */
+    void ExtractCutCells(const double origin[3], const double normal[3], vtkPolyData *output);
+
+    /** \brief Number of nodes of the hierarchy (0 if it is not built). */
+    std::size_t GetNumberOfNodes() const { return m_Nodes.size(); }
+
+  private:
+    struct Node
+    {
+      double Bounds[6];
+      vtkIdType First;
+      vtkIdType Count;
+      int Children[2];
+    };
+
+    void Build();
+    int BuildNode(vtkIdType first, vtkIdType count, std::vector<double> &cellBounds);
+    bool IsCellCut(vtkIdType cellId, const double normal[3], double offset, double tolerance) const;
+
+    vtkSmartPointer<vtkPolyData> m_Input;
+    vtkMTimeType m_BuildTime;
+    unsigned int m_NumberOfThreads;
+    vtkIdType m_MinimumCellsPerThread;
+
+    std::vector<double> m_Points;
+    std::vector<vtkIdType> m_CellOffsets;
+    std::vector<vtkIdType> m_CellPointIds;
+    vtkIdType m_NumberOfCells[4];
+
+    std::vector<vtkIdType> m_CellOrder;
+    std::vector<Node> m_Nodes;
+    double m_Tolerance;
+
+    /// maps input point ids to output point ids in ExtractCutCells(), -1 for unused points
+    std::vector<vtkIdType> m_PointMap;
+  };
+}
+
+#endif
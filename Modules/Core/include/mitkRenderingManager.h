@@ -19,6 +19,7 @@ found in the LICENSE file.
 
 #include <itkObject.h>
 #include <itkObjectFactory.h>
+#include <set>
 #include <string>
 
 #include "mitkProperties.h"
@@ -293,6 +294,50 @@ namespace mitk
 
     void SetAntiAliasing(AntiAliasing antiAliasing);
 
+    /**
+     * \brief Frame-time statistics of a single render window.
+     *
+     * All times are given in milliseconds and cover the VTK rendering of the window
+     * including the update of its mappers.
+     */
+    struct FrameStatistics
+    {
+      unsigned long NumberOfFrames = 0;
+      unsigned long NumberOfDeferredFrames = 0;
+      unsigned long NumberOfDegradedFrames = 0;
+      double LastFrameTime = 0.0;
+      double MeanFrameTime = 0.0;
+      double MaximumFrameTime = 0.0;
+    };
+
+    /**
+     * \brief Time budget in milliseconds for rendering all requested windows of one frame (0: no budget).
+     *
+     * Pending requests are always coalesced, i.e. each window is rendered at most once per
+     * frame. The focused render window (the one under interaction) is rendered first. If a
+     * budget is set and exceeded, the remaining requested windows are deferred to the next
+     * frame. A window that has already been deferred once is rendered with reduced quality
+     * (see IsRenderingDegraded()) instead of being deferred again. As soon as a frame stays
+     * within the budget, all degraded windows are rendered with full quality again.
+     */
+    itkSetMacro(FrameBudget, double);
+    itkGetMacro(FrameBudget, double);
+
+    /** \brief Returns the frame-time statistics of the given render window. */
+    FrameStatistics GetFrameStatistics(vtkRenderWindow *renderWindow) const;
+
+    void ResetFrameStatistics();
+
+    /**
+     * \brief Returns true if the render window is currently rendered with reduced quality to meet the frame budget.
+     *
+     * Mappers may use cheaper algorithms in this case, e.g. nearest neighbor instead of linear
+     * interpolation. LOD enabled mappers are additionally rendered with the lowest LOD and the
+     * desired update rate of the window is raised to the frame rate of the budget, which makes
+     * VTK volume mappers increase their sample distances.
+     */
+    bool IsRenderingDegraded(vtkRenderWindow *renderWindow) const;
+
   protected:
     enum
     {
@@ -359,6 +404,17 @@ namespace mitk
 
     bool m_ConstrainedPanningZooming;
 
+    typedef std::map<vtkRenderWindow *, FrameStatistics> FrameStatisticsMap;
+    typedef std::set<vtkRenderWindow *> RenderWindowSet;
+    typedef std::map<vtkRenderWindow *, double> RenderWindowUpdateRateMap;
+
+    double m_FrameBudget;
+    FrameStatisticsMap m_FrameStatistics;
+    RenderWindowSet m_DeferredRenderWindows;
+
+    /** Degraded render windows and their desired update rate before the degradation. */
+    RenderWindowUpdateRateMap m_DegradedRenderWindows;
+
   private:
     void InternalViewInitialization(mitk::BaseRenderer *baseRenderer,
                                     const mitk::TimeGeometry *geometry,
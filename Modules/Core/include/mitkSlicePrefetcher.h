@@ -0,0 +1,84 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKSLICEPREFETCHER_H_HEADER_INCLUDED
+#define MITKSLICEPREFETCHER_H_HEADER_INCLUDED
+
+#include <mitkImageSliceCache.h>
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /** \brief Computes resliced images on background threads ahead of time.
+   *
+   * Each mapper LocalStorage that wants to prefetch owns one SlicePrefetcher.
+   * All prefetchers share a small pool of worker threads. A request replaces all
+   * jobs of the previous request that have not been started yet, so outdated
+   * predictions (e.g. after the user reversed the scroll direction) are dropped.
+   *
+   * Finished slices are kept until they are collected by TakeResults(), which
+   * has to be called from the thread owning the ImageSliceCache (usually the
+   * GUI thread). Jobs are skipped while the collected results exceed the memory budget.
+   *
+   * The reslice function of a job must not touch objects that are used by
+   * the GUI thread at the same time, i.e. it should work on its own filter
+   * instance and its own (shallow) copy of the input.
+   */
+  class MITKCORE_EXPORT SlicePrefetcher
+  {
+  public:
+    typedef std::function<ImageSliceCache::Entry()> ResliceFunctionType;
+    typedef std::pair<ImageSliceCache::Key, ResliceFunctionType> JobType;
+    typedef std::pair<ImageSliceCache::Key, ImageSliceCache::Entry> ResultType;
+
+    SlicePrefetcher();
+    ~SlicePrefetcher();
+
+    SlicePrefetcher(const SlicePrefetcher &) = delete;
+    SlicePrefetcher &operator=(const SlicePrefetcher &) = delete;
+
+    /** \brief Replaces all pending jobs by the given ones (ordered by priority, first job first). */
+    void Request(std::vector<JobType> jobs);
+
+    /** \brief Drops all pending jobs and all results that have not been collected yet. */
+    void Cancel();
+
+    /** \brief Returns true if a job for the key is pending or running or its result is waiting for collection. */
+    bool IsScheduled(const ImageSliceCache::Key &key) const;
+
+    /** \brief Moves all finished slices to the caller. */
+    std::vector<ResultType> TakeResults();
+
+    /** \brief Upper limit for the memory of not yet collected results in bytes (0: no limit). */
+    void SetMemoryBudget(std::size_t bytes);
+    std::size_t GetMemoryBudget() const;
+
+    /** \brief Number of worker threads shared by all prefetchers. */
+    static unsigned int GetNumberOfWorkerThreads();
+
+    /** \brief Stops the worker threads after their running jobs, pending jobs are dropped.
+     *
+     * Called when the Core module is unloaded. A later request starts new worker threads.
+     */
+    static void ShutdownWorkerThreads();
+
+  private:
+    struct State;
+    std::shared_ptr<State> m_State;
+  };
+}
+
+#endif
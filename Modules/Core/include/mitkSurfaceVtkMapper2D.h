@@ -15,9 +15,13 @@ found in the LICENSE file.
 
 #include "mitkBaseRenderer.h"
 #include "mitkLocalStorageHandler.h"
+#include "mitkPolyDataCutIndex.h"
 #include "mitkVtkMapper.h"
 #include <MitkCoreExports.h>
 
+#include <array>
+#include <map>
+
 // VTK
 #include <vtkSmartPointer.h>
 class vtkAssembly;
@@ -27,6 +31,7 @@ class vtkLookupTable;
 class vtkGlyph3D;
 class vtkArrowSource;
 class vtkReverseSense;
+class vtkPolyData;
 
 namespace mitk
 {
@@ -40,6 +45,11 @@ namespace mitk
     * according to its geometry before cutting, to support the geometry concept
     * of MITK.
     *
+    * Only the cells cut by the plane are passed to the vtkCutter. They are found
+    * with a PolyDataCutIndex per time step of the surface, which is shared by all
+    * render windows and rebuilt when the vtkPolyData is modified. The cut is not
+    * recomputed if only properties changed.
+    *
     * Properties:
     * \b Surface.2D.Line Width: Thickness of the rendered lines in 2D.
     * \b Surface.2D.Normals.Draw Normals: enables drawing of normals as 3D arrows
@@ -109,6 +119,19 @@ namespace mitk
          * @brief m_CuttingPlane The plane where to cut off the 2D slice.
          */
       vtkSmartPointer<vtkPlane> m_CuttingPlane;
+      /**
+         * @brief m_CutCells The cells of the surface cut by the plane, input of the cutter.
+         */
+      vtkSmartPointer<vtkPolyData> m_CutCells;
+      /**
+         * @brief m_CutParameters Plane (origin, normal) and transform of the data the current cut was made for.
+         */
+      std::array<double, 22> m_CutParameters;
+      /**
+         * @brief m_CutInput The vtkPolyData the current cut was made from and its modification time.
+         */
+      const vtkPolyData *m_CutInput;
+      unsigned long m_CutInputMTime;
 
       /**
        * @brief m_NormalMapper Mapper for the normals.
@@ -210,6 +233,11 @@ namespace mitk
        * @param renderer The respective renderer of the mitkRenderWindow.
        */
     void Update(BaseRenderer *renderer) override;
+
+    /**
+     * @brief m_CutIndices Cut index for each time step of the surface, shared by all renderers.
+     */
+    std::map<int, PolyDataCutIndex> m_CutIndices;
   };
 } // namespace mitk
 #endif /* mitkSurfaceVtkMapper2D_h */
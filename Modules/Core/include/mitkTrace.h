@@ -0,0 +1,165 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkTrace_h
+#define mitkTrace_h
+
+#include <MitkCoreExports.h>
+#include <mitkConfig.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * \brief Lightweight tracing of scoped spans (e.g. mapper updates or filter executions).
+   *
+   * Each thread records its spans into its own buffer without locking, the buffers of all
+   * threads are only merged when the spans are collected. While tracing is stopped, a trace
+   * point costs a single relaxed atomic load. Trace points are placed with the MITK_TRACE_SCOPE
+   * macros, which are compiled out completely if MITK is configured with MITK_ENABLE_TRACING=OFF.
+   *
+   * Recorded spans can be written as Chrome trace event JSON, which can be opened in
+   * chrome://tracing or https://ui.perfetto.dev.
+   *
+   * \code
+   * mitk::Trace::Start();
+   * {
+   *   MITK_TRACE_SCOPE("MyAlgorithm");
+   *   ...
+   * }
+   * mitk::Trace::Stop();
+   * mitk::Trace::WriteChromeTrace("trace.json");
+   * \endcode
+   */
+  class MITKCORE_EXPORT Trace
+  {
+  public:
+    /** \brief A finished span. Times are given in nanoseconds since Start(). */
+    struct Event
+    {
+      const char *Name = nullptr;
+      const char *Category = nullptr;
+      std::string Argument;
+      std::int64_t StartTime = 0;
+      std::int64_t Duration = 0;
+      unsigned int ThreadId = 0;
+    };
+
+    /** \brief Clears all recorded spans and starts recording.
+     *
+     * \param eventsPerThread Number of spans kept per thread. If a thread records more spans,
+     * its oldest spans are dropped.
+     */
+    static void Start(std::size_t eventsPerThread = 65536);
+
+    /** \brief Stops recording. Recorded spans are kept until the next Start() or Clear(). */
+    static void Stop();
+
+    static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+    /** \brief Discards all recorded spans. */
+    static void Clear();
+
+    /** \brief Returns the recorded spans of all threads, sorted by start time. */
+    static std::vector<Event> GetEvents();
+
+    /** \brief Writes all recorded spans in the Chrome trace event format. */
+    static void WriteChromeTrace(std::ostream &stream);
+
+    /** \brief Writes all recorded spans in the Chrome trace event format.
+     *
+     * \throws mitk::Exception if the file cannot be written.
+     */
+    static void WriteChromeTrace(const std::string &fileName);
+
+    /** \brief Current time in nanoseconds since Start(). */
+    static std::int64_t Now();
+
+    /** \brief Records a span of the calling thread. Name and category must be string literals
+     * or otherwise outlive the trace. */
+    static void Record(const char *name,
+                       const char *category,
+                       std::int64_t startTime,
+                       std::int64_t endTime,
+                       const std::string &argument = std::string());
+
+  private:
+    static std::atomic<bool> s_Enabled;
+  };
+
+  /**
+   * \brief Records a span from its construction until its destruction (see MITK_TRACE_SCOPE).
+   */
+  class MITKCORE_EXPORT TraceSpan
+  {
+  public:
+    TraceSpan(const char *name, const char *category)
+      : m_Name(name), m_Category(category), m_StartTime(Trace::IsEnabled() ? Trace::Now() : -1)
+    {
+    }
+
+    /** \brief The argument (e.g. a file name) is only copied while tracing is enabled. */
+    TraceSpan(const char *name, const char *category, const std::string &argument)
+      : TraceSpan(name, category)
+    {
+      if (m_StartTime >= 0)
+        m_Argument = argument;
+    }
+
+    ~TraceSpan()
+    {
+      if (m_StartTime >= 0)
+        Trace::Record(m_Name, m_Category, m_StartTime, Trace::Now(), m_Argument);
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+  private:
+    const char *m_Name;
+    const char *m_Category;
+    std::int64_t m_StartTime;
+    std::string m_Argument;
+  };
+}
+
+#define MITK_TRACE_CONCAT_IMPL(a, b) a##b
+#define MITK_TRACE_CONCAT(a, b) MITK_TRACE_CONCAT_IMPL(a, b)
+
+#ifdef MITK_ENABLE_TRACING
+
+/** \brief Traces the enclosing scope as a span with the given name in the category "mitk". */
+#define MITK_TRACE_SCOPE(name) \
+  mitk::TraceSpan MITK_TRACE_CONCAT(mitkTraceSpan, __LINE__)(name, "mitk")
+
+/** \brief Traces the enclosing scope as a span with the given name and category. */
+#define MITK_TRACE_SCOPE_CATEGORY(category, name) \
+  mitk::TraceSpan MITK_TRACE_CONCAT(mitkTraceSpan, __LINE__)(name, category)
+
+/** \brief Like MITK_TRACE_SCOPE_CATEGORY, additionally stores a string argument (e.g. a file name). */
+#define MITK_TRACE_SCOPE_ARGUMENT(category, name, argument) \
+  mitk::TraceSpan MITK_TRACE_CONCAT(mitkTraceSpan, __LINE__)(name, category, argument)
+
+#else
+
+#define MITK_TRACE_SCOPE(name)
+#define MITK_TRACE_SCOPE_CATEGORY(category, name)
+#define MITK_TRACE_SCOPE_ARGUMENT(category, name, argument)
+
+#endif
+
+#endif
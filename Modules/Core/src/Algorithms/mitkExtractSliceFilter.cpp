@@ -42,6 +42,9 @@ mitk::ExtractSliceFilter::ExtractSliceFilter(vtkImageReslice *reslicer): m_XMin(
   m_ZSpacing = 1.0;
   m_ZMin = 0;
   m_ZMax = 0;
+  m_SlabMode = VTK_IMAGE_SLAB_MAX;
+  m_SlabNumberOfSlices = 1;
+  m_ScalarScale = 1.0;
   m_VtkOutputRequested = false;
   m_BackgroundLevel = -32768.0;
   m_Component = 0;
@@ -397,6 +400,11 @@ void mitk::ExtractSliceFilter::GenerateData()
   // we only have one slice, not a volume
   m_Reslicer->SetOutputDimensionality(m_OutputDimension);
 
+  // thick slab: combine several slices along the normal while reslicing
+  m_Reslicer->SetSlabMode(m_SlabMode);
+  m_Reslicer->SetSlabNumberOfSlices(m_SlabNumberOfSlices);
+  m_Reslicer->SetScalarScale(m_ScalarScale);
+
   // set the interpolation mode for slicing
   switch (this->m_InterpolationMode)
   {
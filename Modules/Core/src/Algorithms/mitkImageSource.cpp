@@ -14,6 +14,7 @@ found in the LICENSE file.
 
 #include "mitkImageVtkReadAccessor.h"
 #include "mitkImageVtkWriteAccessor.h"
+#include "mitkTrace.h"
 
 mitk::ImageSource::ImageSource()
 {
@@ -168,6 +169,7 @@ ITK_THREAD_RETURN_TYPE mitk::ImageSource::ThreaderCallback(void *arg)
 
   if (threadId < total)
   {
+    MITK_TRACE_SCOPE_CATEGORY("filter", "ThreadedGenerateData");
     str->Filter->ThreadedGenerateData(splitRegion, threadId);
   }
   // else
@@ -185,6 +187,12 @@ void mitk::ImageSource::PrepareOutputs()
   Superclass::PrepareOutputs();
 }
 
+void mitk::ImageSource::UpdateOutputData(itk::DataObject *output)
+{
+  MITK_TRACE_SCOPE_CATEGORY("filter", this->GetNameOfClass());
+  Superclass::UpdateOutputData(output);
+}
+
 vtkImageData *mitk::ImageSource::GetVtkImageData()
 {
   Update();
@@ -28,6 +28,7 @@ found in the LICENSE file.
 #include <mitkVtkPropRenderer.h>
 
 #include <algorithm>
+#include <chrono>
 
 namespace mitk
 {
@@ -45,6 +46,7 @@ namespace mitk
       m_TimeNavigationController(SliceNavigationController::New()),
       m_DataStorage(nullptr),
       m_ConstrainedPanningZooming(true),
+      m_FrameBudget(0.0),
       m_FocusedRenderWindow(nullptr),
       m_AntiAliasing(AntiAliasing::FastApproximate)
   {
@@ -180,6 +182,16 @@ namespace mitk
         (*rw_it)->UnRegister(nullptr);
         m_AllRenderWindows.erase(rw_it);
       }
+
+      auto degraded_it = m_DegradedRenderWindows.find(renderWindow);
+      if (degraded_it != m_DegradedRenderWindows.end())
+      {
+        renderWindow->SetDesiredUpdateRate(degraded_it->second);
+        m_DegradedRenderWindows.erase(degraded_it);
+      }
+
+      m_FrameStatistics.erase(renderWindow);
+      m_DeferredRenderWindows.erase(renderWindow);
     }
   }
 
@@ -227,6 +239,7 @@ namespace mitk
 
     // Erase potentially pending requests for this window
     m_RenderWindowList[renderWindow] = RENDERING_INACTIVE;
+    m_DeferredRenderWindows.erase(renderWindow);
 
     m_UpdatePending = false;
 
@@ -242,7 +255,18 @@ namespace mitk
       if (vPR)
         vPR->PrepareRender();
       // Execute rendering
+      const auto start = std::chrono::steady_clock::now();
       renderWindow->Render();
+      const std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - start;
+
+      auto &statistics = m_FrameStatistics[renderWindow];
+      ++statistics.NumberOfFrames;
+      statistics.LastFrameTime = frameTime.count();
+      statistics.MeanFrameTime += (frameTime.count() - statistics.MeanFrameTime) / statistics.NumberOfFrames;
+      statistics.MaximumFrameTime = std::max(statistics.MaximumFrameTime, frameTime.count());
+
+      if (m_DegradedRenderWindows.count(renderWindow) != 0)
+        ++statistics.NumberOfDegradedFrames;
     }
   }
 
@@ -520,14 +544,69 @@ namespace mitk
   {
     m_UpdatePending = false;
 
-    // Satisfy all pending update requests
-    RenderWindowList::const_iterator it;
-    int i = 0;
-    for (it = m_RenderWindowList.cbegin(); it != m_RenderWindowList.cend(); ++it, ++i)
+    // Collect all pending update requests. Multiple requests for the same window
+    // since the last frame have already been merged into a single one.
+    RenderWindowVector requestedRenderWindows;
+    for (const auto &renderWindow : m_RenderWindowList)
+    {
+      if (renderWindow.second == RENDERING_REQUESTED)
+        requestedRenderWindows.push_back(renderWindow.first);
+    }
+
+    // The focused render window is the one the user interacts with, render it first
+    auto focusedRenderWindow =
+      std::find(requestedRenderWindows.begin(), requestedRenderWindows.end(), m_FocusedRenderWindow);
+    if (focusedRenderWindow != requestedRenderWindows.end())
+      std::rotate(requestedRenderWindows.begin(), focusedRenderWindow, focusedRenderWindow + 1);
+
+    const auto frameStart = std::chrono::steady_clock::now();
+    bool budgetExceeded = false;
+
+    for (auto renderWindow : requestedRenderWindows)
     {
-      if (it->second == RENDERING_REQUESTED)
+      if (budgetExceeded)
       {
-        this->ForceImmediateUpdate(it->first);
+        if (m_DeferredRenderWindows.insert(renderWindow).second)
+        {
+          // Keep the request, it is merged with the requests of the next frame
+          ++m_FrameStatistics[renderWindow].NumberOfDeferredFrames;
+          continue;
+        }
+
+        // Already deferred in the previous frame, render with reduced quality instead of starving it
+        if (m_DegradedRenderWindows.find(renderWindow) == m_DegradedRenderWindows.end())
+        {
+          m_DegradedRenderWindows[renderWindow] = renderWindow->GetDesiredUpdateRate();
+          renderWindow->SetDesiredUpdateRate(1000.0 / m_FrameBudget);
+        }
+
+        m_NextLODMap[BaseRenderer::GetInstance(renderWindow)] = 0;
+      }
+
+      this->ForceImmediateUpdate(renderWindow);
+
+      if (m_FrameBudget > 0.0)
+      {
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - frameStart;
+        budgetExceeded = elapsed.count() > m_FrameBudget;
+      }
+    }
+
+    if (!m_DeferredRenderWindows.empty())
+    {
+      m_UpdatePending = true;
+      this->GenerateRenderingRequestEvent();
+    }
+    else if (!budgetExceeded && !m_DegradedRenderWindows.empty())
+    {
+      // The load has decreased, render the degraded windows with full quality again
+      RenderWindowUpdateRateMap degradedRenderWindows;
+      degradedRenderWindows.swap(m_DegradedRenderWindows);
+
+      for (const auto &degradedRenderWindow : degradedRenderWindows)
+      {
+        degradedRenderWindow.first->SetDesiredUpdateRate(degradedRenderWindow.second);
+        this->RequestUpdate(degradedRenderWindow.first);
       }
     }
   }
@@ -634,7 +713,7 @@ namespace mitk
     {
       BaseRenderer *renderer = BaseRenderer::GetInstance(it->first);
 
-      if (renderer->GetNumberOfVisibleLODEnabledMappers() > 0)
+      if (renderer->GetNumberOfVisibleLODEnabledMappers() > 0 && m_DegradedRenderWindows.count(it->first) == 0)
       {
         if (m_NextLODMap[renderer] == 0)
         {
@@ -645,6 +724,25 @@ namespace mitk
     }
   }
 
+  RenderingManager::FrameStatistics RenderingManager::GetFrameStatistics(vtkRenderWindow *renderWindow) const
+  {
+    auto statistics = m_FrameStatistics.find(renderWindow);
+
+    return statistics != m_FrameStatistics.cend()
+      ? statistics->second
+      : FrameStatistics();
+  }
+
+  void RenderingManager::ResetFrameStatistics()
+  {
+    m_FrameStatistics.clear();
+  }
+
+  bool RenderingManager::IsRenderingDegraded(vtkRenderWindow *renderWindow) const
+  {
+    return m_DegradedRenderWindows.count(renderWindow) != 0;
+  }
+
   void RenderingManager::SetMaximumLOD(unsigned int max) { m_MaxLOD = max; }
   // enable/disable shading
   void RenderingManager::SetShading(bool state, unsigned int lod)
@@ -20,6 +20,7 @@ found in the LICENSE file.
 #include "mitkNodePredicateBase.h"
 #include "mitkNodePredicateProperty.h"
 #include "mitkProperties.h"
+#include "mitkTrace.h"
 #include "mitkArbitraryTimeGeometry.h"
 
 mitk::DataStorage::DataStorage() : itk::Object(), m_BlockNodeModifiedEvents(false)
@@ -54,6 +55,7 @@ void mitk::DataStorage::Remove(const DataStorage::SetOfObjects *nodes)
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::DataStorage::GetSubset(const NodePredicateBase *condition) const
 {
+  MITK_TRACE_SCOPE_CATEGORY("datastorage", "DataStorage::GetSubset");
   DataStorage::SetOfObjects::ConstPointer result = this->FilterSetOfObjects(this->GetAll(), condition);
   return result;
 }
@@ -12,6 +12,7 @@ found in the LICENSE file.
 
 #include "mitkPointSet.h"
 #include "mitkInteractionConst.h"
+#include "mitkPlaneGeometry.h"
 #include "mitkPointOperation.h"
 
 #include <iomanip>
@@ -51,6 +52,7 @@ mitk::PointSet::~PointSet()
 void mitk::PointSet::ClearData()
 {
   m_PointSetSeries.clear();
+  m_SpatialIndices.clear();
   Superclass::ClearData();
 }
 
@@ -182,24 +184,17 @@ mitk::PointSet::PointsIterator mitk::PointSet::GetMaxId(int t)
 
 int mitk::PointSet::SearchPoint(Point3D point, ScalarType distance, int t) const
 {
-  if (t >= (int)m_PointSetSeries.size())
+  const PointSetSpatialIndex *spatialIndex = this->GetSpatialIndex(t);
+  if (spatialIndex == nullptr)
   {
     return -1;
   }
 
-  // Out is the point which is checked to be the searched point
-  PointType out;
-  out.Fill(0);
   PointType indexPoint;
-
   this->GetGeometry(t)->WorldToIndex(point, indexPoint);
 
-  // Searching the first point in the Set, that is +- distance far away fro
-  // the given point
-  unsigned int i;
-  PointsContainer::Iterator it, end;
-  end = m_PointSetSeries[t]->GetPoints()->End();
-  int bestIndex = -1;
+  // Searching the point in the Set, that is closest to the given point
+  // and less than distance away from it
   distance = distance * distance;
 
   // To correct errors from converting index to world and world to index
@@ -208,37 +203,107 @@ int mitk::PointSet::SearchPoint(Point3D point, ScalarType distance, int t) const
     distance = 0.000001;
   }
 
-  ScalarType bestDist = distance;
-  ScalarType dist, tmp;
+  PointIdentifier id;
+  if (spatialIndex->FindClosestPoint(indexPoint, distance, id))
+  {
+    return id;
+  }
+  return -1;
+}
 
-  for (it = m_PointSetSeries[t]->GetPoints()->Begin(), i = 0; it != end; ++it, ++i)
+void mitk::PointSet::SearchPointsNearPlane(const PlaneGeometry *plane,
+                                           ScalarType distance,
+                                           std::vector<PointIdentifier> &ids,
+                                           int t) const
+{
+  ids.clear();
+
+  const PointSetSpatialIndex *spatialIndex = this->GetSpatialIndex(t);
+  if (plane == nullptr || spatialIndex == nullptr)
   {
-    bool ok = m_PointSetSeries[t]->GetPoints()->GetElementIfIndexExists(it->Index(), &out);
+    return;
+  }
 
-    if (!ok)
-    {
-      return -1;
-    }
-    else if (indexPoint == out) // if totally equal
+  // The spatial index works in index coordinates. With world = A * index + offset, the distance of a
+  // point to the plane is (A^T * normal) * (index - indexOrigin).
+  const BaseGeometry *geometry = this->GetGeometry(t);
+
+  Point3D indexOrigin;
+  geometry->WorldToIndex(plane->GetOrigin(), indexOrigin);
+
+  Vector3D normal = plane->GetNormal();
+  normal.Normalize();
+
+  const auto &matrix = geometry->GetIndexToWorldTransform()->GetMatrix();
+  Vector3D indexNormal;
+  for (unsigned int j = 0; j < 3; ++j)
+  {
+    indexNormal[j] = matrix[0][j] * normal[0] + matrix[1][j] * normal[1] + matrix[2][j] * normal[2];
+  }
+
+  spatialIndex->FindPointsNearPlane(indexOrigin, indexNormal, distance, ids);
+}
+
+const mitk::PointSetSpatialIndex *mitk::PointSet::GetSpatialIndex(int t) const
+{
+  if (t < 0 || t >= static_cast<int>(m_PointSetSeries.size()))
+  {
+    return nullptr;
+  }
+
+  if (!this->IsSpatialIndexUpToDate(t))
+  {
+    if (m_SpatialIndices.size() < m_PointSetSeries.size())
     {
-      return it->Index();
+      m_SpatialIndices.resize(m_PointSetSeries.size());
     }
 
-    // distance calculation
-    tmp = out[0] - indexPoint[0];
-    dist = tmp * tmp;
-    tmp = out[1] - indexPoint[1];
-    dist += tmp * tmp;
-    tmp = out[2] - indexPoint[2];
-    dist += tmp * tmp;
+    const PointsContainer *points = m_PointSetSeries[t]->GetPoints();
 
-    if (dist < bestDist)
+    std::vector<std::pair<PointIdentifier, PointType>> indexPoints;
+    indexPoints.reserve(points->Size());
+    for (PointsConstIterator it = points->Begin(); it != points->End(); ++it)
     {
-      bestIndex = it->Index();
-      bestDist = dist;
+      indexPoints.emplace_back(it->Index(), it->Value());
     }
+
+    m_SpatialIndices[t].Index.Build(indexPoints);
+    m_SpatialIndices[t].Points = points;
+    m_SpatialIndices[t].PointsTime = points->GetMTime();
   }
-  return bestIndex;
+
+  return &m_SpatialIndices[t].Index;
+}
+
+bool mitk::PointSet::IsSpatialIndexUpToDate(int t) const
+{
+  if (t < 0 || t >= static_cast<int>(m_SpatialIndices.size()) || t >= static_cast<int>(m_PointSetSeries.size()))
+  {
+    return false;
+  }
+
+  const PointsContainer *points = m_PointSetSeries[t]->GetPoints();
+  return points != nullptr && m_SpatialIndices[t].Points == points &&
+         m_SpatialIndices[t].PointsTime == points->GetMTime();
+}
+
+void mitk::PointSet::UpdateSpatialIndex(int t, bool wasUpToDate, PointIdentifier id, const PointType *indexPoint)
+{
+  if (!wasUpToDate)
+  {
+    return;
+  }
+
+  SpatialIndexType &spatialIndex = m_SpatialIndices[t];
+  if (indexPoint != nullptr)
+  {
+    spatialIndex.Index.SetPoint(id, *indexPoint);
+  }
+  else
+  {
+    spatialIndex.Index.RemovePoint(id);
+  }
+  spatialIndex.PointsTime = m_PointSetSeries[t]->GetPoints()->GetMTime();
 }
 
 mitk::PointSet::PointType mitk::PointSet::GetPoint(PointIdentifier id, int t) const
@@ -283,12 +348,15 @@ bool mitk::PointSet::GetPointIfExists(PointIdentifier id, PointType *point, int
 
 void mitk::PointSet::SetPoint(PointIdentifier id, PointType point, int t)
 {
+  const bool indexed = this->IsSpatialIndexUpToDate(t);
+
   // Adapt the size of the data vector if necessary
   this->Expand(t + 1);
 
   mitk::Point3D indexPoint;
   this->GetGeometry(t)->WorldToIndex(point, indexPoint);
   m_PointSetSeries[t]->SetPoint(id, indexPoint);
+  this->UpdateSpatialIndex(t, indexed, id, &indexPoint);
   PointDataType defaultPointData;
   defaultPointData.id = id;
   defaultPointData.selected = false;
@@ -302,12 +370,15 @@ void mitk::PointSet::SetPoint(PointIdentifier id, PointType point, int t)
 
 void mitk::PointSet::SetPoint(PointIdentifier id, PointType point, PointSpecificationType spec, int t)
 {
+  const bool indexed = this->IsSpatialIndexUpToDate(t);
+
   // Adapt the size of the data vector if necessary
   this->Expand(t + 1);
 
   mitk::Point3D indexPoint;
   this->GetGeometry(t)->WorldToIndex(point, indexPoint);
   m_PointSetSeries[t]->SetPoint(id, indexPoint);
+  this->UpdateSpatialIndex(t, indexed, id, &indexPoint);
   PointDataType defaultPointData;
   defaultPointData.id = id;
   defaultPointData.selected = false;
@@ -335,7 +406,9 @@ void mitk::PointSet::InsertPoint(PointIdentifier id, PointType point, PointSpeci
       return;
     }
     tempGeometry->WorldToIndex(point, indexPoint);
+    const bool indexed = this->IsSpatialIndexUpToDate(t);
     m_PointSetSeries[t]->GetPoints()->InsertElement(id, indexPoint);
+    this->UpdateSpatialIndex(t, indexed, id, &indexPoint);
     PointDataType defaultPointData;
     defaultPointData.id = id;
     defaultPointData.selected = false;
@@ -363,7 +436,9 @@ mitk::PointSet::PointIdentifier mitk::PointSet::InsertPoint(PointType point, int
 
   mitk::Point3D indexPoint;
   this->GetGeometry(t)->WorldToIndex(point, indexPoint);
+  const bool indexed = this->IsSpatialIndexUpToDate(t);
   m_PointSetSeries[t]->SetPoint(id, indexPoint);
+  this->UpdateSpatialIndex(t, indexed, id, &indexPoint);
   PointDataType defaultPointData;
   defaultPointData.id = id;
   defaultPointData.selected = false;
@@ -389,8 +464,10 @@ bool mitk::PointSet::RemovePointIfExists(PointIdentifier id, int t)
     bool exists = points->IndexExists(id);
     if (exists)
     {
+      const bool indexed = this->IsSpatialIndexUpToDate(t);
       points->DeleteIndex(id);
       pdata->DeleteIndex(id);
+      this->UpdateSpatialIndex(t, indexed, id, nullptr);
       return true;
     }
   }
@@ -412,8 +489,10 @@ mitk::PointSet::PointsIterator mitk::PointSet::RemovePointAtEnd(int t)
     if (eit != bit)
     {
       PointsContainer::ElementIdentifier id = (--eit).Index();
+      const bool indexed = this->IsSpatialIndexUpToDate(t);
       points->DeleteIndex(id);
       pdata->DeleteIndex(id);
+      this->UpdateSpatialIndex(t, indexed, id, nullptr);
       PointsIterator eit2 = points->End();
       return --eit2;
     }
@@ -598,7 +677,9 @@ void mitk::PointSet::ExecuteOperation(Operation *operation)
       }
       geometry->WorldToIndex(pt, pt);
 
+      const bool indexed = this->IsSpatialIndexUpToDate(timeStep);
       m_PointSetSeries[timeStep]->GetPoints()->InsertElement(position, pt);
+      this->UpdateSpatialIndex(timeStep, indexed, position, &pt);
 
       PointDataType pointData = {
         static_cast<unsigned int>(pointOp->GetIndex()), pointOp->GetSelected(), pointOp->GetPointType()};
@@ -624,7 +705,9 @@ void mitk::PointSet::ExecuteOperation(Operation *operation)
       this->GetGeometry(timeStep)->WorldToIndex(pt, pt);
 
       // Copy new point into container
+      const bool indexed = this->IsSpatialIndexUpToDate(timeStep);
       m_PointSetSeries[timeStep]->SetPoint(pointOp->GetIndex(), pt);
+      this->UpdateSpatialIndex(timeStep, indexed, pointOp->GetIndex(), &pt);
 
       // Insert a default point data object to keep the containers in sync
       // (if no point data object exists yet)
@@ -647,8 +730,10 @@ void mitk::PointSet::ExecuteOperation(Operation *operation)
 
     case OpREMOVE: // removes the point at given by position
     {
+      const bool indexed = this->IsSpatialIndexUpToDate(timeStep);
       m_PointSetSeries[timeStep]->GetPoints()->DeleteIndex((unsigned)pointOp->GetIndex());
       m_PointSetSeries[timeStep]->GetPointData()->DeleteIndex((unsigned)pointOp->GetIndex());
+      this->UpdateSpatialIndex(timeStep, indexed, (unsigned)pointOp->GetIndex(), nullptr);
 
       this->OnPointSetChange();
 
@@ -867,10 +952,13 @@ bool mitk::PointSet::SwapPointContents(PointIdentifier id1, PointIdentifier id2,
   if (m_PointSetSeries[timeStep]->GetPointData(id2, &data2) == false)
     return false;
   /* now swap contents */
+  const bool indexed = this->IsSpatialIndexUpToDate(timeStep);
   m_PointSetSeries[timeStep]->SetPoint(id1, p2);
   m_PointSetSeries[timeStep]->SetPointData(id1, data2);
   m_PointSetSeries[timeStep]->SetPoint(id2, p1);
   m_PointSetSeries[timeStep]->SetPointData(id2, data1);
+  this->UpdateSpatialIndex(timeStep, indexed, id1, &p2);
+  this->UpdateSpatialIndex(timeStep, indexed, id2, &p1);
   return true;
 }
 
@@ -0,0 +1,318 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkPointSetSpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  // average number of points per grid cell
+  const std::size_t PointsPerCell = 2;
+
+  const std::size_t MaximumNumberOfCells = 1 << 21;
+
+  bool IsFinite(const mitk::Point3D &point)
+  {
+    return std::isfinite(point[0]) && std::isfinite(point[1]) && std::isfinite(point[2]);
+  }
+}
+
+mitk::PointSetSpatialIndex::PointSetSpatialIndex() : m_BuildSize(0)
+{
+  m_Origin.Fill(0.0);
+  m_CellSize.Fill(1.0);
+  std::fill(m_Dimensions, m_Dimensions + 3, 1);
+}
+
+void mitk::PointSetSpatialIndex::Build(const std::vector<std::pair<IdentifierType, Point3D>> &points)
+{
+  m_Points.clear();
+  m_Points.reserve(points.size());
+  for (const auto &point : points)
+    m_Points[point.first] = point.second;
+
+  this->Rebuild();
+}
+
+void mitk::PointSetSpatialIndex::Clear()
+{
+  m_Points.clear();
+  m_Cells.clear();
+  m_BuildSize = 0;
+}
+
+void mitk::PointSetSpatialIndex::Rebuild()
+{
+  m_Cells.clear();
+  m_BuildSize = m_Points.size();
+
+  ScalarType bounds[6] = {std::numeric_limits<ScalarType>::max(),
+                          std::numeric_limits<ScalarType>::lowest(),
+                          std::numeric_limits<ScalarType>::max(),
+                          std::numeric_limits<ScalarType>::lowest(),
+                          std::numeric_limits<ScalarType>::max(),
+                          std::numeric_limits<ScalarType>::lowest()};
+  bool hasFinitePoints(false);
+  for (const auto &point : m_Points)
+  {
+    if (!IsFinite(point.second))
+      continue;
+
+    hasFinitePoints = true;
+    for (unsigned int axis = 0; axis < 3; ++axis)
+    {
+      bounds[2 * axis] = std::min(bounds[2 * axis], point.second[axis]);
+      bounds[2 * axis + 1] = std::max(bounds[2 * axis + 1], point.second[axis]);
+    }
+  }
+
+  if (!hasFinitePoints)
+  {
+    std::fill(bounds, bounds + 6, 0.0);
+  }
+
+  ScalarType extent[3];
+  ScalarType maximumExtent(0.0);
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    extent[axis] = bounds[2 * axis + 1] - bounds[2 * axis];
+    maximumExtent = std::max(maximumExtent, extent[axis]);
+  }
+
+  // flat point sets get a thin grid, and a margin keeps points set close to the current ones inside of the grid
+  const ScalarType minimumExtent = std::max<ScalarType>(1e-3 * maximumExtent, 1e-3);
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    const ScalarType enlargedExtent = 1.5 * std::max(extent[axis], minimumExtent);
+    m_Origin[axis] = bounds[2 * axis] - 0.5 * (enlargedExtent - extent[axis]);
+    extent[axis] = enlargedExtent;
+  }
+
+  const std::size_t numberOfCells =
+    std::min(MaximumNumberOfCells, std::max<std::size_t>(1, m_Points.size() / PointsPerCell));
+  const ScalarType cellLength = std::cbrt(extent[0] * extent[1] * extent[2] / numberOfCells);
+
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    m_Dimensions[axis] =
+      static_cast<int>(std::min<ScalarType>(std::max<ScalarType>(std::ceil(extent[axis] / cellLength), 1.0), 4096.0));
+    m_CellSize[axis] = extent[axis] / m_Dimensions[axis];
+  }
+
+  m_Cells.resize(static_cast<std::size_t>(m_Dimensions[0]) * m_Dimensions[1] * m_Dimensions[2]);
+  for (const auto &point : m_Points)
+    m_Cells[this->GetCellIndex(point.second)].push_back(point.first);
+}
+
+bool mitk::PointSetSpatialIndex::IsInsideGrid(const Point3D &point) const
+{
+  if (m_Cells.empty())
+    return false;
+
+  // points with invalid coordinates are kept in the first cell
+  if (!IsFinite(point))
+    return true;
+
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    if (point[axis] < m_Origin[axis] || point[axis] > m_Origin[axis] + m_Dimensions[axis] * m_CellSize[axis])
+      return false;
+  }
+  return true;
+}
+
+int mitk::PointSetSpatialIndex::GetCellCoordinate(ScalarType coordinate, unsigned int axis) const
+{
+  const ScalarType cell = std::floor((coordinate - m_Origin[axis]) / m_CellSize[axis]);
+  return static_cast<int>(std::min<ScalarType>(std::max<ScalarType>(cell, 0.0), m_Dimensions[axis] - 1));
+}
+
+std::size_t mitk::PointSetSpatialIndex::GetCellIndex(const Point3D &point) const
+{
+  if (!IsFinite(point))
+    return 0;
+
+  return (static_cast<std::size_t>(this->GetCellCoordinate(point[2], 2)) * m_Dimensions[1] +
+          this->GetCellCoordinate(point[1], 1)) *
+           m_Dimensions[0] +
+         this->GetCellCoordinate(point[0], 0);
+}
+
+void mitk::PointSetSpatialIndex::RemoveFromCell(IdentifierType id, const Point3D &point)
+{
+  auto &cell = m_Cells[this->GetCellIndex(point)];
+  auto it = std::find(cell.begin(), cell.end(), id);
+  if (it != cell.end())
+  {
+    *it = cell.back();
+    cell.pop_back();
+  }
+}
+
+void mitk::PointSetSpatialIndex::SetPoint(IdentifierType id, const Point3D &point)
+{
+  auto it = m_Points.find(id);
+  if (it != m_Points.end())
+  {
+    if (!m_Cells.empty())
+    {
+      this->RemoveFromCell(id, it->second);
+    }
+    it->second = point;
+  }
+  else
+  {
+    m_Points[id] = point;
+  }
+
+  if (!this->IsInsideGrid(point) || m_Points.size() > 2 * m_BuildSize + 64)
+  {
+    this->Rebuild();
+    return;
+  }
+
+  m_Cells[this->GetCellIndex(point)].push_back(id);
+}
+
+void mitk::PointSetSpatialIndex::RemovePoint(IdentifierType id)
+{
+  auto it = m_Points.find(id);
+  if (it == m_Points.end())
+    return;
+
+  if (!m_Cells.empty())
+  {
+    this->RemoveFromCell(id, it->second);
+  }
+  m_Points.erase(it);
+}
+
+bool mitk::PointSetSpatialIndex::FindClosestPoint(const Point3D &point,
+                                                  ScalarType squaredDistance,
+                                                  IdentifierType &id) const
+{
+  if (m_Cells.empty() || !IsFinite(point) || !(squaredDistance > 0.0))
+    return false;
+
+  const ScalarType distance = std::sqrt(squaredDistance);
+  int begin[3];
+  int end[3];
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    const ScalarType lower = std::floor((point[axis] - distance - m_Origin[axis]) / m_CellSize[axis]);
+    const ScalarType upper = std::floor((point[axis] + distance - m_Origin[axis]) / m_CellSize[axis]);
+    if (upper < 0.0 || lower > m_Dimensions[axis] - 1)
+      return false;
+
+    begin[axis] = static_cast<int>(std::max<ScalarType>(lower, 0.0));
+    end[axis] = static_cast<int>(std::min<ScalarType>(upper, m_Dimensions[axis] - 1)) + 1;
+  }
+
+  bool found(false);
+  ScalarType bestDistance = squaredDistance;
+  for (int z = begin[2]; z < end[2]; ++z)
+  {
+    for (int y = begin[1]; y < end[1]; ++y)
+    {
+      for (int x = begin[0]; x < end[0]; ++x)
+      {
+        const auto &cell = m_Cells[(static_cast<std::size_t>(z) * m_Dimensions[1] + y) * m_Dimensions[0] + x];
+        for (const IdentifierType cellId : cell)
+        {
+          const ScalarType cellDistance = point.SquaredEuclideanDistanceTo(m_Points.at(cellId));
+          if (cellDistance < bestDistance || (found && cellDistance == bestDistance && cellId < id))
+          {
+            id = cellId;
+            bestDistance = cellDistance;
+            found = true;
+          }
+        }
+      }
+    }
+  }
+  return found;
+}
+
+void mitk::PointSetSpatialIndex::FindPointsNearPlane(const Point3D &origin,
+                                                     const Vector3D &normal,
+                                                     ScalarType distance,
+                                                     std::vector<IdentifierType> &ids) const
+{
+  ids.clear();
+  if (m_Cells.empty() || !(distance >= 0.0))
+    return;
+
+  // the cells are visited in columns along the axis the normal is closest to
+  unsigned int axis = 0;
+  for (unsigned int i = 1; i < 3; ++i)
+  {
+    if (std::abs(normal[i]) > std::abs(normal[axis]))
+      axis = i;
+  }
+
+  if (normal[axis] == 0.0)
+  {
+    for (const auto &point : m_Points)
+      ids.push_back(point.first);
+    std::sort(ids.begin(), ids.end());
+    return;
+  }
+
+  const unsigned int u = (axis + 1) % 3;
+  const unsigned int v = (axis + 2) % 3;
+  const ScalarType offset = normal[0] * origin[0] + normal[1] * origin[1] + normal[2] * origin[2];
+
+  int cell[3];
+  for (cell[v] = 0; cell[v] < m_Dimensions[v]; ++cell[v])
+  {
+    const ScalarType v0 = m_Origin[v] + cell[v] * m_CellSize[v];
+    const ScalarType v1 = v0 + m_CellSize[v];
+
+    for (cell[u] = 0; cell[u] < m_Dimensions[u]; ++cell[u])
+    {
+      const ScalarType u0 = m_Origin[u] + cell[u] * m_CellSize[u];
+      const ScalarType u1 = u0 + m_CellSize[u];
+
+      // range of the part of normal * p that does not depend on the column axis
+      const ScalarType minimum = std::min(normal[u] * u0, normal[u] * u1) + std::min(normal[v] * v0, normal[v] * v1);
+      const ScalarType maximum = std::max(normal[u] * u0, normal[u] * u1) + std::max(normal[v] * v0, normal[v] * v1);
+
+      ScalarType lower = (offset - distance - maximum) / normal[axis];
+      ScalarType upper = (offset + distance - minimum) / normal[axis];
+      if (lower > upper)
+        std::swap(lower, upper);
+
+      const ScalarType first = std::floor((lower - m_Origin[axis]) / m_CellSize[axis]);
+      const ScalarType last = std::floor((upper - m_Origin[axis]) / m_CellSize[axis]);
+      if (last < 0.0 || first > m_Dimensions[axis] - 1)
+        continue;
+
+      const int end = static_cast<int>(std::min<ScalarType>(last, m_Dimensions[axis] - 1));
+      for (cell[axis] = static_cast<int>(std::max<ScalarType>(first, 0.0)); cell[axis] <= end; ++cell[axis])
+      {
+        const auto &cellIds =
+          m_Cells[(static_cast<std::size_t>(cell[2]) * m_Dimensions[1] + cell[1]) * m_Dimensions[0] + cell[0]];
+        for (const IdentifierType id : cellIds)
+        {
+          const Point3D &point = m_Points.at(id);
+          if (std::abs(normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2] - offset) <= distance)
+            ids.push_back(id);
+        }
+      }
+    }
+  }
+
+  std::sort(ids.begin(), ids.end());
+}
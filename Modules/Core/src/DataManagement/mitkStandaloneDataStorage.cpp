@@ -19,6 +19,7 @@ found in the LICENSE file.
 #include "mitkNodePredicateBase.h"
 #include "mitkNodePredicateProperty.h"
 #include "mitkProperties.h"
+#include "mitkTrace.h"
 
 mitk::StandaloneDataStorage::StandaloneDataStorage() : mitk::DataStorage()
 {
@@ -145,6 +146,7 @@ void mitk::StandaloneDataStorage::RemoveFromRelation(const mitk::DataNode *node,
 
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetAll() const
 {
+  MITK_TRACE_SCOPE_CATEGORY("datastorage", "StandaloneDataStorage::GetAll");
   itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
   if (!IsInitialized())
     throw std::logic_error("DataStorage not initialized");
@@ -240,6 +242,7 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetRe
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSources(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectSources) const
 {
+  MITK_TRACE_SCOPE_CATEGORY("datastorage", "StandaloneDataStorage::GetSources");
   itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
   return this->GetRelations(node, m_SourceNodes, condition, onlyDirectSources);
 }
@@ -247,6 +250,7 @@ mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetSo
 mitk::DataStorage::SetOfObjects::ConstPointer mitk::StandaloneDataStorage::GetDerivations(
   const mitk::DataNode *node, const NodePredicateBase *condition, bool onlyDirectDerivations) const
 {
+  MITK_TRACE_SCOPE_CATEGORY("datastorage", "StandaloneDataStorage::GetDerivations");
   itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_Mutex);
   return this->GetRelations(node, m_DerivedNodes, condition, onlyDirectDerivations);
 }
@@ -0,0 +1,345 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkTrace.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool> mitk::Trace::s_Enabled(false);
+
+namespace
+{
+  /** \brief Block of spans of a single thread.
+   *
+   * Only the recording thread writes to a chunk. It publishes a span by incrementing Count,
+   * published spans are never changed again, so they can be collected without stopping the thread.
+   */
+  struct Chunk
+  {
+    explicit Chunk(std::size_t size)
+      : Events(size),
+        Count(0)
+    {
+    }
+
+    std::vector<mitk::Trace::Event> Events;
+    std::atomic<std::size_t> Count;
+  };
+
+  /** \brief Spans of a single thread. The mutex is only taken when a chunk is full and while the spans are collected. */
+  struct ThreadBuffer
+  {
+    explicit ThreadBuffer(unsigned int threadId)
+      : ThreadId(threadId),
+        Generation(0)
+    {
+    }
+
+    std::mutex Mutex;
+    std::deque<std::shared_ptr<Chunk>> Chunks;
+    unsigned int ThreadId;
+    std::size_t Generation;
+  };
+
+  /** \brief State of the recording thread, its current chunk is also the last chunk of its buffer. */
+  struct ThreadState
+  {
+    std::shared_ptr<ThreadBuffer> Buffer;
+    std::shared_ptr<Chunk> Current;
+    std::size_t Generation = 0;
+  };
+
+  struct Registry
+  {
+    Registry()
+      : Capacity(65536),
+        Epoch(0),
+        Generation(1),
+        NextThreadId(1)
+    {
+    }
+
+    std::mutex Mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> Buffers;
+    std::atomic<std::size_t> Capacity;
+    std::atomic<std::int64_t> Epoch;
+    /** \brief Incremented by Clear(), chunks of older generations are discarded. */
+    std::atomic<std::size_t> Generation;
+    unsigned int NextThreadId;
+  };
+
+  /** \brief Upper limit for the spans per chunk, i.e. the mutex of a thread is taken once per this many spans. */
+  const std::size_t MaximumChunkSize = 256;
+
+  Registry &GetRegistry()
+  {
+    static Registry registry;
+    return registry;
+  }
+
+  ThreadState &GetThreadState()
+  {
+    // the registry shares ownership, so the spans of finished threads survive until they are collected
+    thread_local ThreadState state;
+
+    if (nullptr == state.Buffer)
+    {
+      auto &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.Mutex);
+
+      state.Buffer = std::make_shared<ThreadBuffer>(registry.NextThreadId++);
+      registry.Buffers.push_back(state.Buffer);
+    }
+
+    return state;
+  }
+
+  /** \brief Starts a new chunk of the calling thread and drops the chunks that only hold overwritten spans. */
+  void StartChunk(ThreadState &state, std::size_t generation, std::size_t capacity)
+  {
+    auto &buffer = *state.Buffer;
+    std::lock_guard<std::mutex> lock(buffer.Mutex);
+
+    if (buffer.Generation != generation)
+    {
+      buffer.Chunks.clear();
+      buffer.Generation = generation;
+    }
+
+    // all chunks of the buffer are full, the oldest one is not needed if the newer ones hold the capacity
+    std::size_t numberOfEvents = 0;
+    for (auto &chunk : buffer.Chunks)
+      numberOfEvents += chunk->Events.size();
+
+    while (!buffer.Chunks.empty() && numberOfEvents - buffer.Chunks.front()->Events.size() >= capacity)
+    {
+      numberOfEvents -= buffer.Chunks.front()->Events.size();
+      buffer.Chunks.pop_front();
+    }
+
+    state.Current = std::make_shared<Chunk>(std::min(capacity, MaximumChunkSize));
+    state.Generation = generation;
+    buffer.Chunks.push_back(state.Current);
+  }
+
+  std::int64_t GetSteadyClockTime()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void WriteJsonString(std::ostream &stream, const char *string)
+  {
+    stream << '"';
+
+    for (auto c = string; nullptr != c && '\0' != *c; ++c)
+    {
+      switch (*c)
+      {
+        case '"':
+          stream << "\\\"";
+          break;
+        case '\\':
+          stream << "\\\\";
+          break;
+        case '\n':
+          stream << "\\n";
+          break;
+        case '\r':
+          stream << "\\r";
+          break;
+        case '\t':
+          stream << "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(*c) < 0x20)
+          {
+            stream << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                   << static_cast<int>(*c) << std::dec << std::setfill(' ');
+          }
+          else
+          {
+            stream << *c;
+          }
+      }
+    }
+
+    stream << '"';
+  }
+}
+
+void mitk::Trace::Start(std::size_t eventsPerThread)
+{
+  auto &registry = GetRegistry();
+
+  s_Enabled = false;
+  registry.Capacity = eventsPerThread;
+  Clear();
+
+  registry.Epoch = GetSteadyClockTime();
+  s_Enabled = 0 != eventsPerThread;
+}
+
+void mitk::Trace::Stop()
+{
+  s_Enabled = false;
+}
+
+void mitk::Trace::Clear()
+{
+  auto &registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+
+  // the current chunk of a recording thread is kept alive by the thread until it notices the new generation
+  const std::size_t generation = ++registry.Generation;
+
+  for (auto &buffer : registry.Buffers)
+  {
+    std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+    buffer->Chunks.clear();
+    buffer->Generation = generation;
+  }
+}
+
+std::vector<mitk::Trace::Event> mitk::Trace::GetEvents()
+{
+  std::vector<Event> events;
+
+  {
+    auto &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+
+    const std::size_t capacity = registry.Capacity.load();
+    const std::size_t generation = registry.Generation.load();
+
+    for (auto &buffer : registry.Buffers)
+    {
+      std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+
+      if (buffer->Generation != generation)
+        continue;
+
+      const std::size_t firstEventOfBuffer = events.size();
+
+      for (auto &chunk : buffer->Chunks)
+      {
+        const std::size_t count = chunk->Count.load(std::memory_order_acquire);
+        events.insert(events.end(), chunk->Events.begin(), chunk->Events.begin() + count);
+      }
+
+      // keep the newest spans of the thread
+      if (events.size() - firstEventOfBuffer > capacity)
+        events.erase(events.begin() + firstEventOfBuffer, events.end() - capacity);
+    }
+  }
+
+  std::stable_sort(events.begin(), events.end(), [](const Event &a, const Event &b) {
+    return a.StartTime < b.StartTime;
+  });
+
+  return events;
+}
+
+void mitk::Trace::WriteChromeTrace(std::ostream &stream)
+{
+  const auto events = GetEvents();
+
+  stream << "{\"traceEvents\":[";
+  stream << std::fixed << std::setprecision(3);
+
+  bool first = true;
+  for (const auto &event : events)
+  {
+    stream << (first ? "\n" : ",\n");
+    first = false;
+
+    stream << "{\"name\":";
+    WriteJsonString(stream, event.Name);
+    stream << ",\"cat\":";
+    WriteJsonString(stream, event.Category);
+    stream << ",\"ph\":\"X\",\"ts\":" << event.StartTime / 1000.0 << ",\"dur\":" << event.Duration / 1000.0
+           << ",\"pid\":1,\"tid\":" << event.ThreadId;
+
+    if (!event.Argument.empty())
+    {
+      stream << ",\"args\":{\"argument\":";
+      WriteJsonString(stream, event.Argument.c_str());
+      stream << '}';
+    }
+
+    stream << '}';
+  }
+
+  stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void mitk::Trace::WriteChromeTrace(const std::string &fileName)
+{
+  std::ofstream stream(fileName.c_str());
+
+  if (!stream.is_open())
+    mitkThrow() << "Cannot open \"" << fileName << "\" for writing the trace.";
+
+  WriteChromeTrace(stream);
+
+  if (!stream.good())
+    mitkThrow() << "Error while writing the trace to \"" << fileName << "\".";
+}
+
+std::int64_t mitk::Trace::Now()
+{
+  return GetSteadyClockTime() - GetRegistry().Epoch.load(std::memory_order_relaxed);
+}
+
+void mitk::Trace::Record(const char *name,
+                         const char *category,
+                         std::int64_t startTime,
+                         std::int64_t endTime,
+                         const std::string &argument)
+{
+  auto &registry = GetRegistry();
+  const std::size_t capacity = registry.Capacity.load(std::memory_order_relaxed);
+
+  if (0 == capacity)
+    return;
+
+  // no lock unless the chunk is full or the trace has been cleared
+  auto &state = GetThreadState();
+  const std::size_t generation = registry.Generation.load(std::memory_order_relaxed);
+
+  if (nullptr == state.Current || state.Generation != generation ||
+      state.Current->Count.load(std::memory_order_relaxed) == state.Current->Events.size())
+  {
+    StartChunk(state, generation, capacity);
+  }
+
+  auto &chunk = *state.Current;
+  const std::size_t index = chunk.Count.load(std::memory_order_relaxed);
+  Event &event = chunk.Events[index];
+
+  event.Name = name;
+  event.Category = category;
+  event.Argument = argument;
+  event.StartTime = startTime;
+  event.Duration = endTime - startTime;
+  event.ThreadId = state.Buffer->ThreadId;
+
+  chunk.Count.store(index + 1, std::memory_order_release);
+}
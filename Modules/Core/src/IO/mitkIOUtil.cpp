@@ -20,6 +20,7 @@ found in the LICENSE file.
 #include <mitkIMimeTypeProvider.h>
 #include <mitkProgressBar.h>
 #include <mitkStandaloneDataStorage.h>
+#include <mitkTrace.h>
 #include <usGetModuleContext.h>
 #include <usLDAPProp.h>
 #include <usModuleContext.h>
@@ -590,6 +591,8 @@ namespace mitk
       if(std::find(read_files.begin(), read_files.end(), loadInfo.m_Path) != read_files.end())
         continue;
 
+      MITK_TRACE_SCOPE_ARGUMENT("io", "IOUtil::Load", loadInfo.m_Path);
+
       std::vector<FileReaderSelector::Item> readers = loadInfo.m_ReaderSelector.Get();
 
       if (readers.empty())
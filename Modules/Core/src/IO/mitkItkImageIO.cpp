@@ -37,7 +37,9 @@ namespace mitk
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS = "org_mitk_timegeometry_timepoints";
 
   ItkImageIO::ItkImageIO(const ItkImageIO &other)
-    : AbstractFileIO(other), m_ImageIO(dynamic_cast<itk::ImageIOBase *>(other.m_ImageIO->Clone().GetPointer()))
+    : AbstractFileIO(other),
+      m_ImageIO(dynamic_cast<itk::ImageIOBase *>(other.m_ImageIO->Clone().GetPointer())),
+      m_UseCompression(other.m_UseCompression)
   {
     this->InitializeDefaultMetaDataKeys();
   }
@@ -111,7 +113,7 @@ namespace mitk
   }
 
   ItkImageIO::ItkImageIO(itk::ImageIOBase::Pointer imageIO)
-    : AbstractFileIO(Image::GetStaticNameOfClass()), m_ImageIO(imageIO)
+    : AbstractFileIO(Image::GetStaticNameOfClass()), m_ImageIO(imageIO), m_UseCompression(true)
   {
     if (m_ImageIO.IsNull())
     {
@@ -196,7 +198,8 @@ namespace mitk
 
   ItkImageIO::ItkImageIO(const CustomMimeType &mimeType, itk::ImageIOBase::Pointer imageIO, int rank)
     : AbstractFileIO(Image::GetStaticNameOfClass(), mimeType, std::string("ITK ") + imageIO->GetNameOfClass()),
-      m_ImageIO(imageIO)
+      m_ImageIO(imageIO),
+      m_UseCompression(true)
   {
     if (m_ImageIO.IsNull())
     {
@@ -599,8 +602,8 @@ namespace mitk
         ioRegion.SetIndex(i, image->GetLargestPossibleRegion().GetIndex(i));
       }
 
-      // use compression if available
-      m_ImageIO->UseCompressionOn();
+      // use compression if available and not switched off
+      m_ImageIO->SetUseCompression(m_UseCompression);
 
       m_ImageIO->SetIORegion(ioRegion);
       m_ImageIO->SetFileName(path);
@@ -696,4 +699,14 @@ namespace mitk
     this->m_DefaultMetaDataKeys.push_back(PROPERTY_NAME_TIMEGEOMETRY_TIMEPOINTS);
     this->m_DefaultMetaDataKeys.push_back("ITK.InputFilterName");
   }
+
+  void ItkImageIO::SetUseCompression(bool useCompression)
+  {
+    m_UseCompression = useCompression;
+  }
+
+  bool ItkImageIO::GetUseCompression() const
+  {
+    return m_UseCompression;
+  }
 }
@@ -0,0 +1,173 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkImageSliceCache.h"
+
+#include <mitkPlaneGeometry.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+mitk::ImageSliceCache::Key::Key()
+  : TimeStep(0),
+    DataMTime(0),
+    DataGeometryMTime(0),
+    InterpolationMode(0),
+    ThickSlicesMode(0),
+    ThickSlicesNum(1),
+    ResampleExtentByGeometry(false)
+{
+  PlaneValues.fill(0.0);
+}
+
+void mitk::ImageSliceCache::Key::SetPlaneGeometry(const PlaneGeometry *planeGeometry)
+{
+  PlaneValues.fill(0.0);
+
+  if (nullptr == planeGeometry)
+    return;
+
+  auto transform = planeGeometry->GetIndexToWorldTransform();
+  const auto &matrix = transform->GetMatrix();
+  const auto &offset = transform->GetOffset();
+  const auto &bounds = planeGeometry->GetBounds();
+
+  std::size_t i = 0;
+  for (unsigned int row = 0; row < 3; ++row)
+    for (unsigned int column = 0; column < 3; ++column)
+      PlaneValues[i++] = matrix[row][column];
+
+  for (unsigned int j = 0; j < 3; ++j)
+    PlaneValues[i++] = offset[j];
+
+  for (unsigned int j = 0; j < 6; ++j)
+    PlaneValues[i++] = bounds[j];
+}
+
+bool mitk::ImageSliceCache::Key::operator==(const Key &other) const
+{
+  return PlaneValues == other.PlaneValues && TimeStep == other.TimeStep && DataMTime == other.DataMTime &&
+         DataGeometryMTime == other.DataGeometryMTime && InterpolationMode == other.InterpolationMode &&
+         ThickSlicesMode == other.ThickSlicesMode && ThickSlicesNum == other.ThickSlicesNum &&
+         ResampleExtentByGeometry == other.ResampleExtentByGeometry;
+}
+
+mitk::ImageSliceCache::Entry::Entry()
+{
+  for (auto &bound : ClippedPlaneBounds)
+    bound = 0.0;
+
+  for (auto &spacing : Spacing)
+    spacing = 1.0;
+}
+
+const unsigned int mitk::ImageSliceCache::DefaultCapacity;
+
+mitk::ImageSliceCache::ImageSliceCache(unsigned int capacity)
+  : m_Capacity(capacity),
+    m_MemoryBudget(0)
+{
+}
+
+const mitk::ImageSliceCache::Entry *mitk::ImageSliceCache::Find(const Key &key)
+{
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end(); ++iter)
+  {
+    if (iter->first == key)
+    {
+      // move to the front (most recently used) without invalidating the element
+      m_Entries.splice(m_Entries.begin(), m_Entries, iter);
+      return &m_Entries.front().second;
+    }
+  }
+
+  return nullptr;
+}
+
+bool mitk::ImageSliceCache::Contains(const Key &key) const
+{
+  for (const auto &entry : m_Entries)
+  {
+    if (entry.first == key)
+      return true;
+  }
+
+  return false;
+}
+
+void mitk::ImageSliceCache::Insert(const Key &key, const Entry &entry)
+{
+  if (0 == m_Capacity)
+    return;
+
+  for (auto iter = m_Entries.begin(); iter != m_Entries.end(); ++iter)
+  {
+    if (iter->first == key)
+    {
+      m_Entries.erase(iter);
+      break;
+    }
+  }
+
+  m_Entries.emplace_front(key, entry);
+  this->Shrink();
+}
+
+void mitk::ImageSliceCache::Clear()
+{
+  m_Entries.clear();
+}
+
+void mitk::ImageSliceCache::SetCapacity(unsigned int capacity)
+{
+  m_Capacity = capacity;
+  this->Shrink();
+}
+
+void mitk::ImageSliceCache::SetMemoryBudget(std::size_t bytes)
+{
+  m_MemoryBudget = bytes;
+  this->Shrink();
+}
+
+std::size_t mitk::ImageSliceCache::GetMemorySize() const
+{
+  std::size_t size = 0;
+
+  for (const auto &entry : m_Entries)
+    size += GetMemorySize(entry.second);
+
+  return size;
+}
+
+std::size_t mitk::ImageSliceCache::GetMemorySize(const Entry &entry)
+{
+  // vtkDataObject reports its size in kibibytes
+  return nullptr != entry.Slice ? static_cast<std::size_t>(entry.Slice->GetActualMemorySize()) * 1024 : 0;
+}
+
+void mitk::ImageSliceCache::Shrink()
+{
+  while (m_Entries.size() > m_Capacity)
+    m_Entries.pop_back();
+
+  if (0 == m_MemoryBudget)
+    return;
+
+  auto memorySize = this->GetMemorySize();
+
+  while (m_Entries.size() > 1 && memorySize > m_MemoryBudget)
+  {
+    memorySize -= GetMemorySize(m_Entries.back().second);
+    m_Entries.pop_back();
+  }
+}
@@ -13,6 +13,7 @@ found in the LICENSE file.
 // MITK
 #include <mitkAbstractTransformGeometry.h>
 #include <mitkDataNode.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkImageSliceSelector.h>
 #include <mitkLevelWindowProperty.h>
 #include <mitkLookupTableProperty.h>
@@ -20,7 +21,9 @@ found in the LICENSE file.
 #include <mitkPlaneGeometry.h>
 #include <mitkProperties.h>
 #include <mitkPropertyNameHelper.h>
+#include <mitkRenderingManager.h>
 #include <mitkResliceMethodProperty.h>
+#include <mitkSlicedGeometry3D.h>
 #include <mitkVtkResliceInterpolationProperty.h>
 
 //#include <mitkTransferFunction.h>
@@ -34,6 +37,10 @@ found in the LICENSE file.
 #include "vtkMitkThickSlicesFilter.h"
 #include "vtkNeverTranslucentTexture.h"
 
+// STL
+#include <algorithm>
+#include <vector>
+
 // VTK
 #include <vtkCamera.h>
 #include <vtkCellArray.h>
@@ -55,6 +62,21 @@ found in the LICENSE file.
 #include <itkRGBAPixel.h>
 #include <mitkRenderingModeProperty.h>
 
+namespace
+{
+  // Collects everything the mapper needs to display a resliced slice without the reslicer
+  mitk::ImageSliceCache::Entry CreateSliceCacheEntry(mitk::ExtractSliceFilter *reslicer, vtkImageData *slice)
+  {
+    mitk::ImageSliceCache::Entry entry;
+    entry.Slice = slice;
+    entry.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+    entry.ResliceAxes->DeepCopy(reslicer->GetResliceAxes());
+    reslicer->GetClippedPlaneBounds(entry.ClippedPlaneBounds);
+    std::copy(reslicer->GetOutputSpacing(), reslicer->GetOutputSpacing() + 2, entry.Spacing);
+    return entry;
+  }
+}
+
 mitk::ImageVtkMapper2D::ImageVtkMapper2D()
 {
 }
@@ -189,6 +211,14 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
     localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
   }
 
+  // the rendering manager asks for cheaper rendering while it cannot keep its frame budget
+  localStorage->m_RenderingDegraded =
+    RenderingManager::GetInstance()->IsRenderingDegraded(renderer->GetRenderWindow());
+  if (localStorage->m_RenderingDegraded)
+  {
+    localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
+  }
+
   // set the vtk output property to true, makes sure that no unneeded mitk image convertion
   // is done.
   localStorage->m_Reslicer->SetVtkOutputRequest(true);
@@ -223,74 +253,191 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
   const auto *planeGeometry = dynamic_cast<const PlaneGeometry *>(worldGeometry);
 
-  if (thickSlicesMode > 0)
+  // Slice cache: reuse a previously resliced slice if nothing that influences the reslicing has changed.
+  // Curved (abstract transform) geometries are not described by their plane and are never cached.
+  bool useSliceCache = false;
+  datanode->GetBoolProperty("Image Rendering.Slice Cache", useSliceCache, renderer);
+  useSliceCache = useSliceCache && nullptr == dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
+
+  ImageSliceCache::Key sliceKey;
+  const ImageSliceCache::Entry *cachedSlice = nullptr;
+
+  if (useSliceCache)
+  {
+    int memoryBudget = 256;
+    datanode->GetIntProperty("Image Rendering.Slice Cache.Memory Budget", memoryBudget, renderer);
+    localStorage->m_SliceCache.SetMemoryBudget(static_cast<std::size_t>(std::max(memoryBudget, 0)) * 1024 * 1024);
+
+    // slices that have been prefetched in the meantime
+    for (auto &prefetchedSlice : localStorage->m_Prefetcher.TakeResults())
+      localStorage->m_SliceCache.Insert(prefetchedSlice.first, prefetchedSlice.second);
+
+    sliceKey.SetPlaneGeometry(worldGeometry);
+    sliceKey.TimeStep = this->GetTimestep();
+    sliceKey.DataMTime = std::max(image->GetMTime(), image->GetPipelineMTime());
+    sliceKey.DataGeometryMTime = image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->GetMTime();
+    sliceKey.InterpolationMode = localStorage->m_Reslicer->GetInterpolationMode();
+    sliceKey.ThickSlicesMode = thickSlicesMode;
+    sliceKey.ThickSlicesNum = thickSlicesNum;
+    sliceKey.ResampleExtentByGeometry = inPlaneResampleExtentByGeometry;
+
+    cachedSlice = localStorage->m_SliceCache.Find(sliceKey);
+  }
+  else
   {
-    double dataZSpacing = 1.0;
+    localStorage->StopPrefetching();
+    localStorage->m_SliceCache.Clear();
+  }
 
-    Vector3D normInIndex, normal;
+  // Bounds information for reslicing (only reuqired if reference geometry
+  // is present)
+  // this used for generating a vtkPLaneSource with the right size
+  double sliceBounds[6];
+  for (auto &sliceBound : sliceBounds)
+  {
+    sliceBound = 0.0;
+  }
 
-    const auto *abstractGeometry =
-      dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
-    if (abstractGeometry != nullptr)
-      normal = abstractGeometry->GetPlane()->GetNormal();
-    else
+  if (nullptr != cachedSlice)
+  {
+    localStorage->m_ReslicedImage = cachedSlice->Slice;
+    localStorage->m_ResliceAxes->DeepCopy(cachedSlice->ResliceAxes);
+    std::copy(cachedSlice->ClippedPlaneBounds, cachedSlice->ClippedPlaneBounds + 6, sliceBounds);
+    std::copy(cachedSlice->Spacing, cachedSlice->Spacing + 2, localStorage->m_SliceSpacing);
+  }
+  else
+  {
+    if (thickSlicesMode > 0)
     {
-      if (planeGeometry != nullptr)
+      double dataZSpacing = 1.0;
+
+      Vector3D normInIndex, normal;
+
+      const auto *abstractGeometry =
+        dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
+      if (abstractGeometry != nullptr)
+        normal = abstractGeometry->GetPlane()->GetNormal();
+      else
       {
-        normal = planeGeometry->GetNormal();
+        if (planeGeometry != nullptr)
+        {
+          normal = planeGeometry->GetNormal();
+        }
+        else
+          return; // no fitting geometry set
+      }
+      normal.Normalize();
+
+      image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
+
+      dataZSpacing = 1.0 / normInIndex.GetNorm();
+
+      const int thickSliceMode = thickSlicesMode - 1;
+
+      if (thickSliceMode == vtkMitkThickSlicesFilter::WEIGHTED)
+      {
+        // weighted slabs are not supported by vtkImageReslice; reslice the complete stack and reduce it afterwards
+        localStorage->m_Reslicer->SetSlabNumberOfSlices(1);
+        localStorage->m_Reslicer->SetScalarScale(1.0);
+        localStorage->m_Reslicer->SetOutputDimensionality(3);
+        localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
+        localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
+
+        // Do the reslicing. Modified() is called to make sure that the reslicer is
+        // executed even though the input geometry information did not change; this
+        // is necessary when the input /em data, but not the /em geometry changes.
+        localStorage->m_TSFilter->SetThickSliceMode(thickSliceMode);
+        localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
+
+        // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
+        localStorage->m_Reslicer->Modified();
+        localStorage->m_Reslicer->Update();
+
+        localStorage->m_TSFilter->Modified();
+        localStorage->m_TSFilter->Update();
+        localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
       }
       else
-        return; // no fitting geometry set
-    }
-    normal.Normalize();
+      {
+        // MIP, MinIP and mean are computed by the reslicer while sampling along the slab normal,
+        // so the 2 * n + 1 slices of the slab are never stored.
+        int slabMode = VTK_IMAGE_SLAB_MAX;
+        double scalarScale = 1.0;
+        switch (thickSliceMode)
+        {
+          case vtkMitkThickSlicesFilter::MINIP:
+            slabMode = VTK_IMAGE_SLAB_MIN;
+            break;
+          case vtkMitkThickSlicesFilter::SUM: // vtkMitkThickSlicesFilter normalizes the sum by 2 * n + 1
+            slabMode = VTK_IMAGE_SLAB_MEAN;
+            break;
+          case vtkMitkThickSlicesFilter::MEAN: // vtkMitkThickSlicesFilter divides the sum by 2 * n
+            slabMode = VTK_IMAGE_SLAB_SUM;
+            scalarScale = 1.0 / (2 * thickSlicesNum);
+            break;
+          default:
+            break;
+        }
 
-    image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
+        localStorage->m_Reslicer->SetOutputDimensionality(2);
+        localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
+        localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
+        localStorage->m_Reslicer->SetSlabMode(slabMode);
+        localStorage->m_Reslicer->SetSlabNumberOfSlices(2 * thickSlicesNum + 1);
+        localStorage->m_Reslicer->SetScalarScale(scalarScale);
 
-    dataZSpacing = 1.0 / normInIndex.GetNorm();
+        localStorage->m_Reslicer->Modified();
+        localStorage->m_Reslicer->UpdateLargestPossibleRegion();
+        localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+      }
+    }
+    else
+    {
+      // this is needed when thick mode was enable bevore. These variable have to be reset to default values
+      localStorage->m_Reslicer->SetOutputDimensionality(2);
+      localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
+      localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
+      localStorage->m_Reslicer->SetSlabNumberOfSlices(1);
+      localStorage->m_Reslicer->SetScalarScale(1.0);
+
+      localStorage->m_Reslicer->Modified();
+      // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
+      localStorage->m_Reslicer->UpdateLargestPossibleRegion();
+      localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+    }
 
-    localStorage->m_Reslicer->SetOutputDimensionality(3);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
+    localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
 
-    // Do the reslicing. Modified() is called to make sure that the reslicer is
-    // executed even though the input geometry information did not change; this
-    // is necessary when the input /em data, but not the /em geometry changes.
-    localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
-    localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
+    // get the spacing of the slice
+    std::copy(localStorage->m_Reslicer->GetOutputSpacing(),
+              localStorage->m_Reslicer->GetOutputSpacing() + 2,
+              localStorage->m_SliceSpacing);
+    localStorage->m_ResliceAxes->DeepCopy(localStorage->m_Reslicer->GetResliceAxes());
 
-    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
-    localStorage->m_Reslicer->Modified();
-    localStorage->m_Reslicer->Update();
+    if (useSliceCache)
+    {
+      // the reslicer reuses its output, so the cache needs its own copy of the slice
+      auto slice = vtkSmartPointer<vtkImageData>::New();
+      slice->DeepCopy(localStorage->m_ReslicedImage);
 
-    localStorage->m_TSFilter->Modified();
-    localStorage->m_TSFilter->Update();
-    localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
+      localStorage->m_SliceCache.Insert(sliceKey, CreateSliceCacheEntry(localStorage->m_Reslicer, slice));
+      localStorage->m_ReslicedImage = slice;
+    }
   }
-  else
+
+  localStorage->m_mmPerPixel = localStorage->m_SliceSpacing;
+
+  bool prefetchSlices = false;
+  datanode->GetBoolProperty("Image Rendering.Slice Prefetch", prefetchSlices, renderer);
+
+  if (useSliceCache && prefetchSlices && 0 == thickSlicesMode && image->GetDimension() >= 3)
   {
-    // this is needed when thick mode was enable bevore. These variable have to be reset to default values
-    localStorage->m_Reslicer->SetOutputDimensionality(2);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
-
-    localStorage->m_Reslicer->Modified();
-    // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
-    localStorage->m_Reslicer->UpdateLargestPossibleRegion();
-    localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+    this->PrefetchSlices(renderer, sliceKey);
   }
-
-  // Bounds information for reslicing (only reuqired if reference geometry
-  // is present)
-  // this used for generating a vtkPLaneSource with the right size
-  double sliceBounds[6];
-  for (auto &sliceBound : sliceBounds)
+  else
   {
-    sliceBound = 0.0;
+    localStorage->StopPrefetching();
   }
-  localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
-
-  // get the spacing of the slice
-  localStorage->m_mmPerPixel = localStorage->m_Reslicer->GetOutputSpacing();
 
   // calculate minimum bounding rect of IMAGE in texture
   {
@@ -640,12 +787,14 @@ void mitk::ImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
 
   if (!visible)
   {
+    this->ResetMapper(renderer);
     return;
   }
 
   auto *data = const_cast<mitk::Image *>(this->GetInput());
   if (data == nullptr)
   {
+    this->ResetMapper(renderer);
     return;
   }
 
@@ -657,6 +806,7 @@ void mitk::ImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
   if ((dataTimeGeometry == nullptr) || (dataTimeGeometry->CountTimeSteps() == 0) ||
       (!dataTimeGeometry->IsValidTimeStep(this->GetTimestep())))
   {
+    this->ResetMapper(renderer);
     return;
   }
 
@@ -671,7 +821,9 @@ void mitk::ImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
       (localStorage->m_LastUpdateTime < renderer->GetCurrentWorldPlaneGeometry()->GetMTime()) ||
       (localStorage->m_LastUpdateTime < node->GetPropertyList()->GetMTime()) ||
       (localStorage->m_LastUpdateTime < node->GetPropertyList(renderer)->GetMTime()) ||
-      (localStorage->m_LastUpdateTime < data->GetPropertyList()->GetMTime()))
+      (localStorage->m_LastUpdateTime < data->GetPropertyList()->GetMTime()) ||
+      (localStorage->m_RenderingDegraded !=
+       RenderingManager::GetInstance()->IsRenderingDegraded(renderer->GetRenderWindow())))
   {
     this->GenerateDataForRenderer(renderer);
   }
@@ -698,6 +850,10 @@ void mitk::ImageVtkMapper2D::SetDefaultProperties(mitk::DataNode *node, mitk::Ba
     node->AddProperty("reslice interpolation", mitk::VtkResliceInterpolationProperty::New());
   node->AddProperty("texture interpolation", mitk::BoolProperty::New(false));
   node->AddProperty("in plane resample extent by geometry", mitk::BoolProperty::New(false));
+  node->AddProperty("Image Rendering.Slice Cache", mitk::BoolProperty::New(false));
+  node->AddProperty("Image Rendering.Slice Prefetch", mitk::BoolProperty::New(false));
+  node->AddProperty("Image Rendering.Slice Prefetch.Depth", mitk::IntProperty::New(4));
+  node->AddProperty("Image Rendering.Slice Cache.Memory Budget", mitk::IntProperty::New(256));
   node->AddProperty("bounding box", mitk::BoolProperty::New(false));
 
   mitk::RenderingModeProperty::Pointer renderingModeProperty = mitk::RenderingModeProperty::New();
@@ -1028,8 +1184,7 @@ void mitk::ImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer)
   LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
   // get the transformation matrix of the reslicer in order to render the slice as axial, coronal or saggital
   vtkSmartPointer<vtkTransform> trans = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkMatrix4x4> matrix = localStorage->m_Reslicer->GetResliceAxes();
-  trans->SetMatrix(matrix);
+  trans->SetMatrix(localStorage->m_ResliceAxes);
   // transform the plane/contour (the actual actor) to the corresponding view (axial, coronal or saggital)
   localStorage->m_Actor->SetUserTransform(trans);
   // transform the origin to center based coordinates, because MITK is center based.
@@ -1072,10 +1227,156 @@ bool mitk::ImageVtkMapper2D::RenderingGeometryIntersectsImage(const PlaneGeometr
   return false;
 }
 
+void mitk::ImageVtkMapper2D::PrefetchSlices(mitk::BaseRenderer *renderer, const ImageSliceCache::Key &currentKey)
+{
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+  auto *image = const_cast<mitk::Image *>(this->GetInput());
+
+  const int slice = static_cast<int>(renderer->GetSlice());
+  const int timeStep = static_cast<int>(this->GetTimestep());
+  const int sliceStep = slice - localStorage->m_LastSlice;
+  const int timeStepStep = timeStep - localStorage->m_LastTimeStep;
+
+  localStorage->m_LastSlice = slice;
+  localStorage->m_LastTimeStep = timeStep;
+
+  // no navigation (e.g. level window or color changes): keep the running prediction
+  if (0 == sliceStep && 0 == timeStepStep)
+    return;
+
+  // the longer the user keeps navigating with the same step, the further we look ahead
+  if (sliceStep == localStorage->m_SliceStep && timeStepStep == localStorage->m_TimeStepStep)
+  {
+    ++localStorage->m_PrefetchStreak;
+  }
+  else
+  {
+    localStorage->m_PrefetchStreak = 1;
+  }
+
+  localStorage->m_SliceStep = sliceStep;
+  localStorage->m_TimeStepStep = timeStepStep;
+
+  int maximumDepth = 4;
+  this->GetDataNode()->GetIntProperty("Image Rendering.Slice Prefetch.Depth", maximumDepth, renderer);
+
+  if (maximumDepth < 1)
+  {
+    localStorage->StopPrefetching();
+    return;
+  }
+
+  const int depth = std::min(localStorage->m_PrefetchStreak, maximumDepth);
+
+  // room for the predicted slices in both directions, StopPrefetching() shrinks the cache again
+  localStorage->m_SliceCache.SetCapacity(
+    std::max(ImageSliceCache::DefaultCapacity, static_cast<unsigned int>(2 * maximumDepth + 2)));
+  localStorage->m_Prefetcher.SetMemoryBudget(localStorage->m_SliceCache.GetMemoryBudget());
+
+  const auto *slicedWorldGeometry = dynamic_cast<const SlicedGeometry3D *>(renderer->GetCurrentWorldGeometry());
+  const int numberOfSlices = nullptr != slicedWorldGeometry ? static_cast<int>(slicedWorldGeometry->GetSlices()) : 0;
+  const int numberOfTimeSteps = static_cast<int>(image->GetTimeSteps());
+
+  std::vector<SlicePrefetcher::JobType> jobs;
+
+  for (int i = 1; i <= depth; ++i)
+  {
+    ImageSliceCache::Key key = currentKey;
+    const PlaneGeometry *planeGeometry = renderer->GetCurrentWorldPlaneGeometry();
+
+    if (0 != sliceStep)
+    {
+      const int nextSlice = slice + i * sliceStep;
+
+      if (nextSlice < 0 || nextSlice >= numberOfSlices)
+        break;
+
+      planeGeometry = slicedWorldGeometry->GetPlaneGeometry(nextSlice);
+
+      if (nullptr == planeGeometry)
+        break;
+
+      key.SetPlaneGeometry(planeGeometry);
+    }
+
+    if (0 != timeStepStep)
+    {
+      // cine loops wrap around
+      const int nextTimeStep =
+        ((timeStep + i * timeStepStep) % numberOfTimeSteps + numberOfTimeSteps) % numberOfTimeSteps;
+
+      key.TimeStep = nextTimeStep;
+      key.DataGeometryMTime = image->GetTimeGeometry()->GetGeometryForTimeStep(nextTimeStep)->GetMTime();
+    }
+
+    if (localStorage->m_SliceCache.Contains(key) || !image->IsVolumeSet(key.TimeStep) ||
+        !RenderingGeometryIntersectsImage(planeGeometry, image->GetSlicedGeometry(key.TimeStep)))
+    {
+      continue;
+    }
+
+    auto volume = image->GetVolumeData(key.TimeStep);
+
+    if (volume.IsNull())
+      continue;
+
+    // The worker threads reslice a shallow copy of the volume. Thus they neither share the pipeline
+    // nor the vtkImageData of the input image with the GUI thread. The captured volume keeps the
+    // referenced memory alive, a read accessor of the worker keeps it from being changed meanwhile.
+    auto volumeImage = mitk::Image::New();
+    volumeImage->Initialize(image->GetPixelType(), 3, image->GetDimensions());
+    volumeImage->SetGeometry(image->GetTimeGeometry()->GetGeometryForTimeStep(key.TimeStep)->Clone());
+    volumeImage->SetImportVolume(volume->GetData(), 0, 0, mitk::Image::ReferenceMemory);
+
+    PlaneGeometry::Pointer worldGeometry = planeGeometry->Clone();
+    const auto interpolationMode = static_cast<ExtractSliceFilter::ResliceInterpolation>(key.InterpolationMode);
+    const bool resampleExtentByGeometry = key.ResampleExtentByGeometry;
+
+    Image::ConstPointer inputImage = image;
+
+    auto reslice = [inputImage, volumeImage, volume, worldGeometry, interpolationMode, resampleExtentByGeometry]() {
+      // the accessor is created and destroyed by the worker thread, the lock belongs to this thread
+      ImageReadAccessor accessor(inputImage, volume);
+
+      auto reslicer = ExtractSliceFilter::New();
+      reslicer->SetInput(volumeImage);
+      reslicer->SetWorldGeometry(worldGeometry);
+      reslicer->SetTimeStep(0);
+      reslicer->SetResliceTransformByGeometry(volumeImage->GetGeometry());
+      reslicer->SetInPlaneResampleExtentByGeometry(resampleExtentByGeometry);
+      reslicer->SetInterpolationMode(interpolationMode);
+      reslicer->SetVtkOutputRequest(true);
+      reslicer->SetOutputDimensionality(2);
+      reslicer->UpdateLargestPossibleRegion();
+
+      // the reslicer is not reused, so its output can be cached without copying
+      return CreateSliceCacheEntry(reslicer, reslicer->GetVtkOutput());
+    };
+
+    jobs.emplace_back(key, reslice);
+  }
+
+  localStorage->m_Prefetcher.Request(std::move(jobs));
+}
+
+void mitk::ImageVtkMapper2D::ResetMapper(mitk::BaseRenderer *renderer)
+{
+  m_LSH.GetLocalStorage(renderer)->StopPrefetching();
+}
+
 mitk::ImageVtkMapper2D::LocalStorage::~LocalStorage()
 {
 }
 
+void mitk::ImageVtkMapper2D::LocalStorage::StopPrefetching()
+{
+  m_Prefetcher.Cancel();
+  m_SliceCache.SetCapacity(ImageSliceCache::DefaultCapacity);
+  m_SliceStep = 0;
+  m_TimeStepStep = 0;
+  m_PrefetchStreak = 0;
+}
+
 mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
   : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New())
 {
@@ -1095,6 +1396,16 @@ mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
   m_OutlinePolyData = vtkSmartPointer<vtkPolyData>::New();
   m_ReslicedImage = vtkSmartPointer<vtkImageData>::New();
   m_EmptyPolyData = vtkSmartPointer<vtkPolyData>::New();
+  m_ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+  m_mmPerPixel = m_SliceSpacing;
+  m_LastSlice = 0;
+  m_LastTimeStep = 0;
+  m_SliceStep = 0;
+  m_TimeStepStep = 0;
+  m_PrefetchStreak = 0;
+  m_RenderingDegraded = false;
+  m_SliceSpacing[0] = 1.0;
+  m_SliceSpacing[1] = 1.0;
 
   // the following actions are always the same and thus can be performed
   // in the constructor for each image (i.e. the image-corresponding local storage)
@@ -21,15 +21,17 @@ found in the LICENSE file.
 
 // vtk includes
 #include <vtkActor.h>
+#include <vtkActor2D.h>
 #include <vtkCellArray.h>
 #include <vtkFloatArray.h>
 #include <vtkGlyph3D.h>
 #include <vtkGlyphSource2D.h>
+#include <vtkLabeledDataMapper.h>
 #include <vtkLine.h>
 #include <vtkPointData.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkPropAssembly.h>
-#include <vtkTextActor.h>
+#include <vtkStringArray.h>
 #include <vtkTextProperty.h>
 #include <vtkTransform.h>
 #include <vtkTransformFilter.h>
@@ -85,6 +87,60 @@ mitk::PointSetVtkMapper2D::LocalStorage::~LocalStorage()
 {
 }
 
+mitk::PointSetVtkMapper2D::LocalStorage::TextLabels::TextLabels()
+{
+  Positions = vtkSmartPointer<vtkPoints>::New();
+  Texts = vtkSmartPointer<vtkStringArray>::New();
+  Texts->SetName("labels");
+
+  PolyData = vtkSmartPointer<vtkPolyData>::New();
+  PolyData->SetPoints(Positions);
+  PolyData->GetPointData()->AddArray(Texts);
+
+  // the positions are given in display coordinates, like the ones of the former text actors
+  Mapper = vtkSmartPointer<vtkLabeledDataMapper>::New();
+  Mapper->SetInputData(PolyData);
+  Mapper->SetLabelModeToLabelFieldData();
+  Mapper->SetFieldDataName("labels");
+  Mapper->CoordinateSystemDisplay();
+
+  vtkTextProperty *textProperty = Mapper->GetLabelTextProperty();
+  textProperty->SetFontSize(18);
+  textProperty->BoldOff();
+  textProperty->ItalicOff();
+  textProperty->ShadowOff();
+  textProperty->SetJustificationToLeft();
+  textProperty->SetVerticalJustificationToBottom();
+
+  Actor = vtkSmartPointer<vtkActor2D>::New();
+  Actor->SetMapper(Mapper);
+}
+
+void mitk::PointSetVtkMapper2D::LocalStorage::TextLabels::Reset()
+{
+  Positions->Reset();
+  Texts->Reset();
+}
+
+void mitk::PointSetVtkMapper2D::LocalStorage::TextLabels::Add(double x, double y, const std::string &text)
+{
+  Positions->InsertNextPoint(x, y, 0.0);
+  Texts->InsertNextValue(text);
+}
+
+void mitk::PointSetVtkMapper2D::LocalStorage::TextLabels::Update(double red, double green, double blue)
+{
+  Positions->Modified();
+  Texts->Modified();
+  PolyData->Modified();
+  Mapper->GetLabelTextProperty()->SetColor(red, green, blue);
+}
+
+bool mitk::PointSetVtkMapper2D::LocalStorage::TextLabels::IsEmpty() const
+{
+  return Positions->GetNumberOfPoints() == 0;
+}
+
 // input for this mapper ( = point set)
 const mitk::PointSet *mitk::PointSetVtkMapper2D::GetInput() const
 {
@@ -156,30 +212,6 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 {
   LocalStorage *ls = m_LSH.GetLocalStorage(renderer);
 
-  unsigned i = 0;
-
-  // The vtk text actors need to be removed manually from the propassembly
-  // since the same vtk text actors are not overwriten within this function,
-  // but new actors are added to the propassembly each time this function is executed.
-  // Thus, the actors from the last call must be removed in the beginning.
-  for (i = 0; i < ls->m_VtkTextLabelActors.size(); i++)
-  {
-    if (ls->m_PropAssembly->GetParts()->IsItemPresent(ls->m_VtkTextLabelActors.at(i)))
-      ls->m_PropAssembly->RemovePart(ls->m_VtkTextLabelActors.at(i));
-  }
-
-  for (i = 0; i < ls->m_VtkTextDistanceActors.size(); i++)
-  {
-    if (ls->m_PropAssembly->GetParts()->IsItemPresent(ls->m_VtkTextDistanceActors.at(i)))
-      ls->m_PropAssembly->RemovePart(ls->m_VtkTextDistanceActors.at(i));
-  }
-
-  for (i = 0; i < ls->m_VtkTextAngleActors.size(); i++)
-  {
-    if (ls->m_PropAssembly->GetParts()->IsItemPresent(ls->m_VtkTextAngleActors.at(i)))
-      ls->m_PropAssembly->RemovePart(ls->m_VtkTextAngleActors.at(i));
-  }
-
   // initialize polydata here, otherwise we have update problems when
   // executing this function again
   ls->m_VtkUnselectedPointListPolyData = vtkSmartPointer<vtkPolyData>::New();
@@ -237,9 +269,9 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 
   ls->m_DistancesBetweenPoints->Reset();
 
-  ls->m_VtkTextLabelActors.clear();
-  ls->m_VtkTextDistanceActors.clear();
-  ls->m_VtkTextAngleActors.clear();
+  ls->m_PointLabels.Reset();
+  ls->m_DistanceLabels.Reset();
+  ls->m_AngleLabels.Reset();
 
   ls->m_UnselectedScales->SetNumberOfComponents(3);
   ls->m_SelectedScales->SetNumberOfComponents(3);
@@ -271,183 +303,203 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 
   vtkLinearTransform *dataNodeTransform = input->GetGeometry()->GetVtkTransform();
 
-  int count = 0;
+  // the label property is the same for all points
+  const mitk::StringProperty *labelProperty =
+    dynamic_cast<mitk::StringProperty *>(this->GetDataNode()->GetProperty("label"));
 
-  for (pointsIter = itkPointSet->GetPoints()->Begin(); pointsIter != itkPointSet->GetPoints()->End(); pointsIter++)
-  {
-    lastP = p;              // valid for number of points count > 0
-    preLastPt2d = lastPt2d; // valid only for count > 1
-    lastPt2d = pt2d;        // valid for number of points count > 0
-
-    lastVec = vec; // valid only for counter > 1
-
-    // get current point in point set
-    point = pointsIter->Value();
+  // adds the marker and the label of a point within m_DistanceToPlane of the current plane
+  auto addPointMarker = [&](PointSet::PointIdentifier id, bool selected, float dist) {
+    // is point selected or not?
+    if (selected)
+    {
+      ls->m_SelectedPoints->InsertNextPoint(point[0], point[1], point[2]);
+      // point is scaled according to its distance to the plane
+      ls->m_SelectedScales->InsertNextTuple3(std::max(0.0f, m_Point2DSize - (2 * dist)), 0, 0);
+    }
+    else
+    {
+      ls->m_UnselectedPoints->InsertNextPoint(point[0], point[1], point[2]);
+      // point is scaled according to its distance to the plane
+      ls->m_UnselectedScales->InsertNextTuple3(std::max(0.0f, m_Point2DSize - (2 * dist)), 0, 0);
+    }
 
-    // transform point
+    //---- LABEL -----//
+    // paint label for each point if available
+    if (labelProperty != nullptr)
     {
-      float vtkp[3];
-      itk2vtk(point, vtkp);
-      dataNodeTransform->TransformPoint(vtkp, vtkp);
-      vtk2itk(vtkp, point);
+      std::string l = labelProperty->GetValue();
+      if (input->GetSize() > 1)
+      {
+        std::stringstream ss;
+        ss << id;
+        l.append(ss.str());
+      }
+
+      ls->m_PointLabels.Add(pt2d[0] + text2dDistance, pt2d[1] + text2dDistance, l);
     }
+  };
+
+  // transforms the current point into the world and onto the display
+  auto transformPoint = [&]() {
+    float vtkp[3];
+    itk2vtk(point, vtkp);
+    dataNodeTransform->TransformPoint(vtkp, vtkp);
+    vtk2itk(vtkp, point);
 
     p[0] = point[0];
     p[1] = point[1];
     p[2] = point[2];
 
     renderer->WorldToDisplay(p, pt2d);
+  };
+
+  // Without a contour only the points near the plane are needed, the spatial index of the
+  // point set finds them. It works in the geometry of the time step, so it is only used if
+  // that geometry has the same transform as the one used for rendering.
+  const bool useSpatialIndex =
+    !m_ShowContour && input->GetGeometry(timestep) != nullptr &&
+    mitk::Equal(*input->GetGeometry(timestep)->GetIndexToWorldTransform(),
+                *input->GetGeometry()->GetIndexToWorldTransform(),
+                mitk::eps,
+                false);
+
+  if (useSpatialIndex)
+  {
+    std::vector<PointSet::PointIdentifier> ids;
+    input->SearchPointsNearPlane(geo2D, m_DistanceToPlane, ids, timestep);
 
-    vec = p - lastP; // valid only for counter > 0
+    for (const PointSet::PointIdentifier id : ids)
+    {
+      mitk::PointSet::PointDataType pointData;
+      if (!itkPointSet->GetPoint(id, &point) || !itkPointSet->GetPointData(id, &pointData))
+        continue;
 
-    // compute distance to current plane
-    float dist = geo2D->Distance(point);
+      transformPoint();
 
-    // draw markers on slices a certain distance away from the points
-    // location according to the tolerance threshold (m_DistanceToPlane)
-    if (dist < m_DistanceToPlane)
-    {
-      // is point selected or not?
-      if (pointDataIter->Value().selected)
-      {
-        ls->m_SelectedPoints->InsertNextPoint(point[0], point[1], point[2]);
-        // point is scaled according to its distance to the plane
-        ls->m_SelectedScales->InsertNextTuple3(std::max(0.0f, m_Point2DSize - (2 * dist)), 0, 0);
-      }
-      else
+      // compute distance to current plane
+      float dist = geo2D->Distance(point);
+
+      // the index is searched with the exact distance, the check is kept for rounding differences
+      if (dist < m_DistanceToPlane)
       {
-        ls->m_UnselectedPoints->InsertNextPoint(point[0], point[1], point[2]);
-        // point is scaled according to its distance to the plane
-        ls->m_UnselectedScales->InsertNextTuple3(std::max(0.0f, m_Point2DSize - (2 * dist)), 0, 0);
+        addPointMarker(id, pointData.selected, dist);
       }
+    }
+  }
+  else
+  {
+    int count = 0;
 
-      //---- LABEL -----//
-      // paint label for each point if available
-      if (dynamic_cast<mitk::StringProperty *>(this->GetDataNode()->GetProperty("label")) != nullptr)
-      {
-        const char *pointLabel =
-          dynamic_cast<mitk::StringProperty *>(this->GetDataNode()->GetProperty("label"))->GetValue();
-        std::string l = pointLabel;
-        if (input->GetSize() > 1)
-        {
-          std::stringstream ss;
-          ss << pointsIter->Index();
-          l.append(ss.str());
-        }
+    for (pointsIter = itkPointSet->GetPoints()->Begin(); pointsIter != itkPointSet->GetPoints()->End(); pointsIter++)
+    {
+      lastP = p;              // valid for number of points count > 0
+      preLastPt2d = lastPt2d; // valid only for count > 1
+      lastPt2d = pt2d;        // valid for number of points count > 0
 
-        ls->m_VtkTextActor = vtkSmartPointer<vtkTextActor>::New();
+      lastVec = vec; // valid only for counter > 1
 
-        ls->m_VtkTextActor->SetDisplayPosition(pt2d[0] + text2dDistance, pt2d[1] + text2dDistance);
-        ls->m_VtkTextActor->SetInput(l.c_str());
-        ls->m_VtkTextActor->GetTextProperty()->SetOpacity(100);
+      // get current point in point set
+      point = pointsIter->Value();
 
-        float unselectedColor[4] = {1.0, 1.0, 0.0, 1.0};
+      transformPoint();
 
-        // check if there is a color property
-        GetDataNode()->GetColor(unselectedColor);
+      vec = p - lastP; // valid only for counter > 0
 
-        ls->m_VtkTextActor->GetTextProperty()->SetColor(unselectedColor[0], unselectedColor[1], unselectedColor[2]);
+      // compute distance to current plane
+      float dist = geo2D->Distance(point);
 
-        ls->m_VtkTextLabelActors.push_back(ls->m_VtkTextActor);
+      // draw markers on slices a certain distance away from the points
+      // location according to the tolerance threshold (m_DistanceToPlane)
+      if (dist < m_DistanceToPlane)
+      {
+        addPointMarker(pointsIter->Index(), pointDataIter->Value().selected, dist);
       }
-    }
-
-    // draw contour, distance text and angle text in render window
 
-    // lines between points, which intersect the current plane, are drawn
-    if (m_ShowContour && count > 0)
-    {
-      ScalarType distance = renderer->GetCurrentWorldPlaneGeometry()->SignedDistance(point);
-      ScalarType lastDistance = renderer->GetCurrentWorldPlaneGeometry()->SignedDistance(lastP);
+      // draw contour, distance text and angle text in render window
 
-      pointsOnSameSideOfPlane = (distance * lastDistance) > 0.5;
-
-      // Points must be on different side of plane in order to draw a contour.
-      // If "show distant lines" is enabled this condition is disregarded.
-      if (!pointsOnSameSideOfPlane || m_ShowDistantLines)
+      // lines between points, which intersect the current plane, are drawn
+      if (m_ShowContour && count > 0)
       {
-        vtkSmartPointer<vtkLine> line = vtkSmartPointer<vtkLine>::New();
-
-        ls->m_ContourPoints->InsertNextPoint(lastP[0], lastP[1], lastP[2]);
-        line->GetPointIds()->SetId(0, NumberContourPoints);
-        NumberContourPoints++;
+        ScalarType distance = renderer->GetCurrentWorldPlaneGeometry()->SignedDistance(point);
+        ScalarType lastDistance = renderer->GetCurrentWorldPlaneGeometry()->SignedDistance(lastP);
 
-        ls->m_ContourPoints->InsertNextPoint(point[0], point[1], point[2]);
-        line->GetPointIds()->SetId(1, NumberContourPoints);
-        NumberContourPoints++;
+        pointsOnSameSideOfPlane = (distance * lastDistance) > 0.5;
 
-        ls->m_ContourLines->InsertNextCell(line);
-
-        if (m_ShowDistances) // calculate and print distance between adjacent points
+        // Points must be on different side of plane in order to draw a contour.
+        // If "show distant lines" is enabled this condition is disregarded.
+        if (!pointsOnSameSideOfPlane || m_ShowDistantLines)
         {
-          float distancePoints = point.EuclideanDistanceTo(lastP);
+          vtkSmartPointer<vtkLine> line = vtkSmartPointer<vtkLine>::New();
 
-          std::stringstream buffer;
-          buffer << std::fixed << std::setprecision(m_DistancesDecimalDigits) << distancePoints << " mm";
+          ls->m_ContourPoints->InsertNextPoint(lastP[0], lastP[1], lastP[2]);
+          line->GetPointIds()->SetId(0, NumberContourPoints);
+          NumberContourPoints++;
 
-          // compute desired display position of text
-          Vector2D vec2d = pt2d - lastPt2d;
-          makePerpendicularVector2D(vec2d,
-                                    vec2d); // text is rendered within text2dDistance perpendicular to current line
-          Vector2D pos2d = (lastPt2d.GetVectorFromOrigin() + pt2d.GetVectorFromOrigin()) * 0.5 + vec2d * text2dDistance;
+          ls->m_ContourPoints->InsertNextPoint(point[0], point[1], point[2]);
+          line->GetPointIds()->SetId(1, NumberContourPoints);
+          NumberContourPoints++;
 
-          ls->m_VtkTextActor = vtkSmartPointer<vtkTextActor>::New();
+          ls->m_ContourLines->InsertNextCell(line);
 
-          ls->m_VtkTextActor->SetDisplayPosition(pos2d[0], pos2d[1]);
-          ls->m_VtkTextActor->SetInput(buffer.str().c_str());
-          ls->m_VtkTextActor->GetTextProperty()->SetColor(0.0, 1.0, 0.0);
+          if (m_ShowDistances) // calculate and print distance between adjacent points
+          {
+            float distancePoints = point.EuclideanDistanceTo(lastP);
 
-          ls->m_VtkTextDistanceActors.push_back(ls->m_VtkTextActor);
-        }
+            std::stringstream buffer;
+            buffer << std::fixed << std::setprecision(m_DistancesDecimalDigits) << distancePoints << " mm";
 
-        if (m_ShowAngles && count > 1) // calculate and print angle between connected lines
-        {
-          std::stringstream buffer;
-          buffer << angle(vec.GetVnlVector(), -lastVec.GetVnlVector()) * 180 / vnl_math::pi << "°";
+            // compute desired display position of text
+            Vector2D vec2d = pt2d - lastPt2d;
+            makePerpendicularVector2D(vec2d,
+                                      vec2d); // text is rendered within text2dDistance perpendicular to current line
+            Vector2D pos2d =
+              (lastPt2d.GetVectorFromOrigin() + pt2d.GetVectorFromOrigin()) * 0.5 + vec2d * text2dDistance;
 
-          // compute desired display position of text
-          Vector2D vec2d = pt2d - lastPt2d; // first arm enclosing the angle
-          vec2d.Normalize();
-          Vector2D lastVec2d = lastPt2d - preLastPt2d; // second arm enclosing the angle
-          lastVec2d.Normalize();
-          vec2d = vec2d - lastVec2d; // vector connecting both arms
-          vec2d.Normalize();
+            ls->m_DistanceLabels.Add(pos2d[0], pos2d[1], buffer.str());
+          }
 
-          // middle between two vectors that enclose the angle
-          Vector2D pos2d = lastPt2d.GetVectorFromOrigin() + vec2d * text2dDistance * text2dDistance;
+          if (m_ShowAngles && count > 1) // calculate and print angle between connected lines
+          {
+            std::stringstream buffer;
+            buffer << angle(vec.GetVnlVector(), -lastVec.GetVnlVector()) * 180 / vnl_math::pi << "°";
 
-          ls->m_VtkTextActor = vtkSmartPointer<vtkTextActor>::New();
+            // compute desired display position of text
+            Vector2D vec2d = pt2d - lastPt2d; // first arm enclosing the angle
+            vec2d.Normalize();
+            Vector2D lastVec2d = lastPt2d - preLastPt2d; // second arm enclosing the angle
+            lastVec2d.Normalize();
+            vec2d = vec2d - lastVec2d; // vector connecting both arms
+            vec2d.Normalize();
 
-          ls->m_VtkTextActor->SetDisplayPosition(pos2d[0], pos2d[1]);
-          ls->m_VtkTextActor->SetInput(buffer.str().c_str());
-          ls->m_VtkTextActor->GetTextProperty()->SetColor(0.0, 1.0, 0.0);
+            // middle between two vectors that enclose the angle
+            Vector2D pos2d = lastPt2d.GetVectorFromOrigin() + vec2d * text2dDistance * text2dDistance;
 
-          ls->m_VtkTextAngleActors.push_back(ls->m_VtkTextActor);
+            ls->m_AngleLabels.Add(pos2d[0], pos2d[1], buffer.str());
+          }
         }
       }
-    }
 
-    if (pointDataIter != itkPointSet->GetPointData()->End())
-    {
-      pointDataIter++;
-      count++;
+      if (pointDataIter != itkPointSet->GetPointData()->End())
+      {
+        pointDataIter++;
+        count++;
+      }
     }
   }
 
-  // add each single text actor to the assembly
-  for (i = 0; i < ls->m_VtkTextLabelActors.size(); i++)
-  {
-    ls->m_PropAssembly->AddPart(ls->m_VtkTextLabelActors.at(i));
-  }
-
-  for (i = 0; i < ls->m_VtkTextDistanceActors.size(); i++)
-  {
-    ls->m_PropAssembly->AddPart(ls->m_VtkTextDistanceActors.at(i));
-  }
+  // all texts of a kind are rendered by one labeled data mapper
+  float labelColor[4] = {1.0, 1.0, 0.0, 1.0};
+  GetDataNode()->GetColor(labelColor);
+  ls->m_PointLabels.Update(labelColor[0], labelColor[1], labelColor[2]);
+  ls->m_DistanceLabels.Update(0.0, 1.0, 0.0);
+  ls->m_AngleLabels.Update(0.0, 1.0, 0.0);
 
-  for (i = 0; i < ls->m_VtkTextAngleActors.size(); i++)
+  for (LocalStorage::TextLabels *labels : {&ls->m_PointLabels, &ls->m_DistanceLabels, &ls->m_AngleLabels})
   {
-    ls->m_PropAssembly->AddPart(ls->m_VtkTextAngleActors.at(i));
+    if (labels->IsEmpty())
+      ls->m_PropAssembly->RemovePart(labels->Actor);
+    else
+      ls->m_PropAssembly->AddPart(labels->Actor);
   }
 
   //---- CONTOUR -----//
@@ -0,0 +1,394 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkPolyDataCutIndex.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace
+{
+  // maximum number of cells in a leaf of the hierarchy
+  const vtkIdType MaximumCellsPerLeaf = 16;
+
+  void ResetBounds(double bounds[6])
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      bounds[2 * i] = std::numeric_limits<double>::max();
+      bounds[2 * i + 1] = std::numeric_limits<double>::lowest();
+    }
+  }
+
+  void AddBounds(double bounds[6], const double *other)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      bounds[2 * i] = std::min(bounds[2 * i], other[2 * i]);
+      bounds[2 * i + 1] = std::max(bounds[2 * i + 1], other[2 * i + 1]);
+    }
+  }
+}
+
+mitk::PolyDataCutIndex::PolyDataCutIndex() : m_BuildTime(0), m_NumberOfThreads(0), m_MinimumCellsPerThread(16384), m_Tolerance(0.0)
+{
+  std::fill(m_NumberOfCells, m_NumberOfCells + 4, 0);
+}
+
+mitk::PolyDataCutIndex::~PolyDataCutIndex()
+{
+}
+
+void mitk::PolyDataCutIndex::SetInput(vtkPolyData *polyData)
+{
+  if (m_Input == polyData)
+    return;
+
+  m_Input = polyData;
+  m_BuildTime = 0;
+}
+
+vtkPolyData *mitk::PolyDataCutIndex::GetInput() const
+{
+  return m_Input;
+}
+
+void mitk::PolyDataCutIndex::SetNumberOfThreads(unsigned int numberOfThreads)
+{
+  m_NumberOfThreads = numberOfThreads;
+}
+
+void mitk::PolyDataCutIndex::SetMinimumCellsPerThread(vtkIdType minimumCellsPerThread)
+{
+  m_MinimumCellsPerThread = std::max<vtkIdType>(1, minimumCellsPerThread);
+}
+
+void mitk::PolyDataCutIndex::Update()
+{
+  if (m_Input == nullptr)
+  {
+    m_Nodes.clear();
+    m_BuildTime = 0;
+    return;
+  }
+
+  if (m_BuildTime == 0 || m_BuildTime != m_Input->GetMTime())
+  {
+    this->Build();
+    m_BuildTime = m_Input->GetMTime();
+  }
+}
+
+void mitk::PolyDataCutIndex::Build()
+{
+  m_Points.clear();
+  m_CellOffsets.clear();
+  m_CellPointIds.clear();
+  m_CellOrder.clear();
+  m_Nodes.clear();
+  std::fill(m_NumberOfCells, m_NumberOfCells + 4, 0);
+
+  const vtkIdType numberOfPoints = m_Input->GetPoints() != nullptr ? m_Input->GetNumberOfPoints() : 0;
+  m_Points.resize(3 * numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    m_Input->GetPoints()->GetPoint(pointId, &m_Points[3 * pointId]);
+
+  m_PointMap.assign(numberOfPoints, -1);
+
+  // same order as the cell ids of vtkPolyData
+  vtkCellArray *cellArrays[4] = {m_Input->GetVerts(), m_Input->GetLines(), m_Input->GetPolys(), m_Input->GetStrips()};
+  m_CellOffsets.push_back(0);
+  for (int type = 0; type < 4; ++type)
+  {
+    if (cellArrays[type] == nullptr)
+      continue;
+
+    vtkIdType *cellPointIds(nullptr);
+    vtkIdType cellSize(0);
+    for (cellArrays[type]->InitTraversal(); cellArrays[type]->GetNextCell(cellSize, cellPointIds);)
+    {
+      m_CellPointIds.insert(m_CellPointIds.end(), cellPointIds, cellPointIds + cellSize);
+      m_CellOffsets.push_back(static_cast<vtkIdType>(m_CellPointIds.size()));
+      ++m_NumberOfCells[type];
+    }
+  }
+
+  const vtkIdType numberOfCells = static_cast<vtkIdType>(m_CellOffsets.size()) - 1;
+  std::vector<double> cellBounds(6 * numberOfCells);
+  double bounds[6];
+  ResetBounds(bounds);
+
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    double *cell = &cellBounds[6 * cellId];
+    ResetBounds(cell);
+    for (vtkIdType i = m_CellOffsets[cellId]; i < m_CellOffsets[cellId + 1]; ++i)
+    {
+      const double *point = &m_Points[3 * m_CellPointIds[i]];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        cell[2 * axis] = std::min(cell[2 * axis], point[axis]);
+        cell[2 * axis + 1] = std::max(cell[2 * axis + 1], point[axis]);
+      }
+    }
+
+    // cells without points are never cut
+    if (m_CellOffsets[cellId + 1] > m_CellOffsets[cellId])
+    {
+      m_CellOrder.push_back(cellId);
+      AddBounds(bounds, cell);
+    }
+  }
+
+  if (m_CellOrder.empty())
+    return;
+
+  // points closer to the plane than this count as on the plane, so that a cell touching the plane is
+  // found independently of the rounding of the plane parameters
+  double diagonal = 0.0;
+  for (int axis = 0; axis < 3; ++axis)
+    diagonal += (bounds[2 * axis + 1] - bounds[2 * axis]) * (bounds[2 * axis + 1] - bounds[2 * axis]);
+  m_Tolerance = 1e-9 * std::max(std::sqrt(diagonal), 1.0);
+
+  m_Nodes.reserve(2 * (m_CellOrder.size() / MaximumCellsPerLeaf + 1));
+  this->BuildNode(0, static_cast<vtkIdType>(m_CellOrder.size()), cellBounds);
+}
+
+int mitk::PolyDataCutIndex::BuildNode(vtkIdType first, vtkIdType count, std::vector<double> &cellBounds)
+{
+  const int nodeIndex = static_cast<int>(m_Nodes.size());
+  m_Nodes.emplace_back();
+
+  Node node;
+  node.First = first;
+  node.Count = count;
+  node.Children[0] = -1;
+  node.Children[1] = -1;
+  ResetBounds(node.Bounds);
+
+  double centerBounds[6];
+  ResetBounds(centerBounds);
+  for (vtkIdType i = first; i < first + count; ++i)
+  {
+    const double *cell = &cellBounds[6 * m_CellOrder[i]];
+    AddBounds(node.Bounds, cell);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const double center = 0.5 * (cell[2 * axis] + cell[2 * axis + 1]);
+      centerBounds[2 * axis] = std::min(centerBounds[2 * axis], center);
+      centerBounds[2 * axis + 1] = std::max(centerBounds[2 * axis + 1], center);
+    }
+  }
+
+  // split at the median of the cell centers along the axis with the largest extent
+  int splitAxis = 0;
+  for (int axis = 1; axis < 3; ++axis)
+  {
+    if (centerBounds[2 * axis + 1] - centerBounds[2 * axis] >
+        centerBounds[2 * splitAxis + 1] - centerBounds[2 * splitAxis])
+      splitAxis = axis;
+  }
+
+  if (count > MaximumCellsPerLeaf && centerBounds[2 * splitAxis + 1] > centerBounds[2 * splitAxis])
+  {
+    const vtkIdType half = count / 2;
+    std::nth_element(m_CellOrder.begin() + first,
+                     m_CellOrder.begin() + first + half,
+                     m_CellOrder.begin() + first + count,
+                     [&cellBounds, splitAxis](vtkIdType a, vtkIdType b) {
+                       return cellBounds[6 * a + 2 * splitAxis] + cellBounds[6 * a + 2 * splitAxis + 1] <
+                              cellBounds[6 * b + 2 * splitAxis] + cellBounds[6 * b + 2 * splitAxis + 1];
+                     });
+
+    node.Children[0] = this->BuildNode(first, half, cellBounds);
+    node.Children[1] = this->BuildNode(first + half, count - half, cellBounds);
+  }
+
+  m_Nodes[nodeIndex] = node;
+  return nodeIndex;
+}
+
+bool mitk::PolyDataCutIndex::IsCellCut(vtkIdType cellId, const double normal[3], double offset, double tolerance) const
+{
+  bool below(false);
+  bool above(false);
+  for (vtkIdType i = m_CellOffsets[cellId]; i < m_CellOffsets[cellId + 1]; ++i)
+  {
+    const double *point = &m_Points[3 * m_CellPointIds[i]];
+    const double distance = normal[0] * point[0] + normal[1] * point[1] + normal[2] * point[2] - offset;
+
+    below = below || distance <= tolerance;
+    above = above || distance >= -tolerance;
+    if (below && above)
+      return true;
+  }
+  return false;
+}
+
+void mitk::PolyDataCutIndex::FindCutCells(const double origin[3], const double normal[3], std::vector<vtkIdType> &cellIds)
+{
+  cellIds.clear();
+  this->Update();
+
+  const double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+  if (m_Nodes.empty() || length == 0.0)
+    return;
+
+  const double unitNormal[3] = {normal[0] / length, normal[1] / length, normal[2] / length};
+  const double offset = unitNormal[0] * origin[0] + unitNormal[1] * origin[1] + unitNormal[2] * origin[2];
+
+  // collect the leaves whose bounding box is cut by the plane
+  std::vector<int> leaves;
+  vtkIdType numberOfCandidates(0);
+  std::vector<int> stack(1, 0);
+  while (!stack.empty())
+  {
+    const Node &node = m_Nodes[stack.back()];
+    stack.pop_back();
+
+    double centerDistance = -offset;
+    double radius = 0.0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      centerDistance += unitNormal[axis] * 0.5 * (node.Bounds[2 * axis] + node.Bounds[2 * axis + 1]);
+      radius += std::abs(unitNormal[axis]) * 0.5 * (node.Bounds[2 * axis + 1] - node.Bounds[2 * axis]);
+    }
+
+    if (std::abs(centerDistance) > radius + m_Tolerance)
+      continue;
+
+    if (node.Children[0] < 0)
+    {
+      leaves.push_back(static_cast<int>(&node - m_Nodes.data()));
+      numberOfCandidates += node.Count;
+    }
+    else
+    {
+      stack.push_back(node.Children[0]);
+      stack.push_back(node.Children[1]);
+    }
+  }
+
+  unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
+  numberOfThreads = static_cast<unsigned int>(
+    std::max<vtkIdType>(1, std::min<vtkIdType>(std::max(numberOfThreads, 1u), numberOfCandidates / m_MinimumCellsPerThread)));
+
+  std::vector<std::vector<vtkIdType>> threadCellIds(numberOfThreads);
+  std::atomic<std::size_t> nextLeaf(0);
+
+  auto testCells = [&](unsigned int threadId) {
+    std::vector<vtkIdType> &result = threadCellIds[threadId];
+    for (std::size_t leaf = nextLeaf++; leaf < leaves.size(); leaf = nextLeaf++)
+    {
+      const Node &node = m_Nodes[leaves[leaf]];
+      for (vtkIdType i = node.First; i < node.First + node.Count; ++i)
+      {
+        if (this->IsCellCut(m_CellOrder[i], unitNormal, offset, m_Tolerance))
+          result.push_back(m_CellOrder[i]);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int threadId = 1; threadId < numberOfThreads; ++threadId)
+    threads.emplace_back(testCells, threadId);
+
+  testCells(0);
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (const auto &result : threadCellIds)
+    cellIds.insert(cellIds.end(), result.begin(), result.end());
+
+  std::sort(cellIds.begin(), cellIds.end());
+}
+
+void mitk::PolyDataCutIndex::ExtractCutCells(const double origin[3], const double normal[3], vtkPolyData *output)
+{
+  if (output == nullptr)
+    return;
+
+  std::vector<vtkIdType> cellIds;
+  this->FindCutCells(origin, normal, cellIds);
+
+  output->Initialize();
+  if (m_Input == nullptr)
+    return;
+
+  vtkPointData *inputPointData = m_Input->GetPointData();
+  vtkCellData *inputCellData = m_Input->GetCellData();
+  vtkPointData *outputPointData = output->GetPointData();
+  vtkCellData *outputCellData = output->GetCellData();
+
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  if (m_Input->GetPoints() != nullptr)
+    points->SetDataType(m_Input->GetPoints()->GetDataType());
+
+  outputPointData->CopyAllocate(inputPointData, static_cast<vtkIdType>(3 * cellIds.size()));
+  outputCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(cellIds.size()));
+
+  vtkSmartPointer<vtkCellArray> cellArrays[4];
+  for (auto &cellArray : cellArrays)
+    cellArray = vtkSmartPointer<vtkCellArray>::New();
+
+  std::vector<vtkIdType> usedPoints;
+  std::vector<vtkIdType> cellPointIds;
+  vtkIdType outputCellId(0);
+
+  for (const vtkIdType cellId : cellIds)
+  {
+    int type = 0;
+    vtkIdType typeEnd = m_NumberOfCells[0];
+    while (cellId >= typeEnd && type < 3)
+      typeEnd += m_NumberOfCells[++type];
+
+    cellPointIds.clear();
+    for (vtkIdType i = m_CellOffsets[cellId]; i < m_CellOffsets[cellId + 1]; ++i)
+    {
+      const vtkIdType pointId = m_CellPointIds[i];
+      if (m_PointMap[pointId] < 0)
+      {
+        m_PointMap[pointId] = points->InsertNextPoint(&m_Points[3 * pointId]);
+        outputPointData->CopyData(inputPointData, pointId, m_PointMap[pointId]);
+        usedPoints.push_back(pointId);
+      }
+      cellPointIds.push_back(m_PointMap[pointId]);
+    }
+
+    cellArrays[type]->InsertNextCell(static_cast<vtkIdType>(cellPointIds.size()), cellPointIds.data());
+    outputCellData->CopyData(inputCellData, cellId, outputCellId++);
+  }
+
+  for (const vtkIdType pointId : usedPoints)
+    m_PointMap[pointId] = -1;
+
+  output->SetPoints(points);
+  if (m_NumberOfCells[0] > 0)
+    output->SetVerts(cellArrays[0]);
+  if (m_NumberOfCells[1] > 0)
+    output->SetLines(cellArrays[1]);
+  if (m_NumberOfCells[2] > 0)
+    output->SetPolys(cellArrays[2]);
+  if (m_NumberOfCells[3] > 0)
+    output->SetStrips(cellArrays[3]);
+  output->Squeeze();
+}
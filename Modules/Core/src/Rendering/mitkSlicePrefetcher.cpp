@@ -0,0 +1,305 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkSlicePrefetcher.h"
+
+#include <mitkLogMacros.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  /** \brief Worker threads shared by all SlicePrefetcher instances.
+   *
+   * The pool is created by the first request and destroyed only by Shutdown(), never by a static
+   * destructor: joining threads while a library is unloaded can deadlock (e.g. under the Windows loader lock).
+   */
+  class PrefetchThreadPool
+  {
+  public:
+    static void Post(std::function<void()> task)
+    {
+      std::lock_guard<std::mutex> instanceLock(s_InstanceMutex);
+      PrefetchThreadPool &pool = GetInstance_unlocked();
+
+      {
+        std::lock_guard<std::mutex> lock(pool.m_Mutex);
+        pool.m_Tasks.push_back(std::move(task));
+      }
+      pool.m_Condition.notify_one();
+    }
+
+    static unsigned int GetNumberOfThreads()
+    {
+      std::lock_guard<std::mutex> instanceLock(s_InstanceMutex);
+      return static_cast<unsigned int>(GetInstance_unlocked().m_Threads.size());
+    }
+
+    static void Shutdown()
+    {
+      PrefetchThreadPool *pool = nullptr;
+
+      {
+        std::lock_guard<std::mutex> instanceLock(s_InstanceMutex);
+        std::swap(pool, s_Instance);
+      }
+
+      delete pool;
+    }
+
+  private:
+    static PrefetchThreadPool &GetInstance_unlocked()
+    {
+      if (s_Instance == nullptr)
+        s_Instance = new PrefetchThreadPool;
+
+      return *s_Instance;
+    }
+
+    PrefetchThreadPool()
+      : m_Stop(false)
+    {
+      // leave the remaining cores to the GUI thread and the threaded VTK/ITK filters
+      const unsigned int numberOfThreads = std::max(1u, std::thread::hardware_concurrency() / 4);
+
+      for (unsigned int i = 0; i < numberOfThreads; ++i)
+        m_Threads.emplace_back(&PrefetchThreadPool::Run, this);
+    }
+
+    ~PrefetchThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+        m_Tasks.clear();
+      }
+      m_Condition.notify_all();
+
+      for (auto &thread : m_Threads)
+        thread.join();
+    }
+
+    void Run()
+    {
+      while (true)
+      {
+        std::function<void()> task;
+
+        {
+          std::unique_lock<std::mutex> lock(m_Mutex);
+          m_Condition.wait(lock, [this] { return m_Stop || !m_Tasks.empty(); });
+
+          if (m_Stop)
+            return;
+
+          task = std::move(m_Tasks.front());
+          m_Tasks.pop_front();
+        }
+
+        task();
+      }
+    }
+
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    std::deque<std::function<void()>> m_Tasks;
+    std::vector<std::thread> m_Threads;
+    bool m_Stop;
+
+    static std::mutex s_InstanceMutex;
+    static PrefetchThreadPool *s_Instance;
+  };
+
+  std::mutex PrefetchThreadPool::s_InstanceMutex;
+  PrefetchThreadPool *PrefetchThreadPool::s_Instance = nullptr;
+}
+
+struct mitk::SlicePrefetcher::State
+{
+  State()
+    : ResultMemory(0),
+      MemoryBudget(0),
+      Generation(0)
+  {
+  }
+
+  bool IsScheduled_unlocked(const ImageSliceCache::Key &key) const
+  {
+    for (const auto &job : Pending)
+    {
+      if (job.first == key)
+        return true;
+    }
+
+    if (std::find(Running.begin(), Running.end(), key) != Running.end())
+      return true;
+
+    for (const auto &result : Results)
+    {
+      if (result.first == key)
+        return true;
+    }
+
+    return false;
+  }
+
+  void RunNext()
+  {
+    JobType job;
+    unsigned long generation = 0;
+
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+
+      if (Pending.empty())
+        return;
+
+      if (0 != MemoryBudget && ResultMemory >= MemoryBudget)
+      {
+        // results are not collected fast enough, do not waste memory on further predictions
+        Pending.clear();
+        return;
+      }
+
+      job = std::move(Pending.front());
+      Pending.pop_front();
+      Running.push_back(job.first);
+      generation = Generation;
+    }
+
+    ImageSliceCache::Entry entry;
+    bool success = false;
+
+    try
+    {
+      entry = job.second();
+      success = nullptr != entry.Slice;
+    }
+    catch (const std::exception &e)
+    {
+      MITK_DEBUG << "Prefetching of a slice failed: " << e.what();
+    }
+    catch (...)
+    {
+      MITK_DEBUG << "Prefetching of a slice failed.";
+    }
+
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    auto running = std::find(Running.begin(), Running.end(), job.first);
+    if (running != Running.end())
+      Running.erase(running);
+
+    if (success && generation == Generation)
+    {
+      ResultMemory += ImageSliceCache::GetMemorySize(entry);
+      Results.emplace_back(job.first, std::move(entry));
+    }
+  }
+
+  mutable std::mutex Mutex;
+  std::deque<JobType> Pending;
+  std::vector<ImageSliceCache::Key> Running;
+  std::vector<ResultType> Results;
+  std::size_t ResultMemory;
+  std::size_t MemoryBudget;
+  unsigned long Generation;
+};
+
+mitk::SlicePrefetcher::SlicePrefetcher()
+  : m_State(std::make_shared<State>())
+{
+}
+
+mitk::SlicePrefetcher::~SlicePrefetcher()
+{
+  // running jobs keep the state alive and finish in the background, their results are discarded
+  this->Cancel();
+}
+
+void mitk::SlicePrefetcher::Request(std::vector<JobType> jobs)
+{
+  std::size_t numberOfJobs = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(m_State->Mutex);
+
+    m_State->Pending.clear();
+
+    for (auto &job : jobs)
+    {
+      if (!m_State->IsScheduled_unlocked(job.first))
+        m_State->Pending.push_back(std::move(job));
+    }
+
+    numberOfJobs = m_State->Pending.size();
+  }
+
+  std::shared_ptr<State> state = m_State;
+
+  for (std::size_t i = 0; i < numberOfJobs; ++i)
+    PrefetchThreadPool::Post([state]() { state->RunNext(); });
+}
+
+void mitk::SlicePrefetcher::Cancel()
+{
+  std::lock_guard<std::mutex> lock(m_State->Mutex);
+
+  m_State->Pending.clear();
+  m_State->Results.clear();
+  m_State->ResultMemory = 0;
+  ++m_State->Generation;
+}
+
+bool mitk::SlicePrefetcher::IsScheduled(const ImageSliceCache::Key &key) const
+{
+  std::lock_guard<std::mutex> lock(m_State->Mutex);
+  return m_State->IsScheduled_unlocked(key);
+}
+
+std::vector<mitk::SlicePrefetcher::ResultType> mitk::SlicePrefetcher::TakeResults()
+{
+  std::vector<ResultType> results;
+
+  std::lock_guard<std::mutex> lock(m_State->Mutex);
+  results.swap(m_State->Results);
+  m_State->ResultMemory = 0;
+
+  return results;
+}
+
+void mitk::SlicePrefetcher::SetMemoryBudget(std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(m_State->Mutex);
+  m_State->MemoryBudget = bytes;
+}
+
+std::size_t mitk::SlicePrefetcher::GetMemoryBudget() const
+{
+  std::lock_guard<std::mutex> lock(m_State->Mutex);
+  return m_State->MemoryBudget;
+}
+
+unsigned int mitk::SlicePrefetcher::GetNumberOfWorkerThreads()
+{
+  return PrefetchThreadPool::GetNumberOfThreads();
+}
+
+void mitk::SlicePrefetcher::ShutdownWorkerThreads()
+{
+  PrefetchThreadPool::Shutdown();
+}
@@ -24,13 +24,17 @@ found in the LICENSE file.
 #include <mitkTransferFunctionProperty.h>
 #include <mitkVtkScalarModeProperty.h>
 
+#include <algorithm>
+
 // VTK includes
 #include <vtkActor.h>
 #include <vtkArrowSource.h>
 #include <vtkAssembly.h>
 #include <vtkCutter.h>
 #include <vtkGlyph3D.h>
+#include <vtkLinearTransform.h>
 #include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
 #include <vtkPlane.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
@@ -48,6 +52,10 @@ mitk::SurfaceVtkMapper2D::LocalStorage::LocalStorage()
   m_CuttingPlane = vtkSmartPointer<vtkPlane>::New();
   m_Cutter = vtkSmartPointer<vtkCutter>::New();
   m_Cutter->SetCutFunction(m_CuttingPlane);
+  m_CutCells = vtkSmartPointer<vtkPolyData>::New();
+  m_CutParameters.fill(0.0);
+  m_CutInput = nullptr;
+  m_CutInputMTime = 0;
   m_Mapper->SetInputConnection(m_Cutter->GetOutputPort());
 
   m_NormalGlyph = vtkSmartPointer<vtkGlyph3D>::New();
@@ -208,16 +216,50 @@ void mitk::SurfaceVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rende
   normal[1] = planeGeometry->GetNormal()[1];
   normal[2] = planeGeometry->GetNormal()[2];
 
-  localStorage->m_CuttingPlane->SetOrigin(origin);
-  localStorage->m_CuttingPlane->SetNormal(normal);
   // Transform the data according to its geometry.
   // See UpdateVtkTransform documentation for details.
   vtkSmartPointer<vtkLinearTransform> vtktransform = GetDataNode()->GetVtkTransform(this->GetTimestep());
-  vtkSmartPointer<vtkTransformPolyDataFilter> filter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  filter->SetTransform(vtktransform);
-  filter->SetInputData(inputPolyData);
-  localStorage->m_Cutter->SetInputConnection(filter->GetOutputPort());
-  localStorage->m_Cutter->Update();
+  vtkMatrix4x4 *matrix = vtktransform->GetMatrix();
+
+  // the cut only has to be recomputed if the plane, the transform or the surface changed
+  std::array<double, 22> cutParameters;
+  std::copy(origin, origin + 3, cutParameters.begin());
+  std::copy(normal, normal + 3, cutParameters.begin() + 3);
+  for (int i = 0; i < 16; ++i)
+    cutParameters[6 + i] = matrix->GetElement(i / 4, i % 4);
+
+  if (cutParameters != localStorage->m_CutParameters || localStorage->m_CutInput != inputPolyData.GetPointer() ||
+      localStorage->m_CutInputMTime != inputPolyData->GetMTime())
+  {
+    // Cutting the transformed data with the plane is the same as cutting the data with the plane transformed
+    // back into the coordinates of the data. Only the cells cut by the plane are extracted and transformed.
+    double dataOrigin[3];
+    vtktransform->GetLinearInverse()->TransformPoint(origin, dataOrigin);
+
+    double dataNormal[3];
+    for (int i = 0; i < 3; ++i)
+    {
+      dataNormal[i] = matrix->GetElement(0, i) * normal[0] + matrix->GetElement(1, i) * normal[1] +
+                      matrix->GetElement(2, i) * normal[2];
+    }
+
+    PolyDataCutIndex &cutIndex = m_CutIndices[timestep];
+    cutIndex.SetInput(inputPolyData);
+    cutIndex.ExtractCutCells(dataOrigin, dataNormal, localStorage->m_CutCells);
+
+    localStorage->m_CuttingPlane->SetOrigin(origin);
+    localStorage->m_CuttingPlane->SetNormal(normal);
+
+    vtkSmartPointer<vtkTransformPolyDataFilter> filter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    filter->SetTransform(vtktransform);
+    filter->SetInputData(localStorage->m_CutCells);
+    localStorage->m_Cutter->SetInputConnection(filter->GetOutputPort());
+    localStorage->m_Cutter->Update();
+
+    localStorage->m_CutParameters = cutParameters;
+    localStorage->m_CutInput = inputPolyData;
+    localStorage->m_CutInputMTime = inputPolyData->GetMTime();
+  }
 
   bool generateNormals = false;
   node->GetBoolProperty("draw normals 2D", generateNormals);
@@ -28,6 +28,7 @@ found in the LICENSE file.
 #include <mitkProperties.h>
 #include <mitkRenderingManager.h>
 #include <mitkSurface.h>
+#include <mitkTrace.h>
 #include <mitkVtkInteractorStyle.h>
 
 // VTK
@@ -155,6 +156,8 @@ Called by the vtkMitkRenderProp in order to start MITK rendering process.
 */
 int mitk::VtkPropRenderer::Render(mitk::VtkPropRenderer::RenderType type)
 {
+  MITK_TRACE_SCOPE_ARGUMENT("rendering", "VtkPropRenderer::Render", m_Name);
+
   // Do we have objects to render?
   if (this->GetEmptyWorldGeometry())
     return 0;
@@ -294,6 +297,7 @@ void mitk::VtkPropRenderer::Update(mitk::DataNode *datatreenode)
     {
       if (GetCurrentWorldPlaneGeometry()->IsValid())
       {
+        MITK_TRACE_SCOPE_CATEGORY("rendering", mapper->GetNameOfClass());
         mapper->Update(this);
         {
           auto *vtkmapper = dynamic_cast<VtkMapper *>(mapper.GetPointer());
@@ -20,8 +20,10 @@ found in the LICENSE file.
 #include "vtkPointData.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
+#include <algorithm>
 #include <cmath>
 #include <sstream>
+#include <vector>
 
 vtkStandardNewMacro(vtkMitkThickSlicesFilter);
 
@@ -108,6 +110,10 @@ int vtkMitkThickSlicesFilter::RequestUpdateExtent(vtkInformation *,
 // This execute method handles boundaries.
 // it handles boundaries. Pixels are just replicated to get values
 // out of extent.
+//
+// The slab is reduced row by row: for each output row the input rows of all
+// slices are accumulated into a row buffer. The inner loops run over
+// contiguous memory and can be vectorized by the compiler.
 template <class T>
 void vtkMitkThickSlicesFilterExecute(vtkMitkThickSlicesFilter *self,
                                      vtkImageData *inData,
@@ -121,33 +127,18 @@ void vtkMitkThickSlicesFilterExecute(vtkMitkThickSlicesFilter *self,
   int maxX, maxY;
   vtkIdType inIncX, inIncY, inIncZ;
   vtkIdType outIncX, outIncY, outIncZ;
-  // int axesNum;
   int *inExt = inData->GetExtent();
   int *wholeExtent;
   vtkIdType *inIncs;
-  // int useYMin, useYMax, useXMin, useXMax;
 
   // find the region to loop over
   maxX = outExt[1] - outExt[0];
   maxY = outExt[3] - outExt[2];
 
-  //  maxZ = outExt[5] - outExt[4];
-
-  // Get the dimensionality of the gradient.
-  // axesNum = self->GetDimensionality();
-
   // Get increments to march through data
   inData->GetContinuousIncrements(outExt, inIncX, inIncY, inIncZ);
   outData->GetContinuousIncrements(outExt, outIncX, outIncY, outIncZ);
-  /*
-// The data spacing is important for computing the gradient.
-// central differences (2 * ratio).
-// Negative because below we have (min - max) for dx ...
-inData->GetSpacing(r);
-r[0] = -0.5 / r[0];
-r[1] = -0.5 / r[1];
-r[2] = -0.5 / r[2];
-    */
+
   // get some other info we need
   inIncs = inData->GetIncrements();
   wholeExtent = inData->GetExtent();
@@ -155,14 +146,15 @@ r[2] = -0.5 / r[2];
   // Move the pointer to the correct starting position.
   inPtr += (outExt[0] - inExt[0]) * inIncs[0] + (outExt[2] - inExt[2]) * inIncs[1] + (outExt[4] - inExt[4]) * inIncs[2];
 
-  // Loop through ouput pixels
-
-  int _minZ = /*-5 + outExt[4];  if( _minZ  < wholeExtent[4]) _minZ=*/wholeExtent[4];
-  int _maxZ = /* 5 + outExt[4];  if( _maxZ  > wholeExtent[5]) _maxZ=*/wholeExtent[5];
+  int _minZ = wholeExtent[4];
+  int _maxZ = wholeExtent[5];
 
   if (_maxZ < _minZ)
     return;
 
+  const int rowLength = maxX + 1;
+  const vtkIdType zInc = inIncs[2];
+
   double invNum = 1.0 / (_maxZ - _minZ + 1);
 
   switch (self->GetThickSliceMode())
@@ -170,63 +162,43 @@ r[2] = -0.5 / r[2];
     default:
     case vtkMitkThickSlicesFilter::MIP:
     {
-      // MIP
       for (idxY = 0; idxY <= maxY; idxY++)
       {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
+        std::copy(inPtr + _minZ * zInc, inPtr + _minZ * zInc + rowLength, outPtr);
+
+        for (int z = _minZ + 1; z <= _maxZ; z++)
         {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          T mip = inPtr[_minZ * inIncs[2]];
-
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            if (value > mip)
-              mip = value;
-          }
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          const T *slice = inPtr + z * zInc;
+          for (idxX = 0; idxX < rowLength; idxX++)
+            outPtr[idxX] = slice[idxX] > outPtr[idxX] ? slice[idxX] : outPtr[idxX];
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
+
+        outPtr += rowLength + outIncY;
+        inPtr += rowLength + inIncY;
       }
     }
     break;
 
     case vtkMitkThickSlicesFilter::SUM:
     {
-      // MIP
+      std::vector<double> sum(rowLength);
+
       for (idxY = 0; idxY <= maxY; idxY++)
       {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
-        {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
+        std::fill(sum.begin(), sum.end(), 0.0);
 
-          double sum = 0;
+        for (int z = _minZ; z <= _maxZ; z++)
+        {
+          const T *slice = inPtr + z * zInc;
+          for (idxX = 0; idxX < rowLength; idxX++)
+            sum[idxX] += slice[idxX];
+        }
 
-          for (int z = _minZ; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            sum += value;
-          }
+        for (idxX = 0; idxX < rowLength; idxX++)
+          outPtr[idxX] = static_cast<T>(invNum * sum[idxX]);
 
-          // do X axis
-          *outPtr = static_cast<T>(invNum * sum);
-          outPtr++;
-          inPtr++;
-        }
-        outPtr += outIncY;
-        inPtr += inIncY;
+        outPtr += rowLength + outIncY;
+        inPtr += rowLength + inIncY;
       }
     }
     break;
@@ -251,31 +223,26 @@ r[2] = -0.5 / r[2];
         weights[i] /= sum;
       }
 
+      std::vector<double> weightedSum(rowLength);
+
       for (idxY = 0; idxY <= maxY; idxY++)
       {
-        // useYMin = ((idxY + outExt[2]) <= wholeExtent[2]) ? 0 : -inIncs[1];
-        // useYMax = ((idxY + outExt[2]) >= wholeExtent[3]) ? 0 : inIncs[1];
-        for (idxX = 0; idxX <= maxX; idxX++)
+        std::fill(weightedSum.begin(), weightedSum.end(), 0.0);
+
+        i = 0;
+        for (int z = _minZ + 1; z <= _maxZ; z++)
         {
-          // useXMin = ((idxX + outExt[0]) <= wholeExtent[0]) ? 0 : -inIncs[0];
-          // useXMax = ((idxX + outExt[0]) >= wholeExtent[1]) ? 0 : inIncs[0];
-
-          T mip = inPtr[_minZ * inIncs[2]];
-          i = 0;
-          double mymip = 0;
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            double value = inPtr[z * inIncs[2]];
-            mymip += value * weights[i++];
-          }
-          mip = static_cast<T>(mymip);
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          const T *slice = inPtr + z * zInc;
+          const double weight = weights[i++];
+          for (idxX = 0; idxX < rowLength; idxX++)
+            weightedSum[idxX] += static_cast<double>(slice[idxX]) * weight;
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
+
+        for (idxX = 0; idxX < rowLength; idxX++)
+          outPtr[idxX] = static_cast<T>(weightedSum[idxX]);
+
+        outPtr += rowLength + outIncY;
+        inPtr += rowLength + inIncY;
       }
     }
     break;
@@ -284,24 +251,17 @@ r[2] = -0.5 / r[2];
     {
       for (idxY = 0; idxY <= maxY; idxY++)
       {
-        for (idxX = 0; idxX <= maxX; idxX++)
+        std::copy(inPtr + _minZ * zInc, inPtr + _minZ * zInc + rowLength, outPtr);
+
+        for (int z = _minZ + 1; z <= _maxZ; z++)
         {
-          T mip = inPtr[_minZ * inIncs[2]];
-
-          for (int z = _minZ + 1; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            if (value < mip)
-              mip = value;
-          }
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          const T *slice = inPtr + z * zInc;
+          for (idxX = 0; idxX < rowLength; idxX++)
+            outPtr[idxX] = slice[idxX] < outPtr[idxX] ? slice[idxX] : outPtr[idxX];
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
+
+        outPtr += rowLength + outIncY;
+        inPtr += rowLength + inIncY;
       }
     }
     break;
@@ -309,28 +269,24 @@ r[2] = -0.5 / r[2];
     case vtkMitkThickSlicesFilter::MEAN:
     {
       const int size = _maxZ - _minZ;
+      std::vector<long double> sum(rowLength);
 
-      // MEAN
       for (idxY = 0; idxY <= maxY; idxY++)
       {
-        for (idxX = 0; idxX <= maxX; idxX++)
+        std::fill(sum.begin(), sum.end(), 0.0L);
+
+        for (int z = _minZ; z <= _maxZ; z++)
         {
-          long double sum = 0;
-          for (int z = _minZ; z <= _maxZ; z++)
-          {
-            T value = inPtr[z * inIncs[2]];
-            sum += value;
-          }
-
-          T mip = static_cast<T>(sum / size);
-
-          // do X axis
-          *outPtr = mip;
-          outPtr++;
-          inPtr++;
+          const T *slice = inPtr + z * zInc;
+          for (idxX = 0; idxX < rowLength; idxX++)
+            sum[idxX] += slice[idxX];
         }
-        outPtr += outIncY;
-        inPtr += inIncY;
+
+        for (idxX = 0; idxX < rowLength; idxX++)
+          outPtr[idxX] = static_cast<T>(sum[idxX] / size);
+
+        outPtr += rowLength + outIncY;
+        inPtr += rowLength + inIncY;
       }
     }
     break;
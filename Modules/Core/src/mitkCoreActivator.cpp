@@ -24,6 +24,7 @@ found in the LICENSE file.
 #include <mitkPointSetReaderService.h>
 #include <mitkPointSetWriterService.h>
 #include <mitkRawImageFileReader.h>
+#include <mitkSlicePrefetcher.h>
 #include <mitkSurfaceStlIO.h>
 #include <mitkSurfaceVtkLegacyIO.h>
 #include <mitkSurfaceVtkXmlIO.h>
@@ -192,6 +193,9 @@ void MitkCoreActivator::Load(us::ModuleContext *context)
 
 void MitkCoreActivator::Unload(us::ModuleContext *)
 {
+  // join the prefetch threads here, not in a static destructor while the library is unloaded
+  mitk::SlicePrefetcher::ShutdownWorkerThreads();
+
   for (auto &elem : m_FileReaders)
   {
     delete elem;
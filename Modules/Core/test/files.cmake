@@ -118,6 +118,11 @@ set(MODULE_TESTS
   mitkNodePredicateGeometryTest.cpp
   mitkPreferenceListReaderOptionsFunctorTest.cpp
   mitkGenericIDRelationRuleTest.cpp
+  mitkImageSliceCacheTest.cpp
+  mitkSlicePrefetcherTest.cpp
+  mitkPolyDataCutIndexTest.cpp
+  mitkPointSetSpatialIndexTest.cpp
+  mitkTraceTest.cpp
   mitkSourceImageRelationRuleTest.cpp
   mitkPointSetDataInteractorTest.cpp #since mitkInteractionTestHelper is currently creating a vtkRenderWindow
   mitkSurfaceVtkMapper2DTest.cpp #new rendering test in CppUnit style
@@ -0,0 +1,173 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImageSliceCache.h>
+#include <mitkImageVtkMapper2D.h>
+#include <mitkPlaneGeometry.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+class mitkImageSliceCacheTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageSliceCacheTestSuite);
+  MITK_TEST(FindReturnsInsertedSlice);
+  MITK_TEST(KeyDependsOnPlaneGeometry);
+  MITK_TEST(KeyDependsOnTimeStepAndData);
+  MITK_TEST(LeastRecentlyUsedEntryIsEvicted);
+  MITK_TEST(SetCapacityShrinksCache);
+  MITK_TEST(StopPrefetchingRestoresDefaultCapacity);
+  CPPUNIT_TEST_SUITE_END();
+
+  mitk::PlaneGeometry::Pointer m_AxialPlane;
+  mitk::PlaneGeometry::Pointer m_ShiftedPlane;
+
+  mitk::ImageSliceCache::Entry CreateEntry() const
+  {
+    mitk::ImageSliceCache::Entry entry;
+    entry.Slice = vtkSmartPointer<vtkImageData>::New();
+    entry.Slice->SetDimensions(4, 4, 1);
+    entry.Slice->AllocateScalars(VTK_FLOAT, 1);
+    entry.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+    return entry;
+  }
+
+  mitk::ImageSliceCache::Key CreateKey(const mitk::PlaneGeometry *plane, mitk::TimeStepType timeStep = 0) const
+  {
+    mitk::ImageSliceCache::Key key;
+    key.SetPlaneGeometry(plane);
+    key.TimeStep = timeStep;
+    key.DataMTime = 42;
+    return key;
+  }
+
+public:
+  void setUp() override
+  {
+    m_AxialPlane = mitk::PlaneGeometry::New();
+    m_AxialPlane->InitializeStandardPlane(100.0, 100.0, nullptr, mitk::PlaneGeometry::Axial, 0.0);
+
+    m_ShiftedPlane = mitk::PlaneGeometry::New();
+    m_ShiftedPlane->InitializeStandardPlane(100.0, 100.0, nullptr, mitk::PlaneGeometry::Axial, 5.0);
+  }
+
+  void tearDown() override
+  {
+    m_AxialPlane = nullptr;
+    m_ShiftedPlane = nullptr;
+  }
+
+  void FindReturnsInsertedSlice()
+  {
+    mitk::ImageSliceCache cache;
+    auto key = this->CreateKey(m_AxialPlane);
+
+    CPPUNIT_ASSERT(nullptr == cache.Find(key));
+
+    auto entry = this->CreateEntry();
+    cache.Insert(key, entry);
+
+    auto cachedEntry = cache.Find(key);
+    CPPUNIT_ASSERT(nullptr != cachedEntry);
+    CPPUNIT_ASSERT(cachedEntry->Slice.GetPointer() == entry.Slice.GetPointer());
+    CPPUNIT_ASSERT_EQUAL(1u, cache.GetSize());
+  }
+
+  void KeyDependsOnPlaneGeometry()
+  {
+    mitk::ImageSliceCache cache;
+    cache.Insert(this->CreateKey(m_AxialPlane), this->CreateEntry());
+
+    CPPUNIT_ASSERT(this->CreateKey(m_AxialPlane) != this->CreateKey(m_ShiftedPlane));
+    CPPUNIT_ASSERT(nullptr == cache.Find(this->CreateKey(m_ShiftedPlane)));
+    CPPUNIT_ASSERT(nullptr != cache.Find(this->CreateKey(m_AxialPlane)));
+  }
+
+  void KeyDependsOnTimeStepAndData()
+  {
+    mitk::ImageSliceCache cache;
+    auto key = this->CreateKey(m_AxialPlane);
+    cache.Insert(key, this->CreateEntry());
+
+    CPPUNIT_ASSERT(nullptr == cache.Find(this->CreateKey(m_AxialPlane, 1)));
+
+    auto modifiedDataKey = key;
+    modifiedDataKey.DataMTime = key.DataMTime + 1;
+    CPPUNIT_ASSERT(nullptr == cache.Find(modifiedDataKey));
+
+    auto otherInterpolationKey = key;
+    otherInterpolationKey.InterpolationMode = 1;
+    CPPUNIT_ASSERT(nullptr == cache.Find(otherInterpolationKey));
+  }
+
+  void LeastRecentlyUsedEntryIsEvicted()
+  {
+    mitk::ImageSliceCache cache(2);
+    auto key0 = this->CreateKey(m_AxialPlane, 0);
+    auto key1 = this->CreateKey(m_AxialPlane, 1);
+    auto key2 = this->CreateKey(m_AxialPlane, 2);
+
+    cache.Insert(key0, this->CreateEntry());
+    cache.Insert(key1, this->CreateEntry());
+
+    // touch key0, so key1 becomes the least recently used entry
+    CPPUNIT_ASSERT(nullptr != cache.Find(key0));
+
+    cache.Insert(key2, this->CreateEntry());
+
+    CPPUNIT_ASSERT_EQUAL(2u, cache.GetSize());
+    CPPUNIT_ASSERT(nullptr != cache.Find(key0));
+    CPPUNIT_ASSERT(nullptr == cache.Find(key1));
+    CPPUNIT_ASSERT(nullptr != cache.Find(key2));
+  }
+
+  void SetCapacityShrinksCache()
+  {
+    mitk::ImageSliceCache cache(4);
+
+    for (mitk::TimeStepType timeStep = 0; timeStep < 4; ++timeStep)
+      cache.Insert(this->CreateKey(m_AxialPlane, timeStep), this->CreateEntry());
+
+    CPPUNIT_ASSERT_EQUAL(4u, cache.GetSize());
+
+    cache.SetCapacity(1);
+    CPPUNIT_ASSERT_EQUAL(1u, cache.GetSize());
+    CPPUNIT_ASSERT(nullptr != cache.Find(this->CreateKey(m_AxialPlane, 3)));
+
+    cache.SetCapacity(0);
+    cache.Insert(this->CreateKey(m_AxialPlane), this->CreateEntry());
+    CPPUNIT_ASSERT_EQUAL(0u, cache.GetSize());
+  }
+
+  void StopPrefetchingRestoresDefaultCapacity()
+  {
+    mitk::ImageVtkMapper2D::LocalStorage localStorage;
+    CPPUNIT_ASSERT_EQUAL(mitk::ImageSliceCache::DefaultCapacity, localStorage.m_SliceCache.GetCapacity());
+
+    // prefetching enlarges the cache
+    localStorage.m_SliceCache.SetCapacity(2 * mitk::ImageSliceCache::DefaultCapacity);
+    localStorage.m_PrefetchStreak = 3;
+
+    for (mitk::TimeStepType timeStep = 0; timeStep < 2 * mitk::ImageSliceCache::DefaultCapacity; ++timeStep)
+      localStorage.m_SliceCache.Insert(this->CreateKey(m_AxialPlane, timeStep), this->CreateEntry());
+
+    localStorage.StopPrefetching();
+
+    CPPUNIT_ASSERT_EQUAL(mitk::ImageSliceCache::DefaultCapacity, localStorage.m_SliceCache.GetCapacity());
+    CPPUNIT_ASSERT_EQUAL(mitk::ImageSliceCache::DefaultCapacity, localStorage.m_SliceCache.GetSize());
+    CPPUNIT_ASSERT_EQUAL(0, localStorage.m_PrefetchStreak);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageSliceCache)
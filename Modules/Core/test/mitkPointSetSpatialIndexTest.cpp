@@ -0,0 +1,255 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkPlaneGeometry.h>
+#include <mitkPointSet.h>
+#include <mitkPointSetSpatialIndex.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+class mitkPointSetSpatialIndexTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPointSetSpatialIndexTestSuite);
+  MITK_TEST(FindClosestPointMatchesBruteForce);
+  MITK_TEST(FindPointsNearPlaneMatchesBruteForce);
+  MITK_TEST(IncrementalUpdatesMatchBruteForce);
+  MITK_TEST(PointSetSearchPointUsesIndex);
+  MITK_TEST(PointSetSearchPointsNearPlaneRespectsGeometry);
+  CPPUNIT_TEST_SUITE_END();
+
+  typedef mitk::PointSetSpatialIndex::IdentifierType IdentifierType;
+
+  std::vector<std::pair<IdentifierType, mitk::Point3D>> m_Points;
+  std::mt19937 m_Generator;
+
+  mitk::Point3D RandomPoint(double extent)
+  {
+    std::uniform_real_distribution<double> distribution(-extent, extent);
+    mitk::Point3D point;
+    for (unsigned int axis = 0; axis < 3; ++axis)
+      point[axis] = distribution(m_Generator);
+    return point;
+  }
+
+  bool FindClosestPointBruteForce(const mitk::Point3D &point, double squaredDistance, IdentifierType &id) const
+  {
+    bool found(false);
+    for (const auto &candidate : m_Points)
+    {
+      const double distance = point.SquaredEuclideanDistanceTo(candidate.second);
+      if (distance < squaredDistance || (found && distance == squaredDistance && candidate.first < id))
+      {
+        squaredDistance = distance;
+        id = candidate.first;
+        found = true;
+      }
+    }
+    return found;
+  }
+
+  std::vector<IdentifierType> FindPointsNearPlaneBruteForce(const mitk::Point3D &origin,
+                                                            const mitk::Vector3D &normal,
+                                                            double distance) const
+  {
+    std::vector<IdentifierType> ids;
+    for (const auto &candidate : m_Points)
+    {
+      if (std::abs(normal * (candidate.second - origin)) <= distance)
+        ids.push_back(candidate.first);
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+  }
+
+  void CheckQueries(const mitk::PointSetSpatialIndex &index)
+  {
+    CPPUNIT_ASSERT_EQUAL(m_Points.size(), index.GetNumberOfPoints());
+
+    for (int i = 0; i < 200; ++i)
+    {
+      const mitk::Point3D point = this->RandomPoint(60.0);
+      const double squaredDistance = (i % 2 == 0) ? 4.0 : 400.0;
+
+      IdentifierType expectedId(0);
+      IdentifierType id(0);
+      const bool expected = this->FindClosestPointBruteForce(point, squaredDistance, expectedId);
+      CPPUNIT_ASSERT_EQUAL(expected, index.FindClosestPoint(point, squaredDistance, id));
+      if (expected)
+        CPPUNIT_ASSERT_EQUAL(expectedId, id);
+    }
+
+    const double normals[][3] = {{0.0, 0.0, 1.0}, {1.0, 0.0, 0.0}, {0.3, -0.4, 0.9}, {-1.0, 2.0, 0.5}};
+    for (const auto &normalValues : normals)
+    {
+      mitk::Vector3D normal(normalValues);
+      normal.Normalize();
+      const mitk::Point3D origin = this->RandomPoint(20.0);
+
+      std::vector<IdentifierType> ids;
+      index.FindPointsNearPlane(origin, normal, 2.5, ids);
+      CPPUNIT_ASSERT_MESSAGE("Index finds the same points as testing all points",
+                             ids == this->FindPointsNearPlaneBruteForce(origin, normal, 2.5));
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_Generator.seed(42);
+    m_Points.clear();
+    for (IdentifierType id = 0; id < 2000; ++id)
+      m_Points.emplace_back(3 * id, this->RandomPoint(50.0));
+  }
+
+  void tearDown() override { m_Points.clear(); }
+
+  void FindClosestPointMatchesBruteForce()
+  {
+    mitk::PointSetSpatialIndex index;
+    index.Build(m_Points);
+    this->CheckQueries(index);
+
+    // the closest point is found even if it lies exactly on a point of the set
+    IdentifierType id(0);
+    CPPUNIT_ASSERT(index.FindClosestPoint(m_Points[17].second, 1e-6, id));
+    CPPUNIT_ASSERT_EQUAL(m_Points[17].first, id);
+  }
+
+  void FindPointsNearPlaneMatchesBruteForce()
+  {
+    mitk::PointSetSpatialIndex index;
+    index.Build(m_Points);
+
+    mitk::Point3D origin;
+    origin.Fill(0.0);
+    mitk::Vector3D normal;
+    normal.Fill(0.0);
+    normal[2] = 1.0;
+
+    std::vector<IdentifierType> ids;
+    index.FindPointsNearPlane(origin, normal, 4.0, ids);
+    CPPUNIT_ASSERT_MESSAGE("Plane is close to some points", !ids.empty());
+    CPPUNIT_ASSERT_MESSAGE("Plane is not close to all points", ids.size() < m_Points.size() / 4);
+    CPPUNIT_ASSERT(ids == this->FindPointsNearPlaneBruteForce(origin, normal, 4.0));
+
+    origin[2] = 100.0;
+    index.FindPointsNearPlane(origin, normal, 4.0, ids);
+    CPPUNIT_ASSERT(ids.empty());
+  }
+
+  void IncrementalUpdatesMatchBruteForce()
+  {
+    mitk::PointSetSpatialIndex index;
+    index.Build(std::vector<std::pair<IdentifierType, mitk::Point3D>>(m_Points.begin(), m_Points.begin() + 10));
+
+    // growing the set far beyond the size of the first build and outside of its extent rebuilds the grid
+    for (std::size_t i = 10; i < m_Points.size(); ++i)
+      index.SetPoint(m_Points[i].first, m_Points[i].second);
+    this->CheckQueries(index);
+
+    // move some points, remove others
+    for (std::size_t i = 0; i < m_Points.size(); i += 7)
+    {
+      m_Points[i].second = this->RandomPoint(55.0);
+      index.SetPoint(m_Points[i].first, m_Points[i].second);
+    }
+    for (int i = static_cast<int>(m_Points.size()) - 1; i >= 0; i -= 5)
+    {
+      index.RemovePoint(m_Points[i].first);
+      m_Points.erase(m_Points.begin() + i);
+    }
+    this->CheckQueries(index);
+
+    index.Clear();
+    m_Points.clear();
+    this->CheckQueries(index);
+  }
+
+  void PointSetSearchPointUsesIndex()
+  {
+    mitk::PointSet::Pointer pointSet = mitk::PointSet::New();
+    for (const auto &point : m_Points)
+      pointSet->InsertPoint(point.first, point.second);
+
+    for (int i = 0; i < 100; ++i)
+    {
+      const mitk::Point3D point = this->RandomPoint(50.0);
+      IdentifierType expectedId(0);
+      const int expected =
+        this->FindClosestPointBruteForce(point, 9.0, expectedId) ? static_cast<int>(expectedId) : -1;
+      CPPUNIT_ASSERT_EQUAL(expected, pointSet->SearchPoint(point, 3.0));
+    }
+
+    // the index follows the modifications of the point set
+    mitk::Point3D farPoint;
+    farPoint.Fill(500.0);
+    CPPUNIT_ASSERT_EQUAL(-1, pointSet->SearchPoint(farPoint, 1.0));
+    pointSet->SetPoint(m_Points[5].first, farPoint);
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(m_Points[5].first), pointSet->SearchPoint(farPoint, 1.0));
+    pointSet->RemovePointIfExists(m_Points[5].first);
+    CPPUNIT_ASSERT_EQUAL(-1, pointSet->SearchPoint(farPoint, 1.0));
+
+    // modifications of the points container bypassing the point set are detected as well
+    pointSet->GetPointSet()->GetPoints()->InsertElement(m_Points[5].first, farPoint);
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(m_Points[5].first), pointSet->SearchPoint(farPoint, 1.0));
+  }
+
+  void PointSetSearchPointsNearPlaneRespectsGeometry()
+  {
+    mitk::PointSet::Pointer pointSet = mitk::PointSet::New();
+    for (const auto &point : m_Points)
+      pointSet->InsertPoint(point.first, point.second);
+
+    // points are stored in index coordinates, move and scale them in the world
+    mitk::Vector3D spacing;
+    spacing[0] = 0.5;
+    spacing[1] = 2.0;
+    spacing[2] = 1.5;
+    pointSet->GetGeometry()->SetSpacing(spacing);
+    mitk::Vector3D translation;
+    translation.Fill(10.0);
+    pointSet->GetGeometry()->Translate(translation);
+
+    mitk::Point3D origin;
+    origin.Fill(10.0);
+    mitk::Vector3D normal;
+    normal[0] = 0.3;
+    normal[1] = 0.4;
+    normal[2] = 0.2;
+
+    mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+    plane->InitializePlane(origin, normal);
+
+    std::vector<mitk::PointSet::PointIdentifier> ids;
+    pointSet->SearchPointsNearPlane(plane, 4.0, ids);
+
+    std::vector<mitk::PointSet::PointIdentifier> expectedIds;
+    for (auto it = pointSet->Begin(); it != pointSet->End(); ++it)
+    {
+      // the indexed distance may differ from the world distance by rounding only
+      const double distance = plane->Distance(pointSet->GetPoint(it->Index()));
+      if (distance <= 4.0 - 1e-9)
+        expectedIds.push_back(it->Index());
+      else if (distance <= 4.0 + 1e-9)
+        ids.erase(std::remove(ids.begin(), ids.end(), it->Index()), ids.end());
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Plane is close to some points", !expectedIds.empty());
+    CPPUNIT_ASSERT(ids == expectedIds);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPointSetSpatialIndex)
@@ -0,0 +1,205 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkPolyDataCutIndex.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <vtkCellArray.h>
+#include <vtkCutter.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+
+class mitkPolyDataCutIndexTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPolyDataCutIndexTestSuite);
+  MITK_TEST(FindCutCellsMatchesBruteForce);
+  MITK_TEST(FindCutCellsIsIndependentOfThreads);
+  MITK_TEST(ExtractedCellsGiveSameCut);
+  MITK_TEST(IndexIsRebuiltWhenInputIsModified);
+  MITK_TEST(PlaneOutsideOfSurfaceCutsNothing);
+  CPPUNIT_TEST_SUITE_END();
+
+  vtkSmartPointer<vtkPolyData> m_Sphere;
+
+  std::vector<vtkIdType> FindCutCellsBruteForce(const double origin[3], const double normal[3]) const
+  {
+    std::vector<vtkIdType> cellIds;
+    for (vtkIdType cellId = 0; cellId < m_Sphere->GetNumberOfCells(); ++cellId)
+    {
+      vtkIdType numberOfPoints(0);
+      vtkIdType *pointIds(nullptr);
+      m_Sphere->GetCellPoints(cellId, numberOfPoints, pointIds);
+
+      bool below(false);
+      bool above(false);
+      for (vtkIdType i = 0; i < numberOfPoints; ++i)
+      {
+        double point[3];
+        m_Sphere->GetPoint(pointIds[i], point);
+        const double distance = vtkPlane::Evaluate(const_cast<double *>(normal), const_cast<double *>(origin), point);
+        below = below || distance <= 0.0;
+        above = above || distance >= 0.0;
+      }
+
+      if (below && above)
+        cellIds.push_back(cellId);
+    }
+    return cellIds;
+  }
+
+  vtkSmartPointer<vtkPolyData> Cut(vtkPolyData *polyData, const double origin[3], const double normal[3]) const
+  {
+    auto plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetOrigin(const_cast<double *>(origin));
+    plane->SetNormal(const_cast<double *>(normal));
+
+    auto cutter = vtkSmartPointer<vtkCutter>::New();
+    cutter->SetCutFunction(plane);
+    cutter->SetInputData(polyData);
+    cutter->Update();
+    return cutter->GetOutput();
+  }
+
+public:
+  void setUp() override
+  {
+    auto sphereSource = vtkSmartPointer<vtkSphereSource>::New();
+    sphereSource->SetRadius(10.0);
+    sphereSource->SetThetaResolution(120);
+    sphereSource->SetPhiResolution(120);
+    sphereSource->Update();
+    m_Sphere = sphereSource->GetOutput();
+  }
+
+  void tearDown() override { m_Sphere = nullptr; }
+
+  void FindCutCellsMatchesBruteForce()
+  {
+    mitk::PolyDataCutIndex index;
+    index.SetInput(m_Sphere);
+
+    const double planes[][6] = {{0.0, 0.0, 0.01, 0.0, 0.0, 1.0},
+                                {1.5, -2.0, 3.25, 1.0, 0.0, 0.0},
+                                {0.0, 0.0, 7.3, 0.3, -0.4, 0.9},
+                                {0.0, 0.0, 10.0, 0.0, 0.0, 1.0}};
+    for (const auto &plane : planes)
+    {
+      std::vector<vtkIdType> cellIds;
+      index.FindCutCells(plane, plane + 3, cellIds);
+
+      CPPUNIT_ASSERT_MESSAGE("Index has a hierarchy", index.GetNumberOfNodes() > 1);
+      CPPUNIT_ASSERT_MESSAGE("Plane cuts some cells", !cellIds.empty());
+      CPPUNIT_ASSERT_MESSAGE("Index finds the same cells as testing all cells",
+                             cellIds == this->FindCutCellsBruteForce(plane, plane + 3));
+    }
+  }
+
+  void FindCutCellsIsIndependentOfThreads()
+  {
+    const double origin[3] = {0.5, 0.25, -1.0};
+    const double normal[3] = {0.2, 1.0, 0.1};
+
+    mitk::PolyDataCutIndex singleThreaded;
+    singleThreaded.SetNumberOfThreads(1);
+    singleThreaded.SetInput(m_Sphere);
+    std::vector<vtkIdType> singleThreadedIds;
+    singleThreaded.FindCutCells(origin, normal, singleThreadedIds);
+
+    // the cut of the sphere is far too small to use several threads by default
+    mitk::PolyDataCutIndex multiThreaded;
+    multiThreaded.SetNumberOfThreads(8);
+    multiThreaded.SetMinimumCellsPerThread(1);
+    multiThreaded.SetInput(m_Sphere);
+    std::vector<vtkIdType> multiThreadedIds;
+    multiThreaded.FindCutCells(origin, normal, multiThreadedIds);
+
+    CPPUNIT_ASSERT_MESSAGE("Cut has enough candidates for eight threads", singleThreadedIds.size() >= 8);
+    CPPUNIT_ASSERT(singleThreadedIds == multiThreadedIds);
+  }
+
+  void ExtractedCellsGiveSameCut()
+  {
+    const double origin[3] = {0.0, 1.0, 2.0};
+    const double normal[3] = {0.0, 0.6, 0.8};
+
+    mitk::PolyDataCutIndex index;
+    index.SetInput(m_Sphere);
+    auto cutCells = vtkSmartPointer<vtkPolyData>::New();
+    index.ExtractCutCells(origin, normal, cutCells);
+
+    CPPUNIT_ASSERT_MESSAGE("Only a part of the cells is extracted",
+                           cutCells->GetNumberOfCells() < m_Sphere->GetNumberOfCells() / 10);
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(this->FindCutCellsBruteForce(origin, normal).size()),
+                         cutCells->GetNumberOfPolys());
+    CPPUNIT_ASSERT_EQUAL(m_Sphere->GetPointData()->GetNumberOfArrays(), cutCells->GetPointData()->GetNumberOfArrays());
+
+    vtkSmartPointer<vtkPolyData> expected = this->Cut(m_Sphere, origin, normal);
+    vtkSmartPointer<vtkPolyData> actual = this->Cut(cutCells, origin, normal);
+
+    CPPUNIT_ASSERT_EQUAL(expected->GetNumberOfLines(), actual->GetNumberOfLines());
+    CPPUNIT_ASSERT_EQUAL(expected->GetNumberOfPoints(), actual->GetNumberOfPoints());
+
+    double expectedBounds[6];
+    double actualBounds[6];
+    expected->GetBounds(expectedBounds);
+    actual->GetBounds(actualBounds);
+    for (int i = 0; i < 6; ++i)
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedBounds[i], actualBounds[i], 1e-6);
+  }
+
+  void IndexIsRebuiltWhenInputIsModified()
+  {
+    const double origin[3] = {0.0, 0.0, 15.0};
+    const double normal[3] = {0.0, 0.0, 1.0};
+
+    mitk::PolyDataCutIndex index;
+    index.SetInput(m_Sphere);
+    std::vector<vtkIdType> cellIds;
+    index.FindCutCells(origin, normal, cellIds);
+    CPPUNIT_ASSERT(cellIds.empty());
+
+    // move the sphere up, so that the plane cuts it
+    vtkPoints *points = m_Sphere->GetPoints();
+    for (vtkIdType pointId = 0; pointId < points->GetNumberOfPoints(); ++pointId)
+    {
+      double point[3];
+      points->GetPoint(pointId, point);
+      point[2] += 10.0;
+      points->SetPoint(pointId, point);
+    }
+    points->Modified();
+
+    index.FindCutCells(origin, normal, cellIds);
+    CPPUNIT_ASSERT(!cellIds.empty());
+    CPPUNIT_ASSERT(cellIds == this->FindCutCellsBruteForce(origin, normal));
+  }
+
+  void PlaneOutsideOfSurfaceCutsNothing()
+  {
+    const double origin[3] = {20.0, 0.0, 0.0};
+    const double normal[3] = {1.0, 1.0, 0.0};
+
+    mitk::PolyDataCutIndex index;
+    index.SetInput(m_Sphere);
+    auto cutCells = vtkSmartPointer<vtkPolyData>::New();
+    index.ExtractCutCells(origin, normal, cutCells);
+
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(0), cutCells->GetNumberOfCells());
+    CPPUNIT_ASSERT_EQUAL(static_cast<vtkIdType>(0), cutCells->GetNumberOfPoints());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPolyDataCutIndex)
@@ -11,6 +11,7 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkProperties.h"
+#include "mitkRenderWindow.h"
 #include "mitkRenderingManager.h"
 #include "mitkStandaloneDataStorage.h"
 #include "mitkVtkPropRenderer.h"
@@ -157,6 +158,125 @@ public:
     myRenderingManager->ForceImmediateUpdateAll();
   }
 
+  static void TestFrameScheduling()
+  {
+    mitk::RenderingManager::Pointer myRenderingManager = mitk::RenderingManager::New();
+
+    MITK_TEST_CONDITION(myRenderingManager->GetFrameBudget() == 0.0, "Frame budget must be disabled by default")
+
+    vtkRenderWindow *vtkRenWin = vtkRenderWindow::New();
+    mitk::VtkPropRenderer::Pointer br = mitk::VtkPropRenderer::New("frameSchedulingBR", vtkRenWin);
+    mitk::BaseRenderer::AddInstance(vtkRenWin, br);
+    myRenderingManager->AddRenderWindow(vtkRenWin);
+    myRenderingManager->SetFrameBudget(40.0);
+
+    MITK_TEST_CONDITION(myRenderingManager->GetFrameBudget() == 40.0, "Testing if the frame budget has been set")
+
+    // requests are merged and executed once; an empty window is not rendered at all
+    myRenderingManager->RequestUpdate(vtkRenWin);
+    myRenderingManager->RequestUpdate(vtkRenWin);
+    myRenderingManager->ExecutePendingRequests();
+
+    auto statistics = myRenderingManager->GetFrameStatistics(vtkRenWin);
+    MITK_TEST_CONDITION(statistics.NumberOfFrames == 0 && statistics.NumberOfDeferredFrames == 0,
+                        "Window without size must neither be rendered nor deferred")
+    MITK_TEST_CONDITION(!myRenderingManager->IsRenderingDegraded(vtkRenWin),
+                        "A single window within the budget must not be degraded")
+
+    myRenderingManager->ResetFrameStatistics();
+    statistics = myRenderingManager->GetFrameStatistics(nullptr);
+    MITK_TEST_CONDITION(statistics.NumberOfFrames == 0 && statistics.MaximumFrameTime == 0.0,
+                        "Statistics of unknown windows must be empty")
+
+    myRenderingManager->RemoveRenderWindow(vtkRenWin);
+    mitk::BaseRenderer::RemoveInstance(vtkRenWin);
+    vtkRenWin->Delete();
+  }
+
+  static void TestFrameBudgetDefersAndDegradesWindows()
+  {
+    vtkRenderWindow *focusedVtkRenWin = vtkRenderWindow::New();
+    vtkRenderWindow *otherVtkRenWin = vtkRenderWindow::New();
+    focusedVtkRenWin->SetOffScreenRendering(1);
+    otherVtkRenWin->SetOffScreenRendering(1);
+
+    if (0 == focusedVtkRenWin->SupportsOpenGL())
+    {
+      MITK_TEST_OUTPUT(<< "OpenGL not supported, skipping frame budget tests")
+      focusedVtkRenWin->Delete();
+      otherVtkRenWin->Delete();
+      return;
+    }
+
+    {
+      // sized windows are actually rendered (in contrast to the window of TestFrameScheduling())
+      mitk::RenderWindow::Pointer focusedWindow = mitk::RenderWindow::New(focusedVtkRenWin, "frameBudgetFocusedBR");
+      mitk::RenderWindow::Pointer otherWindow = mitk::RenderWindow::New(otherVtkRenWin, "frameBudgetOtherBR");
+      focusedWindow->SetSize(64, 64);
+      otherWindow->SetSize(64, 64);
+
+      mitk::RenderingManager::Pointer myRenderingManager = mitk::RenderingManager::New();
+      myRenderingManager->AddRenderWindow(focusedVtkRenWin);
+      myRenderingManager->AddRenderWindow(otherVtkRenWin);
+      myRenderingManager->SetDataStorage(mitk::StandaloneDataStorage::New());
+      myRenderingManager->SetRenderWindowFocus(focusedVtkRenWin);
+
+      // every frame exceeds this budget as soon as the first window has been rendered
+      const double frameBudget = 1e-6;
+      const double desiredUpdateRate = otherVtkRenWin->GetDesiredUpdateRate();
+      myRenderingManager->SetFrameBudget(frameBudget);
+
+      myRenderingManager->RequestUpdate(otherVtkRenWin);
+      myRenderingManager->RequestUpdate(focusedVtkRenWin);
+      myRenderingManager->ExecutePendingRequests();
+
+      auto focusedStatistics = myRenderingManager->GetFrameStatistics(focusedVtkRenWin);
+      auto otherStatistics = myRenderingManager->GetFrameStatistics(otherVtkRenWin);
+      MITK_TEST_CONDITION(focusedStatistics.NumberOfFrames == 1 && focusedStatistics.NumberOfDeferredFrames == 0,
+                          "Focused window must be rendered first")
+      MITK_TEST_CONDITION(otherStatistics.NumberOfFrames == 0 && otherStatistics.NumberOfDeferredFrames == 1,
+                          "Other window must be deferred once the budget is exceeded")
+      MITK_TEST_CONDITION(!myRenderingManager->IsRenderingDegraded(otherVtkRenWin),
+                          "Deferred window must not be degraded yet")
+
+      // the deferred request is kept, the other window must not be deferred twice
+      myRenderingManager->RequestUpdate(focusedVtkRenWin);
+      myRenderingManager->ExecutePendingRequests();
+
+      otherStatistics = myRenderingManager->GetFrameStatistics(otherVtkRenWin);
+      MITK_TEST_CONDITION(otherStatistics.NumberOfFrames == 1 && otherStatistics.NumberOfDeferredFrames == 1,
+                          "Window deferred in the previous frame must be rendered")
+      MITK_TEST_CONDITION(otherStatistics.NumberOfDegradedFrames == 1 &&
+                            myRenderingManager->IsRenderingDegraded(otherVtkRenWin),
+                          "Window deferred in the previous frame must be rendered degraded")
+      MITK_TEST_CONDITION(otherVtkRenWin->GetDesiredUpdateRate() == 1000.0 / frameBudget,
+                          "Degraded window must request the frame rate of the budget")
+      MITK_TEST_CONDITION(!myRenderingManager->IsRenderingDegraded(focusedVtkRenWin),
+                          "Focused window must not be degraded")
+
+      // a frame within the budget restores the quality and re-renders the degraded window
+      myRenderingManager->SetFrameBudget(0.0);
+      myRenderingManager->RequestUpdate(focusedVtkRenWin);
+      myRenderingManager->ExecutePendingRequests();
+
+      MITK_TEST_CONDITION(!myRenderingManager->IsRenderingDegraded(otherVtkRenWin),
+                          "Window must not be degraded after a frame within the budget")
+      MITK_TEST_CONDITION(otherVtkRenWin->GetDesiredUpdateRate() == desiredUpdateRate,
+                          "Desired update rate must be restored")
+
+      myRenderingManager->ExecutePendingRequests();
+
+      otherStatistics = myRenderingManager->GetFrameStatistics(otherVtkRenWin);
+      MITK_TEST_CONDITION(otherStatistics.NumberOfFrames == 2 && otherStatistics.NumberOfDegradedFrames == 1,
+                          "Formerly degraded window must be rendered with full quality again")
+
+      myRenderingManager->RemoveRenderWindow(focusedVtkRenWin);
+      myRenderingManager->RemoveRenderWindow(otherVtkRenWin);
+    }
+
+    // the mitk::RenderWindows have deleted the vtkRenderWindows
+  }
+
 }; // mitkDataNodeTestClass
 int mitkRenderingManagerTest(int /* argc */, char * /*argv*/ [])
 {
@@ -165,6 +285,10 @@ int mitkRenderingManagerTest(int /* argc */, char * /*argv*/ [])
 
   mitkRenderingManagerTestClass::TestAddRemoveRenderWindow();
 
+  mitkRenderingManagerTestClass::TestFrameScheduling();
+
+  mitkRenderingManagerTestClass::TestFrameBudgetDefersAndDegradesWindows();
+
   mitk::RenderingManager::Pointer globalRenderingManager = mitk::RenderingManager::GetInstance();
 
   MITK_TEST_CONDITION_REQUIRED(globalRenderingManager.IsNotNull(), "Testing instantiation of global static instance")
@@ -0,0 +1,131 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkSlicePrefetcher.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+class mitkSlicePrefetcherTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkSlicePrefetcherTestSuite);
+  MITK_TEST(RequestedSlicesAreComputed);
+  MITK_TEST(FailingJobsAreDropped);
+  MITK_TEST(CancelDropsResults);
+  MITK_TEST(RequestAfterShutdownRestartsWorkerThreads);
+  CPPUNIT_TEST_SUITE_END();
+
+  static mitk::ImageSliceCache::Key CreateKey(mitk::TimeStepType timeStep)
+  {
+    mitk::ImageSliceCache::Key key;
+    key.TimeStep = timeStep;
+    return key;
+  }
+
+  static mitk::SlicePrefetcher::JobType CreateJob(mitk::TimeStepType timeStep)
+  {
+    return mitk::SlicePrefetcher::JobType(CreateKey(timeStep), []() {
+      mitk::ImageSliceCache::Entry entry;
+      entry.Slice = vtkSmartPointer<vtkImageData>::New();
+      entry.Slice->SetDimensions(8, 8, 1);
+      entry.Slice->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+      entry.ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+      return entry;
+    });
+  }
+
+  static std::vector<mitk::SlicePrefetcher::ResultType> WaitForResults(mitk::SlicePrefetcher &prefetcher,
+                                                                       std::size_t expectedNumberOfResults)
+  {
+    std::vector<mitk::SlicePrefetcher::ResultType> results;
+
+    for (int i = 0; i < 500 && results.size() < expectedNumberOfResults; ++i)
+    {
+      for (auto &result : prefetcher.TakeResults())
+        results.push_back(std::move(result));
+
+      if (results.size() < expectedNumberOfResults)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    return results;
+  }
+
+public:
+  void RequestedSlicesAreComputed()
+  {
+    CPPUNIT_ASSERT(mitk::SlicePrefetcher::GetNumberOfWorkerThreads() > 0);
+
+    mitk::SlicePrefetcher prefetcher;
+    prefetcher.Request({CreateJob(1), CreateJob(2), CreateJob(3)});
+
+    auto results = WaitForResults(prefetcher, 3);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), results.size());
+
+    for (const auto &result : results)
+    {
+      CPPUNIT_ASSERT(nullptr != result.second.Slice);
+      CPPUNIT_ASSERT(!prefetcher.IsScheduled(result.first));
+    }
+  }
+
+  void FailingJobsAreDropped()
+  {
+    mitk::SlicePrefetcher prefetcher;
+
+    mitk::SlicePrefetcher::JobType failingJob(CreateKey(1), []() -> mitk::ImageSliceCache::Entry {
+      throw std::runtime_error("reslicing failed");
+    });
+
+    prefetcher.Request({failingJob, CreateJob(2)});
+
+    auto results = WaitForResults(prefetcher, 1);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), results.size());
+    CPPUNIT_ASSERT(CreateKey(2) == results.front().first);
+  }
+
+  void CancelDropsResults()
+  {
+    mitk::SlicePrefetcher prefetcher;
+    prefetcher.Request({CreateJob(1), CreateJob(2)});
+    prefetcher.Cancel();
+
+    // jobs that were already running when Cancel() was called must not deliver their results
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    CPPUNIT_ASSERT(prefetcher.TakeResults().empty());
+    CPPUNIT_ASSERT(!prefetcher.IsScheduled(CreateKey(1)));
+  }
+
+  void RequestAfterShutdownRestartsWorkerThreads()
+  {
+    mitk::SlicePrefetcher prefetcher;
+    prefetcher.Request({CreateJob(1), CreateJob(2)});
+
+    // waits for the running jobs, drops the others
+    mitk::SlicePrefetcher::ShutdownWorkerThreads();
+    prefetcher.Cancel();
+
+    prefetcher.Request({CreateJob(3)});
+    auto results = WaitForResults(prefetcher, 1);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), results.size());
+    CPPUNIT_ASSERT(CreateKey(3) == results.front().first);
+    CPPUNIT_ASSERT(mitk::SlicePrefetcher::GetNumberOfWorkerThreads() > 0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkSlicePrefetcher)
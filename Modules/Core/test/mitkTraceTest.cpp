@@ -0,0 +1,151 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+#include <mitkTrace.h>
+
+#include <atomic>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+class mitkTraceTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkTraceTestSuite);
+  MITK_TEST(SpansAreOnlyRecordedWhileEnabled);
+  MITK_TEST(RingBufferKeepsNewestSpans);
+  MITK_TEST(ThreadsHaveDistinctIds);
+  MITK_TEST(ConcurrentThreadsKeepAllSpans);
+  MITK_TEST(ChromeTraceContainsSpans);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void tearDown() override
+  {
+    mitk::Trace::Stop();
+    mitk::Trace::Clear();
+  }
+
+  void SpansAreOnlyRecordedWhileEnabled()
+  {
+    {
+      mitk::TraceSpan span("before", "test");
+    }
+
+    mitk::Trace::Start();
+    CPPUNIT_ASSERT(mitk::Trace::IsEnabled());
+
+    {
+      mitk::TraceSpan span("during", "test");
+    }
+
+    mitk::Trace::Stop();
+
+    {
+      mitk::TraceSpan span("after", "test");
+    }
+
+    auto events = mitk::Trace::GetEvents();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), events.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("during"), std::string(events.front().Name));
+    CPPUNIT_ASSERT(events.front().StartTime >= 0);
+    CPPUNIT_ASSERT(events.front().Duration >= 0);
+  }
+
+  void RingBufferKeepsNewestSpans()
+  {
+    mitk::Trace::Start(4);
+
+    for (int i = 0; i < 10; ++i)
+      mitk::Trace::Record("span", "test", i, i + 1);
+
+    auto events = mitk::Trace::GetEvents();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), events.size());
+
+    for (std::size_t i = 0; i < events.size(); ++i)
+      CPPUNIT_ASSERT_EQUAL(static_cast<std::int64_t>(6 + i), events[i].StartTime);
+  }
+
+  void ThreadsHaveDistinctIds()
+  {
+    mitk::Trace::Start();
+
+    {
+      mitk::TraceSpan span("main", "test");
+    }
+
+    std::thread thread([]() { mitk::TraceSpan span("worker", "test"); });
+    thread.join();
+
+    auto events = mitk::Trace::GetEvents();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), events.size());
+    CPPUNIT_ASSERT(events[0].ThreadId != events[1].ThreadId);
+  }
+
+  void ConcurrentThreadsKeepAllSpans()
+  {
+    mitk::Trace::Start();
+
+    // the spans are collected while the threads are still recording
+    std::atomic<bool> recording(true);
+    std::atomic<bool> tooManySpans(false);
+    std::thread collector([&recording, &tooManySpans]() {
+      while (recording)
+      {
+        if (mitk::Trace::GetEvents().size() > 4000)
+          tooManySpans = true;
+      }
+    });
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+      threads.emplace_back([]() {
+        for (int j = 0; j < 1000; ++j)
+          mitk::TraceSpan span("worker", "test", "argument");
+      });
+    }
+
+    for (auto &thread : threads)
+      thread.join();
+
+    recording = false;
+    collector.join();
+    CPPUNIT_ASSERT(!tooManySpans);
+
+    auto events = mitk::Trace::GetEvents();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4000), events.size());
+
+    for (std::size_t i = 1; i < events.size(); ++i)
+      CPPUNIT_ASSERT(events[i - 1].StartTime <= events[i].StartTime);
+  }
+
+  void ChromeTraceContainsSpans()
+  {
+    mitk::Trace::Start();
+
+    {
+      mitk::TraceSpan span("Load", "io", "C:\\data\\\"image\".nrrd");
+    }
+
+    std::ostringstream stream;
+    mitk::Trace::WriteChromeTrace(stream);
+    const auto json = stream.str();
+
+    CPPUNIT_ASSERT(json.find("\"traceEvents\"") != std::string::npos);
+    CPPUNIT_ASSERT(json.find("\"name\":\"Load\",\"cat\":\"io\",\"ph\":\"X\"") != std::string::npos);
+    CPPUNIT_ASSERT(json.find("C:\\\\data\\\\\\\"image\\\".nrrd") != std::string::npos);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkTrace)
@@ -14,13 +14,17 @@ found in the LICENSE file.
 
 #include <vtkMitkThickSlicesFilter.h>
 
+#include "mitkExtractSliceFilter.h"
 #include "mitkImage.h"
 #include "mitkImageWriteAccessor.h"
+#include "mitkPlaneGeometry.h"
 
 #include <vtkDataArray.h>
 #include <vtkImageData.h>
 #include <vtkPointData.h>
 
+#include <cmath>
+
 class vtkMitkThickSlicesFilterTestHelper
 {
 public:
@@ -56,6 +60,26 @@ public:
     MITK_INFO << "actual value: " << static_cast<double>(value[0]);
     MITK_TEST_CONDITION_REQUIRED(value[0] == expectedValue, "Resulting image has correct pixel-value");
   }
+
+  /** Reslices the axial plane through the given slice, optionally as slab of numberOfSlices slices. */
+  static unsigned char ExtractSlice(
+    mitk::Image *image, int slice, int slabMode, int numberOfSlices, double scalarScale = 1.0)
+  {
+    auto plane = mitk::PlaneGeometry::New();
+    plane->InitializeStandardPlane(image->GetGeometry(), mitk::PlaneGeometry::Axial, slice);
+
+    auto reslicer = mitk::ExtractSliceFilter::New();
+    reslicer->SetInput(image);
+    reslicer->SetWorldGeometry(plane);
+    reslicer->SetVtkOutputRequest(true);
+    reslicer->SetOutputSpacingZDirection(1.0);
+    reslicer->SetSlabMode(slabMode);
+    reslicer->SetSlabNumberOfSlices(numberOfSlices);
+    reslicer->SetScalarScale(scalarScale);
+    reslicer->Update();
+
+    return *static_cast<unsigned char *>(reslicer->GetVtkOutput()->GetScalarPointer());
+  }
 };
 
 /**
@@ -149,6 +173,30 @@ int vtkMitkThickSlicesFilterTest(int, char *[])
   thickSliceFilter->Update();
   vtkMitkThickSlicesFilterTestHelper::EvaluateResult(6, thickSliceFilter->GetOutput(), "Mean");
 
+  //////////////////////////////////////////////////////////////////////////
+  // Slab reslicing by ExtractSliceFilter combines the slices while sampling,
+  // it has to match the reduction of a resliced stack.
+  mitk::Image::Pointer testImage3 = vtkMitkThickSlicesFilterTestHelper::CreateTestImage(0, 6);
+
+  unsigned char centerValue = vtkMitkThickSlicesFilterTestHelper::ExtractSlice(testImage3, 3, VTK_IMAGE_SLAB_MAX, 1);
+  MITK_TEST_CONDITION_REQUIRED(centerValue > 0 && centerValue < 6, "Single slice is inside of the volume");
+
+  MITK_TEST_CONDITION_REQUIRED(
+    vtkMitkThickSlicesFilterTestHelper::ExtractSlice(testImage3, 3, VTK_IMAGE_SLAB_MAX, 3) == centerValue + 1,
+    "Slab MaxIP");
+  MITK_TEST_CONDITION_REQUIRED(
+    vtkMitkThickSlicesFilterTestHelper::ExtractSlice(testImage3, 3, VTK_IMAGE_SLAB_MIN, 3) == centerValue - 1,
+    "Slab MinIP");
+  MITK_TEST_CONDITION_REQUIRED(
+    vtkMitkThickSlicesFilterTestHelper::ExtractSlice(testImage3, 3, VTK_IMAGE_SLAB_MEAN, 3) == centerValue,
+    "Slab Mean");
+
+  // ImageVtkMapper2D computes the mean mode of vtkMitkThickSlicesFilter (sum / (2 * n)) as a scaled slab sum
+  MITK_TEST_CONDITION_REQUIRED(
+    vtkMitkThickSlicesFilterTestHelper::ExtractSlice(testImage3, 3, VTK_IMAGE_SLAB_SUM, 3, 0.5) ==
+      std::lround(1.5 * centerValue),
+    "Scaled slab sum");
+
   thickSliceFilter->Delete();
 
   MITK_TEST_END()
@@ -15,6 +15,8 @@ found in the LICENSE file.
 #include "itkTotalVariationDenoisingImageFilter.h"
 #include "itkTotalVariationSingleIterationImageFilter.h"
 
+#include <algorithm>
+
 // image typedefs
 typedef itk::Image<float, 3> ImageType;
 typedef itk::ImageRegionIterator<ImageType> IteratorType;
@@ -104,6 +106,42 @@ VectorImageType::Pointer GenerateVectorTestImage()
   return image;
 }
 
+/**
+* noisy image with a step edge
+*/
+ImageType::Pointer GenerateNoisyTestImage()
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::SizeType size = {{24, 19, 11}};
+  ImageType::IndexType index = {{0, 0, 0}};
+  ImageType::RegionType largestPossibleRegion(index, size);
+  image->SetRegions(largestPossibleRegion);
+  image->Allocate();
+
+  unsigned int seed = 42;
+  IteratorType it(image, largestPossibleRegion);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+  {
+    seed = seed * 1103515245 + 12345;
+    const float noise = static_cast<float>((seed >> 16) % 1000) / 100.0f - 5.0f;
+    it.Set((it.GetIndex()[0] < 12 ? 10.0f : 50.0f) + noise);
+  }
+
+  return image;
+}
+
+double MaximumDifference(ImageType::Pointer first, ImageType::Pointer second)
+{
+  double difference = 0.0;
+  IteratorType firstIt(first, first->GetLargestPossibleRegion());
+  IteratorType secondIt(second, second->GetLargestPossibleRegion());
+  for (firstIt.GoToBegin(), secondIt.GoToBegin(); !firstIt.IsAtEnd(); ++firstIt, ++secondIt)
+  {
+    difference = std::max(difference, static_cast<double>(fabs(firstIt.Get() - secondIt.Get())));
+  }
+  return difference;
+}
+
 void PrintImage(ImageType::Pointer image)
 {
   IteratorType it(image, image->GetLargestPossibleRegion());
@@ -200,6 +238,53 @@ int itkTotalVariationDenoisingImageFilterTest(int /*argc*/, char * /*argv*/ [])
     return EXIT_FAILURE;
   }
 
+  try
+  {
+    // the fused iterations compute the same result as the single iteration filters, independent of the threads
+    typedef itk::TotalVariationDenoisingImageFilter<ImageType, ImageType> TVFilterType;
+    ImageType::Pointer noisyImage = GenerateNoisyTestImage();
+    ImageType::Pointer results[3];
+    const unsigned int numberOfThreads[3] = {1, 1, 4};
+    for (int i = 0; i < 3; ++i)
+    {
+      TVFilterType::Pointer tvFilter = TVFilterType::New();
+      tvFilter->SetInput(noisyImage);
+      tvFilter->SetNumberIterations(15);
+      tvFilter->SetNumberOfThreads(numberOfThreads[i]);
+      tvFilter->SetLambda(0.1);
+      tvFilter->SetUseFusedIterations(i > 0);
+      tvFilter->Update();
+      results[i] = tvFilter->GetOutput();
+      if (tvFilter->GetNumberOfPerformedIterations() != 15)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+
+    if (MaximumDifference(results[0], results[1]) > 1e-3 || MaximumDifference(results[1], results[2]) != 0.0 ||
+        MaximumDifference(results[0], noisyImage) < 1.0)
+    {
+      return EXIT_FAILURE;
+    }
+
+    // the iterations stop early once they converged
+    TVFilterType::Pointer tvFilter = TVFilterType::New();
+    tvFilter->SetInput(noisyImage);
+    tvFilter->SetNumberIterations(1000);
+    tvFilter->SetTolerance(0.01);
+    tvFilter->SetLambda(0.1);
+    tvFilter->Update();
+    std::cout << "Converged after " << tvFilter->GetNumberOfPerformedIterations() << " iterations" << std::endl;
+    if (tvFilter->GetNumberOfPerformedIterations() >= 1000 || tvFilter->GetNumberOfPerformedIterations() < 15)
+    {
+      return EXIT_FAILURE;
+    }
+  }
+  catch (...)
+  {
+    return EXIT_FAILURE;
+  }
+
   VectorImageType::Pointer vecImage = GenerateVectorTestImage();
   PrintVectorImage(vecImage);
 
@@ -261,6 +346,18 @@ int itkTotalVariationDenoisingImageFilterTest(int /*argc*/, char * /*argv*/ [])
     {
       return EXIT_FAILURE;
     }
+
+    TVVectorFilterType::Pointer tvVecFilterSingle = TVVectorFilterType::New();
+    tvVecFilterSingle->SetInput(vecImage);
+    tvVecFilterSingle->SetNumberIterations(30);
+    tvVecFilterSingle->SetNumberOfThreads(1);
+    tvVecFilterSingle->SetLambda(0.1);
+    tvVecFilterSingle->UseFusedIterationsOff();
+    tvVecFilterSingle->Update();
+    if ((outVecImageTV->GetPixel(vecIndex) - tvVecFilterSingle->GetOutput()->GetPixel(vecIndex)).GetNorm() > 1e-3)
+    {
+      return EXIT_FAILURE;
+    }
   }
   catch (...)
   {
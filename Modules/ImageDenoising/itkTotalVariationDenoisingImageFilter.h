@@ -18,6 +18,8 @@ found in the LICENSE file.
 #include "itkImageToImageFilter.h"
 #include "itkTotalVariationSingleIterationImageFilter.h"
 
+#include <vector>
+
 namespace itk
 {
   /** \class TotalVariationDenoisingImageFilter
@@ -25,6 +27,13 @@ namespace itk
    *
    * Reference: Tony F. Chan et al., The digital TV filter and nonlinear denoising
    *
+   * By default all iterations are computed on two preallocated buffers. Each iteration is a
+   * single multithreaded sweep over the slices of the outermost image dimension, which computes
+   * the local variation of three neighbouring slices on the fly instead of in a separate pass.
+   * Optionally the iterations stop as soon as no pixel changes by more than a tolerance.
+   * The former implementation, which runs a TotalVariationSingleIterationImageFilter per
+   * iteration, can be selected with UseFusedIterationsOff().
+   *
    * \sa Image
    * \sa Neighborhood
    * \sa NeighborhoodOperator
@@ -65,6 +74,7 @@ namespace itk
     typedef typename OutputImageType::RegionType OutputImageRegionType;
 
     typedef typename InputImageType::SizeType InputSizeType;
+    typedef typename OutputImageType::SizeType SizeType;
 
     typedef TotalVariationSingleIterationImageFilter<TOutputImage, TOutputImage> SingleIterationFilterType;
 
@@ -76,17 +86,61 @@ namespace itk
     itkSetMacro(NumberIterations, int);
     itkGetMacro(NumberIterations, int);
 
+    /** Computes the iterations in place with the local variation on the fly (default: on) */
+    itkSetMacro(UseFusedIterations, bool);
+    itkGetMacro(UseFusedIterations, bool);
+    itkBooleanMacro(UseFusedIterations);
+
+    /** Stops the fused iterations when no pixel changes by more than the tolerance (default: 0, no early stop) */
+    itkSetMacro(Tolerance, double);
+    itkGetMacro(Tolerance, double);
+
+    /** Returns the number of iterations computed by the last update */
+    itkGetMacro(NumberOfPerformedIterations, int);
+
   protected:
     TotalVariationDenoisingImageFilter();
     ~TotalVariationDenoisingImageFilter() override {}
     void PrintSelf(std::ostream &os, Indent indent) const override;
 
+    /** The whole image is needed for the iterations */
+    void GenerateInputRequestedRegion() override;
+    void EnlargeOutputRequestedRegion(DataObject *output) override;
+
     void GenerateData() override;
 
+    /** Runs one TotalVariationSingleIterationImageFilter per iteration */
+    void GenerateDataWithSingleIterationFilters();
+
+    /** Ping-pongs between the output and one further buffer */
+    void GenerateDataWithFusedIterations();
+
+    /** Computes one iteration for the slices [firstSlice, endSlice) of the outermost dimension,
+     * returns the maximal squared change of a pixel. */
+    double ComputeIteration(const OutputPixelType *original,
+                            const OutputPixelType *input,
+                            OutputPixelType *output,
+                            SizeValueType firstSlice,
+                            SizeValueType endSlice,
+                            std::vector<float> &localVariation) const;
+
+    /** Computes the local variation of one slice of the outermost dimension */
+    void ComputeLocalVariation(const OutputPixelType *input, SizeValueType slice, float *localVariation) const;
+
     double m_Lambda;
 
     int m_NumberIterations;
 
+    bool m_UseFusedIterations;
+
+    double m_Tolerance;
+
+    int m_NumberOfPerformedIterations;
+
+    /** Size and offset table of the image in the fused iterations */
+    SizeType m_Size;
+    OffsetValueType m_Strides[OutputImageDimension + 1];
+
   private:
     TotalVariationDenoisingImageFilter(const Self &); // purposely not implemented
     void operator=(const Self &);                     // purposely not implemented
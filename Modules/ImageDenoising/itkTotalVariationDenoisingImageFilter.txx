@@ -30,18 +30,60 @@ This file is based heavily on a corresponding ITK filter.
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
 #include <vector>
 
 namespace itk
 {
   template <class TInputImage, class TOutputImage>
   TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::TotalVariationDenoisingImageFilter()
-    : m_Lambda(1.0), m_NumberIterations(0)
+    : m_Lambda(1.0),
+      m_NumberIterations(0),
+      m_UseFusedIterations(true),
+      m_Tolerance(0.0),
+      m_NumberOfPerformedIterations(0)
   {
+    m_Size.Fill(0);
+    std::fill(m_Strides, m_Strides + OutputImageDimension + 1, 0);
+  }
+
+  template <class TInputImage, class TOutputImage>
+  void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::GenerateInputRequestedRegion()
+  {
+    Superclass::GenerateInputRequestedRegion();
+
+    auto input = const_cast<InputImageType *>(this->GetInput());
+    if (input != nullptr)
+    {
+      input->SetRequestedRegionToLargestPossibleRegion();
+    }
+  }
+
+  template <class TInputImage, class TOutputImage>
+  void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::EnlargeOutputRequestedRegion(DataObject *output)
+  {
+    Superclass::EnlargeOutputRequestedRegion(output);
+    output->SetRequestedRegionToLargestPossibleRegion();
   }
 
   template <class TInputImage, class TOutputImage>
   void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::GenerateData()
+  {
+    // the fused iterations slice the image along its outermost dimension
+    if (m_UseFusedIterations && OutputImageDimension > 1)
+    {
+      this->GenerateDataWithFusedIterations();
+    }
+    else
+    {
+      this->GenerateDataWithSingleIterationFilters();
+    }
+  }
+
+  template <class TInputImage, class TOutputImage>
+  void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::GenerateDataWithSingleIterationFilters()
   {
     // first we cast the input image to match output type
     typename CastType::Pointer infilter = CastType::New();
@@ -67,6 +109,7 @@ namespace itk
       image = filter->GetOutput();
       std::cout << "Iteration " << i + 1 << "/" << m_NumberIterations << std::endl;
     }
+    m_NumberOfPerformedIterations = std::max(m_NumberIterations, 0);
 
     typename OutputImageType::Pointer output = this->GetOutput();
     output->SetSpacing(image->GetSpacing());
@@ -91,6 +134,244 @@ namespace itk
     }
   }
 
+  template <class TInputImage, class TOutputImage>
+  void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::GenerateDataWithFusedIterations()
+  {
+    typename CastType::Pointer caster = CastType::New();
+    caster->SetInput(this->GetInput());
+    caster->Update();
+    typename OutputImageType::Pointer original = caster->GetOutput();
+
+    this->AllocateOutputs();
+    typename OutputImageType::Pointer output = this->GetOutput();
+    const OutputImageRegionType region = output->GetBufferedRegion();
+    const SizeValueType numberOfPixels = region.GetNumberOfPixels();
+    m_NumberOfPerformedIterations = 0;
+
+    if (numberOfPixels == 0 || m_NumberIterations <= 0)
+    {
+      std::copy(original->GetBufferPointer(), original->GetBufferPointer() + numberOfPixels, output->GetBufferPointer());
+      return;
+    }
+
+    m_Size = region.GetSize();
+    m_Strides[0] = 1;
+    for (unsigned int d = 0; d < OutputImageDimension; ++d)
+    {
+      m_Strides[d + 1] = m_Strides[d] * m_Size[d];
+    }
+
+    // the second buffer is only needed if more than one iteration is computed
+    typename OutputImageType::Pointer buffer;
+    OutputPixelType *buffers[2] = {output->GetBufferPointer(), nullptr};
+    if (m_NumberIterations > 1)
+    {
+      buffer = OutputImageType::New();
+      buffer->CopyInformation(output);
+      buffer->SetRegions(region);
+      buffer->Allocate();
+      buffers[1] = buffer->GetBufferPointer();
+    }
+
+    const SizeValueType numberOfSlices = m_Size[OutputImageDimension - 1];
+    const unsigned int numberOfThreads =
+      static_cast<unsigned int>(std::min<SizeValueType>(std::max(this->GetNumberOfThreads(), 1u), numberOfSlices));
+
+    // a few chunks per thread balance the load, every chunk computes the local variation of two extra slices
+    const SizeValueType slicesPerChunk = std::max<SizeValueType>(1, numberOfSlices / (4 * numberOfThreads));
+    const double squaredTolerance = m_Tolerance * m_Tolerance;
+
+    const OutputPixelType *input = original->GetBufferPointer();
+    for (int i = 0; i < m_NumberIterations; ++i)
+    {
+      OutputPixelType *result = buffers[i % 2];
+      std::atomic<SizeValueType> nextSlice(0);
+      std::vector<double> maximumChanges(numberOfThreads, 0.0);
+
+      auto worker = [&](unsigned int threadId) {
+        std::vector<float> localVariation;
+        for (SizeValueType first = nextSlice.fetch_add(slicesPerChunk); first < numberOfSlices;
+             first = nextSlice.fetch_add(slicesPerChunk))
+        {
+          const SizeValueType end = std::min(first + slicesPerChunk, numberOfSlices);
+          maximumChanges[threadId] = std::max(
+            maximumChanges[threadId],
+            this->ComputeIteration(original->GetBufferPointer(), input, result, first, end, localVariation));
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (unsigned int threadId = 1; threadId < numberOfThreads; ++threadId)
+      {
+        threads.emplace_back(worker, threadId);
+      }
+      worker(0);
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+
+      input = result;
+      ++m_NumberOfPerformedIterations;
+      this->UpdateProgress(static_cast<float>(i + 1) / m_NumberIterations);
+
+      if (*std::max_element(maximumChanges.begin(), maximumChanges.end()) <= squaredTolerance)
+      {
+        break;
+      }
+    }
+
+    if (input != output->GetBufferPointer())
+    {
+      std::copy(input, input + numberOfPixels, output->GetBufferPointer());
+    }
+  }
+
+  template <class TInputImage, class TOutputImage>
+  void TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::ComputeLocalVariation(
+    const OutputPixelType *input, SizeValueType slice, float *localVariation) const
+  {
+    const unsigned int dimension = OutputImageDimension;
+    const OffsetValueType sliceStride = m_Strides[dimension - 1];
+    const OffsetValueType rowLength = m_Size[0];
+    OffsetValueType lower[OutputImageDimension];
+    OffsetValueType upper[OutputImageDimension];
+
+    // the zero flux boundary condition replaces neighbours outside of the image by the pixel itself
+    auto localVariationAt = [&](const OutputPixelType *pixel) {
+      double variation = 0.0;
+      for (unsigned int d = 0; d < dimension; ++d)
+      {
+        variation += SquaredEuclideanMetric<OutputPixelType>::Calc(pixel[lower[d]] - pixel[0]);
+        variation += SquaredEuclideanMetric<OutputPixelType>::Calc(pixel[upper[d]] - pixel[0]);
+      }
+      return static_cast<float>(std::sqrt(variation + 0.0001));
+    };
+
+    for (OffsetValueType rowStart = 0; rowStart < sliceStride; rowStart += rowLength)
+    {
+      const OffsetValueType offset = slice * sliceStride + rowStart;
+      for (unsigned int d = 1; d < dimension; ++d)
+      {
+        const OffsetValueType index = (offset / m_Strides[d]) % static_cast<OffsetValueType>(m_Size[d]);
+        lower[d] = index > 0 ? -m_Strides[d] : 0;
+        upper[d] = index + 1 < static_cast<OffsetValueType>(m_Size[d]) ? m_Strides[d] : 0;
+      }
+
+      const OutputPixelType *row = input + offset;
+      float *localVariationRow = localVariation + rowStart;
+      for (OffsetValueType x = 0; x < rowLength; ++x)
+      {
+        lower[0] = x > 0 ? -1 : 0;
+        upper[0] = x + 1 < rowLength ? 1 : 0;
+        localVariationRow[x] = localVariationAt(row + x);
+      }
+    }
+  }
+
+  template <class TInputImage, class TOutputImage>
+  double TotalVariationDenoisingImageFilter<TInputImage, TOutputImage>::ComputeIteration(
+    const OutputPixelType *original,
+    const OutputPixelType *input,
+    OutputPixelType *output,
+    SizeValueType firstSlice,
+    SizeValueType endSlice,
+    std::vector<float> &localVariation) const
+  {
+    const unsigned int dimension = OutputImageDimension;
+    const SizeValueType numberOfSlices = m_Size[dimension - 1];
+    const OffsetValueType sliceStride = m_Strides[dimension - 1];
+    const OffsetValueType rowLength = m_Size[0];
+
+    // local variation of the previous, the current and the next slice
+    localVariation.resize(3 * sliceStride);
+    float *slices[3] = {&localVariation[0], &localVariation[sliceStride], &localVariation[2 * sliceStride]};
+
+    if (firstSlice > 0)
+    {
+      this->ComputeLocalVariation(input, firstSlice - 1, slices[0]);
+    }
+    this->ComputeLocalVariation(input, firstSlice, slices[1]);
+
+    const double lambda = m_Lambda;
+    double maximumChange = 0.0;
+    OffsetValueType lower[OutputImageDimension];
+    OffsetValueType upper[OutputImageDimension];
+    const float *lowerLocalVariation[OutputImageDimension];
+    const float *upperLocalVariation[OutputImageDimension];
+    double weights[2 * OutputImageDimension];
+
+    for (SizeValueType slice = firstSlice; slice < endSlice; ++slice)
+    {
+      const bool hasNextSlice = slice + 1 < numberOfSlices;
+      if (hasNextSlice)
+      {
+        this->ComputeLocalVariation(input, slice + 1, slices[2]);
+      }
+
+      for (OffsetValueType rowStart = 0; rowStart < sliceStride; rowStart += rowLength)
+      {
+        const OffsetValueType offset = slice * sliceStride + rowStart;
+        const float *localVariationRow = slices[1] + rowStart;
+
+        // neighbours in the same slice, then in the neighbouring slices
+        for (unsigned int d = 1; d + 1 < dimension; ++d)
+        {
+          const OffsetValueType index = (offset / m_Strides[d]) % static_cast<OffsetValueType>(m_Size[d]);
+          lower[d] = index > 0 ? -m_Strides[d] : 0;
+          upper[d] = index + 1 < static_cast<OffsetValueType>(m_Size[d]) ? m_Strides[d] : 0;
+          lowerLocalVariation[d] = localVariationRow + lower[d];
+          upperLocalVariation[d] = localVariationRow + upper[d];
+        }
+        if (dimension > 1)
+        {
+          lower[dimension - 1] = slice > 0 ? -sliceStride : 0;
+          upper[dimension - 1] = hasNextSlice ? sliceStride : 0;
+          lowerLocalVariation[dimension - 1] = (slice > 0 ? slices[0] : slices[1]) + rowStart;
+          upperLocalVariation[dimension - 1] = (hasNextSlice ? slices[2] : slices[1]) + rowStart;
+        }
+
+        const OutputPixelType *inputRow = input + offset;
+        const OutputPixelType *originalRow = original + offset;
+        OutputPixelType *outputRow = output + offset;
+        for (OffsetValueType x = 0; x < rowLength; ++x)
+        {
+          lower[0] = x > 0 ? -1 : 0;
+          upper[0] = x + 1 < rowLength ? 1 : 0;
+          lowerLocalVariation[0] = localVariationRow + lower[0];
+          upperLocalVariation[0] = localVariationRow + upper[0];
+
+          // w_alphabeta(u) = 1 / ||nabla_alpha(u)||_a + 1 / ||nabla_beta(u)||_a
+          const double inverseLocalVariation = 1.0 / localVariationRow[x];
+          double weightSum = 0.0;
+          for (unsigned int d = 0; d < dimension; ++d)
+          {
+            weights[2 * d] = inverseLocalVariation + 1.0 / static_cast<double>(lowerLocalVariation[d][x]);
+            weights[2 * d + 1] = inverseLocalVariation + 1.0 / static_cast<double>(upperLocalVariation[d][x]);
+            weightSum += weights[2 * d] + weights[2 * d + 1];
+          }
+
+          // h_alphaalpha * u_alpha^zero + sum of h_alphabeta * u_beta
+          const double normalization = 1.0 / (lambda + weightSum);
+          OutputPixelType result = static_cast<OutputPixelType>(originalRow[x] * (lambda * normalization));
+          for (unsigned int d = 0; d < dimension; ++d)
+          {
+            result += inputRow[x + lower[d]] * (weights[2 * d] * normalization);
+            result += inputRow[x + upper[d]] * (weights[2 * d + 1] * normalization);
+          }
+
+          maximumChange =
+            std::max(maximumChange, SquaredEuclideanMetric<OutputPixelType>::Calc(result - inputRow[x]));
+          outputRow[x] = result;
+        }
+      }
+
+      std::rotate(slices, slices + 1, slices + 3);
+    }
+
+    return maximumChange;
+  }
+
   /**
   * Standard "PrintSelf" method
   */
@@ -98,6 +379,10 @@ namespace itk
   void TotalVariationDenoisingImageFilter<TInputImage, TOutput>::PrintSelf(std::ostream &os, Indent indent) const
   {
     Superclass::PrintSelf(os, indent);
+    os << indent << "Lambda: " << m_Lambda << std::endl;
+    os << indent << "NumberIterations: " << m_NumberIterations << std::endl;
+    os << indent << "UseFusedIterations: " << m_UseFusedIterations << std::endl;
+    os << indent << "Tolerance: " << m_Tolerance << std::endl;
   }
 
 } // end namespace itk
@@ -30,6 +30,8 @@ found in the LICENSE file.
 #include <time.h>
 #include <thread>
 #include <chrono>
+#include <limits>
+#include <algorithm>
 
 #include <vector>
 #include <iostream>
@@ -46,6 +48,7 @@ found in the LICENSE file.
 #include <mitkPAProbe.h>
 #include <mitkPALightSource.h>
 #include <mitkPAMonteCarloThreadHandler.h>
+#include <mitkPAPhotonTransportEngine.h>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -611,6 +614,9 @@ public:
 /* DECLARE FUNCTIONS */
 
 void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thread, mitk::pa::MonteCarloThreadHandler::Pointer threadHandler);
+void launchPhoton(const InputValues* inputValues, const double* rnd, mitk::pa::PhotonTransportEngine::Photon& photon);
+mitk::pa::PhotonTransportEngine::Pointer createTransportEngine(const InputValues* inputValues);
+void runBenchmark(InputValues* inputValues);
 
 int detector_x = -1;
 int detector_z = -1;
@@ -624,6 +630,10 @@ bool saveLegacy = false;
 std::string normalizationFilename;
 std::string inputFilename;
 std::string outputFilename;
+bool useTransportEngine = false;
+bool benchmark = false;
+bool seedGiven = false;
+unsigned long long seed = 0;
 
 mitk::pa::Probe::Pointer m_PhotoacousticProbe;
 
@@ -676,6 +686,15 @@ int main(int argc, char * argv[]) {
     "Xml definition of the probe", "Specifies the absolute path of the location of the xml definition file of the probe design.", us::Any(), true, false, false, mitkCommandLineParser::Input);
   parser.addArgument("normalization-file", "nf", mitkCommandLineParser::File,
     "Input normalization file", "The input normalization file is used for normalization of the number of photons in the PVFC calculations.", us::Any(), true, false, false, mitkCommandLineParser::Input);
+  parser.addArgument(
+    "batched", "b", mitkCommandLineParser::Bool,
+    "Batched transport engine", "Propagates batches of photons with a counter-based random number generator. The result only depends on the seed and the number of photons, not on the number of jobs. Not available for PVFC calculations.");
+  parser.addArgument(
+    "seed", "s", mitkCommandLineParser::Int,
+    "Random seed", "Seed of the batched transport engine (default: derived from the current time).");
+  parser.addArgument(
+    "benchmark", "bm", mitkCommandLineParser::Bool,
+    "Benchmark", "Simulates the requested number of photons with the legacy and the batched implementation, reports photons per second and exits without saving.");
   parser.endGroup();
 
   // parse arguments, this method returns a mapping of long argument names and their values
@@ -740,6 +759,19 @@ int main(int argc, char * argv[]) {
   {
     normalizationFilename = us::any_cast<std::string>(parsedArgs["normalization-file"]);
   }
+  if (parsedArgs.count("batched"))
+  {
+    useTransportEngine = us::any_cast<bool>(parsedArgs["batched"]);
+  }
+  if (parsedArgs.count("seed"))
+  {
+    seed = static_cast<unsigned int>(us::any_cast<int>(parsedArgs["seed"]));
+    seedGiven = true;
+  }
+  if (parsedArgs.count("benchmark"))
+  {
+    benchmark = us::any_cast<bool>(parsedArgs["benchmark"]);
+  }
 
   if (concurentThreadsSupported == 0 || concurentThreadsSupported == -1)
   {
@@ -763,9 +795,25 @@ int main(int argc, char * argv[]) {
       std::cout << "Will not perform PVFC calculation due to x=" << detector_x << " and/or z=" << detector_z << std::endl;
   }
 
+  if (simulatePVFC && (useTransportEngine || benchmark))
+  {
+    std::cout << "The batched transport engine does not support PVFC calculations. Using the legacy implementation." << std::endl;
+    useTransportEngine = false;
+    benchmark = false;
+  }
+
+  if (!seedGiven)
+    seed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
   InputValues allInput = InputValues();
   allInput.LoadValues(inputFilename, yOffset, normalizationFilename, simulatePVFC);
 
+  if (benchmark)
+  {
+    runBenchmark(&allInput);
+    exit(EXIT_SUCCESS);
+  }
+
   std::vector<ReturnValues> allValues(concurentThreadsSupported);
   auto* threads = new std::thread[concurentThreadsSupported];
 
@@ -799,14 +847,28 @@ int main(int argc, char * argv[]) {
 
   auto simulationStartTime = std::chrono::system_clock::now();
 
-  for (int i = 0; i < concurentThreadsSupported; i++)
+  mitk::pa::PhotonTransportEngine::Pointer transportEngine;
+
+  if (useTransportEngine)
   {
-    threads[i] = std::thread(runMonteCarlo, &allInput, &allValues[i], (i + 1), threadHandler);
+    if (verbose) std::cout << "Using the batched transport engine with seed " << seed << std::endl;
+    transportEngine = createTransportEngine(&allInput);
+    if (interpretAsTime)
+      transportEngine->Simulate(std::numeric_limits<long long>::max(), timeMetric);
+    else
+      transportEngine->Simulate(timeMetric);
   }
-
-  for (int i = 0; i < concurentThreadsSupported; i++)
+  else
   {
-    threads[i].join();
+    for (int i = 0; i < concurentThreadsSupported; i++)
+    {
+      threads[i] = std::thread(runMonteCarlo, &allInput, &allValues[i], (i + 1), threadHandler);
+    }
+
+    for (int i = 0; i < concurentThreadsSupported; i++)
+    {
+      threads[i].join();
+    }
   }
 
   auto simulationFinishTime = std::chrono::system_clock::now();
@@ -832,16 +894,21 @@ int main(int argc, char * argv[]) {
     if (verbose) std::cout << "[OK]" << std::endl;
 
     if (verbose) std::cout << "Calculating resulting fluence ... ";
-    double tdx = 0, tdy = 0, tdz = 0;
+    double tdx = allInput.xSpacing, tdy = allInput.ySpacing, tdz = allInput.zSpacing;
     long long tNphotons = 0;
-    for (int t = 0; t < concurentThreadsSupported; t++)
+    if (useTransportEngine)
     {
-      tdx = allInput.xSpacing;
-      tdy = allInput.ySpacing;
-      tdz = allInput.zSpacing;
-      tNphotons += allValues[t].Nphotons;
-      for (int voxelNumber = 0; voxelNumber < allInput.totalNumberOfVoxels; voxelNumber++) {
-        finalTotalFluence[voxelNumber] += allValues[t].totalFluence[voxelNumber];
+      tNphotons = transportEngine->GetNumberOfSimulatedPhotons();
+      std::copy(transportEngine->GetAbsorbedWeight().begin(), transportEngine->GetAbsorbedWeight().end(), finalTotalFluence);
+    }
+    else
+    {
+      for (int t = 0; t < concurentThreadsSupported; t++)
+      {
+        tNphotons += allValues[t].Nphotons;
+        for (int voxelNumber = 0; voxelNumber < allInput.totalNumberOfVoxels; voxelNumber++) {
+          finalTotalFluence[voxelNumber] += allValues[t].totalFluence[voxelNumber];
+        }
       }
     }
     if (verbose) std::cout << "[OK]" << std::endl;
@@ -877,6 +944,13 @@ int main(int argc, char * argv[]) {
     resultImage->GetPropertyList()->SetFloatProperty("y-offset", yOffset);
     mitk::CoreServices::GetPropertyPersistence()->AddInfo(mitk::PropertyPersistenceInfo::New("y-offset"));
 
+    if (useTransportEngine)
+    {
+      // the seed and the number of photons reproduce the result exactly
+      resultImage->GetPropertyList()->SetStringProperty("seed", std::to_string(seed).c_str());
+      mitk::CoreServices::GetPropertyPersistence()->AddInfo(mitk::PropertyPersistenceInfo::New("seed"));
+    }
+
     mitk::IOUtil::Save(resultImage, outputFilename);
 
     if (verbose) std::cout << "[OK]" << std::endl;
@@ -1468,3 +1542,131 @@ void runMonteCarlo(InputValues* inputValues, ReturnValues* returnValue, int thre
   if (verbose) std::cout << "------------------------------------------------------" << std::endl;
   if (verbose) std::cout << "Thread " << thread << " is finished." << std::endl;
 }
+
+/* Photon launch of runMonteCarlo for the batched transport engine. The random numbers are in (0, 1]. */
+void launchPhoton(const InputValues* inputValues, const double* rnd, mitk::pa::PhotonTransportEngine::Photon& photon)
+{
+  double r, phi, temp;
+
+  if (m_PhotoacousticProbe.IsNotNull())
+  {
+    mitk::pa::LightSource::PhotonInformation info = m_PhotoacousticProbe->GetNextPhoton(rnd[0], rnd[1], rnd[2], rnd[3], rnd[4], rnd[5], rnd[6], rnd[7]);
+    photon.X = info.xPosition;
+    photon.Y = yOffset + info.yPosition;
+    photon.Z = info.zPosition;
+    photon.DirectionX = info.xAngle;
+    photon.DirectionY = info.yAngle;
+    photon.DirectionZ = info.zAngle;
+  }
+  else if (inputValues->launchflag == 1) // manually set launch
+  {
+    photon.X = inputValues->xs;
+    photon.Y = inputValues->ys;
+    photon.Z = inputValues->zs;
+    photon.DirectionX = inputValues->ux0;
+    photon.DirectionY = inputValues->uy0;
+    photon.DirectionZ = inputValues->uz0;
+  }
+  else if (inputValues->mcflag == 0) // uniform beam
+  {
+    // set launch point and width of beam
+    r = inputValues->radius*sqrt(rnd[0]); // radius of beam at launch point
+    phi = rnd[1] * 2.0*PI;
+    photon.X = inputValues->xs + r*cos(phi);
+    photon.Y = inputValues->ys + r*sin(phi);
+    photon.Z = inputValues->zs;
+    // set trajectory toward focus
+    r = inputValues->waist*sqrt(rnd[2]); // radius of beam at focus
+    phi = rnd[3] * 2.0*PI;
+    double xfocus = r*cos(phi);
+    double yfocus = r*sin(phi);
+    temp = sqrt((photon.X - xfocus)*(photon.X - xfocus)
+      + (photon.Y - yfocus)*(photon.Y - yfocus) + inputValues->zfocus*inputValues->zfocus);
+    photon.DirectionX = -(photon.X - xfocus) / temp;
+    photon.DirectionY = -(photon.Y - yfocus) / temp;
+    photon.DirectionZ = sqrt(1 - photon.DirectionX*photon.DirectionX + photon.DirectionY*photon.DirectionY);
+  }
+  else if (inputValues->mcflag == 5 || inputValues->mcflag == 4) // Multispectral / monospectral DKFZ prototype
+  {
+    double yDistance = inputValues->mcflag == 5 ? 1.5 : 0.83;
+    double angle = inputValues->mcflag == 5 ? 0.436 : 0.375;
+
+    //offset in x direction in cm (random)
+    photon.X = (rnd[0] * 2.5) - 1.25;
+    double b = ((rnd[1]) - 0.5);
+    photon.Y = (b > 0 ? yOffset + yDistance : yOffset - yDistance);
+    photon.Z = 0.1;
+    //Angle of beam in y direction
+    photon.DirectionY = sin((rnd[2] * 0.42) - 0.21 + (b < 0 ? 1.0 : -1.0) * angle);
+    // angle of beam in x direction
+    photon.DirectionX = sin((rnd[3] * 0.42) - 0.21);
+    photon.DirectionZ = sqrt(1 - photon.DirectionX*photon.DirectionX - photon.DirectionY*photon.DirectionY);
+  }
+  else // isotropic pt source
+  {
+    double costheta = 1.0 - 2.0 * rnd[0];
+    double sintheta = sqrt(1.0 - costheta*costheta);
+    double psi = 2.0 * PI * rnd[1];
+    double cospsi = cos(psi);
+    double sinpsi = psi < PI ? sqrt(1.0 - cospsi*cospsi) : -sqrt(1.0 - cospsi*cospsi);
+    photon.X = inputValues->xs;
+    photon.Y = inputValues->ys;
+    photon.Z = inputValues->zs;
+    photon.DirectionX = sintheta*cospsi;
+    photon.DirectionY = sintheta*sinpsi;
+    photon.DirectionZ = costheta;
+  }
+}
+
+mitk::pa::PhotonTransportEngine::Pointer createTransportEngine(const InputValues* inputValues)
+{
+  mitk::pa::PhotonTransportEngine::Medium medium;
+  medium.NumberOfVoxelsX = inputValues->Nx;
+  medium.NumberOfVoxelsY = inputValues->Ny;
+  medium.NumberOfVoxelsZ = inputValues->Nz;
+  medium.SpacingX = inputValues->xSpacing;
+  medium.SpacingY = inputValues->ySpacing;
+  medium.SpacingZ = inputValues->zSpacing;
+  medium.Absorption = inputValues->muaVector;
+  medium.Scattering = inputValues->musVector;
+  medium.Anisotropy = inputValues->gVector;
+  medium.BoundaryFlag = inputValues->boundaryflag;
+
+  auto engine = mitk::pa::PhotonTransportEngine::New();
+  engine->SetMedium(medium);
+  engine->SetSeed(seed);
+  engine->SetNumberOfThreads(concurentThreadsSupported);
+  engine->SetLaunchFunction([inputValues](const double* rnd, mitk::pa::PhotonTransportEngine::Photon& photon) {
+    launchPhoton(inputValues, rnd, photon);
+  });
+
+  return engine;
+}
+
+/* Simulates the requested number of photons with both implementations and reports their throughput. */
+void runBenchmark(InputValues* inputValues)
+{
+  std::cout << "Benchmarking " << requestedNumberOfPhotons << " photons with " << concurentThreadsSupported << " threads" << std::endl;
+
+  std::vector<ReturnValues> returnValues(concurentThreadsSupported);
+  std::vector<std::thread> threads;
+  auto threadHandler = mitk::pa::MonteCarloThreadHandler::New(requestedNumberOfPhotons, false, false);
+
+  auto startTime = std::chrono::steady_clock::now();
+  for (int i = 0; i < concurentThreadsSupported; i++)
+    threads.emplace_back(runMonteCarlo, inputValues, &returnValues[i], (i + 1), threadHandler);
+  for (auto& thread : threads)
+    thread.join();
+  double legacySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+  for (auto& returnValue : returnValues)
+    free(returnValue.totalFluence);
+
+  auto engine = createTransportEngine(inputValues);
+  engine->Simulate(requestedNumberOfPhotons);
+
+  double legacyPhotonsPerSecond = requestedNumberOfPhotons / legacySeconds;
+  std::cout << "legacy implementation:  " << legacyPhotonsPerSecond << " photons/s" << std::endl;
+  std::cout << "batched implementation: " << engine->GetPhotonsPerSecond() << " photons/s (speedup "
+    << engine->GetPhotonsPerSecond() / legacyPhotonsPerSecond << "x)" << std::endl;
+}
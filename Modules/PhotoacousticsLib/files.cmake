@@ -15,6 +15,8 @@ SET(H_FILES
   include/mitkPALightSource.h
   include/mitkPAIOUtil.h
   include/mitkPAMonteCarloThreadHandler.h
+  include/mitkPAPhotonTransportEngine.h
+  include/mitkPAPhiloxRandomGenerator.h
   include/mitkPASimulationBatchGenerator.h
   include/mitkPAFluenceYOffsetPair.h
   include/mitkPAVolumeManipulator.h
@@ -51,6 +53,7 @@ set(CPP_FILES
   Utils/ProbeDesign/mitkPAProbe.cpp
   Utils/ProbeDesign/mitkPALightSource.cpp
   Utils/Thread/mitkPAMonteCarloThreadHandler.cpp
+  Utils/Thread/mitkPAPhotonTransportEngine.cpp
   SUFilter/mitkPASpectralUnmixingFilterBase.cpp
   SUFilter/mitkPALinearSpectralUnmixingFilter.cpp
   SUFilter/mitkPASpectralUnmixingSO2.cpp
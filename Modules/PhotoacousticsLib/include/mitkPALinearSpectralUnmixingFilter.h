@@ -92,6 +92,15 @@ namespace mitk {
       Eigen::VectorXf SpectralUnmixingAlgorithm(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix,
         Eigen::VectorXf inputVector) override;
 
+      /**
+      * \brief All algorithms of this class solve a linear system, so the solution depends linearly on the input vector. The
+      * unmixing matrix is obtained by solving for the unit vectors with the decomposition of the endmember matrix, which is
+      * therefore computed only once per image.
+      * @throws if one chooses the ldlt/llt solver and the endmember matrix is not positive definite
+      */
+      bool CalculateUnmixingMatrix(const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix,
+        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix) override;
+
     private:
       AlgortihmType algorithmName;
     };
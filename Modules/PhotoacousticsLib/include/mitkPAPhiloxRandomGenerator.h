@@ -0,0 +1,71 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKPHILOXRANDOMGENERATOR_H
+#define MITKPHILOXRANDOMGENERATOR_H
+
+#include <array>
+#include <cstdint>
+
+namespace mitk {
+  namespace pa {
+    /**
+     * @brief Counter-based random number generator Philox4x32-10 (Salmon et al., "Parallel random numbers:
+     * as easy as 1, 2, 3", SC 2011).
+     *
+     * The generator has no state: four 32 bit random numbers are computed from a 128 bit counter and a 64 bit
+     * key. If the counter is derived from the identity of the requesting object (e.g. photon index and step),
+     * the numbers do not depend on the order in which the objects are processed, i.e. on the number of threads.
+     */
+    class PhiloxRandomGenerator
+    {
+    public:
+      typedef std::array<std::uint32_t, 4> CounterType;
+      typedef std::array<std::uint32_t, 2> KeyType;
+
+      static KeyType MakeKey(std::uint64_t seed)
+      {
+        return { { static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) } };
+      }
+
+      static CounterType Generate(CounterType counter, KeyType key)
+      {
+        for (int round = 0; round < 10; ++round)
+        {
+          if (round > 0)
+          {
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+          }
+
+          const std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+          const std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+
+          counter = { { static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                        static_cast<std::uint32_t>(product1),
+                        static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                        static_cast<std::uint32_t>(product0) } };
+        }
+
+        return counter;
+      }
+
+      /** @brief Maps a 32 bit random number to the interval (0, 1]. */
+      static double ToUniform(std::uint32_t value)
+      {
+        return (static_cast<double>(value) + 1.0) * (1.0 / 4294967296.0);
+      }
+    };
+  }
+}
+
+#endif // MITKPHILOXRANDOMGENERATOR_H
@@ -0,0 +1,136 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKPHOTONTRANSPORTENGINE_H
+#define MITKPHOTONTRANSPORTENGINE_H
+
+#include <MitkPhotoacousticsLibExports.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//Includes for smart pointer usage
+#include "mitkCommon.h"
+#include "itkLightObject.h"
+
+namespace mitk {
+  namespace pa {
+    /**
+     * @brief The PhotonTransportEngine class
+     * Monte Carlo photon transport through a voxelized medium following the hop-drop-spin scheme of mcxyz
+     * (Jacques and Li).
+     *
+     * Photons are propagated in batches of BatchWidth lanes that are stored as structure of arrays, so the
+     * per-lane loops (random number generation, step sampling, scattering) can be vectorized by the compiler.
+     * A lane whose photon died is refilled with the next photon of the current work package.
+     *
+     * All random numbers are taken from a Philox counter-based generator keyed with the seed, the counter
+     * being the photon index and the step count. Each thread accumulates into its own grid using fixed point
+     * arithmetic and the grids are summed at the end, so the result for a given seed and number of photons
+     * is bit-identical for any number of threads.
+     */
+    class MITKPHOTOACOUSTICSLIB_EXPORT PhotonTransportEngine : public itk::LightObject
+    {
+    public:
+
+      mitkClassMacroItkParent(PhotonTransportEngine, itk::LightObject);
+      itkFactorylessNewMacro(Self);
+
+      static const unsigned int BatchWidth = 8;
+
+      /**
+       * @brief Optical properties of the medium. The arrays are indexed as
+       * z * NumberOfVoxelsY * NumberOfVoxelsX + x * NumberOfVoxelsY + y and must outlive the simulation.
+       * The spacing is given in cm.
+       */
+      struct Medium
+      {
+        int NumberOfVoxelsX = 0;
+        int NumberOfVoxelsY = 0;
+        int NumberOfVoxelsZ = 0;
+        double SpacingX = 1;
+        double SpacingY = 1;
+        double SpacingZ = 1;
+        const double* Absorption = nullptr;
+        const double* Scattering = nullptr;
+        const double* Anisotropy = nullptr;
+        /** @brief 0 = infinite medium, 1 = escape at all boundaries, 2 = escape at the top surface only */
+        int BoundaryFlag = 1;
+      };
+
+      struct Photon
+      {
+        double X = 0;
+        double Y = 0;
+        double Z = 0;
+        double DirectionX = 0;
+        double DirectionY = 0;
+        double DirectionZ = 1;
+      };
+
+      /**
+       * @brief Initializes a new photon from NumberOfLaunchRandomNumbers random numbers in (0, 1].
+       * Called concurrently from all threads.
+       */
+      typedef std::function<void(const double* randomNumbers, Photon& photon)> LaunchFunctionType;
+      static const unsigned int NumberOfLaunchRandomNumbers = 8;
+
+      void SetMedium(const Medium& medium);
+      const Medium& GetMedium() const;
+
+      void SetLaunchFunction(const LaunchFunctionType& launchFunction);
+
+      itkSetMacro(Seed, std::uint64_t);
+      itkGetMacro(Seed, std::uint64_t);
+
+      /** @brief Number of threads, 0 uses all available cores (default). */
+      itkSetMacro(NumberOfThreads, unsigned int);
+      itkGetMacro(NumberOfThreads, unsigned int);
+
+      /** @brief Number of photons a thread takes at once. Does not affect the result. */
+      itkSetMacro(PackageSize, unsigned long);
+      itkGetMacro(PackageSize, unsigned long);
+
+      /**
+       * @brief Simulates the photons with the indices [0, numberOfPhotons). If timeLimitInMilliseconds is
+       * greater than 0, no further work packages are started after that time.
+       * @return the number of simulated photons.
+       */
+      unsigned long long Simulate(unsigned long long numberOfPhotons, long timeLimitInMilliseconds = 0);
+
+      /**
+       * @brief Photon weight absorbed in each voxel during the last simulation (same indexing as the medium).
+       * Weight absorbed outside the volume (boundary flags 0 and 2) is not recorded.
+       */
+      const std::vector<double>& GetAbsorbedWeight() const;
+
+      itkGetConstMacro(NumberOfSimulatedPhotons, unsigned long long);
+      itkGetConstMacro(PhotonsPerSecond, double);
+
+    protected:
+      PhotonTransportEngine();
+      ~PhotonTransportEngine() override;
+
+      Medium m_Medium;
+      LaunchFunctionType m_LaunchFunction;
+      std::uint64_t m_Seed;
+      unsigned int m_NumberOfThreads;
+      unsigned long m_PackageSize;
+      std::vector<double> m_AbsorbedWeight;
+      unsigned long long m_NumberOfSimulatedPhotons;
+      double m_PhotonsPerSecond;
+    };
+  }
+}
+
+#endif // MITKPHOTONTRANSPORTENGINE_H
@@ -106,6 +106,13 @@ namespace mitk {
       */
       virtual void AddRelativeErrorSettings(int value);
 
+      /*
+      * \brief BatchedUnmixing enables the unmixing of whole images by one matrix product if the subclass provides an unmixing
+      * matrix (see CalculateUnmixingMatrix). Default value is true. If false every pixel is unmixed by SpectralUnmixingAlgorithm.
+      * @param batched is the boolian to activate the batched unmixing
+      */
+      virtual void BatchedUnmixing(bool batched);
+
       ofstream myfile; // just for testing purposes; has to be removeed
 
     protected:
@@ -126,8 +133,23 @@ namespace mitk {
       virtual Eigen::VectorXf SpectralUnmixingAlgorithm(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix,
         Eigen::VectorXf inputVector) = 0;
 
+      /**
+      * \brief Subclasses whose algorithm is linear in the input vector override this method to provide the matrix mapping the
+      * multispectral values of a pixel to the unmixing result, i.e. SpectralUnmixingAlgorithm(endmemberMatrix, v) == unmixingMatrix * v.
+      * The matrix is calculated once and all pixels of a sequence are unmixed by a single matrix product, distributed over all
+      * available cores. The default implementation returns false, so that constrained algorithms (e.g. Simplex, Vigra) are called
+      * for every pixel.
+      * @param endmemberMatrix Matrix with number of chromophores colums and number of wavelengths rows (see SpectralUnmixingAlgorithm)
+      * @param unmixingMatrix Matrix with number of chromophores rows and number of wavelengths colums
+      * @return true if unmixingMatrix was set
+      * @throws if the algorithm can not be applied to the endmember matrix
+      */
+      virtual bool CalculateUnmixingMatrix(const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix,
+        Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix);
+
       bool m_Verbose = false;
       bool m_RelativeError = false;
+      bool m_BatchedUnmixing = true;
 
       std::vector<mitk::pa::PropertyCalculator::ChromophoreType> m_Chromophore;
       std::vector<int> m_Wavelength;
@@ -187,6 +209,15 @@ namespace mitk {
       float CalculateRelativeError(Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> endmemberMatrix,
         Eigen::VectorXf inputVector, Eigen::VectorXf resultVector);
 
+      /*
+      * \brief Unmixes all sequences with the unmixing matrix. The pixels are split into blocks which are processed in parallel.
+      * Each block is unmixed by one matrix product of the block (pixels x wavelengths) and the transposed unmixing matrix.
+      */
+      void GenerateDataBatched(const float* inputDataArray, const std::vector<float*>& writeBufferVector,
+        unsigned int numberOfPixels, unsigned int totalNumberOfSequences,
+        const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix,
+        const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix);
+
       PropertyCalculator::Pointer m_PropertyCalculatorEigen;
     };
   }
@@ -78,3 +78,45 @@ Eigen::VectorXf mitk::pa::LinearSpectralUnmixingFilter::SpectralUnmixingAlgorith
 
   return resultVector;
 }
+
+bool mitk::pa::LinearSpectralUnmixingFilter::CalculateUnmixingMatrix(
+  const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix, Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix)
+{
+  // column i of the unmixing matrix is the solution for the i-th unit vector
+  const Eigen::MatrixXf identity = Eigen::MatrixXf::Identity(endmemberMatrix.rows(), endmemberMatrix.rows());
+
+  if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::HOUSEHOLDERQR == algorithmName)
+    unmixingMatrix = endmemberMatrix.householderQr().solve(identity);
+
+  else if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::LDLT == algorithmName)
+  {
+    Eigen::LLT<Eigen::MatrixXf> lltOfA(endmemberMatrix);
+    if (lltOfA.info() == Eigen::NumericalIssue)
+      mitkThrow() << "Possibly non semi-positive definitie endmembermatrix!";
+    unmixingMatrix = endmemberMatrix.ldlt().solve(identity);
+  }
+
+  else if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::LLT == algorithmName)
+  {
+    Eigen::LLT<Eigen::MatrixXf> lltOfA(endmemberMatrix);
+    if (lltOfA.info() == Eigen::NumericalIssue)
+      mitkThrow() << "Possibly non semi-positive definitie endmembermatrix!";
+    unmixingMatrix = lltOfA.solve(identity);
+  }
+
+  else if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::COLPIVHOUSEHOLDERQR == algorithmName)
+    unmixingMatrix = endmemberMatrix.colPivHouseholderQr().solve(identity);
+
+  else if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::JACOBISVD == algorithmName)
+    unmixingMatrix = endmemberMatrix.jacobiSvd(Eigen::ComputeFullU | Eigen::ComputeFullV).solve(identity);
+
+  else if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::FULLPIVLU == algorithmName)
+    unmixingMatrix = endmemberMatrix.fullPivLu().solve(identity);
+
+  else if (mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::FULLPIVHOUSEHOLDERQR == algorithmName)
+    unmixingMatrix = endmemberMatrix.fullPivHouseholderQr().solve(identity);
+  else
+    mitkThrow() << "404 VIGRA ALGORITHM NOT FOUND";
+
+  return true;
+}
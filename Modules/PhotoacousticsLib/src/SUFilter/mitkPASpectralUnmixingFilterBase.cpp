@@ -20,6 +20,10 @@ found in the LICENSE file.
 #include <mitkImageReadAccessor.h>
 #include <mitkImageWriteAccessor.h>
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 mitk::pa::SpectralUnmixingFilterBase::SpectralUnmixingFilterBase()
 {
   m_PropertyCalculatorEigen = mitk::pa::PropertyCalculator::New();
@@ -64,6 +68,17 @@ void mitk::pa::SpectralUnmixingFilterBase::AddRelativeErrorSettings(int value)
   m_RelativeErrorSettings.push_back(value);
 }
 
+void mitk::pa::SpectralUnmixingFilterBase::BatchedUnmixing(bool batched)
+{
+  m_BatchedUnmixing = batched;
+}
+
+bool mitk::pa::SpectralUnmixingFilterBase::CalculateUnmixingMatrix(const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& /*endmemberMatrix*/,
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& /*unmixingMatrix*/)
+{
+  return false;
+}
+
 void mitk::pa::SpectralUnmixingFilterBase::GenerateData()
 {
   MITK_INFO(m_Verbose) << "GENERATING DATA..";
@@ -110,38 +125,47 @@ void mitk::pa::SpectralUnmixingFilterBase::GenerateData()
     outputCounter -= 1;
   }
 
-  for (unsigned int sequenceCounter = 0; sequenceCounter < totalNumberOfSequences; ++sequenceCounter)
+  Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> unmixingMatrix;
+  if (m_BatchedUnmixing && CalculateUnmixingMatrix(endmemberMatrix, unmixingMatrix))
+  {
+    MITK_INFO(m_Verbose) << "BATCHED UNMIXING";
+    GenerateDataBatched(inputDataArray, writteBufferVector, xDim*yDim, totalNumberOfSequences, endmemberMatrix, unmixingMatrix);
+  }
+  else
   {
-    MITK_INFO(m_Verbose) << "SequenceCounter: " << sequenceCounter;
-    //loop over every pixel in XY-plane
-    for (unsigned int x = 0; x < xDim; x++)
+    for (unsigned int sequenceCounter = 0; sequenceCounter < totalNumberOfSequences; ++sequenceCounter)
     {
-      for (unsigned int y = 0; y < yDim; y++)
+      MITK_INFO(m_Verbose) << "SequenceCounter: " << sequenceCounter;
+      //loop over every pixel in XY-plane
+      for (unsigned int x = 0; x < xDim; x++)
       {
-        Eigen::VectorXf inputVector(sequenceSize);
-        for (unsigned int z = 0; z < sequenceSize; z++)
+        for (unsigned int y = 0; y < yDim; y++)
         {
-          /**
-          * 'sequenceCounter*sequenceSize' has to be added to 'z' to ensure that one accesses the
-          * correct pixel, because the inputDataArray contains the information of all sequences and
-          * not just the one of the current sequence.
-          */
-          unsigned int pixelNumber = (xDim*yDim*(z+sequenceCounter*sequenceSize)) + x * yDim + y;
-          auto pixel = inputDataArray[pixelNumber];
-
-          inputVector[z] = pixel;
-        }
-        Eigen::VectorXf resultVector = SpectralUnmixingAlgorithm(endmemberMatrix, inputVector);
-
-        if (m_RelativeError == true)
-        {
-          float relativeError = CalculateRelativeError(endmemberMatrix, inputVector, resultVector);
-          writteBufferVector[outputCounter][(xDim*yDim * sequenceCounter) + x * yDim + y] = relativeError;
-        }
-
-        for (unsigned int outputIdx = 0; outputIdx < outputCounter; ++outputIdx)
-        {
-          writteBufferVector[outputIdx][(xDim*yDim * sequenceCounter) + x * yDim + y] = resultVector[outputIdx];
+          Eigen::VectorXf inputVector(sequenceSize);
+          for (unsigned int z = 0; z < sequenceSize; z++)
+          {
+            /**
+            * 'sequenceCounter*sequenceSize' has to be added to 'z' to ensure that one accesses the
+            * correct pixel, because the inputDataArray contains the information of all sequences and
+            * not just the one of the current sequence.
+            */
+            unsigned int pixelNumber = (xDim*yDim*(z+sequenceCounter*sequenceSize)) + x * yDim + y;
+            auto pixel = inputDataArray[pixelNumber];
+
+            inputVector[z] = pixel;
+          }
+          Eigen::VectorXf resultVector = SpectralUnmixingAlgorithm(endmemberMatrix, inputVector);
+
+          if (m_RelativeError == true)
+          {
+            float relativeError = CalculateRelativeError(endmemberMatrix, inputVector, resultVector);
+            writteBufferVector[outputCounter][(xDim*yDim * sequenceCounter) + x * yDim + y] = relativeError;
+          }
+
+          for (unsigned int outputIdx = 0; outputIdx < outputCounter; ++outputIdx)
+          {
+            writteBufferVector[outputIdx][(xDim*yDim * sequenceCounter) + x * yDim + y] = resultVector[outputIdx];
+          }
         }
       }
     }
@@ -233,3 +257,71 @@ float mitk::pa::SpectralUnmixingFilterBase::CalculateRelativeError(Eigen::Matrix
   }
   return relativeError;
 }
+
+void mitk::pa::SpectralUnmixingFilterBase::GenerateDataBatched(const float* inputDataArray, const std::vector<float*>& writeBufferVector,
+  unsigned int numberOfPixels, unsigned int totalNumberOfSequences,
+  const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& endmemberMatrix,
+  const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>& unmixingMatrix)
+{
+  typedef Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic>, 0, Eigen::OuterStride<>> InputBlockType;
+
+  const unsigned int sequenceSize = m_Wavelength.size();
+  const unsigned int numberOfChromophores = unmixingMatrix.rows();
+  const unsigned int blockSize = 4096;
+  const unsigned int blocksPerSequence = (numberOfPixels + blockSize - 1) / blockSize;
+  const unsigned int numberOfBlocks = blocksPerSequence * totalNumberOfSequences;
+
+  std::atomic<unsigned int> nextBlock(0);
+
+  auto unmixBlocks = [&]()
+  {
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> result;
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic> reconstruction;
+
+    for (unsigned int block = nextBlock++; block < numberOfBlocks; block = nextBlock++)
+    {
+      unsigned int sequenceCounter = block / blocksPerSequence;
+      unsigned int begin = (block % blocksPerSequence) * blockSize;
+      unsigned int length = std::min(blockSize, numberOfPixels - begin);
+
+      // the images of one sequence are stored one after another and form a column major (pixels x wavelengths) matrix
+      InputBlockType input(inputDataArray + (std::size_t)sequenceCounter * sequenceSize * numberOfPixels + begin,
+        length, sequenceSize, Eigen::OuterStride<>(numberOfPixels));
+
+      result.noalias() = input * unmixingMatrix.transpose();
+
+      std::size_t outputOffset = (std::size_t)sequenceCounter * numberOfPixels + begin;
+      for (unsigned int outputIdx = 0; outputIdx < numberOfChromophores; ++outputIdx)
+        Eigen::Map<Eigen::VectorXf>(writeBufferVector[outputIdx] + outputOffset, length) = result.col(outputIdx);
+
+      if (m_RelativeError == true)
+      {
+        // same as CalculateRelativeError for every pixel of the block
+        reconstruction.noalias() = result * endmemberMatrix.transpose();
+        float* relativeErrorBuffer = writeBufferVector[numberOfChromophores] + outputOffset;
+
+        for (unsigned int pixel = 0; pixel < length; ++pixel)
+        {
+          float relativeError = (reconstruction.row(pixel) - input.row(pixel)).norm() / input.row(pixel).norm();
+          for (int i = 0; i < 2; ++i)
+          {
+            if (result(pixel, i) < m_RelativeErrorSettings[i])
+              relativeError = 0;
+          }
+          relativeErrorBuffer[pixel] = relativeError;
+        }
+      }
+    }
+  };
+
+  unsigned int numberOfThreads = std::min(std::max(std::thread::hardware_concurrency(), 1u), std::max(numberOfBlocks, 1u));
+  MITK_INFO(m_Verbose) << "Unmixing " << numberOfBlocks << " blocks with " << numberOfThreads << " threads";
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+    threads.emplace_back(unmixBlocks);
+  unmixBlocks();
+
+  for (auto& thread : threads)
+    thread.join();
+}
@@ -0,0 +1,497 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkPAPhotonTransportEngine.h"
+#include "mitkPAExceptions.h"
+#include "mitkPAPhiloxRandomGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+  typedef mitk::pa::PhotonTransportEngine Engine;
+  typedef mitk::pa::PhiloxRandomGenerator Philox;
+
+  const unsigned int WIDTH = Engine::BatchWidth;
+
+  const double LITTLEST_STEP = 1.0E-7;     /* Moving photon a little bit off the voxel face */
+  const double PI = 3.1415926;
+  const double THRESHOLD = 0.01;           /* used in roulette */
+  const double CHANCE = 0.1;               /* used in roulette */
+  const double ONE_MINUS_COSZERO = 1.0E-12;
+
+  /* Absorbed weight is accumulated as integer multiples of 2^-32, which makes the sum independent of the order
+   * of the deposits. A voxel can take up the weight of about 4e9 photons. */
+  const double FIXED_POINT_SCALE = 4294967296.0;
+
+  /* The fourth counter word separates the random number streams of a photon. */
+  const std::uint32_t HOP_STREAM = 0;
+  const std::uint32_t LAUNCH_STREAM = 1;
+
+  inline double Min2(double a, double b)
+  {
+    return a >= b ? b : a;
+  }
+
+  inline double Min3(double a, double b, double c)
+  {
+    if (a <= Min2(b, c))
+      return a;
+    else if (b <= Min2(a, c))
+      return b;
+    return c;
+  }
+
+  inline double Sign(double x)
+  {
+    return x >= 0 ? 1 : -1;
+  }
+
+  inline bool SameVoxel(double x1, double y1, double z1, double x2, double y2, double z2, double dx, double dy, double dz)
+  {
+    double xmax = Min2(std::floor(x1 / dx), std::floor(x2 / dx)) * dx + dx;
+    double ymax = Min2(std::floor(y1 / dy), std::floor(y2 / dy)) * dy + dy;
+    double zmax = Min2(std::floor(z1 / dz), std::floor(z2 / dz)) * dz + dz;
+
+    return x1 <= xmax && x2 <= xmax && y1 <= ymax && y2 <= ymax && z1 < zmax && z2 <= zmax;
+  }
+
+  /* Distance to the next voxel face along the trajectory (FindVoxelFace2 of mcxyz). */
+  inline double FindVoxelFace(double x1, double y1, double z1, double dx, double dy, double dz, double ux, double uy, double uz)
+  {
+    int ix1 = static_cast<int>(std::floor(x1 / dx));
+    int iy1 = static_cast<int>(std::floor(y1 / dy));
+    int iz1 = static_cast<int>(std::floor(z1 / dz));
+
+    int ix2 = ux >= 0 ? ix1 + 1 : ix1;
+    int iy2 = uy >= 0 ? iy1 + 1 : iy1;
+    int iz2 = uz >= 0 ? iz1 + 1 : iz1;
+
+    double xs = std::fabs((ix2*dx - x1) / ux);
+    double ys = std::fabs((iy2*dy - y1) / uy);
+    double zs = std::fabs((iz2*dz - z1) / uz);
+
+    return Min3(xs, ys, zs);
+  }
+
+  /* Photon states of one batch, stored as structure of arrays. */
+  struct PhotonBatch
+  {
+    double x[WIDTH], y[WIDTH], z[WIDTH];
+    double ux[WIDTH], uy[WIDTH], uz[WIDTH];
+    double weight[WIDTH];
+    double stepLeft[WIDTH];
+    double random[4][WIDTH];
+    long voxel[WIDTH];
+    std::uint64_t photon[WIDTH];
+    std::uint32_t hop[WIDTH];
+    bool alive[WIDTH];
+    bool inside[WIDTH];
+
+    /* results of the current sub-step */
+    double step[WIDTH];
+    double absorbed[WIDTH];
+    bool sameVoxel[WIDTH];
+  };
+
+  class PackageTransport
+  {
+  public:
+    PackageTransport(const Engine::Medium& medium, const Engine::LaunchFunctionType& launchFunction,
+      Philox::KeyType key, std::vector<std::uint64_t>& grid)
+      : m_Medium(medium), m_LaunchFunction(launchFunction), m_Key(key), m_Grid(grid)
+    {
+    }
+
+    /* Propagates the photons [begin, end) until all of them died. */
+    void Run(std::uint64_t begin, std::uint64_t end)
+    {
+      m_NextPhoton = begin;
+      m_EndPhoton = end;
+
+      for (unsigned int lane = 0; lane < WIDTH; ++lane)
+      {
+        m_Batch.voxel[lane] = 0;
+        this->Launch(lane);
+      }
+
+      while (std::any_of(m_Batch.alive, m_Batch.alive + WIDTH, [](bool alive) { return alive; }))
+      {
+        this->Hop();
+        this->ComputeSubStep();
+        this->ApplySubStep();
+        this->SpinAndRoulette();
+
+        for (unsigned int lane = 0; lane < WIDTH; ++lane)
+        {
+          if (!m_Batch.alive[lane])
+            this->Launch(lane);
+        }
+      }
+    }
+
+  private:
+    void Launch(unsigned int lane)
+    {
+      auto& b = m_Batch;
+
+      if (m_NextPhoton >= m_EndPhoton)
+      {
+        b.alive[lane] = false;
+        return;
+      }
+
+      const std::uint64_t photon = m_NextPhoton++;
+      const auto low = static_cast<std::uint32_t>(photon);
+      const auto high = static_cast<std::uint32_t>(photon >> 32);
+
+      double randomNumbers[Engine::NumberOfLaunchRandomNumbers];
+      for (std::uint32_t block = 0; block < Engine::NumberOfLaunchRandomNumbers / 4; ++block)
+      {
+        const auto values = Philox::Generate({ { low, high, block, LAUNCH_STREAM } }, m_Key);
+        for (unsigned int k = 0; k < 4; ++k)
+          randomNumbers[4 * block + k] = Philox::ToUniform(values[k]);
+      }
+
+      Engine::Photon launched;
+      m_LaunchFunction(randomNumbers, launched);
+
+      b.x[lane] = launched.X;
+      b.y[lane] = launched.Y;
+      b.z[lane] = launched.Z;
+      b.ux[lane] = launched.DirectionX;
+      b.uy[lane] = launched.DirectionY;
+      b.uz[lane] = launched.DirectionZ;
+      b.weight[lane] = 1.0;
+      b.stepLeft[lane] = 0;
+      b.photon[lane] = photon;
+      b.hop[lane] = 0;
+      b.alive[lane] = true;
+      b.inside[lane] = true; // as in mcxyz, the launch voxel counts as inside even if the photon starts outside
+
+      /* If the photon starts beyond the outer edge of the volume, it takes the properties of the outermost voxels. */
+      const auto& m = m_Medium;
+      int ix = std::min(std::max(static_cast<int>(m.NumberOfVoxelsX / 2 + launched.X / m.SpacingX), 0), m.NumberOfVoxelsX - 1);
+      int iy = std::min(std::max(static_cast<int>(m.NumberOfVoxelsY / 2 + launched.Y / m.SpacingY), 0), m.NumberOfVoxelsY - 1);
+      int iz = std::min(std::max(static_cast<int>(launched.Z / m.SpacingZ), 0), m.NumberOfVoxelsZ - 1);
+      b.voxel[lane] = static_cast<long>(iz) * m.NumberOfVoxelsY * m.NumberOfVoxelsX + ix * m.NumberOfVoxelsY + iy;
+    }
+
+    /* HOP: lanes that completed their last step draw the random numbers of the next step. */
+    void Hop()
+    {
+      auto& b = m_Batch;
+
+      for (unsigned int lane = 0; lane < WIDTH; ++lane)
+      {
+        if (b.alive[lane] && b.stepLeft[lane] == 0)
+        {
+          const auto values = Philox::Generate({ { static_cast<std::uint32_t>(b.photon[lane]),
+            static_cast<std::uint32_t>(b.photon[lane] >> 32), b.hop[lane], HOP_STREAM } }, m_Key);
+
+          for (unsigned int k = 0; k < 4; ++k)
+            b.random[k][lane] = Philox::ToUniform(values[k]);
+
+          b.stepLeft[lane] = -std::log(b.random[0][lane]);
+        }
+      }
+    }
+
+    /* Step length and absorbed weight of all lanes. Does not depend on other lanes and has no side effects.
+     * Dead lanes, including lanes that were never launched in the last package, get an empty step. */
+    void ComputeSubStep()
+    {
+      auto& b = m_Batch;
+      const auto& m = m_Medium;
+
+      for (unsigned int lane = 0; lane < WIDTH; ++lane)
+      {
+        if (!b.alive[lane])
+        {
+          b.sameVoxel[lane] = true;
+          b.step[lane] = 0;
+          b.absorbed[lane] = 0;
+          continue;
+        }
+
+        const long i = b.voxel[lane];
+        const double s = b.stepLeft[lane] / m.Scattering[i];
+
+        b.sameVoxel[lane] = SameVoxel(b.x[lane], b.y[lane], b.z[lane],
+          b.x[lane] + s*b.ux[lane], b.y[lane] + s*b.uy[lane], b.z[lane] + s*b.uz[lane],
+          m.SpacingX, m.SpacingY, m.SpacingZ);
+
+        /* step to voxel face + "littlest step" so just inside new voxel. */
+        b.step[lane] = b.sameVoxel[lane]
+          ? s
+          : LITTLEST_STEP + FindVoxelFace(b.x[lane], b.y[lane], b.z[lane], m.SpacingX, m.SpacingY, m.SpacingZ,
+            b.ux[lane], b.uy[lane], b.uz[lane]);
+
+        b.absorbed[lane] = b.weight[lane] * (1 - std::exp(-m.Absorption[i] * b.step[lane]));
+      }
+    }
+
+    /* DROP and move. */
+    void ApplySubStep()
+    {
+      auto& b = m_Batch;
+      const auto& m = m_Medium;
+
+      for (unsigned int lane = 0; lane < WIDTH; ++lane)
+      {
+        if (!b.alive[lane] || b.stepLeft[lane] == 0)
+          continue;
+
+        const double s = b.step[lane];
+        const double absorbed = b.absorbed[lane];
+
+        b.weight[lane] -= absorbed;
+
+        if (b.inside[lane] && absorbed > 0)
+          m_Grid[b.voxel[lane]] += static_cast<std::uint64_t>(absorbed * FIXED_POINT_SCALE + 0.5);
+
+        b.x[lane] += s*b.ux[lane];
+        b.y[lane] += s*b.uy[lane];
+        b.z[lane] += s*b.uz[lane];
+
+        if (b.sameVoxel[lane])
+        {
+          b.stepLeft[lane] = 0;
+          continue;
+        }
+
+        b.stepLeft[lane] -= s*m.Scattering[b.voxel[lane]];
+        if (b.stepLeft[lane] <= LITTLEST_STEP)
+          b.stepLeft[lane] = 0;
+
+        int ix = static_cast<int>(m.NumberOfVoxelsX / 2 + b.x[lane] / m.SpacingX);
+        int iy = static_cast<int>(m.NumberOfVoxelsY / 2 + b.y[lane] / m.SpacingY);
+        int iz = static_cast<int>(b.z[lane] / m.SpacingZ);
+
+        const bool outside = ix < 0 || iy < 0 || iz < 0
+          || ix >= m.NumberOfVoxelsX || iy >= m.NumberOfVoxelsY || iz >= m.NumberOfVoxelsZ;
+
+        b.inside[lane] = !outside;
+
+        if (outside)
+        {
+          if (m.BoundaryFlag == 1 || (m.BoundaryFlag == 2 && iz < 0))
+          {
+            // escaped
+            b.alive[lane] = false;
+            continue;
+          }
+
+          // let the photon wander with the properties of the outermost voxels, but do not deposit its weight
+          ix = std::min(std::max(ix, 0), m.NumberOfVoxelsX - 1);
+          iy = std::min(std::max(iy, 0), m.NumberOfVoxelsY - 1);
+          iz = std::min(std::max(iz, 0), m.NumberOfVoxelsZ - 1);
+        }
+
+        b.voxel[lane] = static_cast<long>(iz) * m.NumberOfVoxelsY * m.NumberOfVoxelsX + ix * m.NumberOfVoxelsY + iy;
+      }
+    }
+
+    /* SPIN into a new trajectory (Henyey-Greenstein) and CHECK ROULETTE for lanes that completed their step. */
+    void SpinAndRoulette()
+    {
+      auto& b = m_Batch;
+      const auto& m = m_Medium;
+
+      for (unsigned int lane = 0; lane < WIDTH; ++lane)
+      {
+        if (!b.alive[lane] || b.stepLeft[lane] != 0)
+          continue;
+
+        const double g = m.Anisotropy[b.voxel[lane]];
+        const double rnd = b.random[1][lane];
+
+        double costheta;
+        if (g == 0.0)
+        {
+          costheta = 2.0 * rnd - 1.0;
+        }
+        else
+        {
+          const double temp = (1.0 - g*g) / (1.0 - g + 2 * g*rnd);
+          costheta = (1.0 + g*g - temp*temp) / (2.0*g);
+        }
+        const double sintheta = std::sqrt(1.0 - costheta*costheta);
+
+        const double psi = 2.0*PI*b.random[2][lane];
+        const double cospsi = std::cos(psi);
+        const double sinpsi = psi < PI ? std::sqrt(1.0 - cospsi*cospsi) : -std::sqrt(1.0 - cospsi*cospsi);
+
+        const double ux = b.ux[lane];
+        const double uy = b.uy[lane];
+        const double uz = b.uz[lane];
+
+        if (1 - std::fabs(uz) <= ONE_MINUS_COSZERO)
+        {
+          b.ux[lane] = sintheta * cospsi;
+          b.uy[lane] = sintheta * sinpsi;
+          b.uz[lane] = costheta * Sign(uz);
+        }
+        else
+        {
+          const double temp = std::sqrt(1.0 - uz * uz);
+          b.ux[lane] = sintheta * (ux * uz * cospsi - uy * sinpsi) / temp + ux * costheta;
+          b.uy[lane] = sintheta * (uy * uz * cospsi + ux * sinpsi) / temp + uy * costheta;
+          b.uz[lane] = -sintheta * cospsi * temp + uz * costheta;
+        }
+
+        if (b.weight[lane] < THRESHOLD)
+        {
+          if (b.random[3][lane] <= CHANCE)
+            b.weight[lane] /= CHANCE;
+          else
+            b.alive[lane] = false;
+        }
+
+        ++b.hop[lane];
+      }
+    }
+
+    const Engine::Medium& m_Medium;
+    const Engine::LaunchFunctionType& m_LaunchFunction;
+    const Philox::KeyType m_Key;
+    std::vector<std::uint64_t>& m_Grid;
+    PhotonBatch m_Batch{};
+    std::uint64_t m_NextPhoton = 0;
+    std::uint64_t m_EndPhoton = 0;
+  };
+}
+
+mitk::pa::PhotonTransportEngine::PhotonTransportEngine() :
+  m_Seed(0),
+  m_NumberOfThreads(0),
+  m_PackageSize(10000),
+  m_NumberOfSimulatedPhotons(0),
+  m_PhotonsPerSecond(0)
+{
+}
+
+mitk::pa::PhotonTransportEngine::~PhotonTransportEngine()
+{
+}
+
+void mitk::pa::PhotonTransportEngine::SetMedium(const Medium& medium)
+{
+  m_Medium = medium;
+}
+
+const mitk::pa::PhotonTransportEngine::Medium& mitk::pa::PhotonTransportEngine::GetMedium() const
+{
+  return m_Medium;
+}
+
+void mitk::pa::PhotonTransportEngine::SetLaunchFunction(const LaunchFunctionType& launchFunction)
+{
+  m_LaunchFunction = launchFunction;
+}
+
+const std::vector<double>& mitk::pa::PhotonTransportEngine::GetAbsorbedWeight() const
+{
+  return m_AbsorbedWeight;
+}
+
+unsigned long long mitk::pa::PhotonTransportEngine::Simulate(unsigned long long numberOfPhotons, long timeLimitInMilliseconds)
+{
+  if (m_Medium.NumberOfVoxelsX <= 0 || m_Medium.NumberOfVoxelsY <= 0 || m_Medium.NumberOfVoxelsZ <= 0
+    || m_Medium.Absorption == nullptr || m_Medium.Scattering == nullptr || m_Medium.Anisotropy == nullptr)
+    throw InvalidInputException("PhotonTransportEngine: the medium is not defined");
+
+  if (!m_LaunchFunction)
+    throw InvalidInputException("PhotonTransportEngine: no launch function set");
+
+  const std::size_t numberOfVoxels = static_cast<std::size_t>(m_Medium.NumberOfVoxelsX)
+    * m_Medium.NumberOfVoxelsY * m_Medium.NumberOfVoxelsZ;
+  const unsigned long long packageSize = std::max(m_PackageSize, 1ul);
+  const unsigned long long numberOfPackages = (numberOfPhotons + packageSize - 1) / packageSize;
+
+  unsigned int numberOfThreads = m_NumberOfThreads;
+  if (numberOfThreads == 0)
+    numberOfThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  numberOfThreads = static_cast<unsigned int>(std::max(std::min<unsigned long long>(numberOfThreads, numberOfPackages), 1ull));
+
+  const auto key = Philox::MakeKey(m_Seed);
+  const auto startTime = std::chrono::steady_clock::now();
+
+  std::vector<std::vector<std::uint64_t>> grids(numberOfThreads);
+  std::atomic<unsigned long long> nextPackage(0);
+  std::atomic<unsigned long long> simulatedPhotons(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto work = [&](std::vector<std::uint64_t>& grid) {
+    try
+    {
+      grid.assign(numberOfVoxels, 0);
+      PackageTransport transport(m_Medium, m_LaunchFunction, key, grid);
+
+      while (true)
+      {
+        // checking the time before taking a package keeps the simulated photons a contiguous range
+        if (timeLimitInMilliseconds > 0 && std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime).count() > timeLimitInMilliseconds)
+          break;
+
+        const unsigned long long package = nextPackage++;
+        if (package >= numberOfPackages)
+          break;
+
+        const unsigned long long begin = package * packageSize;
+        const unsigned long long end = std::min(begin + packageSize, numberOfPhotons);
+        transport.Run(begin, end);
+        simulatedPhotons += end - begin;
+      }
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      error = std::current_exception();
+      nextPackage = numberOfPackages;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 1; t < numberOfThreads; ++t)
+    threads.emplace_back(work, std::ref(grids[t]));
+  work(grids[0]);
+
+  for (auto& thread : threads)
+    thread.join();
+
+  if (error)
+    std::rethrow_exception(error);
+
+  m_AbsorbedWeight.assign(numberOfVoxels, 0.0);
+  for (std::size_t i = 0; i < numberOfVoxels; ++i)
+  {
+    std::uint64_t sum = 0;
+    for (const auto& grid : grids)
+      sum += grid[i];
+    m_AbsorbedWeight[i] = sum / FIXED_POINT_SCALE;
+  }
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+  m_NumberOfSimulatedPhotons = simulatedPhotons;
+  m_PhotonsPerSecond = seconds > 0 ? m_NumberOfSimulatedPhotons / seconds : 0;
+
+  return m_NumberOfSimulatedPhotons;
+}
@@ -29,6 +29,8 @@ set(MODULE_TESTS
   # mitkSpectralUnmixingTest.cpp (See T27024)
   mitkPhotoacousticVesselMeanderStrategyTest.cpp
   mitkPhotoacousticVesselTest.cpp
+  mitkPhotonTransportEngineTest.cpp
+  mitkBatchedSpectralUnmixingTest.cpp
 )
 
 set(RESOURCE_FILES
@@ -0,0 +1,151 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkImageReadAccessor.h>
+#include <mitkPALinearSpectralUnmixingFilter.h>
+
+#include <algorithm>
+#include <cmath>
+
+class mitkBatchedSpectralUnmixingTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkBatchedSpectralUnmixingTestSuite);
+  MITK_TEST(testBatchedUnmixingEqualsPixelwiseUnmixing);
+  MITK_TEST(testBatchedUnmixingFindsFractions);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  // more pixels than in one block of the batched unmixing, two sequences of two wavelengths
+  static const unsigned int DimensionX = 70;
+  static const unsigned int DimensionY = 90;
+  static const unsigned int NumberOfPixels = DimensionX * DimensionY;
+  static const unsigned int NumberOfSequences = 2;
+
+  mitk::Image::Pointer m_InputImage;
+
+  static float GetFractionHb(unsigned int pixel, unsigned int sequence) { return (pixel % 97) + 10.f * sequence; }
+  static float GetFractionHbO2(unsigned int pixel, unsigned int) { return (pixel % 89) + 1.f; }
+
+  std::vector<mitk::Image::Pointer> Unmix(mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType algorithm,
+                                          bool batched)
+  {
+    auto filter = mitk::pa::LinearSpectralUnmixingFilter::New();
+    filter->Verbose(false);
+    filter->RelativeError(false);
+    filter->BatchedUnmixing(batched);
+    filter->SetInput(m_InputImage);
+    filter->AddOutputs(2);
+    filter->AddWavelength(750);
+    filter->AddWavelength(800);
+    filter->AddChromophore(mitk::pa::PropertyCalculator::ChromophoreType::OXYGENATED);
+    filter->AddChromophore(mitk::pa::PropertyCalculator::ChromophoreType::DEOXYGENATED);
+    filter->SetAlgorithm(algorithm);
+    filter->Update();
+
+    std::vector<mitk::Image::Pointer> outputs;
+    for (unsigned int i = 0; i < 2; ++i)
+      outputs.push_back(filter->GetOutput(i));
+    return outputs;
+  }
+
+  static std::vector<mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType> GetAlgorithms()
+  {
+    return {mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::HOUSEHOLDERQR,
+            mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::COLPIVHOUSEHOLDERQR,
+            mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::JACOBISVD,
+            mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::FULLPIVLU,
+            mitk::pa::LinearSpectralUnmixingFilter::AlgortihmType::FULLPIVHOUSEHOLDERQR};
+  }
+
+public:
+  void setUp() override
+  {
+    m_InputImage = mitk::Image::New();
+    unsigned int dimensions[3] = {DimensionX, DimensionY, 2 * NumberOfSequences};
+    m_InputImage->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+
+    // absorption of Hb and HbO2 at 750 and 800 nm
+    std::vector<float> data(NumberOfPixels * dimensions[2]);
+    for (unsigned int pixel = 0; pixel < NumberOfPixels; ++pixel)
+    {
+      for (unsigned int sequence = 0; sequence < NumberOfSequences; ++sequence)
+      {
+        float fracHb = GetFractionHb(pixel, sequence);
+        float fracHbO2 = GetFractionHbO2(pixel, sequence);
+        data[(2 * sequence) * NumberOfPixels + pixel] = fracHb * 7.52 + fracHbO2 * 2.77;
+        data[(2 * sequence + 1) * NumberOfPixels + pixel] = fracHb * 4.08 + fracHbO2 * 4.37;
+      }
+    }
+    m_InputImage->SetImportVolume(data.data(), mitk::Image::ImportMemoryManagementType::CopyMemory);
+  }
+
+  void tearDown() override
+  {
+    m_InputImage = nullptr;
+  }
+
+  // Tests that unmixing with the precomputed unmixing matrix equals the pixelwise unmixing
+  void testBatchedUnmixingEqualsPixelwiseUnmixing()
+  {
+    for (auto algorithm : GetAlgorithms())
+    {
+      auto pixelwiseOutputs = this->Unmix(algorithm, false);
+      auto batchedOutputs = this->Unmix(algorithm, true);
+
+      for (unsigned int i = 0; i < 2; ++i)
+      {
+        CPPUNIT_ASSERT_EQUAL(2u, batchedOutputs[i]->GetDimension(2));
+
+        mitk::ImageReadAccessor pixelwiseAccess(pixelwiseOutputs[i]);
+        mitk::ImageReadAccessor batchedAccess(batchedOutputs[i]);
+        const auto *pixelwise = static_cast<const float *>(pixelwiseAccess.GetData());
+        const auto *batched = static_cast<const float *>(batchedAccess.GetData());
+
+        for (unsigned int pixel = 0; pixel < NumberOfSequences * NumberOfPixels; ++pixel)
+        {
+          const float tolerance = 1e-3f * std::max(1.f, std::abs(pixelwise[pixel]));
+          CPPUNIT_ASSERT(std::abs(pixelwise[pixel] - batched[pixel]) <= tolerance);
+        }
+      }
+    }
+  }
+
+  // Tests that the batched unmixing recovers the fractions of every pixel in every sequence
+  void testBatchedUnmixingFindsFractions()
+  {
+    for (auto algorithm : GetAlgorithms())
+    {
+      auto outputs = this->Unmix(algorithm, true);
+
+      // the outputs are ordered like the chromophores
+      mitk::ImageReadAccessor hbO2Access(outputs[0]);
+      mitk::ImageReadAccessor hbAccess(outputs[1]);
+      const auto *hbO2 = static_cast<const float *>(hbO2Access.GetData());
+      const auto *hb = static_cast<const float *>(hbAccess.GetData());
+
+      for (unsigned int sequence = 0; sequence < NumberOfSequences; ++sequence)
+      {
+        for (unsigned int pixel = 0; pixel < NumberOfPixels; ++pixel)
+        {
+          const unsigned int index = sequence * NumberOfPixels + pixel;
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(GetFractionHbO2(pixel, sequence), hbO2[index], 0.01);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(GetFractionHb(pixel, sequence), hb[index], 0.01);
+        }
+      }
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkBatchedSpectralUnmixing)
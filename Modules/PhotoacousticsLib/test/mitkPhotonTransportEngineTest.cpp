@@ -0,0 +1,167 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <mitkPAPhiloxRandomGenerator.h>
+#include <mitkPAPhotonTransportEngine.h>
+
+#include <vector>
+
+class mitkPhotonTransportEngineTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPhotonTransportEngineTestSuite);
+  MITK_TEST(testPhiloxKnownAnswers);
+  MITK_TEST(testResultIsIndependentOfNumberOfThreads);
+  MITK_TEST(testResultDependsOnSeed);
+  MITK_TEST(testAbsorbedWeightIsPlausible);
+  MITK_TEST(testPhotonCountIsNotMultipleOfBatchWidth);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  static const int m_NumberOfVoxels = 20;
+  std::vector<double> m_Absorption;
+  std::vector<double> m_Scattering;
+  std::vector<double> m_Anisotropy;
+
+  mitk::pa::PhotonTransportEngine::Pointer CreateEngine(std::uint64_t seed, unsigned int numberOfThreads)
+  {
+    mitk::pa::PhotonTransportEngine::Medium medium;
+    medium.NumberOfVoxelsX = m_NumberOfVoxels;
+    medium.NumberOfVoxelsY = m_NumberOfVoxels;
+    medium.NumberOfVoxelsZ = m_NumberOfVoxels;
+    medium.SpacingX = 0.01;
+    medium.SpacingY = 0.01;
+    medium.SpacingZ = 0.01;
+    medium.Absorption = m_Absorption.data();
+    medium.Scattering = m_Scattering.data();
+    medium.Anisotropy = m_Anisotropy.data();
+    medium.BoundaryFlag = 1;
+
+    auto engine = mitk::pa::PhotonTransportEngine::New();
+    engine->SetMedium(medium);
+    engine->SetSeed(seed);
+    engine->SetNumberOfThreads(numberOfThreads);
+    engine->SetPackageSize(333);
+    engine->SetLaunchFunction([](const double* randomNumbers, mitk::pa::PhotonTransportEngine::Photon& photon)
+    {
+      // pencil beam with a little jitter, so the launch random numbers are used as well
+      photon.X = (randomNumbers[0] - 0.5) * 0.01;
+      photon.Y = (randomNumbers[1] - 0.5) * 0.01;
+      photon.Z = 0.0001;
+      photon.DirectionX = 0;
+      photon.DirectionY = 0;
+      photon.DirectionZ = 1;
+    });
+
+    return engine;
+  }
+
+public:
+
+  void setUp() override
+  {
+    const int size = m_NumberOfVoxels * m_NumberOfVoxels * m_NumberOfVoxels;
+    m_Absorption.assign(size, 1.0);
+    m_Scattering.assign(size, 50.0);
+    m_Anisotropy.assign(size, 0.9);
+  }
+
+  void tearDown() override
+  {
+    m_Absorption.clear();
+    m_Scattering.clear();
+    m_Anisotropy.clear();
+  }
+
+  void testPhiloxKnownAnswers()
+  {
+    // known answer tests of the Random123 reference implementation
+    typedef mitk::pa::PhiloxRandomGenerator Philox;
+
+    auto result = Philox::Generate({ { 0, 0, 0, 0 } }, { { 0, 0 } });
+    CPPUNIT_ASSERT(result == Philox::CounterType({ { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } }));
+
+    result = Philox::Generate({ { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff } }, { { 0xffffffff, 0xffffffff } });
+    CPPUNIT_ASSERT(result == Philox::CounterType({ { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } }));
+
+    result = Philox::Generate({ { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } }, { { 0xa4093822, 0x299f31d0 } });
+    CPPUNIT_ASSERT(result == Philox::CounterType({ { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } }));
+
+    CPPUNIT_ASSERT(Philox::ToUniform(0) > 0);
+    CPPUNIT_ASSERT(Philox::ToUniform(0xffffffff) == 1.0);
+  }
+
+  void testResultIsIndependentOfNumberOfThreads()
+  {
+    auto singleThreaded = CreateEngine(42, 1);
+    CPPUNIT_ASSERT_EQUAL(2000ull, singleThreaded->Simulate(2000));
+
+    auto multiThreaded = CreateEngine(42, 4);
+    CPPUNIT_ASSERT_EQUAL(2000ull, multiThreaded->Simulate(2000));
+
+    CPPUNIT_ASSERT(singleThreaded->GetAbsorbedWeight() == multiThreaded->GetAbsorbedWeight());
+  }
+
+  void testResultDependsOnSeed()
+  {
+    auto first = CreateEngine(1, 2);
+    first->Simulate(1000);
+
+    auto second = CreateEngine(2, 2);
+    second->Simulate(1000);
+
+    CPPUNIT_ASSERT(first->GetAbsorbedWeight() != second->GetAbsorbedWeight());
+  }
+
+  void testAbsorbedWeightIsPlausible()
+  {
+    auto engine = CreateEngine(7, 0);
+    engine->Simulate(1000);
+
+    double totalWeight = 0;
+    for (double weight : engine->GetAbsorbedWeight())
+    {
+      CPPUNIT_ASSERT(weight >= 0);
+      totalWeight += weight;
+    }
+
+    // photons escape at the boundaries, so the absorbed weight is less than the launched weight
+    CPPUNIT_ASSERT(totalWeight > 0);
+    CPPUNIT_ASSERT(totalWeight < 1000);
+  }
+
+  void testPhotonCountIsNotMultipleOfBatchWidth()
+  {
+    // fewer photons than lanes, and packages of 333 photons whose last batch leaves lanes unused
+    for (unsigned long long numberOfPhotons : { 3ull, 2001ull })
+    {
+      auto singleThreaded = CreateEngine(5, 1);
+      CPPUNIT_ASSERT_EQUAL(numberOfPhotons, singleThreaded->Simulate(numberOfPhotons));
+
+      auto multiThreaded = CreateEngine(5, 3);
+      CPPUNIT_ASSERT_EQUAL(numberOfPhotons, multiThreaded->Simulate(numberOfPhotons));
+
+      CPPUNIT_ASSERT(singleThreaded->GetAbsorbedWeight() == multiThreaded->GetAbsorbedWeight());
+
+      double totalWeight = 0;
+      for (double weight : singleThreaded->GetAbsorbedWeight())
+        totalWeight += weight;
+      CPPUNIT_ASSERT(totalWeight > 0);
+      CPPUNIT_ASSERT(totalWeight < numberOfPhotons);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPhotonTransportEngine)
@@ -30,6 +30,11 @@ found in the LICENSE file.
 
 #include <mitkExceptionMacro.h>
 
+#include <itkCommand.h>
+
+#include <algorithm>
+#include <memory>
+
 #ifndef WIN32
 #include <dlfcn.h>
 #endif
@@ -525,7 +530,8 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
   QString command;
   QString varName = QString::fromStdString( stdvarName );
 
-  command.append( QString("%1_numpy_array = sitk.GetArrayFromImage(%1)\n").arg(varName) );
+  // a view avoids copying the pixels twice, they are copied once into the mitk image below
+  command.append( QString("%1_numpy_array = sitk.GetArrayViewFromImage(%1) if hasattr(sitk, 'GetArrayViewFromImage') else sitk.GetArrayFromImage(%1)\n").arg(varName) );
   command.append( QString("%1_spacing = numpy.asarray(%1.GetSpacing())\n").arg(varName) );
   command.append( QString("%1_origin = numpy.asarray(%1.GetOrigin())\n").arg(varName) );
   command.append( QString("%1_dtype = %1_numpy_array.dtype.name\n").arg(varName) );
@@ -627,6 +633,332 @@ mitk::Image::Pointer mitk::PythonService::CopySimpleItkImageFromPython(const std
   return mitkImage;
 }
 
+namespace
+{
+  const char* const SharedImageCapsuleName = "mitk.Image";
+
+  /// owned by the capsule that is the base object of a numpy array sharing the pixels of an image
+  struct SharedImageBuffer
+  {
+    mitk::Image::Pointer Image;
+    std::unique_ptr<mitk::ImageAccessorBase> Accessor;
+  };
+
+  void DeleteSharedImageBuffer(PyObject* capsule)
+  {
+    delete static_cast<SharedImageBuffer*>(PyCapsule_GetPointer(capsule, SharedImageCapsuleName));
+  }
+
+  void ReleaseAdoptedNumpyArray(itk::Object*, const itk::EventObject&, void* clientData)
+  {
+    if (!Py_IsInitialized())
+      return;
+
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_XDECREF(static_cast<PyObject*>(clientData));
+    PyGILState_Release(state);
+  }
+
+  bool InitializeNumpy()
+  {
+    import_array1(false);
+    return true;
+  }
+
+  int GetNumpyType(const mitk::PixelType& pixelType)
+  {
+    switch (pixelType.GetComponentType())
+    {
+      case itk::ImageIOBase::DOUBLE: return NPY_DOUBLE;
+      case itk::ImageIOBase::FLOAT: return NPY_FLOAT;
+      case itk::ImageIOBase::SHORT: return NPY_SHORT;
+      case itk::ImageIOBase::USHORT: return NPY_USHORT;
+      case itk::ImageIOBase::CHAR: return NPY_BYTE;
+      case itk::ImageIOBase::UCHAR: return NPY_UBYTE;
+      case itk::ImageIOBase::INT: return NPY_INT;
+      case itk::ImageIOBase::UINT: return NPY_UINT;
+      case itk::ImageIOBase::LONG: return NPY_LONG;
+      case itk::ImageIOBase::ULONG: return NPY_ULONG;
+      default: return NPY_NOTYPE;
+    }
+  }
+
+  /// \return the dtype name as expected by DeterminePixelType(), e.g. "uint16", or an empty string
+  std::string GetNumpyTypeName(PyArrayObject* array)
+  {
+    const PyArray_Descr* descr = PyArray_DESCR(array);
+    const std::string bits = std::to_string(8 * descr->elsize);
+
+    switch (descr->kind)
+    {
+      case 'f': return "float" + bits;
+      case 'i': return "int" + bits;
+      case 'u': return "uint" + bits;
+      default: return std::string();
+    }
+  }
+
+  PyObject* BuildTuple(const double* values, unsigned int size)
+  {
+    PyObject* tuple = PyTuple_New(size);
+    for (unsigned int i = 0; i < size; ++i)
+      PyTuple_SET_ITEM(tuple, i, PyFloat_FromDouble(values[i]));
+
+    return tuple;
+  }
+
+  /// reads a sequence of exactly size numbers
+  bool ParseTuple(PyObject* object, double* values, unsigned int size)
+  {
+    if (object == nullptr)
+      return false;
+
+    PyObject* sequence = PySequence_Fast(object, "expected a sequence");
+    if (sequence == nullptr)
+    {
+      PyErr_Clear();
+      return false;
+    }
+
+    bool valid = static_cast<unsigned int>(PySequence_Fast_GET_SIZE(sequence)) == size;
+    for (unsigned int i = 0; valid && i < size; ++i)
+    {
+      values[i] = PyFloat_AsDouble(PySequence_Fast_GET_ITEM(sequence, i));
+      valid = !PyErr_Occurred();
+    }
+
+    PyErr_Clear();
+    Py_DECREF(sequence);
+    return valid;
+  }
+}
+
+bool mitk::PythonService::ShareWithPythonAsNumpyArray(mitk::Image* image, const std::string& varName, bool writable)
+{
+  if (image == nullptr || !image->IsInitialized())
+    return false;
+
+  if (!InitializeNumpy())
+  {
+    MITK_WARN << "numpy is not available";
+    return false;
+  }
+
+  const mitk::PixelType pixelType = image->GetPixelType();
+  const int npyType = GetNumpyType(pixelType);
+  if (npyType == NPY_NOTYPE)
+  {
+    MITK_WARN << "not a recognized pixeltype";
+    return false;
+  }
+
+  // numpy order: [t,] [z,] y, x [,components]
+  std::vector<npy_intp> shape;
+  if (image->GetTimeSteps() > 1)
+    shape.push_back(image->GetTimeSteps());
+  for (int i = std::min(image->GetDimension(), 3u) - 1; i >= 0; --i)
+    shape.push_back(image->GetDimension(i));
+  if (pixelType.GetNumberOfComponents() > 1)
+    shape.push_back(pixelType.GetNumberOfComponents());
+
+  auto buffer = new SharedImageBuffer;
+  buffer->Image = image;
+  void* data = nullptr;
+
+  try
+  {
+    if (writable)
+    {
+      auto accessor = new mitk::ImageWriteAccessor(image);
+      buffer->Accessor.reset(accessor);
+      data = accessor->GetData();
+    }
+    else
+    {
+      auto accessor = new mitk::ImageReadAccessor(image);
+      buffer->Accessor.reset(accessor);
+      data = const_cast<void*>(accessor->GetData());
+    }
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_WARN << "Cannot access image: " << e.GetDescription();
+    delete buffer;
+    return false;
+  }
+
+  PyObject* capsule = PyCapsule_New(buffer, SharedImageCapsuleName, DeleteSharedImageBuffer);
+  if (capsule == nullptr)
+  {
+    delete buffer;
+    return false;
+  }
+
+  PyObject* npyArray = PyArray_New(&PyArray_Type, static_cast<int>(shape.size()), shape.data(), npyType, nullptr,
+    data, 0, writable ? NPY_ARRAY_CARRAY : NPY_ARRAY_CARRAY_RO, nullptr);
+
+  // the array owns the capsule from now on, the accessor is released together with the array
+  if (npyArray == nullptr || PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(npyArray), capsule) != 0)
+  {
+    Py_XDECREF(npyArray);
+    Py_DECREF(capsule);
+    return false;
+  }
+
+  // geometry as metadata, in x,y,z order
+  const mitk::BaseGeometry* geometry = image->GetGeometry();
+  const mitk::Vector3D spacing = geometry->GetSpacing();
+  const mitk::Point3D origin = geometry->GetOrigin();
+  const vnl_matrix_fixed<ScalarType, 3, 3> &transform = geometry->GetIndexToWorldTransform()->GetMatrix().GetVnlMatrix();
+
+  double direction[9];
+  for (unsigned int row = 0; row < 3; ++row)
+    for (unsigned int column = 0; column < 3; ++column)
+      direction[3 * row + column] = transform[row][column] / spacing[column];
+
+  PyObject* geometryDict = PyDict_New();
+  PyObject* spacingTuple = BuildTuple(spacing.GetDataPointer(), 3);
+  PyObject* originTuple = BuildTuple(origin.GetDataPointer(), 3);
+  PyObject* directionTuple = BuildTuple(direction, 9);
+  PyDict_SetItemString(geometryDict, "spacing", spacingTuple);
+  PyDict_SetItemString(geometryDict, "origin", originTuple);
+  PyDict_SetItemString(geometryDict, "direction", directionTuple);
+  Py_DECREF(spacingTuple);
+  Py_DECREF(originTuple);
+  Py_DECREF(directionTuple);
+
+  PyObject *pyDict = PyModule_GetDict(PyImport_AddModule("__main__"));
+  const int status = PyDict_SetItemString(pyDict, varName.c_str(), npyArray)
+    | PyDict_SetItemString(pyDict, (varName + "_geometry").c_str(), geometryDict);
+
+  Py_DECREF(npyArray);
+  Py_DECREF(geometryDict);
+
+  return status == 0;
+}
+
+mitk::Image::Pointer mitk::PythonService::AdoptNumpyArrayFromPython(const std::string& varName, unsigned int numberOfComponents)
+{
+  if (!InitializeNumpy())
+  {
+    MITK_WARN << "numpy is not available";
+    return nullptr;
+  }
+
+  PyObject *pyDict = PyModule_GetDict(PyImport_AddModule("__main__"));
+  PyObject* object = PyDict_GetItemString(pyDict, varName.c_str());
+
+  if (object == nullptr || !PyArray_Check(object))
+  {
+    MITK_WARN << varName << " is not a numpy array";
+    return nullptr;
+  }
+
+  PyArrayObject* array = reinterpret_cast<PyArrayObject*>(object);
+  if (!PyArray_ISCARRAY(array))
+  {
+    MITK_WARN << varName << " is not a c-contiguous, aligned and writable numpy array, use numpy.ascontiguousarray()";
+    return nullptr;
+  }
+
+  if (numberOfComponents == 0)
+    numberOfComponents = 1;
+
+  int numberOfDimensions = PyArray_NDIM(array);
+  if (numberOfComponents > 1)
+  {
+    if (numberOfDimensions < 2 || PyArray_DIMS(array)[numberOfDimensions - 1] != numberOfComponents)
+    {
+      MITK_WARN << "the last axis of " << varName << " does not hold " << numberOfComponents << " components";
+      return nullptr;
+    }
+    --numberOfDimensions;
+  }
+
+  if (numberOfDimensions < 2 || numberOfDimensions > 4)
+  {
+    MITK_WARN << varName << " must have two to four (spatial and temporal) axes";
+    return nullptr;
+  }
+
+  const std::string dtype = GetNumpyTypeName(array);
+  mitk::PixelType pixelType = mitk::MakePixelType<char, char>(1);
+  try
+  {
+    if (dtype.empty())
+      mitkThrow() << "unknown dtype";
+
+    pixelType = DeterminePixelType(dtype, numberOfComponents, numberOfDimensions);
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_WARN << "cannot adopt " << varName << ": " << e.GetDescription();
+    return nullptr;
+  }
+
+  // fill backwards, numpy saves the dimensions in opposite direction
+  std::vector<unsigned int> dimensions(numberOfDimensions);
+  for (int i = 0; i < numberOfDimensions; ++i)
+    dimensions[i] = static_cast<unsigned int>(PyArray_DIMS(array)[numberOfDimensions - 1 - i]);
+
+  mitk::Image::Pointer mitkImage = mitk::Image::New();
+  mitkImage->Initialize(pixelType, numberOfDimensions, dimensions.data());
+
+  const unsigned int timeSteps = mitkImage->GetTimeSteps();
+  const std::size_t volumeSize = PyArray_NBYTES(array) / timeSteps;
+  char* data = static_cast<char*>(PyArray_DATA(array));
+
+  for (unsigned int t = 0; t < timeSteps; ++t)
+  {
+    if (!mitkImage->SetImportVolume(data + t * volumeSize, t, 0, mitk::Image::ReferenceMemory))
+    {
+      MITK_WARN << "cannot adopt " << varName;
+      return nullptr;
+    }
+  }
+
+  // the image keeps the array alive, the reference is released when the image is deleted
+  Py_INCREF(object);
+  auto releaseCommand = itk::CStyleCommand::New();
+  releaseCommand->SetCallback(&ReleaseAdoptedNumpyArray);
+  releaseCommand->SetClientData(object);
+  mitkImage->AddObserver(itk::DeleteEvent(), releaseCommand);
+
+  PyObject* geometryDict = PyDict_GetItemString(pyDict, (varName + "_geometry").c_str());
+  if (geometryDict != nullptr && PyDict_Check(geometryDict))
+  {
+    double values[9];
+
+    if (ParseTuple(PyDict_GetItemString(geometryDict, "spacing"), values, 3))
+    {
+      mitk::Vector3D spacing;
+      mitk::FillVector3D(spacing, values[0], values[1], values[2]);
+      mitkImage->GetGeometry()->SetSpacing(spacing);
+    }
+
+    if (ParseTuple(PyDict_GetItemString(geometryDict, "origin"), values, 3))
+    {
+      mitk::Point3D origin;
+      mitk::FillVector3D(origin, values[0], values[1], values[2]);
+      mitkImage->GetGeometry()->SetOrigin(origin);
+    }
+
+    if (ParseTuple(PyDict_GetItemString(geometryDict, "direction"), values, 9))
+    {
+      itk::Matrix<double,3,3> direction;
+      for (unsigned int row = 0; row < 3; ++row)
+        for (unsigned int column = 0; column < 3; ++column)
+          direction[row][column] = values[3 * row + column];
+
+      mitk::AffineTransform3D::Pointer affineTransform = mitkImage->GetGeometry()->GetIndexToWorldTransform();
+      affineTransform->SetMatrix(direction * affineTransform->GetMatrix());
+      mitkImage->GetGeometry()->SetIndexToWorldTransform(affineTransform);
+    }
+  }
+
+  return mitkImage;
+}
+
 bool mitk::PythonService::CopyToPythonAsCvImage( mitk::Image* image, const std::string& stdvarName )
 {
   QString varName = QString::fromStdString( stdvarName );
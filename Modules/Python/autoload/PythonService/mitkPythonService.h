@@ -68,6 +68,12 @@ namespace mitk
       /// \see IPythonService::CopyItkImageFromPython()
       mitk::Image::Pointer CopySimpleItkImageFromPython( const std::string& varName ) override;
       ///
+      /// \see IPythonService::ShareWithPythonAsNumpyArray()
+      bool ShareWithPythonAsNumpyArray( mitk::Image* image, const std::string& varName, bool writable = false ) override;
+      ///
+      /// \see IPythonService::AdoptNumpyArrayFromPython()
+      mitk::Image::Pointer AdoptNumpyArrayFromPython( const std::string& varName, unsigned int numberOfComponents = 1 ) override;
+      ///
       /// \see IPythonService::IsOpenCvPythonWrappingAvailable()
       bool IsOpenCvPythonWrappingAvailable() override;
       ///
@@ -112,6 +112,22 @@ namespace mitk
         /// \return the image or 0 if copying was not possible
         virtual mitk::Image::Pointer CopySimpleItkImageFromPython( const std::string& varName ) = 0;
 
+        ///
+        /// makes the pixels of an mitk image available as numpy array "varName" in python without copying.
+        /// The array keeps the image and an image accessor alive until it is deleted in python, i.e. MITK code
+        /// writing to the image (or also reading it, if writable is true) waits until "del varName" was issued.
+        /// The axes are in numpy order, i.e. [t,][z,]y,x[,components]. Spacing, origin and direction are
+        /// available as dictionary "varName_geometry" (in x,y,z order).
+        /// \return true if the array was created, else false
+        virtual bool ShareWithPythonAsNumpyArray( mitk::Image* image, const std::string& varName, bool writable = false ) = 0;
+        ///
+        /// creates an mitk image that uses the buffer of the c-contiguous, writable numpy array "varName"
+        /// without copying. The image keeps a reference to the array until it is destructed. If
+        /// numberOfComponents is greater than one, the last axis holds the components. If a dictionary
+        /// "varName_geometry" exists (see ShareWithPythonAsNumpyArray()), it defines the geometry of the image.
+        /// \return the image or nullptr if the array cannot be adopted
+        virtual mitk::Image::Pointer AdoptNumpyArrayFromPython( const std::string& varName, unsigned int numberOfComponents = 1 ) = 0;
+
         ///
         /// \return true, if OpenCv wrapping is available, false otherwise
         virtual bool IsOpenCvPythonWrappingAvailable() = 0;
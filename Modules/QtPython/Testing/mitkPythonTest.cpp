@@ -19,25 +19,77 @@ found in the LICENSE file.
 #include <mitkIPythonService.h>
 #include <QmitkPythonSnippets.h>
 #include <mitkIPythonService.h>
+#include <mitkImageGenerator.h>
+#include <mitkImagePixelReadAccessor.h>
 
 class mitkPythonTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkPythonTestSuite);
   MITK_TEST(TestPython);
+  MITK_TEST(TestNumpyArrayIsShared);
+  MITK_TEST(TestNumpyArrayIsAdopted);
   CPPUNIT_TEST_SUITE_END();
 
+private:
+
+  mitk::IPythonService* m_PythonService;
+
 public:
 
-  void TestPython()
+  void setUp() override
   {
     us::ModuleContext* context = us::GetModuleContext();
     us::ServiceReference<mitk::IPythonService> m_PythonServiceRef = context->GetServiceReference<mitk::IPythonService>();
-    mitk::IPythonService* m_PythonService = dynamic_cast<mitk::IPythonService*> ( context->GetService<mitk::IPythonService>(m_PythonServiceRef) );
+    m_PythonService = dynamic_cast<mitk::IPythonService*> ( context->GetService<mitk::IPythonService>(m_PythonServiceRef) );
     mitk::IPythonService::ForceLoadModule();
+  }
 
+  void TestPython()
+  {
     std::string result = m_PythonService->Execute( "5+5", mitk::IPythonService::EVAL_COMMAND );
     MITK_TEST_CONDITION( result == "10", "Testing if running python code 5+5 results in 10" );
   }
+
+  void TestNumpyArrayIsShared()
+  {
+    mitk::Image::Pointer image = mitk::ImageGenerator::GenerateGradientImage<float>(4, 3, 2, 0.5, 1, 2);
+
+    CPPUNIT_ASSERT(m_PythonService->ShareWithPythonAsNumpyArray(image, "shared", true));
+    CPPUNIT_ASSERT_EQUAL(std::string("(2, 3, 4)"), m_PythonService->Execute("str(shared.shape)", mitk::IPythonService::EVAL_COMMAND));
+    CPPUNIT_ASSERT_EQUAL(std::string("(0.5, 1.0, 2.0)"), m_PythonService->Execute("str(shared_geometry['spacing'])", mitk::IPythonService::EVAL_COMMAND));
+
+    m_PythonService->Execute("shared[1, 2, 3] = -7", mitk::IPythonService::SINGLE_LINE_COMMAND);
+    m_PythonService->Execute("del shared", mitk::IPythonService::SINGLE_LINE_COMMAND);
+
+    // the write accessor was released together with the array
+    mitk::ImagePixelReadAccessor<float, 3> accessor(image);
+    itk::Index<3> index = { { 3, 2, 1 } };
+    CPPUNIT_ASSERT_EQUAL(-7.0f, accessor.GetPixelByIndex(index));
+  }
+
+  void TestNumpyArrayIsAdopted()
+  {
+    m_PythonService->Execute("import numpy", mitk::IPythonService::SINGLE_LINE_COMMAND);
+    m_PythonService->Execute("adopted = numpy.arange(24, dtype=numpy.int16).reshape(2, 3, 4)", mitk::IPythonService::SINGLE_LINE_COMMAND);
+    m_PythonService->Execute("adopted_geometry = {'spacing': (0.5, 1, 2), 'origin': (1, 2, 3)}", mitk::IPythonService::SINGLE_LINE_COMMAND);
+
+    mitk::Image::Pointer image = m_PythonService->AdoptNumpyArrayFromPython("adopted");
+    CPPUNIT_ASSERT(image.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(4u, image->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(2u, image->GetDimension(2));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, image->GetGeometry()->GetSpacing()[0], mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, image->GetGeometry()->GetOrigin()[2], mitk::eps);
+
+    // the image still references the buffer after the python variable is gone
+    m_PythonService->Execute("adopted[1, 2, 3] = -7", mitk::IPythonService::SINGLE_LINE_COMMAND);
+    m_PythonService->Execute("del adopted", mitk::IPythonService::SINGLE_LINE_COMMAND);
+
+    mitk::ImagePixelReadAccessor<short, 3> accessor(image);
+    itk::Index<3> index = { { 3, 2, 1 } };
+    CPPUNIT_ASSERT_EQUAL(static_cast<short>(-7), accessor.GetPixelByIndex(index));
+    index[0] = 1; index[1] = 0; index[2] = 0;
+    CPPUNIT_ASSERT_EQUAL(static_cast<short>(1), accessor.GetPixelByIndex(index));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkPython)
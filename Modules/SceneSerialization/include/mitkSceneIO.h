@@ -20,12 +20,14 @@ found in the LICENSE file.
 
 #include <Poco/Zip/ZipLocalFileHeader.h>
 
+class TiXmlDocument;
 class TiXmlElement;
 
 namespace mitk
 {
   class BaseData;
   class PropertyList;
+  class SceneArchive;
 
   class MITKSCENESERIALIZATION_EXPORT SceneIO : public itk::Object
   {
@@ -111,12 +113,43 @@ namespace mitk
      */
     const PropertyList *GetFailedProperties();
 
+    /**
+     * \brief Number of BaseData objects which are loaded or saved at the same time (default: 1), 0 for one per core.
+     *
+     * More than one thread requires the readers and writers of all data in the scene to be thread-safe. The scene
+     * is loaded and saved with the "C" locale, so readers and writers that use mitk::LocaleSwitch("C") leave the
+     * locale untouched. Readers and writers that call setlocale() themselves race with each other.
+     */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+    /**
+     * \brief Images with more bytes are saved without compression, 0 (default) to compress all images.
+     *
+     * Compressing large images dominates the time to save and load a scene. Uncompressed images are
+     * stored as they are in the scene file, so loading them is limited by the disk only.
+     */
+    itkSetMacro(UncompressedImageThreshold, std::size_t);
+    itkGetConstMacro(UncompressedImageThreshold, std::size_t);
+
   protected:
     SceneIO();
     ~SceneIO() override;
 
     std::string CreateEmptyTempDirectory();
 
+    /**
+     * \brief Creates the nodes described by document in storage.
+     *
+     * \param workingDirectory directory of the files referenced by document, or where files of the archive are
+     * extracted to if archive is given
+     */
+    DataStorage::Pointer LoadSceneDocument(TiXmlDocument &document,
+                                           const std::string &workingDirectory,
+                                           const SceneArchive *archive,
+                                           DataStorage *storage,
+                                           bool clearStorageFirst);
+
     TiXmlElement *SaveBaseData(BaseData *data, const std::string &filenamehint, bool &error);
     TiXmlElement *SavePropertyList(PropertyList *propertyList, const std::string &filenamehint);
 
@@ -128,6 +161,8 @@ namespace mitk
 
     std::string m_WorkingDirectory;
     unsigned int m_UnzipErrors;
+    unsigned int m_NumberOfThreads;
+    std::size_t m_UncompressedImageThreshold;
   };
 }
 
@@ -20,6 +20,8 @@ found in the LICENSE file.
 
 namespace mitk
 {
+  class SceneArchive;
+
   class MITKSCENESERIALIZATION_EXPORT SceneReader : public itk::Object
   {
   public:
@@ -28,5 +30,30 @@ namespace mitk
     itkCloneMacro(Self);
 
       virtual bool LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage);
+
+    /**
+      \brief Reads the files of the scene from the scene archive instead of the working directory.
+
+      Property lists are parsed from memory. The files of each BaseData are extracted into the working
+      directory just before they are loaded and removed right after.
+    */
+    void SetArchive(const SceneArchive *archive);
+    const SceneArchive *GetArchive() const;
+
+    /**
+      \brief Number of BaseData objects which are loaded at the same time (default: 1), 0 for one per core.
+
+      More than one thread requires the readers of all data in the scene to be thread-safe, see
+      SceneIO::SetNumberOfThreads().
+    */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  protected:
+    SceneReader();
+    ~SceneReader() override;
+
+    const SceneArchive *m_Archive;
+    unsigned int m_NumberOfThreads;
   };
 }
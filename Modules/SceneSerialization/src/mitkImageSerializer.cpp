@@ -11,13 +11,58 @@ found in the LICENSE file.
 ============================================================================*/
 
 #include "mitkImageSerializer.h"
+#include "mitkFileWriterRegistry.h"
+#include "mitkIOMimeTypes.h"
 #include "mitkIOUtil.h"
 #include "mitkImage.h"
+#include "mitkItkImageIO.h"
 #include <Poco/Path.h>
 
 MITK_REGISTER_SERIALIZER(ImageSerializer)
 
-mitk::ImageSerializer::ImageSerializer()
+namespace
+{
+  // Compression is not a writer option (so that interactive saving does not ask for it),
+  // hence an uncompressed image has to be written by configuring an ITK NRRD writer directly.
+  void SaveUncompressed(const mitk::Image *image, const std::string &path)
+  {
+    mitk::FileWriterRegistry registry;
+    std::vector<mitk::IFileWriter *> writers = registry.GetWriters(image, mitk::IOMimeTypes::NRRD_MIMETYPE_NAME());
+
+    mitk::IFileWriter *writer = nullptr;
+    for (auto candidate : writers)
+    {
+      if (auto *itkImageIO = dynamic_cast<mitk::ItkImageIO *>(candidate))
+      {
+        itkImageIO->SetUseCompression(false);
+        writer = candidate;
+        break;
+      }
+    }
+
+    try
+    {
+      if (writer != nullptr)
+      {
+        writer->SetInput(image);
+        writer->SetOutputLocation(path);
+        writer->Write();
+      }
+      else
+      {
+        mitk::IOUtil::Save(image, path);
+      }
+    }
+    catch (...)
+    {
+      registry.UngetWriters(writers);
+      throw;
+    }
+    registry.UngetWriters(writers);
+  }
+}
+
+mitk::ImageSerializer::ImageSerializer() : m_UseCompression(true)
 {
 }
 
@@ -45,7 +90,14 @@ std::string mitk::ImageSerializer::Serialize()
 
   try
   {
-    IOUtil::Save(image, fullname);
+    if (m_UseCompression)
+    {
+      IOUtil::Save(image, fullname);
+    }
+    else
+    {
+      SaveUncompressed(image, fullname);
+    }
   }
   catch (std::exception &e)
   {
@@ -29,9 +29,17 @@ namespace mitk
 
       std::string Serialize() override;
 
+    /**
+      \brief Whether the image file is compressed (default: true)
+    */
+    itkSetMacro(UseCompression, bool);
+    itkGetConstMacro(UseCompression, bool);
+
   protected:
     ImageSerializer();
     ~ImageSerializer() override;
+
+    bool m_UseCompression;
   };
 
 } // namespace
@@ -27,7 +27,7 @@ bool mitk::PropertyListDeserializer::Deserialize()
   bool error(false);
 
   TiXmlDocument document(m_Filename);
-  if (!document.LoadFile())
+  if (!this->LoadDocument(document))
   {
     MITK_ERROR << "Could not open/read/parse " << m_Filename << "\nTinyXML reports: " << document.ErrorDesc()
                << std::endl;
@@ -66,6 +66,7 @@ bool mitk::PropertyListDeserializer::Deserialize()
     if (auto *reader = dynamic_cast<PropertyListDeserializer *>(iter->GetPointer()))
     {
       reader->SetFilename(m_Filename);
+      reader->SetContent(m_Content);
       bool success = reader->Deserialize();
       error |= !success;
       m_PropertyList = reader->GetOutput();
@@ -82,6 +83,17 @@ bool mitk::PropertyListDeserializer::Deserialize()
   return !error;
 }
 
+bool mitk::PropertyListDeserializer::LoadDocument(TiXmlDocument &document)
+{
+  if (m_Content.empty())
+  {
+    return document.LoadFile();
+  }
+
+  document.Parse(m_Content.c_str());
+  return !document.Error();
+}
+
 mitk::PropertyList::Pointer mitk::PropertyListDeserializer::GetOutput()
 {
   return m_PropertyList;
@@ -15,6 +15,8 @@ found in the LICENSE file.
 
 #include "mitkPropertyList.h"
 
+class TiXmlDocument;
+
 namespace mitk
 {
   /**
@@ -29,6 +31,12 @@ namespace mitk
       itkSetStringMacro(Filename);
     itkGetStringMacro(Filename);
 
+    /**
+      \brief Sets the XML content to deserialize instead of reading the file, which is then only used in messages
+      */
+    itkSetStringMacro(Content);
+    itkGetStringMacro(Content);
+
     /**
       \brief Reads a propertylist from file
       \return success of deserialization
@@ -41,7 +49,13 @@ namespace mitk
     PropertyListDeserializer();
     ~PropertyListDeserializer() override;
 
+    /**
+      \brief Parses the content if it was set, the file otherwise
+      */
+    bool LoadDocument(TiXmlDocument &document);
+
     std::string m_Filename;
+    std::string m_Content;
     PropertyList::Pointer m_PropertyList;
   };
 
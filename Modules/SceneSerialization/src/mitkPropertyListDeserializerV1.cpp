@@ -32,7 +32,7 @@ bool mitk::PropertyListDeserializerV1::Deserialize()
   m_PropertyList = PropertyList::New();
 
   TiXmlDocument document(m_Filename);
-  if (!document.LoadFile())
+  if (!this->LoadDocument(document))
   {
     MITK_ERROR << "Could not open/read/parse " << m_Filename << "\nTinyXML reports: " << document.ErrorDesc()
                << std::endl;
@@ -0,0 +1,127 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkSceneArchive.h"
+
+#include <mitkLogMacros.h>
+
+#include <Poco/File.h>
+#include <Poco/Path.h>
+#include <Poco/StreamCopier.h>
+#include <Poco/Zip/ZipStream.h>
+
+#include <fstream>
+
+namespace
+{
+  std::string GetStem(const std::string &name)
+  {
+    return name.substr(0, name.find('.'));
+  }
+}
+
+mitk::SceneArchive::SceneArchive()
+{
+}
+
+mitk::SceneArchive::~SceneArchive()
+{
+}
+
+bool mitk::SceneArchive::Open(const std::string &filename)
+{
+  m_Archive.reset();
+  m_Filename = filename;
+
+  std::ifstream file(filename.c_str(), std::ios::binary);
+  if (!file.good())
+    return false;
+
+  try
+  {
+    m_Archive.reset(new Poco::Zip::ZipArchive(file));
+  }
+  catch (const std::exception &e)
+  {
+    MITK_WARN << "Could not read the directory of '" << filename << "': " << e.what();
+    return false;
+  }
+
+  return true;
+}
+
+bool mitk::SceneArchive::HasFile(const std::string &name) const
+{
+  return m_Archive != nullptr && m_Archive->findHeader(name) != m_Archive->headerEnd();
+}
+
+bool mitk::SceneArchive::ReadFile(const std::string &name, std::string &content) const
+{
+  if (!this->HasFile(name))
+    return false;
+
+  try
+  {
+    std::ifstream file(m_Filename.c_str(), std::ios::binary);
+    Poco::Zip::ZipInputStream input(file, m_Archive->findHeader(name)->second);
+    content.clear();
+    Poco::StreamCopier::copyToString(input, content);
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << "Could not read '" << name << "' from '" << m_Filename << "': " << e.what();
+    return false;
+  }
+
+  return true;
+}
+
+std::vector<std::string> mitk::SceneArchive::ExtractFile(const std::string &name, const std::string &directory) const
+{
+  std::vector<std::string> extractedFiles;
+  if (!this->HasFile(name))
+    return extractedFiles;
+
+  const std::string stem = GetStem(name);
+
+  try
+  {
+    std::ifstream file(m_Filename.c_str(), std::ios::binary);
+    for (auto iter = m_Archive->headerBegin(); iter != m_Archive->headerEnd(); ++iter)
+    {
+      if (!iter->second.isFile() || GetStem(iter->first) != stem)
+        continue;
+
+      Poco::Path target(directory);
+      target.makeDirectory();
+      target.append(Poco::Path(iter->first, Poco::Path::PATH_UNIX));
+      Poco::File(target.parent()).createDirectories();
+
+      std::ofstream output(target.toString().c_str(), std::ios::binary);
+      Poco::Zip::ZipInputStream input(file, iter->second);
+      Poco::StreamCopier::copyStream(input, output);
+      extractedFiles.push_back(target.toString());
+
+      if (!output.good())
+      {
+        MITK_ERROR << "Could not write '" << target.toString() << "'";
+        break;
+      }
+    }
+  }
+  catch (const std::exception &e)
+  {
+    MITK_ERROR << "Could not extract '" << name << "' from '" << m_Filename << "': " << e.what();
+  }
+
+  return extractedFiles;
+}
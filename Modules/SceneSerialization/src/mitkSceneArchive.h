@@ -0,0 +1,73 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkSceneArchive_h_included
+#define mitkSceneArchive_h_included
+
+#include <mitkCommon.h>
+
+#include <itkLightObject.h>
+#include <itkObjectFactory.h>
+
+#include <Poco/Zip/ZipArchive.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Read access to the files of a scene file (zip archive) without extracting the whole archive.
+
+    Only the directory of the archive is read by Open(). Each read opens its own stream on the scene
+    file, so files can be read from several threads at the same time.
+  */
+  class SceneArchive : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(SceneArchive, itk::LightObject);
+    itkFactorylessNewMacro(Self);
+
+    /**
+      \brief Reads the directory of the archive.
+      \return false if the file is not a readable zip archive
+    */
+    bool Open(const std::string &filename);
+
+    bool HasFile(const std::string &name) const;
+
+    /**
+      \brief Decompresses a file of the archive into memory.
+    */
+    bool ReadFile(const std::string &name, std::string &content) const;
+
+    /**
+      \brief Writes a file of the archive into directory.
+
+      All files whose name is identical up to the first '.' are written as well, so files which
+      reference each other (e.g. a detached header and its data) stay together.
+      \return full paths of the written files, empty on errors
+    */
+    std::vector<std::string> ExtractFile(const std::string &name, const std::string &directory) const;
+
+  protected:
+    SceneArchive();
+    ~SceneArchive() override;
+
+  private:
+    std::string m_Filename;
+    std::unique_ptr<Poco::Zip::ZipArchive> m_Archive;
+  };
+}
+
+#endif
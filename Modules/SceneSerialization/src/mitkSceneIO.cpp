@@ -17,11 +17,14 @@ found in the LICENSE file.
 #include <Poco/Zip/Decompress.h>
 
 #include "mitkBaseDataSerializer.h"
+#include "mitkImageSerializer.h"
 #include "mitkPropertyListSerializer.h"
+#include "mitkSceneArchive.h"
 #include "mitkSceneIO.h"
 #include "mitkSceneReader.h"
 
 #include "mitkBaseRenderer.h"
+#include "mitkImage.h"
 #include "mitkProgressBar.h"
 #include "mitkRenderingManager.h"
 #include "mitkStandaloneDataStorage.h"
@@ -32,13 +35,18 @@ found in the LICENSE file.
 
 #include <tinyxml.h>
 
+#include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <mitkIOUtil.h>
+#include <set>
 #include <sstream>
+#include <thread>
 
 #include "itksys/SystemTools.hxx"
 
-mitk::SceneIO::SceneIO() : m_WorkingDirectory(""), m_UnzipErrors(0)
+mitk::SceneIO::SceneIO()
+  : m_WorkingDirectory(""), m_UnzipErrors(0), m_NumberOfThreads(1), m_UncompressedImageThreshold(0)
 {
 }
 
@@ -117,6 +125,43 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadScene(const std::string &filename,
     return storage;
   }
 
+  // read the files directly from the archive, so only the data of the nodes being loaded is written to the
+  // temporary directory
+  SceneArchive::Pointer archive = SceneArchive::New();
+  std::string index;
+  if (archive->Open(filename) && archive->ReadFile("index.xml", index))
+  {
+    file.close();
+    m_WorkingDirectory = Poco::Path::transcode(m_WorkingDirectory);
+
+    TiXmlDocument document;
+    document.Parse(index.c_str());
+    if (document.Error())
+    {
+      MITK_ERROR << "Could not parse index.xml of " << filename << "\nTinyXML reports: " << document.ErrorDesc();
+    }
+    else
+    {
+      storage = LoadSceneDocument(document, m_WorkingDirectory, archive, storage, clearStorageFirst);
+    }
+
+    try
+    {
+      Poco::File deleteDir(m_WorkingDirectory);
+      deleteDir.remove(true); // recursive
+    }
+    catch (...)
+    {
+      MITK_ERROR << "Could not delete temporary directory " << m_WorkingDirectory;
+    }
+
+    return storage;
+  }
+
+  MITK_WARN << "Could not read '" << filename << "' as archive. Extracting all files.";
+  file.clear();
+  file.seekg(0);
+
   // unzip all filenames contents to temp dir
   m_UnzipErrors = 0;
   Poco::Zip::Decompress unzipper(file, Poco::Path(m_WorkingDirectory));
@@ -204,10 +249,35 @@ mitk::DataStorage::Pointer mitk::SceneIO::LoadSceneUnzipped(const std::string &i
     return storage;
   }
 
+  return LoadSceneDocument(document, workingDir, nullptr, storage, false);
+}
+
+mitk::DataStorage::Pointer mitk::SceneIO::LoadSceneDocument(TiXmlDocument &document,
+                                                            const std::string &workingDirectory,
+                                                            const SceneArchive *archive,
+                                                            DataStorage *pStorage,
+                                                            bool clearStorageFirst)
+{
+  DataStorage::Pointer storage = pStorage;
+  if (clearStorageFirst)
+  {
+    try
+    {
+      storage->Remove(storage->GetAll());
+    }
+    catch (...)
+    {
+      MITK_ERROR << "DataStorage cannot be cleared properly.";
+    }
+  }
+
   SceneReader::Pointer reader = SceneReader::New();
-  if (!reader->LoadScene(document, workingDir, storage))
+  reader->SetArchive(archive);
+  reader->SetNumberOfThreads(m_NumberOfThreads);
+  if (!reader->LoadScene(document, workingDirectory, storage))
   {
-    MITK_ERROR << "There were errors while loading scene file " << indexfilename << ". Your data may be corrupted";
+    MITK_ERROR << "There were errors while loading scene file " << workingDirectory << mitk::IOUtil::GetDirectorySeparator()
+               << "index.xml. Your data may be corrupted";
   }
 
   // return new data storage, even if empty or uncomplete (return as much as possible but notify calling method)
@@ -321,7 +391,48 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
         }
       }
 
+      // serialize all BaseData objects concurrently, they are written to files of their own
+      std::vector<DataNode *> nodesWithData;
+      for (auto iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter)
+      {
+        if (iter->IsNotNull() && (*iter)->GetData() != nullptr)
+        {
+          nodesWithData.push_back(iter->GetPointer());
+        }
+      }
+
+      std::vector<TiXmlElement *> dataElements(nodesWithData.size(), nullptr);
+      std::vector<char> dataErrors(nodesWithData.size(), 0);
+      std::atomic<std::size_t> nextNode(0);
+
+      auto saveNodes = [&]() {
+        for (std::size_t i = nextNode++; i < nodesWithData.size(); i = nextNode++)
+        {
+          std::string filenameHint = itksys::SystemTools::MakeCindentifier(nodesWithData[i]->GetName().c_str());
+          bool error(false);
+          dataElements[i] = SaveBaseData(nodesWithData[i]->GetData(), filenameHint, error); // returns a reference to a file
+          dataErrors[i] = error;
+        }
+      };
+
+      unsigned int numberOfThreads = m_NumberOfThreads != 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
+      numberOfThreads =
+        static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, nodesWithData.size())));
+
+      std::vector<std::thread> threads;
+      for (unsigned int i = 1; i < numberOfThreads; ++i)
+      {
+        threads.emplace_back(saveNodes);
+      }
+      saveNodes();
+      for (auto &thread : threads)
+      {
+        thread.join();
+      }
+
       // write out objects, dependencies and properties
+      auto nextDataElement = dataElements.begin();
+      auto nextDataError = dataErrors.begin();
       for (auto iter = sceneNodes->begin(); iter != sceneNodes->end(); ++iter)
       {
         DataNode *node = iter->GetPointer();
@@ -358,10 +469,8 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
           // store basedata
           if (BaseData *data = node->GetData())
           {
-            // std::string filenameHint( node->GetName() );
-            bool error(false);
-            TiXmlElement *dataElement(SaveBaseData(data, filenameHint, error)); // returns a reference to a file
-            if (error)
+            TiXmlElement *dataElement(*nextDataElement++);
+            if (*nextDataError++)
             {
               m_FailedNodes->push_back(node);
             }
@@ -439,6 +548,12 @@ bool mitk::SceneIO::SaveScene(DataStorage::SetOfObjects::ConstPointer sceneNodes
         else
         {
           Poco::Zip::Compress zipper(file, true);
+
+          // images are compressed by their writers already, if at all
+          std::set<std::string> storeExtensions;
+          storeExtensions.insert("nrrd");
+          zipper.setStoreExtensions(storeExtensions);
+
           Poco::Path tmpdir(m_WorkingDirectory);
           zipper.addRecursive(tmpdir);
           zipper.close();
@@ -499,6 +614,18 @@ TiXmlElement *mitk::SceneIO::SaveBaseData(BaseData *data, const std::string &fil
   {
     if (auto *serializer = dynamic_cast<BaseDataSerializer *>(iter->GetPointer()))
     {
+      auto *imageSerializer = dynamic_cast<ImageSerializer *>(serializer);
+      auto *image = dynamic_cast<Image *>(data);
+      if (imageSerializer != nullptr && image != nullptr && m_UncompressedImageThreshold != 0)
+      {
+        std::size_t imageSize = image->GetPixelType().GetSize();
+        for (unsigned int i = 0; i < image->GetDimension(); ++i)
+        {
+          imageSize *= image->GetDimension(i);
+        }
+        imageSerializer->SetUseCompression(imageSize <= m_UncompressedImageThreshold);
+      }
+
       serializer->SetData(data);
       serializer->SetFilenameHint(filenamehint);
       std::string defaultLocale_WorkingDirectory = Poco::Path::transcode( m_WorkingDirectory );
@@ -12,6 +12,24 @@ found in the LICENSE file.
 
 #include "mitkSceneReader.h"
 
+mitk::SceneReader::SceneReader() : m_Archive(nullptr), m_NumberOfThreads(1)
+{
+}
+
+mitk::SceneReader::~SceneReader()
+{
+}
+
+void mitk::SceneReader::SetArchive(const SceneArchive *archive)
+{
+  m_Archive = archive;
+}
+
+const mitk::SceneArchive *mitk::SceneReader::GetArchive() const
+{
+  return m_Archive;
+}
+
 bool mitk::SceneReader::LoadScene(TiXmlDocument &document, const std::string &workingDirectory, DataStorage *storage)
 {
   // find version node --> note version in some variable
@@ -45,6 +63,9 @@ bool mitk::SceneReader::LoadScene(TiXmlDocument &document, const std::string &wo
   {
     if (auto *reader = dynamic_cast<SceneReader *>(iter->GetPointer()))
     {
+      reader->SetArchive(m_Archive);
+      reader->SetNumberOfThreads(m_NumberOfThreads);
+
       if (!reader->LoadScene(document, workingDirectory, storage))
       {
         MITK_ERROR << "There were errors while loading scene file "
@@ -16,9 +16,17 @@ found in the LICENSE file.
 #include "mitkIOUtil.h"
 #include "mitkProgressBar.h"
 #include "mitkPropertyListDeserializer.h"
+#include "mitkSceneArchive.h"
 #include "mitkSerializerMacros.h"
+#include <mitkLocaleSwitch.h>
 #include <mitkRenderingModeProperty.h>
 
+#include <Poco/File.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
 MITK_REGISTER_SERIALIZER(SceneReaderV1)
 
 namespace
@@ -65,20 +73,49 @@ bool mitk::SceneReaderV1::LoadScene(TiXmlDocument &document, const std::string &
 
   // create a node for the tag "data" and test if node was created
   typedef std::vector<mitk::DataNode::Pointer> DataNodeVector;
-  DataNodeVector DataNodes;
-  unsigned int listSize = 0;
+  std::vector<TiXmlElement *> dataElements;
   for (TiXmlElement *element = document.FirstChildElement("node"); element != nullptr;
        element = element->NextSiblingElement("node"))
   {
-    ++listSize;
+    dataElements.push_back(element->FirstChildElement("data"));
   }
 
+  const std::size_t listSize = dataElements.size();
   ProgressBar::GetInstance()->AddStepsToDo(listSize * 2);
 
-  for (TiXmlElement *element = document.FirstChildElement("node"); element != nullptr;
-       element = element->NextSiblingElement("node"))
+  // the BaseData objects do not depend on each other, so they may be loaded concurrently. The locale is
+  // switched once for all of them, so readers using LocaleSwitch("C") do not switch it while others read.
+  mitk::LocaleSwitch localeSwitch("C");
+  DataNodeVector DataNodes(listSize);
+  std::vector<char> loadErrors(listSize, 0);
+  std::atomic<std::size_t> nextNode(0);
+
+  auto loadNodes = [&]() {
+    for (std::size_t i = nextNode++; i < listSize; i = nextNode++)
+    {
+      bool loadError(false);
+      DataNodes[i] = LoadBaseDataFromDataTag(dataElements[i], workingDirectory, loadError);
+      loadErrors[i] = loadError;
+    }
+  };
+
+  unsigned int numberOfThreads = m_NumberOfThreads != 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
+  numberOfThreads = static_cast<unsigned int>(std::max<std::size_t>(1, std::min<std::size_t>(numberOfThreads, listSize)));
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(loadNodes);
+  }
+  loadNodes();
+  for (auto &thread : threads)
   {
-    DataNodes.push_back(LoadBaseDataFromDataTag(element->FirstChildElement("data"), workingDirectory, error));
+    thread.join();
+  }
+
+  for (std::size_t i = 0; i < listSize; ++i)
+  {
+    error |= loadErrors[i] != 0;
     ProgressBar::GetInstance()->Progress();
   }
 
@@ -248,6 +285,12 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag(TiXmlElemen
     const char *filename = dataElement->Attribute("file");
     if (filename && strlen(filename) != 0)
     {
+      std::vector<std::string> extractedFiles;
+      if (m_Archive != nullptr)
+      {
+        extractedFiles = m_Archive->ExtractFile(filename, workingDirectory);
+      }
+
       try
       {
         std::vector<BaseData::Pointer> baseData = IOUtil::Load(workingDirectory + Poco::Path::separator() + filename);
@@ -269,6 +312,19 @@ mitk::DataNode::Pointer mitk::SceneReaderV1::LoadBaseDataFromDataTag(TiXmlElemen
         MITK_ERROR << "Error during attempt to read '" << filename << "'. Factory returned nullptr object.";
         error = true;
       }
+
+      // the data is in memory now, so the extracted files are not needed anymore
+      for (const auto &extractedFile : extractedFiles)
+      {
+        try
+        {
+          Poco::File(extractedFile).remove();
+        }
+        catch (...)
+        {
+          MITK_WARN << "Could not remove temporary file " << extractedFile;
+        }
+      }
     }
   }
 
@@ -354,7 +410,7 @@ bool mitk::SceneReaderV1::DecorateNodeWithProperties(DataNode *node,
     // use deserializer to construct new properties
     PropertyListDeserializer::Pointer deserializer = PropertyListDeserializer::New();
 
-    deserializer->SetFilename(workingDirectory + Poco::Path::separator() + propertiesfile);
+    InitializeDeserializer(deserializer, workingDirectory, propertiesfile);
     bool success = deserializer->Deserialize();
     error |= !success;
     PropertyList::Pointer readProperties = deserializer->GetOutput();
@@ -392,7 +448,7 @@ bool mitk::SceneReaderV1::DecorateBaseDataWithProperties(BaseData::Pointer data,
     PropertyListDeserializer::Pointer propertyDeserializer = PropertyListDeserializer::New();
 
     // initialize the property reader
-    propertyDeserializer->SetFilename(workingDir + Poco::Path::separator() + baseDataPropertyFile);
+    InitializeDeserializer(propertyDeserializer, workingDir, baseDataPropertyFile);
     bool ioSuccess = propertyDeserializer->Deserialize();
     error = !ioSuccess;
 
@@ -419,3 +475,16 @@ bool mitk::SceneReaderV1::DecorateBaseDataWithProperties(BaseData::Pointer data,
 
   return !error;
 }
+
+void mitk::SceneReaderV1::InitializeDeserializer(PropertyListDeserializer *deserializer,
+                                                 const std::string &workingDirectory,
+                                                 const std::string &filename)
+{
+  deserializer->SetFilename(workingDirectory + Poco::Path::separator() + filename);
+
+  std::string content;
+  if (m_Archive != nullptr && m_Archive->ReadFile(filename, content))
+  {
+    deserializer->SetContent(content);
+  }
+}
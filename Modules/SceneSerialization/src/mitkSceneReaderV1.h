@@ -12,6 +12,8 @@ found in the LICENSE file.
 
 #include "mitkSceneReader.h"
 
+#include "mitkPropertyListDeserializer.h"
+
 namespace mitk
 {
   class SceneReaderV1 : public SceneReader
@@ -60,6 +62,13 @@ namespace mitk
                                         TiXmlElement *baseDataNodeElem,
                                         const std::string &workingDir);
 
+    /**
+      \brief Lets the deserializer read the given property file from the scene archive, if any, or the working directory
+    */
+    void InitializeDeserializer(PropertyListDeserializer *deserializer,
+                                const std::string &workingDirectory,
+                                const std::string &filename);
+
     typedef std::pair<DataNode::Pointer, std::list<std::string>> NodesAndParentsPair;
     typedef std::list<NodesAndParentsPair> OrderedNodesList;
     typedef std::map<std::string, DataNode *> IDToNodeMappingType;
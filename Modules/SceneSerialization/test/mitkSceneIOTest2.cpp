@@ -78,13 +78,21 @@ class mitkSceneIOTest2Suite : public mitk::TestFixture
   CPPUNIT_TEST_SUITE(mitkSceneIOTest2Suite);
   MITK_TEST(Test_SceneIOInterfaces);
   MITK_TEST(Test_ReconstructionOfScenes);
+  MITK_TEST(Test_ReconstructionOfUncompressedScenes);
+  MITK_TEST(Test_ParallelReconstructionOfScenes);
   CPPUNIT_TEST_SUITE_END();
 
   mitk::SceneIOTestScenarioProvider m_TestCaseProvider;
 
 public:
   void Test_SceneIOInterfaces() { CPPUNIT_ASSERT_MESSAGE("Not urgent", true); }
-  void Test_ReconstructionOfScenes()
+  void Test_ReconstructionOfScenes() { ReconstructScenes(0, 1, 1); }
+  /// images are not compressed
+  void Test_ReconstructionOfUncompressedScenes() { ReconstructScenes(1, 1, 1); }
+  /// opt-in concurrent saving and loading (see SceneIO::SetNumberOfThreads())
+  void Test_ParallelReconstructionOfScenes() { ReconstructScenes(0, 4, 4); }
+
+  void ReconstructScenes(std::size_t uncompressedImageThreshold, unsigned int savingThreads, unsigned int loadingThreads)
   {
     std::string tempDir = mitk::IOUtil::CreateTemporaryDirectory("SceneIOTest_XXXXXX");
 
@@ -96,6 +104,8 @@ public:
 
       std::string archiveFilename = mitk::IOUtil::CreateTemporaryFile("scene_XXXXXX.mitk", tempDir);
       mitk::SceneIO::Pointer writer = mitk::SceneIO::New();
+      writer->SetUncompressedImageThreshold(uncompressedImageThreshold);
+      writer->SetNumberOfThreads(savingThreads);
       mitk::DataStorage::Pointer originalStorage = scenario.BuildDataStorage();
       CPPUNIT_ASSERT_MESSAGE(
         std::string("Save test scenario '") + scenario.key + "' to '" + archiveFilename + "'",
@@ -104,6 +114,7 @@ public:
       if (scenario.serializable)
       {
         mitk::SceneIO::Pointer reader = mitk::SceneIO::New();
+        reader->SetNumberOfThreads(loadingThreads);
         mitk::DataStorage::Pointer restoredStorage;
         CPPUNIT_ASSERT_NO_THROW(restoredStorage = reader->LoadScene(archiveFilename));
         CPPUNIT_ASSERT_MESSAGE(
@@ -15,10 +15,8 @@ found in the LICENSE file.
 #include "mitkImageCast.h"
 #include <mitkITKImageImport.h>
 
-#include <itkFastChamferDistanceImageFilter.h>
-#include <itkInvertIntensityImageFilter.h>
-#include <itkIsoContourDistanceImageFilter.h>
-#include <itkSubtractImageFilter.h>
+#include <algorithm>
+#include <cmath>
 
 mitk::Image::Pointer mitk::ShapeBasedInterpolationAlgorithm::Interpolate(
   Image::ConstPointer lowerSlice,
@@ -49,48 +47,151 @@ template <typename TPixel, unsigned int VImageDimension>
 void mitk::ShapeBasedInterpolationAlgorithm::ComputeDistanceMap(const itk::Image<TPixel, VImageDimension> *binaryImage,
                                                                 mitk::Image::Pointer &result)
 {
-  typedef itk::Image<TPixel, VImageDimension> DistanceFilterInputImageType;
+  const auto &region = binaryImage->GetLargestPossibleRegion();
+  const unsigned int width = region.GetSize(0);
+  const unsigned int height = region.GetSize(1);
 
-  typedef itk::FastChamferDistanceImageFilter<DistanceFilterImageType, DistanceFilterImageType> DistanceFilterType;
-  typedef itk::IsoContourDistanceImageFilter<DistanceFilterInputImageType, DistanceFilterImageType> IsoContourType;
-  typedef itk::InvertIntensityImageFilter<DistanceFilterInputImageType> InvertIntensityImageFilterType;
-  typedef itk::SubtractImageFilter<DistanceFilterImageType, DistanceFilterImageType> SubtractImageFilterType;
+  std::vector<unsigned char> mask(width * height);
+  const TPixel *pixels = binaryImage->GetBufferPointer();
+  for (std::size_t i = 0; i < mask.size(); ++i)
+  {
+    mask[i] = pixels[i] != 0 ? 1 : 0;
+  }
 
-  typename DistanceFilterType::Pointer distanceFilter = DistanceFilterType::New();
-  typename DistanceFilterType::Pointer distanceFilterInverted = DistanceFilterType::New();
-  typename IsoContourType::Pointer isoContourFilter = IsoContourType::New();
-  typename IsoContourType::Pointer isoContourFilterInverted = IsoContourType::New();
-  typename InvertIntensityImageFilterType::Pointer invertFilter = InvertIntensityImageFilterType::New();
-  typename SubtractImageFilterType::Pointer subtractImageFilter = SubtractImageFilterType::New();
+  std::vector<float> distances;
+  ComputeSignedDistanceMap(mask.data(), width, height, distances);
 
-  // arbitrary maximum distance
-  int maximumDistance = 100;
+  typename DistanceFilterImageType::Pointer distanceImage = DistanceFilterImageType::New();
+  distanceImage->SetRegions(region);
+  distanceImage->SetOrigin(binaryImage->GetOrigin());
+  distanceImage->SetSpacing(binaryImage->GetSpacing());
+  distanceImage->SetDirection(binaryImage->GetDirection());
+  distanceImage->Allocate();
+  std::copy(distances.begin(), distances.end(), distanceImage->GetBufferPointer());
 
-  // this assumes the image contains only 1 and 0
-  invertFilter->SetInput(binaryImage);
-  invertFilter->SetMaximum(1);
+  result = mitk::GrabItkImageMemory(distanceImage.GetPointer());
+}
 
-  // do the processing on the image and the inverted image to get inside and outside distance
-  isoContourFilter->SetInput(binaryImage);
-  isoContourFilter->SetFarValue(maximumDistance + 1);
-  isoContourFilter->SetLevelSetValue(0);
+namespace
+{
+  // value of squared distances where there is no feature pixel at all
+  const float NoFeature = 1e20f;
 
-  isoContourFilterInverted->SetInput(invertFilter->GetOutput());
-  isoContourFilterInverted->SetFarValue(maximumDistance + 1);
-  isoContourFilterInverted->SetLevelSetValue(0);
+  // Lower envelope of parabolas rooted at the samples of f (Felzenszwalb and Huttenlocher, "Distance
+  // Transforms of Sampled Functions", 2012). v and z are workspaces of size n and n + 1.
+  void SquaredDistanceTransform1D(const float *f, float *d, unsigned int n, unsigned int *v, float *z)
+  {
+    unsigned int k = 0;
+    v[0] = 0;
+    z[0] = -NoFeature;
+    z[1] = NoFeature;
+
+    for (unsigned int q = 1; q < n; ++q)
+    {
+      float s = 0;
+      for (;;)
+      {
+        const float p = static_cast<float>(v[k]);
+        s = ((f[q] + float(q) * q) - (f[v[k]] + p * p)) / (2.0f * (q - p));
+        if (s > z[k] || k == 0)
+          break;
+        --k;
+      }
+
+      if (s <= z[k])
+      {
+        // only possible for k == 0, the new parabola hides the first one everywhere
+        v[0] = q;
+        z[0] = -NoFeature;
+        z[1] = NoFeature;
+        continue;
+      }
+
+      ++k;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = NoFeature;
+    }
+
+    k = 0;
+    for (unsigned int q = 0; q < n; ++q)
+    {
+      while (z[k + 1] < q)
+        ++k;
+      const float delta = float(q) - float(v[k]);
+      d[q] = delta * delta + f[v[k]];
+    }
+  }
 
-  distanceFilter->SetInput(isoContourFilter->GetOutput());
-  distanceFilter->SetMaximumDistance(maximumDistance);
+  // Squared distance of every pixel to the nearest pixel where mask equals feature
+  void SquaredDistanceTransform2D(const unsigned char *mask,
+                                  unsigned char feature,
+                                  unsigned int width,
+                                  unsigned int height,
+                                  std::vector<float> &result)
+  {
+    const unsigned int n = std::max(width, height);
+    std::vector<float> f(n);
+    std::vector<float> d(n);
+    std::vector<unsigned int> v(n);
+    std::vector<float> z(n + 1);
+
+    result.resize(static_cast<std::size_t>(width) * height);
+
+    // rows
+    for (unsigned int y = 0; y < height; ++y)
+    {
+      const unsigned char *row = mask + static_cast<std::size_t>(y) * width;
+      for (unsigned int x = 0; x < width; ++x)
+        f[x] = row[x] == feature ? 0.0f : NoFeature;
+
+      SquaredDistanceTransform1D(f.data(), result.data() + static_cast<std::size_t>(y) * width, width, v.data(), z.data());
+    }
+
+    // columns
+    for (unsigned int x = 0; x < width; ++x)
+    {
+      for (unsigned int y = 0; y < height; ++y)
+        f[y] = result[static_cast<std::size_t>(y) * width + x];
+
+      SquaredDistanceTransform1D(f.data(), d.data(), height, v.data(), z.data());
+
+      for (unsigned int y = 0; y < height; ++y)
+        result[static_cast<std::size_t>(y) * width + x] = d[y];
+    }
+  }
+}
+
+void mitk::ShapeBasedInterpolationAlgorithm::ComputeSignedDistanceMap(const unsigned char *mask,
+                                                                      unsigned int width,
+                                                                      unsigned int height,
+                                                                      std::vector<float> &distances)
+{
+  distances.clear();
+  if (width == 0 || height == 0)
+    return;
 
-  distanceFilterInverted->SetInput(isoContourFilterInverted->GetOutput());
-  distanceFilterInverted->SetMaximumDistance(maximumDistance);
+  std::vector<unsigned char> binaryMask(mask, mask + static_cast<std::size_t>(width) * height);
+  for (auto &value : binaryMask)
+    value = value != 0 ? 1 : 0;
 
-  // inside distance should be negative, outside distance positive
-  subtractImageFilter->SetInput2(distanceFilter->GetOutput());
-  subtractImageFilter->SetInput1(distanceFilterInverted->GetOutput());
-  subtractImageFilter->Update();
+  // distance of outside pixels to the segmentation and of inside pixels to the background
+  std::vector<float> outside;
+  std::vector<float> inside;
+  SquaredDistanceTransform2D(binaryMask.data(), 1, width, height, outside);
+  SquaredDistanceTransform2D(binaryMask.data(), 0, width, height, inside);
 
-  result = mitk::GrabItkImageMemory(subtractImageFilter->GetOutput());
+  // slices without segmentation or without background are farther away from a contour than any pixel
+  const float maximumDistance = static_cast<float>(width + height);
+
+  distances.resize(binaryMask.size());
+  for (std::size_t i = 0; i < binaryMask.size(); ++i)
+  {
+    if (binaryMask[i] != 0)
+      distances[i] = -(std::min(std::sqrt(inside[i]), maximumDistance) - 0.5f);
+    else
+      distances[i] = std::min(std::sqrt(outside[i]), maximumDistance) - 0.5f;
+  }
 }
 
 template <typename TPixel, unsigned int VImageDimension>
@@ -16,6 +16,8 @@ found in the LICENSE file.
 #include "mitkSegmentationInterpolationAlgorithm.h"
 #include <MitkSegmentationExports.h>
 
+#include <vector>
+
 namespace mitk
 {
   /**
@@ -27,6 +29,11 @@ namespace mitk
    * G.T. Herman, J. Zheng, C.A. Bucholtz: "Shape-based interpolation"
    * IEEE Computer Graphics & Applications, pp. 69-79,May 1992
    *
+   * The distance maps of the neighboring slices are exact Euclidean distance
+   * transforms (see ComputeSignedDistanceMap()), so they can be computed once per
+   * slice and shared by all interpolated slices in between (see
+   * SegmentationInterpolationController::InterpolateAll()).
+   *
    *  Last contributor:
    *  $Author:$
    */
@@ -47,6 +54,21 @@ namespace mitk
                                  unsigned int timeStep,
                                  Image::ConstPointer referenceImage) override;
 
+    /**
+      \brief Computes the signed Euclidean distance of every pixel to the contour of a binary slice.
+
+      Distances are given in pixels, pixels inside the segmentation get negative values and the contour
+      lies half a pixel off the centers of the border pixels. The transform is exact and linear in the
+      number of pixels (separable squared distance transform by Felzenszwalb and Huttenlocher).
+
+      \param mask width * height values in row-major order, values other than 0 are segmentation
+      \param distances resized to width * height
+    */
+    static void ComputeSignedDistanceMap(const unsigned char *mask,
+                                         unsigned int width,
+                                         unsigned int height,
+                                         std::vector<float> &distances);
+
   private:
     typedef itk::Image<mitk::ScalarType, 2> DistanceFilterImageType;
 
@@ -0,0 +1,338 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkThresholdPreviewUpdater.h"
+
+#include "mitkBaseRenderer.h"
+#include "mitkImageAccessByItk.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkImageTimeSelector.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkRenderingManager.h"
+#include "mitkSegTool2D.h"
+#include "mitkTool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace
+{
+  typedef void (*ThresholdFunctionType)(const void *input,
+                                        void *output,
+                                        const unsigned int *size,
+                                        const unsigned int *begin,
+                                        const unsigned int *end,
+                                        double lower,
+                                        double upper);
+
+  template <typename TInput, typename TOutput>
+  void ThresholdRegion(const void *input,
+                       void *output,
+                       const unsigned int *size,
+                       const unsigned int *begin,
+                       const unsigned int *end,
+                       double lower,
+                       double upper)
+  {
+    // the thresholds are converted like in itk::BinaryThresholdImageFilter
+    const auto lowerValue = static_cast<TInput>(lower);
+    const auto upperValue = static_cast<TInput>(upper);
+    const auto *inputPixels = static_cast<const TInput *>(input);
+    auto *outputPixels = static_cast<TOutput *>(output);
+
+    for (unsigned int z = begin[2]; z < end[2]; ++z)
+    {
+      for (unsigned int y = begin[1]; y < end[1]; ++y)
+      {
+        const std::size_t offset = (static_cast<std::size_t>(z) * size[1] + y) * size[0];
+        for (unsigned int x = begin[0]; x < end[0]; ++x)
+        {
+          const TInput value = inputPixels[offset + x];
+          outputPixels[offset + x] = (lowerValue <= value && value <= upperValue) ? 1 : 0;
+        }
+      }
+    }
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  void GetThresholdFunction(const itk::Image<TPixel, VImageDimension> *,
+                            bool hasUnsignedCharOutput,
+                            ThresholdFunctionType &function)
+  {
+    if (hasUnsignedCharOutput)
+      function = &ThresholdRegion<TPixel, unsigned char>;
+    else
+      function = &ThresholdRegion<TPixel, mitk::Tool::DefaultSegmentationDataType>;
+  }
+
+  // number of slices thresholded between two checks for cancellation
+  const unsigned int SlicesPerChunk = 8;
+}
+
+struct mitk::ThresholdPreviewUpdater::BackgroundTask
+{
+  double Lower;
+  double Upper;
+  ThresholdFunctionType Function;
+  unsigned int Size[3];
+  std::size_t BytesPerVolume;
+
+  /// keeps the input alive and its volumes locked for reading while the task is running
+  Image::ConstPointer Input;
+  std::vector<std::unique_ptr<ImageReadAccessor>> InputAccessors;
+  std::vector<const void *> InputData;
+  std::vector<std::vector<char>> Results;
+
+  std::atomic<bool> Cancelled;
+  std::atomic<bool> Finished;
+
+  BackgroundTask() : Cancelled(false), Finished(false) {}
+};
+
+mitk::ThresholdPreviewUpdater::ThresholdPreviewUpdater()
+{
+}
+
+mitk::ThresholdPreviewUpdater::~ThresholdPreviewUpdater()
+{
+  this->Cancel();
+}
+
+void mitk::ThresholdPreviewUpdater::SetInput(const Image *input)
+{
+  if (m_Input == input)
+    return;
+
+  this->Cancel();
+  m_Input = input;
+  this->Modified();
+}
+
+void mitk::ThresholdPreviewUpdater::SetPreview(Image *preview)
+{
+  if (m_Preview == preview)
+    return;
+
+  this->Cancel();
+  m_Preview = preview;
+  this->Modified();
+}
+
+bool mitk::ThresholdPreviewUpdater::CheckImages() const
+{
+  if (m_Input.IsNull() || m_Preview.IsNull())
+    return false;
+
+  if (m_Input->GetDimension() < 2 || m_Input->GetDimension() > 4 ||
+      m_Input->GetDimension(0) != m_Preview->GetDimension(0) || m_Input->GetDimension(1) != m_Preview->GetDimension(1) ||
+      (m_Input->GetDimension() > 2 && m_Input->GetDimension(2) != m_Preview->GetDimension(2)))
+  {
+    MITK_ERROR << "Threshold preview does not have the extent of the thresholded image.";
+    return false;
+  }
+
+  const auto componentType = m_Preview->GetPixelType().GetComponentType();
+  if (componentType != itk::ImageIOBase::UCHAR &&
+      m_Preview->GetPixelType() != MakeScalarPixelType<Tool::DefaultSegmentationDataType>())
+  {
+    MITK_ERROR << "Threshold preview has an unsupported pixel type.";
+    return false;
+  }
+
+  return true;
+}
+
+void mitk::ThresholdPreviewUpdater::Update(double lower,
+                                           double upper,
+                                           unsigned int timeStep,
+                                           const std::vector<SliceType> &slices)
+{
+  this->Cancel();
+
+  if (!this->CheckImages())
+    return;
+
+  auto task = std::make_shared<BackgroundTask>();
+  task->Lower = lower;
+  task->Upper = upper;
+  task->Input = m_Input;
+  task->Function = nullptr;
+  for (unsigned int dim = 0; dim < 3; ++dim)
+    task->Size[dim] = dim < m_Input->GetDimension() ? m_Input->GetDimension(dim) : 1;
+
+  const bool hasUnsignedCharOutput = m_Preview->GetPixelType().GetComponentType() == itk::ImageIOBase::UCHAR;
+  task->BytesPerVolume = static_cast<std::size_t>(task->Size[0]) * task->Size[1] * task->Size[2] *
+                         (hasUnsignedCharOutput ? sizeof(unsigned char) : sizeof(Tool::DefaultSegmentationDataType));
+
+  try
+  {
+    // only the pixel type is needed here, which is the same for all time steps
+    ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
+    timeSelector->SetInput(m_Input);
+    timeSelector->SetTimeNr(0);
+    timeSelector->UpdateLargestPossibleRegion();
+    Image::Pointer image3D = timeSelector->GetOutput();
+
+    AccessByItk_n(image3D, GetThresholdFunction, (hasUnsignedCharOutput, task->Function));
+  }
+  catch (const AccessByItkException &e)
+  {
+    MITK_ERROR << "Cannot threshold image for preview: " << e.what();
+    return;
+  }
+
+  const unsigned int timeSteps = std::min(m_Input->GetTimeSteps(), m_Preview->GetTimeSteps());
+  for (unsigned int t = 0; t < timeSteps; ++t)
+  {
+    task->InputAccessors.emplace_back(new ImageReadAccessor(m_Input, m_Input->GetVolumeData(t)));
+    task->InputData.push_back(task->InputAccessors.back()->GetData());
+  }
+
+  // the visible slices first
+  if (timeStep < timeSteps)
+  {
+    ImageWriteAccessor previewAccess(m_Preview, m_Preview->GetVolumeData(timeStep));
+    for (const auto &slice : slices)
+    {
+      if (slice.first > 2 || slice.second >= task->Size[slice.first])
+        continue;
+
+      unsigned int begin[3] = {0, 0, 0};
+      unsigned int end[3] = {task->Size[0], task->Size[1], task->Size[2]};
+      begin[slice.first] = slice.second;
+      end[slice.first] = slice.second + 1;
+
+      task->Function(task->InputData[timeStep], previewAccess.GetData(), task->Size, begin, end, lower, upper);
+    }
+  }
+  m_Preview->Modified();
+
+  // then the whole image in the background
+  m_Task = task;
+  m_Thread = std::thread([this, task]() {
+    this->ThresholdAll(*task);
+
+    if (!task->Cancelled)
+    {
+      task->Finished = true;
+      this->BackgroundThresholdingFinished.Send();
+    }
+  });
+}
+
+void mitk::ThresholdPreviewUpdater::ThresholdAll(BackgroundTask &task) const
+{
+  task.Results.resize(task.InputData.size());
+  for (std::size_t t = 0; t < task.InputData.size(); ++t)
+  {
+    task.Results[t].resize(task.BytesPerVolume);
+
+    for (unsigned int z = 0; z < task.Size[2]; z += SlicesPerChunk)
+    {
+      if (task.Cancelled)
+        return;
+
+      const unsigned int begin[3] = {0, 0, z};
+      const unsigned int end[3] = {task.Size[0], task.Size[1], std::min(z + SlicesPerChunk, task.Size[2])};
+      task.Function(task.InputData[t], task.Results[t].data(), task.Size, begin, end, task.Lower, task.Upper);
+    }
+  }
+}
+
+bool mitk::ThresholdPreviewUpdater::ApplyBackgroundResult()
+{
+  if (!m_Task || !m_Task->Finished)
+    return false;
+
+  if (m_Thread.joinable())
+    m_Thread.join();
+
+  for (std::size_t t = 0; t < m_Task->Results.size(); ++t)
+  {
+    m_Preview->SetVolume(m_Task->Results[t].data(), static_cast<int>(t));
+  }
+
+  m_Task.reset();
+  m_Preview->Modified();
+  return true;
+}
+
+void mitk::ThresholdPreviewUpdater::Finish()
+{
+  if (!m_Task)
+    return;
+
+  // the task is only cancelled together with resetting m_Task, so the thread completes it
+  if (m_Thread.joinable())
+    m_Thread.join();
+
+  this->ApplyBackgroundResult();
+}
+
+void mitk::ThresholdPreviewUpdater::Cancel()
+{
+  if (m_Task)
+    m_Task->Cancelled = true;
+
+  if (m_Thread.joinable())
+    m_Thread.join();
+
+  m_Task.reset();
+}
+
+void mitk::ThresholdPreviewUpdater::GetVisibleSlices(const Image *image,
+                                                     std::vector<SliceType> &slices,
+                                                     unsigned int &timeStep)
+{
+  slices.clear();
+  timeStep = 0;
+
+  if (!image)
+    return;
+
+  if (image->GetDimension() == 2)
+  {
+    slices.emplace_back(2, 0);
+    return;
+  }
+
+  bool hasTimeStep(false);
+  for (auto renderWindow : RenderingManager::GetInstance()->GetAllRegisteredRenderWindows())
+  {
+    BaseRenderer *renderer = BaseRenderer::GetInstance(renderWindow);
+    if (!renderer || renderer->GetMapperID() != BaseRenderer::Standard2D || !renderer->GetCurrentWorldPlaneGeometry())
+      continue;
+
+    if (!hasTimeStep)
+    {
+      const int rendererTimeStep = renderer->GetTimeStep(image);
+      timeStep = rendererTimeStep > 0 ? static_cast<unsigned int>(rendererTimeStep) : 0;
+      hasTimeStep = true;
+    }
+
+    int sliceDimension(-1);
+    int sliceIndex(-1);
+    if (SegTool2D::DetermineAffectedImageSlice(image, renderer->GetCurrentWorldPlaneGeometry(), sliceDimension, sliceIndex))
+    {
+      slices.emplace_back(sliceDimension, sliceIndex);
+    }
+    else if (sliceDimension < 0)
+    {
+      // oblique plane, it may cut every slice
+      slices.clear();
+      for (unsigned int index = 0; index < image->GetDimension(2); ++index)
+        slices.emplace_back(2, index);
+      return;
+    }
+  }
+}
@@ -0,0 +1,118 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef mitkThresholdPreviewUpdater_h_Included
+#define mitkThresholdPreviewUpdater_h_Included
+
+#include "mitkCommon.h"
+#include "mitkImage.h"
+#include "mitkMessage.h"
+#include <MitkSegmentationExports.h>
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Updates the binary preview of a threshold tool, visible slices first.
+
+    Update() immediately thresholds the given slices (usually the ones shown in the render windows, see
+    GetVisibleSlices()) into the preview image. The whole image is then thresholded on a background thread into a
+    separate buffer. A new call of Update() cancels this background thresholding and starts it again with the new
+    threshold values.
+
+    As soon as the background thresholding is complete, BackgroundThresholdingFinished is sent from the background
+    thread. The result is written into the preview by ApplyBackgroundResult() or Finish(), which have to be called
+    from the thread owning the preview (usually the GUI thread).
+
+    The preview must have the extent of the input and unsigned char or Tool::DefaultSegmentationDataType pixels.
+    The input is locked for reading from Update() until the result is applied or the thresholding is cancelled,
+    so it must not be written in the meantime.
+
+    \sa BinaryThresholdTool
+    \sa BinaryThresholdULTool
+  */
+  class MITKSEGMENTATION_EXPORT ThresholdPreviewUpdater : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ThresholdPreviewUpdater, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /// slice of a 3D image given by the dimension which is constant for all its pixels and the slice index
+    typedef std::pair<unsigned int, unsigned int> SliceType;
+
+    /**
+      \brief Sent from the background thread when the whole image has been thresholded.
+    */
+    Message<> BackgroundThresholdingFinished;
+
+    void SetInput(const Image *input);
+    void SetPreview(Image *preview);
+
+    /**
+      \brief Thresholds slices of one time step into the preview and restarts the background thresholding.
+
+      Pixels with values in [lower, upper] become 1, all others 0.
+    */
+    void Update(double lower, double upper, unsigned int timeStep, const std::vector<SliceType> &slices);
+
+    /**
+      \brief Writes the result of the background thresholding into the preview if it is complete.
+      \return true if the preview was changed
+    */
+    bool ApplyBackgroundResult();
+
+    /**
+      \brief Completes the preview for the values of the last Update().
+
+      Waits for the background thresholding and writes its result into the preview. Does nothing after Cancel().
+    */
+    void Finish();
+
+    /**
+      \brief Stops the background thresholding, the preview is not changed.
+    */
+    void Cancel();
+
+    /**
+      \brief Determines the slices of image that are shown in the 2D render windows.
+
+      If a render window shows an oblique plane, all slices are returned.
+      \param timeStep time step of image shown in the render windows
+    */
+    static void GetVisibleSlices(const Image *image, std::vector<SliceType> &slices, unsigned int &timeStep);
+
+  protected:
+    ThresholdPreviewUpdater();
+    ~ThresholdPreviewUpdater() override;
+
+  private:
+    struct BackgroundTask;
+
+    bool CheckImages() const;
+    void ThresholdAll(BackgroundTask &task) const;
+
+    Image::ConstPointer m_Input;
+    Image::Pointer m_Preview;
+
+    std::shared_ptr<BackgroundTask> m_Task;
+    std::thread m_Thread;
+  };
+}
+
+#endif
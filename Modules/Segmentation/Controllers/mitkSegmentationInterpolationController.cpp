@@ -15,6 +15,7 @@ found in the LICENSE file.
 #include "mitkImageCast.h"
 #include "mitkImageReadAccessor.h"
 #include "mitkImageTimeSelector.h"
+#include "mitkImageWriteAccessor.h"
 #include <mitkExtractSliceFilter.h>
 #include <mitkImageAccessByItk.h>
 //#include <mitkPlaneGeometry.h>
@@ -24,6 +25,43 @@ found in the LICENSE file.
 #include <itkCommand.h>
 #include <itkImage.h>
 #include <itkImageSliceConstIteratorWithIndex.h>
+#include <itkTimeStamp.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+namespace
+{
+  itk::ModifiedTimeType NewSliceModifiedTime()
+  {
+    itk::TimeStamp stamp;
+    stamp.Modified();
+    return stamp.GetMTime();
+  }
+
+  // the two dimensions spanning a slice, as used in SetChangedSlice()
+  void GetSliceDimensions(unsigned int sliceDimension, unsigned int &dim0, unsigned int &dim1)
+  {
+    switch (sliceDimension)
+    {
+      default:
+      case 2:
+        dim0 = 0;
+        dim1 = 1;
+        break;
+      case 1:
+        dim0 = 0;
+        dim1 = 2;
+        break;
+      case 0:
+        dim0 = 1;
+        dim1 = 2;
+        break;
+    }
+  }
+}
 
 mitk::SegmentationInterpolationController::InterpolatorMapType
   mitk::SegmentationInterpolationController::s_InterpolatorForImage; // static member initialization
@@ -93,6 +131,8 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
 {
   // clear old information (remove all time steps
   m_SegmentationCountInSlice.clear();
+  m_SliceModifiedTime.clear();
+  m_DistanceMapCache.clear();
 
   // delete this from the list of interpolators
   auto iter = s_InterpolatorForImage.find(segmentation);
@@ -119,15 +159,19 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
 
   m_Segmentation = segmentation;
 
+  const itk::ModifiedTimeType sliceModifiedTime = NewSliceModifiedTime();
   m_SegmentationCountInSlice.resize(m_Segmentation->GetTimeSteps());
+  m_SliceModifiedTime.resize(m_Segmentation->GetTimeSteps());
   for (unsigned int timeStep = 0; timeStep < m_Segmentation->GetTimeSteps(); ++timeStep)
   {
     m_SegmentationCountInSlice[timeStep].resize(3);
+    m_SliceModifiedTime[timeStep].resize(3);
     for (unsigned int dim = 0; dim < 3; ++dim)
     {
       m_SegmentationCountInSlice[timeStep][dim].clear();
       m_SegmentationCountInSlice[timeStep][dim].resize(m_Segmentation->GetDimension(dim));
       m_SegmentationCountInSlice[timeStep][dim].assign(m_Segmentation->GetDimension(dim), 0);
+      m_SliceModifiedTime[timeStep][dim].assign(m_Segmentation->GetDimension(dim), sliceModifiedTime);
     }
   }
 
@@ -212,22 +256,7 @@ void mitk::SegmentationInterpolationController::SetChangedSlice(const Image *sli
   unsigned int dim1(1);
 
   // determine the other two dimensions
-  switch (sliceDimension)
-  {
-    default:
-    case 2:
-      dim0 = 0;
-      dim1 = 1;
-      break;
-    case 1:
-      dim0 = 0;
-      dim1 = 2;
-      break;
-    case 0:
-      dim0 = 1;
-      dim1 = 2;
-      break;
-  }
+  GetSliceDimensions(sliceDimension, dim0, dim1);
 
   mitk::ImageReadAccessor readAccess(sliceDiff);
   auto *rawSlice = (unsigned char *)readAccess.GetData();
@@ -260,6 +289,8 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
   unsigned int dim1(options.dim1);
 
   int numberOfPixels(0); // number of pixels in this slice that are not 0
+  bool sliceChanged(false);
+  const itk::ModifiedTimeType sliceModifiedTime = NewSliceModifiedTime();
 
   unsigned int dim0max = m_SegmentationCountInSlice[timeStep][dim0].size();
   unsigned int dim1max = m_SegmentationCountInSlice[timeStep][dim1].size();
@@ -281,9 +312,19 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
       m_SegmentationCountInSlice[timeStep][dim1][v] =
         static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim1][v] + value);
       numberOfPixels += static_cast<int>(value);
+
+      if (value != 0)
+      {
+        m_SliceModifiedTime[timeStep][dim0][u] = sliceModifiedTime;
+        m_SliceModifiedTime[timeStep][dim1][v] = sliceModifiedTime;
+        sliceChanged = true;
+      }
     }
   }
 
+  if (sliceChanged)
+    m_SliceModifiedTime[timeStep][sliceDimension][sliceIndex] = sliceModifiedTime;
+
   // flag for the dimension of the slice itself
   assert((signed)m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] + numberOfPixels >= 0);
   m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] += numberOfPixels;
@@ -304,6 +345,8 @@ void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Ima
   iter.SetSecondDirection(1);
 
   int numberOfPixels(0); // number of pixels in this slice that are not 0
+  bool sliceChanged(false);
+  const itk::ModifiedTimeType sliceModifiedTime = NewSliceModifiedTime();
 
   typename IteratorType::IndexType index;
   unsigned int x = 0;
@@ -336,6 +379,13 @@ void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Ima
 
         numberOfPixels += static_cast<int>(value);
 
+        if (value != 0)
+        {
+          m_SliceModifiedTime[timeStep][0][x] = sliceModifiedTime;
+          m_SliceModifiedTime[timeStep][1][y] = sliceModifiedTime;
+          sliceChanged = true;
+        }
+
         ++iter;
       }
       iter.NextLine();
@@ -344,6 +394,10 @@ void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Ima
     m_SegmentationCountInSlice[timeStep][2][z] += numberOfPixels;
     numberOfPixels = 0;
 
+    if (sliceChanged)
+      m_SliceModifiedTime[timeStep][2][z] = sliceModifiedTime;
+    sliceChanged = false;
+
     iter.NextSlice();
   }
 }
@@ -584,3 +638,188 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
                                 timeStep,
                                 m_ReferenceImage);
 }
+
+unsigned int mitk::SegmentationInterpolationController::InterpolateAll(unsigned int sliceDimension,
+                                                                       unsigned int timeStep,
+                                                                       Image *result)
+{
+  if (m_Segmentation.IsNull() || !result)
+    return 0;
+
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return 0;
+  if (sliceDimension > 2)
+    return 0;
+
+  if (result->GetDimension() != 3 || result->GetPixelType() != m_Segmentation->GetPixelType())
+  {
+    MITK_ERROR << "Result of the 2D interpolation needs the pixel type of the segmentation and 3 dimensions.";
+    return 0;
+  }
+
+  for (unsigned int dim = 0; dim < 3; ++dim)
+  {
+    if (result->GetDimension(dim) != m_Segmentation->GetDimension(dim))
+    {
+      MITK_ERROR << "Result of the 2D interpolation needs the extent of the segmentation.";
+      return 0;
+    }
+  }
+
+  ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
+  timeSelector->SetInput(m_Segmentation);
+  timeSelector->SetTimeNr(timeStep);
+  timeSelector->UpdateLargestPossibleRegion();
+  Image::Pointer segmentation3D = timeSelector->GetOutput();
+
+  unsigned int numberOfInterpolatedSlices(0);
+  AccessFixedDimensionByItk_n(
+    segmentation3D, InterpolateAllSlices, 3, (sliceDimension, timeStep, result, numberOfInterpolatedSlices));
+
+  return numberOfInterpolatedSlices;
+}
+
+template <typename TPixel, unsigned int VImageDimension>
+void mitk::SegmentationInterpolationController::InterpolateAllSlices(
+  const itk::Image<TPixel, VImageDimension> *segmentation,
+  unsigned int sliceDimension,
+  unsigned int timeStep,
+  Image *result,
+  unsigned int &numberOfInterpolatedSlices)
+{
+  const DirtyVectorType &countInSlice = m_SegmentationCountInSlice[timeStep][sliceDimension];
+  const auto &sliceModifiedTime = m_SliceModifiedTime[timeStep][sliceDimension];
+
+  // pairs of neighboring segmented slices with empty slices in between
+  std::vector<std::pair<unsigned int, unsigned int>> gaps;
+  std::vector<unsigned int> boundarySlices;
+  bool hasLowerBound(false);
+  unsigned int lowerBound(0);
+  for (unsigned int sliceIndex = 0; sliceIndex < countInSlice.size(); ++sliceIndex)
+  {
+    if (countInSlice[sliceIndex] == 0)
+      continue;
+
+    if (hasLowerBound && sliceIndex - lowerBound > 1)
+    {
+      if (boundarySlices.empty() || boundarySlices.back() != lowerBound)
+        boundarySlices.push_back(lowerBound);
+      boundarySlices.push_back(sliceIndex);
+      gaps.emplace_back(lowerBound, sliceIndex);
+    }
+
+    hasLowerBound = true;
+    lowerBound = sliceIndex;
+  }
+
+  // forget distance maps of slices that are no longer segmented
+  for (auto iter = m_DistanceMapCache.begin(); iter != m_DistanceMapCache.end();)
+  {
+    if (std::get<0>(iter->first) == timeStep && std::get<1>(iter->first) == sliceDimension &&
+        countInSlice[std::get<2>(iter->first)] == 0)
+    {
+      iter = m_DistanceMapCache.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  if (gaps.empty())
+    return;
+
+  unsigned int dim0(0);
+  unsigned int dim1(1);
+  GetSliceDimensions(sliceDimension, dim0, dim1);
+
+  const auto &size = segmentation->GetLargestPossibleRegion().GetSize();
+  const std::size_t stride[3] = {1, size[0], size[0] * size[1]};
+  const unsigned int width = size[dim0];
+  const unsigned int height = size[dim1];
+  const TPixel *segmentationPixels = segmentation->GetBufferPointer();
+
+  // look up all distance maps before the threads start, remember the ones which are missing or outdated
+  std::map<unsigned int, std::vector<float> *> distanceMaps;
+  std::vector<unsigned int> outdatedMaps;
+  for (unsigned int sliceIndex : boundarySlices)
+  {
+    DistanceMapCacheEntry &entry = m_DistanceMapCache[std::make_tuple(timeStep, sliceDimension, sliceIndex)];
+    if (entry.Distances.empty() || entry.SliceMTime != sliceModifiedTime[sliceIndex])
+    {
+      entry.SliceMTime = sliceModifiedTime[sliceIndex];
+      outdatedMaps.push_back(sliceIndex);
+    }
+    distanceMaps[sliceIndex] = &entry.Distances;
+  }
+
+  auto sliceOffset = [&](unsigned int sliceIndex) { return sliceIndex * stride[sliceDimension]; };
+
+  auto computeDistanceMap = [&](std::size_t job) {
+    const unsigned int sliceIndex = outdatedMaps[job];
+    const TPixel *slice = segmentationPixels + sliceOffset(sliceIndex);
+
+    std::vector<unsigned char> mask(static_cast<std::size_t>(width) * height);
+    for (unsigned int v = 0; v < height; ++v)
+      for (unsigned int u = 0; u < width; ++u)
+        mask[v * width + u] = slice[u * stride[dim0] + v * stride[dim1]] != 0 ? 1 : 0;
+
+    ShapeBasedInterpolationAlgorithm::ComputeSignedDistanceMap(mask.data(), width, height, *distanceMaps.at(sliceIndex));
+  };
+
+  // every interpolated slice is written by exactly one job, so the jobs do not need to synchronize
+  ImageWriteAccessor resultAccess(result);
+  auto *resultPixels = static_cast<TPixel *>(resultAccess.GetData());
+
+  auto interpolateSlice = [&](std::size_t gap, unsigned int sliceIndex) {
+    const unsigned int lower = gaps[gap].first;
+    const unsigned int upper = gaps[gap].second;
+    const std::vector<float> &lowerDistances = *distanceMaps.at(lower);
+    const std::vector<float> &upperDistances = *distanceMaps.at(upper);
+
+    const float ratio = static_cast<float>(sliceIndex - lower) / static_cast<float>(upper - lower);
+    TPixel *slice = resultPixels + sliceOffset(sliceIndex);
+
+    for (unsigned int v = 0; v < height; ++v)
+    {
+      for (unsigned int u = 0; u < width; ++u)
+      {
+        const std::size_t i = v * width + u;
+        const float distance = (1.0f - ratio) * lowerDistances[i] + ratio * upperDistances[i];
+        slice[u * stride[dim0] + v * stride[dim1]] = static_cast<TPixel>(distance > 0 ? 0 : 1);
+      }
+    }
+  };
+
+  std::vector<std::pair<std::size_t, unsigned int>> interpolatedSlices;
+  for (std::size_t gap = 0; gap < gaps.size(); ++gap)
+  {
+    for (unsigned int sliceIndex = gaps[gap].first + 1; sliceIndex < gaps[gap].second; ++sliceIndex)
+      interpolatedSlices.emplace_back(gap, sliceIndex);
+  }
+
+  auto runConcurrently = [](std::size_t numberOfJobs, const std::function<void(std::size_t)> &job) {
+    std::atomic<std::size_t> nextJob(0);
+    auto work = [&]() {
+      for (std::size_t i = nextJob++; i < numberOfJobs; i = nextJob++)
+        job(i);
+    };
+
+    const unsigned int numberOfThreads = static_cast<unsigned int>(
+      std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), numberOfJobs)));
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+      threads.emplace_back(work);
+    work();
+    for (auto &thread : threads)
+      thread.join();
+  };
+
+  runConcurrently(outdatedMaps.size(), computeDistanceMap);
+  runConcurrently(interpolatedSlices.size(), [&](std::size_t i) {
+    interpolateSlice(interpolatedSlices[i].first, interpolatedSlices[i].second);
+  });
+
+  numberOfInterpolatedSlices = static_cast<unsigned int>(interpolatedSlices.size());
+}
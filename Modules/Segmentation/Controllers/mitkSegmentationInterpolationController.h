@@ -21,6 +21,7 @@ found in the LICENSE file.
 #include <itkObjectFactory.h>
 
 #include <map>
+#include <tuple>
 #include <vector>
 
 namespace mitk
@@ -142,6 +143,24 @@ namespace mitk
                                const mitk::PlaneGeometry *currentPlane,
                                unsigned int timeStep);
 
+    /**
+      \brief Interpolates all empty slices between two segmented slices of one orientation at once.
+
+      The signed distance map of every segmented slice is computed only once and cached until the slice
+      changes. The empty slices are then filled concurrently.
+
+      \param sliceDimension Number of the dimension which is constant for all pixels of the meant slices.
+
+      \param timeStep Which time step to use
+
+      \param result 3D image with the extent and pixel type of the segmentation. Only the interpolated slices are
+             written. Since these slices are empty in the segmentation, a result that was filled with 0 before is the
+             difference image of the interpolation (see mitk::ApplyDiffImageOperation).
+
+      \return Number of interpolated slices
+    */
+    unsigned int InterpolateAll(unsigned int sliceDimension, unsigned int timeStep, Image *result);
+
     void OnImageModified(const itk::EventObject &);
 
     /**
@@ -180,6 +199,17 @@ namespace mitk
     // used for implementation
     typedef std::vector<std::vector<DirtyVectorType>> TimeResolvedDirtyVectorType;
     typedef std::map<const Image *, SegmentationInterpolationController *> InterpolatorMapType;
+    typedef std::vector<std::vector<std::vector<itk::ModifiedTimeType>>> TimeResolvedModifiedTimeType;
+
+    /// signed distance map of a segmented slice, valid as long as the slice is not modified after SliceMTime
+    struct DistanceMapCacheEntry
+    {
+      itk::ModifiedTimeType SliceMTime;
+      std::vector<float> Distances;
+    };
+
+    /// key is (time step, slice dimension, slice index)
+    typedef std::map<std::tuple<unsigned int, unsigned int, unsigned int>, DistanceMapCacheEntry> DistanceMapCacheType;
 
     SegmentationInterpolationController(); // purposely hidden
     ~SegmentationInterpolationController() override;
@@ -194,6 +224,13 @@ namespace mitk
     template <typename DATATYPE>
     void ScanWholeVolume(const itk::Image<DATATYPE, 3> *, const Image *volume, unsigned int timeStep);
 
+    template <typename TPixel, unsigned int VImageDimension>
+    void InterpolateAllSlices(const itk::Image<TPixel, VImageDimension> *segmentation,
+                              unsigned int sliceDimension,
+                              unsigned int timeStep,
+                              Image *result,
+                              unsigned int &numberOfInterpolatedSlices);
+
     void PrintStatus();
 
     /**
@@ -207,6 +244,14 @@ namespace mitk
     */
     TimeResolvedDirtyVectorType m_SegmentationCountInSlice;
 
+    /**
+      Time of the last change of each slice, indexed like m_SegmentationCountInSlice. Decides whether a
+      distance map in m_DistanceMapCache is still valid.
+    */
+    TimeResolvedModifiedTimeType m_SliceModifiedTime;
+
+    DistanceMapCacheType m_DistanceMapCache;
+
     static InterpolatorMapType s_InterpolatorForImage;
 
     Image::ConstPointer m_Segmentation;
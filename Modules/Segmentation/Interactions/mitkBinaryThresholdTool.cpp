@@ -55,10 +55,17 @@ mitk::BinaryThresholdTool::BinaryThresholdTool()
   m_ThresholdFeedbackNode->SetProperty("opacity", FloatProperty::New(0.3));
   m_ThresholdFeedbackNode->SetProperty("binary", BoolProperty::New(true));
   m_ThresholdFeedbackNode->SetProperty("helper object", BoolProperty::New(true));
+
+  m_PreviewUpdater = ThresholdPreviewUpdater::New();
+  m_PreviewUpdater->BackgroundThresholdingFinished +=
+    mitk::MessageDelegate<mitk::BinaryThresholdTool>(this, &mitk::BinaryThresholdTool::OnBackgroundThresholdingFinished);
 }
 
 mitk::BinaryThresholdTool::~BinaryThresholdTool()
 {
+  m_PreviewUpdater->Cancel();
+  m_PreviewUpdater->BackgroundThresholdingFinished -=
+    mitk::MessageDelegate<mitk::BinaryThresholdTool>(this, &mitk::BinaryThresholdTool::OnBackgroundThresholdingFinished);
 }
 
 const char **mitk::BinaryThresholdTool::GetXPM() const
@@ -102,6 +109,9 @@ void mitk::BinaryThresholdTool::Deactivated()
 {
   m_ToolManager->RoiDataChanged -=
     mitk::MessageDelegate<mitk::BinaryThresholdTool>(this, &mitk::BinaryThresholdTool::OnRoiDataChanged);
+  m_PreviewUpdater->Cancel();
+  m_PreviewUpdater->SetInput(nullptr);
+  m_PreviewUpdater->SetPreview(nullptr);
   m_NodeForThresholding = nullptr;
   m_OriginalImageNode = nullptr;
   try
@@ -153,6 +163,9 @@ void mitk::BinaryThresholdTool::SetThresholdValue(double value)
 
 void mitk::BinaryThresholdTool::AcceptCurrentThresholdValue()
 {
+  // the segmentation is created from the preview of the whole image
+  m_PreviewUpdater->Finish();
+
   CreateNewSegmentationFromThreshold(m_NodeForThresholding);
 
   RenderingManager::GetInstance()->RequestUpdateAll();
@@ -347,72 +360,35 @@ void mitk::BinaryThresholdTool::OnRoiDataChanged()
   this->UpdatePreview();
 }
 
-template <typename TPixel, unsigned int VImageDimension>
-void mitk::BinaryThresholdTool::ITKThresholding(itk::Image<TPixel, VImageDimension> *originalImage,
-                                                Image *segmentation,
-                                                double thresholdValue,
-                                                unsigned int timeStep)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<mitk::Tool::DefaultSegmentationDataType, VImageDimension> SegmentationType;
-  typedef itk::BinaryThresholdImageFilter<ImageType, SegmentationType> ThresholdFilterType;
-
-  typename ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
-  filter->SetInput(originalImage);
-  filter->SetLowerThreshold(thresholdValue);
-  filter->SetUpperThreshold(m_SensibleMaximumThresholdValue);
-  filter->SetInsideValue(1);
-  filter->SetOutsideValue(0);
-  filter->Update();
-
-  segmentation->SetVolume((void *)(filter->GetOutput()->GetPixelContainer()->GetBufferPointer()), timeStep);
-}
-
-template <typename TPixel, unsigned int VImageDimension>
-void mitk::BinaryThresholdTool::ITKThresholdingOldBinary(itk::Image<TPixel, VImageDimension> *originalImage,
-                                                         Image *segmentation,
-                                                         double thresholdValue,
-                                                         unsigned int timeStep)
-{
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<unsigned char, VImageDimension> SegmentationType;
-  typedef itk::BinaryThresholdImageFilter<ImageType, SegmentationType> ThresholdFilterType;
-
-  typename ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
-  filter->SetInput(originalImage);
-  filter->SetLowerThreshold(thresholdValue);
-  filter->SetUpperThreshold(m_SensibleMaximumThresholdValue);
-  filter->SetInsideValue(1);
-  filter->SetOutsideValue(0);
-  filter->Update();
-
-  segmentation->SetVolume((void *)(filter->GetOutput()->GetPixelContainer()->GetBufferPointer()), timeStep);
-}
-
 void mitk::BinaryThresholdTool::UpdatePreview()
 {
   mitk::Image::Pointer thresholdImage = dynamic_cast<mitk::Image *>(m_NodeForThresholding->GetData());
   mitk::Image::Pointer previewImage = dynamic_cast<mitk::Image *>(m_ThresholdFeedbackNode->GetData());
   if (thresholdImage && previewImage)
   {
-    for (unsigned int timeStep = 0; timeStep < thresholdImage->GetTimeSteps(); ++timeStep)
-    {
-      ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
-      timeSelector->SetInput(thresholdImage);
-      timeSelector->SetTimeNr(timeStep);
-      timeSelector->UpdateLargestPossibleRegion();
-      Image::Pointer feedBackImage3D = timeSelector->GetOutput();
+    // the slices in the render windows are thresholded immediately, the rest of the image in the background
+    std::vector<ThresholdPreviewUpdater::SliceType> visibleSlices;
+    unsigned int timeStep(0);
+    ThresholdPreviewUpdater::GetVisibleSlices(thresholdImage, visibleSlices, timeStep);
 
-      if (m_IsOldBinary)
-      {
-        AccessByItk_n(feedBackImage3D, ITKThresholdingOldBinary, (previewImage, m_CurrentThresholdValue, timeStep));
-      }
-      else
-      {
-        AccessByItk_n(feedBackImage3D, ITKThresholding, (previewImage, m_CurrentThresholdValue, timeStep));
-      }
-    }
+    m_PreviewUpdater->SetInput(thresholdImage);
+    m_PreviewUpdater->SetPreview(previewImage);
+    m_PreviewUpdater->Update(m_CurrentThresholdValue, m_SensibleMaximumThresholdValue, timeStep, visibleSlices);
 
     RenderingManager::GetInstance()->RequestUpdateAll();
   }
 }
+
+void mitk::BinaryThresholdTool::OnBackgroundThresholdingFinished()
+{
+  // called from the background thread
+  BackgroundPreviewFinished.Send();
+}
+
+void mitk::BinaryThresholdTool::ApplyBackgroundPreview()
+{
+  if (m_PreviewUpdater->ApplyBackgroundResult())
+  {
+    RenderingManager::GetInstance()->RequestUpdateAll();
+  }
+}
@@ -16,6 +16,7 @@ found in the LICENSE file.
 #include "mitkAutoSegmentationTool.h"
 #include "mitkCommon.h"
 #include "mitkDataNode.h"
+#include "mitkThresholdPreviewUpdater.h"
 #include <MitkSegmentationExports.h>
 
 #include <itkImage.h>
@@ -30,6 +31,10 @@ namespace mitk
   /**
   \brief Calculates the segmented volumes for binary images.
 
+  The preview follows the threshold value immediately in the slices shown in the render windows. The rest of the
+  image is thresholded in the background (see mitk::ThresholdPreviewUpdater). When this is done, BackgroundPreviewFinished
+  is sent from the background thread and ApplyBackgroundPreview() should be called from the GUI thread.
+
   \ingroup ToolManagerEtAl
   \sa mitk::Tool
   \sa QmitkInteractiveSegmentation
@@ -41,6 +46,7 @@ namespace mitk
   public:
     Message3<double, double, bool> IntervalBordersChanged;
     Message1<double> ThresholdingValueChanged;
+    Message<> BackgroundPreviewFinished;
 
     mitkClassMacro(BinaryThresholdTool, AutoSegmentationTool);
     itkFactorylessNewMacro(Self);
@@ -57,6 +63,9 @@ namespace mitk
     virtual void AcceptCurrentThresholdValue();
     virtual void CancelThresholding();
 
+    /// \brief Shows the preview of the whole image once the background thresholding is finished.
+    void ApplyBackgroundPreview();
+
   protected:
     BinaryThresholdTool(); // purposely hidden
     ~BinaryThresholdTool() override;
@@ -66,19 +75,9 @@ namespace mitk
     void CreateNewSegmentationFromThreshold(DataNode *node);
 
     void OnRoiDataChanged();
+    void OnBackgroundThresholdingFinished();
     void UpdatePreview();
 
-    template <typename TPixel, unsigned int VImageDimension>
-    void ITKThresholding(itk::Image<TPixel, VImageDimension> *originalImage,
-                         mitk::Image *segmentation,
-                         double thresholdValue,
-                         unsigned int timeStep);
-    template <typename TPixel, unsigned int VImageDimension>
-    void ITKThresholdingOldBinary(itk::Image<TPixel, VImageDimension> *originalImage,
-                                  mitk::Image *segmentation,
-                                  double thresholdValue,
-                                  unsigned int timeStep);
-
     DataNode::Pointer m_ThresholdFeedbackNode;
     DataNode::Pointer m_OriginalImageNode;
     DataNode::Pointer m_NodeForThresholding;
@@ -89,6 +88,8 @@ namespace mitk
     bool m_IsFloatImage;
 
     bool m_IsOldBinary = false;
+
+    ThresholdPreviewUpdater::Pointer m_PreviewUpdater;
   };
 
 } // namespace
@@ -55,10 +55,17 @@ mitk::BinaryThresholdULTool::BinaryThresholdULTool()
   m_ThresholdFeedbackNode->SetProperty("opacity", FloatProperty::New(0.3));
   m_ThresholdFeedbackNode->SetProperty("binary", BoolProperty::New(true));
   m_ThresholdFeedbackNode->SetProperty("helper object", BoolProperty::New(true));
+
+  m_PreviewUpdater = ThresholdPreviewUpdater::New();
+  m_PreviewUpdater->BackgroundThresholdingFinished +=
+    mitk::MessageDelegate<mitk::BinaryThresholdULTool>(this, &mitk::BinaryThresholdULTool::OnBackgroundThresholdingFinished);
 }
 
 mitk::BinaryThresholdULTool::~BinaryThresholdULTool()
 {
+  m_PreviewUpdater->Cancel();
+  m_PreviewUpdater->BackgroundThresholdingFinished -=
+    mitk::MessageDelegate<mitk::BinaryThresholdULTool>(this, &mitk::BinaryThresholdULTool::OnBackgroundThresholdingFinished);
 }
 
 const char **mitk::BinaryThresholdULTool::GetXPM() const
@@ -102,6 +109,9 @@ void mitk::BinaryThresholdULTool::Deactivated()
 {
   m_ToolManager->RoiDataChanged -=
     mitk::MessageDelegate<mitk::BinaryThresholdULTool>(this, &mitk::BinaryThresholdULTool::OnRoiDataChanged);
+  m_PreviewUpdater->Cancel();
+  m_PreviewUpdater->SetInput(nullptr);
+  m_PreviewUpdater->SetPreview(nullptr);
   m_NodeForThresholding = nullptr;
   m_OriginalImageNode = nullptr;
   try
@@ -133,6 +143,9 @@ void mitk::BinaryThresholdULTool::SetThresholdValues(double lower, double upper)
 
 void mitk::BinaryThresholdULTool::AcceptCurrentThresholdValue()
 {
+  // the segmentation is created from the preview of the whole image
+  m_PreviewUpdater->Finish();
+
   CreateNewSegmentationFromThreshold(m_NodeForThresholding);
 
   RenderingManager::GetInstance()->RequestUpdateAll();
@@ -330,77 +343,35 @@ void mitk::BinaryThresholdULTool::OnRoiDataChanged()
   this->UpdatePreview();
 }
 
-template <typename TPixel, unsigned int VImageDimension>
-static void ITKThresholding(itk::Image<TPixel, VImageDimension> *originalImage,
-                            mitk::Image *segmentation,
-                            double lower,
-                            double upper,
-                            unsigned int timeStep)
+void mitk::BinaryThresholdULTool::UpdatePreview()
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<mitk::Tool::DefaultSegmentationDataType, VImageDimension> SegmentationType;
-  typedef itk::BinaryThresholdImageFilter<ImageType, SegmentationType> ThresholdFilterType;
-
-  typename ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
-  filter->SetInput(originalImage);
-  filter->SetLowerThreshold(lower);
-  filter->SetUpperThreshold(upper);
-  filter->SetInsideValue(1);
-  filter->SetOutsideValue(0);
-  filter->Update();
-
-  segmentation->SetVolume((void *)(filter->GetOutput()->GetPixelContainer()->GetBufferPointer()), timeStep);
+  mitk::Image::Pointer thresholdImage = dynamic_cast<mitk::Image *>(m_NodeForThresholding->GetData());
+  mitk::Image::Pointer previewImage = dynamic_cast<mitk::Image *>(m_ThresholdFeedbackNode->GetData());
+  if (thresholdImage && previewImage)
+  {
+    // the slices in the render windows are thresholded immediately, the rest of the image in the background
+    std::vector<ThresholdPreviewUpdater::SliceType> visibleSlices;
+    unsigned int timeStep(0);
+    ThresholdPreviewUpdater::GetVisibleSlices(thresholdImage, visibleSlices, timeStep);
+
+    m_PreviewUpdater->SetInput(thresholdImage);
+    m_PreviewUpdater->SetPreview(previewImage);
+    m_PreviewUpdater->Update(m_CurrentLowerThresholdValue, m_CurrentUpperThresholdValue, timeStep, visibleSlices);
+
+    RenderingManager::GetInstance()->RequestUpdateAll();
+  }
 }
 
-template <typename TPixel, unsigned int VImageDimension>
-static void ITKThresholdingOldBinary(itk::Image<TPixel, VImageDimension> *originalImage,
-                                     mitk::Image *segmentation,
-                                     double lower,
-                                     double upper,
-                                     unsigned int timeStep)
+void mitk::BinaryThresholdULTool::OnBackgroundThresholdingFinished()
 {
-  typedef itk::Image<TPixel, VImageDimension> ImageType;
-  typedef itk::Image<unsigned char, VImageDimension> SegmentationType;
-  typedef itk::BinaryThresholdImageFilter<ImageType, SegmentationType> ThresholdFilterType;
-
-  typename ThresholdFilterType::Pointer filter = ThresholdFilterType::New();
-  filter->SetInput(originalImage);
-  filter->SetLowerThreshold(lower);
-  filter->SetUpperThreshold(upper);
-  filter->SetInsideValue(1);
-  filter->SetOutsideValue(0);
-  filter->Update();
-
-  segmentation->SetVolume((void *)(filter->GetOutput()->GetPixelContainer()->GetBufferPointer()), timeStep);
+  // called from the background thread
+  BackgroundPreviewFinished.Send();
 }
 
-void mitk::BinaryThresholdULTool::UpdatePreview()
+void mitk::BinaryThresholdULTool::ApplyBackgroundPreview()
 {
-  mitk::Image::Pointer thresholdImage = dynamic_cast<mitk::Image *>(m_NodeForThresholding->GetData());
-  mitk::Image::Pointer previewImage = dynamic_cast<mitk::Image *>(m_ThresholdFeedbackNode->GetData());
-  if (thresholdImage && previewImage)
+  if (m_PreviewUpdater->ApplyBackgroundResult())
   {
-    for (unsigned int timeStep = 0; timeStep < thresholdImage->GetTimeSteps(); ++timeStep)
-    {
-      ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
-      timeSelector->SetInput(thresholdImage);
-      timeSelector->SetTimeNr(timeStep);
-      timeSelector->UpdateLargestPossibleRegion();
-      Image::Pointer feedBackImage3D = timeSelector->GetOutput();
-
-      if (m_IsOldBinary)
-      {
-        AccessByItk_n(feedBackImage3D,
-                      ITKThresholdingOldBinary,
-                      (previewImage, m_CurrentLowerThresholdValue, m_CurrentUpperThresholdValue, timeStep));
-      }
-      else
-      {
-        AccessByItk_n(feedBackImage3D,
-                      ITKThresholding,
-                      (previewImage, m_CurrentLowerThresholdValue, m_CurrentUpperThresholdValue, timeStep));
-      }
-    }
     RenderingManager::GetInstance()->RequestUpdateAll();
   }
 }
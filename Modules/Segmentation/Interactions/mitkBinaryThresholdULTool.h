@@ -16,6 +16,7 @@ found in the LICENSE file.
 #include "mitkAutoSegmentationTool.h"
 #include "mitkCommon.h"
 #include "mitkDataNode.h"
+#include "mitkThresholdPreviewUpdater.h"
 #include <MitkSegmentationExports.h>
 
 #include <itkBinaryThresholdImageFilter.h>
@@ -31,6 +32,10 @@ namespace mitk
   /**
   \brief Calculates the segmented volumes for binary images.
 
+  The preview follows the threshold values immediately in the slices shown in the render windows. The rest of the
+  image is thresholded in the background (see mitk::ThresholdPreviewUpdater). When this is done, BackgroundPreviewFinished
+  is sent from the background thread and ApplyBackgroundPreview() should be called from the GUI thread.
+
   \ingroup ToolManagerEtAl
   \sa mitk::Tool
   \sa QmitkInteractiveSegmentation
@@ -42,6 +47,7 @@ namespace mitk
   public:
     Message3<double, double, bool> IntervalBordersChanged;
     Message2<mitk::ScalarType, mitk::ScalarType> ThresholdingValuesChanged;
+    Message<> BackgroundPreviewFinished;
 
     mitkClassMacro(BinaryThresholdULTool, AutoSegmentationTool);
     itkFactorylessNewMacro(Self);
@@ -58,6 +64,9 @@ namespace mitk
     virtual void AcceptCurrentThresholdValue();
     virtual void CancelThresholding();
 
+    /// \brief Shows the preview of the whole image once the background thresholding is finished.
+    void ApplyBackgroundPreview();
+
   protected:
     BinaryThresholdULTool(); // purposely hidden
     ~BinaryThresholdULTool() override;
@@ -67,6 +76,7 @@ namespace mitk
     void CreateNewSegmentationFromThreshold(DataNode *node);
 
     void OnRoiDataChanged();
+    void OnBackgroundThresholdingFinished();
     void UpdatePreview();
 
     DataNode::Pointer m_ThresholdFeedbackNode;
@@ -80,6 +90,8 @@ namespace mitk
 
     bool m_IsOldBinary = false;
 
+    ThresholdPreviewUpdater::Pointer m_PreviewUpdater;
+
     typedef itk::Image<int, 3> ImageType;
     typedef itk::Image<Tool::DefaultSegmentationDataType, 3> SegmentationType; // this is sure for new segmentations
     typedef itk::BinaryThresholdImageFilter<ImageType, SegmentationType> ThresholdFilterType;
@@ -12,6 +12,7 @@ set(MODULE_TESTS
   mitkToolManagerProviderTest.cpp
   mitkManualSegmentationToSurfaceFilterTest.cpp #new cpp unit style
   mitkToolInteractionTest.cpp
+  mitkThresholdPreviewUpdaterTest.cpp
 )
 
 set(MODULE_IMAGE_TESTS
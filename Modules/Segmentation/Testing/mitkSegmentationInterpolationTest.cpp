@@ -31,11 +31,68 @@ class mitkSegmentationInterpolationTestSuite : public mitk::TestFixture
   MITK_TEST(Equal_Axial_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Frontal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Sagittal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(Equal_Axial_TestInterpolateAllAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(Equal_Frontal_TestInterpolateAllAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(Equal_Sagittal_TestInterpolateAllAndReferenceInterpolation_ReturnsTrue);
   CPPUNIT_TEST_SUITE_END();
 
 private:
-  // The tests all do the same, only in different directions
-  void testRoutine(mitk::SliceNavigationController::ViewDirection viewDirection)
+  /* Fill segmentation
+   *
+   * 1st slice: 3x3 square segmentation
+   * 2nd slice: empty
+   * 3rd slice: 1x1 square segmentation in corner
+   * -> 2nd slice should become 2x2 square in corner
+   */
+  void fillSegmentation(int dim)
+  {
+    itk::Index<3> currentPoint;
+    mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(m_SegmentationImage);
+
+    // Fill 3x3 slice
+    currentPoint[dim] = m_CenterPoint[dim] - 1;
+    for (int i = -1; i <= 1; ++i)
+    {
+      for (int j = -1; j <= 1; ++j)
+      {
+        currentPoint[(dim + 1) % 3] = m_CenterPoint[(dim + 1) % 3] + i;
+        currentPoint[(dim + 2) % 3] = m_CenterPoint[(dim + 2) % 3] + j;
+        writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
+      }
+    }
+    // Now i=j=1, set point two slices up
+    currentPoint[dim] = m_CenterPoint[dim] + 1;
+    writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
+  }
+
+  // Check a 4x4 square, the center of which needs to be filled
+  void checkInterpolation(const mitk::Image *image, int dim)
+  {
+    mitk::ImagePixelReadAccessor<mitk::Tool::DefaultSegmentationDataType, 3> readAccess(image);
+    itk::Index<3> currentPoint = m_CenterPoint;
+
+    for (int i = -1; i <= 2; ++i)
+    {
+      for (int j = -1; j <= 2; ++j)
+      {
+        currentPoint[(dim + 1) % 3] = m_CenterPoint[(dim + 1) % 3] + i;
+        currentPoint[(dim + 2) % 3] = m_CenterPoint[(dim + 2) % 3] + j;
+
+        if (i == -1 || i == 2 || j == -1 || j == 2)
+        {
+          CPPUNIT_ASSERT_MESSAGE("Have false positive segmentation.",
+                                 readAccess.GetPixelByIndexSafe(currentPoint) == 0);
+        }
+        else
+        {
+          CPPUNIT_ASSERT_MESSAGE("Have false negative segmentation.",
+                                 readAccess.GetPixelByIndexSafe(currentPoint) == 1);
+        }
+      }
+    }
+  }
+
+  int getSliceDimension(mitk::SliceNavigationController::ViewDirection viewDirection)
   {
     int dim;
     switch (viewDirection)
@@ -53,36 +110,14 @@ private:
         dim = -1;
         break;
     }
+    return dim;
+  }
 
-    /* Fill segmentation
-     *
-     * 1st slice: 3x3 square segmentation
-     * 2nd slice: empty
-     * 3rd slice: 1x1 square segmentation in corner
-     * -> 2nd slice should become 2x2 square in corner
-     *
-     * put accessor in scope
-     */
-
-    itk::Index<3> currentPoint;
-    {
-      mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(m_SegmentationImage);
-
-      // Fill 3x3 slice
-      currentPoint[dim] = m_CenterPoint[dim] - 1;
-      for (int i = -1; i <= 1; ++i)
-      {
-        for (int j = -1; j <= 1; ++j)
-        {
-          currentPoint[(dim + 1) % 3] = m_CenterPoint[(dim + 1) % 3] + i;
-          currentPoint[(dim + 2) % 3] = m_CenterPoint[(dim + 2) % 3] + j;
-          writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
-        }
-      }
-      // Now i=j=1, set point two slices up
-      currentPoint[dim] = m_CenterPoint[dim] + 1;
-      writeAccessor.SetPixelByIndexSafe(currentPoint, 1);
-    }
+  // The tests all do the same, only in different directions
+  void testRoutine(mitk::SliceNavigationController::ViewDirection viewDirection)
+  {
+    int dim = getSliceDimension(viewDirection);
+    fillSegmentation(dim);
 
     //        mitk::IOUtil::Save(m_SegmentationImage, "SOME PATH");
 
@@ -119,29 +154,41 @@ private:
 
     //        mitk::IOUtil::Save(m_SegmentationImage, "SOME PATH");
 
-    // Check a 4x4 square, the center of which needs to be filled
-    mitk::ImagePixelReadAccessor<mitk::Tool::DefaultSegmentationDataType, 3> readAccess(m_SegmentationImage);
-    currentPoint = m_CenterPoint;
+    checkInterpolation(m_SegmentationImage, dim);
+  }
 
-    for (int i = -1; i <= 2; ++i)
+  // Same as testRoutine, but all slices are interpolated at once into an empty diff image
+  void testInterpolateAllRoutine(mitk::SliceNavigationController::ViewDirection viewDirection)
+  {
+    int dim = getSliceDimension(viewDirection);
+    fillSegmentation(dim);
+
+    m_InterpolationController->SetSegmentationVolume(m_SegmentationImage);
+    m_InterpolationController->SetReferenceVolume(m_ReferenceImage);
+
+    mitk::Image::Pointer diffImage = m_SegmentationImage->Clone();
     {
-      for (int j = -1; j <= 2; ++j)
-      {
-        currentPoint[(dim + 1) % 3] = m_CenterPoint[(dim + 1) % 3] + i;
-        currentPoint[(dim + 2) % 3] = m_CenterPoint[(dim + 2) % 3] + j;
+      mitk::ImageWriteAccessor imageAccessor(diffImage);
+      memset(imageAccessor.GetData(),
+             0,
+             sizeof(mitk::Tool::DefaultSegmentationDataType) * diffImage->GetDimension(0) *
+               diffImage->GetDimension(1) * diffImage->GetDimension(2));
+    }
 
-        if (i == -1 || i == 2 || j == -1 || j == 2)
-        {
-          CPPUNIT_ASSERT_MESSAGE("Have false positive segmentation.",
-                                 readAccess.GetPixelByIndexSafe(currentPoint) == 0);
-        }
-        else
-        {
-          CPPUNIT_ASSERT_MESSAGE("Have false negative segmentation.",
-                                 readAccess.GetPixelByIndexSafe(currentPoint) == 1);
-        }
-      }
+    CPPUNIT_ASSERT_EQUAL(1u, m_InterpolationController->InterpolateAll(dim, 0, diffImage));
+    checkInterpolation(diffImage, dim);
+
+    // the segmented slices are not part of the diff
+    {
+      mitk::ImagePixelReadAccessor<mitk::Tool::DefaultSegmentationDataType, 3> readAccess(diffImage);
+      itk::Index<3> lowerCenter = m_CenterPoint;
+      lowerCenter[dim] -= 1;
+      CPPUNIT_ASSERT_MESSAGE("Segmented slice was changed.", readAccess.GetPixelByIndexSafe(lowerCenter) == 0);
     }
+
+    // a second run uses the cached distance maps and gives the same result
+    CPPUNIT_ASSERT_EQUAL(1u, m_InterpolationController->InterpolateAll(dim, 0, diffImage));
+    checkInterpolation(diffImage, dim);
   }
 
   mitk::Image::Pointer m_ReferenceImage;
@@ -199,6 +246,21 @@ public:
     mitk::SliceNavigationController::ViewDirection viewDirection = mitk::SliceNavigationController::Sagittal;
     testRoutine(viewDirection);
   }
+
+  void Equal_Axial_TestInterpolateAllAndReferenceInterpolation_ReturnsTrue()
+  {
+    testInterpolateAllRoutine(mitk::SliceNavigationController::Axial);
+  }
+
+  void Equal_Frontal_TestInterpolateAllAndReferenceInterpolation_ReturnsTrue() // Coronal
+  {
+    testInterpolateAllRoutine(mitk::SliceNavigationController::Frontal);
+  }
+
+  void Equal_Sagittal_TestInterpolateAllAndReferenceInterpolation_ReturnsTrue()
+  {
+    testInterpolateAllRoutine(mitk::SliceNavigationController::Sagittal);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkSegmentationInterpolation)
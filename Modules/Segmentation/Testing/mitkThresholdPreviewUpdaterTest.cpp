@@ -0,0 +1,171 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+#include <mitkThresholdPreviewUpdater.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+class mitkThresholdPreviewUpdaterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkThresholdPreviewUpdaterTestSuite);
+  MITK_TEST(VisibleSlicesAreThresholdedImmediately);
+  MITK_TEST(BackgroundResultIsApplied);
+  MITK_TEST(RestartedThresholdingFinishesWithLastValues);
+  MITK_TEST(CancelledThresholdingIsNotApplied);
+  MITK_TEST(InputIsLockedUntilResultIsApplied);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  // the pixel values are x + 40 * y + 1600 * z
+  mitk::Image::Pointer m_Input;
+  mitk::Image::Pointer m_Preview;
+  mitk::ThresholdPreviewUpdater::Pointer m_Updater;
+
+  std::atomic<unsigned int> m_NumberOfFinishedMessages;
+
+  void OnBackgroundThresholdingFinished() { ++m_NumberOfFinishedMessages; }
+
+  void FillPreview(unsigned char value)
+  {
+    mitk::ImageWriteAccessor accessor(m_Preview);
+    auto *pixels = static_cast<unsigned char *>(accessor.GetData());
+    std::fill(pixels, pixels + 40 * 40 * 20, value);
+  }
+
+  /** Checks the preview in the slices [beginZ, endZ) */
+  void CheckPreview(double lower, double upper, unsigned int beginZ, unsigned int endZ)
+  {
+    mitk::ImageReadAccessor inputAccessor(m_Input);
+    mitk::ImageReadAccessor previewAccessor(m_Preview);
+    const auto *input = static_cast<const short *>(inputAccessor.GetData());
+    const auto *preview = static_cast<const unsigned char *>(previewAccessor.GetData());
+
+    for (std::size_t i = beginZ * 40 * 40; i < endZ * 40 * 40; ++i)
+    {
+      const unsigned char expected = (lower <= input[i] && input[i] <= upper) ? 1 : 0;
+      CPPUNIT_ASSERT_EQUAL(static_cast<int>(expected), static_cast<int>(preview[i]));
+    }
+  }
+
+  void CheckPreview(unsigned char value, unsigned int beginZ, unsigned int endZ)
+  {
+    mitk::ImageReadAccessor previewAccessor(m_Preview);
+    const auto *preview = static_cast<const unsigned char *>(previewAccessor.GetData());
+    for (std::size_t i = beginZ * 40 * 40; i < endZ * 40 * 40; ++i)
+      CPPUNIT_ASSERT_EQUAL(static_cast<int>(value), static_cast<int>(preview[i]));
+  }
+
+public:
+  void setUp() override
+  {
+    m_Input = mitk::ImageGenerator::GenerateGradientImage<short>(40, 40, 20);
+    m_Preview = mitk::Image::New();
+    m_Preview->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, m_Input->GetDimensions());
+    this->FillPreview(7);
+
+    m_NumberOfFinishedMessages = 0;
+    m_Updater = mitk::ThresholdPreviewUpdater::New();
+    m_Updater->SetInput(m_Input);
+    m_Updater->SetPreview(m_Preview);
+    m_Updater->BackgroundThresholdingFinished += mitk::MessageDelegate<mitkThresholdPreviewUpdaterTestSuite>(
+      this, &mitkThresholdPreviewUpdaterTestSuite::OnBackgroundThresholdingFinished);
+  }
+
+  void tearDown() override
+  {
+    m_Updater->Cancel();
+    m_Updater->BackgroundThresholdingFinished -= mitk::MessageDelegate<mitkThresholdPreviewUpdaterTestSuite>(
+      this, &mitkThresholdPreviewUpdaterTestSuite::OnBackgroundThresholdingFinished);
+    m_Updater = nullptr;
+    m_Preview = nullptr;
+    m_Input = nullptr;
+  }
+
+  void VisibleSlicesAreThresholdedImmediately()
+  {
+    m_Updater->Update(2000.0, 30000.0, 0, {{2, 3}, {2, 17}});
+    m_Updater->Cancel();
+
+    this->CheckPreview(2000.0, 30000.0, 3, 4);
+    this->CheckPreview(2000.0, 30000.0, 17, 18);
+    this->CheckPreview(7, 4, 17);
+  }
+
+  void BackgroundResultIsApplied()
+  {
+    m_Updater->Update(2000.0, 30000.0, 0, {{2, 3}});
+
+    // wait for the background thread, the result is only applied on request
+    const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!m_Updater->ApplyBackgroundResult())
+    {
+      CPPUNIT_ASSERT_MESSAGE("Background thresholding finishes", std::chrono::steady_clock::now() < timeout);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    CPPUNIT_ASSERT_EQUAL(1u, m_NumberOfFinishedMessages.load());
+    this->CheckPreview(2000.0, 30000.0, 0, 20);
+    CPPUNIT_ASSERT(!m_Updater->ApplyBackgroundResult());
+  }
+
+  void RestartedThresholdingFinishesWithLastValues()
+  {
+    // every update cancels the running background thresholding
+    for (int i = 0; i < 20; ++i)
+      m_Updater->Update(100.0 * i, 30000.0 - 500.0 * i, 0, {{2, static_cast<unsigned int>(i)}});
+
+    m_Updater->Finish();
+    this->CheckPreview(1900.0, 20500.0, 0, 20);
+    CPPUNIT_ASSERT(!m_Updater->ApplyBackgroundResult());
+  }
+
+  void CancelledThresholdingIsNotApplied()
+  {
+    m_Updater->Update(2000.0, 30000.0, 0, {{2, 3}});
+    m_Updater->Cancel();
+
+    CPPUNIT_ASSERT(!m_Updater->ApplyBackgroundResult());
+    m_Updater->Finish();
+    this->CheckPreview(7, 0, 3);
+    this->CheckPreview(7, 4, 20);
+
+    // a new update after the cancellation is complete again
+    m_Updater->Update(0.0, 1000.0, 0, {});
+    m_Updater->Finish();
+    this->CheckPreview(0.0, 1000.0, 0, 20);
+  }
+
+  void InputIsLockedUntilResultIsApplied()
+  {
+    m_Updater->Update(2000.0, 30000.0, 0, {{2, 3}});
+
+    // the background thread reads the input, it must not be changed
+    CPPUNIT_ASSERT_THROW(mitk::ImageWriteAccessor(m_Input, nullptr, mitk::ImageAccessorBase::ExceptionIfLocked),
+                         mitk::Exception);
+
+    m_Updater->Finish();
+    this->CheckPreview(2000.0, 30000.0, 0, 20);
+
+    mitk::ImageWriteAccessor accessor(m_Input, nullptr, mitk::ImageAccessorBase::ExceptionIfLocked);
+    CPPUNIT_ASSERT(accessor.GetData() != nullptr);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkThresholdPreviewUpdater)
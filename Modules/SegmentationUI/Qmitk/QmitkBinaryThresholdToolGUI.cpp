@@ -14,6 +14,7 @@ found in the LICENSE file.
 #include "QmitkConfirmSegmentationDialog.h"
 #include "QmitkNewSegmentationDialog.h"
 
+#include <QMetaObject>
 #include <qlabel.h>
 #include <qlayout.h>
 #include <qpushbutton.h>
@@ -79,6 +80,8 @@ QmitkBinaryThresholdToolGUI::~QmitkBinaryThresholdToolGUI()
         this, &QmitkBinaryThresholdToolGUI::OnThresholdingIntervalBordersChanged);
     m_BinaryThresholdTool->ThresholdingValueChanged -= mitk::MessageDelegate1<QmitkBinaryThresholdToolGUI, double>(
       this, &QmitkBinaryThresholdToolGUI::OnThresholdingValueChanged);
+    m_BinaryThresholdTool->BackgroundPreviewFinished -=
+      mitk::MessageDelegate<QmitkBinaryThresholdToolGUI>(this, &QmitkBinaryThresholdToolGUI::OnBackgroundPreviewFinished);
   }
 }
 
@@ -91,6 +94,8 @@ void QmitkBinaryThresholdToolGUI::OnNewToolAssociated(mitk::Tool *tool)
         this, &QmitkBinaryThresholdToolGUI::OnThresholdingIntervalBordersChanged);
     m_BinaryThresholdTool->ThresholdingValueChanged -= mitk::MessageDelegate1<QmitkBinaryThresholdToolGUI, double>(
       this, &QmitkBinaryThresholdToolGUI::OnThresholdingValueChanged);
+    m_BinaryThresholdTool->BackgroundPreviewFinished -=
+      mitk::MessageDelegate<QmitkBinaryThresholdToolGUI>(this, &QmitkBinaryThresholdToolGUI::OnBackgroundPreviewFinished);
   }
 
   m_BinaryThresholdTool = dynamic_cast<mitk::BinaryThresholdTool *>(tool);
@@ -102,6 +107,8 @@ void QmitkBinaryThresholdToolGUI::OnNewToolAssociated(mitk::Tool *tool)
         this, &QmitkBinaryThresholdToolGUI::OnThresholdingIntervalBordersChanged);
     m_BinaryThresholdTool->ThresholdingValueChanged += mitk::MessageDelegate1<QmitkBinaryThresholdToolGUI, double>(
       this, &QmitkBinaryThresholdToolGUI::OnThresholdingValueChanged);
+    m_BinaryThresholdTool->BackgroundPreviewFinished +=
+      mitk::MessageDelegate<QmitkBinaryThresholdToolGUI>(this, &QmitkBinaryThresholdToolGUI::OnBackgroundPreviewFinished);
   }
 }
 
@@ -210,3 +217,17 @@ int QmitkBinaryThresholdToolGUI::DoubleToSliderInt(double val)
     return intVal;
   }
 }
+
+void QmitkBinaryThresholdToolGUI::OnBackgroundPreviewFinished()
+{
+  // the tool sends this from its background thread, the preview has to be changed in the GUI thread
+  QMetaObject::invokeMethod(this, "OnApplyBackgroundPreview", Qt::QueuedConnection);
+}
+
+void QmitkBinaryThresholdToolGUI::OnApplyBackgroundPreview()
+{
+  if (m_BinaryThresholdTool.IsNotNull())
+  {
+    m_BinaryThresholdTool->ApplyBackgroundPreview();
+  }
+}
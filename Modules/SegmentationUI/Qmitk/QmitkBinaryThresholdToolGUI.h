@@ -45,6 +45,9 @@ public:
     void OnThresholdingIntervalBordersChanged(double lower, double upper, bool isFloat);
   void OnThresholdingValueChanged(double current);
 
+  /// \brief Called from the background thread of the tool when the preview of the whole image is ready
+  void OnBackgroundPreviewFinished();
+
 signals:
 
   /// \brief Emitted when threshold Accepted
@@ -58,6 +61,9 @@ public slots:
 protected slots:
 
   void OnNewToolAssociated(mitk::Tool *);
+
+  /// \brief Shows the preview of the whole image, see OnBackgroundPreviewFinished()
+  void OnApplyBackgroundPreview();
   void OnAcceptThresholdPreview();
 
   /// \brief Called when Spinner value has changed. Consider: Spinner contains DOUBLE values
@@ -13,6 +13,7 @@ found in the LICENSE file.
 #include "QmitkBinaryThresholdULToolGUI.h"
 #include "QmitkConfirmSegmentationDialog.h"
 
+#include <QMetaObject>
 #include <qlabel.h>
 #include <qlayout.h>
 #include <qpushbutton.h>
@@ -59,6 +60,8 @@ QmitkBinaryThresholdULToolGUI::~QmitkBinaryThresholdULToolGUI()
     m_BinaryThresholdULTool->ThresholdingValuesChanged -=
       mitk::MessageDelegate2<QmitkBinaryThresholdULToolGUI, mitk::ScalarType, mitk::ScalarType>(
         this, &QmitkBinaryThresholdULToolGUI::OnThresholdingValuesChanged);
+    m_BinaryThresholdULTool->BackgroundPreviewFinished -=
+      mitk::MessageDelegate<QmitkBinaryThresholdULToolGUI>(this, &QmitkBinaryThresholdULToolGUI::OnBackgroundPreviewFinished);
   }
 }
 
@@ -72,6 +75,8 @@ void QmitkBinaryThresholdULToolGUI::OnNewToolAssociated(mitk::Tool *tool)
     m_BinaryThresholdULTool->ThresholdingValuesChanged -=
       mitk::MessageDelegate2<QmitkBinaryThresholdULToolGUI, mitk::ScalarType, mitk::ScalarType>(
         this, &QmitkBinaryThresholdULToolGUI::OnThresholdingValuesChanged);
+    m_BinaryThresholdULTool->BackgroundPreviewFinished -=
+      mitk::MessageDelegate<QmitkBinaryThresholdULToolGUI>(this, &QmitkBinaryThresholdULToolGUI::OnBackgroundPreviewFinished);
   }
 
   m_BinaryThresholdULTool = dynamic_cast<mitk::BinaryThresholdULTool *>(tool);
@@ -84,6 +89,8 @@ void QmitkBinaryThresholdULToolGUI::OnNewToolAssociated(mitk::Tool *tool)
     m_BinaryThresholdULTool->ThresholdingValuesChanged +=
       mitk::MessageDelegate2<QmitkBinaryThresholdULToolGUI, mitk::ScalarType, mitk::ScalarType>(
         this, &QmitkBinaryThresholdULToolGUI::OnThresholdingValuesChanged);
+    m_BinaryThresholdULTool->BackgroundPreviewFinished +=
+      mitk::MessageDelegate<QmitkBinaryThresholdULToolGUI>(this, &QmitkBinaryThresholdULToolGUI::OnBackgroundPreviewFinished);
   }
 }
 
@@ -136,3 +143,17 @@ void QmitkBinaryThresholdULToolGUI::OnThresholdsChanged(double min, double max)
 {
   m_BinaryThresholdULTool->SetThresholdValues(min, max);
 }
+
+void QmitkBinaryThresholdULToolGUI::OnBackgroundPreviewFinished()
+{
+  // the tool sends this from its background thread, the preview has to be changed in the GUI thread
+  QMetaObject::invokeMethod(this, "OnApplyBackgroundPreview", Qt::QueuedConnection);
+}
+
+void QmitkBinaryThresholdULToolGUI::OnApplyBackgroundPreview()
+{
+  if (m_BinaryThresholdULTool.IsNotNull())
+  {
+    m_BinaryThresholdULTool->ApplyBackgroundPreview();
+  }
+}
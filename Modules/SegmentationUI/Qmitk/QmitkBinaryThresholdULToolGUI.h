@@ -38,6 +38,9 @@ public:
     void OnThresholdingIntervalBordersChanged(double lower, double upper, bool isFloat);
   void OnThresholdingValuesChanged(mitk::ScalarType lower, mitk::ScalarType upper);
 
+  /// \brief Called from the background thread of the tool when the preview of the whole image is ready
+  void OnBackgroundPreviewFinished();
+
 signals:
 
 public slots:
@@ -46,6 +49,9 @@ protected slots:
 
   void OnNewToolAssociated(mitk::Tool *);
 
+  /// \brief Shows the preview of the whole image, see OnBackgroundPreviewFinished()
+  void OnApplyBackgroundPreview();
+
   void OnAcceptThresholdPreview();
 
   void OnThresholdsChanged(double min, double max);
@@ -671,7 +671,7 @@ void QmitkSlicesInterpolator::AcceptAllInterpolations(mitk::SliceNavigationContr
   /*
    * What exactly is done here:
    * 1. We create an empty diff image for the current segmentation
-   * 2. All interpolated slices are written into the diff image
+   * 2. All interpolated slices are written into the diff image at once
    * 3. Then the diffimage is applied to the original segmentation
    */
   if (m_Segmentation)
@@ -711,55 +711,15 @@ void QmitkSlicesInterpolator::AcceptAllInterpolations(mitk::SliceNavigationContr
                diffImage->GetDimension(2));
     }
 
-    // Since we need to shift the plane it must be clone so that the original plane isn't altered
-    mitk::PlaneGeometry::Pointer reslicePlane = slicer->GetCurrentPlaneGeometry()->Clone();
-
     int sliceDimension(-1);
     int sliceIndex(-1);
-    mitk::SegTool2D::DetermineAffectedImageSlice(m_Segmentation, reslicePlane, sliceDimension, sliceIndex);
-
-    unsigned int zslices = m_Segmentation->GetDimension(sliceDimension);
-    mitk::ProgressBar::GetInstance()->AddStepsToDo(zslices);
+    mitk::SegTool2D::DetermineAffectedImageSlice(
+      m_Segmentation, slicer->GetCurrentPlaneGeometry(), sliceDimension, sliceIndex);
 
-    mitk::Point3D origin = reslicePlane->GetOrigin();
-    unsigned int totalChangedSlices(0);
-
-    for (unsigned int sliceIndex = 0; sliceIndex < zslices; ++sliceIndex)
-    {
-      // Transforming the current origin of the reslice plane
-      // so that it matches the one of the next slice
-      m_Segmentation->GetSlicedGeometry()->WorldToIndex(origin, origin);
-      origin[sliceDimension] = sliceIndex;
-      m_Segmentation->GetSlicedGeometry()->IndexToWorld(origin, origin);
-      reslicePlane->SetOrigin(origin);
-      // Set the slice as 'input'
-      mitk::Image::Pointer interpolation =
-        m_Interpolator->Interpolate(sliceDimension, sliceIndex, reslicePlane, timeStep);
-
-      if (interpolation.IsNotNull()) // we don't check if interpolation is necessary/sensible - but m_Interpolator does
-      {
-        // Setting up the reslicing pipeline which allows us to write the interpolation results back into
-        // the image volume
-        vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
-
-        // set overwrite mode to true to write back to the image volume
-        reslice->SetInputSlice(interpolation->GetSliceData()->GetVtkImageAccessor(interpolation)->GetVtkImageData());
-        reslice->SetOverwriteMode(true);
-        reslice->Modified();
-
-        mitk::ExtractSliceFilter::Pointer diffslicewriter = mitk::ExtractSliceFilter::New(reslice);
-        diffslicewriter->SetInput(diffImage);
-        diffslicewriter->SetTimeStep(0);
-        diffslicewriter->SetWorldGeometry(reslicePlane);
-        diffslicewriter->SetVtkOutputRequest(true);
-        diffslicewriter->SetResliceTransformByGeometry(diffImage->GetTimeGeometry()->GetGeometryForTimeStep(0));
-
-        diffslicewriter->Modified();
-        diffslicewriter->Update();
-        ++totalChangedSlices;
-      }
-      mitk::ProgressBar::GetInstance()->Progress();
-    }
+    // all slices are interpolated at once, directly into the diff image
+    mitk::ProgressBar::GetInstance()->AddStepsToDo(1);
+    unsigned int totalChangedSlices = m_Interpolator->InterpolateAll(sliceDimension, timeStep, diffImage);
+    mitk::ProgressBar::GetInstance()->Progress();
     mitk::RenderingManager::GetInstance()->RequestUpdateAll();
 
     if (totalChangedSlices > 0)
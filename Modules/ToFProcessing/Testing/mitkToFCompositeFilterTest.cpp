@@ -24,6 +24,9 @@ found in the LICENSE file.
 #include <itkMedianImageFilter.h>
 #include <mitkImagePixelReadAccessor.h>
 
+#include <algorithm>
+#include <vector>
+
 
 /**Documentation
 *  \brief test for the class "ToFCompositeFilter".
@@ -318,6 +321,82 @@ int mitkToFCompositeFilterTest(int /* argc */, char* /*argv*/[])
 //  MITK_TEST_CONDITION_REQUIRED(pipelineSuccess,"Test all filters in pipeline");
 
 
+//-------------------------------------------------------------------------------------------------------
+
+  //Apply threshold and spatial filters with the fused pipeline
+  compositeFilter->SetUseFusedPipeline(true);
+  compositeFilter->SetNumberOfThreads(3);
+  compositeFilter->SetApplyBilateralFilter(false);
+  mitkOutputImage->Update();
+
+  mitk::CastToMitkImage(medianFilter->GetOutput(),itkOutputImageConverted);
+  MITK_TEST_CONDITION_REQUIRED( mitk::Equal(*itkOutputImageConverted, *mitkOutputImage, mitk::eps, true),
+                               "Test threshold and median filter in fused pipeline");
+
+  compositeFilter->SetApplyBilateralFilter(true);
+  mitkOutputImage->Update();
+
+  // the bilateral kernels are computed in a different order than by ITK
+  mitk::CastToMitkImage(bilateralFilter->GetOutput(),itkOutputImageConverted);
+  MITK_TEST_CONDITION_REQUIRED( mitk::Equal(*itkOutputImageConverted, *mitkOutputImage, 1e-3, true),
+                               "Test threshold, median and bilateral filter in fused pipeline");
+
+  //Apply temporal filters with the fused pipeline and compare them with the median and mean of the last frames
+  compositeFilter->SetApplyThresholdFilter(false);
+  compositeFilter->SetApplyMedianFilter(false);
+  compositeFilter->SetApplyBilateralFilter(false);
+  const int numberOfFrames = 3;
+  compositeFilter->SetTemporalMedianFilterParameter(numberOfFrames);
+  bool temporalMedianSuccess = true;
+  bool averageSuccess = true;
+  std::vector<mitk::Image::Pointer> frames;
+  for (int frame = 0; frame < 7; ++frame)
+  {
+    ItkImageType_2D::Pointer itkFrame = ItkImageType_2D::New();
+    mitk::Image::Pointer mitkFrame = mitk::Image::New();
+    CreateRandomDistanceImage(20,10,itkFrame,mitkFrame);
+    frames.push_back(mitkFrame);
+    compositeFilter->SetInput(mitkFrame);
+    const bool average = frame >= 4;
+    compositeFilter->SetApplyTemporalMedianFilter(!average);
+    compositeFilter->SetApplyAverageFilter(average);
+    mitkOutputImage->Update();
+
+    const int numberOfUsedFrames = std::min(frame+1, numberOfFrames);
+    mitk::ImagePixelReadAccessor<ToFScalarType,2> outputAcc(mitkOutputImage);
+    for (unsigned int i=0; i<20; i++)
+    {
+      for (unsigned int j=0; j<10; j++)
+      {
+        itk::Index<2> index;
+        index[0] = i;
+        index[1] = j;
+        std::vector<ToFScalarType> values;
+        double sum = 0.0;
+        for (int k=frame+1-numberOfUsedFrames; k<=frame; k++)
+        {
+          mitk::ImagePixelReadAccessor<ToFScalarType,2> frameAcc(frames[k]);
+          values.push_back(frameAcc.GetPixelByIndex(index));
+          sum += values.back();
+        }
+        std::sort(values.begin(), values.end());
+        if (average)
+        {
+          averageSuccess = averageSuccess && mitk::Equal(outputAcc.GetPixelByIndex(index), sum/numberOfUsedFrames, 1e-3);
+        }
+        else
+        {
+          temporalMedianSuccess = temporalMedianSuccess && outputAcc.GetPixelByIndex(index) == values[(numberOfUsedFrames-1)/2];
+        }
+      }
+    }
+  }
+  MITK_TEST_CONDITION_REQUIRED(temporalMedianSuccess,"Test temporal median filter in fused pipeline");
+  MITK_TEST_CONDITION_REQUIRED(averageSuccess,"Test average filter in fused pipeline");
+  compositeFilter->SetApplyAverageFilter(false);
+  compositeFilter->SetUseFusedPipeline(false);
+  MITK_TEST_CONDITION_REQUIRED(compositeFilter->GetUseFusedPipeline()==false,"Get/Set UseFusedPipeline");
+
 //-------------------------------------------------------------------------------------------------------
 
   //Check set/get functions
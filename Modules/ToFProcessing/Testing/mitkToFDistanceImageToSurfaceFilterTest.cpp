@@ -15,6 +15,7 @@ found in the LICENSE file.
 
 #include <mitkImage.h>
 #include <mitkImagePixelReadAccessor.h>
+#include <mitkImagePixelWriteAccessor.h>
 #include <mitkImageGenerator.h>
 #include <mitkSurface.h>
 #include <mitkToFProcessingCommon.h>
@@ -22,10 +23,16 @@ found in the LICENSE file.
 #include <mitkToFTestingCommon.h>
 #include <mitkIOUtil.h>
 
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkMath.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 
+#include <algorithm>
+#include <vector>
+
 /**
  *  @brief Test for the class "ToFDistanceImageToSurfaceFilter".
  */
@@ -34,6 +41,80 @@ typedef mitk::ToFProcessingCommon::ToFPoint2D ToFPoint2D;
 typedef mitk::ToFProcessingCommon::ToFPoint3D ToFPoint3D;
 typedef mitk::ToFProcessingCommon::ToFScalarType ToFScalarType;
 
+/**
+ * @brief Computes the cells of the surface pixel by pixel as expected from the filter
+ * @param points reconstructed points in the order of the valid pixels of the image
+ * @param triangulationThreshold squared triangulation threshold, 0 to triangulate all valid neighbors
+ */
+static void ComputeExpectedCells(mitk::Image::Pointer image, vtkPoints* points, double triangulationThreshold,
+                                 std::vector<vtkIdType>& polys, std::vector<vtkIdType>& vertices)
+{
+  int dimX = image->GetDimension(0);
+  int dimY = image->GetDimension(1);
+  mitk::ImagePixelReadAccessor<float,2> readAccess(image, image->GetSliceData());
+  const float* distances = readAccess.GetData();
+
+  std::vector<vtkIdType> ids(dimX*dimY, -1);
+  vtkIdType numberOfPoints = 0;
+  for (int pixel = 0; pixel < dimX*dimY; ++pixel)
+  {
+    if (distances[pixel] > mitk::eps)
+      ids[pixel] = numberOfPoints++;
+  }
+
+  polys.clear();
+  vertices.clear();
+  for (int j = 1; j < dimY; ++j)
+  {
+    for (int i = 1; i < dimX; ++i)
+    {
+      vtkIdType xy = ids[i+j*dimX];
+      vtkIdType x_1y = ids[i-1+j*dimX];
+      vtkIdType xy_1 = ids[i+(j-1)*dimX];
+      vtkIdType x_1y_1 = ids[i-1+(j-1)*dimX];
+      if (xy < 0 || x_1y < 0 || xy_1 < 0 || x_1y_1 < 0)
+        continue;
+
+      bool triangulate = true;
+      if (triangulationThreshold > 0.0)
+      {
+        double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
+        points->GetPoint(xy, pointXY);
+        points->GetPoint(x_1y, pointX_1Y);
+        points->GetPoint(xy_1, pointXY_1);
+        points->GetPoint(x_1y_1, pointX_1Y_1);
+        triangulate = vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= triangulationThreshold &&
+                      vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= triangulationThreshold &&
+                      vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= triangulationThreshold &&
+                      vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= triangulationThreshold;
+      }
+      if (triangulate)
+      {
+        vtkIdType cells[] = { 3, x_1y, xy, x_1y_1, 3, x_1y_1, xy, xy_1 };
+        polys.insert(polys.end(), cells, cells + 8);
+      }
+      else
+      {
+        vertices.push_back(1);
+        vertices.push_back(xy);
+      }
+    }
+  }
+}
+
+static std::vector<vtkIdType> GetCells(vtkCellArray* cells)
+{
+  vtkIdTypeArray* data = cells->GetData();
+  return std::vector<vtkIdType>(data->GetPointer(0), data->GetPointer(0) + data->GetNumberOfValues());
+}
+
+static bool CellsEqual(vtkPolyData* mesh, const std::vector<vtkIdType>& polys, const std::vector<vtkIdType>& vertices)
+{
+  return mesh->GetNumberOfPolys() == static_cast<vtkIdType>(polys.size() / 4) &&
+         mesh->GetNumberOfVerts() == static_cast<vtkIdType>(vertices.size() / 2) &&
+         GetCells(mesh->GetPolys()) == polys && GetCells(mesh->GetVerts()) == vertices;
+}
+
 int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
 {
   MITK_TEST_BEGIN("ToFDistanceImageToSurfaceFilter");
@@ -375,6 +456,107 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  //Kinect reconstruction
+  filter->SetReconstructionMode(mitk::ToFDistanceImageToSurfaceFilter::Kinect);
+  filter->Update();
+  result = filter->GetOutput()->GetVtkPolyData()->GetPoints();
+  bool kinectPointsEqual = true;
+  {
+    mitk::ImagePixelReadAccessor<float,2> readAccess(image, image->GetSliceData());
+    vtkIdType id = 0;
+    for (unsigned int j=0; j<dimY && kinectPointsEqual; j++)
+    {
+      for (unsigned int i=0; i<dimX && kinectPointsEqual; i++)
+      {
+        itk::Index<2> index = {{ static_cast<itk::IndexValueType>(i), static_cast<itk::IndexValueType>(j) }};
+        float distance = readAccess.GetPixelByIndex(index);
+        if (distance<=mitk::eps)
+          continue;
+        ToFPoint3D expectedPoint = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(i,j,distance,focalLengthXY,principalPoint);
+        kinectPointsEqual = id<result->GetNumberOfPoints() && mitk::Equal(expectedPoint,ToFPoint3D(result->GetPoint(id)));
+        id++;
+      }
+    }
+    kinectPointsEqual = kinectPointsEqual && id==result->GetNumberOfPoints();
+  }
+  MITK_TEST_CONDITION_REQUIRED(kinectPointsEqual,"Testing Kinect reconstruction");
+
+  //Triangulation of a distance image with invalid pixels
+  filter->SetReconstructionMode(mitk::ToFDistanceImageToSurfaceFilter::WithInterPixelDistance);
+  {
+    mitk::ImagePixelWriteAccessor<float,2> writeAccess(image, image->GetSliceData());
+    for (unsigned int pixel=0; pixel<dimX*dimY; pixel+=7)
+      writeAccess.GetData()[pixel] = 0.0f;
+  }
+  image->Modified();
+  filter->Update();
+  mitk::Surface::Pointer surface = filter->GetOutput();
+  std::vector<vtkIdType> expectedPolys;
+  std::vector<vtkIdType> expectedVertices;
+  ComputeExpectedCells(image, surface->GetVtkPolyData()->GetPoints(), 0.0, expectedPolys, expectedVertices);
+  MITK_TEST_CONDITION_REQUIRED(!expectedPolys.empty() && CellsEqual(surface->GetVtkPolyData(), expectedPolys, expectedVertices),
+                               "Testing triangulation with invalid pixels");
+
+  //Reused triangulation for the same valid pixels and new distances
+  {
+    mitk::ImagePixelWriteAccessor<float,2> writeAccess(image, image->GetSliceData());
+    for (unsigned int pixel=0; pixel<dimX*dimY; pixel++)
+    {
+      if (writeAccess.GetData()[pixel] > mitk::eps)
+        writeAccess.GetData()[pixel] = 500.0f + 0.25f*writeAccess.GetData()[pixel];
+    }
+  }
+  image->Modified();
+  filter->Update();
+  MITK_TEST_CONDITION_REQUIRED(CellsEqual(filter->GetOutput()->GetVtkPolyData(), expectedPolys, expectedVertices),
+                               "Testing triangulation for unchanged valid pixels");
+
+  //Triangulation threshold
+  filter->SetTriangulationThreshold(40.0);
+  filter->Modified();
+  filter->Update();
+  ComputeExpectedCells(image, filter->GetOutput()->GetVtkPolyData()->GetPoints(), 40.0*40.0, expectedPolys, expectedVertices);
+  MITK_TEST_CONDITION_REQUIRED(!expectedPolys.empty() && !expectedVertices.empty() &&
+                               CellsEqual(filter->GetOutput()->GetVtkPolyData(), expectedPolys, expectedVertices),
+                               "Testing triangulation threshold");
+
+  filter->SetTriangulationThreshold(0.0);
+  filter->Modified();
+  filter->Update();
+  ComputeExpectedCells(image, filter->GetOutput()->GetVtkPolyData()->GetPoints(), 0.0, expectedPolys, expectedVertices);
+  MITK_TEST_CONDITION_REQUIRED(CellsEqual(filter->GetOutput()->GetVtkPolyData(), expectedPolys, expectedVertices),
+                               "Testing triangulation after removing the threshold");
+
+  //The result does not depend on the number of threads
+  filter->SetNumberOfThreads(4);
+  filter->Update();
+  vtkSmartPointer<vtkPolyData> multiThreadedMesh = vtkSmartPointer<vtkPolyData>::New();
+  multiThreadedMesh->DeepCopy(filter->GetOutput()->GetVtkPolyData());
+  filter->SetNumberOfThreads(1);
+  filter->Update();
+  vtkPolyData* singleThreadedMesh = filter->GetOutput()->GetVtkPolyData();
+  bool threadsEqual = multiThreadedMesh->GetNumberOfPoints() == singleThreadedMesh->GetNumberOfPoints() &&
+                      GetCells(multiThreadedMesh->GetPolys()) == GetCells(singleThreadedMesh->GetPolys()) &&
+                      GetCells(multiThreadedMesh->GetVerts()) == GetCells(singleThreadedMesh->GetVerts());
+  for (vtkIdType i=0; threadsEqual && i<singleThreadedMesh->GetNumberOfPoints(); i++)
+  {
+    threadsEqual = mitk::Equal(ToFPoint3D(multiThreadedMesh->GetPoint(i)), ToFPoint3D(singleThreadedMesh->GetPoint(i)));
+  }
+  MITK_TEST_CONDITION_REQUIRED(threadsEqual,"Testing single threaded reconstruction");
+
+  //An image with the same number of pixels and the same valid pixels, but another width, needs new cells
+  mitk::Image::Pointer reshapedImage = mitk::ImageGenerator::GenerateRandomImage<float>(2*dimX,dimY/2);
+  {
+    mitk::ImagePixelReadAccessor<float,2> readAccess(image, image->GetSliceData());
+    mitk::ImagePixelWriteAccessor<float,2> writeAccess(reshapedImage, reshapedImage->GetSliceData());
+    std::copy(readAccess.GetData(), readAccess.GetData() + dimX*dimY, writeAccess.GetData());
+  }
+  filter->SetInput(reshapedImage);
+  filter->Update();
+  ComputeExpectedCells(reshapedImage, filter->GetOutput()->GetVtkPolyData()->GetPoints(), 0.0, expectedPolys, expectedVertices);
+  MITK_TEST_CONDITION_REQUIRED(CellsEqual(filter->GetOutput()->GetVtkPolyData(), expectedPolys, expectedVertices),
+                               "Testing triangulation after changing the image dimensions");
+
   //clean up
   delete[] point;
   //  expectedResult->Delete();
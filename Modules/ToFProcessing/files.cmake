@@ -4,5 +4,6 @@ set(CPP_FILES
   mitkToFDistanceImageToSurfaceFilter.cpp
   mitkToFImageDownsamplingFilter.cpp
   mitkToFProcessingCommon.cpp
+  mitkToFRayDirections.cpp
   mitkToFTestingCommon.cpp
 )
@@ -13,16 +13,167 @@ found in the LICENSE file.
 #include <mitkToFCompositeFilter.h>
 #include <mitkInstantiateAccessFunctions.h>
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 
 #include <itkImage.h>
 
 #include "opencv2/imgproc.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+
+namespace
+{
+  /** Calls function(firstRow, endRow) for blocks of rows which are distributed to the given number of threads */
+  template <typename FunctionType>
+  void ParallelForRows(int numberOfRows, int rowsPerBlock, unsigned int numberOfThreads, FunctionType function)
+  {
+    const int numberOfBlocks = (numberOfRows + rowsPerBlock - 1) / rowsPerBlock;
+    numberOfThreads = std::max(1u, std::min(numberOfThreads, static_cast<unsigned int>(std::max(numberOfBlocks, 1))));
+
+    std::atomic<int> nextBlock(0);
+    auto worker = [&]()
+    {
+      for (int block = nextBlock++; block < numberOfBlocks; block = nextBlock++)
+      {
+        function(block * rowsPerBlock, std::min(numberOfRows, (block + 1) * rowsPerBlock));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+  inline int Clamp(int value, int max)
+  {
+    return std::min(std::max(value, 0), max);
+  }
+
+  inline void SortPair(float &a, float &b)
+  {
+    const float minimum = std::min(a, b);
+    b = std::max(a, b);
+    a = minimum;
+  }
+
+  /** Median of nine values with the exchange network of Nicolas Devillard ("Fast median search", 1998) */
+  inline float Median9(float p[9])
+  {
+    SortPair(p[1], p[2]); SortPair(p[4], p[5]); SortPair(p[7], p[8]);
+    SortPair(p[0], p[1]); SortPair(p[3], p[4]); SortPair(p[6], p[7]);
+    SortPair(p[1], p[2]); SortPair(p[4], p[5]); SortPair(p[7], p[8]);
+    SortPair(p[0], p[3]); SortPair(p[5], p[8]); SortPair(p[4], p[7]);
+    SortPair(p[3], p[6]); SortPair(p[1], p[4]); SortPair(p[2], p[5]);
+    SortPair(p[4], p[7]); SortPair(p[4], p[2]); SortPair(p[6], p[4]);
+    SortPair(p[4], p[2]);
+    return p[4];
+  }
+
+  /** Writes the 3x3 median of row y of the image to medianRow, the border is replicated as by cvSmooth() */
+  void Median3x3Row(const float *image, int width, int height, int y, float *medianRow)
+  {
+    const float *rows[3] = { image + Clamp(y - 1, height - 1) * width, image + y * width,
+                             image + Clamp(y + 1, height - 1) * width };
+    float values[9];
+    for (int x = 0; x < width; ++x)
+    {
+      const int left = Clamp(x - 1, width - 1);
+      const int right = Clamp(x + 1, width - 1);
+      for (int i = 0; i < 3; ++i)
+      {
+        values[3 * i] = rows[i][left];
+        values[3 * i + 1] = rows[i][x];
+        values[3 * i + 2] = rows[i][right];
+      }
+      medianRow[x] = Median9(values);
+    }
+  }
+
+  /** Kernels of itk::BilateralImageFilter for an image spacing of 1 */
+  struct BilateralKernel
+  {
+    BilateralKernel(double domainSigma, double rangeSigma)
+    {
+      // domain kernel: normalized gaussian with a radius of 2.5 sigma
+      radius = domainSigma > 0.0 ? static_cast<int>(std::ceil(2.5 * domainSigma)) : 0;
+      double sum = 0.0;
+      for (int dy = -radius; dy <= radius; ++dy)
+      {
+        for (int dx = -radius; dx <= radius; ++dx)
+        {
+          const double weight = radius > 0 ? std::exp(-0.5 * (dx * dx + dy * dy) / (domainSigma * domainSigma)) : 1.0;
+          domainWeights.push_back(weight);
+          sum += weight;
+        }
+      }
+      for (auto &weight : domainWeights)
+      {
+        weight /= sum;
+      }
+
+      // range kernel: gaussian sampled at 100 values up to 4 sigma
+      rangeThreshold = 4.0 * rangeSigma;
+      rangeDelta = rangeThreshold / 99.0;
+      for (int i = 0; i < 100; ++i)
+      {
+        const double distance = i * rangeDelta;
+        rangeWeights.push_back(std::exp(-0.5 * distance * distance / (rangeSigma * rangeSigma)));
+      }
+    }
+
+    int radius;
+    std::vector<double> domainWeights;
+    std::vector<double> rangeWeights;
+    double rangeDelta;
+    double rangeThreshold;
+  };
+
+  /** Writes the bilateral filtered row to outputRow, rows points to the 2*radius+1 rows around it with replicated border */
+  void BilateralRow(const float *const *rows, int width, const BilateralKernel &kernel, float *outputRow)
+  {
+    const int radius = kernel.radius;
+    for (int x = 0; x < width; ++x)
+    {
+      const double center = rows[radius][x];
+      const double *domainWeight = kernel.domainWeights.data();
+      double value = 0.0;
+      double normalization = 0.0;
+      for (int dy = 0; dy <= 2 * radius; ++dy)
+      {
+        for (int dx = -radius; dx <= radius; ++dx, ++domainWeight)
+        {
+          const double pixel = rows[dy][Clamp(x + dx, width - 1)];
+          const double distance = std::fabs(pixel - center);
+          if (distance < kernel.rangeThreshold)
+          {
+            const double weight = kernel.rangeWeights[static_cast<std::size_t>(distance / kernel.rangeDelta)] * (*domainWeight);
+            value += pixel * weight;
+            normalization += weight;
+          }
+        }
+      }
+      outputRow[x] = normalization > 0.0 ? static_cast<float>(value / normalization) : static_cast<float>(center);
+    }
+  }
+}
+
 mitk::ToFCompositeFilter::ToFCompositeFilter() : m_SegmentationMask(nullptr), m_ImageWidth(0), m_ImageHeight(0), m_ImageSize(0),
 m_IplDistanceImage(nullptr), m_IplOutputImage(nullptr), m_ItkInputImage(nullptr), m_ApplyTemporalMedianFilter(false), m_ApplyAverageFilter(false),
   m_ApplyMedianFilter(false), m_ApplyThresholdFilter(false), m_ApplyMaskSegmentation(false), m_ApplyBilateralFilter(false), m_DataBuffer(nullptr),
 m_DataBufferCurrentIndex(0), m_DataBufferMaxSize(0), m_TemporalMedianFilterNumOfFrames(10), m_ThresholdFilterMin(1),
-m_ThresholdFilterMax(7000), m_BilateralFilterDomainSigma(2), m_BilateralFilterRangeSigma(60), m_BilateralFilterKernelRadius(0)
+m_ThresholdFilterMax(7000), m_BilateralFilterDomainSigma(2), m_BilateralFilterRangeSigma(60), m_BilateralFilterKernelRadius(0),
+m_UseFusedPipeline(false), m_NumberOfThreads(0), m_FrameBufferSize(0), m_FrameBufferCount(0), m_FrameBufferIndex(0)
 {
 }
 
@@ -108,6 +259,16 @@ void mitk::ToFCompositeFilter::GenerateData()
       outputImage->SetSlice(inputAcc.GetData());
     }
   }
+  if (m_UseFusedPipeline)
+  {
+    mitk::Image::Pointer inputDistanceImage = this->GetInput();
+    ImageReadAccessor inputAcc(inputDistanceImage, inputDistanceImage->GetSliceData(0, 0, 0));
+    ImageWriteAccessor outputAcc(this->GetOutput(), this->GetOutput()->GetSliceData(0, 0, 0));
+    ProcessFusedPipeline(static_cast<const float*>(inputAcc.GetData()), static_cast<float*>(outputAcc.GetData()),
+                         inputDistanceImage->GetDimension(0), inputDistanceImage->GetDimension(1));
+    return;
+  }
+
   //mitk::Image::Pointer outputDistanceImage = this->GetOutput();
   ImageReadAccessor outputAcc(this->GetOutput(), this->GetOutput()->GetSliceData(0, 0, 0) );
   float* outputDistanceFloatData = (float*) outputAcc.GetData();
@@ -313,6 +474,152 @@ void mitk::ToFCompositeFilter::ProcessStreamedQuickSelectMedianImageFilter(IplIm
   delete[] tmpArray;
 }
 
+void mitk::ToFCompositeFilter::ProcessFusedPipeline(const float* inputData, float* outputData, int width, int height)
+{
+  const unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
+  const std::size_t imageSize = static_cast<std::size_t>(width) * height;
+  m_FusedImage.resize(imageSize);
+
+  const bool applyTemporalFilter = (m_ApplyTemporalMedianFilter||m_ApplyAverageFilter) && m_TemporalMedianFilterNumOfFrames > 0;
+  if (applyTemporalFilter && (m_TemporalMedianFilterNumOfFrames != m_FrameBufferSize || m_FrameBufferSums.size() != imageSize)) // reset
+  {
+    m_FrameBufferSize = m_TemporalMedianFilterNumOfFrames;
+    m_FrameBuffer.assign(imageSize * m_FrameBufferSize, 0.0f);
+    m_SortedFrameBuffer.assign(imageSize * m_FrameBufferSize, 0.0f);
+    m_FrameBufferSums.assign(imageSize, 0.0);
+    m_FrameBufferCount = 0;
+    m_FrameBufferIndex = 0;
+  }
+
+  const char* segmentationMask = nullptr;
+  std::unique_ptr<ImageReadAccessor> segmentationMaskAcc;
+  if (m_ApplyMaskSegmentation && m_SegmentationMask.IsNotNull())
+  {
+    segmentationMaskAcc.reset(new ImageReadAccessor(m_SegmentationMask, m_SegmentationMask->GetSliceData(0,0,0)));
+    segmentationMask = static_cast<const char*>(segmentationMaskAcc->GetData());
+  }
+
+  // first pass: per pixel filters
+  ParallelForRows(height, 16, numberOfThreads, [&](int firstRow, int endRow)
+  {
+    this->ProcessFusedSegmentationAndTemporalFilter(inputData, segmentationMask, firstRow * width, endRow * width);
+  });
+  if (applyTemporalFilter)
+  {
+    m_FrameBufferCount = std::min(m_FrameBufferCount + 1, m_FrameBufferSize);
+    m_FrameBufferIndex = (m_FrameBufferIndex + 1) % m_FrameBufferSize;
+  }
+
+  // second pass: spatial filters, each block of rows computes the median of the rows needed by its bilateral filter
+  const BilateralKernel kernel(m_BilateralFilterDomainSigma, m_BilateralFilterRangeSigma);
+  const int radius = m_ApplyBilateralFilter ? kernel.radius : 0;
+  ParallelForRows(height, std::max(16, 4 * radius), numberOfThreads, [&](int firstRow, int endRow)
+  {
+    const float* source = m_FusedImage.data();
+    const int firstSourceRow = std::max(0, firstRow - radius);
+    const int endSourceRow = std::min(height, endRow + radius);
+    std::vector<float> medianRows;
+    if (m_ApplyMedianFilter)
+    {
+      medianRows.resize(static_cast<std::size_t>(endSourceRow - firstSourceRow) * width);
+      for (int y = firstSourceRow; y < endSourceRow; ++y)
+      {
+        Median3x3Row(m_FusedImage.data(), width, height, y, &medianRows[static_cast<std::size_t>(y - firstSourceRow) * width]);
+      }
+      source = medianRows.data() - static_cast<std::ptrdiff_t>(firstSourceRow) * width;
+    }
+
+    if (!m_ApplyBilateralFilter)
+    {
+      std::copy(source + static_cast<std::ptrdiff_t>(firstRow) * width, source + static_cast<std::ptrdiff_t>(endRow) * width,
+                outputData + static_cast<std::ptrdiff_t>(firstRow) * width);
+      return;
+    }
+
+    std::vector<const float*> rows(2 * radius + 1);
+    for (int y = firstRow; y < endRow; ++y)
+    {
+      for (int i = 0; i <= 2 * radius; ++i)
+      {
+        rows[i] = source + static_cast<std::ptrdiff_t>(Clamp(y - radius + i, height - 1)) * width;
+      }
+      BilateralRow(rows.data(), width, kernel, outputData + static_cast<std::ptrdiff_t>(y) * width);
+    }
+  });
+}
+
+void mitk::ToFCompositeFilter::ProcessFusedSegmentationAndTemporalFilter(const float* inputData, const char* segmentationMask, int firstPixel, int endPixel)
+{
+  const bool applyTemporalFilter = (m_ApplyTemporalMedianFilter||m_ApplyAverageFilter) && m_TemporalMedianFilterNumOfFrames > 0;
+  const int bufferSize = m_FrameBufferSize;
+  const int frameCount = std::min(m_FrameBufferCount + 1, bufferSize); // number of frames including the current one
+  // the running sums are recomputed once per cycle through the ring buffer to avoid accumulating rounding errors
+  const bool recomputeSums = m_FrameBufferIndex == bufferSize - 1;
+
+  for (int i = firstPixel; i < endPixel; ++i)
+  {
+    float value = inputData[i];
+    if (m_ApplyThresholdFilter && (value<=m_ThresholdFilterMin || value>=m_ThresholdFilterMax))
+    {
+      value = 0.0f;
+    }
+    if (m_ApplyMaskSegmentation && segmentationMask && segmentationMask[i]==0)
+    {
+      value = 0.0f;
+    }
+
+    if (applyTemporalFilter)
+    {
+      float* frames = &m_FrameBuffer[static_cast<std::size_t>(i) * bufferSize];
+      float* sortedFrames = &m_SortedFrameBuffer[static_cast<std::size_t>(i) * bufferSize];
+      double& sum = m_FrameBufferSums[i];
+      int sortedCount = m_FrameBufferCount;
+
+      if (sortedCount == bufferSize) // remove the oldest frame which is overwritten by the current one
+      {
+        const float oldest = frames[m_FrameBufferIndex];
+        int k = 0;
+        while (k < sortedCount - 1 && !(sortedFrames[k] == oldest || (oldest != oldest && sortedFrames[k] != sortedFrames[k])))
+        {
+          ++k;
+        }
+        std::copy(sortedFrames + k + 1, sortedFrames + sortedCount, sortedFrames + k);
+        --sortedCount;
+        sum -= oldest;
+      }
+
+      frames[m_FrameBufferIndex] = value;
+      int k = sortedCount;
+      while (k > 0 && sortedFrames[k - 1] > value)
+      {
+        sortedFrames[k] = sortedFrames[k - 1];
+        --k;
+      }
+      sortedFrames[k] = value;
+      sum += value;
+
+      if (recomputeSums)
+      {
+        sum = 0.0;
+        for (int j = 0; j < frameCount; ++j)
+        {
+          sum += frames[j];
+        }
+      }
+
+      if (m_ApplyAverageFilter)
+      {
+        value = static_cast<float>(sum / frameCount);
+      }
+      else
+      {
+        value = sortedFrames[(frameCount - 1) / 2]; // lower median as returned by quick_select()
+      }
+    }
+    m_FusedImage[i] = value;
+  }
+}
+
 #define ELEM_SWAP(a,b) { register float t=(a);(a)=(b);(b)=t; }
 float mitk::ToFCompositeFilter::quick_select(float arr[], int n)
 {
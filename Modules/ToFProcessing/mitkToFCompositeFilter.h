@@ -18,6 +18,8 @@ found in the LICENSE file.
 #include <itkBilateralImageFilter.h>
 #include "opencv2/core.hpp"
 
+#include <vector>
+
 typedef itk::Image<float, 2> ItkImageType2D;
 typedef itk::Image<float, 3> ItkImageType3D;
 typedef itk::BilateralImageFilter<ItkImageType2D,ItkImageType2D> BilateralFilterType;
@@ -35,6 +37,12 @@ namespace mitk
   * - spatial median filter
   * - bilateral filter
   *
+  * By default the filters of OpenCV and ITK are used. With SetUseFusedPipeline() the filter uses native implementations
+  * working on float buffers of this filter instead: segmentation and temporal filter are computed in one pass over the
+  * pixels, spatial median and bilateral filter in a second pass, both by multiple threads. The temporal filter keeps
+  * the last frames of each pixel in a ring buffer together with a sorted copy and their sum, so the temporal median and
+  * average are updated incrementally with each new frame instead of being recomputed from all buffered frames.
+  *
   * @ingroup ToFProcessing
   */
   class MITKTOFPROCESSING_EXPORT ToFCompositeFilter : public ImageToImageFilter
@@ -57,6 +65,19 @@ namespace mitk
     itkGetConstMacro(ApplyMaskSegmentation,bool);
     itkSetMacro(ApplyBilateralFilter,bool);
     itkGetConstMacro(ApplyBilateralFilter,bool);
+    /*!
+    \brief Use the native fused implementation of the filters instead of OpenCV and ITK. Default: false
+    The spatial median filter is the 3x3 median with replicated border, the bilateral filter uses the kernels of
+    itk::BilateralImageFilter. The buffered frames of the temporal filter are not shared between both implementations.
+    */
+    itkSetMacro(UseFusedPipeline,bool);
+    itkGetConstMacro(UseFusedPipeline,bool);
+    itkBooleanMacro(UseFusedPipeline);
+    /*!
+    \brief Number of threads of the fused pipeline, 0 uses all hardware threads
+    */
+    itkSetMacro(NumberOfThreads,unsigned int);
+    itkGetConstMacro(NumberOfThreads,unsigned int);
 
     using itk::ProcessObject::SetInput;
 
@@ -161,6 +182,14 @@ namespace mitk
     \brief Initialize and allocate a 2D ITK image of dimension m_ImageWidth*m_ImageHeight
     */
     void CreateItkImage(ItkImageType2D::Pointer &itkInputImage);
+    /*!
+    \brief Applies all active filters to the distance image with the native implementations, see SetUseFusedPipeline()
+    */
+    void ProcessFusedPipeline(const float* inputData, float* outputData, int width, int height);
+    /*!
+    \brief Applies segmentation and temporal filter to the pixels [firstPixel, endPixel) and writes the result to m_FusedImage
+    */
+    void ProcessFusedSegmentationAndTemporalFilter(const float* inputData, const char* segmentationMask, int firstPixel, int endPixel);
 
     mitk::Image::Pointer m_SegmentationMask; ///< mask image used for segmenting the image
 
@@ -191,6 +220,16 @@ namespace mitk
     double m_BilateralFilterRangeSigma; ///< Parameter of the bilateral filter controlling the edge preserving effect of the filter. Default value: 60
     int m_BilateralFilterKernelRadius; ///< Kernel radius of the bilateral filter mask
 
+    bool m_UseFusedPipeline; ///< Flag indicating if the native fused implementation of the filters is used
+    unsigned int m_NumberOfThreads; ///< Number of threads of the fused pipeline, 0 uses all hardware threads
+
+    std::vector<float> m_FusedImage; ///< Distance image after segmentation and temporal filter in the fused pipeline
+    std::vector<float> m_FrameBuffer; ///< Ring buffer holding the last m_FrameBufferSize frames consecutively for each pixel
+    std::vector<float> m_SortedFrameBuffer; ///< Buffered frames of each pixel in ascending order for the temporal median
+    std::vector<double> m_FrameBufferSums; ///< Sum of the buffered frames of each pixel for the temporal average
+    int m_FrameBufferSize; ///< Maximal number of frames per pixel in m_FrameBuffer
+    int m_FrameBufferCount; ///< Number of frames currently held in m_FrameBuffer
+    int m_FrameBufferIndex; ///< Position of the next frame in m_FrameBuffer
   };
 } //END mitk namespace
 #endif
@@ -166,27 +166,24 @@ void mitk::ToFDistanceImageToPointSetFilter::GenerateData()
     int yDimension = (int)input->GetDimension(1);
     int pointCount = 0;
     mitk::ImagePixelReadAccessor<float,2> imageAcces(input, input->GetSliceData(0));
-    for (int j=0; j<yDimension; j++)
+    const float* distances = imageAcces.GetData();
+
+    // the rays of the pixels are only recomputed if the intrinsics or the image size changed
+    mitk::ToFProcessingCommon::ToFPoint2D origin;
+    origin.Fill(0.0);
+    mitk::ToFProcessingCommon::ToFPoint2D spacing;
+    spacing.Fill(1.0);
+    m_RayDirections.Update(m_ReconstructionMode ? ToFRayDirections::FocalLengthInPixelUnits : ToFRayDirections::FocalLengthInMm,
+      xDimension, yDimension, m_CameraIntrinsics, m_InterPixelDistance, origin, spacing);
+
+    const int size = xDimension*yDimension;
+    for (int pixelID=0; pixelID<size; pixelID++)
     {
-      for (int i=0; i<xDimension; i++)
+      mitk::ToFProcessingCommon::ToFScalarType distance = (double)distances[pixelID];
+      if (distance>mitk::eps)
       {
-        itk::Index<2> pixel;
-        pixel[0] = i;
-        pixel[1] = j;
-
-        mitk::ToFProcessingCommon::ToFScalarType distance = (double)imageAcces.GetPixelByIndex(pixel);
-
-        mitk::Point3D currentPoint;
-        if (m_ReconstructionMode)
-          currentPoint = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(i,j,distance,focalLengthInPixelUnits,principalPoint);
-        else
-          currentPoint = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(i,j,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-
-        if (distance>mitk::eps)
-        {
-          output->InsertPoint( pointCount, currentPoint );
-          pointCount++;
-        }
+        output->InsertPoint( pointCount, m_RayDirections.IndexToCartesianCoordinates(pixelID,distance) );
+        pointCount++;
       }
     }
   }
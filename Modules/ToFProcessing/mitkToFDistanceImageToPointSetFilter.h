@@ -19,6 +19,7 @@ found in the LICENSE file.
 #include <mitkPointSetSource.h>
 #include "mitkImageSource.h"
 #include <mitkToFProcessingCommon.h>
+#include <mitkToFRayDirections.h>
 #include <MitkToFProcessingExports.h>
 
 namespace mitk
@@ -130,6 +131,7 @@ namespace mitk
     mitk::CameraIntrinsics::Pointer m_CameraIntrinsics; ///< Member holding the intrinsic parameters needed for PointSet calculation
     ToFProcessingCommon::ToFPoint2D m_InterPixelDistance; ///< distance in mm between two adjacent pixels on the ToF camera chip
     bool m_ReconstructionMode; ///< true = Reconstruction without interpixeldistance and with focal lengths in pixel units. false = Reconstruction with interpixeldistance and with focal length in mm.
+    ToFRayDirections m_RayDirections; ///< Viewing rays of the pixels, used if no subset is defined
   };
 } //END mitk namespace
 #endif
@@ -25,12 +25,54 @@ found in the LICENSE file.
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
 
-#include <cmath>
 #include <vtkMath.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+  /** Cells created for a pixel */
+  enum CellType { NoCell = 0, TriangleCells = 1, VertexCell = 2 };
+
+  /** Calls function(firstRow, endRow) for blocks of rows which are distributed to the given number of threads */
+  template <typename FunctionType>
+  void ParallelForRows(int numberOfRows, unsigned int numberOfThreads, FunctionType function)
+  {
+    const int rowsPerBlock = 16;
+    const int numberOfBlocks = (numberOfRows + rowsPerBlock - 1) / rowsPerBlock;
+    numberOfThreads = std::max(1u, std::min(numberOfThreads, static_cast<unsigned int>(std::max(numberOfBlocks, 1))));
+
+    std::atomic<int> nextBlock(0);
+    auto worker = [&]()
+    {
+      for (int block = nextBlock++; block < numberOfBlocks; block = nextBlock++)
+      {
+        function(block * rowsPerBlock, std::min(numberOfRows, (block + 1) * rowsPerBlock));
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned int i = 1; i < numberOfThreads; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  }
+}
+
 mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_IplScalarImage(nullptr), m_CameraIntrinsics(), m_TextureImageWidth(0), m_TextureImageHeight(0), m_InterPixelDistance(), m_TextureIndex(0),
-  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0)
+  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0), m_NumberOfThreads(0),
+  m_ConnectivityIsReusable(false), m_ConnectivityIsTriangulated(false), m_ConnectivityXDimension(0), m_ConnectivityYDimension(0)
 {
   m_InterPixelDistance.Fill(0.045);
   m_CameraIntrinsics = mitk::CameraIntrinsics::New();
@@ -38,6 +80,14 @@ mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_CameraIntrinsics->SetPrincipalPoint(107.867935181,98.3807373047);
   m_CameraIntrinsics->SetDistorsionCoeffs(-0.486690014601f,0.553943634033f,0.00222016777843f,-0.00300851115026f);
   m_ReconstructionMode = WithInterPixelDistance;
+
+  m_Points = vtkSmartPointer<vtkPoints>::New();
+  m_Points->SetDataTypeToDouble();
+  m_Polys = vtkSmartPointer<vtkCellArray>::New();
+  m_Vertices = vtkSmartPointer<vtkCellArray>::New();
+  m_ScalarArray = vtkSmartPointer<vtkFloatArray>::New();
+  m_TextureCoords = vtkSmartPointer<vtkFloatArray>::New();
+  m_TextureCoords->SetNumberOfComponents(2);
 }
 
 mitk::ToFDistanceImageToSurfaceFilter::~ToFDistanceImageToSurfaceFilter()
@@ -95,30 +145,11 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   int xDimension = input->GetDimension(0);
   int yDimension = input->GetDimension(1);
   unsigned int size = xDimension*yDimension; //size of the image-array
-  std::vector<bool> isPointValid;
-  isPointValid.resize(size);
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  points->SetDataTypeToDouble();
-  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New();
-  vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
-  vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
-  textureCoords->SetNumberOfComponents(2);
-  textureCoords->Allocate(size);
-
-  //Make a vtkIdList to save the ID's of the polyData corresponding to the image
-  //pixel ID's. See below for more documentation.
-  m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
-  //Allocate the object once else it would automatically allocate new memory
-  //for every vertex and perform a copy which is expensive.
-  m_VertexIdList->Allocate(size);
-  m_VertexIdList->SetNumberOfIds(size);
-  for(unsigned int i = 0; i < size; ++i)
-  {
-    m_VertexIdList->SetId(i, 0);
-  }
+
+  unsigned int numberOfThreads = m_NumberOfThreads > 0 ? m_NumberOfThreads : std::thread::hardware_concurrency();
 
   float* scalarFloatData = nullptr;
+  std::unique_ptr<ImageReadAccessor> textureAcc;
 
   if (this->m_IplScalarImage) // if scalar image is defined use it for texturing
   {
@@ -126,97 +157,173 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   }
   else if (this->GetInput(m_TextureIndex)) // otherwise use intensity image (input(2))
   {
-    ImageReadAccessor inputAcc(this->GetInput(m_TextureIndex));
-    scalarFloatData = (float*)inputAcc.GetData();
+    textureAcc.reset(new ImageReadAccessor(this->GetInput(m_TextureIndex)));
+    scalarFloatData = (float*)textureAcc->GetData();
   }
 
   ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
   float* inputFloatData = (float*)inputAcc.GetData();
-  //calculate world coordinates
-  mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
-  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm;
-  if((m_ReconstructionMode == WithOutInterPixelDistance) || (m_ReconstructionMode == Kinect))
+
+  //calculate the viewing rays of the pixels, they are only recomputed if the camera or the image size changed
+  ToFRayDirections::ModelType model = ToFRayDirections::FocalLengthInMm;
+  switch (m_ReconstructionMode)
   {
-    focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
-    focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
-    focalLengthInMm = 0.0;
+  case WithOutInterPixelDistance:
+    model = ToFRayDirections::FocalLengthInPixelUnits;
+    break;
+  case WithInterPixelDistance:
+    model = ToFRayDirections::FocalLengthInMm;
+    break;
+  case Kinect:
+    model = ToFRayDirections::Kinect;
+    break;
+  default:
+    mitkThrow() << "Incorrect reconstruction mode!";
   }
-  else if( m_ReconstructionMode == WithInterPixelDistance)
+
+  /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
+  * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
+  * due to cropping or the spacing differes due to up- or downsampling.*/
+  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
+  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  ToFProcessingCommon::ToFPoint2D origin2D;
+  origin2D[0] = origin[0];
+  origin2D[1] = origin[1];
+  ToFProcessingCommon::ToFPoint2D spacing2D;
+  spacing2D[0] = spacing[0];
+  spacing2D[1] = spacing[1];
+  m_RayDirections.Update(model, xDimension, yDimension, m_CameraIntrinsics, m_InterPixelDistance, origin2D, spacing2D);
+
+  //Find the valid pixels and count them per row. The triangulation can be reused if they did not change.
+  //The cells index the pixels row by row, so they cannot be reused if only the aspect ratio changed
+  bool validPixelsChanged = xDimension != m_ConnectivityXDimension || yDimension != m_ConnectivityYDimension ||
+                            m_ValidPixels.size() != size;
+  m_ValidPixels.resize(size, 0);
+  std::vector<vtkIdType> rowOffsets(yDimension + 1, 0);
+  std::vector<unsigned char> rowChanged(yDimension, 0);
+  ParallelForRows(yDimension, numberOfThreads, [&](int firstRow, int endRow)
   {
-    //convert focallength from pixel to mm
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
-  }
-  else
+    for (int j = firstRow; j < endRow; ++j)
+    {
+      vtkIdType numberOfValidPixels = 0;
+      unsigned char changed = 0;
+      for (int i = 0, pixelID = j*xDimension; i < xDimension; ++i, ++pixelID)
+      {
+        //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
+        unsigned char isPointValid = !((double)inputFloatData[pixelID] <= mitk::eps);
+        changed |= isPointValid ^ m_ValidPixels[pixelID];
+        m_ValidPixels[pixelID] = isPointValid;
+        numberOfValidPixels += isPointValid;
+      }
+      rowOffsets[j + 1] = numberOfValidPixels;
+      rowChanged[j] = changed;
+    }
+  });
+  for (int j = 0; j < yDimension; ++j)
   {
-    focalLengthInPixelUnits[0] = 0.0;
-    focalLengthInPixelUnits[1] = 0.0;
-    focalLengthInMm = 0.0;
+    rowOffsets[j + 1] += rowOffsets[j];
+    validPixelsChanged = validPixelsChanged || rowChanged[j];
   }
+  vtkIdType numberOfPoints = rowOffsets[yDimension];
 
-  mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
-  principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
-  principalPoint[1] = m_CameraIntrinsics->GetPrincipalPointY();
+  //VTK would insert empty points into the polydata if we use points->InsertPoint(pixelID, ...).
+  //The points are stored consecutively instead, thus the ID's do not correspond to the image pixel ID's
+  //and we have to save them in the vertexIdList. Invalid pixels keep the ID 0.
+  if (m_VertexIdList.GetPointer() == nullptr)
+  {
+    m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
+  }
+  m_VertexIdList->SetNumberOfIds(size);
+  vtkIdType* vertexIds = m_VertexIdList->GetPointer(0);
 
-  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
-  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+  m_Points->SetNumberOfPoints(numberOfPoints);
+  double* points = static_cast<double*>(m_Points->GetVoidPointer(0));
+  m_ScalarArray->SetNumberOfTuples(scalarFloatData ? numberOfPoints : 0);
+  float* scalars = m_ScalarArray->GetPointer(0);
+  m_TextureCoords->SetNumberOfTuples(numberOfPoints);
+  float* textureCoords = m_TextureCoords->GetPointer(0);
 
-  for (int j=0; j<yDimension; j++)
+  ParallelForRows(yDimension, numberOfThreads, [&](int firstRow, int endRow)
   {
-    for (int i=0; i<xDimension; i++)
+    for (int j = firstRow; j < endRow; ++j)
     {
-      unsigned int pixelID = i+j*xDimension;
+      vtkIdType id = rowOffsets[j];
+      for (int i = 0, pixelID = j*xDimension; i < xDimension; ++i, ++pixelID)
+      {
+        if (!m_ValidPixels[pixelID])
+        {
+          vertexIds[pixelID] = 0;
+          continue;
+        }
+        mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
+        m_RayDirections.IndexToCartesianCoordinates(pixelID, distance, points + 3*id);
+        vertexIds[pixelID] = id;
 
-      mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
+        //Scalar values are necessary for mapping colors/texture onto the surface
+        if (scalarFloatData)
+        {
+          scalars[id] = scalarFloatData[pixelID];
+        }
+        //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
+        textureCoords[2*id] = ((float)i)/xDimension;// correct video texture scale for kinect
+        textureCoords[2*id+1] = ((float)j)/yDimension; //don't flip. we don't need to flip.
+        ++id;
+      }
+    }
+  });
+  m_Points->Modified();
+  m_ScalarArray->Modified();
+  m_TextureCoords->Modified();
+
+  //Without triangulation threshold the cells only depend on the valid pixels
+  bool connectivityDependsOnPoints = m_GenerateTriangularMesh && !mitk::Equal(m_TriangulationThreshold, 0.0);
+  if (validPixelsChanged || connectivityDependsOnPoints || !m_ConnectivityIsReusable ||
+      m_ConnectivityIsTriangulated != m_GenerateTriangularMesh)
+  {
+    this->GenerateConnectivity(xDimension, yDimension, numberOfThreads);
+  }
 
-      /** Here we have to incorporate spacing and origin to allow processing of cropped/resampled images
-      * Usually origin will be [0, 0, 0] and spacing will be [1, 1, 1], but just in case the image is moved
-      * due to cropping or the spacing differes due to up- or downsampling.*/
-      unsigned int completeIndexX = i*spacing[0]+origin[0];
-      unsigned int completeIndexY = j*spacing[1]+origin[1];
+  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+  mesh->SetPoints(m_Points);
+  mesh->SetPolys(m_Polys);
+  mesh->SetVerts(m_Vertices);
+  //Pass the scalars to the polydata (if they were set).
+  if (m_ScalarArray->GetNumberOfTuples()>0)
+  {
+    mesh->GetPointData()->SetScalars(m_ScalarArray);
+  }
+  //Pass the TextureCoords to the polydata anyway (to save them).
+  mesh->GetPointData()->SetTCoords(m_TextureCoords);
+  output->SetVtkPolyData(mesh);
+}
 
-      mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates;
-      switch (m_ReconstructionMode)
-      {
-      case WithOutInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
-      }
-      case WithInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-        break;
-      }
-      case Kinect:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
-      }
-      default:
-      {
-        MITK_ERROR << "Incorrect reconstruction mode!";
-      }
-      }
-      //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
-      if (distance<=mitk::eps)
-      {
-        isPointValid[pixelID] = false;
-      }
-      else
+void mitk::ToFDistanceImageToSurfaceFilter::GenerateConnectivity(int xDimension, int yDimension, unsigned int numberOfThreads)
+{
+  bool connectivityDependsOnPoints = m_GenerateTriangularMesh && !mitk::Equal(m_TriangulationThreshold, 0.0);
+  const vtkIdType* vertexIds = m_VertexIdList->GetPointer(0);
+  const double* points = static_cast<const double*>(m_Points->GetVoidPointer(0));
+
+  //Decide for every pixel which cells it creates and count them per row
+  m_CellTypes.resize(m_ValidPixels.size());
+  std::vector<vtkIdType> polyOffsets(yDimension + 1, 0);
+  std::vector<vtkIdType> vertexOffsets(yDimension + 1, 0);
+  ParallelForRows(yDimension, numberOfThreads, [&](int firstRow, int endRow)
+  {
+    for (int j = firstRow; j < endRow; ++j)
+    {
+      vtkIdType numberOfQuads = 0;
+      vtkIdType numberOfVertices = 0;
+      for (int i = 0, pixelID = j*xDimension; i < xDimension; ++i, ++pixelID)
       {
-        isPointValid[pixelID] = true;
-        //VTK would insert empty points into the polydata if we use
-        //points->InsertPoint(pixelID, cartesianCoordinates.GetDataPointer()).
-        //If we use points->InsertNextPoint(...) instead, the ID's do not
-        //correspond to the image pixel ID's. Thus, we have to save them
-        //in the vertexIdList.
-        m_VertexIdList->SetId(pixelID, points->InsertNextPoint(cartesianCoordinates.GetDataPointer()));
-
-        if (m_GenerateTriangularMesh)
+        unsigned char cellType = NoCell;
+        if (m_ValidPixels[pixelID])
         {
-          if((i >= 1) && (j >= 1))
+          if (!m_GenerateTriangularMesh)
+          {
+            //We dont want triangulation, we only want vertices
+            cellType = VertexCell;
+          }
+          else if ((i >= 1) && (j >= 1))
           {
             //This little piece of art explains the ID's:
             //
@@ -235,76 +342,92 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
             vtkIdType xy_1 = pixelID-xDimension;
             vtkIdType x_1y_1 = xy_1-1;
 
-            //Find the corresponding vertex ID's in the saved vertexIdList:
-            vtkIdType xyV = m_VertexIdList->GetId(xy);
-            vtkIdType x_1yV = m_VertexIdList->GetId(x_1y);
-            vtkIdType xy_1V = m_VertexIdList->GetId(xy_1);
-            vtkIdType x_1y_1V = m_VertexIdList->GetId(x_1y_1);
-
-            if (isPointValid[xy]&&isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1]) // check if points of cell are valid
+            if (m_ValidPixels[x_1y]&&m_ValidPixels[x_1y_1]&&m_ValidPixels[xy_1]) // check if points of cell are valid
             {
-              double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
-
-              points->GetPoint(xyV, pointXY);
-              points->GetPoint(x_1yV, pointX_1Y);
-              points->GetPoint(xy_1V, pointXY_1);
-              points->GetPoint(x_1y_1V, pointX_1Y_1);
-
-              if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
+              cellType = TriangleCells;
+              if (connectivityDependsOnPoints)
               {
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1yV);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(x_1y_1V);
-
-                polys->InsertNextCell(3);
-                polys->InsertCellPoint(x_1y_1V);
-                polys->InsertCellPoint(xyV);
-                polys->InsertCellPoint(xy_1V);
-              }
-              else
-              {
-                //We dont want triangulation, but we want to keep the vertex
-                vertices->InsertNextCell(1);
-                vertices->InsertCellPoint(xyV);
+                const double* pointXY = points + 3*vertexIds[xy];
+                const double* pointX_1Y = points + 3*vertexIds[x_1y];
+                const double* pointXY_1 = points + 3*vertexIds[xy_1];
+                const double* pointX_1Y_1 = points + 3*vertexIds[x_1y_1];
+
+                if (!((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
+                      && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
+                      && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
+                      && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
+                {
+                  //We dont want triangulation, but we want to keep the vertex
+                  cellType = VertexCell;
+                }
               }
             }
           }
         }
-        else
+        m_CellTypes[pixelID] = cellType;
+        numberOfQuads += (cellType == TriangleCells);
+        numberOfVertices += (cellType == VertexCell);
+      }
+      polyOffsets[j + 1] = numberOfQuads;
+      vertexOffsets[j + 1] = numberOfVertices;
+    }
+  });
+  for (int j = 0; j < yDimension; ++j)
+  {
+    polyOffsets[j + 1] += polyOffsets[j];
+    vertexOffsets[j + 1] += vertexOffsets[j];
+  }
+
+  //Write the cells directly into the reused cell arrays, each quad is split into two triangles
+  vtkIdType numberOfQuads = polyOffsets[yDimension];
+  vtkIdType numberOfVertices = vertexOffsets[yDimension];
+  m_Polys->Reset();
+  vtkIdType* polys = m_Polys->WritePointer(2*numberOfQuads, 8*numberOfQuads);
+  m_Vertices->Reset();
+  vtkIdType* vertices = m_Vertices->WritePointer(numberOfVertices, 2*numberOfVertices);
+  ParallelForRows(yDimension, numberOfThreads, [&](int firstRow, int endRow)
+  {
+    for (int j = firstRow; j < endRow; ++j)
+    {
+      vtkIdType* poly = polys + 8*polyOffsets[j];
+      vtkIdType* vertex = vertices + 2*vertexOffsets[j];
+      for (int i = 0, pixelID = j*xDimension; i < xDimension; ++i, ++pixelID)
+      {
+        if (m_CellTypes[pixelID] == TriangleCells)
         {
-          //We dont want triangulation, we only want vertices
-          vertices->InsertNextCell(1);
-          vertices->InsertCellPoint(m_VertexIdList->GetId(pixelID));
+          //Find the corresponding vertex ID's in the saved vertexIdList:
+          vtkIdType xyV = vertexIds[pixelID];
+          vtkIdType x_1yV = vertexIds[pixelID-1];
+          vtkIdType xy_1V = vertexIds[pixelID-xDimension];
+          vtkIdType x_1y_1V = vertexIds[pixelID-xDimension-1];
+
+          poly[0] = 3;
+          poly[1] = x_1yV;
+          poly[2] = xyV;
+          poly[3] = x_1y_1V;
+
+          poly[4] = 3;
+          poly[5] = x_1y_1V;
+          poly[6] = xyV;
+          poly[7] = xy_1V;
+          poly += 8;
         }
-        //Scalar values are necessary for mapping colors/texture onto the surface
-        if (scalarFloatData)
+        else if (m_CellTypes[pixelID] == VertexCell)
         {
-          scalarArray->InsertTuple1(m_VertexIdList->GetId(pixelID), scalarFloatData[pixelID]);
+          vertex[0] = 1;
+          vertex[1] = vertexIds[pixelID];
+          vertex += 2;
         }
-        //These Texture Coordinates will map color pixel and vertices 1:1 (e.g. for Kinect).
-        float xNorm = (((float)i)/xDimension);// correct video texture scale for kinect
-        float yNorm = ((float)j)/yDimension; //don't flip. we don't need to flip.
-        textureCoords->InsertTuple2(m_VertexIdList->GetId(pixelID), xNorm, yNorm);
       }
     }
-  }
-
-  vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-  mesh->SetPoints(points);
-  mesh->SetPolys(polys);
-  mesh->SetVerts(vertices);
-  //Pass the scalars to the polydata (if they were set).
-  if (scalarArray->GetNumberOfTuples()>0)
-  {
-    mesh->GetPointData()->SetScalars(scalarArray);
-  }
-  //Pass the TextureCoords to the polydata anyway (to save them).
-  mesh->GetPointData()->SetTCoords(textureCoords);
-  output->SetVtkPolyData(mesh);
+  });
+  m_Polys->Modified();
+  m_Vertices->Modified();
+
+  m_ConnectivityIsReusable = !connectivityDependsOnPoints;
+  m_ConnectivityIsTriangulated = m_GenerateTriangularMesh;
+  m_ConnectivityXDimension = xDimension;
+  m_ConnectivityYDimension = yDimension;
 }
 
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
@@ -17,12 +17,18 @@ found in the LICENSE file.
 #include <mitkSurfaceSource.h>
 #include <MitkToFProcessingExports.h>
 #include <mitkToFProcessingCommon.h>
+#include <mitkToFRayDirections.h>
 #include <mitkCameraIntrinsics.h>
 #include "mitkCameraIntrinsics.h"
 #include <mitkPointSet.h>
 
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkPoints.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -38,6 +44,12 @@ namespace mitk
   * The definition of the image plane and its coordinate systems (pixel and mm) is depicted in the following image
   * \image html ../Modules/ToFProcessing/Documentation/ImagePlane.png
   *
+  * The viewing rays of the pixels are computed once (see ToFRayDirections) and only recomputed if the camera
+  * intrinsics, the reconstruction mode or the image size change. The frames are reconstructed by multiple threads
+  * into point and cell buffers which are reused by the next update, the triangulation is only recomputed if the
+  * set of valid pixels changed or a triangulation threshold is set. Each update sets a new vtkPolyData as output,
+  * but it shares these buffers. Copy it (vtkPolyData::DeepCopy()) to keep a frame beyond the next update.
+  *
   * @ingroup SurfaceFilters
   * @ingroup ToFProcessing
   */
@@ -75,6 +87,12 @@ namespace mitk
     itkSetMacro(GenerateTriangularMesh,bool);
     itkGetMacro(GenerateTriangularMesh,bool);
 
+    /*!
+    \brief Number of threads used for the reconstruction, 0 uses all hardware threads
+    */
+    itkSetMacro(NumberOfThreads, unsigned int);
+    itkGetMacro(NumberOfThreads, unsigned int);
+
 
     /**
      * @brief The ReconstructionModeType enum: Defines the reconstruction mode, if using no interpixeldistances and focal lenghts in pixel units  or interpixeldistances and focal length in mm. The Kinect option defines a special reconstruction mode for the kinect.
@@ -166,6 +184,10 @@ namespace mitk
     * \warning any additional outputs that exist before the method is called are deleted
     */
     void CreateOutputsForAllInputs();
+    /*!
+    \brief Computes the cells of the surface from the valid pixels and the reconstructed points
+    */
+    void GenerateConnectivity(int xDimension, int yDimension, unsigned int numberOfThreads);
 
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
@@ -184,6 +206,22 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    unsigned int m_NumberOfThreads; ///< Number of threads used for the reconstruction, 0 uses all hardware threads
+
+    ToFRayDirections m_RayDirections; ///< Viewing rays of the pixels for the current intrinsics and image size
+
+    std::vector<unsigned char> m_ValidPixels; ///< Pixels with a distance larger than mitk::eps in the last update
+    std::vector<unsigned char> m_CellTypes; ///< Cells created for each pixel: none, two triangles or a single vertex
+    bool m_ConnectivityIsReusable; ///< The cells only depend on m_ValidPixels, i.e. no triangulation threshold was applied
+    bool m_ConnectivityIsTriangulated; ///< The cells were computed with m_GenerateTriangularMesh set
+    int m_ConnectivityXDimension; ///< Width of the image the cells were computed for
+    int m_ConnectivityYDimension; ///< Height of the image the cells were computed for
+
+    vtkSmartPointer<vtkPoints> m_Points; ///< Points of the surface, reused between the updates
+    vtkSmartPointer<vtkCellArray> m_Polys; ///< Triangles of the surface, reused between the updates
+    vtkSmartPointer<vtkCellArray> m_Vertices; ///< Vertices of the surface, reused between the updates
+    vtkSmartPointer<vtkFloatArray> m_ScalarArray; ///< Texture scalars of the points, reused between the updates
+    vtkSmartPointer<vtkFloatArray> m_TextureCoords; ///< Texture coordinates of the points, reused between the updates
   };
 } //END mitk namespace
 #endif
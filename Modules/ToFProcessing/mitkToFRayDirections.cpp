@@ -0,0 +1,107 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkToFRayDirections.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <cmath>
+
+mitk::ToFRayDirections::ToFRayDirections()
+{
+}
+
+bool mitk::ToFRayDirections::Update(ModelType model, unsigned int dimX, unsigned int dimY, const CameraIntrinsics *cameraIntrinsics,
+  const ToFPoint2D &interPixelDistance, const ToFPoint2D &origin, const ToFPoint2D &spacing)
+{
+  if (cameraIntrinsics == nullptr)
+  {
+    mitkThrow() << "No camera intrinsics given for the computation of the ray directions";
+  }
+
+  const ToFScalarType focalLengthX = cameraIntrinsics->GetFocalLengthX();
+  const ToFScalarType focalLengthY = cameraIntrinsics->GetFocalLengthY();
+  const ToFScalarType principalPointX = cameraIntrinsics->GetPrincipalPointX();
+  const ToFScalarType principalPointY = cameraIntrinsics->GetPrincipalPointY();
+
+  // the intrinsics may be changed in place, therefore the values are compared and not the object
+  std::vector<ToFScalarType> parameters = { static_cast<ToFScalarType>(model), static_cast<ToFScalarType>(dimX),
+    static_cast<ToFScalarType>(dimY), focalLengthX, focalLengthY, principalPointX, principalPointY,
+    interPixelDistance[0], interPixelDistance[1], origin[0], origin[1], spacing[0], spacing[1] };
+  if (parameters == m_Parameters)
+  {
+    return false;
+  }
+
+  // same focal length in mm as used by ToFDistanceImageToSurfaceFilter and ToFDistanceImageToPointSetFilter
+  const ToFScalarType focalLengthInMm = (focalLengthX*interPixelDistance[0]+focalLengthY*interPixelDistance[1])/2.0;
+
+  const std::size_t size = static_cast<std::size_t>(dimX) * dimY;
+  m_Factors.resize(3 * size);
+  m_Divisors.resize(3 * size);
+  ToFScalarType *factors = m_Factors.data();
+  ToFScalarType *divisors = m_Divisors.data();
+  for (unsigned int j = 0; j < dimY; ++j)
+  {
+    const unsigned int indexY = j*spacing[1]+origin[1];
+    for (unsigned int i = 0; i < dimX; ++i, factors += 3, divisors += 3)
+    {
+      const unsigned int indexX = i*spacing[0]+origin[0];
+
+      // the same terms as in ToFProcessingCommon with the distance factored out
+      switch (model)
+      {
+      case FocalLengthInPixelUnits:
+      {
+        ToFScalarType imageX = indexX - principalPointX;
+        ToFScalarType imageY = indexY - principalPointY;
+        ToFScalarType imageY_in_pX = imageY * (focalLengthX / focalLengthY);
+        ToFScalarType d_in_pX = std::sqrt(imageX*imageX + imageY_in_pX*imageY_in_pX + focalLengthX*focalLengthX);
+        factors[0] = imageX;
+        factors[1] = imageY_in_pX;
+        factors[2] = focalLengthX;
+        divisors[0] = divisors[1] = divisors[2] = d_in_pX;
+        break;
+      }
+      case FocalLengthInMm:
+      {
+        ToFScalarType imageX = (( indexX - principalPointX ) * interPixelDistance[0]);
+        ToFScalarType imageY = (( indexY - principalPointY ) * interPixelDistance[1]);
+        ToFScalarType d = std::sqrt(imageX*imageX + imageY*imageY + focalLengthInMm*focalLengthInMm);
+        factors[0] = imageX;
+        factors[1] = imageY;
+        factors[2] = focalLengthInMm;
+        divisors[0] = divisors[1] = divisors[2] = d;
+        break;
+      }
+      case Kinect:
+      {
+        factors[0] = indexX - principalPointX;
+        factors[1] = indexY - principalPointY;
+        factors[2] = 1.0;
+        divisors[0] = focalLengthX;
+        divisors[1] = focalLengthY;
+        divisors[2] = 1.0;
+        break;
+      }
+      default:
+      {
+        m_Parameters.clear();
+        mitkThrow() << "Incorrect reconstruction mode!";
+      }
+      }
+    }
+  }
+
+  m_Parameters.swap(parameters);
+  return true;
+}
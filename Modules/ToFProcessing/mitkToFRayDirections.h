@@ -0,0 +1,95 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+#ifndef __mitkToFRayDirections_h
+#define __mitkToFRayDirections_h
+
+#include <MitkToFProcessingExports.h>
+#include <mitkCameraIntrinsics.h>
+#include <mitkToFProcessingCommon.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * @brief Viewing ray of every pixel of a ToF camera image.
+  *
+  * All reconstruction models of ToFProcessingCommon compute the cartesian coordinates of a pixel from its
+  * distance value and terms which only depend on the pixel index and the camera. Update() computes these
+  * terms for a whole image and only recomputes them if the camera, the model or the image size changed, so
+  * reconstructing a frame does not need the square roots and the model dependent code of
+  * ToFProcessingCommon::IndexToCartesianCoordinates() for every pixel.
+  *
+  * Each coordinate is computed as (distance * factor) / divisor, i.e. with the same rounding as in
+  * ToFProcessingCommon, so the results are identical to the ones of the per pixel conversion.
+  *
+  * @ingroup ToFProcessing
+  */
+  class MITKTOFPROCESSING_EXPORT ToFRayDirections
+  {
+  public:
+    typedef ToFProcessingCommon::ToFScalarType ToFScalarType;
+    typedef ToFProcessingCommon::ToFPoint2D ToFPoint2D;
+    typedef ToFProcessingCommon::ToFPoint3D ToFPoint3D;
+
+    /*!
+    \brief Camera models matching ToFProcessingCommon::IndexToCartesianCoordinates() (focal length in pixel units),
+    ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist() (focal length in mm) and
+    ToFProcessingCommon::KinectIndexToCartesianCoordinates()
+    */
+    enum ModelType { FocalLengthInPixelUnits, FocalLengthInMm, Kinect };
+
+    ToFRayDirections();
+
+    /*!
+    \brief Computes the rays for an image of dimX x dimY pixels if any parameter changed since the last call
+    \param model camera model used for the reconstruction
+    \param dimX number of pixels in x direction
+    \param dimY number of pixels in y direction
+    \param cameraIntrinsics focal length and principal point of the camera
+    \param interPixelDistance distance between adjacent pixels in mm, only used by FocalLengthInMm
+    \param origin, spacing pixel (i,j) is located at the camera index (origin[0]+i*spacing[0], origin[1]+j*spacing[1])
+    which is truncated to integers as in the reconstruction of cropped or resampled distance images
+    \return true if the rays were recomputed
+    */
+    bool Update(ModelType model, unsigned int dimX, unsigned int dimY, const CameraIntrinsics *cameraIntrinsics,
+      const ToFPoint2D &interPixelDistance, const ToFPoint2D &origin, const ToFPoint2D &spacing);
+
+    /*!
+    \brief Writes the cartesian coordinates of the pixel with the given id (i+j*dimX) and distance to cartesianCoordinates
+    */
+    void IndexToCartesianCoordinates(std::size_t pixelID, ToFScalarType distance, ToFScalarType cartesianCoordinates[3]) const
+    {
+      const ToFScalarType *factors = &m_Factors[3 * pixelID];
+      const ToFScalarType *divisors = &m_Divisors[3 * pixelID];
+      cartesianCoordinates[0] = distance * factors[0] / divisors[0];
+      cartesianCoordinates[1] = distance * factors[1] / divisors[1];
+      cartesianCoordinates[2] = distance * factors[2] / divisors[2];
+    }
+
+    /*!
+    \brief Convenience method returning the cartesian coordinates of the pixel with the given id (i+j*dimX)
+    */
+    ToFPoint3D IndexToCartesianCoordinates(std::size_t pixelID, ToFScalarType distance) const
+    {
+      ToFPoint3D cartesianCoordinates;
+      this->IndexToCartesianCoordinates(pixelID, distance, cartesianCoordinates.GetDataPointer());
+      return cartesianCoordinates;
+    }
+
+  private:
+    std::vector<ToFScalarType> m_Parameters; ///< parameters of the last computation of the rays
+    std::vector<ToFScalarType> m_Factors; ///< three factors per pixel
+    std::vector<ToFScalarType> m_Divisors; ///< three divisors per pixel
+  };
+} //END mitk namespace
+#endif
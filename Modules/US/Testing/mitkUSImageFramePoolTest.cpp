@@ -0,0 +1,317 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkUSImageFramePool.h"
+#include "mitkUSImageSource.h"
+#include <mitkAbstractOpenCVImageFilter.h>
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkRGBPixel.h>
+
+#include <algorithm>
+
+namespace
+{
+  /** Returns the same image on every call, like a device that keeps its frame buffer. */
+  class TestImageSource : public mitk::USImageSource
+  {
+  public:
+    mitkClassMacro(TestImageSource, mitk::USImageSource);
+    itkFactorylessNewMacro(Self);
+
+    mitk::Image::Pointer RawImage;
+
+  protected:
+    void GetNextRawImage(std::vector<mitk::Image::Pointer>& images) override
+    {
+      images.assign(1, RawImage);
+    }
+  };
+
+  /** Remembers the first pixel and the buffer it was given and increments all values in place. */
+  class IncrementFilter : public mitk::AbstractOpenCVImageFilter
+  {
+  public:
+    mitkClassMacro(IncrementFilter, mitk::AbstractOpenCVImageFilter);
+    itkFactorylessNewMacro(Self);
+
+    cv::Vec3b FirstPixel;
+    const void* Data = nullptr;
+
+    bool OnFilterImage(cv::Mat& image) override
+    {
+      Data = image.data;
+      if (image.channels() == 3)
+        FirstPixel = image.at<cv::Vec3b>(0, 0);
+      image += cv::Scalar::all(1);
+      return true;
+    }
+  };
+}
+
+class mitkUSImageFramePoolTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkUSImageFramePoolTestSuite);
+  MITK_TEST(TestFramesAreRecycled);
+  MITK_TEST(TestFramesInUseAreNotRecycled);
+  MITK_TEST(TestPoolIsBounded);
+  MITK_TEST(TestViewedFramesAreNotRecycled);
+  MITK_TEST(TestViewKeepsImageAlive);
+  MITK_TEST(TestViewIsConvertedWithoutCopy);
+  MITK_TEST(TestConversionOfGrayFrame);
+  MITK_TEST(TestConversionOfColorFrame);
+  MITK_TEST(TestUnsupportedType);
+  MITK_TEST(TestConvertedViewIsModified);
+  MITK_TEST(TestImageSourceFiltersViewOfGrayImage);
+  MITK_TEST(TestImageSourceKeepsChannelOrder);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void TestFramesAreRecycled()
+  {
+    mitk::USImageFramePool pool(4);
+
+    void* buffer = nullptr;
+    {
+      mitk::USImageFramePool::Frame frame = pool.Acquire(48, 64, CV_8UC1);
+      buffer = frame.Mat.data;
+    }
+
+    mitk::USImageFramePool::Frame frame = pool.Acquire(48, 64, CV_8UC1);
+    CPPUNIT_ASSERT_MESSAGE("Released frame is handed out again", frame.Mat.data == buffer);
+    CPPUNIT_ASSERT_EQUAL(1u, pool.GetNumberOfAllocatedFrames());
+  }
+
+  void TestFramesInUseAreNotRecycled()
+  {
+    mitk::USImageFramePool pool(4);
+
+    mitk::USImageFramePool::Frame first = pool.Acquire(48, 64, CV_8UC1);
+    mitk::USImageFramePool::Frame second = pool.Acquire(48, 64, CV_8UC1);
+
+    CPPUNIT_ASSERT(first.Mat.data != second.Mat.data);
+    CPPUNIT_ASSERT(first.Image.GetPointer() != second.Image.GetPointer());
+    CPPUNIT_ASSERT_EQUAL(2u, pool.GetNumberOfAllocatedFrames());
+  }
+
+  void TestPoolIsBounded()
+  {
+    mitk::USImageFramePool pool(2);
+
+    std::vector<mitk::USImageFramePool::Frame> frames;
+    for (int i = 0; i < 5; ++i)
+      frames.push_back(pool.Acquire(16, 16, CV_16UC1));
+
+    CPPUNIT_ASSERT_EQUAL(2u, pool.GetNumberOfAllocatedFrames());
+    for (const auto& frame : frames)
+    {
+      CPPUNIT_ASSERT(frame.Image.IsNotNull());
+      CPPUNIT_ASSERT(!frame.Mat.empty());
+    }
+  }
+
+  void TestViewedFramesAreNotRecycled()
+  {
+    mitk::USImageFramePool pool(4);
+
+    cv::Mat view;
+    mitk::Image* image = nullptr;
+    {
+      mitk::USImageFramePool::Frame frame = pool.Acquire(48, 64, CV_8UC1);
+      frame.Mat.setTo(cv::Scalar(7));
+      view = frame.Mat;
+      image = frame.Image;
+    }
+
+    // only the view is left, its frame must not be handed out and overwritten
+    mitk::USImageFramePool::Frame other = pool.Acquire(48, 64, CV_8UC1);
+    CPPUNIT_ASSERT(other.Mat.data != view.data);
+    other.Mat.setTo(cv::Scalar(1));
+    CPPUNIT_ASSERT_EQUAL(7.0, cv::norm(view, cv::NORM_INF));
+    CPPUNIT_ASSERT_EQUAL(7.0, cv::norm(view, cv::NORM_L1) / view.total());
+    CPPUNIT_ASSERT(pool.ToImage(view).GetPointer() == image);
+
+    // the view outlives the pool's frames
+    void* buffer = view.data;
+    pool.Clear();
+    CPPUNIT_ASSERT_EQUAL(7.0, cv::norm(view, cv::NORM_INF));
+
+    // once the view is released as well, the frame is recycled
+    mitk::USImageFramePool::Frame recycled = pool.Acquire(48, 64, CV_8UC1);
+    cv::Mat recycledView = recycled.Mat;
+    buffer = recycled.Mat.data;
+    recycled = mitk::USImageFramePool::Frame();
+    CPPUNIT_ASSERT(pool.Acquire(48, 64, CV_8UC1).Mat.data != buffer);
+    recycledView.release();
+    CPPUNIT_ASSERT(pool.Acquire(48, 64, CV_8UC1).Mat.data == buffer);
+  }
+
+  void TestViewKeepsImageAlive()
+  {
+    cv::Mat view;
+    {
+      unsigned int dimensions[2] = { 20, 10 };
+      auto image = mitk::Image::New();
+      image->Initialize(mitk::MakeScalarPixelType<unsigned short>(), 2, dimensions);
+      view = mitk::USImageFramePool::GetMatView(image);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(10, view.rows);
+    CPPUNIT_ASSERT_EQUAL(20, view.cols);
+    view.setTo(cv::Scalar(1000));
+    cv::Mat copy = view;
+    view.release();
+    CPPUNIT_ASSERT_EQUAL(1000.0, cv::norm(copy, cv::NORM_INF));
+  }
+
+  void TestViewIsConvertedWithoutCopy()
+  {
+    mitk::USImageFramePool pool;
+
+    mitk::USImageFramePool::Frame frame = pool.Acquire(10, 20, CV_32FC1);
+    frame.Mat.setTo(cv::Scalar(3.5));
+
+    mitk::Image::Pointer image = pool.ToImage(frame.Mat);
+    CPPUNIT_ASSERT_MESSAGE("View of a pooled frame returns the frame's image", image == frame.Image);
+
+    mitk::ImageReadAccessor accessor(image);
+    const float* data = static_cast<const float*>(accessor.GetData());
+    CPPUNIT_ASSERT_EQUAL(3.5f, data[0]);
+    CPPUNIT_ASSERT_EQUAL(3.5f, data[10 * 20 - 1]);
+  }
+
+  void TestConversionOfGrayFrame()
+  {
+    mitk::USImageFramePool pool;
+
+    cv::Mat mat(30, 40, CV_8UC1);
+    for (int y = 0; y < mat.rows; ++y)
+      for (int x = 0; x < mat.cols; ++x)
+        mat.at<unsigned char>(y, x) = static_cast<unsigned char>(x + y);
+
+    mitk::Image::Pointer image = pool.ToImage(mat);
+    CPPUNIT_ASSERT(image.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(40u, image->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(30u, image->GetDimension(1));
+
+    cv::Mat view = mitk::USImageFramePool::GetMatView(image);
+    CPPUNIT_ASSERT_MESSAGE("Converted image holds a copy of the pixels", view.data != mat.data);
+    CPPUNIT_ASSERT_EQUAL(0.0, cv::norm(view, mat, cv::NORM_INF));
+  }
+
+  void TestConversionOfColorFrame()
+  {
+    mitk::USImageFramePool pool;
+
+    cv::Mat mat(8, 8, CV_8UC3, cv::Scalar(1, 2, 3)); // BGR
+
+    mitk::Image::Pointer image = pool.ToImage(mat);
+    CPPUNIT_ASSERT(image.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(3u, image->GetPixelType().GetNumberOfComponents());
+
+    mitk::ImageReadAccessor accessor(image);
+    const unsigned char* data = static_cast<const unsigned char*>(accessor.GetData());
+    CPPUNIT_ASSERT_MESSAGE("Pixels are stored in RGB order", data[0] == 3 && data[1] == 2 && data[2] == 1);
+  }
+
+  void TestUnsupportedType()
+  {
+    mitk::USImageFramePool pool;
+
+    CPPUNIT_ASSERT(pool.ToImage(cv::Mat()).IsNull());
+    CPPUNIT_ASSERT(pool.ToImage(cv::Mat(4, 4, CV_32SC2)).IsNull());
+    CPPUNIT_ASSERT_THROW(pool.Acquire(4, 4, CV_32SC2), mitk::Exception);
+  }
+
+  void TestConvertedViewIsModified()
+  {
+    mitk::USImageFramePool pool;
+
+    unsigned int dimensions[2] = { 6, 4 };
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakePixelType<unsigned char, itk::RGBPixel<unsigned char>>(3), 2, dimensions);
+
+    cv::Mat view = mitk::USImageFramePool::GetMatView(image);
+    view.setTo(cv::Scalar(1, 2, 3)); // BGR
+    const itk::ModifiedTimeType timeStamp = image->GetMTime();
+
+    CPPUNIT_ASSERT_MESSAGE("View of an image returns the image", pool.ToImage(view) == image);
+    CPPUNIT_ASSERT_MESSAGE("Image is marked as modified", image->GetMTime() > timeStamp);
+    CPPUNIT_ASSERT_EQUAL(0u, pool.GetNumberOfAllocatedFrames());
+
+    mitk::ImageReadAccessor accessor(image);
+    const unsigned char* data = static_cast<const unsigned char*>(accessor.GetData());
+    CPPUNIT_ASSERT_MESSAGE("Pixels are converted to RGB in place", data[0] == 3 && data[1] == 2 && data[2] == 1);
+  }
+
+  void TestImageSourceFiltersViewOfGrayImage()
+  {
+    unsigned int dimensions[2] = { 6, 4 };
+    auto rawImage = mitk::Image::New();
+    rawImage->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 2, dimensions);
+    void* rawData = nullptr;
+    {
+      mitk::ImageWriteAccessor accessor(rawImage);
+      rawData = accessor.GetData();
+      std::fill_n(static_cast<unsigned char*>(rawData), 6 * 4, 10);
+    }
+
+    auto source = TestImageSource::New();
+    source->RawImage = rawImage;
+    auto filter = IncrementFilter::New();
+    source->PushFilter(filter.GetPointer());
+
+    const itk::ModifiedTimeType timeStamp = rawImage->GetMTime();
+    std::vector<mitk::Image::Pointer> images = source->GetNextImage();
+
+    CPPUNIT_ASSERT_MESSAGE("Filter works on the pixels of the raw image", filter->Data == rawData);
+    CPPUNIT_ASSERT_MESSAGE("Filtered raw image is returned without copying", images[0] == rawImage);
+    CPPUNIT_ASSERT_MESSAGE("Image is marked as modified", rawImage->GetMTime() > timeStamp);
+
+    mitk::ImageReadAccessor accessor(rawImage);
+    CPPUNIT_ASSERT_EQUAL(11, static_cast<int>(static_cast<const unsigned char*>(accessor.GetData())[0]));
+  }
+
+  void TestImageSourceKeepsChannelOrder()
+  {
+    unsigned int dimensions[2] = { 6, 4 };
+    auto rawImage = mitk::Image::New();
+    rawImage->Initialize(mitk::MakePixelType<unsigned char, itk::RGBPixel<unsigned char>>(3), 2, dimensions);
+    mitk::USImageFramePool::GetMatView(rawImage).setTo(cv::Scalar(10, 20, 30)); // RGB
+
+    auto source = TestImageSource::New();
+    source->RawImage = rawImage;
+    auto filter = IncrementFilter::New();
+    source->PushFilter(filter.GetPointer());
+
+    for (int i = 0; i < 2; ++i)
+    {
+      std::vector<mitk::Image::Pointer> images = source->GetNextImage();
+
+      CPPUNIT_ASSERT_MESSAGE("Filter gets BGR", filter->FirstPixel == cv::Vec3b(30, 20, 10));
+      CPPUNIT_ASSERT(images[0].IsNotNull() && images[0] != rawImage);
+
+      mitk::ImageReadAccessor accessor(images[0]);
+      const unsigned char* data = static_cast<const unsigned char*>(accessor.GetData());
+      CPPUNIT_ASSERT_MESSAGE("Result is RGB", data[0] == 11 && data[1] == 21 && data[2] == 31);
+    }
+
+    mitk::ImageReadAccessor accessor(rawImage);
+    CPPUNIT_ASSERT_MESSAGE("Raw image is not changed", static_cast<const unsigned char*>(accessor.GetData())[0] == 10);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkUSImageFramePool)
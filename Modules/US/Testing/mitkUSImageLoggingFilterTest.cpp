@@ -26,6 +26,8 @@ found in the LICENSE file.
 
 #include "Poco/File.h"
 
+#include <fstream>
+
 class mitkUSImageLoggingFilterTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkUSImageLoggingFilterTestSuite);
@@ -36,6 +38,9 @@ class mitkUSImageLoggingFilterTestSuite : public mitk::TestFixture
   MITK_TEST(TestSavingAfterMupltipleUpdateCalls);
   MITK_TEST(TestFilterWithEmptyImages);
   MITK_TEST(TestFilterWithInvalidPath);
+  MITK_TEST(TestRecording);
+  MITK_TEST(TestRecordingWithInvalidPath);
+  MITK_TEST(TestMessagesNeedCurrentImage);
   //MITK_TEST(TestJpgFileExtension); //bug 19614
   CPPUNIT_TEST_SUITE_END();
 
@@ -158,6 +163,95 @@ public:
                                mitk::Exception);
   }
 
+  void TestRecording()
+  {
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->StartRecording(m_TemporaryTestDirectory, 2);
+  CPPUNIT_ASSERT_MESSAGE("Testing if recording is running", m_TestFilter->GetIsRecording());
+
+  for(int i=0; i<5; i++)
+    {
+    m_RandomSingleSliceImage->Modified();
+    m_TestFilter->Update();
+    std::stringstream testmessage;
+    testmessage << "testmessage" << i;
+    m_TestFilter->AddMessageToCurrentImage(testmessage.str());
+    }
+
+  std::vector<std::string> filenames;
+  std::string csvFileName;
+  m_TestFilter->StopRecording(filenames,csvFileName);
+  CPPUNIT_ASSERT_MESSAGE("Testing if recording is stopped", !m_TestFilter->GetIsRecording());
+  CPPUNIT_ASSERT_MESSAGE("Testing if every image was either written or dropped",
+                         filenames.size() + m_TestFilter->GetNumberOfDroppedFrames() == 5);
+  CPPUNIT_ASSERT_MESSAGE("Testing if at least one image was written", !filenames.empty());
+  for(size_t i=0; i<filenames.size(); i++)
+    CPPUNIT_ASSERT_MESSAGE("Testing if recorded file exists",Poco::File(filenames.at(i).c_str()).exists());
+  CPPUNIT_ASSERT_MESSAGE("Testing if csv file exists",Poco::File(csvFileName.c_str()).exists());
+
+  mitk::Image::Pointer recordedImage = mitk::IOUtil::Load<mitk::Image>(filenames.at(0));
+  CPPUNIT_ASSERT_MESSAGE("Testing if recorded image has the size of the input",
+                         recordedImage->GetDimension(0) == m_RandomSingleSliceImage->GetDimension(0) &&
+                         recordedImage->GetDimension(1) == m_RandomSingleSliceImage->GetDimension(1));
+
+  //clean up
+  for(size_t i=0; i<filenames.size(); i++) std::remove(filenames.at(i).c_str());
+  std::remove(csvFileName.c_str());
+  }
+
+  void TestMessagesNeedCurrentImage()
+  {
+  CPPUNIT_ASSERT_MESSAGE("Testing that a message without image is rejected",
+                         !m_TestFilter->AddMessageToCurrentImage("no image"));
+
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->Update();
+  CPPUNIT_ASSERT_MESSAGE("Testing that a message is added to the logged image",
+                         m_TestFilter->AddMessageToCurrentImage("logged image"));
+
+  //the logged image does not belong to the recording
+  m_TestFilter->StartRecording(m_TemporaryTestDirectory, 1);
+  CPPUNIT_ASSERT_MESSAGE("Testing that a message before the first recorded image is rejected",
+                         !m_TestFilter->AddMessageToCurrentImage("no recorded image"));
+
+  m_RandomSingleSliceImage->Modified();
+  m_TestFilter->Update();
+  CPPUNIT_ASSERT_MESSAGE("Testing that a message is added to the recorded image",
+                         m_TestFilter->AddMessageToCurrentImage("recorded image"));
+
+  std::vector<std::string> filenames;
+  std::string csvFileName;
+  m_TestFilter->StopRecording(filenames, csvFileName);
+  CPPUNIT_ASSERT_MESSAGE("Testing that a message after the recording is rejected",
+                         !m_TestFilter->AddMessageToCurrentImage("stopped"));
+
+  std::ifstream csvFile(csvFileName.c_str());
+  std::string header, firstLine;
+  std::getline(csvFile, header);
+  std::getline(csvFile, firstLine);
+  CPPUNIT_ASSERT_MESSAGE("Testing that the message belongs to the recorded image",
+                         firstLine.find("recorded image") != std::string::npos);
+  csvFile.close();
+
+  //clean up
+  for(size_t i=0; i<filenames.size(); i++) std::remove(filenames.at(i).c_str());
+  std::remove(csvFileName.c_str());
+  }
+
+  void TestRecordingWithInvalidPath()
+  {
+  #ifdef WIN32
+  std::string filename = "XV:/342INVALID<>"; //invalid filename for windows
+  #else
+  std::string filename = "/dsfdsf:$342INVALID"; //invalid filename for linux
+  #endif
+
+  CPPUNIT_ASSERT_THROW_MESSAGE("Testing if correct exception if thrown if an invalid path is given.",
+                               m_TestFilter->StartRecording(filename),
+                               mitk::Exception);
+  CPPUNIT_ASSERT(!m_TestFilter->GetIsRecording());
+  }
+
   void TestJpgFileExtension()
   {
   CPPUNIT_ASSERT_MESSAGE("Testing setting of jpg extension.",m_TestFilter->SetImageFilesExtension(".jpg"));
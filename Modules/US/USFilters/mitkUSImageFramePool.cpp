@@ -0,0 +1,308 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkUSImageFramePool.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkRGBPixel.h>
+
+#include <utility>
+
+namespace
+{
+  bool GetPixelTypeForCvType(int cvType, mitk::PixelType& pixelType)
+  {
+    const int depth = CV_MAT_DEPTH(cvType);
+    const int channels = CV_MAT_CN(cvType);
+
+    if (channels == 1)
+    {
+      switch (depth)
+      {
+      case CV_8S:  pixelType = mitk::MakeScalarPixelType<char>(); return true;
+      case CV_8U:  pixelType = mitk::MakeScalarPixelType<unsigned char>(); return true;
+      case CV_16S: pixelType = mitk::MakeScalarPixelType<short>(); return true;
+      case CV_16U: pixelType = mitk::MakeScalarPixelType<unsigned short>(); return true;
+      case CV_32F: pixelType = mitk::MakeScalarPixelType<float>(); return true;
+      case CV_64F: pixelType = mitk::MakeScalarPixelType<double>(); return true;
+      default: return false;
+      }
+    }
+
+    if (channels == 3)
+    {
+      switch (depth)
+      {
+      case CV_8U:  pixelType = mitk::MakePixelType<unsigned char, itk::RGBPixel<unsigned char>>(3); return true;
+      case CV_16U: pixelType = mitk::MakePixelType<unsigned short, itk::RGBPixel<unsigned short>>(3); return true;
+      case CV_32F: pixelType = mitk::MakePixelType<float, itk::RGBPixel<float>>(3); return true;
+      case CV_64F: pixelType = mitk::MakePixelType<double, itk::RGBPixel<double>>(3); return true;
+      default: return false;
+      }
+    }
+
+    return false;
+  }
+
+#if CV_VERSION_MAJOR < 4
+  typedef int AccessFlagType;
+#else
+  typedef cv::AccessFlag AccessFlagType;
+#endif
+
+  /**
+  * Shares the buffer of an mitk::Image with cv::Mat headers. The UMatData of a view holds a reference to
+  * the image, so the buffer stays valid as long as any copy of the view exists, and the pool can tell
+  * from the reference count of the UMatData whether a frame is still viewed.
+  */
+  class ImageMatAllocator : public cv::MatAllocator
+  {
+  public:
+    cv::UMatData* Wrap(mitk::Image* image, void* data, std::size_t size) const
+    {
+      auto* u = new cv::UMatData(this);
+      u->data = u->origdata = static_cast<uchar*>(data);
+      u->size = size;
+      u->refcount = 1;
+      u->flags |= cv::UMatData::USER_ALLOCATED;
+      u->userdata = new mitk::Image::Pointer(image);
+      return u;
+    }
+
+    // called if a view is re-created with another size or type, the new buffer is a normal OpenCV buffer
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+      AccessFlagType flags, cv::UMatUsageFlags usageFlags) const override
+    {
+      return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData* u, AccessFlagType, cv::UMatUsageFlags) const override
+    {
+      return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override
+    {
+      if (u == nullptr)
+        return;
+
+      delete static_cast<mitk::Image::Pointer*>(u->userdata);
+      u->userdata = nullptr;
+      delete u;
+    }
+  };
+
+  ImageMatAllocator* GetImageMatAllocator()
+  {
+    // never destroyed, like the default allocator of OpenCV, as views may outlive static objects
+    static ImageMatAllocator* const allocator = new ImageMatAllocator;
+    return allocator;
+  }
+
+  int GetCvTypeForPixelType(const mitk::PixelType& pixelType)
+  {
+    const int channels = static_cast<int>(pixelType.GetNumberOfComponents());
+    if (channels != 1 && channels != 3)
+      return -1;
+
+    switch (pixelType.GetComponentType())
+    {
+    case itk::ImageIOBase::CHAR:   return CV_MAKETYPE(CV_8S, channels);
+    case itk::ImageIOBase::UCHAR:  return CV_MAKETYPE(CV_8U, channels);
+    case itk::ImageIOBase::SHORT:  return CV_MAKETYPE(CV_16S, channels);
+    case itk::ImageIOBase::USHORT: return CV_MAKETYPE(CV_16U, channels);
+    case itk::ImageIOBase::FLOAT:  return CV_MAKETYPE(CV_32F, channels);
+    case itk::ImageIOBase::DOUBLE: return CV_MAKETYPE(CV_64F, channels);
+    default: return -1;
+    }
+  }
+
+  /** Returns the image if the matrix is a view of a whole image created by GetMatView(), otherwise nullptr. */
+  mitk::Image* GetViewedImage(const cv::Mat& mat)
+  {
+    if (mat.u == nullptr || mat.u->currAllocator != GetImageMatAllocator() || mat.u->userdata == nullptr)
+      return nullptr;
+
+    mitk::Image* image = static_cast<mitk::Image::Pointer*>(mat.u->userdata)->GetPointer();
+
+    if (mat.data != mat.u->data || !mat.isContinuous() || mat.type() != GetCvTypeForPixelType(image->GetPixelType())
+      || mat.cols != static_cast<int>(image->GetDimension(0)) || mat.rows != static_cast<int>(image->GetDimension(1)))
+    {
+      return nullptr;
+    }
+
+    return image;
+  }
+
+  /** Converts a three channel matrix between BGR and RGB in place. */
+  void SwapRedAndBlue(cv::Mat mat)
+  {
+    cv::Mat channels[3];
+    cv::split(mat, channels);
+    std::swap(channels[0], channels[2]);
+    cv::merge(channels, 3, mat);
+  }
+}
+
+mitk::USImageFramePool::USImageFramePool(unsigned int maximumNumberOfFrames)
+  : m_MaximumNumberOfFrames(maximumNumberOfFrames)
+{
+}
+
+mitk::USImageFramePool::~USImageFramePool()
+{
+}
+
+mitk::USImageFramePool::PooledFrame mitk::USImageFramePool::CreateFrame(int rows, int cols, int cvType)
+{
+  mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+  if (!GetPixelTypeForCvType(cvType, pixelType))
+  {
+    mitkThrow() << "OpenCV type " << cvType << " has no corresponding MITK pixel type.";
+  }
+
+  unsigned int dimensions[2] = { static_cast<unsigned int>(cols), static_cast<unsigned int>(rows) };
+
+  PooledFrame pooledFrame;
+  pooledFrame.Data.Image = mitk::Image::New();
+  pooledFrame.Data.Image->Initialize(pixelType, 2, dimensions);
+  pooledFrame.Data.Mat = GetMatView(pooledFrame.Data.Image);
+  pooledFrame.InitialGeometry = pooledFrame.Data.Image->GetGeometry()->Clone();
+
+  return pooledFrame;
+}
+
+mitk::USImageFramePool::Frame mitk::USImageFramePool::Acquire(int rows, int cols, int cvType)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  PooledFrame* reusable = nullptr;
+
+  for (auto& pooledFrame : m_Frames)
+  {
+    const Frame& frame = pooledFrame.Data;
+
+    // only the pool and the view of the pool reference the image, so nobody uses this frame anymore
+    if (frame.Image->GetReferenceCount() == 2 && frame.Mat.u->refcount == 1)
+    {
+      if (frame.Mat.rows == rows && frame.Mat.cols == cols && frame.Mat.type() == cvType)
+      {
+        // consumers may have changed (or share) the geometry of the handed out image
+        frame.Image->SetClonedGeometry(pooledFrame.InitialGeometry);
+        return frame;
+      }
+
+      if (reusable == nullptr)
+        reusable = &pooledFrame;
+    }
+  }
+
+  if (reusable != nullptr)
+  {
+    // free slot of the wrong size, replace it instead of growing the pool
+    *reusable = CreateFrame(rows, cols, cvType);
+    return reusable->Data;
+  }
+
+  if (m_Frames.size() < m_MaximumNumberOfFrames)
+  {
+    m_Frames.push_back(CreateFrame(rows, cols, cvType));
+    return m_Frames.back().Data;
+  }
+
+  return CreateFrame(rows, cols, cvType).Data;
+}
+
+mitk::Image::Pointer mitk::USImageFramePool::ToImage(const cv::Mat& mat)
+{
+  if (mat.empty() || mat.dims != 2)
+    return nullptr;
+
+  mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+  if (!GetPixelTypeForCvType(mat.type(), pixelType))
+  {
+    MITK_WARN << "Unknown image depth and/or pixel type. Cannot convert OpenCV to MITK image.";
+    return nullptr;
+  }
+
+  // views of pooled frames or other images (see GetMatView()) are converted in place
+  mitk::Image::Pointer viewedImage = GetViewedImage(mat);
+  if (viewedImage.IsNotNull())
+  {
+    if (mat.channels() == 3)
+      SwapRedAndBlue(mat);
+
+    viewedImage->Modified();
+    return viewedImage;
+  }
+
+  Frame frame = this->Acquire(mat.rows, mat.cols, mat.type());
+
+  if (mat.channels() == 3)
+  {
+    const int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+    cv::mixChannels(&mat, 1, &frame.Mat, 1, fromTo, 3);
+  }
+  else
+  {
+    mat.copyTo(frame.Mat);
+  }
+
+  frame.Image->Modified();
+
+  return frame.Image;
+}
+
+cv::Mat mitk::USImageFramePool::GetMatView(mitk::Image* image)
+{
+  if (image == nullptr || !image->IsInitialized() || image->GetDimension() < 2
+    || (image->GetDimension() > 2 && image->GetDimension(2) > 1))
+  {
+    return cv::Mat();
+  }
+
+  const int cvType = GetCvTypeForPixelType(image->GetPixelType());
+  if (cvType < 0)
+    return cv::Mat();
+
+  // the accessor only guards the acquisition of the pointer, the buffer itself lives as long as the image
+  mitk::ImageWriteAccessor accessor(image, image->GetVolumeData(0));
+
+  cv::Mat view(static_cast<int>(image->GetDimension(1)), static_cast<int>(image->GetDimension(0)), cvType,
+    accessor.GetData());
+
+  // let the view (and all its copies) keep the image alive
+  ImageMatAllocator* allocator = GetImageMatAllocator();
+  view.allocator = allocator;
+  view.u = allocator->Wrap(image, view.data, view.total() * view.elemSize());
+
+  return view;
+}
+
+void mitk::USImageFramePool::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_Frames.clear();
+}
+
+unsigned int mitk::USImageFramePool::GetNumberOfAllocatedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return static_cast<unsigned int>(m_Frames.size());
+}
+
+unsigned int mitk::USImageFramePool::GetMaximumNumberOfFrames() const
+{
+  return m_MaximumNumberOfFrames;
+}
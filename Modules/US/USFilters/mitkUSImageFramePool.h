@@ -0,0 +1,109 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKUSImageFramePool_H_HEADER_INCLUDED_
+#define MITKUSImageFramePool_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkImage.h>
+
+// OpenCV
+#include <opencv2/core.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace mitk {
+  /**
+  * \brief Pool of recycled 2D frames whose pixel buffers are shared between
+  * an mitk::Image and a cv::Mat header.
+  *
+  * A frame is handed out again as soon as nobody but the pool holds a reference
+  * to its image or to a cv::Mat view of it, so a running image source does not
+  * allocate a new image per frame. OpenCV code can write directly into the image buffer through the
+  * cv::Mat view of a frame; ToImage() recognizes such a view and returns the
+  * image without copying.
+  *
+  * Views returned by GetMatView() keep the channel order of the image (RGB). Code that
+  * passes them to OpenCV filters expecting BGR has to swap the channels, as
+  * mitk::USImageSource does.
+  *
+  * The pool is bounded: if all frames are in use, Acquire() returns an
+  * unpooled frame instead of growing the pool.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageFramePool
+  {
+  public:
+    struct Frame
+    {
+      mitk::Image::Pointer Image;
+      cv::Mat Mat; ///< header viewing the buffer of Image, keeps Image alive
+    };
+
+    explicit USImageFramePool(unsigned int maximumNumberOfFrames = 8);
+    ~USImageFramePool();
+
+    /**
+    * \brief Returns a free frame of the given size and OpenCV type (e.g. CV_8UC1).
+    * The pixel values are undefined.
+    * \throw mitk::Exception if the OpenCV type has no MITK equivalent
+    */
+    Frame Acquire(int rows, int cols, int cvType);
+
+    /**
+    * \brief Converts an OpenCV frame into an mitk::Image.
+    *
+    * The matrix is expected in the channel order of OpenCV, three channel frames are
+    * converted from BGR to RGB (like mitk::OpenCVToMitkImageFilter does). If the
+    * matrix views a whole image (a pooled frame or any other view created by
+    * GetMatView()), that image is converted in place, marked as modified and returned
+    * without copying. Otherwise the pixels are copied once into a recycled frame.
+    *
+    * \return the image or nullptr if the matrix is empty or of an unsupported type
+    */
+    mitk::Image::Pointer ToImage(const cv::Mat& mat);
+
+    /**
+    * \brief Returns a cv::Mat header viewing the pixels of a 2D image without copying.
+    * The header and its copies hold a reference to the image, so the pixels stay valid as long
+    * as any of them exists. The header becomes invalid if the image is re-initialized.
+    * \return an empty matrix if the image has no OpenCV equivalent
+    */
+    static cv::Mat GetMatView(mitk::Image* image);
+
+    /** \brief Releases all pooled frames. Images still referenced elsewhere stay valid. */
+    void Clear();
+
+    unsigned int GetNumberOfAllocatedFrames() const;
+    unsigned int GetMaximumNumberOfFrames() const;
+
+  private:
+    USImageFramePool(const USImageFramePool&) = delete;
+    USImageFramePool& operator=(const USImageFramePool&) = delete;
+
+    struct PooledFrame
+    {
+      Frame Data;
+      mitk::BaseGeometry::Pointer InitialGeometry;
+    };
+
+    static PooledFrame CreateFrame(int rows, int cols, int cvType);
+
+    std::vector<PooledFrame> m_Frames;
+    unsigned int m_MaximumNumberOfFrames;
+    mutable std::mutex m_Mutex;
+  };
+} // namespace mitk
+#endif /* MITKUSImageFramePool_H_HEADER_INCLUDED_ */
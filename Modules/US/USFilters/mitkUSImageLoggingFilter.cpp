@@ -20,9 +20,53 @@ found in the LICENSE file.
 #include <mitkCoreServices.h>
 #include <mitkIMimeTypeProvider.h>
 
+namespace
+{
+  void WriteCsvFile(const std::string& csvFileName,
+                    const std::vector<std::string>& filenames,
+                    const std::vector<double>& systemTimes,
+                    const std::map<int, std::string>& messages)
+  {
+    //open file
+    std::filebuf fb;
+    fb.open (csvFileName.c_str(),std::ios::out);
+    std::ostream os(&fb);
+    os.precision(15); //set high precision to avoid loss of digits
+
+    //write header
+    os << "image filename; MITK system timestamp; message\n";
+
+    //write data
+    for(size_t i=0; i<filenames.size(); i++)
+      {
+      std::map<int, std::string>::const_iterator it = messages.find(static_cast<int>(i));
+      if (it == messages.end()) os << filenames.at(i) << ";" << systemTimes.at(i) << ";" << "" << "\n";
+      else os << filenames.at(i) << ";" << systemTimes.at(i) << ";" << it->second << "\n";
+      }
+
+    //close file
+    fb.close();
+  }
+
+  std::string GenerateFilePrefix(const std::string& path)
+  {
+    //test if path is valid
+    Poco::Path testPath(path);
+    if(!testPath.isDirectory())
+      {
+      mitkThrow() << "Attemting to write to directory " << path << " which is not valid! Aborting!";
+      }
+
+    //generate a unique ID which is used as part of the filenames, so we avoid to overwrite old files by mistake.
+    mitk::UIDGenerator myGen = mitk::UIDGenerator("",5);
+    return path + myGen.GetUID();
+  }
+}
+
 
 mitk::USImageLoggingFilter::USImageLoggingFilter() : m_SystemTimeClock(RealTimeClock::New()),
-                                                     m_ImageExtension(".nrrd")
+                                                     m_ImageExtension(".nrrd"),
+                                                     m_CurrentImageIndex(-1)
 {
 }
 
@@ -35,12 +79,27 @@ void mitk::USImageLoggingFilter::GenerateData()
   mitk::Image::ConstPointer inputImage = this->GetInput();
   mitk::Image::Pointer outputImage = this->GetOutput();
 
+  //messages must not be attached to a previous image if this one is not logged
+  m_CurrentImageIndex = -1;
+
   if(inputImage.IsNull() || inputImage->IsEmpty())
     {
     MITK_WARN << "Input image is not valid. Cannot save image!";
     return;
     }
 
+  if (m_RecordingBuffer.IsRecording())
+    {
+    //the image is copied into the ring buffer, its timestamp is only logged if it was not dropped
+    double timestamp = m_SystemTimeClock->GetCurrentStamp();
+    if (m_RecordingBuffer.Push(inputImage))
+      {
+      m_RecordedMITKSystemTimes.push_back(timestamp);
+      m_CurrentImageIndex = static_cast<int>(m_RecordedMITKSystemTimes.size()) - 1;
+      }
+    return;
+    }
+
   //a clone is needed for a output and to store it.
   mitk::Image::Pointer inputClone = inputImage->Clone();
 
@@ -74,12 +133,24 @@ void mitk::USImageLoggingFilter::GenerateData()
 
   m_LoggedImages.push_back(inputClone);
   m_LoggedMITKSystemTimes.push_back(m_SystemTimeClock->GetCurrentStamp());
+  m_CurrentImageIndex = static_cast<int>(m_LoggedImages.size()) - 1;
 
 }
 
-void mitk::USImageLoggingFilter::AddMessageToCurrentImage(std::string message)
+bool mitk::USImageLoggingFilter::AddMessageToCurrentImage(std::string message)
 {
-  m_LoggedMessages.insert(std::make_pair(static_cast<int>(m_LoggedImages.size()-1),message));
+  if (m_CurrentImageIndex < 0)
+    {
+    MITK_WARN << "No current image (none was logged yet or it was dropped). Message \"" << message << "\" is ignored.";
+    return false;
+    }
+
+  if (m_RecordingBuffer.IsRecording())
+    m_RecordedMessages[m_CurrentImageIndex] = message;
+  else
+    m_LoggedMessages.insert(std::make_pair(m_CurrentImageIndex, message));
+
+  return true;
 }
 
 void mitk::USImageLoggingFilter::SaveImages(std::string path)
@@ -93,50 +164,71 @@ void mitk::USImageLoggingFilter::SaveImages(std::string path, std::vector<std::s
 {
   filenames = std::vector<std::string>();
 
-  //test if path is valid
-  Poco::Path testPath(path);
-  if(!testPath.isDirectory())
-    {
-    mitkThrow() << "Attemting to write to directory " << path << " which is not valid! Aborting!";
-    }
-
-  //generate a unique ID which is used as part of the filenames, so we avoid to overwrite old files by mistake.
-  mitk::UIDGenerator myGen = mitk::UIDGenerator("",5);
-  std::string uniqueID = myGen.GetUID();
+  std::string filePrefix = GenerateFilePrefix(path);
 
   //first: write the images
   for(size_t i=0; i<m_LoggedImages.size(); i++)
     {
       std::stringstream name;
-      name << path << uniqueID << "_Image_" << i << m_ImageExtension;
+      name << filePrefix << "_Image_" << i << m_ImageExtension;
       mitk::IOUtil::Save(m_LoggedImages.at(i),name.str());
       filenames.push_back(name.str());
     }
 
   //then: write a csv file which contains comments to all the images
+  csvFileName = filePrefix + "_ImageMessages.csv";
+  WriteCsvFile(csvFileName, filenames, m_LoggedMITKSystemTimes, m_LoggedMessages);
+}
 
-  //open file
-  std::stringstream csvFilenameStream;
-  csvFilenameStream << path << uniqueID << "_ImageMessages.csv";
-  csvFileName = csvFilenameStream.str();
-  std::filebuf fb;
-  fb.open (csvFileName.c_str(),std::ios::out);
-  std::ostream os(&fb);
-  os.precision(15); //set high precision to avoid loss of digits
-
-  //write header
-  os << "image filename; MITK system timestamp; message\n";
-
-  //write data
-  for(size_t i=0; i<m_LoggedImages.size(); i++)
+void mitk::USImageLoggingFilter::StartRecording(std::string path, unsigned int bufferSize)
+{
+  if (m_RecordingBuffer.IsRecording())
     {
-    std::map<int, std::string>::iterator it = m_LoggedMessages.find(i);
-    if (m_LoggedMessages.empty() || (it == m_LoggedMessages.end())) os << filenames.at(i) << ";" << m_LoggedMITKSystemTimes.at(i) << ";" << "" << "\n";
-    else os << filenames.at(i) << ";" << m_LoggedMITKSystemTimes.at(i) << ";" << it->second << "\n";
+    mitkThrow() << "Recording is already running.";
     }
 
-  //close file
-  fb.close();
+  std::string filePrefix = GenerateFilePrefix(path);
+
+  m_RecordedMessages.clear();
+  m_RecordedMITKSystemTimes.clear();
+  m_CurrentImageIndex = -1;
+  m_RecordingCsvFileName = filePrefix + "_ImageMessages.csv";
+  m_RecordingBuffer.Start(filePrefix, m_ImageExtension, bufferSize);
+}
+
+void mitk::USImageLoggingFilter::StopRecording()
+{
+  std::vector<std::string> dummy1;
+  std::string dummy2;
+  this->StopRecording(dummy1,dummy2);
+}
+
+void mitk::USImageLoggingFilter::StopRecording(std::vector<std::string>& filenames, std::string& csvFileName)
+{
+  filenames = std::vector<std::string>();
+  csvFileName = std::string();
+
+  if (!m_RecordingBuffer.IsRecording())
+    return;
+
+  //the current image belongs to the recording
+  m_CurrentImageIndex = -1;
+
+  //waits for the writer, throws if an image could not be written
+  filenames = m_RecordingBuffer.Stop();
+
+  csvFileName = m_RecordingCsvFileName;
+  WriteCsvFile(csvFileName, filenames, m_RecordedMITKSystemTimes, m_RecordedMessages);
+}
+
+bool mitk::USImageLoggingFilter::GetIsRecording() const
+{
+  return m_RecordingBuffer.IsRecording();
+}
+
+unsigned long mitk::USImageLoggingFilter::GetNumberOfDroppedFrames() const
+{
+  return m_RecordingBuffer.GetNumberOfDroppedFrames();
 }
 
 bool mitk::USImageLoggingFilter::SetImageFilesExtension(std::string extension)
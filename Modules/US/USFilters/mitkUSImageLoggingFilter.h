@@ -17,6 +17,7 @@ found in the LICENSE file.
 #include <MitkUSExports.h>
 #include <mitkImageToImageFilter.h>
 #include <mitkRealTimeClock.h>
+#include "mitkUSImageRecordingBuffer.h"
 
 
 namespace mitk {
@@ -25,6 +26,11 @@ namespace mitk {
    *  add messages. All data (images, timestamps and messages) is written to the harddisc when
    *  the method SaveImages(...) is called.
    *
+   *  For long acquisitions the images should rather be recorded with StartRecording(...) and
+   *  StopRecording(...): the images are then copied into a bounded ring buffer and written to disk
+   *  in the background while the acquisition is running, instead of keeping a clone of every image
+   *  in memory. If the disk cannot keep up, images are dropped (see GetNumberOfDroppedFrames()).
+   *
    *  Caution: only supports logging of one input at the moment, multiple inputs are ignored!
    *
    *  \ingroup US
@@ -40,11 +46,13 @@ namespace mitk {
     /** This method is internally called by the Update() mechanism of the pipeline. Don't call it directly. */
     void GenerateData() override;
 
-    /** Adds a message to the current (last logged) image. This message is internally stored and written to the
-     *  harddisc when SaveImages(...) is called.
+    /** Adds a message to the current image, i.e. the image of the last Update(). This message is internally stored
+     *  and written to the harddisc when SaveImages(...) or StopRecording(...) is called.
      * @param message The string which contains the message which is logged to the current image
+     * @return false if there is no current image, e.g. because it was invalid or dropped during a recording or no image
+     *         was logged since the recording was started or stopped; the message is ignored then
      */
-    void AddMessageToCurrentImage(std::string message);
+    bool AddMessageToCurrentImage(std::string message);
 
     /** Saves all logged data to the given path. Every image is written to a separate image file.
      *  Additionaly a csv file containing a list of all images together with timestamps and messages is saved.
@@ -72,6 +80,31 @@ namespace mitk {
      */
     bool SetImageFilesExtension(std::string extension);
 
+    /** Starts writing every image passed to Update() to the given path in the background. While recording,
+     *  no images are kept in memory for SaveImages(...).
+     *  @param[in]     path            Should contain a valid path were all logging data will be stored.
+     *  @param[in]     bufferSize      Number of images which can wait for being written before images are dropped.
+     *  @throw         mitk::Exception Throws an exception if the path is not valid or a recording is already running.
+     */
+    void StartRecording(std::string path, unsigned int bufferSize = 64);
+
+    /** Waits until all recorded images are written and writes the csv file with timestamps and messages.
+     *  @param[out]    imageFilenames  Returns a list of all images filenames which were stored to the harddisc.
+     *  @param[out]    csvFileName     Returns the filename of the csv list with the timestamps and the messages.
+     *  @throw         mitk::Exception Throws an exception if there was a problem during writing the images.
+     */
+    void StopRecording(std::vector<std::string>& imageFilenames, std::string& csvFileName);
+
+    /** Waits until all recorded images are written and writes the csv file with timestamps and messages.
+     *  @throw         mitk::Exception Throws an exception if there was a problem during writing the images.
+     */
+    void StopRecording();
+
+    bool GetIsRecording() const;
+
+    /** @return the number of images of the current (or last) recording which were dropped because the ring buffer was full. */
+    unsigned long GetNumberOfDroppedFrames() const;
+
 
   protected:
     USImageLoggingFilter();
@@ -85,6 +118,14 @@ namespace mitk {
     std::vector<double> m_LoggedMITKSystemTimes; ///< Logged system times for every logged image
     std::string m_ImageExtension; ///< stores the image extension, default is ".nrrd"
 
+    //members for recording
+    USImageRecordingBuffer m_RecordingBuffer; ///< writes the recorded images in the background
+    std::string m_RecordingCsvFileName; ///< csv file of the running recording
+    std::map<int, std::string> m_RecordedMessages; ///< (Optional) messages for every recorded image
+    std::vector<double> m_RecordedMITKSystemTimes; ///< Recorded system times for every recorded image
+
+    int m_CurrentImageIndex; ///< index of the image of the last Update() in the logged or recorded images, -1 if there is none
+
   };
 } // namespace mitk
 #endif /* MITKUSImageSource_H_HEADER_INCLUDED_ */
@@ -0,0 +1,255 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#include "mitkUSImageRecordingBuffer.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkIOUtil.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <cstring>
+#include <sstream>
+
+namespace
+{
+  std::size_t GetNumberOfBytes(const mitk::Image* image)
+  {
+    std::size_t numberOfBytes = image->GetPixelType().GetSize();
+    for (unsigned int i = 0; i < image->GetDimension(); ++i)
+      numberOfBytes *= image->GetDimension(i);
+
+    return numberOfBytes;
+  }
+
+  bool HasSameLayout(const mitk::Image* a, const mitk::Image* b)
+  {
+    if (a->GetDimension() != b->GetDimension() || a->GetPixelType() != b->GetPixelType())
+      return false;
+
+    for (unsigned int i = 0; i < a->GetDimension(); ++i)
+    {
+      if (a->GetDimension(i) != b->GetDimension(i))
+        return false;
+    }
+
+    return true;
+  }
+}
+
+mitk::USImageRecordingBuffer::USImageRecordingBuffer()
+  : m_Head(0),
+    m_Count(0),
+    m_PushInProgress(false),
+    m_NumberOfDroppedFrames(0),
+    m_IsRecording(false),
+    m_StopRequested(false)
+{
+}
+
+mitk::USImageRecordingBuffer::~USImageRecordingBuffer()
+{
+  if (this->IsRecording())
+  {
+    try
+    {
+      this->Stop();
+    }
+    catch (const mitk::Exception& e)
+    {
+      MITK_ERROR << "Recording was not written completely: " << e.GetDescription();
+    }
+  }
+}
+
+void mitk::USImageRecordingBuffer::Start(const std::string& filePrefix, const std::string& extension, unsigned int capacity)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+
+  if (m_IsRecording)
+    mitkThrow() << "Recording is already running.";
+
+  if (capacity == 0)
+    mitkThrow() << "Recording buffer needs at least one slot.";
+
+  if (m_Slots.size() != capacity)
+    m_Slots = std::vector<Slot>(capacity);
+
+  m_Head = 0;
+  m_Count = 0;
+  m_FilePrefix = filePrefix;
+  m_Extension = extension;
+  m_FileNames.clear();
+  m_Errors.clear();
+  m_NumberOfDroppedFrames = 0;
+  m_StopRequested = false;
+  m_IsRecording = true;
+
+  m_Writer = std::thread(&USImageRecordingBuffer::Write, this);
+}
+
+bool mitk::USImageRecordingBuffer::Push(const mitk::Image* image, std::string* fileName)
+{
+  if (image == nullptr || !image->IsInitialized())
+    return false;
+
+  Slot* slot = nullptr;
+  std::string name;
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (!m_IsRecording || m_StopRequested)
+      return false;
+
+    if (m_Count == m_Slots.size())
+    {
+      ++m_NumberOfDroppedFrames;
+      return false;
+    }
+
+    // the writer only touches queued slots, so this one can be filled without holding the lock
+    slot = &m_Slots[(m_Head + m_Count) % m_Slots.size()];
+
+    std::ostringstream stream;
+    stream << m_FilePrefix << "_Image_" << m_FileNames.size() << m_Extension;
+    name = stream.str();
+    m_FileNames.push_back(name);
+    m_PushInProgress = true;
+  }
+
+  try
+  {
+    if (slot->Image.IsNull() || !HasSameLayout(slot->Image, image))
+    {
+      slot->Image = mitk::Image::New();
+      slot->Image->Initialize(image);
+    }
+
+    {
+      mitk::ImageReadAccessor source(image);
+      mitk::ImageWriteAccessor target(slot->Image);
+      std::memcpy(target.GetData(), source.GetData(), GetNumberOfBytes(image));
+    }
+
+    slot->Image->SetClonedTimeGeometry(image->GetTimeGeometry());
+    slot->FileName = name;
+  }
+  catch (...)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      m_FileNames.pop_back();
+      m_PushInProgress = false;
+    }
+
+    m_FrameAvailable.notify_one();
+    throw;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_PushInProgress = false;
+    ++m_Count;
+  }
+
+  m_FrameAvailable.notify_one();
+
+  if (fileName != nullptr)
+    *fileName = name;
+
+  return true;
+}
+
+std::vector<std::string> mitk::USImageRecordingBuffer::Stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (!m_IsRecording)
+      return std::vector<std::string>();
+
+    m_StopRequested = true;
+  }
+
+  m_FrameAvailable.notify_one();
+  m_Writer.join();
+
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  m_IsRecording = false;
+
+  if (!m_Errors.empty())
+  {
+    mitkThrow() << m_Errors.size() << " of " << m_FileNames.size()
+                << " recorded frames could not be written. First error: " << m_Errors.front();
+  }
+
+  return m_FileNames;
+}
+
+void mitk::USImageRecordingBuffer::Write()
+{
+  std::unique_lock<std::mutex> lock(m_Mutex);
+
+  while (true)
+  {
+    m_FrameAvailable.wait(lock, [this] { return m_Count > 0 || (m_StopRequested && !m_PushInProgress); });
+
+    if (m_Count == 0)
+      break; // stop requested and everything written
+
+    Slot& slot = m_Slots[m_Head];
+    lock.unlock();
+
+    std::string error;
+    try
+    {
+      mitk::IOUtil::Save(slot.Image, slot.FileName);
+    }
+    catch (const std::exception& e)
+    {
+      error = slot.FileName + ": " + e.what();
+    }
+
+    lock.lock();
+
+    if (!error.empty())
+      m_Errors.push_back(error);
+
+    m_Head = (m_Head + 1) % m_Slots.size();
+    --m_Count;
+  }
+}
+
+bool mitk::USImageRecordingBuffer::IsRecording() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_IsRecording;
+}
+
+unsigned long mitk::USImageRecordingBuffer::GetNumberOfDroppedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_NumberOfDroppedFrames;
+}
+
+unsigned long mitk::USImageRecordingBuffer::GetNumberOfRecordedFrames() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return static_cast<unsigned long>(m_FileNames.size());
+}
+
+unsigned int mitk::USImageRecordingBuffer::GetCapacity() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return static_cast<unsigned int>(m_Slots.size());
+}
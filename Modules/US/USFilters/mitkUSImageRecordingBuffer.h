@@ -0,0 +1,105 @@
+/*============================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center (DKFZ)
+All rights reserved.
+
+Use of this source code is governed by a 3-clause BSD license that can be
+found in the LICENSE file.
+
+============================================================================*/
+
+#ifndef MITKUSImageRecordingBuffer_H_HEADER_INCLUDED_
+#define MITKUSImageRecordingBuffer_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkImage.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mitk {
+  /**
+  * \brief Bounded ring buffer which writes recorded frames to disk in a background thread.
+  *
+  * Push() copies a frame into one of a fixed number of slots and returns immediately,
+  * the slots are written by a writer thread with mitk::IOUtil::Save(). The image of a
+  * slot is allocated when the slot is filled for the first time and reused as long as
+  * the frame size and pixel type do not change. If the writer falls behind and all
+  * slots are occupied, the frame is dropped and counted instead of stalling the
+  * acquisition.
+  *
+  * Frames must be pushed from one thread at a time.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageRecordingBuffer
+  {
+  public:
+    USImageRecordingBuffer();
+
+    /** \brief Stops a running recording, write errors are only logged. */
+    ~USImageRecordingBuffer();
+
+    /**
+    * \brief Starts the writer thread. Frame i is written to filePrefix + "_Image_" + i + extension.
+    * \throw mitk::Exception if a recording is already running or the capacity is zero
+    */
+    void Start(const std::string& filePrefix, const std::string& extension, unsigned int capacity);
+
+    /**
+    * \brief Copies the image into a free slot.
+    * \param fileName receives the file the frame will be written to (optional)
+    * \return false if the frame was dropped because the buffer is full or no recording is running
+    */
+    bool Push(const mitk::Image* image, std::string* fileName = nullptr);
+
+    /**
+    * \brief Writes all pending frames and stops the writer thread.
+    * \return the files of all recorded frames, in recording order
+    * \throw mitk::Exception if writing of at least one frame failed
+    */
+    std::vector<std::string> Stop();
+
+    bool IsRecording() const;
+
+    unsigned long GetNumberOfDroppedFrames() const;
+    unsigned long GetNumberOfRecordedFrames() const;
+    unsigned int GetCapacity() const;
+
+  private:
+    USImageRecordingBuffer(const USImageRecordingBuffer&) = delete;
+    USImageRecordingBuffer& operator=(const USImageRecordingBuffer&) = delete;
+
+    struct Slot
+    {
+      mitk::Image::Pointer Image;
+      std::string FileName;
+    };
+
+    void Write();
+
+    std::vector<Slot> m_Slots;
+    std::size_t m_Head;  ///< oldest slot waiting to be written
+    std::size_t m_Count; ///< number of slots waiting to be written
+    bool m_PushInProgress; ///< a slot is reserved but not yet queued
+
+    std::string m_FilePrefix;
+    std::string m_Extension;
+    std::vector<std::string> m_FileNames;
+    std::vector<std::string> m_Errors;
+    unsigned long m_NumberOfDroppedFrames;
+
+    bool m_IsRecording;
+    bool m_StopRequested;
+    std::thread m_Writer;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_FrameAvailable;
+  };
+} // namespace mitk
+#endif /* MITKUSImageRecordingBuffer_H_HEADER_INCLUDED_ */
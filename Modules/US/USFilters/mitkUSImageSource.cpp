@@ -63,12 +63,8 @@ std::vector<mitk::Image::Pointer> mitk::USImageSource::GetNextImage()
         m_ImageFilter->FilterImage(imageVector[i], m_CurrentImageId);
         m_ImageFilterMutex->Unlock();
 
-        // convert to MITK image
-        this->m_OpenCVToMitkFilter->SetOpenCVMat(imageVector[i]);
-        this->m_OpenCVToMitkFilter->Update();
-
-        // OpenCVToMitkImageFilter returns a standard mitk::image.
-        result[i] = this->m_OpenCVToMitkFilter->GetOutput();
+        // convert to MITK image, this copies at most once into a recycled frame
+        result[i] = m_FramePool.ToImage(imageVector[i]);
       }
     }
   }
@@ -106,6 +102,9 @@ void mitk::USImageSource::GetNextRawImage(std::vector<cv::Mat>& imageVector)
   std::vector<mitk::Image::Pointer> mitkImg;
   this->GetNextRawImage(mitkImg);
 
+  if (imageVector.size() != mitkImg.size())
+    imageVector.resize(mitkImg.size());
+
   for (unsigned int i = 0; i < mitkImg.size(); ++i)
   {
     if (mitkImg[i].IsNull() || !mitkImg[i]->IsInitialized())
@@ -114,9 +113,28 @@ void mitk::USImageSource::GetNextRawImage(std::vector<cv::Mat>& imageVector)
     }
     else
     {
-      // convert mitk::Image to an OpenCV image
-      m_MitkToOpenCVFilter->SetImage(mitkImg[i]);
-      imageVector[i] = m_MitkToOpenCVFilter->GetOpenCVMat();
+      // view the pixels of the image, m_FramePool.ToImage() returns the image of the view without copying
+      cv::Mat view = mitk::USImageFramePool::GetMatView(mitkImg[i]);
+
+      if (view.empty())
+      {
+        // no OpenCV equivalent of the pixel type, convert mitk::Image to an OpenCV image
+        m_MitkToOpenCVFilter->SetImage(mitkImg[i]);
+        imageVector[i] = m_MitkToOpenCVFilter->GetOpenCVMat();
+      }
+      else if (view.channels() == 3)
+      {
+        // OpenCV filters expect BGR, like the conversion of mitk::ImageToOpenCVImageFilter the channels
+        // are swapped into a recycled frame, which m_FramePool.ToImage() swaps back without another copy
+        mitk::USImageFramePool::Frame frame = m_FramePool.Acquire(view.rows, view.cols, view.type());
+        const int fromTo[] = { 0, 2, 1, 1, 2, 0 };
+        cv::mixChannels(&view, 1, &frame.Mat, 1, fromTo, 3);
+        imageVector[i] = frame.Mat;
+      }
+      else
+      {
+        imageVector[i] = view;
+      }
     }
   }
 }
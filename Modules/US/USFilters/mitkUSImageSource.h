@@ -23,6 +23,7 @@ found in the LICENSE file.
 #include "mitkBasicCombinationOpenCVImageFilter.h"
 #include "mitkOpenCVToMitkImageFilter.h"
 #include "mitkImageToOpenCVImageFilter.h"
+#include "mitkUSImageFramePool.h"
 
 namespace mitk {
   /**
@@ -64,8 +65,11 @@ namespace mitk {
     * from the device or file.
     *
     * The standard implementation calls the overloaded function with an
-    * mitk::Image and converts this image to OpenCV then. One should reimplement
-    * this method for a better performance if an image filter is set.
+    * mitk::Image and returns a view of its pixels (see
+    * mitk::USImageFramePool::GetMatView()), so the image filter works on the
+    * image itself and GetNextImage() returns it without copying. Three channel
+    * images are copied once into a recycled frame in BGR order, as OpenCV
+    * filters expect.
     */
     virtual void GetNextRawImage(std::vector<cv::Mat>&);
 
@@ -83,6 +87,12 @@ namespace mitk {
     * \brief Used to convert from MITK Images to OpenCV Images.
     */
     mitk::ImageToOpenCVImageFilter::Pointer m_MitkToOpenCVFilter;
+    /**
+    * \brief Recycled output images. Subclasses can convert OpenCV frames with
+    * m_FramePool.ToImage() or let OpenCV write directly into a frame acquired
+    * from the pool, instead of allocating a new image for every frame.
+    */
+    mitk::USImageFramePool m_FramePool;
 
   private:
     /**
@@ -200,14 +200,8 @@ void mitk::USImageVideoSource::GetNextRawImage(std::vector<mitk::Image::Pointer>
 
   this->GetNextRawImage(cv_img);
 
-  // convert to MITK-Image
-  IplImage ipl_img = cv_img[0];
-
-  this->m_OpenCVToMitkFilter->SetOpenCVImage(&ipl_img);
-  this->m_OpenCVToMitkFilter->Update();
-
-  // OpenCVToMitkImageFilter returns a standard mitk::image. We then transform it into an USImage
-  image[0] = this->m_OpenCVToMitkFilter->GetOutput();
+  // convert to MITK-Image, the pixels are copied into a recycled frame
+  image[0] = m_FramePool.ToImage(cv_img[0]);
 
   // clean up
   cv_img[0].release();
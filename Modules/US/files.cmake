@@ -16,7 +16,9 @@ USModel/mitkUSDeviceReaderXML.cpp
 USModel/mitkUSDeviceWriterXML.cpp
 
 ## Filters and Sources
+USFilters/mitkUSImageFramePool.cpp
 USFilters/mitkUSImageLoggingFilter.cpp
+USFilters/mitkUSImageRecordingBuffer.cpp
 USFilters/mitkUSImageSource.cpp
 USFilters/mitkUSImageVideoSource.cpp
 USFilters/mitkIGTLMessageToUSImageFilter.cpp
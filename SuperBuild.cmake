@@ -286,6 +286,7 @@ set(mitk_cmake_boolean_args
   MITK_USE_OpenCL
   MITK_USE_OpenMP
   MITK_ENABLE_PIC_READER
+  MITK_ENABLE_TRACING
   )
 
 #-----------------------------------------------------------------------------